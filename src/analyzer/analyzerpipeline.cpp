@@ -0,0 +1,142 @@
+#include "analyzer/analyzerpipeline.h"
+
+#include <cstring>
+
+#include "analyzer/constants.h"
+#include "util/assert.h"
+#include "util/math.h"
+
+namespace {
+
+// Allows the decoding thread to run ahead of the slowest stage by a few
+// chunks to compensate jitter in decoding and analysis.
+constexpr int kChunkCount = 8;
+
+} // anonymous namespace
+
+AnalyzerPipeline::Chunk::Chunk()
+        : buffer(mixxx::kAnalysisSamplesPerChunk),
+          sampleCount(0),
+          pendingStages(0) {
+}
+
+AnalyzerPipeline::AnalyzerPipeline(int stageCount)
+        : m_chunks(std::make_unique<Chunk[]>(kChunkCount)),
+          m_activeStageCount(0),
+          m_writePosition(0),
+          m_chunkAcquired(false),
+          m_semaFreeChunks(kChunkCount),
+          m_bDiscard(false),
+          m_bQuit(false) {
+    DEBUG_ASSERT(stageCount > 0);
+    m_stages.reserve(stageCount);
+    for (int i = 0; i < stageCount; ++i) {
+        m_stages.push_back(std::make_unique<Stage>(this, i));
+        // Started from the decoding thread and running with its priority
+        m_stages.back()->start(QThread::InheritPriority);
+    }
+}
+
+AnalyzerPipeline::~AnalyzerPipeline() {
+    waitUntilIdle(true);
+    m_bQuit.store(true);
+    for (const auto& pStage : m_stages) {
+        pStage->wake();
+    }
+    for (const auto& pStage : m_stages) {
+        pStage->wait();
+    }
+}
+
+AnalyzerPipeline::Chunk& AnalyzerPipeline::chunkAt(int position) const {
+    return m_chunks[position % kChunkCount];
+}
+
+void AnalyzerPipeline::assignAnalyzers(std::vector<AnalyzerWithState>* pAnalyzers) {
+    DEBUG_ASSERT(!m_chunkAcquired);
+    for (const auto& pStage : m_stages) {
+        pStage->m_analyzers.clear();
+        pStage->m_readPosition = m_writePosition;
+    }
+    // Inactive analyzers would not do anything and are skipped to balance
+    // the load among the stages
+    int analyzerCount = 0;
+    for (auto&& analyzer : *pAnalyzers) {
+        if (analyzer.isActive()) {
+            m_stages[analyzerCount % stageCount()]->m_analyzers.push_back(&analyzer);
+            ++analyzerCount;
+        }
+    }
+    m_activeStageCount = math_min(analyzerCount, stageCount());
+}
+
+mixxx::SampleBuffer::WritableSlice AnalyzerPipeline::nextChunkBuffer() {
+    if (!m_chunkAcquired) {
+        m_semaFreeChunks.acquire();
+        m_chunkAcquired = true;
+    }
+    return mixxx::SampleBuffer::WritableSlice(chunkAt(m_writePosition).buffer);
+}
+
+void AnalyzerPipeline::processSamples(const CSAMPLE* pSamples, SINT sampleCount) {
+    DEBUG_ASSERT(sampleCount <= mixxx::kAnalysisSamplesPerChunk);
+    nextChunkBuffer();
+    Chunk& chunk = chunkAt(m_writePosition);
+    if (pSamples != chunk.buffer.data()) {
+        // The samples might have been decoded into the chunk at an offset
+        std::memmove(chunk.buffer.data(), pSamples, sampleCount * sizeof(CSAMPLE));
+    }
+    chunk.sampleCount = sampleCount;
+    m_chunkAcquired = false;
+    ++m_writePosition;
+    if (m_activeStageCount == 0) {
+        m_semaFreeChunks.release();
+        return;
+    }
+    chunk.pendingStages.store(m_activeStageCount);
+    // The semaphore release publishes the chunk to the stage
+    for (int i = 0; i < m_activeStageCount; ++i) {
+        m_stages[i]->wake();
+    }
+}
+
+void AnalyzerPipeline::waitUntilIdle(bool discardPending) {
+    if (m_chunkAcquired) {
+        m_semaFreeChunks.release();
+        m_chunkAcquired = false;
+    }
+    if (discardPending) {
+        m_bDiscard.store(true);
+    }
+    // All chunks are free when all stages are done
+    m_semaFreeChunks.acquire(kChunkCount);
+    m_semaFreeChunks.release(kChunkCount);
+    m_bDiscard.store(false);
+}
+
+AnalyzerPipeline::Stage::Stage(AnalyzerPipeline* pPipeline, int stageIndex)
+        : m_readPosition(0),
+          m_pPipeline(pPipeline),
+          m_stageIndex(stageIndex) {
+}
+
+void AnalyzerPipeline::Stage::run() {
+    QThread::currentThread()->setObjectName(
+            QStringLiteral("AnalyzerPipeline %1").arg(m_stageIndex));
+    while (true) {
+        m_semaAvailable.acquire();
+        if (m_pPipeline->m_bQuit.load()) {
+            break;
+        }
+        Chunk& chunk = m_pPipeline->chunkAt(m_readPosition++);
+        if (!m_pPipeline->m_bDiscard.load()) {
+            for (AnalyzerWithState* pAnalyzer : m_analyzers) {
+                pAnalyzer->processSamples(chunk.buffer.data(), chunk.sampleCount);
+            }
+        }
+        // The last stage that is done with the chunk returns it
+        if (chunk.pendingStages.fetch_sub(1) == 1) {
+            m_pPipeline->m_semaFreeChunks.release();
+        }
+    }
+}
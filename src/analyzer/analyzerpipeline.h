@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "analyzer/analyzer.h"
+#include "util/class.h"
+#include "util/samplebuffer.h"
+
+/// Runs the analyzers of a single AnalyzerThread concurrently on separate
+/// stage threads while the AnalyzerThread decodes the next chunks.
+///
+/// Decoded chunks are stored in a small ring that is shared by all stages.
+/// Each active analyzer is assigned to a single stage that processes all
+/// chunks of the track in order, so analyzers don't need to be thread-safe.
+/// A chunk is reused for decoding after all stages have processed it.
+///
+/// All functions must be invoked from the decoding thread.
+class AnalyzerPipeline {
+  public:
+    explicit AnalyzerPipeline(int stageCount);
+    ~AnalyzerPipeline();
+
+    int stageCount() const {
+        return static_cast<int>(m_stages.size());
+    }
+
+    /// Distributes the active analyzers among the stages. Only allowed
+    /// while the pipeline is idle, i.e. before decoding the first chunk
+    /// of a track.
+    void assignAnalyzers(std::vector<AnalyzerWithState>* pAnalyzers);
+
+    /// Returns the buffer for decoding the next chunk. Blocks until the
+    /// stages have finished processing the chunk that previously occupied
+    /// the buffer. Returns the same buffer until processSamples() is
+    /// invoked.
+    mixxx::SampleBuffer::WritableSlice nextChunkBuffer();
+
+    /// Passes the decoded samples to the stages without waiting for them.
+    /// The samples are copied if they are not located in the buffer that
+    /// has been returned by nextChunkBuffer().
+    void processSamples(const CSAMPLE* pSamples, SINT sampleCount);
+
+    /// Blocks until all stages have processed all chunks. Chunks that
+    /// have not been processed yet are skipped if discardPending is set.
+    void waitUntilIdle(bool discardPending = false);
+
+  private:
+    struct Chunk {
+        Chunk();
+
+        mixxx::SampleBuffer buffer;
+        SINT sampleCount;
+        // The number of stages that have not processed the chunk yet
+        std::atomic<int> pendingStages;
+    };
+
+    class Stage : public QThread {
+      public:
+        Stage(AnalyzerPipeline* pPipeline, int stageIndex);
+
+        void wake() {
+            m_semaAvailable.release();
+        }
+
+        // Accessed only while the pipeline is idle
+        std::vector<AnalyzerWithState*> m_analyzers;
+        int m_readPosition;
+
+      protected:
+        void run() override;
+
+      private:
+        AnalyzerPipeline* const m_pPipeline;
+        const int m_stageIndex;
+        QSemaphore m_semaAvailable;
+    };
+
+    Chunk& chunkAt(int position) const;
+
+    const std::unique_ptr<Chunk[]> m_chunks;
+    std::vector<std::unique_ptr<Stage>> m_stages;
+    // Stages with at least one analyzer for the current track
+    int m_activeStageCount;
+
+    int m_writePosition;
+    bool m_chunkAcquired;
+    QSemaphore m_semaFreeChunks;
+
+    std::atomic<bool> m_bDiscard;
+    std::atomic<bool> m_bQuit;
+
+    DISALLOW_COPY_AND_ASSIGN(AnalyzerPipeline);
+};
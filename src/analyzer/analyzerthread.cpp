@@ -84,6 +84,7 @@ AnalyzerThread::AnalyzerThread(
           m_pConfig(pConfig),
           m_modeFlags(modeFlags),
           m_nextTrack(2), // minimum capacity
+          m_pipelineStageCount(0),
           m_sampleBuffer(mixxx::kAnalysisSamplesPerChunk),
           m_emittedState(AnalyzerThreadState::Void) {
     std::call_once(registerMetaTypesOnceFlag, registerMetaTypesOnce);
@@ -152,6 +153,7 @@ void AnalyzerThread::doRun() {
         }
 
         if (processTrack) {
+            updatePipeline();
             const auto analysisResult = analyzeAudioSource(audioSource);
             DEBUG_ASSERT(analysisResult != AnalysisResult::Pending);
             if (analysisResult == AnalysisResult::Finished) {
@@ -181,6 +183,7 @@ void AnalyzerThread::doRun() {
     DEBUG_ASSERT(!m_currentTrack);
     DEBUG_ASSERT(isStopping());
 
+    m_pPipeline.reset();
     m_analyzers.clear();
 
     kLogger.debug() << "Exiting worker thread";
@@ -203,6 +206,22 @@ bool AnalyzerThread::submitNextTrack(TrackPointer nextTrack) {
     return false;
 }
 
+void AnalyzerThread::updatePipeline() {
+    const int stageCount = m_pipelineStageCount.load();
+    if (stageCount <= 0) {
+        m_pPipeline.reset();
+        return;
+    }
+    if (!m_pPipeline || m_pPipeline->stageCount() != stageCount) {
+        kLogger.debug()
+                << "Analyzing with" << stageCount << "pipeline stages";
+        // Destroy the old pipeline before starting new threads
+        m_pPipeline.reset();
+        m_pPipeline = std::make_unique<AnalyzerPipeline>(stageCount);
+    }
+    m_pPipeline->assignAnalyzers(&m_analyzers);
+}
+
 WorkerThread::TryFetchWorkItemsResult AnalyzerThread::tryFetchWorkItems() {
     DEBUG_ASSERT(!m_currentTrack);
     TrackPointer* pFront = m_nextTrack.front();
@@ -237,6 +256,9 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
     while (!remainingFrameRange.empty()) {
         sleepWhileSuspended();
         if (isStopping()) {
+            if (m_pPipeline) {
+                m_pPipeline->waitUntilIdle(true);
+            }
             return AnalysisResult::Cancelled;
         }
 
@@ -248,12 +270,16 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
                         math_min(mixxx::kAnalysisFramesPerChunk, remainingFrameRange.length()));
         DEBUG_ASSERT(!chunkFrameRange.empty());
 
-        // Request the next chunk of audio data
+        // Request the next chunk of audio data. With a pipeline it is
+        // decoded directly into the ring that is shared with the stages.
         const auto readableSampleFrames =
                 audioSourceProxy.readSampleFrames(
                         mixxx::WritableSampleFrames(
                                 chunkFrameRange,
-                                mixxx::SampleBuffer::WritableSlice(m_sampleBuffer)));
+                                m_pPipeline
+                                        ? m_pPipeline->nextChunkBuffer()
+                                        : mixxx::SampleBuffer::WritableSlice(
+                                                  m_sampleBuffer)));
         // The returned range fits into the requested range
         DEBUG_ASSERT(readableSampleFrames.frameIndexRange().isSubrangeOf(chunkFrameRange));
 
@@ -293,15 +319,24 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
 
         sleepWhileSuspended();
         if (isStopping()) {
+            if (m_pPipeline) {
+                m_pPipeline->waitUntilIdle(true);
+            }
             return AnalysisResult::Cancelled;
         }
 
         // 2nd: step: Analyze chunk of decoded audio data
         if (!readableSampleFrames.frameIndexRange().empty()) {
-            for (auto&& analyzer : m_analyzers) {
-                analyzer.processSamples(
+            if (m_pPipeline) {
+                m_pPipeline->processSamples(
                         readableSampleFrames.readableData(),
                         readableSampleFrames.readableLength());
+            } else {
+                for (auto&& analyzer : m_analyzers) {
+                    analyzer.processSamples(
+                            readableSampleFrames.readableData(),
+                            readableSampleFrames.readableLength());
+                }
             }
         }
 
@@ -327,6 +362,10 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
         }
     }
 
+    if (m_pPipeline) {
+        // The analyzers must not be finished before they have seen all chunks
+        m_pPipeline->waitUntilIdle();
+    }
     return AnalysisResult::Finished;
 }
 
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "analyzer/analyzer.h"
+#include "analyzer/analyzerpipeline.h"
 #include "analyzer/analyzerprogress.h"
 #include "preferences/usersettings.h"
 #include "rigtorp/SPSCQueue.h"
@@ -77,6 +79,13 @@ class AnalyzerThread : public WorkerThread {
     // worker thread, yet.
     bool submitNextTrack(TrackPointer nextTrack);
 
+    // Sets the number of threads that run the analyzers while this
+    // thread decodes the audio data. The analyzers run on this thread
+    // if the count is 0. Takes effect with the next track.
+    void setPipelineStageCount(int stageCount) {
+        m_pipelineStageCount.store(stageCount);
+    }
+
   signals:
     // Use a single signal for progress updates to ensure that all signals
     // are queued and received in the same order as emitted from the internal
@@ -110,6 +119,8 @@ class AnalyzerThread : public WorkerThread {
     // for this purpose, which will become available in C++20.
     rigtorp::SPSCQueue<TrackPointer> m_nextTrack;
 
+    std::atomic<int> m_pipelineStageCount;
+
     /////////////////////////////////////////////////////////////////////////
     // Thread local: Only used in the constructor/destructor and within
     // run() by the worker thread.
@@ -118,6 +129,8 @@ class AnalyzerThread : public WorkerThread {
 
     mixxx::SampleBuffer m_sampleBuffer;
 
+    std::unique_ptr<AnalyzerPipeline> m_pPipeline;
+
     TrackPointer m_currentTrack;
 
     AnalyzerThreadState m_emittedState;
@@ -132,6 +145,9 @@ class AnalyzerThread : public WorkerThread {
     AnalysisResult analyzeAudioSource(
             const mixxx::AudioSourcePointer& audioSource);
 
+    // Creates, replaces, or destroys the pipeline as requested
+    void updatePipeline();
+
     // Blocks the worker thread until a next track becomes available
     TrackPointer receiveNextTrack();
 
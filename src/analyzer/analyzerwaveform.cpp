@@ -77,6 +77,13 @@ bool AnalyzerWaveform::initialize(TrackPointer tio,
     m_currentStride = 0;
     m_currentSummaryStride = 0;
 
+    const QString pendingPath = m_analysisDao.getPendingWaveformPath(
+            tio->getId(), AnalysisDao::TYPE_WAVEFORM);
+    if (!pendingPath.isEmpty()) {
+        // Otherwise the whole waveform is written when storing the results
+        m_waveformWriter.open(pendingPath, *m_waveform);
+    }
+
     //debug
     //m_waveform->dump();
     //m_waveformSummary->dump();
@@ -112,7 +119,11 @@ bool AnalyzerWaveform::shouldAnalyze(TrackPointer tio) const {
                 if (missingWaveform && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveform = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWaveform = false;
+                    if (pLoadedTrackWaveform) {
+                        missingWaveform = false;
+                    } else {
+                        m_analysisDao.deleteAnalysis(analysis.analysisId);
+                    }
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_analysisDao.deleteAnalysis(analysis.analysisId);
@@ -123,7 +134,11 @@ bool AnalyzerWaveform::shouldAnalyze(TrackPointer tio) const {
                 if (missingWavesummary && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveformSummary = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWavesummary = false;
+                    if (pLoadedTrackWaveformSummary) {
+                        missingWavesummary = false;
+                    } else {
+                        m_analysisDao.deleteAnalysis(analysis.analysisId);
+                    }
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_analysisDao.deleteAnalysis(analysis.analysisId);
@@ -252,12 +267,17 @@ bool AnalyzerWaveform::processSamples(const CSAMPLE* buffer, const int bufferLen
         }
     }
 
+    if (m_waveformWriter.isOpen()) {
+        m_waveformWriter.write(*m_waveform, m_currentStride);
+    }
+
     //kLogger.debug() << "process - m_waveform->getCompletion()" << m_waveform->getCompletion() << "off" << m_waveform->getDataSize();
     //kLogger.debug() << "process - m_waveformSummary->getCompletion()" << m_waveformSummary->getCompletion() << "off" << m_waveformSummary->getDataSize();
     return true;
 }
 
 void AnalyzerWaveform::cleanup() {
+    m_waveformWriter.abort();
     m_waveform.clear();
     m_waveformData = nullptr;
     m_waveformSummary.clear();
@@ -271,6 +291,9 @@ void AnalyzerWaveform::storeResults(TrackPointer tio) {
         m_waveform->setCompletion(m_waveform->getDataSize());
         m_waveform->setVersion(WaveformFactory::currentWaveformVersion());
         m_waveform->setDescription(WaveformFactory::currentWaveformDescription());
+        if (m_waveformWriter.isOpen()) {
+            m_waveformWriter.finish(*m_waveform);
+        }
     }
     tio->setWaveform(m_waveform);
 
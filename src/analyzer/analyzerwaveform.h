@@ -9,6 +9,7 @@
 #include "library/dao/analysisdao.h"
 #include "util/performancetimer.h"
 #include "waveform/waveform.h"
+#include "waveform/waveformblockfile.h"
 
 //NOTS vrince some test to segment sound, to apply color in the waveform
 //#define TEST_HEAT_MAP
@@ -161,6 +162,9 @@ class AnalyzerWaveform : public Analyzer {
 
     WaveformPointer m_waveform;
     WaveformPointer m_waveformSummary;
+    // Stores the blocks of the waveform that have been completed while
+    // the analysis is still running.
+    WaveformBlockFileWriter m_waveformWriter;
     WaveformData* m_waveformData;
     WaveformData* m_waveformSummaryData;
 
@@ -0,0 +1,92 @@
+#include "analyzer/trackanalysisautoscaler.h"
+
+#include "util/assert.h"
+#include "util/math.h"
+
+namespace {
+
+// More stages would exceed the number of analyzers that are usually active
+constexpr int kMaxPipelineStageCount = 3;
+
+// A window must contain enough tracks per worker and last long enough to
+// even out differences between individual tracks
+constexpr int kMinWindowTracksPerWorker = 2;
+constexpr std::chrono::seconds kMinWindowDuration(5);
+
+// Fewer workers are preferred if they are not significantly slower
+constexpr double kThroughputTolerance = 0.05;
+
+} // anonymous namespace
+
+TrackAnalysisAutoscaler::TrackAnalysisAutoscaler(
+        int maxWorkerCount,
+        int coreCount,
+        Clock::time_point startTime)
+        : m_maxWorkerCount(math_max(1, maxWorkerCount)),
+          m_coreCount(math_max(1, coreCount)),
+          m_workerCount(m_maxWorkerCount),
+          m_settled(m_maxWorkerCount == 1),
+          m_bestThroughput(0),
+          m_bestWorkerCount(m_maxWorkerCount),
+          // The first tracks need to warm up the disk cache
+          m_skipWindow(true),
+          m_windowStart(startTime),
+          m_windowTrackCount(0),
+          m_windowAudioSeconds(0) {
+}
+
+int TrackAnalysisAutoscaler::pipelineStageCount() const {
+    // The worker thread decodes while the stages analyze
+    return math_clamp(m_coreCount / m_workerCount - 1, 0, kMaxPipelineStageCount);
+}
+
+void TrackAnalysisAutoscaler::changeWorkerCount(int workerCount) {
+    DEBUG_ASSERT(workerCount >= 1);
+    DEBUG_ASSERT(workerCount <= m_maxWorkerCount);
+    m_workerCount = workerCount;
+    m_skipWindow = true;
+}
+
+bool TrackAnalysisAutoscaler::trackFinished(
+        double audioDurationSeconds, Clock::time_point now) {
+    if (m_settled) {
+        return false;
+    }
+    ++m_windowTrackCount;
+    if (audioDurationSeconds > 0) {
+        m_windowAudioSeconds += audioDurationSeconds;
+    }
+    const auto windowDuration = now - m_windowStart;
+    if (m_windowTrackCount < kMinWindowTracksPerWorker * m_workerCount ||
+            windowDuration < kMinWindowDuration) {
+        return false;
+    }
+    const double throughput = m_windowAudioSeconds /
+            std::chrono::duration<double>(windowDuration).count();
+    m_windowStart = now;
+    m_windowTrackCount = 0;
+    m_windowAudioSeconds = 0;
+    if (m_skipWindow) {
+        m_skipWindow = false;
+        return false;
+    }
+
+    if (m_bestThroughput > 0 &&
+            throughput < m_bestThroughput * (1 - kThroughputTolerance)) {
+        // Too few workers, go back to the best configuration
+        m_settled = true;
+        if (m_workerCount == m_bestWorkerCount) {
+            return false;
+        }
+        changeWorkerCount(m_bestWorkerCount);
+        return true;
+    }
+    m_bestThroughput = math_max(m_bestThroughput, throughput);
+    m_bestWorkerCount = m_workerCount;
+    if (m_workerCount == 1) {
+        m_settled = true;
+        return false;
+    }
+    changeWorkerCount(m_workerCount - 1);
+    return true;
+}
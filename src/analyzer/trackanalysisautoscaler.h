@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+
+/// Decides how many worker threads of the TrackAnalysisScheduler are
+/// analyzing tracks concurrently and how many pipeline stages each of
+/// them uses.
+///
+/// The analysis starts with all workers and the throughput, i.e. seconds
+/// of audio per second, is measured over windows of finished tracks.
+/// Whenever the throughput with fewer workers does not drop, the number
+/// of workers is reduced further. Fewer workers need less disk bandwidth
+/// and free cores that are then used for pipelining the analyzers of
+/// each track. The first reduction that slows down the analysis is
+/// reverted and the number of workers stays fixed afterwards.
+///
+/// All functions must be invoked from the same thread.
+class TrackAnalysisAutoscaler {
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    TrackAnalysisAutoscaler(
+            int maxWorkerCount,
+            int coreCount,
+            Clock::time_point startTime);
+
+    int workerCount() const {
+        return m_workerCount;
+    }
+
+    /// The number of pipeline stages for each worker, 0 if the analyzers
+    /// should run on the worker thread.
+    int pipelineStageCount() const;
+
+    bool isSettled() const {
+        return m_settled;
+    }
+
+    /// Accounts a finished track. Returns true if the number of workers
+    /// has changed.
+    bool trackFinished(double audioDurationSeconds, Clock::time_point now);
+
+  private:
+    void changeWorkerCount(int workerCount);
+
+    const int m_maxWorkerCount;
+    const int m_coreCount;
+    int m_workerCount;
+    bool m_settled;
+
+    // The best throughput so far and the corresponding number of workers
+    double m_bestThroughput;
+    int m_bestWorkerCount;
+
+    // The first window after a change still contains tracks that have
+    // been analyzed with the previous number of workers
+    bool m_skipWindow;
+    Clock::time_point m_windowStart;
+    int m_windowTrackCount;
+    double m_windowAudioSeconds;
+};
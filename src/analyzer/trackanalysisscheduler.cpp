@@ -54,6 +54,7 @@ TrackAnalysisScheduler::TrackAnalysisScheduler(
           m_currentTrackProgress(kAnalyzerProgressUnknown),
           m_currentTrackNumber(0),
           m_dequeuedTracksCount(0),
+          m_autoscaler(numWorkerThreads, QThread::idealThreadCount(), Clock::now()),
           // The first signal should always be emitted
           m_lastProgressEmittedAt(Clock::now() - kProgressInhibitDuration) {
     DEBUG_ASSERT(m_pEnvironment);
@@ -81,6 +82,7 @@ TrackAnalysisScheduler::TrackAnalysisScheduler(
                 this,
                 &TrackAnalysisScheduler::onWorkerThreadProgress);
     }
+    applyActiveWorkerCount();
     // 2nd pass: Start worker threads in a suspended state
     for (const auto& worker: m_workers) {
         worker.thread()->suspend();
@@ -110,10 +112,10 @@ void TrackAnalysisScheduler::emitProgressOrFinished() {
     }
     m_lastProgressEmittedAt = now;
 
-    DEBUG_ASSERT(m_pendingTrackIds.size() <=
+    DEBUG_ASSERT(m_pendingTracks.size() <=
             static_cast<size_t>(m_dequeuedTracksCount));
     const int finishedTracksCount =
-            m_dequeuedTracksCount - static_cast<int>(m_pendingTrackIds.size());
+            m_dequeuedTracksCount - static_cast<int>(m_pendingTracks.size());
 
     AnalyzerProgress workerProgressSum = 0;
     int workerProgressCount = 0;
@@ -199,12 +201,15 @@ void TrackAnalysisScheduler::onWorkerThreadProgress(
         DEBUG_ASSERT(!trackId.isValid());
         DEBUG_ASSERT(analyzerProgress == kAnalyzerProgressUnknown);
         worker.onAnalyzerProgress(analyzerProgress);
-        submitNextTrack(&worker);
+        worker.onThreadIdle();
+        if (threadId < m_autoscaler.workerCount()) {
+            submitNextTrack(&worker);
+        }
         break;
     case AnalyzerThreadState::Busy:
         DEBUG_ASSERT(trackId.isValid());
         // Ignore delayed signals for tracks that are no longer pending
-        if (m_pendingTrackIds.find(trackId) != m_pendingTrackIds.end()) {
+        if (m_pendingTracks.find(trackId) != m_pendingTracks.end()) {
             DEBUG_ASSERT(analyzerProgress != kAnalyzerProgressUnknown);
             DEBUG_ASSERT(analyzerProgress < kAnalyzerProgressDone);
             worker.onAnalyzerProgress(analyzerProgress);
@@ -214,12 +219,19 @@ void TrackAnalysisScheduler::onWorkerThreadProgress(
     case AnalyzerThreadState::Done:
         DEBUG_ASSERT(trackId.isValid());
         // Ignore delayed signals for tracks that are no longer pending
-        if (m_pendingTrackIds.find(trackId) != m_pendingTrackIds.end()) {
+        if (const auto pendingTrack = m_pendingTracks.find(trackId);
+                pendingTrack != m_pendingTracks.end()) {
             DEBUG_ASSERT((analyzerProgress == kAnalyzerProgressDone) // success
                     || (analyzerProgress == kAnalyzerProgressUnknown)); // failure
-            m_pendingTrackIds.erase(trackId);
+            const double durationSeconds = pendingTrack->second;
+            m_pendingTracks.erase(pendingTrack);
             worker.onAnalyzerProgress(analyzerProgress);
             emit trackProgress(trackId, analyzerProgress);
+            // Failed tracks don't tell anything about the throughput
+            if (analyzerProgress == kAnalyzerProgressDone &&
+                    m_autoscaler.trackFinished(durationSeconds, Clock::now())) {
+                applyActiveWorkerCount();
+            }
         }
         break;
     case AnalyzerThreadState::Exit:
@@ -282,7 +294,8 @@ bool TrackAnalysisScheduler::submitNextTrack(Worker* worker) {
             TrackPointer nextTrack =
                     m_pEnvironment->loadTrackById(nextTrackId);
             if (nextTrack) {
-                if (m_pendingTrackIds.insert(nextTrackId).second) {
+                const double durationSeconds = nextTrack->getDuration();
+                if (m_pendingTracks.emplace(nextTrackId, durationSeconds).second) {
                     if (worker->submitNextTrack(std::move(nextTrack))) {
                         m_queuedTrackIds.pop_front();
                         ++m_dequeuedTracksCount;
@@ -290,7 +303,7 @@ bool TrackAnalysisScheduler::submitNextTrack(Worker* worker) {
                     } else {
                         // The worker may already have been assigned new tasks
                         // in the mean time, nothing to worry about.
-                        m_pendingTrackIds.erase(nextTrackId);
+                        m_pendingTracks.erase(nextTrackId);
                         kLogger.debug()
                                 << "Failed to submit next track - worker thread"
                                 << worker->thread()->id()
@@ -321,6 +334,26 @@ bool TrackAnalysisScheduler::submitNextTrack(Worker* worker) {
     return false;
 }
 
+void TrackAnalysisScheduler::applyActiveWorkerCount() {
+    const int workerCount = m_autoscaler.workerCount();
+    // Cores that are not occupied by workers are used for pipelining
+    const int pipelineStageCount = m_autoscaler.pipelineStageCount();
+    kLogger.debug()
+            << "Analyzing with"
+            << workerCount
+            << "workers and"
+            << pipelineStageCount
+            << "pipeline stages per worker";
+    for (int threadId = 0; threadId < static_cast<int>(m_workers.size()); ++threadId) {
+        auto& worker = m_workers[threadId];
+        worker.setPipelineStageCount(pipelineStageCount);
+        // Idle workers would not ask for the next track again
+        if (threadId < workerCount && worker && worker.isIdle()) {
+            submitNextTrack(&worker);
+        }
+    }
+}
+
 void TrackAnalysisScheduler::stop() {
     kLogger.debug() << "Stopping";
     for (auto& worker: m_workers) {
@@ -329,6 +362,6 @@ void TrackAnalysisScheduler::stop() {
     // The worker threads are still running at this point
     // and m_workers must not be modified!
     m_queuedTrackIds.clear();
-    m_pendingTrackIds.clear();
+    m_pendingTracks.clear();
     DEBUG_ASSERT((allTracksFinished()));
 }
@@ -2,11 +2,12 @@
 
 #include <QList>
 #include <deque>
+#include <map>
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "analyzer/analyzerthread.h"
+#include "analyzer/trackanalysisautoscaler.h"
 #include "util/db/dbconnectionpool.h"
 
 /// Callbacks for triggering side-effects in the outer context of
@@ -81,7 +82,8 @@ class TrackAnalysisScheduler : public QObject {
       public:
         explicit Worker(AnalyzerThread::Pointer thread = AnalyzerThread::NullPointer())
             : m_thread(std::move(thread)),
-              m_analyzerProgress(kAnalyzerProgressUnknown) {
+              m_analyzerProgress(kAnalyzerProgressUnknown),
+              m_idle(false) {
         }
         Worker(const Worker&) = delete;
         Worker(Worker&&) = default;
@@ -99,10 +101,25 @@ class TrackAnalysisScheduler : public QObject {
             return m_analyzerProgress;
         }
 
+        // The thread is waiting for the next track
+        bool isIdle() const {
+            return m_idle;
+        }
+
         bool submitNextTrack(TrackPointer track) {
             DEBUG_ASSERT(track);
             DEBUG_ASSERT(m_thread);
-            return m_thread->submitNextTrack(std::move(track));
+            if (!m_thread->submitNextTrack(std::move(track))) {
+                return false;
+            }
+            m_idle = false;
+            return true;
+        }
+
+        void setPipelineStageCount(int stageCount) {
+            if (m_thread) {
+                m_thread->setPipelineStageCount(stageCount);
+            }
         }
 
         void suspendThread() {
@@ -128,23 +145,33 @@ class TrackAnalysisScheduler : public QObject {
             m_analyzerProgress = analyzerProgress;
         }
 
+        void onThreadIdle() {
+            DEBUG_ASSERT(m_thread);
+            m_idle = true;
+        }
+
         void onThreadExit() {
             DEBUG_ASSERT(m_thread);
             m_thread.reset();
             m_analyzerProgress = kAnalyzerProgressUnknown;
+            m_idle = false;
         }
 
       private:
         AnalyzerThread::Pointer m_thread;
         AnalyzerProgress m_analyzerProgress;
+        bool m_idle;
     };
 
     bool submitNextTrack(Worker* worker);
     void emitProgressOrFinished();
 
+    // Only the first workers receive tracks, see TrackAnalysisAutoscaler
+    void applyActiveWorkerCount();
+
     bool allTracksFinished() const {
         return m_queuedTrackIds.empty() &&
-                m_pendingTrackIds.empty();
+                m_pendingTracks.empty();
     }
 
     const std::unique_ptr<const TrackAnalysisSchedulerEnvironment> m_pEnvironment;
@@ -154,8 +181,11 @@ class TrackAnalysisScheduler : public QObject {
     std::deque<TrackId> m_queuedTrackIds;
 
     // Tracks that have already been submitted to workers
-    // and not yet reported back as finished.
-    std::set<TrackId> m_pendingTrackIds;
+    // and not yet reported back as finished, with the duration
+    // of their audio in seconds.
+    std::map<TrackId, double> m_pendingTracks;
+
+    TrackAnalysisAutoscaler m_autoscaler;
 
     AnalyzerProgress m_currentTrackProgress;
 
@@ -24,7 +24,8 @@ BroadcastManager::BroadcastManager(SettingsManager* pSettingsManager,
                                    SoundManager* pSoundManager)
         : m_pConfig(pSettingsManager->settings()),
           m_pBroadcastSettings(pSettingsManager->broadcastSettings()),
-          m_pNetworkStream(pSoundManager->getNetworkStream()) {
+          m_pNetworkStream(pSoundManager->getNetworkStream()),
+          m_pEncoderFanOuts(EncoderFanOutPoolPtr::create(m_pNetworkStream)) {
     const bool persist = true;
     m_pBroadcastEnabled = new ControlPushButton(
             ConfigKey(BROADCAST_PREF_KEY,"enabled"), persist);
@@ -137,17 +138,13 @@ void BroadcastManager::slotProfileRemoved(BroadcastProfilePtr profile) {
 }
 
 void BroadcastManager::slotProfilesChanged() {
-    QVector<NetworkOutputStreamWorkerPtr> workers = m_pNetworkStream->outputWorkers();
-    for (const NetworkOutputStreamWorkerPtr& pWorker : workers) {
-        ShoutConnectionPtr connection = qSharedPointerCast<ShoutConnection>(pWorker);
-        if (connection) {
-            BroadcastProfilePtr profile = connection->profile();
-            if (profile->connectionStatus() == BroadcastProfile::STATUS_FAILURE
-                    && !profile->getEnabled()) {
-                profile->setConnectionStatus(BroadcastProfile::STATUS_UNCONNECTED);
-            }
-            connection->applySettings();
+    for (const ShoutConnectionPtr& connection : std::as_const(m_connections)) {
+        BroadcastProfilePtr profile = connection->profile();
+        if (profile->connectionStatus() == BroadcastProfile::STATUS_FAILURE
+                && !profile->getEnabled()) {
+            profile->setConnectionStatus(BroadcastProfile::STATUS_UNCONNECTED);
         }
+        connection->applySettings();
     }
 }
 
@@ -160,8 +157,14 @@ bool BroadcastManager::addConnection(BroadcastProfilePtr profile) {
         return false;
     }
 
-    ShoutConnectionPtr connection(new ShoutConnection(profile, m_pConfig));
-    m_pNetworkStream->addOutputWorker(connection);
+    if (m_connections.size() >= BROADCAST_MAX_CONNECTIONS) {
+        kLogger.warning() << "addConnection: can't add connection:"
+                          << "no free slot left";
+        return false;
+    }
+
+    ShoutConnectionPtr connection(new ShoutConnection(profile, m_pConfig, m_pEncoderFanOuts));
+    m_connections.append(connection);
 
     connect(profile.data(),
             &BroadcastProfile::connectionStatusChanged,
@@ -187,7 +190,7 @@ bool BroadcastManager::removeConnection(BroadcastProfilePtr profile) {
 
         // Disabling the profile tells ShoutOutput's thread to disconnect
         connection->profile()->setEnabled(false);
-        m_pNetworkStream->removeOutputWorker(connection);
+        m_connections.removeOne(connection);
 
         kLogger.debug() << "removeConnection: removed connection for profile"
                         << profile->getProfileName();
@@ -198,13 +201,7 @@ bool BroadcastManager::removeConnection(BroadcastProfilePtr profile) {
 }
 
 ShoutConnectionPtr BroadcastManager::findConnectionForProfile(BroadcastProfilePtr profile) {
-    QVector<NetworkOutputStreamWorkerPtr> workers = m_pNetworkStream->outputWorkers();
-    for (const NetworkOutputStreamWorkerPtr& pWorker : workers) {
-        ShoutConnectionPtr connection = qSharedPointerCast<ShoutConnection>(pWorker);
-        if (connection.isNull()) {
-            continue;
-        }
-
+    for (const ShoutConnectionPtr& connection : std::as_const(m_connections)) {
         if (connection->profile() == profile) {
             return connection;
         }
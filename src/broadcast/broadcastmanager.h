@@ -4,6 +4,7 @@
 
 #include "preferences/settingsmanager.h"
 #include "preferences/usersettings.h"
+#include "engine/sidechain/encoderfanout.h"
 #include "engine/sidechain/enginenetworkstream.h"
 #include "engine/sidechain/shoutconnection.h"
 
@@ -51,6 +52,9 @@ class BroadcastManager : public QObject {
     UserSettingsPointer m_pConfig;
     BroadcastSettingsPointer m_pBroadcastSettings;
     QSharedPointer<EngineNetworkStream> m_pNetworkStream;
+    // Connections with the same encoder settings share the encoder
+    EncoderFanOutPoolPtr m_pEncoderFanOuts;
+    QList<ShoutConnectionPtr> m_connections;
 
     ControlPushButton* m_pBroadcastEnabled;
     ControlObject* m_pStatusCO;
@@ -1,5 +1,6 @@
 #include "control/control.h"
 
+#include "control/controlchangejournal.h"
 #include "control/controlobject.h"
 #include "moc_control.cpp"
 #include "util/stat.h"
@@ -277,6 +278,10 @@ void ControlDoublePrivate::setInner(double value, QObject* pSender) {
         return;
     }
     m_value.setValue(value);
+    ControlChangeJournal* pJournal = m_pJournal.loadAcquire();
+    if (pJournal) {
+        pJournal->record(this, value);
+    }
     emit valueChanged(value, pSender);
 
     if (m_bTrack) {
@@ -11,6 +11,7 @@
 #include "preferences/usersettings.h"
 #include "util/mutex.h"
 
+class ControlChangeJournal;
 class ControlObject;
 
 enum class ControlFlag {
@@ -148,6 +149,16 @@ class ControlDoublePrivate : public QObject {
         return m_confirmRequired;
     }
 
+    // Records all further changes in the journal. Returns false if the
+    // control is already journaled by another journal.
+    bool attachJournal(ControlChangeJournal* pJournal) {
+        return m_pJournal.testAndSetOrdered(nullptr, pJournal) ||
+                m_pJournal.loadAcquire() == pJournal;
+    }
+    void detachJournal(ControlChangeJournal* pJournal) {
+        m_pJournal.testAndSetOrdered(pJournal, nullptr);
+    }
+
   signals:
     // Emitted when the ControlDoublePrivate value changes. pSender is a
     // pointer to the setter of the value (potentially NULL).
@@ -204,6 +215,9 @@ class ControlDoublePrivate : public QObject {
     ControlValueAtomic<double> m_defaultValue;
 
     QSharedPointer<ControlNumericBehavior> m_pBehavior;
+
+    // The journal that observes this control, if any
+    QAtomicPointer<ControlChangeJournal> m_pJournal;
 };
 
 /// The constant ControlDoublePrivate version is used as dummy for default
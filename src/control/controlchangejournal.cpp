@@ -0,0 +1,205 @@
+#include "control/controlchangejournal.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "control/control.h"
+#include "moc_controlchangejournal.cpp"
+#include "util/assert.h"
+#include "util/compatibility/qatomic.h"
+#include "util/compatibility/qmutex.h"
+
+namespace {
+
+// The number of changes a single thread can record between two drains.
+// If the ring is full, all subscriptions are updated with the current
+// control values on the next drain.
+constexpr std::size_t kPipeCapacity = 1024;
+
+QAtomicInt s_guiJournalEnabled;
+
+} // anonymous namespace
+
+ControlJournalSubscription::ControlJournalSubscription(
+        ControlChangeJournal* pJournal,
+        QSharedPointer<ControlDoublePrivate> pControl,
+        QObject* pParent)
+        : QObject(pParent),
+          m_pJournal(pJournal),
+          m_pControl(std::move(pControl)),
+          m_key(m_pControl->getKey()),
+          m_pendingValue(0.0),
+          m_pending(false) {
+}
+
+ControlJournalSubscription::~ControlJournalSubscription() {
+    if (m_pJournal) {
+        m_pJournal->unsubscribe(this);
+    }
+}
+
+ControlChangeJournal::Pipe::Pipe()
+        : m_queue(kPipeCapacity) {
+}
+
+ControlChangeJournal::ControlChangeJournal()
+        : m_numSubscriptions(0) {
+}
+
+ControlChangeJournal::~ControlChangeJournal() {
+    for (auto it = m_subscriptions.constBegin(); it != m_subscriptions.constEnd(); ++it) {
+        it.key()->detachJournal(this);
+        for (auto* pSubscription : it.value()) {
+            pSubscription->m_pJournal = nullptr;
+        }
+    }
+}
+
+// static
+ControlChangeJournal* ControlChangeJournal::guiJournalInstance() {
+    // Intentionally leaked. The engine and controller threads may still set
+    // controls while the GUI is shut down.
+    static auto* const s_pGuiJournal = new ControlChangeJournal();
+    return s_pGuiJournal;
+}
+
+// static
+ControlChangeJournal* ControlChangeJournal::guiJournal() {
+    if (!atomicLoadRelaxed(s_guiJournalEnabled)) {
+        return nullptr;
+    }
+    return guiJournalInstance();
+}
+
+// static
+void ControlChangeJournal::registerGuiJournalThread() {
+    guiJournalInstance()->registerThread();
+}
+
+// static
+void ControlChangeJournal::setGuiJournalEnabled(bool enabled) {
+    s_guiJournalEnabled.storeRelease(enabled ? 1 : 0);
+}
+
+ControlJournalSubscription* ControlChangeJournal::subscribe(
+        const ConfigKey& key, QObject* pParent) {
+    QSharedPointer<ControlDoublePrivate> pControl =
+            ControlDoublePrivate::getControl(key, ControlFlag::NoAssertIfMissing);
+    if (!pControl || !pControl->attachJournal(this)) {
+        return nullptr;
+    }
+    auto* pSubscription = new ControlJournalSubscription(this, pControl, pParent);
+    m_subscriptions[pControl.data()].append(pSubscription);
+    ++m_numSubscriptions;
+    m_pendingSubscriptions.reserve(m_numSubscriptions);
+    return pSubscription;
+}
+
+void ControlChangeJournal::unsubscribe(ControlJournalSubscription* pSubscription) {
+    ControlDoublePrivate* pControl = pSubscription->m_pControl.data();
+    auto it = m_subscriptions.find(pControl);
+    VERIFY_OR_DEBUG_ASSERT(it != m_subscriptions.end()) {
+        return;
+    }
+    it.value().removeOne(pSubscription);
+    --m_numSubscriptions;
+    if (it.value().isEmpty()) {
+        m_subscriptions.erase(it);
+        pControl->detachJournal(this);
+    }
+    // The subscription might be deleted by a receiver while draining
+    if (pSubscription->m_pending) {
+        std::replace(m_pendingSubscriptions.begin(),
+                m_pendingSubscriptions.end(),
+                pSubscription,
+                static_cast<ControlJournalSubscription*>(nullptr));
+    }
+    pSubscription->m_pJournal = nullptr;
+}
+
+ControlChangeJournal::Pipe* ControlChangeJournal::pipeForThread() {
+    // Only allocates for threads that have not called registerThread()
+    if (m_threadPipes.hasLocalData()) {
+        return m_threadPipes.localData().get();
+    }
+    auto pPipe = std::make_shared<Pipe>();
+    m_threadPipes.setLocalData(pPipe);
+    const auto locker = lockMutex(&m_pipesMutex);
+    m_pipes.append(pPipe);
+    return pPipe.get();
+}
+
+void ControlChangeJournal::record(ControlDoublePrivate* pControl, double value) {
+    Pipe* pPipe = pipeForThread();
+    if (!pPipe->m_queue.try_push(Change{pControl, value})) {
+        pPipe->m_overflow.storeRelease(1);
+    }
+}
+
+void ControlChangeJournal::markPending(
+        ControlJournalSubscription* pSubscription, double value) {
+    pSubscription->m_pendingValue = value;
+    if (!pSubscription->m_pending) {
+        pSubscription->m_pending = true;
+        m_pendingSubscriptions.push_back(pSubscription);
+    }
+}
+
+int ControlChangeJournal::drain() {
+    QVector<std::shared_ptr<Pipe>> pipes;
+    {
+        const auto locker = lockMutex(&m_pipesMutex);
+        pipes = m_pipes;
+    }
+
+    bool overflow = false;
+    for (const auto& pPipe : std::as_const(pipes)) {
+        // Reset before reading, changes that are dropped after this point
+        // will be detected by the next drain
+        if (pPipe->m_overflow.fetchAndStoreAcquire(0)) {
+            overflow = true;
+        }
+        while (const Change* pChange = pPipe->m_queue.front()) {
+            const auto it = m_subscriptions.constFind(pChange->pControl);
+            // Changes of controls that have been unsubscribed in the
+            // meantime are skipped
+            if (it != m_subscriptions.constEnd()) {
+                for (auto* pSubscription : it.value()) {
+                    markPending(pSubscription, pChange->value);
+                }
+            }
+            pPipe->m_queue.pop();
+        }
+    }
+    if (overflow) {
+        for (auto it = m_subscriptions.constBegin(); it != m_subscriptions.constEnd(); ++it) {
+            for (auto* pSubscription : it.value()) {
+                markPending(pSubscription, it.key()->get());
+            }
+        }
+    }
+
+    // The signal receivers may subscribe or unsubscribe. New subscriptions
+    // are not pending, unsubscribed ones are replaced by nullptr.
+    int updates = 0;
+    for (std::size_t i = 0; i < m_pendingSubscriptions.size(); ++i) {
+        ControlJournalSubscription* pSubscription = m_pendingSubscriptions[i];
+        if (!pSubscription) {
+            continue;
+        }
+        pSubscription->m_pending = false;
+        emit pSubscription->valueChanged(pSubscription->m_pendingValue);
+        ++updates;
+    }
+    m_pendingSubscriptions.clear();
+
+    // Release the pipes of threads that have finished
+    pipes.clear();
+    const auto locker = lockMutex(&m_pipesMutex);
+    for (int i = m_pipes.size() - 1; i >= 0; --i) {
+        if (m_pipes[i].use_count() == 1 && !m_pipes[i]->m_queue.front()) {
+            m_pipes.remove(i);
+        }
+    }
+    return updates;
+}
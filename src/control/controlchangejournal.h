@@ -0,0 +1,139 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QThreadStorage>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+#include "preferences/configobject.h"
+#include "rigtorp/SPSCQueue.h"
+#include "util/class.h"
+
+class ControlChangeJournal;
+class ControlDoublePrivate;
+
+/// The subscription of an observer to the changes of a single control in a
+/// ControlChangeJournal. valueChanged() is emitted at most once per drain of
+/// the journal, from the thread that drains it. The subscription ends when
+/// the object is deleted.
+class ControlJournalSubscription : public QObject {
+    Q_OBJECT
+  public:
+    ~ControlJournalSubscription() override;
+
+    const ConfigKey& getKey() const {
+        return m_key;
+    }
+
+  signals:
+    void valueChanged(double value);
+
+  private:
+    ControlJournalSubscription(ControlChangeJournal* pJournal,
+            QSharedPointer<ControlDoublePrivate> pControl,
+            QObject* pParent);
+
+    ControlChangeJournal* m_pJournal;
+    const QSharedPointer<ControlDoublePrivate> m_pControl;
+    const ConfigKey m_key;
+
+    // Coalesced value of the current drain
+    double m_pendingValue;
+    bool m_pending;
+
+    friend class ControlChangeJournal;
+};
+
+/// Collects control changes from any number of threads and delivers them
+/// coalesced to the observers in a single consumer thread.
+///
+/// Each thread that sets a subscribed control writes the change into its
+/// own lock-free SPSC ring. The consumer calls drain() once per GUI frame
+/// (or engine callback), which reads all rings and emits a single
+/// valueChanged() per subscription with the latest value. Compared to
+/// queued signal connections this replaces one cross-thread event per set()
+/// by one update per frame, e.g. for jog wheels and meters that controller
+/// scripts update at 1 kHz. The values themselves are still stored in the
+/// control, readers that poll them are not affected.
+///
+/// A control can only be journaled by a single journal at a time. The
+/// valueChanged() signal of the control is emitted as before.
+///
+/// subscribe(), drain() and the destructor must be called from the consumer
+/// thread. The journal must outlive all threads that set journaled controls.
+class ControlChangeJournal {
+  public:
+    ControlChangeJournal();
+    ~ControlChangeJournal();
+
+    /// The journal that is drained in every GUI frame by GuiTick, or nullptr
+    /// if it is disabled.
+    static ControlChangeJournal* guiJournal();
+    static void setGuiJournalEnabled(bool enabled);
+
+    /// Creates the ring of the calling thread in the GUI journal in
+    /// advance, even if the journal is currently disabled. Real-time
+    /// threads call this before they start processing, because creating
+    /// the ring on the first record() allocates and locks a mutex.
+    static void registerGuiJournalThread();
+
+    /// Creates the ring of the calling thread in advance.
+    void registerThread() {
+        pipeForThread();
+    }
+
+    /// Subscribes to the changes of a control. Returns nullptr if the
+    /// control doesn't exist or is already journaled by another journal.
+    /// The subscription is owned by pParent.
+    ControlJournalSubscription* subscribe(const ConfigKey& key, QObject* pParent);
+
+    /// Delivers the latest value of all controls that changed since the
+    /// last drain to their subscriptions. Returns the number of delivered
+    /// updates.
+    int drain();
+
+    /// Called by ControlDoublePrivate from any thread.
+    void record(ControlDoublePrivate* pControl, double value);
+
+  private:
+    struct Change {
+        ControlDoublePrivate* pControl;
+        double value;
+    };
+
+    // The ring of a single producer thread
+    class Pipe {
+      public:
+        Pipe();
+
+        rigtorp::SPSCQueue<Change> m_queue;
+        // Changes have been dropped, all subscriptions need to be updated
+        QAtomicInt m_overflow;
+    };
+
+    static ControlChangeJournal* guiJournalInstance();
+
+    Pipe* pipeForThread();
+    void unsubscribe(ControlJournalSubscription* pSubscription);
+    void markPending(ControlJournalSubscription* pSubscription, double value);
+
+    QThreadStorage<std::shared_ptr<Pipe>> m_threadPipes;
+    QMutex m_pipesMutex;
+    // Shared with the thread storage of the producers. Pipes of threads
+    // that have finished are removed after they have been drained.
+    QVector<std::shared_ptr<Pipe>> m_pipes;
+
+    // Only accessed by the consumer thread
+    QHash<ControlDoublePrivate*, QVector<ControlJournalSubscription*>> m_subscriptions;
+    int m_numSubscriptions;
+    // Reserved for all subscriptions to avoid allocations while draining
+    std::vector<ControlJournalSubscription*> m_pendingSubscriptions;
+
+    friend class ControlJournalSubscription;
+
+    DISALLOW_COPY_AND_ASSIGN(ControlChangeJournal);
+};
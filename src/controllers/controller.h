@@ -153,6 +153,13 @@ class Controller : public QObject {
         return false;
     }
 
+    // Returns the name of the system MIDI port that this device reads its
+    // input from, if any. Where supported, input on that port wakes up the
+    // ControllerManager instead of waiting for the next poll.
+    virtual QString inputPortName() const {
+        return QString();
+    }
+
   private:
     ControllerScriptEngineLegacy* m_pScriptEngineLegacy;
 
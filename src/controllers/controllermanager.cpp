@@ -6,6 +6,9 @@
 #include "controllers/controllerlearningeventfilter.h"
 #include "controllers/defs_controllers.h"
 #include "controllers/midi/portmidienumerator.h"
+#ifdef __ALSASEQ__
+#include "controllers/midi/alsaseqinputnotifier.h"
+#endif
 #include "moc_controllermanager.cpp"
 #include "util/cmdlineargs.h"
 #include "util/compatibility/qmutex.h"
@@ -25,7 +28,8 @@
 
 // http://developer.qt.nokia.com/wiki/Threads_Events_QObjects
 
-// Poll every 1ms (where possible) for good controller response
+// Poll every 1ms (where possible) for good controller response. On Linux
+// MIDI devices are only polled if the ALSA sequencer cannot notify us.
 #ifdef __LINUX__
 // Many Linux distros ship with the system tick set to 250Hz so 1ms timer
 // reportedly causes CPU hosage. See Bug #990992 rryan 6/2012
@@ -35,6 +39,10 @@ const mixxx::Duration ControllerManager::kPollInterval = mixxx::Duration::fromMi
 #endif
 
 namespace {
+/// The number of times the devices are polled again after a wake-up that
+/// did not find any input, each 1 ms later
+constexpr int kMaxInputRetries = 5;
+
 /// Strip slashes and spaces from device name, so that it can be used as config
 /// key or a filename.
 QString sanitizeDeviceName(QString name) {
@@ -87,6 +95,12 @@ ControllerManager::ControllerManager(UserSettingsPointer pConfig)
           // its own event loop.
           m_pControllerLearningEventFilter(new ControllerLearningEventFilter()),
           m_pollTimer(this),
+          m_inputRetryTimer(this),
+          m_inputPending(false),
+          m_inputRetryCount(0),
+#ifdef __ALSASEQ__
+          m_pInputNotifier(nullptr),
+#endif
           m_skipPoll(false) {
     qRegisterMetaType<std::shared_ptr<LegacyControllerMapping>>(
             "std::shared_ptr<LegacyControllerMapping>");
@@ -100,6 +114,12 @@ ControllerManager::ControllerManager(UserSettingsPointer pConfig)
 
     m_pollTimer.setInterval(kPollInterval.toIntegerMillis());
     connect(&m_pollTimer, &QTimer::timeout, this, &ControllerManager::pollDevices);
+    m_inputRetryTimer.setSingleShot(true);
+    m_inputRetryTimer.setInterval(1);
+    connect(&m_inputRetryTimer,
+            &QTimer::timeout,
+            this,
+            &ControllerManager::pollPendingInput);
 
     m_pThread = new QThread;
     m_pThread->setObjectName("Controller");
@@ -156,10 +176,39 @@ void ControllerManager::slotInitialize() {
 #ifdef __HID__
     m_enumerators.append(new HidEnumerator());
 #endif
+
+#ifdef __ALSASEQ__
+    // Needs to be created in this thread for the socket notifier
+    m_pInputNotifier = new AlsaSeqInputNotifier(this);
+    if (m_pInputNotifier->isValid()) {
+        connect(m_pInputNotifier,
+                &AlsaSeqInputNotifier::inputReceived,
+                this,
+                &ControllerManager::slotInputReceived);
+    } else {
+        qWarning() << "Event-driven MIDI input is not available, polling instead";
+        delete m_pInputNotifier;
+        m_pInputNotifier = nullptr;
+    }
+#endif
 }
 
 void ControllerManager::slotShutdown() {
     stopPolling();
+    m_inputRetryTimer.stop();
+    m_inputPending = false;
+#ifdef __ALSASEQ__
+    delete m_pInputNotifier;
+    m_pInputNotifier = nullptr;
+#endif
+    if (m_inputLatency.count() > 0) {
+        qInfo() << "MIDI input latency:"
+                << QStringLiteral("p50 %1, p99 %2, p99.9 %3, max %4")
+                           .arg(m_inputLatency.quantile(0.5).formatMicrosWithUnit(),
+                                   m_inputLatency.quantile(0.99).formatMicrosWithUnit(),
+                                   m_inputLatency.quantile(0.999).formatMicrosWithUnit(),
+                                   m_inputLatency.max().formatMicrosWithUnit());
+    }
 
     // Clear m_enumerators before deleting the enumerators to prevent other code
     // paths from accessing them.
@@ -302,9 +351,27 @@ void ControllerManager::pollIfAnyControllersOpen() {
     QList<Controller*> controllers = m_controllers;
     locker.unlock();
 
+    QSet<QString> watchedPortNames;
+#ifdef __ALSASEQ__
+    if (m_pInputNotifier) {
+        QSet<QString> inputPortNames;
+        for (Controller* pController : controllers) {
+            if (pController->isOpen() && pController->isPolling()) {
+                const QString inputPortName = pController->inputPortName();
+                if (!inputPortName.isEmpty()) {
+                    inputPortNames.insert(inputPortName);
+                }
+            }
+        }
+        watchedPortNames = m_pInputNotifier->setWatchedPorts(inputPortNames);
+    }
+#endif
+
+    // Only devices that do not notify us about their input need polling
     bool shouldPoll = false;
     for (Controller* pController : controllers) {
-        if (pController->isOpen() && pController->isPolling()) {
+        if (pController->isOpen() && pController->isPolling() &&
+                !watchedPortNames.contains(pController->inputPortName())) {
             shouldPoll = true;
         }
     }
@@ -370,6 +437,56 @@ void ControllerManager::pollDevices() {
     //qDebug() << "ControllerManager::pollDevices()" << duration << start;
 }
 
+void ControllerManager::slotInputReceived(mixxx::Duration receivedAt) {
+    if (!m_inputPending || receivedAt < m_pendingInputReceivedAt) {
+        m_pendingInputReceivedAt = receivedAt;
+    }
+    m_inputPending = true;
+    m_inputRetryCount = 0;
+    pollPendingInput();
+}
+
+void ControllerManager::pollPendingInput() {
+    m_inputRetryTimer.stop();
+    const mixxx::Duration start = mixxx::Time::elapsed();
+    // PortMidi reads at most a buffer full of events per poll
+    while (pollInputDevices()) {
+        if (m_inputPending) {
+            m_inputPending = false;
+            m_inputLatency.record(
+                    (mixxx::Time::elapsed() - m_pendingInputReceivedAt).toIntegerNanos());
+        }
+        if (mixxx::Time::elapsed() - start > kPollInterval) {
+            // Like pollDevices(), leave some CPU time to the other threads
+            // if a controller sends more than we are able to handle
+            m_inputRetryTimer.start();
+            return;
+        }
+    }
+    if (!m_inputPending) {
+        return;
+    }
+    // The sequencer might not have delivered the input to PortMidi yet
+    // when it woke us up
+    if (++m_inputRetryCount <= kMaxInputRetries) {
+        m_inputRetryTimer.start();
+        return;
+    }
+    // PortMidi filters some messages like active sensing, which are
+    // still received by the sequencer
+    m_inputPending = false;
+}
+
+bool ControllerManager::pollInputDevices() {
+    bool handled = false;
+    for (Controller* pDevice : qAsConst(m_controllers)) {
+        if (pDevice->isOpen() && pDevice->isPolling()) {
+            handled = pDevice->poll() || handled;
+        }
+    }
+    return handled;
+}
+
 void ControllerManager::openController(Controller* pController) {
     if (!pController) {
         return;
@@ -9,8 +9,10 @@
 #include "controllers/controllermappinginfoenumerator.h"
 #include "controllers/legacycontrollermapping.h"
 #include "preferences/usersettings.h"
+#include "util/histogram.h"
 
 // Forward declaration(s)
+class AlsaSeqInputNotifier;
 class Controller;
 class ControllerLearningEventFilter;
 
@@ -68,14 +70,37 @@ class ControllerManager : public QObject {
     void slotShutdown();
     /// Calls poll() on all devices that have isPolling() true.
     void pollDevices();
+    /// Called when input has arrived on a watched MIDI port. Polls the
+    /// devices and records the latency from receivedAt.
+    void slotInputReceived(mixxx::Duration receivedAt);
+    /// Polls the devices until none of them has any input left. Retries
+    /// shortly afterwards if the pending input has not been found yet or
+    /// if draining the input took too long.
+    void pollPendingInput();
     void startPolling();
     void stopPolling();
     void pollIfAnyControllersOpen();
 
   private:
+    /// Polls all devices once. Returns true if any of them had input.
+    bool pollInputDevices();
+
     UserSettingsPointer m_pConfig;
     ControllerLearningEventFilter* m_pControllerLearningEventFilter;
     QTimer m_pollTimer;
+    /// Polls again shortly after a wake-up that did not find any input
+    /// or that did not drain all of it
+    QTimer m_inputRetryTimer;
+    /// Set on a wake-up until the input has been found or given up on
+    bool m_inputPending;
+    int m_inputRetryCount;
+    mixxx::Duration m_pendingInputReceivedAt;
+#ifdef __ALSASEQ__
+    AlsaSeqInputNotifier* m_pInputNotifier;
+#endif
+    /// From the arrival of the input on a watched port until the devices
+    /// have been polled and the input has been passed to the scripts
+    mixxx::Histogram m_inputLatency;
     mutable QMutex m_mutex;
     QList<ControllerEnumerator*> m_enumerators;
     QList<Controller*> m_controllers;
@@ -0,0 +1,213 @@
+#include "controllers/midi/alsaseqinputnotifier.h"
+
+#include <QSocketNotifier>
+#include <algorithm>
+
+#include "moc_alsaseqinputnotifier.cpp"
+#include "util/logger.h"
+#include "util/time.h"
+
+namespace {
+
+const mixxx::Logger kLogger("AlsaSeqInputNotifier");
+
+constexpr qint64 kNanosPerSecond = 1000000000;
+
+bool containsAddress(const std::vector<snd_seq_addr_t>& addresses,
+        const snd_seq_addr_t& address) {
+    return std::any_of(addresses.begin(),
+            addresses.end(),
+            [&address](const snd_seq_addr_t& other) {
+                return other.client == address.client && other.port == address.port;
+            });
+}
+
+qint64 toNanos(const snd_seq_real_time_t& time) {
+    return static_cast<qint64>(time.tv_sec) * kNanosPerSecond + time.tv_nsec;
+}
+
+} // anonymous namespace
+
+AlsaSeqInputNotifier::AlsaSeqInputNotifier(QObject* pParent)
+        : QObject(pParent),
+          m_pSeq(nullptr),
+          m_address{0, 0},
+          m_queue(-1),
+          m_pSocketNotifier(nullptr) {
+    // Duplex, because starting the queue needs to send an event
+    int result = snd_seq_open(&m_pSeq, "default", SND_SEQ_OPEN_DUPLEX, SND_SEQ_NONBLOCK);
+    if (result < 0) {
+        kLogger.warning() << "Failed to open the ALSA sequencer:" << snd_strerror(result);
+        m_pSeq = nullptr;
+        return;
+    }
+    snd_seq_set_client_name(m_pSeq, "Mixxx Input Monitor");
+
+    // Only we may subscribe to the port. Without SND_SEQ_PORT_CAP_SUBS_WRITE
+    // it is not listed as a MIDI output by PortMidi either.
+    const int port = snd_seq_create_simple_port(m_pSeq,
+            "Input Monitor",
+            SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_NO_EXPORT,
+            SND_SEQ_PORT_TYPE_APPLICATION);
+    // The queue timestamps the incoming events
+    m_queue = snd_seq_alloc_queue(m_pSeq);
+    struct pollfd pollDescriptor;
+    if (port < 0 || m_queue < 0 ||
+            snd_seq_start_queue(m_pSeq, m_queue, nullptr) < 0 ||
+            snd_seq_drain_output(m_pSeq) < 0 ||
+            snd_seq_poll_descriptors(m_pSeq, &pollDescriptor, 1, POLLIN) != 1) {
+        kLogger.warning() << "Failed to set up the ALSA sequencer client";
+        snd_seq_close(m_pSeq);
+        m_pSeq = nullptr;
+        return;
+    }
+    m_address.client = static_cast<unsigned char>(snd_seq_client_id(m_pSeq));
+    m_address.port = static_cast<unsigned char>(port);
+
+    m_pSocketNotifier = new QSocketNotifier(pollDescriptor.fd, QSocketNotifier::Read, this);
+    connect(m_pSocketNotifier,
+            &QSocketNotifier::activated,
+            this,
+            &AlsaSeqInputNotifier::slotReadEvents);
+}
+
+AlsaSeqInputNotifier::~AlsaSeqInputNotifier() {
+    if (!m_pSeq) {
+        return;
+    }
+    delete m_pSocketNotifier;
+    // Also removes all subscriptions and the queue
+    snd_seq_close(m_pSeq);
+}
+
+QSet<QString> AlsaSeqInputNotifier::setWatchedPorts(const QSet<QString>& portNames) {
+    QSet<QString> watchedPortNames;
+    if (!m_pSeq) {
+        return watchedPortNames;
+    }
+
+    std::vector<snd_seq_addr_t> senders;
+    snd_seq_client_info_t* pClientInfo;
+    snd_seq_client_info_alloca(&pClientInfo);
+    snd_seq_port_info_t* pPortInfo;
+    snd_seq_port_info_alloca(&pPortInfo);
+    snd_seq_client_info_set_client(pClientInfo, -1);
+    while (snd_seq_query_next_client(m_pSeq, pClientInfo) >= 0) {
+        const int client = snd_seq_client_info_get_client(pClientInfo);
+        if (client == m_address.client) {
+            continue;
+        }
+        snd_seq_port_info_set_client(pPortInfo, client);
+        snd_seq_port_info_set_port(pPortInfo, -1);
+        while (snd_seq_query_next_port(m_pSeq, pPortInfo) >= 0) {
+            constexpr unsigned int kReadable =
+                    SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ;
+            if ((snd_seq_port_info_get_capability(pPortInfo) & kReadable) != kReadable) {
+                continue;
+            }
+            // PortMidi uses the port names as device names
+            const QString name = QString::fromLocal8Bit(snd_seq_port_info_get_name(pPortInfo));
+            if (portNames.contains(name)) {
+                senders.push_back(*snd_seq_port_info_get_addr(pPortInfo));
+                watchedPortNames.insert(name);
+            }
+        }
+    }
+
+    for (const auto& sender : m_subscriptions) {
+        if (!containsAddress(senders, sender)) {
+            unsubscribe(sender);
+        }
+    }
+    std::vector<snd_seq_addr_t> subscriptions;
+    for (const auto& sender : senders) {
+        if (containsAddress(m_subscriptions, sender) || subscribe(sender)) {
+            subscriptions.push_back(sender);
+        }
+    }
+    m_subscriptions = std::move(subscriptions);
+
+    // A port whose subscription failed is not watched
+    if (m_subscriptions.size() < senders.size()) {
+        watchedPortNames.clear();
+        for (const auto& sender : m_subscriptions) {
+            if (snd_seq_get_any_port_info(m_pSeq, sender.client, sender.port, pPortInfo) >= 0) {
+                watchedPortNames.insert(QString::fromLocal8Bit(
+                        snd_seq_port_info_get_name(pPortInfo)));
+            }
+        }
+    }
+    return watchedPortNames;
+}
+
+bool AlsaSeqInputNotifier::subscribe(const snd_seq_addr_t& sender) {
+    snd_seq_port_subscribe_t* pSubscription;
+    snd_seq_port_subscribe_alloca(&pSubscription);
+    snd_seq_port_subscribe_set_sender(pSubscription, &sender);
+    snd_seq_port_subscribe_set_dest(pSubscription, &m_address);
+    snd_seq_port_subscribe_set_queue(pSubscription, m_queue);
+    snd_seq_port_subscribe_set_time_update(pSubscription, 1);
+    snd_seq_port_subscribe_set_time_real(pSubscription, 1);
+    const int result = snd_seq_subscribe_port(m_pSeq, pSubscription);
+    if (result < 0) {
+        kLogger.warning() << "Failed to subscribe to port"
+                          << static_cast<int>(sender.client) << ':'
+                          << static_cast<int>(sender.port) << '-'
+                          << snd_strerror(result);
+        return false;
+    }
+    kLogger.debug() << "Watching port" << static_cast<int>(sender.client) << ':'
+                    << static_cast<int>(sender.port);
+    return true;
+}
+
+void AlsaSeqInputNotifier::unsubscribe(const snd_seq_addr_t& sender) {
+    snd_seq_port_subscribe_t* pSubscription;
+    snd_seq_port_subscribe_alloca(&pSubscription);
+    snd_seq_port_subscribe_set_sender(pSubscription, &sender);
+    snd_seq_port_subscribe_set_dest(pSubscription, &m_address);
+    // Fails if the port has disappeared in the meantime, which also
+    // removed the subscription
+    snd_seq_unsubscribe_port(m_pSeq, pSubscription);
+}
+
+void AlsaSeqInputNotifier::slotReadEvents() {
+    const mixxx::Duration now = mixxx::Time::elapsed();
+    // The current time of the queue maps the timestamps of the events to
+    // the clock of Mixxx
+    snd_seq_queue_status_t* pQueueStatus;
+    snd_seq_queue_status_alloca(&pQueueStatus);
+    const snd_seq_real_time_t* pQueueTime = nullptr;
+    if (snd_seq_get_queue_status(m_pSeq, m_queue, pQueueStatus) >= 0) {
+        pQueueTime = snd_seq_queue_status_get_real_time(pQueueStatus);
+    }
+
+    bool received = false;
+    mixxx::Duration receivedAt = now;
+    snd_seq_event_t* pEvent = nullptr;
+    int result;
+    while ((result = snd_seq_event_input(m_pSeq, &pEvent)) != -EAGAIN) {
+        if (result == -ENOSPC) {
+            // Our input buffer has overrun, which does not matter since
+            // we only need to know that there is input
+            continue;
+        }
+        if (result < 0) {
+            kLogger.warning() << "Failed to read events:" << snd_strerror(result);
+            break;
+        }
+        received = true;
+        if (pQueueTime &&
+                (pEvent->flags & SND_SEQ_TIME_STAMP_MASK) == SND_SEQ_TIME_STAMP_REAL) {
+            const qint64 ageNanos = toNanos(*pQueueTime) - toNanos(pEvent->time.time);
+            const mixxx::Duration eventTime =
+                    now - mixxx::Duration::fromNanos(std::max<qint64>(ageNanos, 0));
+            if (eventTime < receivedAt) {
+                receivedAt = eventTime;
+            }
+        }
+    }
+    if (received) {
+        emit inputReceived(receivedAt);
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <alsa/asoundlib.h>
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <vector>
+
+#include "util/duration.h"
+
+class QSocketNotifier;
+
+/// Wakes up the controller thread when MIDI input arrives on Linux.
+///
+/// PortMidi does not expose the file descriptors of its ALSA sequencer
+/// client, so the devices can only be polled. This opens a second sequencer
+/// client that is subscribed to the same input ports and watched by a
+/// QSocketNotifier. The events it receives are only used as a wake-up call
+/// and as a timestamp, the data is still read with PortMidi.
+///
+/// All functions must be called from the thread that owns the object.
+class AlsaSeqInputNotifier : public QObject {
+    Q_OBJECT
+  public:
+    explicit AlsaSeqInputNotifier(QObject* pParent = nullptr);
+    ~AlsaSeqInputNotifier() override;
+
+    /// Returns false if the sequencer could not be opened
+    bool isValid() const {
+        return m_pSeq != nullptr;
+    }
+
+    /// Subscribes to all readable sequencer ports with one of the names and
+    /// unsubscribes from all other ports. Returns the names of the ports
+    /// that are watched.
+    QSet<QString> setWatchedPorts(const QSet<QString>& portNames);
+
+  signals:
+    /// Emitted after all pending events have been read. receivedAt is the
+    /// time of the earliest event as mixxx::Time::elapsed().
+    void inputReceived(mixxx::Duration receivedAt);
+
+  private slots:
+    void slotReadEvents();
+
+  private:
+    bool subscribe(const snd_seq_addr_t& sender);
+    void unsubscribe(const snd_seq_addr_t& sender);
+
+    snd_seq_t* m_pSeq;
+    snd_seq_addr_t m_address;
+    int m_queue;
+    QSocketNotifier* m_pSocketNotifier;
+    std::vector<snd_seq_addr_t> m_subscriptions;
+};
@@ -1,5 +1,6 @@
 #include "controllers/midi/midicontroller.h"
 
+#include "control/control.h"
 #include "control/controlobject.h"
 #include "controllers/defs_controllers.h"
 #include "controllers/midi/midiutils.h"
@@ -11,7 +12,8 @@
 #include "util/screensaver.h"
 
 MidiController::MidiController(const QString& deviceName)
-        : Controller(deviceName) {
+        : Controller(deviceName),
+          m_compiledHandlerGeneration(0) {
     setDeviceCategory(tr("MIDI Controller"));
 }
 
@@ -31,6 +33,7 @@ QString MidiController::mappingExtension() {
 
 void MidiController::setMapping(std::shared_ptr<LegacyControllerMapping> pMapping) {
     m_pMapping = downcastAndTakeOwnership<LegacyMidiControllerMapping>(std::move(pMapping));
+    clearCompiledInputMappings();
 }
 
 std::shared_ptr<LegacyControllerMapping> MidiController::cloneMapping() {
@@ -54,6 +57,7 @@ bool MidiController::matchMapping(const MappingInfo& mapping) {
 bool MidiController::applyMapping() {
     // Handles the engine
     bool result = Controller::applyMapping();
+    clearCompiledInputMappings();
 
     // Only execute this code if this is an output device
     if (isOutputDevice()) {
@@ -207,6 +211,33 @@ void MidiController::commitTemporaryInputMappings() {
         m_pMapping->addInputMapping(it.key(), it.value());
     }
     m_temporaryInputMappings.clear();
+    clearCompiledInputMappings();
+}
+
+QVector<MidiController::CompiledInputMapping>& MidiController::compiledInputMappings(
+        uint16_t key) {
+    // The handlers of the previous scripts are gone after reloading them
+    const ControllerScriptEngineLegacy* pEngine = getScriptEngine();
+    if (pEngine && pEngine->handlerGeneration() != m_compiledHandlerGeneration) {
+        clearCompiledInputMappings();
+        m_compiledHandlerGeneration = pEngine->handlerGeneration();
+    }
+
+    auto compiledIt = m_compiledInputMappings.find(key);
+    if (compiledIt == m_compiledInputMappings.end()) {
+        QVector<CompiledInputMapping> compiledMappings;
+        // In the same order as iterating the mappings
+        auto it = m_pMapping->getInputMappings().constFind(key);
+        for (; it != m_pMapping->getInputMappings().constEnd() && it.key() == key; ++it) {
+            compiledMappings.append(CompiledInputMapping(it.value()));
+        }
+        compiledIt = m_compiledInputMappings.insert(key, compiledMappings);
+    }
+    return compiledIt.value();
+}
+
+void MidiController::clearCompiledInputMappings() {
+    m_compiledInputMappings.clear();
 }
 
 void MidiController::receivedShortMessage(unsigned char status,
@@ -244,50 +275,65 @@ void MidiController::receivedShortMessage(unsigned char status,
         auto it = m_temporaryInputMappings.constFind(mappingKey.key);
         if (it != m_temporaryInputMappings.constEnd()) {
             for (; it != m_temporaryInputMappings.constEnd() && it.key() == mappingKey.key; ++it) {
-                processInputMapping(it.value(), status, control, value, timestamp);
+                // Temporary mappings change too often to be worth compiling
+                CompiledInputMapping temporaryMapping(it.value());
+                processInputMapping(&temporaryMapping, status, control, value, timestamp);
             }
             return;
         }
     }
 
-    auto it = m_pMapping->getInputMappings().constFind(mappingKey.key);
-    for (; it != m_pMapping->getInputMappings().constEnd() && it.key() == mappingKey.key; ++it) {
-        processInputMapping(it.value(), status, control, value, timestamp);
+    for (auto& compiledMapping : compiledInputMappings(mappingKey.key)) {
+        processInputMapping(&compiledMapping, status, control, value, timestamp);
     }
 }
 
-void MidiController::processInputMapping(const MidiInputMapping& mapping,
-                                         unsigned char status,
-                                         unsigned char control,
-                                         unsigned char value,
-                                         mixxx::Duration timestamp) {
+void MidiController::processInputMapping(CompiledInputMapping* pCompiled,
+        unsigned char status,
+        unsigned char control,
+        unsigned char value,
+        mixxx::Duration timestamp) {
     Q_UNUSED(timestamp);
+    const MidiInputMapping& mapping = pCompiled->mapping;
     unsigned char channel = MidiUtils::channelFromStatus(status);
     MidiOpCode opCode = MidiUtils::opCodeFromStatus(status);
+    ControllerScriptEngineLegacy* pEngine = getScriptEngine();
 
     if (mapping.options.testFlag(MidiOption::Script)) {
-        ControllerScriptEngineLegacy* pEngine = getScriptEngine();
         if (pEngine == nullptr) {
             return;
         }
 
-        QJSValue function = pEngine->wrapFunctionCode(mapping.control.item, 5);
-        const auto args = QJSValueList{
-                channel,
-                control,
-                value,
-                status,
-                mapping.control.group,
-        };
-        if (!pEngine->executeFunction(function, args)) {
+        if (pCompiled->scriptHandler < 0) {
+            pCompiled->scriptHandler = pEngine->compileHandler(
+                    mapping.control.item, mapping.control.group);
+        }
+        if (pCompiled->scriptHandler < 0 ||
+                !pEngine->callHandler(pCompiled->scriptHandler,
+                        channel,
+                        control,
+                        value,
+                        status)) {
             qCWarning(m_logBase) << "MidiController: Invalid script function"
                                  << mapping.control.item;
         }
         return;
     }
 
+    // Script handlers queued before must see the state from before this
+    // message
+    if (pEngine) {
+        pEngine->flushBatch();
+    }
+
     // Only pass values on to valid ControlObjects.
-    ControlObject* pCO = ControlObject::getControl(mapping.control);
+    QSharedPointer<ControlDoublePrivate> pControl = pCompiled->pControl.toStrongRef();
+    if (!pControl || !pControl->getCreatorCO()) {
+        // Not looked up yet or the ControlObject has been deleted since
+        pControl = ControlDoublePrivate::getControl(mapping.control);
+        pCompiled->pControl = pControl;
+    }
+    ControlObject* pCO = pControl ? pControl->getCreatorCO() : nullptr;
     if (pCO == nullptr) {
         return;
     }
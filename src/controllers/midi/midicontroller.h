@@ -7,6 +7,7 @@
 #include "controllers/midi/midioutputhandler.h"
 #include "controllers/softtakeover.h"
 
+class ControlDoublePrivate;
 class DlgControllerLearning;
 
 /// MIDI Controller base class
@@ -71,8 +72,25 @@ class MidiController : public Controller {
     void commitTemporaryInputMappings();
 
   private:
+    /// An input mapping with its compiled script handler or its control, so
+    /// neither needs to be looked up again for every message.
+    struct CompiledInputMapping {
+        explicit CompiledInputMapping(const MidiInputMapping& mapping)
+                : mapping(mapping),
+                  scriptHandler(-1) {
+        }
+
+        MidiInputMapping mapping;
+        int scriptHandler;
+        // Weak, so deleting the ControlObject is not prevented
+        QWeakPointer<ControlDoublePrivate> pControl;
+    };
+
+    QVector<CompiledInputMapping>& compiledInputMappings(uint16_t key);
+    void clearCompiledInputMappings();
+
     void processInputMapping(
-            const MidiInputMapping& mapping,
+            CompiledInputMapping* pCompiled,
             unsigned char status,
             unsigned char control,
             unsigned char value,
@@ -88,6 +106,8 @@ class MidiController : public Controller {
     void destroyOutputHandlers();
 
     QHash<uint16_t, MidiInputMapping> m_temporaryInputMappings;
+    QHash<uint16_t, QVector<CompiledInputMapping>> m_compiledInputMappings;
+    quint32 m_compiledHandlerGeneration;
     QList<MidiOutputHandler*> m_outputs;
     std::shared_ptr<LegacyMidiControllerMapping> m_pMapping;
     SoftTakeoverCtrl m_st;
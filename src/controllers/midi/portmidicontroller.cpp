@@ -130,6 +130,9 @@ bool PortMidiController::poll() {
         return false;
     }
 
+    // Hand the script handlers of all messages to the script engine at once
+    ControllerScriptEngineLegacy::ScopedBatch scriptBatch(getScriptEngine());
+
     for (int i = 0; i < numEvents; i++) {
         unsigned char status = Pm_MessageStatus(m_midiBuffer[i].message);
         mixxx::Duration timestamp = mixxx::Duration::fromMillis(m_midiBuffer[i].timestamp);
@@ -191,6 +194,13 @@ bool PortMidiController::poll() {
     return numEvents > 0;
 }
 
+QString PortMidiController::inputPortName() const {
+    if (m_pInputDevice.isNull() || !m_pInputDevice->info()) {
+        return QString();
+    }
+    return QString::fromLocal8Bit(m_pInputDevice->info()->name);
+}
+
 void PortMidiController::sendShortMsg(unsigned char status, unsigned char byte1,
                                       unsigned char byte2) {
     if (m_pOutputDevice.isNull() || !m_pOutputDevice->isOpen()) {
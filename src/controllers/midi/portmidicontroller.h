@@ -74,6 +74,8 @@ class PortMidiController : public MidiController {
         return true;
     }
 
+    QString inputPortName() const override;
+
     // For testing only so that test fixtures can install mock PortMidiDevices.
     void setPortMidiInputDevice(PortMidiDevice* device) {
         m_pInputDevice.reset(device);
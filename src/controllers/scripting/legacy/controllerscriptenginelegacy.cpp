@@ -1,5 +1,7 @@
 #include "controllers/scripting/legacy/controllerscriptenginelegacy.h"
 
+#include <atomic>
+
 #include "control/controlobject.h"
 #include "controllers/controller.h"
 #include "controllers/scripting/colormapperjsproxy.h"
@@ -8,9 +10,22 @@
 #include "mixer/playermanager.h"
 #include "moc_controllerscriptenginelegacy.cpp"
 
+namespace {
+
+constexpr int kBatchedCallSize = 6;
+constexpr int kMaxHandlers = 0x10000;
+
+// Unique across all engines, so a new engine is never mistaken for the one
+// that compiled the handlers.
+std::atomic<quint32> s_nextHandlerGeneration{0};
+
+} // anonymous namespace
+
 ControllerScriptEngineLegacy::ControllerScriptEngineLegacy(
         Controller* controller, const RuntimeLoggingCategory& logger)
-        : ControllerScriptEngineBase(controller, logger) {
+        : ControllerScriptEngineBase(controller, logger),
+          m_handlerGeneration(s_nextHandlerGeneration++),
+          m_batchDepth(0) {
     connect(&m_fileWatcher,
             &QFileSystemWatcher::fileChanged,
             this,
@@ -90,6 +105,89 @@ QJSValue ControllerScriptEngineLegacy::wrapFunctionCode(
     return wrappedFunction;
 }
 
+int ControllerScriptEngineLegacy::compileHandler(
+        const QString& codeSnippet, const QString& group) {
+    if (!m_pJSEngine) {
+        return -1;
+    }
+
+    const auto key = qMakePair(codeSnippet, group);
+    const auto it = m_handlerIndices.constFind(key);
+    if (it != m_handlerIndices.constEnd()) {
+        return it.value();
+    }
+
+    const int handler = m_handlerIndices.size();
+    VERIFY_OR_DEBUG_ASSERT(handler < kMaxHandlers) {
+        return -1;
+    }
+    const QJSValue function = wrapFunctionCode(codeSnippet, 5);
+    if (!function.isCallable()) {
+        return -1;
+    }
+    m_handlerFunctions.setProperty(static_cast<quint32>(handler), function);
+    m_handlerGroups.setProperty(static_cast<quint32>(handler), group);
+    m_handlerIndices.insert(key, handler);
+    return handler;
+}
+
+bool ControllerScriptEngineLegacy::callHandler(int handler,
+        unsigned char channel,
+        unsigned char control,
+        unsigned char value,
+        unsigned char status) {
+    if (!m_pJSEngine) {
+        return false;
+    }
+    VERIFY_OR_DEBUG_ASSERT(handler >= 0 && handler < m_handlerIndices.size()) {
+        return false;
+    }
+
+    if (m_batchDepth > 0) {
+        const char call[kBatchedCallSize] = {
+                static_cast<char>(handler & 0xFF),
+                static_cast<char>(handler >> 8),
+                static_cast<char>(channel),
+                static_cast<char>(control),
+                static_cast<char>(value),
+                static_cast<char>(status),
+        };
+        m_batchedCalls.append(call, kBatchedCallSize);
+        return true;
+    }
+
+    const auto args = QJSValueList{
+            channel,
+            control,
+            value,
+            status,
+            m_handlerGroups.property(static_cast<quint32>(handler)),
+    };
+    return executeFunction(m_handlerFunctions.property(static_cast<quint32>(handler)), args);
+}
+
+void ControllerScriptEngineLegacy::flushBatch() {
+    if (m_batchedCalls.isEmpty()) {
+        return;
+    }
+    if (!m_pJSEngine) {
+        m_batchedCalls.clear();
+        return;
+    }
+
+    const auto args = QJSValueList{
+            m_handlerFunctions,
+            m_handlerGroups,
+            m_pJSEngine->toScriptValue(m_batchedCalls),
+    };
+    // Keep the capacity for the next batch
+    m_batchedCalls.resize(0);
+    const QJSValue result = m_dispatchBatchFunction.call(args);
+    if (result.isError()) {
+        showScriptExceptionDialog(result);
+    }
+}
+
 void ControllerScriptEngineLegacy::setScriptFiles(
         const QList<LegacyControllerMapping::ScriptFileInfo>& scripts) {
     const QStringList paths = m_fileWatcher.files();
@@ -119,6 +217,31 @@ bool ControllerScriptEngineLegacy::initialize() {
             "    };"
             "})"));
 
+    // Executes the handler calls of a batch, see callHandler(). A throwing
+    // handler does not prevent the remaining calls, like it would if they
+    // were made one by one. The first exception is rethrown afterwards.
+    m_dispatchBatchFunction = m_pJSEngine->evaluate(QStringLiteral(
+            "(function(handlers, groups, buffer) {"
+            "    var calls = new Uint8Array(buffer);"
+            "    var error;"
+            "    for (var i = 0; i + 5 < calls.length; i += 6) {"
+            "        var handler = calls[i] | (calls[i + 1] << 8);"
+            "        try {"
+            "            handlers[handler](calls[i + 2], calls[i + 3],"
+            "                    calls[i + 4], calls[i + 5], groups[handler]);"
+            "        } catch (e) {"
+            "            if (error === undefined) {"
+            "                error = e;"
+            "            }"
+            "        }"
+            "    }"
+            "    if (error !== undefined) {"
+            "        throw error;"
+            "    }"
+            "})"));
+    m_handlerFunctions = m_pJSEngine->newArray();
+    m_handlerGroups = m_pJSEngine->newArray();
+
     // Make this ControllerScriptHandler instance available to scripts as 'engine'.
     QJSValue engineGlobalObject = m_pJSEngine->globalObject();
     ControllerScriptInterfaceLegacy* legacyScriptInterface =
@@ -167,8 +290,14 @@ bool ControllerScriptEngineLegacy::initialize() {
 }
 
 void ControllerScriptEngineLegacy::shutdown() {
+    flushBatch();
     callFunctionOnObjects(m_scriptFunctionPrefixes, "shutdown");
     m_scriptWrappedFunctionCache.clear();
+    m_handlerIndices.clear();
+    m_handlerFunctions = QJSValue();
+    m_handlerGroups = QJSValue();
+    m_dispatchBatchFunction = QJSValue();
+    m_handlerGeneration = s_nextHandlerGeneration++;
     m_incomingDataFunctions.clear();
     m_scriptFunctionPrefixes.clear();
     ControllerScriptEngineBase::shutdown();
@@ -181,6 +310,9 @@ bool ControllerScriptEngineLegacy::handleIncomingData(const QByteArray& data) {
         return false;
     }
 
+    // Keep the order with the short messages of the current batch
+    flushBatch();
+
     const auto args = QJSValueList{
             m_pJSEngine->toScriptValue(data),
             static_cast<uint>(data.size()),
@@ -4,9 +4,11 @@
 #include <QJSEngine>
 #include <QJSValue>
 #include <QMessageBox>
+#include <QPointer>
 
 #include "controllers/legacycontrollermapping.h"
 #include "controllers/scripting/controllerscriptenginebase.h"
+#include "util/class.h"
 
 /// ControllerScriptEngineLegacy loads and executes controller scripts for the legacy
 /// JS/XML hybrid controller mapping system.
@@ -26,6 +28,61 @@ class ControllerScriptEngineLegacy : public ControllerScriptEngineBase {
     /// and ensures the function is executed with the correct 'this' object.
     QJSValue wrapFunctionCode(const QString& codeSnippet, int numberOfArgs);
 
+    /// Compile a handler for short MIDI messages that is called with
+    /// (channel, control, value, status, group). Returns an index for
+    /// callHandler() or -1 if the code is invalid. The indices remain valid
+    /// as long as handlerGeneration() does not change.
+    int compileHandler(const QString& codeSnippet, const QString& group);
+
+    /// Call a handler from compileHandler(). While a batch is open, the call
+    /// is queued and executed when the batch ends.
+    bool callHandler(int handler,
+            unsigned char channel,
+            unsigned char control,
+            unsigned char value,
+            unsigned char status);
+
+    /// Changes whenever the compiled handlers are discarded, e.g. when the
+    /// scripts are reloaded.
+    quint32 handlerGeneration() const {
+        return m_handlerGeneration;
+    }
+
+    /// Execute the queued handler calls of the current batch. This must be
+    /// called before anything else that might depend on their effects
+    /// happens within a batch.
+    void flushBatch();
+
+    /// Queues all handler calls during its lifetime and delivers them to the
+    /// script with a single call into the JS engine, which avoids the
+    /// overhead of entering the engine for every message of a poll cycle.
+    ///
+    /// Only the calls of callHandler(), i.e. the script handlers of MIDI
+    /// input mappings, are batched. HID and bulk controllers already pass
+    /// each input report as a whole to handleIncomingData(), and HSS1394
+    /// delivers every message in its own queued signal without a poll cycle.
+    /// Therefore PortMidiController::poll() is the only user.
+    class ScopedBatch {
+      public:
+        explicit ScopedBatch(ControllerScriptEngineLegacy* pEngine)
+                : m_pEngine(pEngine) {
+            if (m_pEngine) {
+                m_pEngine->m_batchDepth++;
+            }
+        }
+        ~ScopedBatch() {
+            if (m_pEngine && --m_pEngine->m_batchDepth == 0) {
+                m_pEngine->flushBatch();
+            }
+        }
+
+      private:
+        // The engine might be deleted by a script while the batch is open
+        const QPointer<ControllerScriptEngineLegacy> m_pEngine;
+
+        DISALLOW_COPY_AND_ASSIGN(ScopedBatch);
+    };
+
   public slots:
     void setScriptFiles(const QList<LegacyControllerMapping::ScriptFileInfo>& scripts);
 
@@ -43,6 +100,17 @@ class ControllerScriptEngineLegacy : public ControllerScriptEngineBase {
     QList<QString> m_scriptFunctionPrefixes;
     QList<QJSValue> m_incomingDataFunctions;
     QHash<QString, QJSValue> m_scriptWrappedFunctionCache;
+
+    QJSValue m_dispatchBatchFunction;
+    // JS arrays with the functions and groups of the compiled handlers
+    QJSValue m_handlerFunctions;
+    QJSValue m_handlerGroups;
+    QHash<QPair<QString, QString>, int> m_handlerIndices;
+    quint32 m_handlerGeneration;
+    // 6 bytes per queued call: handler (little endian), channel, control,
+    // value and status
+    QByteArray m_batchedCalls;
+    int m_batchDepth;
     QList<LegacyControllerMapping::ScriptFileInfo> m_scriptFiles;
 
     QFileSystemWatcher m_fileWatcher;
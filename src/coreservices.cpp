@@ -4,6 +4,7 @@
 #include <QFileDialog>
 #include <QPushButton>
 #include <QStandardPaths>
+#include <QtConcurrentRun>
 
 #ifdef __BROADCAST__
 #include "broadcast/broadcastmanager.h"
@@ -15,6 +16,7 @@
 #include "effects/effectsmanager.h"
 #include "engine/enginemaster.h"
 #include "library/coverartcache.h"
+#include "library/coverartthumbnailstore.h"
 #include "library/library.h"
 #include "library/library_prefs.h"
 #include "library/trackcollection.h"
@@ -26,7 +28,9 @@
 #ifdef __MODPLUG__
 #include "preferences/dialog/dlgprefmodplug.h"
 #endif
+#include "skin/legacy/svgrastercache.h"
 #include "soundio/soundmanager.h"
+#include "sources/seekindex.h"
 #include "sources/soundsourceproxy.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/font.h"
@@ -60,6 +64,8 @@ namespace {
 const mixxx::Logger kLogger("CoreServices");
 constexpr int kMicrophoneCount = 4;
 constexpr int kAuxiliaryCount = 4;
+constexpr int kRenderDeckCount = 4;
+constexpr int kRenderSamplerCount = 4;
 
 #define CLEAR_AND_CHECK_DELETED(x) clearHelper(x, #x);
 
@@ -234,6 +240,16 @@ void CoreServices::initialize(QApplication* pApp) {
 
     Sandbox::setPermissionsFilePath(QDir(pConfig->getSettingsPath()).filePath("sandbox.cfg"));
 
+    // Stored along with the analysis data, see AnalysisDao
+    mixxx::SeekIndex::setStorageDirectory(
+            QDir(pConfig->getSettingsPath()).filePath("analysis/seekindex"));
+    // Indexes are only removed when the storage size is exceeded
+    m_pruneSeekIndexesFuture = QtConcurrent::run([] { mixxx::SeekIndex::prune(); });
+    CoverArtThumbnailStore::setStorageDirectory(
+            QDir(pConfig->getSettingsPath()).filePath("coverart/thumbnails"));
+    SvgRasterCache::setStorageDirectory(
+            QDir(pConfig->getSettingsPath()).filePath("skincache"));
+
     QString resourcePath = pConfig->getResourcePath();
 
     emit initializationProgressUpdate(0, tr("fonts"));
@@ -474,6 +490,53 @@ void CoreServices::initialize(QApplication* pApp) {
     m_isInitialized = true;
 }
 
+void CoreServices::initializeForRender() {
+    VERIFY_OR_DEBUG_ASSERT(!m_isInitialized) {
+        return;
+    }
+
+    ScopedTimer t("CoreServices::initializeForRender");
+
+    VERIFY_OR_DEBUG_ASSERT(SoundSourceProxy::registerProviders()) {
+        qCritical() << "Failed to register any SoundSource providers";
+        return;
+    }
+
+    VersionStore::logBuildDetails();
+
+    UserSettingsPointer pConfig = m_pSettingsManager->settings();
+
+    auto pChannelHandleFactory = std::make_shared<ChannelHandleFactory>();
+    m_pEffectsManager = std::make_shared<EffectsManager>(pConfig, pChannelHandleFactory);
+
+    // The renderer encodes the master output itself, so there is no need
+    // for the side chain that feeds recording and broadcasting.
+    m_pEngine = std::make_shared<EngineMaster>(
+            pConfig,
+            "[Master]",
+            m_pEffectsManager.get(),
+            pChannelHandleFactory,
+            false);
+
+    m_pPlayerManager = std::make_shared<PlayerManager>(
+            pConfig,
+            nullptr,
+            m_pEffectsManager.get(),
+            m_pEngine.get());
+    PlayerInfo::create();
+
+    for (int i = 0; i < kRenderDeckCount; ++i) {
+        m_pPlayerManager->addDeck();
+    }
+    for (int i = 0; i < kRenderSamplerCount; ++i) {
+        m_pPlayerManager->addSampler();
+    }
+
+    m_pEffectsManager->setup();
+
+    m_isInitialized = true;
+}
+
 void CoreServices::initializeKeyboard() {
     UserSettingsPointer pConfig = m_pSettingsManager->settings();
     QString resourcePath = pConfig->getResourcePath();
@@ -564,14 +627,19 @@ void CoreServices::finalize() {
     Timer t("CoreServices::~CoreServices");
     t.start();
 
-    // Stop all pending library operations
-    qDebug() << t.elapsed(false).debugMillisWithUnit() << "stopping pending Library tasks";
-    m_pTrackCollectionManager->stopLibraryScan();
-    m_pLibrary->stopPendingTasks();
+    // Stop all pending library operations. There is no library if only
+    // initializeForRender() has been called.
+    if (m_pLibrary) {
+        qDebug() << t.elapsed(false).debugMillisWithUnit() << "stopping pending Library tasks";
+        m_pTrackCollectionManager->stopLibraryScan();
+        m_pLibrary->stopPendingTasks();
+    }
 
     qDebug() << t.elapsed(false).debugMillisWithUnit() << "saving configuration";
     m_pSettingsManager->save();
 
+    m_pruneSeekIndexesFuture.waitForFinished();
+
     // SoundManager depend on Engine and Config
     qDebug() << t.elapsed(false).debugMillisWithUnit() << "deleting SoundManager";
     CLEAR_AND_CHECK_DELETED(m_pSoundManager);
@@ -587,8 +655,11 @@ void CoreServices::finalize() {
     CLEAR_AND_CHECK_DELETED(m_pVCManager);
 #endif
 
-    // CoverArtCache is fairly independent of everything else.
-    CoverArtCache::destroy();
+    // CoverArtCache is fairly independent of everything else. It is created
+    // together with the library.
+    if (m_pLibrary) {
+        CoverArtCache::destroy();
+    }
 
     // PlayerManager depends on Engine, SoundManager, VinylControlManager, and Config
     // The player manager has to be deleted before the library to ensure
@@ -630,9 +701,11 @@ void CoreServices::finalize() {
     qDebug() << t.elapsed(false).debugMillisWithUnit() << "detaching all track collections";
     CLEAR_AND_CHECK_DELETED(m_pTrackCollectionManager);
 
-    qDebug() << t.elapsed(false).debugMillisWithUnit() << "closing database connection(s)";
-    m_pDbConnectionPool->destroyThreadLocalConnection();
-    m_pDbConnectionPool.reset(); // should drop the last reference
+    if (m_pDbConnectionPool) {
+        qDebug() << t.elapsed(false).debugMillisWithUnit() << "closing database connection(s)";
+        m_pDbConnectionPool->destroyThreadLocalConnection();
+        m_pDbConnectionPool.reset(); // should drop the last reference
+    }
 
     m_pTouchShift.reset();
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QFuture>
 #include <memory>
 
 #include "control/controlpushbutton.h"
@@ -43,6 +44,12 @@ class CoreServices : public QObject {
     /// The secondary long run which should be called after displaying the start up screen
     void initialize(QApplication* pApp);
 
+    /// Only sets up what is needed to render a script offline, see --render:
+    /// the engine with effects, and a player manager with decks and
+    /// samplers. There are no sound devices, controllers, database, or
+    /// library, so nothing is scanned and no user state is touched.
+    void initializeForRender();
+
     std::shared_ptr<KeyboardEventFilter> getKeyboardEventFilter() const {
         return m_pKeyboardEventFilter;
     }
@@ -55,6 +62,10 @@ class CoreServices : public QObject {
         return m_pControlIndicatorTimer;
     }
 
+    std::shared_ptr<EngineMaster> getEngineMaster() const {
+        return m_pEngine;
+    }
+
     std::shared_ptr<SoundManager> getSoundManager() const {
         return m_pSoundManager;
     }
@@ -154,6 +165,8 @@ class CoreServices : public QObject {
     std::vector<std::unique_ptr<ControlPushButton>> m_uiControls;
     std::unique_ptr<ControlPushButton> m_pTouchShift;
 
+    QFuture<void> m_pruneSeekIndexesFuture;
+
     Timer m_runtime_timer;
     const CmdlineArgs& m_cmdlineArgs;
     bool m_isInitialized;
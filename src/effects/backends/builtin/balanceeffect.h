@@ -1,11 +1,11 @@
 #pragma once
 
 #include "effects/backends/effectprocessor.h"
+#include "effects/backends/effectsamplebuffer.h"
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectparameter.h"
 #include "engine/filters/enginefilterlinkwitzriley4.h"
 #include "util/memory.h"
-#include "util/samplebuffer.h"
 
 class BalanceGroupState : public EffectState {
   public:
@@ -17,7 +17,7 @@ class BalanceGroupState : public EffectState {
     std::unique_ptr<EngineFilterLinkwitzRiley4Low> m_low;
     std::unique_ptr<EngineFilterLinkwitzRiley4High> m_high;
 
-    mixxx::SampleBuffer m_pHighBuf;
+    EffectSampleBuffer m_pHighBuf;
 
     mixxx::audio::SampleRate m_oldSampleRate;
     double m_freq;
@@ -3,6 +3,7 @@
 #include "control/controlproxy.h"
 #include "effects/backends/builtin/lvmixeqbase.h"
 #include "effects/backends/effectprocessor.h"
+#include "effects/backends/effectsamplebuffer.h"
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectparameter.h"
 #include "engine/filters/enginefilterbessel4.h"
@@ -12,7 +13,6 @@
 #include "util/defs.h"
 #include "util/memory.h"
 #include "util/sample.h"
-#include "util/samplebuffer.h"
 #include "util/types.h"
 
 class BiquadFullKillEQEffectGroupState : public EffectState {
@@ -32,10 +32,10 @@ class BiquadFullKillEQEffectGroupState : public EffectState {
     std::unique_ptr<EngineFilterBiquad1HighShelving> m_highKill;
     std::unique_ptr<LVMixEQEffectGroupState<EngineFilterBessel4Low>> m_lvMixIso;
 
-    mixxx::SampleBuffer m_pLowBuf;
-    mixxx::SampleBuffer m_pBandBuf;
-    mixxx::SampleBuffer m_pHighBuf;
-    mixxx::SampleBuffer m_tempBuf;
+    EffectSampleBuffer m_pLowBuf;
+    EffectSampleBuffer m_pBandBuf;
+    EffectSampleBuffer m_pHighBuf;
+    EffectSampleBuffer m_tempBuf;
 
     double m_oldLowBoost;
     double m_oldMidBoost;
@@ -3,13 +3,13 @@
 #include <QMap>
 
 #include "effects/backends/effectprocessor.h"
+#include "effects/backends/effectsamplebuffer.h"
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectparameter.h"
 #include "engine/engine.h"
 #include "util/class.h"
 #include "util/defs.h"
 #include "util/sample.h"
-#include "util/samplebuffer.h"
 
 class EchoGroupState : public EffectState {
   public:
@@ -24,7 +24,7 @@ class EchoGroupState : public EffectState {
     }
 
     void audioParametersChanged(const mixxx::EngineParameters& engineParameters) {
-        delay_buf = mixxx::SampleBuffer(kMaxDelaySeconds *
+        delay_buf = EffectSampleBuffer(kMaxDelaySeconds *
                 engineParameters.sampleRate() *
                 engineParameters.channelCount());
     };
@@ -38,7 +38,7 @@ class EchoGroupState : public EffectState {
         ping_pong = 0;
     };
 
-    mixxx::SampleBuffer delay_buf;
+    EffectSampleBuffer delay_buf;
     CSAMPLE_GAIN prev_send;
     CSAMPLE_GAIN prev_feedback;
     int prev_delay_samples;
@@ -68,7 +68,7 @@ FilterGroupState::FilterGroupState(const mixxx::EngineParameters& engineParamete
           m_loFreq(kMaxCorner / engineParameters.sampleRate()),
           m_q(0.707106781),
           m_hiFreq(kMinCorner / engineParameters.sampleRate()) {
-    m_buffer = mixxx::SampleBuffer(engineParameters.samplesPerBuffer());
+    m_buffer = EffectSampleBuffer(engineParameters.samplesPerBuffer());
     m_pLowFilter = new EngineFilterBiquad1Low(1, m_loFreq, m_q, true);
     m_pHighFilter = new EngineFilterBiquad1High(1, m_hiFreq, m_q, true);
 }
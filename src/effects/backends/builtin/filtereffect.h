@@ -1,13 +1,13 @@
 #pragma once
 
 #include "effects/backends/effectprocessor.h"
+#include "effects/backends/effectsamplebuffer.h"
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectparameter.h"
 #include "engine/filters/enginefilterbiquad1.h"
 #include "util/class.h"
 #include "util/defs.h"
 #include "util/sample.h"
-#include "util/samplebuffer.h"
 #include "util/types.h"
 
 struct FilterGroupState : public EffectState {
@@ -16,7 +16,7 @@ struct FilterGroupState : public EffectState {
 
     void setFilters(int sampleRate, double lowFreq, double highFreq);
 
-    mixxx::SampleBuffer m_buffer;
+    EffectSampleBuffer m_buffer;
     EngineFilterBiquad1Low* m_pLowFilter;
     EngineFilterBiquad1High* m_pHighFilter;
 
@@ -2,6 +2,7 @@
 
 #include "control/controlproxy.h"
 #include "effects/backends/effectprocessor.h"
+#include "effects/backends/effectsamplebuffer.h"
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectparameter.h"
 #include "engine/filters/enginefilterbiquad1.h"
@@ -9,7 +10,6 @@
 #include "util/defs.h"
 #include "util/memory.h"
 #include "util/sample.h"
-#include "util/samplebuffer.h"
 #include "util/types.h"
 
 class ThreeBandBiquadEQEffectGroupState final : public EffectState {
@@ -26,7 +26,7 @@ class ThreeBandBiquadEQEffectGroupState final : public EffectState {
     std::unique_ptr<EngineFilterBiquad1Peaking> m_lowCut;
     std::unique_ptr<EngineFilterBiquad1Peaking> m_midCut;
     std::unique_ptr<EngineFilterBiquad1HighShelving> m_highCut;
-    mixxx::SampleBuffer m_tempBuf;
+    EffectSampleBuffer m_tempBuf;
     double m_oldLowBoost;
     double m_oldMidBoost;
     double m_oldHighBoost;
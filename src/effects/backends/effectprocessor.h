@@ -5,6 +5,7 @@
 #include <QPair>
 #include <QString>
 
+#include "effects/backends/effectstateallocator.h"
 #include "effects/defs.h"
 #include "engine/channelhandle.h"
 #include "engine/effects/groupfeaturestate.h"
@@ -49,6 +50,11 @@
 /// without wasting a lot of memory. (EffectStates could be (de)allocated when toggling
 /// the enable switches for EffectSlots as well, but the memory savings would be
 /// relatively small compared to the additional code complexity.)
+///
+/// The memory of EffectStates is recycled by the EffectStateAllocator, so
+/// loading the same effects again does not need to allocate it from the
+/// system. Subclasses should store their sample buffers in an
+/// EffectSampleBuffer for the same reason.
 class EffectState {
   public:
     EffectState(const mixxx::EngineParameters& engineParameters) {
@@ -56,6 +62,13 @@ class EffectState {
         Q_UNUSED(engineParameters);
     };
     virtual ~EffectState(){};
+
+    static void* operator new(std::size_t size) {
+        return EffectStateAllocator::allocate(size);
+    }
+    static void operator delete(void* pState) {
+        EffectStateAllocator::deallocate(pState);
+    }
 };
 
 /// EffectProcessor is an abstract base class for interfacing with an EffectSlot
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <utility>
+
+#include "effects/backends/effectstateallocator.h"
+#include "util/assert.h"
+#include "util/class.h"
+#include "util/sample.h"
+#include "util/types.h"
+
+/// A sample buffer owned by an EffectState. The memory is recycled by the
+/// EffectStateAllocator when the state is deleted, otherwise it behaves
+/// like mixxx::SampleBuffer.
+class EffectSampleBuffer final {
+  public:
+    EffectSampleBuffer()
+            : m_data(nullptr),
+              m_size(0) {
+    }
+    explicit EffectSampleBuffer(SINT size)
+            : m_data((size > 0)
+                              ? static_cast<CSAMPLE*>(EffectStateAllocator::allocate(
+                                        size * sizeof(CSAMPLE)))
+                              : nullptr),
+              m_size((m_data != nullptr) ? size : 0) {
+    }
+    EffectSampleBuffer(EffectSampleBuffer&& that)
+            : m_data(std::exchange(that.m_data, nullptr)),
+              m_size(std::exchange(that.m_size, 0)) {
+    }
+    ~EffectSampleBuffer() {
+        EffectStateAllocator::deallocate(m_data);
+    }
+
+    EffectSampleBuffer& operator=(EffectSampleBuffer&& that) {
+        swap(that);
+        return *this;
+    }
+
+    SINT size() const {
+        return m_size;
+    }
+
+    CSAMPLE* data(SINT offset = 0) {
+        DEBUG_ASSERT((m_data != nullptr) || (offset == 0));
+        DEBUG_ASSERT(0 <= offset);
+        // >=: allow access to one element behind allocated memory
+        DEBUG_ASSERT(m_size >= offset);
+        return m_data + offset;
+    }
+    const CSAMPLE* data(SINT offset = 0) const {
+        DEBUG_ASSERT((m_data != nullptr) || (offset == 0));
+        DEBUG_ASSERT(0 <= offset);
+        // >=: allow access to one element behind allocated memory
+        DEBUG_ASSERT(m_size >= offset);
+        return m_data + offset;
+    }
+
+    CSAMPLE& operator[](SINT index) {
+        return *data(index);
+    }
+    const CSAMPLE& operator[](SINT index) const {
+        return *data(index);
+    }
+
+    void swap(EffectSampleBuffer& that) {
+        std::swap(m_data, that.m_data);
+        std::swap(m_size, that.m_size);
+    }
+
+    /// Fills the whole buffer with zeroes
+    void clear() {
+        SampleUtil::clear(m_data, m_size);
+    }
+
+  private:
+    CSAMPLE* m_data;
+    SINT m_size;
+
+    DISALLOW_COPY_AND_ASSIGN(EffectSampleBuffer);
+};
@@ -0,0 +1,220 @@
+#include "effects/backends/effectstateallocator.h"
+
+#include <QHash>
+#include <QMutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include "util/assert.h"
+#include "util/compatibility/qmutex.h"
+#include "util/stat.h"
+
+namespace {
+
+// Sufficient for AVX
+constexpr std::size_t kAlignment = 64;
+
+// Large blocks are rounded to pages. This keeps the number of free lists
+// small if the size depends on the sample rate.
+constexpr std::size_t kPageSize = 4096;
+constexpr std::size_t kLargeBlockSize = 64 * 1024;
+
+// All states of the echo for 8 channels and both outputs at 96 kHz
+constexpr std::size_t kDefaultMaxPooledBytes = 64 * 1024 * 1024;
+
+// Precedes the memory of each block
+struct alignas(kAlignment) BlockHeader {
+    std::size_t capacity;
+    int account;
+};
+
+struct Account {
+    QString effectId;
+    std::size_t bytesInUse;
+    std::size_t peakBytesInUse;
+    int allocationCount;
+    int reusedCount;
+};
+
+// Allocations outside of a ScopedEffect
+constexpr int kUnattributedAccount = 0;
+
+struct AllocatorState {
+    AllocatorState()
+            : pooledBytes(0),
+              maxPooledBytes(kDefaultMaxPooledBytes) {
+        accounts.push_back(Account{QStringLiteral("(unattributed)"), 0, 0, 0, 0});
+    }
+
+    QMutex mutex;
+    std::unordered_map<std::size_t, std::vector<BlockHeader*>> freeBlocks;
+    std::size_t pooledBytes;
+    std::size_t maxPooledBytes;
+    std::vector<Account> accounts;
+    QHash<QString, int> accountIndices;
+};
+
+AllocatorState& allocatorState() {
+    static AllocatorState s_state;
+    return s_state;
+}
+
+thread_local int t_account = kUnattributedAccount;
+
+std::size_t blockCapacity(std::size_t size) {
+    const std::size_t alignment = size < kLargeBlockSize ? kAlignment : kPageSize;
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+std::size_t blockSize(const BlockHeader* pBlock) {
+    return sizeof(BlockHeader) + pBlock->capacity;
+}
+
+BlockHeader* newBlock(std::size_t capacity) {
+    void* pMemory = ::operator new(
+            sizeof(BlockHeader) + capacity, std::align_val_t{kAlignment});
+    return new (pMemory) BlockHeader{capacity, kUnattributedAccount};
+}
+
+void deleteBlock(BlockHeader* pBlock) {
+    pBlock->~BlockHeader();
+    ::operator delete(pBlock, std::align_val_t{kAlignment});
+}
+
+void trackUsage(const QString& effectId, std::size_t bytesInUse) {
+    Stat::track(QStringLiteral("EffectState bytes ") + effectId,
+            Stat::UNSPECIFIED,
+            Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE | Stat::MIN | Stat::MAX),
+            static_cast<double>(bytesInUse));
+}
+
+} // anonymous namespace
+
+EffectStateAllocator::ScopedEffect::ScopedEffect(const QString& effectId)
+        : m_previousAccount(t_account) {
+    AllocatorState& state = allocatorState();
+    const auto locker = lockMutex(&state.mutex);
+    int account = state.accountIndices.value(effectId, -1);
+    if (account < 0) {
+        account = static_cast<int>(state.accounts.size());
+        state.accountIndices.insert(effectId, account);
+        state.accounts.push_back(Account{effectId, 0, 0, 0, 0});
+    }
+    t_account = account;
+}
+
+EffectStateAllocator::ScopedEffect::~ScopedEffect() {
+    t_account = m_previousAccount;
+}
+
+// static
+void* EffectStateAllocator::allocate(std::size_t size) {
+    const std::size_t capacity = blockCapacity(size);
+    AllocatorState& state = allocatorState();
+    BlockHeader* pBlock = nullptr;
+    QString effectId;
+    std::size_t bytesInUse;
+    {
+        const auto locker = lockMutex(&state.mutex);
+        Account* pAccount = &state.accounts[t_account];
+        const auto it = state.freeBlocks.find(capacity);
+        if (it != state.freeBlocks.end() && !it->second.empty()) {
+            pBlock = it->second.back();
+            it->second.pop_back();
+            state.pooledBytes -= blockSize(pBlock);
+            ++pAccount->reusedCount;
+        }
+        if (!pBlock) {
+            pBlock = newBlock(capacity);
+        }
+        pBlock->account = t_account;
+        ++pAccount->allocationCount;
+        pAccount->bytesInUse += capacity;
+        if (pAccount->peakBytesInUse < pAccount->bytesInUse) {
+            pAccount->peakBytesInUse = pAccount->bytesInUse;
+        }
+        effectId = pAccount->effectId;
+        bytesInUse = pAccount->bytesInUse;
+    }
+    trackUsage(effectId, bytesInUse);
+    return pBlock + 1;
+}
+
+// static
+void EffectStateAllocator::deallocate(void* pMemory) {
+    if (!pMemory) {
+        return;
+    }
+    BlockHeader* pBlock = static_cast<BlockHeader*>(pMemory) - 1;
+    AllocatorState& state = allocatorState();
+    QString effectId;
+    std::size_t bytesInUse;
+    {
+        const auto locker = lockMutex(&state.mutex);
+        VERIFY_OR_DEBUG_ASSERT(pBlock->account >= 0 &&
+                pBlock->account < static_cast<int>(state.accounts.size())) {
+            return;
+        }
+        Account* pAccount = &state.accounts[pBlock->account];
+        DEBUG_ASSERT(pAccount->bytesInUse >= pBlock->capacity);
+        pAccount->bytesInUse -= pBlock->capacity;
+        effectId = pAccount->effectId;
+        bytesInUse = pAccount->bytesInUse;
+        if (state.pooledBytes + blockSize(pBlock) <= state.maxPooledBytes) {
+            state.freeBlocks[pBlock->capacity].push_back(pBlock);
+            state.pooledBytes += blockSize(pBlock);
+            pBlock = nullptr;
+        }
+    }
+    if (pBlock) {
+        deleteBlock(pBlock);
+    }
+    trackUsage(effectId, bytesInUse);
+}
+
+// static
+QList<EffectStateAllocator::Usage> EffectStateAllocator::usage() {
+    AllocatorState& state = allocatorState();
+    const auto locker = lockMutex(&state.mutex);
+    QList<Usage> usage;
+    for (const auto& account : state.accounts) {
+        usage.append(Usage{account.effectId,
+                account.bytesInUse,
+                account.peakBytesInUse,
+                account.allocationCount,
+                account.reusedCount});
+    }
+    return usage;
+}
+
+// static
+std::size_t EffectStateAllocator::pooledBytes() {
+    AllocatorState& state = allocatorState();
+    const auto locker = lockMutex(&state.mutex);
+    return state.pooledBytes;
+}
+
+// static
+void EffectStateAllocator::setMaxPooledBytes(std::size_t maxPooledBytes) {
+    AllocatorState& state = allocatorState();
+    const auto locker = lockMutex(&state.mutex);
+    state.maxPooledBytes = maxPooledBytes;
+}
+
+// static
+void EffectStateAllocator::releasePooledMemory() {
+    std::unordered_map<std::size_t, std::vector<BlockHeader*>> freeBlocks;
+    {
+        AllocatorState& state = allocatorState();
+        const auto locker = lockMutex(&state.mutex);
+        freeBlocks.swap(state.freeBlocks);
+        state.pooledBytes = 0;
+    }
+    for (const auto& [capacity, blocks] : freeBlocks) {
+        Q_UNUSED(capacity);
+        for (BlockHeader* pBlock : blocks) {
+            deleteBlock(pBlock);
+        }
+    }
+}
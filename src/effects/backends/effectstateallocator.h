@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <cstddef>
+
+#include "util/class.h"
+
+/// Recycles the memory of EffectStates and of the sample buffers they own.
+///
+/// EffectStates are created on the main thread whenever the routing of an
+/// effect chain changes or an effect is loaded into a slot. Some of them
+/// need several MiB, e.g. the delay line of the echo at 96 kHz. Loading a
+/// chain preset for all channels used to allocate and fault in all of
+/// that memory again. Freed blocks are kept on free lists for their size
+/// instead, so swapping effects reuses memory that is already mapped.
+///
+/// Allocations are charged to the effect whose states are created on the
+/// calling thread, see ScopedEffect. The usage of each effect is also
+/// reported to the StatsManager.
+class EffectStateAllocator {
+  public:
+    struct Usage {
+        QString effectId;
+        std::size_t bytesInUse;
+        std::size_t peakBytesInUse;
+        /// All allocations and those that have been served from the pool
+        int allocationCount;
+        int reusedCount;
+    };
+
+    /// Charges all allocations of the current thread to the effect while
+    /// in scope.
+    class ScopedEffect final {
+      public:
+        explicit ScopedEffect(const QString& effectId);
+        ~ScopedEffect();
+
+      private:
+        const int m_previousAccount;
+
+        DISALLOW_COPY_AND_ASSIGN(ScopedEffect);
+    };
+
+    /// The returned memory is aligned for SIMD instructions.
+    static void* allocate(std::size_t size);
+    static void deallocate(void* pMemory);
+
+    static QList<Usage> usage();
+
+    /// The size of the freed blocks that are kept for reuse
+    static std::size_t pooledBytes();
+    /// Blocks that are freed while the pool has reached this size are
+    /// returned to the system.
+    static void setMaxPooledBytes(std::size_t maxPooledBytes);
+    static void releasePooledMemory();
+};
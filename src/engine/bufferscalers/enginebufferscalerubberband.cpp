@@ -3,6 +3,7 @@
 #include <rubberband/RubberBandStretcher.h>
 
 #include <QtDebug>
+#include <cmath>
 
 #include "control/controlobject.h"
 #include "engine/readaheadmanager.h"
@@ -23,25 +24,143 @@ size_t kRubberBandBlockSize = 256;
 
 #define RUBBERBANDV3 (RUBBERBAND_API_MAJOR_VERSION >= 2 && RUBBERBAND_API_MINOR_VERSION >= 7)
 
+// The worker stretches ahead of the audio callback by this many callbacks
+constexpr SINT kLookaheadCallbacks = 2;
+
+// The stretcher is only handed over to the worker after the rate has been
+// stable for a few callbacks, because the output that has been stretched
+// ahead does not follow rate changes immediately.
+constexpr int kStableCallbacksBeforeHandover = 4;
+
+// Relative change of the time ratio between two callbacks that is handled
+// synchronously
+constexpr double kRateJumpThreshold = 0.05;
+
+// Interleaved samples of the FIFOs between the engine thread and the worker,
+// enough for the lookahead with large buffers and fast tempos
+constexpr int kWorkerFifoSize = 65536;
+
 }  // namespace
 
+EngineBufferScaleRubberBand::Worker::Worker(EngineBufferScaleRubberBand* pScale)
+        : m_pScale(pScale) {
+}
+
+void EngineBufferScaleRubberBand::Worker::run() {
+    QThread::currentThread()->setObjectName(QStringLiteral("EngineBufferScaleRubberBand"));
+    while (true) {
+        m_semaWake.acquire();
+        if (m_pScale->m_bWorkerQuit.load()) {
+            break;
+        }
+        // Checking the ownership after announcing that the stretcher is
+        // busy lets the engine thread wait until the stretcher is released.
+        m_pScale->m_bWorkerBusy.store(true);
+        if (m_pScale->m_bWorkerOwnsStretcher.load()) {
+            m_pScale->processAhead();
+        }
+        m_pScale->m_bWorkerBusy.store(false);
+    }
+}
+
 EngineBufferScaleRubberBand::EngineBufferScaleRubberBand(
         ReadAheadManager* pReadAheadManager)
         : m_pReadAheadManager(pReadAheadManager),
           m_buffer_back(SampleUtil::alloc(MAX_BUFFER_LEN)),
           m_bBackwards(false),
-          m_useEngineFiner(false) {
+          m_useEngineFiner(false),
+          m_bMultiThreaded(false),
+          m_bWorkerThreadRequested(false),
+          m_bWorkerRunning(false),
+          m_bClearPending(false),
+          m_stableCallbacks(0),
+          m_dTimeRatioInverse(0.0),
+          m_inputFifo(kWorkerFifoSize),
+          m_outputFifo(kWorkerFifoSize),
+          m_bWorkerOwnsStretcher(false),
+          m_bWorkerBusy(false),
+          m_bWorkerQuit(false),
+          m_workerTimeRatio(1.0),
+          m_workerPitchScale(1.0),
+          m_worker_buffer_interleaved(SampleUtil::alloc(MAX_BUFFER_LEN)),
+          m_bWorkerThreadStarted(false) {
+    connect(this,
+            &EngineBufferScaleRubberBand::workerThreadRequested,
+            this,
+            &EngineBufferScaleRubberBand::slotWorkerThreadRequested,
+            Qt::QueuedConnection);
     m_retrieve_buffer[0] = SampleUtil::alloc(MAX_BUFFER_LEN);
     m_retrieve_buffer[1] = SampleUtil::alloc(MAX_BUFFER_LEN);
+    m_worker_buffer[0] = SampleUtil::alloc(MAX_BUFFER_LEN);
+    m_worker_buffer[1] = SampleUtil::alloc(MAX_BUFFER_LEN);
     // Initialize the internal buffers to prevent re-allocations
     // in the real-time thread.
     onSampleRateChanged();
 }
 
 EngineBufferScaleRubberBand::~EngineBufferScaleRubberBand() {
+    // The worker releases the stretcher before it checks m_bWorkerQuit
+    m_bWorkerOwnsStretcher.store(false);
+    quitWorkerThread();
+
     SampleUtil::free(m_buffer_back);
     SampleUtil::free(m_retrieve_buffer[0]);
     SampleUtil::free(m_retrieve_buffer[1]);
+    SampleUtil::free(m_worker_buffer[0]);
+    SampleUtil::free(m_worker_buffer[1]);
+    SampleUtil::free(m_worker_buffer_interleaved);
+}
+
+void EngineBufferScaleRubberBand::setMultiThreaded(bool enable) {
+    m_bMultiThreaded.store(enable);
+    if (!enable) {
+        quitWorkerThread();
+    }
+}
+
+void EngineBufferScaleRubberBand::releaseWorkerThread() {
+    if (!m_bWorkerThreadRequested) {
+        return;
+    }
+    m_bWorkerThreadRequested = false;
+    // The handover is completed by the next scaleBuffer() if the worker
+    // is still busy
+    stopWorker();
+    emit workerThreadRequested(false);
+}
+
+void EngineBufferScaleRubberBand::slotWorkerThreadRequested(bool running) {
+    if (running && m_bMultiThreaded.load()) {
+        startWorkerThread();
+    } else {
+        quitWorkerThread();
+    }
+}
+
+void EngineBufferScaleRubberBand::startWorkerThread() {
+    if (!m_pWorker) {
+        m_pWorker = std::make_unique<Worker>(this);
+    }
+    if (m_bWorkerThreadStarted.load()) {
+        return;
+    }
+    m_bWorkerQuit.store(false);
+    // The output of the worker is needed by the next callback
+    m_pWorker->start(QThread::TimeCriticalPriority);
+    m_bWorkerThreadStarted.store(true);
+}
+
+void EngineBufferScaleRubberBand::quitWorkerThread() {
+    if (!m_bWorkerThreadStarted.load()) {
+        return;
+    }
+    // The engine thread does not hand over the stretcher anymore. If it
+    // has just done so, the worker finishes its current block and the
+    // engine thread takes the stretcher back after an underflow.
+    m_bWorkerThreadStarted.store(false);
+    m_bWorkerQuit.store(true);
+    m_pWorker->wake();
+    m_pWorker->wait();
 }
 
 void EngineBufferScaleRubberBand::setScaleParameters(double base_rate,
@@ -49,7 +168,7 @@ void EngineBufferScaleRubberBand::setScaleParameters(double base_rate,
                                                      double* pPitchRatio) {
     // Negative speed means we are going backwards. pitch does not affect
     // the playback direction.
-    m_bBackwards = *pTempoRatio < 0;
+    const bool backwards = *pTempoRatio < 0;
 
     // Due to a bug in RubberBand, setting the timeRatio to a large value can
     // cause division-by-zero SIGFPEs. We limit the minimum seek speed to
@@ -71,37 +190,62 @@ void EngineBufferScaleRubberBand::setScaleParameters(double base_rate,
     // no-op.
     double pitchScale = fabs(base_rate * *pPitchRatio);
 
-    if (pitchScale > 0) {
-        //qDebug() << "EngineBufferScaleRubberBand setPitchScale" << *pitch << pitchScale;
-        m_pRubberBand->setPitchScale(pitchScale);
-    }
-
     // RubberBand handles checking for whether the change in timeRatio is a
     // no-op. Time ratio is the ratio of stretched to unstretched duration. So 1
     // second in real duration is 0.5 seconds in stretched duration if tempo is
     // 2.
     double timeRatioInverse = base_rate * speed_abs;
-    if (timeRatioInverse > 0) {
-        //qDebug() << "EngineBufferScaleRubberBand setTimeRatio" << 1 / timeRatioInverse;
-        m_pRubberBand->setTimeRatio(1.0 / timeRatioInverse);
+
+    const bool rateJump = backwards != m_bBackwards ||
+            timeRatioInverse <= 0 || m_dTimeRatioInverse <= 0 ||
+            fabs(timeRatioInverse - m_dTimeRatioInverse) >
+                    kRateJumpThreshold * m_dTimeRatioInverse;
+    if (rateJump) {
+        // The output that has been stretched ahead is still played, but
+        // everything after it follows the new rate immediately
+        stopWorker();
+        m_stableCallbacks = 0;
+    } else if (m_stableCallbacks < kStableCallbacksBeforeHandover) {
+        ++m_stableCallbacks;
     }
+    m_bBackwards = backwards;
 
-    if (runningEngineVersion() == 2) {
-        if (m_pRubberBand->getInputIncrement() == 0) {
-            qWarning() << "EngineBufferScaleRubberBand inputIncrement is 0."
-                       << "On RubberBand <=1.8.1 a SIGFPE is imminent despite"
-                       << "our workaround. Taking evasive action."
-                       << "Please file an issue on https://github.com/mixxxdj/mixxx/issues";
-
-            // This is much slower than the minimum seek speed workaround above.
-            while (m_pRubberBand->getInputIncrement() == 0) {
-                timeRatioInverse += 0.001;
-                m_pRubberBand->setTimeRatio(1.0 / timeRatioInverse);
+    if (m_bWorkerRunning) {
+        // Small changes are applied by the worker before it stretches the
+        // next block, or when the pending handover has been completed
+        if (pitchScale > 0) {
+            m_workerPitchScale.store(pitchScale);
+        }
+        m_workerTimeRatio.store(1.0 / timeRatioInverse);
+    } else {
+        if (pitchScale > 0) {
+            //qDebug() << "EngineBufferScaleRubberBand setPitchScale" << *pitch << pitchScale;
+            m_pRubberBand->setPitchScale(pitchScale);
+        }
+
+        if (timeRatioInverse > 0) {
+            //qDebug() << "EngineBufferScaleRubberBand setTimeRatio" << 1 / timeRatioInverse;
+            m_pRubberBand->setTimeRatio(1.0 / timeRatioInverse);
+        }
+
+        if (runningEngineVersion() == 2) {
+            if (m_pRubberBand->getInputIncrement() == 0) {
+                qWarning() << "EngineBufferScaleRubberBand inputIncrement is 0."
+                           << "On RubberBand <=1.8.1 a SIGFPE is imminent despite"
+                           << "our workaround. Taking evasive action."
+                           << "Please file an issue on https://github.com/mixxxdj/mixxx/issues";
+
+                // This is much slower than the minimum seek speed workaround above.
+                while (m_pRubberBand->getInputIncrement() == 0) {
+                    timeRatioInverse += 0.001;
+                    m_pRubberBand->setTimeRatio(1.0 / timeRatioInverse);
+                }
+                speed_abs = timeRatioInverse / base_rate;
+                *pTempoRatio = m_bBackwards ? -speed_abs : speed_abs;
             }
-            speed_abs = timeRatioInverse / base_rate;
-            *pTempoRatio = m_bBackwards ? -speed_abs : speed_abs;
         }
     }
+    m_dTimeRatioInverse = timeRatioInverse;
     // Used by other methods so we need to keep them up to date.
     m_dBaseRate = base_rate;
     m_dTempoRatio = speed_abs;
@@ -112,6 +256,11 @@ void EngineBufferScaleRubberBand::onSampleRateChanged() {
     // TODO: Resetting the sample rate will cause internal
     // memory allocations that may block the real-time thread.
     // When is this function actually invoked??
+    waitForWorkerStopped();
+    // Samples at the previous rate
+    m_inputFifo.flushReadData(m_inputFifo.readAvailable());
+    m_outputFifo.flushReadData(m_outputFifo.readAvailable());
+    m_stableCallbacks = 0;
     if (!getOutputSignal().isValid()) {
         m_pRubberBand.reset();
         return;
@@ -142,6 +291,15 @@ void EngineBufferScaleRubberBand::clear() {
     VERIFY_OR_DEBUG_ASSERT(m_pRubberBand) {
         return;
     }
+    m_stableCallbacks = 0;
+    // The engine thread is the reader of the output FIFO
+    m_outputFifo.flushReadData(m_outputFifo.readAvailable());
+    if (!stopWorker()) {
+        // The worker still reads the input FIFO and uses the stretcher
+        m_bClearPending = true;
+        return;
+    }
+    m_inputFifo.flushReadData(m_inputFifo.readAvailable());
     m_pRubberBand->reset();
 }
 
@@ -181,9 +339,89 @@ double EngineBufferScaleRubberBand::scaleBuffer(
         return 0.0;
     }
 
+    if (m_bMultiThreaded.load() != m_bWorkerThreadRequested) {
+        m_bWorkerThreadRequested = !m_bWorkerThreadRequested;
+        if (m_bWorkerThreadRequested) {
+            // This deck stretches for the first time since multi-threading
+            // has been enabled or keylock has been turned off
+            emit workerThreadRequested(true);
+        }
+    }
+
+    if (m_bClearPending) {
+        // The output after a seek must not be delayed until the worker
+        // releases the stretcher. It does so after its current process()
+        // call of at most kRubberBandBlockSize frames, which takes only a
+        // fraction of a callback.
+        waitForWorkerStopped();
+    } else if (m_bWorkerRunning &&
+            (!m_bMultiThreaded.load() || !m_bWorkerOwnsStretcher.load())) {
+        // Disabled or a handover is pending
+        stopWorker();
+    }
+    DEBUG_ASSERT(!m_bClearPending);
+
+    const SINT output_frames = getOutputSignal().samples2frames(iOutputBufferSize);
+    SINT total_received_frames = readStretchedAhead(pOutputBuffer, output_frames);
+    if (m_bWorkerRunning && total_received_frames < output_frames) {
+        // The worker could not keep up. It might have finished more
+        // output while it has been stopped.
+        stopWorker();
+        Counter counter("EngineBufferScaleRubberBand::worker underflow");
+        counter.increment();
+        total_received_frames += readStretchedAhead(
+                pOutputBuffer + getOutputSignal().frames2samples(total_received_frames),
+                output_frames - total_received_frames);
+    }
+
+    SINT remaining_frames = output_frames - total_received_frames;
+    // Unless the worker still has not released the stretcher
+    if (remaining_frames > 0 && !m_bWorkerRunning) {
+        const SINT received_frames = scaleSynchronously(
+                pOutputBuffer + getOutputSignal().frames2samples(total_received_frames),
+                remaining_frames);
+        remaining_frames -= received_frames;
+        total_received_frames += received_frames;
+    }
+
+    if (remaining_frames > 0) {
+        SampleUtil::clear(
+                pOutputBuffer + getOutputSignal().frames2samples(total_received_frames),
+                getOutputSignal().frames2samples(remaining_frames));
+        Counter counter("EngineBufferScaleRubberBand::getScaled underflow");
+        counter.increment();
+    }
+
+    if (!m_bWorkerRunning && m_bMultiThreaded.load() &&
+            m_bWorkerThreadStarted.load() &&
+            m_stableCallbacks >= kStableCallbacksBeforeHandover) {
+        startWorker();
+    }
+    if (m_bWorkerRunning && m_bWorkerOwnsStretcher.load()) {
+        fillWorkerInput(output_frames);
+        m_pWorker->wake();
+    }
+
+    // framesRead is interpreted as the total number of virtual sample frames
+    // consumed to produce the scaled buffer. Due to this, we do not take into
+    // account directionality or starting point.
+    // NOTE(rryan): Why no m_dPitchAdjust here? Pitch does not change the time
+    // ratio. m_dSpeedAdjust is the ratio of unstretched time to stretched
+    // time. So, if we used total_received_frames in stretched time, then
+    // multiplying that by the ratio of unstretched time to stretched time
+    // will get us the unstretched sample frames read.
+    double framesRead = m_dBaseRate * m_dTempoRatio * total_received_frames;
+
+    return framesRead;
+}
+
+SINT EngineBufferScaleRubberBand::scaleSynchronously(
+        CSAMPLE* pOutputBuffer,
+        SINT frames) {
+    DEBUG_ASSERT(!m_bWorkerRunning);
     SINT total_received_frames = 0;
 
-    SINT remaining_frames = getOutputSignal().samples2frames(iOutputBufferSize);
+    SINT remaining_frames = frames;
     CSAMPLE* read = pOutputBuffer;
     bool last_read_failed = false;
     bool break_out_after_retrieve_and_reset_rubberband = false;
@@ -224,13 +462,7 @@ double EngineBufferScaleRubberBand::scaleBuffer(
         //qDebug() << "iLenFramesRequired" << iLenFramesRequired;
 
         if (remaining_frames > 0 && iLenFramesRequired > 0) {
-            SINT iAvailSamples = m_pReadAheadManager->getNextSamples(
-                        // The value doesn't matter here. All that matters is we
-                        // are going forward or backward.
-                        (m_bBackwards ? -1.0 : 1.0) * m_dBaseRate * m_dTempoRatio,
-                        m_buffer_back,
-                        getOutputSignal().frames2samples(iLenFramesRequired));
-            SINT iAvailFrames = getOutputSignal().samples2frames(iAvailSamples);
+            SINT iAvailFrames = getNextInputFrames(iLenFramesRequired);
 
             if (iAvailFrames > 0) {
                 last_read_failed = false;
@@ -247,24 +479,151 @@ double EngineBufferScaleRubberBand::scaleBuffer(
             }
         }
     }
+    return total_received_frames;
+}
 
-    if (remaining_frames > 0) {
-        SampleUtil::clear(read, getOutputSignal().frames2samples(remaining_frames));
-        Counter counter("EngineBufferScaleRubberBand::getScaled underflow");
-        counter.increment();
+SINT EngineBufferScaleRubberBand::getNextInputFrames(SINT frames) {
+    DEBUG_ASSERT(!m_bWorkerRunning);
+    const SINT samples = getOutputSignal().frames2samples(frames);
+    SINT read_samples = m_inputFifo.read(m_buffer_back, samples);
+    if (read_samples < samples) {
+        read_samples += m_pReadAheadManager->getNextSamples(
+                // The value doesn't matter here. All that matters is we
+                // are going forward or backward.
+                (m_bBackwards ? -1.0 : 1.0) * m_dBaseRate * m_dTempoRatio,
+                m_buffer_back + read_samples,
+                samples - read_samples);
     }
+    return getOutputSignal().samples2frames(read_samples);
+}
 
-    // framesRead is interpreted as the total number of virtual sample frames
-    // consumed to produce the scaled buffer. Due to this, we do not take into
-    // account directionality or starting point.
-    // NOTE(rryan): Why no m_dPitchAdjust here? Pitch does not change the time
-    // ratio. m_dSpeedAdjust is the ratio of unstretched time to stretched
-    // time. So, if we used total_received_frames in stretched time, then
-    // multiplying that by the ratio of unstretched time to stretched time
-    // will get us the unstretched sample frames read.
-    double framesRead = m_dBaseRate * m_dTempoRatio * total_received_frames;
+SINT EngineBufferScaleRubberBand::readStretchedAhead(
+        CSAMPLE* pOutputBuffer,
+        SINT frames) {
+    return getOutputSignal().samples2frames(m_outputFifo.read(
+            pOutputBuffer, getOutputSignal().frames2samples(frames)));
+}
 
-    return framesRead;
+void EngineBufferScaleRubberBand::startWorker() {
+    DEBUG_ASSERT(!m_bWorkerRunning);
+    DEBUG_ASSERT(m_pWorker);
+    if (!m_pRubberBand || m_dTimeRatioInverse <= 0) {
+        return;
+    }
+    m_workerTimeRatio.store(m_pRubberBand->getTimeRatio());
+    m_workerPitchScale.store(m_pRubberBand->getPitchScale());
+    // Publishes all previous modifications of the stretcher to the worker
+    m_bWorkerOwnsStretcher.store(true);
+    m_bWorkerRunning = true;
+}
+
+bool EngineBufferScaleRubberBand::stopWorker() {
+    if (!m_bWorkerRunning) {
+        return true;
+    }
+    m_bWorkerOwnsStretcher.store(false);
+    // The worker announces that it is busy before checking the ownership,
+    // so it will not access the stretcher anymore if it is not busy now.
+    // Waiting for it would block the callback for a whole process() call.
+    if (m_bWorkerBusy.load()) {
+        return false;
+    }
+    m_bWorkerRunning = false;
+    onWorkerStopped();
+    return true;
+}
+
+void EngineBufferScaleRubberBand::waitForWorkerStopped() {
+    while (!stopWorker()) {
+        QThread::yieldCurrentThread();
+    }
+}
+
+void EngineBufferScaleRubberBand::onWorkerStopped() {
+    if (m_bClearPending) {
+        m_bClearPending = false;
+        m_inputFifo.flushReadData(m_inputFifo.readAvailable());
+        m_outputFifo.flushReadData(m_outputFifo.readAvailable());
+        m_pRubberBand->reset();
+    }
+    // The latest parameters have only been passed to the worker
+    m_pRubberBand->setTimeRatio(m_workerTimeRatio.load());
+    m_pRubberBand->setPitchScale(m_workerPitchScale.load());
+}
+
+void EngineBufferScaleRubberBand::fillWorkerInput(SINT outputFrames) {
+    DEBUG_ASSERT(m_dTimeRatioInverse > 0);
+    // Input that is waiting for the worker will result in this many output
+    // frames. Frames that are buffered by the stretcher itself are not
+    // accounted for and add to the lookahead.
+    const double pendingFrames =
+            getOutputSignal().samples2frames(m_outputFifo.readAvailable()) +
+            getOutputSignal().samples2frames(m_inputFifo.readAvailable()) /
+                    m_dTimeRatioInverse;
+    const double missingFrames = kLookaheadCallbacks * outputFrames - pendingFrames;
+    if (missingFrames <= 0) {
+        return;
+    }
+    const SINT inputFrames = math_min3(
+            static_cast<SINT>(std::ceil(missingFrames * m_dTimeRatioInverse)),
+            getOutputSignal().samples2frames(m_inputFifo.writeAvailable()),
+            getOutputSignal().samples2frames(MAX_BUFFER_LEN));
+    if (inputFrames <= 0) {
+        return;
+    }
+    const SINT readSamples = m_pReadAheadManager->getNextSamples(
+            (m_bBackwards ? -1.0 : 1.0) * m_dBaseRate * m_dTempoRatio,
+            m_buffer_back,
+            getOutputSignal().frames2samples(inputFrames));
+    m_inputFifo.write(m_buffer_back, readSamples);
+}
+
+void EngineBufferScaleRubberBand::processAhead() {
+    const SINT maxFrames = getOutputSignal().samples2frames(MAX_BUFFER_LEN);
+    while (m_bWorkerOwnsStretcher.load()) {
+        m_pRubberBand->setTimeRatio(m_workerTimeRatio.load());
+        m_pRubberBand->setPitchScale(m_workerPitchScale.load());
+
+        const SINT availableFrames = m_pRubberBand->available();
+        if (availableFrames > 0) {
+            const SINT writableFrames =
+                    getOutputSignal().samples2frames(m_outputFifo.writeAvailable());
+            if (writableFrames == 0) {
+                // Far enough ahead
+                break;
+            }
+            const SINT framesToRead = math_min3(availableFrames, writableFrames, maxFrames);
+            const SINT receivedFrames = static_cast<SINT>(
+                    m_pRubberBand->retrieve(m_worker_buffer, framesToRead));
+            SampleUtil::interleaveBuffer(m_worker_buffer_interleaved,
+                    m_worker_buffer[0],
+                    m_worker_buffer[1],
+                    receivedFrames);
+            m_outputFifo.write(m_worker_buffer_interleaved,
+                    getOutputSignal().frames2samples(receivedFrames));
+            continue;
+        }
+
+        SINT requiredFrames = static_cast<SINT>(m_pRubberBand->getSamplesRequired());
+        if (requiredFrames == 0) {
+            // See the workaround in scaleSynchronously()
+            requiredFrames = kRubberBandBlockSize;
+        }
+        const SINT inputFrames = math_min3(requiredFrames,
+                static_cast<SINT>(kRubberBandBlockSize),
+                getOutputSignal().samples2frames(m_inputFifo.readAvailable()));
+        if (inputFrames == 0) {
+            // Waiting for more input
+            break;
+        }
+        m_inputFifo.read(m_worker_buffer_interleaved,
+                getOutputSignal().frames2samples(inputFrames));
+        SampleUtil::deinterleaveBuffer(m_worker_buffer[0],
+                m_worker_buffer[1],
+                m_worker_buffer_interleaved,
+                inputFrames);
+        m_pRubberBand->process(m_worker_buffer, inputFrames, false);
+    }
 }
 
 // static
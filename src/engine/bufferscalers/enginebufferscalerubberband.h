@@ -1,6 +1,11 @@
 #pragma once
 
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+
 #include "engine/bufferscalers/enginebufferscale.h"
+#include "util/fifo.h"
 #include "util/memory.h"
 
 namespace RubberBand {
@@ -23,6 +28,21 @@ class EngineBufferScaleRubberBand : public EngineBufferScale {
     // Enable engine v3 if available
     void useEngineFiner(bool enable);
 
+    /// Stretch ahead of the audio callback on a dedicated worker thread.
+    /// The input is still fetched from the ReadAheadManager by the engine
+    /// thread and passed to the worker, which returns the stretched output
+    /// through a lock-free FIFO. The engine thread takes over and stretches
+    /// synchronously after seeks, rate jumps, or if the worker could not
+    /// keep up, and hands over to the worker again once the rate is stable.
+    /// The worker thread is only started once this scaler actually
+    /// stretches and quits when it is disabled or releaseWorkerThread() is
+    /// invoked. Must be invoked from the thread that owns this object.
+    void setMultiThreaded(bool enable);
+
+    /// Invoked by the engine thread when keylock is not used anymore. The
+    /// worker thread quits and is started again by the next scaleBuffer().
+    void releaseWorkerThread();
+
     void setScaleParameters(double base_rate,
                             double* pTempoRatio,
                             double* pPitchRatio) override;
@@ -34,6 +54,13 @@ class EngineBufferScaleRubberBand : public EngineBufferScale {
     // Flush buffer.
     void clear() override;
 
+  signals:
+    // Emitted by the engine thread, which must not start or join threads
+    void workerThreadRequested(bool running);
+
+  private slots:
+    void slotWorkerThreadRequested(bool running);
+
   private:
     // Reset RubberBand library with new audio signal
     void onSampleRateChanged() override;
@@ -43,6 +70,50 @@ class EngineBufferScaleRubberBand : public EngineBufferScale {
     void deinterleaveAndProcess(const CSAMPLE* pBuffer, SINT frames, bool flush);
     SINT retrieveAndDeinterleave(CSAMPLE* pBuffer, SINT frames);
 
+    // Stretches synchronously on the engine thread
+    SINT scaleSynchronously(CSAMPLE* pOutputBuffer, SINT frames);
+    // Input that has been passed to the worker but not consumed yet
+    // precedes any further input from the ReadAheadManager
+    SINT getNextInputFrames(SINT frames);
+    // Output that has already been stretched ahead
+    SINT readStretchedAhead(CSAMPLE* pOutputBuffer, SINT frames);
+
+    // Hands the stretcher over to the worker or takes it back. Taking it
+    // back never waits for the worker: If the worker is still busy, the
+    // stretcher stays with it and stopWorker() returns false. The handover
+    // is then completed by a later call.
+    void startWorker();
+    bool stopWorker();
+    // Waits until the worker has finished its current process() call. Only
+    // for non real-time code paths and after seeks, which need the
+    // stretcher immediately.
+    void waitForWorkerStopped();
+    void startWorkerThread();
+    void quitWorkerThread();
+    // Applies the parameters and requests that could not be applied while
+    // the worker owned the stretcher
+    void onWorkerStopped();
+    // Passes input for the next callbacks to the worker
+    void fillWorkerInput(SINT outputFrames);
+    // Invoked by the worker thread while owning the stretcher
+    void processAhead();
+
+    class Worker : public QThread {
+      public:
+        explicit Worker(EngineBufferScaleRubberBand* pScale);
+
+        void wake() {
+            m_semaWake.release();
+        }
+
+      protected:
+        void run() override;
+
+      private:
+        EngineBufferScaleRubberBand* const m_pScale;
+        QSemaphore m_semaWake;
+    };
+
     // The read-ahead manager that we use to fetch samples
     ReadAheadManager* m_pReadAheadManager;
 
@@ -55,4 +126,38 @@ class EngineBufferScaleRubberBand : public EngineBufferScale {
     bool m_bBackwards;
 
     bool m_useEngineFiner;
+
+    std::atomic<bool> m_bMultiThreaded;
+    // Only accessed by the engine thread. True after the worker thread has
+    // been requested until it has been released.
+    bool m_bWorkerThreadRequested;
+    // Only accessed by the engine thread. True while the worker owns the
+    // stretcher or the handover back to the engine thread is pending.
+    bool m_bWorkerRunning;
+    // clear() has been requested while the handover was pending
+    bool m_bClearPending;
+    int m_stableCallbacks;
+    double m_dTimeRatioInverse;
+
+    // Engine thread -> worker: interleaved input samples
+    FIFO<CSAMPLE> m_inputFifo;
+    // Worker -> engine thread: interleaved output samples
+    FIFO<CSAMPLE> m_outputFifo;
+
+    // Set by the engine thread while the worker owns the stretcher
+    std::atomic<bool> m_bWorkerOwnsStretcher;
+    // Set by the worker while it accesses the stretcher
+    std::atomic<bool> m_bWorkerBusy;
+    std::atomic<bool> m_bWorkerQuit;
+    // Applied by the worker between process() calls
+    std::atomic<double> m_workerTimeRatio;
+    std::atomic<double> m_workerPitchScale;
+
+    CSAMPLE* m_worker_buffer[2];
+    CSAMPLE* m_worker_buffer_interleaved;
+
+    // Created once and published by m_bWorkerThreadStarted
+    std::unique_ptr<Worker> m_pWorker;
+    // The engine thread only hands the stretcher over while this is set
+    std::atomic<bool> m_bWorkerThreadStarted;
 };
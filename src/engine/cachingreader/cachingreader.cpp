@@ -62,7 +62,12 @@ CachingReader::CachingReader(const QString& group,
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
           m_sampleBuffer(CachingReaderChunk::kSamples * kNumberOfCachedChunksInMemory),
-          m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusUpdateFIFO) {
+          m_chunkHitCounter(QStringLiteral("CachingReader::read(): Chunk cache hit")),
+          m_chunkMissCounter(QStringLiteral(
+                  "CachingReader::read(): Failed to read chunk on cache miss")),
+          m_prefetchedChunkCounter(QStringLiteral(
+                  "CachingReader::hintAndMaybeWake(): Prefetched chunks")),
+          m_worker(group, config, &m_chunkReadRequestFIFO, &m_readerStatusUpdateFIFO) {
     m_allocatedCachingReaderChunks.reserve(kNumberOfCachedChunksInMemory);
     // Divide up the allocated raw memory buffer into total_chunks
     // chunks. Initialize each chunk to hold nothing and add it to the free
@@ -222,6 +227,16 @@ void CachingReader::newTrack(TrackPointer pTrack) {
     m_worker.newTrack(std::move(pTrack));
 }
 
+bool CachingReader::isIdle() const {
+    int pendingReadRequests = 0;
+    for (const auto& pChunk : m_chunks) {
+        if (pChunk->getState() == CachingReaderChunkForOwner::READ_PENDING) {
+            ++pendingReadRequests;
+        }
+    }
+    return m_readerStatusUpdateFIFO.readAvailable() >= pendingReadRequests;
+}
+
 // Called from the engine thread
 void CachingReader::process() {
     ReaderStatusUpdate update;
@@ -275,6 +290,7 @@ void CachingReader::process() {
                 }
                 // Reset the readable frame index range
                 m_readableFrameIndexRange = update.readableFrameIndexRange();
+                m_prefetcher.reset();
                 m_state.storeRelease(STATE_TRACK_LOADED);
             } else {
                 DEBUG_ASSERT(update.status == TRACK_UNLOADED);
@@ -329,6 +345,11 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
 
     SINT samplesRemaining = numSamples;
 
+    // The position where the next read will continue
+    m_prefetcher.notifyRead(CachingReaderChunk::samples2frames(
+            reverse ? sample : startSample + numSamples));
+    int chunkHits = 0;
+
     // Process new messages from the reader thread before looking up
     // the first chunk and to update m_readableFrameIndexRange
     process();
@@ -423,6 +444,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
                 mixxx::IndexRange bufferedFrameIndexRange;
                 const CachingReaderChunkForOwner* const pChunk = lookupChunkAndFreshen(chunkIndex);
                 if (pChunk && (pChunk->getState() == CachingReaderChunkForOwner::READY)) {
+                    ++chunkHits;
                     if (reverse) {
                         bufferedFrameIndexRange =
                                 pChunk->readBufferedSampleFramesReverse(
@@ -440,7 +462,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
                     // pending.
                     DEBUG_ASSERT(!pChunk ||
                             (pChunk->getState() == CachingReaderChunkForOwner::READ_PENDING));
-                    Counter("CachingReader::read(): Failed to read chunk on cache miss")++;
+                    m_chunkMissCounter++;
                     if (kLogger.traceEnabled()) {
                         kLogger.trace()
                                 << "Cache miss for chunk with index"
@@ -497,6 +519,9 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
             }
         }
     }
+    if (chunkHits > 0) {
+        m_chunkHitCounter += chunkHits;
+    }
     // Finally fill the remaining buffer with silence
     DEBUG_ASSERT(samplesRemaining >= 0);
     if (samplesRemaining > 0) {
@@ -516,18 +541,22 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
     // any are not, then wake.
     bool shouldWake = false;
 
+    // The frames that must be available after jumping to a hinted position
+    // depend on the current speed
+    const SINT defaultHintFrames = m_prefetcher.jumpTargetFrameCount(kDefaultHintFrames);
+
     for (const auto& hint: hintList) {
         SINT hintFrame = hint.frame;
         SINT hintFrameCount = hint.frameCount;
 
         // Handle some special length values
         if (hintFrameCount == Hint::kFrameCountForward) {
-        	hintFrameCount = kDefaultHintFrames;
+            hintFrameCount = defaultHintFrames;
         } else if (hintFrameCount == Hint::kFrameCountBackward) {
-        	hintFrame -= kDefaultHintFrames;
-        	hintFrameCount = kDefaultHintFrames;
+            hintFrame -= defaultHintFrames;
+            hintFrameCount = defaultHintFrames;
             if (hintFrame < 0) {
-            	hintFrameCount += hintFrame;
+                hintFrameCount += hintFrame;
                 if (hintFrameCount <= 0) {
                     continue;
                 }
@@ -546,43 +575,21 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
         if (readableFrameIndexRange.empty()) {
             continue;
         }
+        if (requestChunks(readableFrameIndexRange) > 0) {
+            shouldWake = true;
+        }
+    }
 
-        const int firstChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.start());
-        const int lastChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.end() - 1);
-        for (int chunkIndex = firstChunkIndex; chunkIndex <= lastChunkIndex; ++chunkIndex) {
-            CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
-            if (!pChunk) {
-                shouldWake = true;
-                pChunk = allocateChunkExpireLRU(chunkIndex);
-                if (!pChunk) {
-                    kLogger.warning()
-                            << "Failed to allocate chunk"
-                            << chunkIndex
-                            << "for read request";
-                    continue;
-                }
-                // Do not insert the allocated chunk into the MRU/LRU list,
-                // because it will be handed over to the worker immediately
-                CachingReaderChunkReadRequest request;
-                request.giveToWorker(pChunk);
-                if (kLogger.traceEnabled()) {
-                    kLogger.trace()
-                            << "Requesting read of chunk"
-                            << request.chunk;
-                }
-                if (m_chunkReadRequestFIFO.write(&request, 1) != 1) {
-                    kLogger.warning()
-                            << "Failed to submit read request for chunk"
-                            << chunkIndex;
-                    // Revoke the chunk from the worker and free it
-                    pChunk->takeFromWorker();
-                    freeChunk(pChunk);
-                }
-            } else if (pChunk->getState() == CachingReaderChunkForOwner::READY) {
-                // This will cause the chunk to be 'freshened' in the cache. The
-                // chunk will be moved to the end of the LRU list.
-                freshenChunk(pChunk);
-            }
+    // The predicted frames are requested last, the explicit hints are
+    // more important if the request FIFO is full.
+    const auto prefetchFrameIndexRange = intersect(
+            m_readableFrameIndexRange,
+            m_prefetcher.predictedFrameIndexRange());
+    if (!prefetchFrameIndexRange.empty()) {
+        const int prefetchedChunks = requestChunks(prefetchFrameIndexRange);
+        if (prefetchedChunks > 0) {
+            m_prefetchedChunkCounter += prefetchedChunks;
+            shouldWake = true;
         }
     }
 
@@ -591,3 +598,46 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
         m_worker.workReady();
     }
 }
+
+int CachingReader::requestChunks(const mixxx::IndexRange& frameIndexRange) {
+    DEBUG_ASSERT(!frameIndexRange.empty());
+    int requestedChunks = 0;
+    const int firstChunkIndex = CachingReaderChunk::indexForFrame(frameIndexRange.start());
+    const int lastChunkIndex = CachingReaderChunk::indexForFrame(frameIndexRange.end() - 1);
+    for (int chunkIndex = firstChunkIndex; chunkIndex <= lastChunkIndex; ++chunkIndex) {
+        CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
+        if (!pChunk) {
+            ++requestedChunks;
+            pChunk = allocateChunkExpireLRU(chunkIndex);
+            if (!pChunk) {
+                kLogger.warning()
+                        << "Failed to allocate chunk"
+                        << chunkIndex
+                        << "for read request";
+                continue;
+            }
+            // Do not insert the allocated chunk into the MRU/LRU list,
+            // because it will be handed over to the worker immediately
+            CachingReaderChunkReadRequest request;
+            request.giveToWorker(pChunk);
+            if (kLogger.traceEnabled()) {
+                kLogger.trace()
+                        << "Requesting read of chunk"
+                        << request.chunk;
+            }
+            if (m_chunkReadRequestFIFO.write(&request, 1) != 1) {
+                kLogger.warning()
+                        << "Failed to submit read request for chunk"
+                        << chunkIndex;
+                // Revoke the chunk from the worker and free it
+                pChunk->takeFromWorker();
+                freeChunk(pChunk);
+            }
+        } else if (pChunk->getState() == CachingReaderChunkForOwner::READY) {
+            // This will cause the chunk to be 'freshened' in the cache. The
+            // chunk will be moved to the end of the LRU list.
+            freshenChunk(pChunk);
+        }
+    }
+    return requestedChunks;
+}
@@ -7,10 +7,12 @@
 #include <QVector>
 #include <list>
 
+#include "engine/cachingreader/cachingreaderprefetcher.h"
 #include "engine/cachingreader/cachingreaderworker.h"
 #include "engine/engineworker.h"
 #include "preferences/usersettings.h"
 #include "track/track_decl.h"
+#include "util/counter.h"
 #include "util/fifo.h"
 #include "util/types.h"
 
@@ -114,6 +116,13 @@ class CachingReader : public QObject {
     // for this to take effect.
     void newTrack(TrackPointer pTrack);
 
+    // Returns true if the worker has answered all pending chunk read
+    // requests, i.e. the next call of process() will receive every chunk
+    // that has been requested so far. Must only be called from the thread
+    // that calls process(). Only needed when the engine is driven without
+    // a sound device and can afford to wait for the worker.
+    bool isIdle() const;
+
     void setScheduler(EngineWorkerScheduler* pScheduler) {
         m_worker.setScheduler(pScheduler);
     }
@@ -157,6 +166,11 @@ class CachingReader : public QObject {
     // Gets a chunk from the free list, frees the LRU CachingReaderChunk if none available.
     CachingReaderChunkForOwner* allocateChunkExpireLRU(SINT chunkIndex);
 
+    // Requests all chunks of the readable frames in the range that are not
+    // in the cache from the worker and freshens the others. Returns the
+    // number of requested chunks.
+    int requestChunks(const mixxx::IndexRange& frameIndexRange);
+
     enum State {
         STATE_IDLE,
         STATE_TRACK_LOADING,
@@ -186,5 +200,12 @@ class CachingReader : public QObject {
     // The readable frame index range as reported by the worker.
     mixxx::IndexRange m_readableFrameIndexRange;
 
+    // Predicts the frames that will be read next from the recent reads
+    CachingReaderPrefetcher m_prefetcher;
+
+    Counter m_chunkHitCounter;
+    Counter m_chunkMissCounter;
+    Counter m_prefetchedChunkCounter;
+
     CachingReaderWorker m_worker;
 };
@@ -43,16 +43,17 @@ void CachingReaderChunk::init(SINT index) {
     m_bufferedSampleFrames.frameIndexRange() = mixxx::IndexRange();
 }
 
-// Frame index range of this chunk for the given audio source.
+// static
 mixxx::IndexRange CachingReaderChunk::frameIndexRange(
-        const mixxx::AudioSourcePointer& pAudioSource) const {
-    DEBUG_ASSERT(m_index != kInvalidChunkIndex);
+        const mixxx::AudioSourcePointer& pAudioSource,
+        SINT chunkIndex) {
+    DEBUG_ASSERT(chunkIndex != kInvalidChunkIndex);
     if (!pAudioSource) {
         return mixxx::IndexRange();
     }
     const SINT minFrameIndex =
             pAudioSource->frameIndexMin() +
-            frameIndexOffset();
+            chunkIndex * kFrames;
     return intersect(
             mixxx::IndexRange::forward(minFrameIndex, kFrames),
             pAudioSource->frameIndexRange());
@@ -79,6 +80,19 @@ mixxx::IndexRange CachingReaderChunk::bufferSampleFrames(
     return m_bufferedSampleFrames.frameIndexRange();
 }
 
+mixxx::IndexRange CachingReaderChunk::bufferSampleFrames(
+        const mixxx::IndexRange& frameIndexRange,
+        const CSAMPLE* pSamples) {
+    DEBUG_ASSERT(m_index != kInvalidChunkIndex);
+    DEBUG_ASSERT(frameIndexRange.length() <= kFrames);
+    const SINT sampleCount = frames2samples(frameIndexRange.length());
+    SampleUtil::copy(m_sampleBuffer.data(), pSamples, sampleCount);
+    m_bufferedSampleFrames = mixxx::ReadableSampleFrames(
+            frameIndexRange,
+            mixxx::SampleBuffer::ReadableSlice(m_sampleBuffer.data(), sampleCount));
+    return m_bufferedSampleFrames.frameIndexRange();
+}
+
 mixxx::IndexRange CachingReaderChunk::readBufferedSampleFrames(
         CSAMPLE* sampleBuffer,
         const mixxx::IndexRange& frameIndexRange) const {
@@ -48,7 +48,14 @@ public:
 
     // Frame index range of this chunk for the given audio source.
     mixxx::IndexRange frameIndexRange(
-            const mixxx::AudioSourcePointer& pAudioSource) const;
+            const mixxx::AudioSourcePointer& pAudioSource) const {
+        return frameIndexRange(pAudioSource, m_index);
+    }
+    // Frame index range of the chunk with the given index, e.g. for
+    // filling a CachingReaderPcmCache without a chunk object.
+    static mixxx::IndexRange frameIndexRange(
+            const mixxx::AudioSourcePointer& pAudioSource,
+            SINT chunkIndex);
 
     // Read sample frames from the audio source and return the
     // range of frames that have been read.
@@ -56,6 +63,12 @@ public:
             const mixxx::AudioSourcePointer& pAudioSource,
             mixxx::SampleBuffer::WritableSlice tempOutputBuffer);
 
+    // Copy sample frames that have already been decoded, e.g. by
+    // a CachingReaderPcmCache, instead of reading from the audio source.
+    mixxx::IndexRange bufferSampleFrames(
+            const mixxx::IndexRange& frameIndexRange,
+            const CSAMPLE* pSamples);
+
     mixxx::IndexRange readBufferedSampleFrames(
             CSAMPLE* sampleBuffer,
             const mixxx::IndexRange& frameIndexRange) const;
@@ -71,10 +84,6 @@ protected:
     void init(SINT index);
 
 private:
-    SINT frameIndexOffset() const {
-        return m_index * kFrames;
-    }
-
     SINT m_index;
 
     // The worker thread will fill the sample buffer and
@@ -0,0 +1,288 @@
+#include "engine/cachingreader/cachingreaderpcmcache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSet>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "util/assert.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+#include "util/math.h"
+
+// The fixed size header at the start of each file. It is followed by one
+// flag byte per chunk and the samples of all chunks, starting at the next
+// page boundary. The last chunk is padded to the full chunk size.
+struct CachingReaderPcmCache::Header {
+    quint32 magic;
+    quint32 version;
+    quint32 sampleRate;
+    quint32 channelCount;
+    qint64 frameIndexStart;
+    qint64 frameIndexEnd;
+};
+
+namespace {
+
+const mixxx::Logger kLogger("CachingReaderPcmCache");
+
+const QString kFileSuffix = QStringLiteral(".pcm");
+
+constexpr quint32 kMagic = 0x4d585043; // "MXPC"
+constexpr quint32 kVersion = 1;
+
+constexpr qint64 kSampleDataAlignment = 4096;
+
+// The cache files that are currently opened by any deck. Loading the
+// same track into multiple decks must not reset or evict a file that
+// is still mapped by another deck.
+QMutex s_openCacheKeysMutex;
+QSet<mixxx::cache_key_t> s_openCacheKeys;
+
+bool acquireCacheKey(mixxx::cache_key_t cacheKey) {
+    const auto locker = lockMutex(&s_openCacheKeysMutex);
+    if (s_openCacheKeys.contains(cacheKey)) {
+        return false;
+    }
+    s_openCacheKeys.insert(cacheKey);
+    return true;
+}
+
+void releaseCacheKey(mixxx::cache_key_t cacheKey) {
+    const auto locker = lockMutex(&s_openCacheKeysMutex);
+    s_openCacheKeys.remove(cacheKey);
+}
+
+bool isCacheKeyOpen(mixxx::cache_key_t cacheKey) {
+    const auto locker = lockMutex(&s_openCacheKeysMutex);
+    return s_openCacheKeys.contains(cacheKey);
+}
+
+SINT numChunksForFrames(SINT frames) {
+    return (frames + CachingReaderChunk::kFrames - 1) / CachingReaderChunk::kFrames;
+}
+
+qint64 sampleDataOffset(SINT numChunks) {
+    const qint64 headerSize =
+            static_cast<qint64>(sizeof(CachingReaderPcmCache::Header)) + numChunks;
+    return ((headerSize + kSampleDataAlignment - 1) / kSampleDataAlignment) *
+            kSampleDataAlignment;
+}
+
+qint64 fileSizeForFrames(SINT frames) {
+    const SINT numChunks = numChunksForFrames(frames);
+    return sampleDataOffset(numChunks) +
+            static_cast<qint64>(numChunks) * CachingReaderChunk::kSamples *
+            static_cast<qint64>(sizeof(CSAMPLE));
+}
+
+} // anonymous namespace
+
+CachingReaderPcmCache::CachingReaderPcmCache(
+        const QString& directoryPath, qint64 maxDirectorySize)
+        : m_directory(directoryPath),
+          m_maxDirectorySize(maxDirectorySize),
+          m_cacheKey(mixxx::invalidCacheKey()),
+          m_pHeader(nullptr),
+          m_pChunkFlags(nullptr),
+          m_pSamples(nullptr) {
+    if (!QDir().mkpath(m_directory.absolutePath())) {
+        kLogger.warning()
+                << "Failed to create cache directory"
+                << m_directory.absolutePath();
+    }
+}
+
+CachingReaderPcmCache::~CachingReaderPcmCache() {
+    close();
+}
+
+// static
+mixxx::cache_key_t CachingReaderPcmCache::cacheKeyForFile(
+        const mixxx::FileInfo& fileInfo) {
+    return mixxx::cacheKeyFromFileInfo(fileInfo);
+}
+
+QString CachingReaderPcmCache::filePathForKey(mixxx::cache_key_t cacheKey) const {
+    return m_directory.absoluteFilePath(
+            QString::number(cacheKey, 16).rightJustified(16, '0') + kFileSuffix);
+}
+
+bool CachingReaderPcmCache::open(mixxx::cache_key_t cacheKey,
+        const mixxx::IndexRange& frameIndexRange,
+        mixxx::audio::SampleRate sampleRate) {
+    close();
+    VERIFY_OR_DEBUG_ASSERT(mixxx::isValidCacheKey(cacheKey) &&
+            !frameIndexRange.empty() && frameIndexRange.start() >= 0) {
+        return false;
+    }
+    const qint64 fileSize = fileSizeForFrames(frameIndexRange.length());
+    if (fileSize > m_maxDirectorySize) {
+        kLogger.info()
+                << "Track too large for the cache:"
+                << fileSize << "bytes";
+        return false;
+    }
+    if (!acquireCacheKey(cacheKey)) {
+        // Another deck uses the file. Both decks decode independently.
+        return false;
+    }
+
+    m_file.setFileName(filePathForKey(cacheKey));
+    bool reuse = false;
+    if (m_file.exists() && m_file.size() == fileSize &&
+            m_file.open(QIODevice::ReadWrite)) {
+        Header header;
+        reuse = m_file.read(reinterpret_cast<char*>(&header), sizeof(header)) ==
+                        sizeof(header) &&
+                header.magic == kMagic && header.version == kVersion &&
+                header.sampleRate == sampleRate.value() &&
+                header.channelCount == CachingReaderChunk::kChannels &&
+                header.frameIndexStart == frameIndexRange.start() &&
+                header.frameIndexEnd == frameIndexRange.end();
+        if (!reuse) {
+            m_file.close();
+        }
+    }
+    if (!reuse) {
+        evictFiles(fileSize);
+        // Truncating and resizing the file yields a sparse file with all
+        // chunk flags cleared
+        if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate) ||
+                !m_file.resize(fileSize)) {
+            kLogger.warning()
+                    << "Failed to create cache file"
+                    << m_file.fileName()
+                    << m_file.errorString();
+            m_file.close();
+            m_file.remove();
+            releaseCacheKey(cacheKey);
+            return false;
+        }
+    }
+
+    uchar* pData = m_file.map(0, fileSize);
+    if (!pData) {
+        kLogger.warning()
+                << "Failed to map cache file"
+                << m_file.fileName()
+                << m_file.errorString();
+        m_file.close();
+        releaseCacheKey(cacheKey);
+        return false;
+    }
+    m_cacheKey = cacheKey;
+    m_pHeader = reinterpret_cast<Header*>(pData);
+    m_pChunkFlags = pData + sizeof(Header);
+    m_pSamples = reinterpret_cast<CSAMPLE*>(
+            pData + sampleDataOffset(numChunksForFrames(frameIndexRange.length())));
+    if (!reuse) {
+        m_pHeader->magic = kMagic;
+        m_pHeader->version = kVersion;
+        m_pHeader->sampleRate = sampleRate.value();
+        m_pHeader->channelCount = CachingReaderChunk::kChannels;
+        m_pHeader->frameIndexStart = frameIndexRange.start();
+        m_pHeader->frameIndexEnd = frameIndexRange.end();
+    }
+    // The modification time is used for evicting the least recently used files
+    m_file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+void CachingReaderPcmCache::close() {
+    if (!m_pHeader) {
+        return;
+    }
+    m_file.unmap(reinterpret_cast<uchar*>(m_pHeader));
+    m_file.close();
+    m_pHeader = nullptr;
+    m_pChunkFlags = nullptr;
+    m_pSamples = nullptr;
+    releaseCacheKey(m_cacheKey);
+    m_cacheKey = mixxx::invalidCacheKey();
+}
+
+void CachingReaderPcmCache::evictFiles(qint64 requiredSize) {
+    // Oldest files first
+    const QFileInfoList fileInfos = m_directory.entryInfoList(
+            QStringList{QStringLiteral("*") + kFileSuffix},
+            QDir::Files,
+            QDir::Time | QDir::Reversed);
+    qint64 directorySize = requiredSize;
+    for (const auto& fileInfo : fileInfos) {
+        directorySize += fileInfo.size();
+    }
+    for (const auto& fileInfo : fileInfos) {
+        if (directorySize <= m_maxDirectorySize) {
+            break;
+        }
+        if (fileInfo.absoluteFilePath() == m_file.fileName()) {
+            // Will be overwritten
+            directorySize -= fileInfo.size();
+            continue;
+        }
+        bool ok = false;
+        const mixxx::cache_key_t cacheKey =
+                fileInfo.completeBaseName().toULongLong(&ok, 16);
+        if (ok && isCacheKeyOpen(cacheKey)) {
+            continue;
+        }
+        if (QFile::remove(fileInfo.absoluteFilePath())) {
+            directorySize -= fileInfo.size();
+        }
+    }
+}
+
+SINT CachingReaderPcmCache::numChunks() const {
+    VERIFY_OR_DEBUG_ASSERT(m_pHeader) {
+        return 0;
+    }
+    return numChunksForFrames(static_cast<SINT>(
+            m_pHeader->frameIndexEnd - m_pHeader->frameIndexStart));
+}
+
+bool CachingReaderPcmCache::isChunkCached(SINT chunkIndex) const {
+    if (!m_pHeader || chunkIndex < 0 || chunkIndex >= numChunks()) {
+        return false;
+    }
+    return m_pChunkFlags[chunkIndex] != 0;
+}
+
+void CachingReaderPcmCache::setChunkCached(SINT chunkIndex) {
+    VERIFY_OR_DEBUG_ASSERT(m_pHeader && chunkIndex >= 0 && chunkIndex < numChunks()) {
+        return;
+    }
+    m_pChunkFlags[chunkIndex] = 1;
+}
+
+SINT CachingReaderPcmCache::nextUncachedChunk(SINT chunkIndex) const {
+    if (!m_pHeader) {
+        return -1;
+    }
+    const SINT chunkCount = numChunks();
+    for (SINT i = math_max(chunkIndex, SINT(0)); i < chunkCount; ++i) {
+        if (!m_pChunkFlags[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const CSAMPLE* CachingReaderPcmCache::readableSamples(SINT frameIndex) const {
+    DEBUG_ASSERT(m_pHeader);
+    DEBUG_ASSERT(frameIndex >= m_pHeader->frameIndexStart);
+    DEBUG_ASSERT(frameIndex <= m_pHeader->frameIndexEnd);
+    return m_pSamples +
+            CachingReaderChunk::frames2samples(
+                    static_cast<SINT>(frameIndex - m_pHeader->frameIndexStart));
+}
+
+CSAMPLE* CachingReaderPcmCache::writableSamples(SINT frameIndex) {
+    DEBUG_ASSERT(m_pHeader);
+    DEBUG_ASSERT(frameIndex >= m_pHeader->frameIndexStart);
+    DEBUG_ASSERT(frameIndex <= m_pHeader->frameIndexEnd);
+    return m_pSamples +
+            CachingReaderChunk::frames2samples(
+                    static_cast<SINT>(frameIndex - m_pHeader->frameIndexStart));
+}
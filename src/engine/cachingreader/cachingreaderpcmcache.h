@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include "audio/types.h"
+#include "util/cache.h"
+#include "util/class.h"
+#include "util/fileinfo.h"
+#include "util/indexrange.h"
+#include "util/types.h"
+
+/// A fully decoded copy of a track's stereo samples in a memory-mapped file.
+///
+/// The file is organized in the same chunks as the CachingReader. The worker
+/// fills it in the background and for every missed chunk it reads, so that
+/// subsequent misses are served by copying from the mapping instead of
+/// seeking and decoding in the audio source. A flag per chunk records which
+/// chunks have been written completely. The flag is only set after the
+/// samples have been written, so the file stays consistent if Mixxx crashes.
+///
+/// The files are kept in a directory that is shared by all decks and named
+/// after a cache key of the track's file. Reloading a track that is still
+/// in the cache makes all previously decoded chunks available immediately.
+/// The total size of the directory is bounded, the least recently used
+/// files are deleted first.
+///
+/// Not thread-safe, only accessed by the CachingReaderWorker.
+class CachingReaderPcmCache {
+  public:
+    CachingReaderPcmCache(const QString& directoryPath, qint64 maxDirectorySize);
+    ~CachingReaderPcmCache();
+
+    /// Derives the cache key from the location, size and modification
+    /// time of the file. Modifying the file invalidates the cache.
+    static mixxx::cache_key_t cacheKeyForFile(const mixxx::FileInfo& fileInfo);
+
+    /// Opens or creates the cache file for the given key. An existing
+    /// file is only reused if it has been created for the same frame
+    /// index range and sample rate. Returns false if the cache is not
+    /// available for this track, e.g. because the same track is loaded
+    /// into another deck that already uses the file.
+    bool open(mixxx::cache_key_t cacheKey,
+            const mixxx::IndexRange& frameIndexRange,
+            mixxx::audio::SampleRate sampleRate);
+    void close();
+
+    bool isOpen() const {
+        return m_pHeader != nullptr;
+    }
+
+    SINT numChunks() const;
+    bool isChunkCached(SINT chunkIndex) const;
+    void setChunkCached(SINT chunkIndex);
+
+    /// Returns the index of the first chunk at or after the given chunk
+    /// that has not been cached yet, or -1 if there is none.
+    SINT nextUncachedChunk(SINT chunkIndex) const;
+
+    /// The stereo samples starting at the given frame index.
+    const CSAMPLE* readableSamples(SINT frameIndex) const;
+    CSAMPLE* writableSamples(SINT frameIndex);
+
+    /// The file header, defined in the .cpp file.
+    struct Header;
+
+  private:
+    QString filePathForKey(mixxx::cache_key_t cacheKey) const;
+    void evictFiles(qint64 requiredSize);
+
+    const QDir m_directory;
+    const qint64 m_maxDirectorySize;
+
+    mixxx::cache_key_t m_cacheKey;
+    QFile m_file;
+    Header* m_pHeader;
+    quint8* m_pChunkFlags;
+    CSAMPLE* m_pSamples;
+
+    DISALLOW_COPY_AND_ASSIGN(CachingReaderPcmCache);
+};
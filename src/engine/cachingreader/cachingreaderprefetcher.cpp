@@ -0,0 +1,88 @@
+#include "engine/cachingreader/cachingreaderprefetcher.h"
+
+#include <cmath>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "util/math.h"
+
+namespace {
+
+// Weight of the latest read for the smoothed velocity
+constexpr double kVelocitySmoothing = 0.25;
+
+// Decay of the peak speed per read. Keeps the range behind the position
+// prefetched for a few hundred milliseconds after the last direction
+// change while scratching.
+constexpr double kPeakSpeedDecay = 0.98;
+
+// The number of reads to look ahead in the direction of play
+constexpr double kLookaheadReads = 16;
+
+// The number of reads to look around the position in both directions
+// to cover direction changes
+constexpr double kScratchMarginReads = 2;
+
+// Reads that are further away than this multiple of the peak speed are
+// jumps (seeks, loops, hotcues) and don't affect the velocity
+constexpr double kJumpPeakSpeedFactor = 8;
+
+// Don't let the prefetched chunks push out too many other chunks from the
+// cache with its capacity of 80 chunks
+const SINT kMaxPrefetchFrames = 8 * CachingReaderChunk::kFrames;
+const SINT kMaxJumpTargetFrames = 2 * CachingReaderChunk::kFrames;
+
+} // anonymous namespace
+
+CachingReaderPrefetcher::CachingReaderPrefetcher() {
+    reset();
+}
+
+void CachingReaderPrefetcher::reset() {
+    m_nextFrameIndex = 0;
+    m_hasPosition = false;
+    m_velocity = 0;
+    m_peakSpeed = 0;
+}
+
+void CachingReaderPrefetcher::notifyRead(SINT nextFrameIndex) {
+    if (m_hasPosition) {
+        const double delta = static_cast<double>(nextFrameIndex - m_nextFrameIndex);
+        const double jumpThreshold = math_max(
+                static_cast<double>(2 * CachingReaderChunk::kFrames),
+                kJumpPeakSpeedFactor * m_peakSpeed);
+        if (std::abs(delta) <= jumpThreshold) {
+            m_velocity += kVelocitySmoothing * (delta - m_velocity);
+            m_peakSpeed = math_max(std::abs(delta), m_peakSpeed * kPeakSpeedDecay);
+        }
+    }
+    m_nextFrameIndex = nextFrameIndex;
+    m_hasPosition = true;
+}
+
+mixxx::IndexRange CachingReaderPrefetcher::predictedFrameIndexRange() const {
+    if (!m_hasPosition || m_peakSpeed < 1) {
+        return mixxx::IndexRange();
+    }
+    const SINT margin = static_cast<SINT>(
+            math_min(m_peakSpeed * kScratchMarginReads,
+                    static_cast<double>(kMaxPrefetchFrames / 2)));
+    const SINT ahead = static_cast<SINT>(
+            math_min(std::abs(m_velocity) * kLookaheadReads,
+                    static_cast<double>(kMaxPrefetchFrames - 2 * margin)));
+    if (m_velocity >= 0) {
+        return mixxx::IndexRange::between(
+                m_nextFrameIndex - margin,
+                m_nextFrameIndex + ahead + margin);
+    } else {
+        return mixxx::IndexRange::between(
+                m_nextFrameIndex - ahead - margin,
+                m_nextFrameIndex + margin);
+    }
+}
+
+SINT CachingReaderPrefetcher::jumpTargetFrameCount(SINT defaultFrameCount) const {
+    // After a jump the deck continues with the same speed, the target
+    // must be available until the next hint.
+    const SINT frameCount = static_cast<SINT>(m_peakSpeed * kLookaheadReads / 2);
+    return math_clamp(frameCount, defaultFrameCount, kMaxJumpTargetFrames);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "util/indexrange.h"
+#include "util/types.h"
+
+/// Predicts which frames of a track will be read in the near future from
+/// the positions of the recent reads of the engine.
+///
+/// The explicit hints only cover a fixed number of frames around the play
+/// position and the jump targets. This is too short at high rates and lags
+/// behind when the direction changes while scratching. The prefetcher
+/// tracks the smoothed read velocity in frames per read and the recent
+/// peak velocity, and derives
+///  - the range ahead of (and while scratching also behind) the current
+///    position that will be read within the next reads, and
+///  - the number of frames that need to be available at the targets of
+///    a jump, i.e. loop boundaries and hotcues.
+///
+/// Only accessed from the engine thread.
+class CachingReaderPrefetcher {
+  public:
+    CachingReaderPrefetcher();
+
+    /// Forget the history, e.g. when a new track has been loaded.
+    void reset();
+
+    /// Called after each read with the first frame that will be read next
+    /// when continuing in the same direction, i.e. the end of the frames
+    /// that have been read when reading forward and the start when
+    /// reading in reverse.
+    void notifyRead(SINT nextFrameIndex);
+
+    /// The smoothed read velocity in frames per read, negative in reverse.
+    double velocity() const {
+        return m_velocity;
+    }
+
+    /// The frames that are expected to be read next. Empty as long as the
+    /// velocity is unknown.
+    mixxx::IndexRange predictedFrameIndexRange() const;
+
+    /// The number of frames to keep available after the targets of jumps
+    /// (or before when reading in reverse).
+    SINT jumpTargetFrameCount(SINT defaultFrameCount) const;
+
+  private:
+    SINT m_nextFrameIndex;
+    bool m_hasPosition;
+    double m_velocity;
+    double m_peakSpeed;
+};
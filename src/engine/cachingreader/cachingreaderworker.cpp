@@ -6,6 +6,7 @@
 
 #include "control/controlobject.h"
 #include "moc_cachingreaderworker.cpp"
+#include "sources/audiosourcestereoproxy.h"
 #include "sources/soundsourceproxy.h"
 #include "track/track.h"
 #include "util/compatibility/qmutex.h"
@@ -16,16 +17,35 @@ namespace {
 
 mixxx::Logger kLogger("CachingReaderWorker");
 
+// The maximum size of the decoded track cache directory, shared by all
+// decks. 0 disables the cache.
+const ConfigKey kDecodedTrackCacheSizeKey("[Master]", "decoded_track_cache_mb");
+
+const QString kDecodedTrackCacheDirectory = QStringLiteral("/decoded_tracks");
+
 } // anonymous namespace
 
 CachingReaderWorker::CachingReaderWorker(
         const QString& group,
+        UserSettingsPointer pConfig,
         FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
         FIFO<ReaderStatusUpdate>* pReaderStatusFIFO)
         : m_group(group),
           m_tag(QString("CachingReaderWorker %1").arg(m_group)),
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
-          m_pReaderStatusFIFO(pReaderStatusFIFO) {
+          m_pReaderStatusFIFO(pReaderStatusFIFO),
+          m_pcmCacheFillStartChunk(-1),
+          m_nextPcmCacheFillChunk(0),
+          m_pcmCacheFillWrapped(false) {
+    if (pConfig) {
+        const qint64 cacheSizeMB =
+                pConfig->getValue<int>(kDecodedTrackCacheSizeKey, 0);
+        if (cacheSizeMB > 0) {
+            m_pPcmCache = std::make_unique<CachingReaderPcmCache>(
+                    pConfig->getSettingsPath() + kDecodedTrackCacheDirectory,
+                    cacheSizeMB * 1024 * 1024);
+        }
+    }
 }
 
 ReaderStatusUpdate CachingReaderWorker::processReadRequest(
@@ -45,6 +65,23 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
         return result;
     }
 
+    if (m_pcmCacheFillStartChunk < 0) {
+        // The first request is usually where playback starts, e.g. at the
+        // main cue. The background fill follows the playback from there.
+        m_pcmCacheFillStartChunk = pChunk->getIndex();
+        m_nextPcmCacheFillChunk = m_pcmCacheFillStartChunk;
+    }
+
+    // Chunks that have been decoded before only need to be copied
+    if (m_pPcmCache && m_pPcmCache->isChunkCached(pChunk->getIndex())) {
+        pChunk->bufferSampleFrames(
+                chunkFrameIndexRange,
+                m_pPcmCache->readableSamples(chunkFrameIndexRange.start()));
+        ReaderStatusUpdate result;
+        result.init(CHUNK_READ_SUCCESS, pChunk, m_pAudioSource->frameIndexRange());
+        return result;
+    }
+
     // Try to read the data required for the chunk from the audio source
     const mixxx::IndexRange bufferedFrameIndexRange = pChunk->bufferSampleFrames(
             m_pAudioSource,
@@ -68,11 +105,59 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
         }
     }
 
+    if (m_pPcmCache && status == CHUNK_READ_SUCCESS &&
+            bufferedFrameIndexRange == chunkFrameIndexRange) {
+        pChunk->readBufferedSampleFrames(
+                m_pPcmCache->writableSamples(chunkFrameIndexRange.start()),
+                chunkFrameIndexRange);
+        m_pPcmCache->setChunkCached(pChunk->getIndex());
+    }
+
     ReaderStatusUpdate result;
     result.init(status, pChunk, m_pAudioSource ? m_pAudioSource->frameIndexRange() : mixxx::IndexRange());
     return result;
 }
 
+bool CachingReaderWorker::fillPcmCache() {
+    if (!m_pPcmCache || !m_pPcmCache->isOpen() || !m_pAudioSource ||
+            m_pcmCacheFillStartChunk < 0) {
+        return false;
+    }
+    // From the first requested chunk to the end of the track, then the
+    // chunks before it
+    SINT chunkIndex = m_pPcmCache->nextUncachedChunk(m_nextPcmCacheFillChunk);
+    if (chunkIndex < 0 && !m_pcmCacheFillWrapped) {
+        m_pcmCacheFillWrapped = true;
+        chunkIndex = m_pPcmCache->nextUncachedChunk(0);
+    }
+    if (chunkIndex < 0 ||
+            (m_pcmCacheFillWrapped && chunkIndex >= m_pcmCacheFillStartChunk)) {
+        return false;
+    }
+    // Each chunk is only tried once, even if reading fails
+    m_nextPcmCacheFillChunk = chunkIndex + 1;
+
+    const auto frameIndexRange =
+            CachingReaderChunk::frameIndexRange(m_pAudioSource, chunkIndex);
+    if (frameIndexRange.empty()) {
+        return true;
+    }
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            m_pAudioSource,
+            mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer));
+    const auto readableSampleFrames = audioSourceProxy.readSampleFrames(
+            mixxx::WritableSampleFrames(
+                    frameIndexRange,
+                    mixxx::SampleBuffer::WritableSlice(
+                            m_pPcmCache->writableSamples(frameIndexRange.start()),
+                            CachingReaderChunk::frames2samples(
+                                    frameIndexRange.length()))));
+    if (readableSampleFrames.frameIndexRange() == frameIndexRange) {
+        m_pPcmCache->setChunkCached(chunkIndex);
+    }
+    return true;
+}
+
 // WARNING: Always called from a different thread (GUI)
 void CachingReaderWorker::newTrack(TrackPointer pTrack) {
     {
@@ -113,6 +198,9 @@ void CachingReaderWorker::run() {
             // Read the requested chunk and send the result
             const ReaderStatusUpdate update(processReadRequest(request));
             m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        } else if (fillPcmCache()) {
+            // Check for new requests after each chunk, they take precedence
+            continue;
         } else {
             Event::end(m_tag);
             m_semaRun.acquire();
@@ -132,6 +220,10 @@ void CachingReaderWorker::discardAllPendingRequests() {
 void CachingReaderWorker::closeAudioSource() {
     discardAllPendingRequests();
 
+    if (m_pPcmCache) {
+        m_pPcmCache->close();
+    }
+
     if (m_pAudioSource) {
         // Closes open file handles of the old track.
         m_pAudioSource->close();
@@ -211,6 +303,16 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         mixxx::SampleBuffer(tempReadBufferSize).swap(m_tempReadBuffer);
     }
 
+    if (m_pPcmCache) {
+        m_pPcmCache->open(
+                CachingReaderPcmCache::cacheKeyForFile(pTrack->getFileInfo()),
+                m_pAudioSource->frameIndexRange(),
+                m_pAudioSource->getSignalInfo().getSampleRate());
+    }
+    m_pcmCacheFillStartChunk = -1;
+    m_nextPcmCacheFillChunk = 0;
+    m_pcmCacheFillWrapped = false;
+
     const auto update =
             ReaderStatusUpdate::trackLoaded(
                     m_pAudioSource->frameIndexRange());
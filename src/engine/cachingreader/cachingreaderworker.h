@@ -5,9 +5,12 @@
 #include <QString>
 #include <QThread>
 #include <QtDebug>
+#include <memory>
 
 #include "engine/cachingreader/cachingreaderchunk.h"
+#include "engine/cachingreader/cachingreaderpcmcache.h"
 #include "engine/engineworker.h"
+#include "preferences/usersettings.h"
 #include "sources/audiosource.h"
 #include "track/track_decl.h"
 #include "util/fifo.h"
@@ -95,8 +98,10 @@ class CachingReaderWorker : public EngineWorker {
     Q_OBJECT
 
   public:
-    // Construct a CachingReader with the given group.
+    // Construct a CachingReader with the given group. The decoded track
+    // cache is enabled in the settings, pConfig may be null.
     CachingReaderWorker(const QString& group,
+            UserSettingsPointer pConfig,
             FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
             FIFO<ReaderStatusUpdate>* pReaderStatusFIFO);
     ~CachingReaderWorker() override = default;
@@ -147,6 +152,11 @@ class CachingReaderWorker : public EngineWorker {
     ReaderStatusUpdate processReadRequest(
             const CachingReaderChunkReadRequest& request);
 
+    /// Decodes the next chunk that is missing in the PCM cache while there
+    /// are no pending requests, starting at the first requested chunk.
+    /// Returns false if there is nothing to do.
+    bool fillPcmCache();
+
     // The current audio source of the track loaded
     mixxx::AudioSourcePointer m_pAudioSource;
 
@@ -154,5 +164,12 @@ class CachingReaderWorker : public EngineWorker {
     // before conversion to a stereo signal.
     mixxx::SampleBuffer m_tempReadBuffer;
 
+    // Optional backing store with the decoded samples of the whole track
+    std::unique_ptr<CachingReaderPcmCache> m_pPcmCache;
+    // -1 until the first chunk of the track has been requested
+    SINT m_pcmCacheFillStartChunk;
+    SINT m_nextPcmCacheFillChunk;
+    bool m_pcmCacheFillWrapped;
+
     QAtomicInt m_stop;
 };
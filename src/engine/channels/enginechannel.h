@@ -60,6 +60,15 @@ class EngineChannel : public EngineObject {
     virtual void collectFeatures(GroupFeatureState* pGroupFeatures) const = 0;
     virtual void postProcess(const int iBuffersize) = 0;
 
+    /// Returns true if process() neither reads nor modifies the state of
+    /// other channels or of EngineSync during the current callback, so it
+    /// may run concurrently with other channels. Pending requests that
+    /// modify shared state are processed here before. Must be called from
+    /// the callback thread before process().
+    virtual bool prepareConcurrentProcess() {
+        return true;
+    }
+
     // TODO(XXX) This hack needs to be removed.
     virtual EngineBuffer* getEngineBuffer() {
         return NULL;
@@ -97,6 +97,10 @@ void EngineDeck::postProcess(const int iBufferSize) {
     m_pBuffer->postProcess(iBufferSize);
 }
 
+bool EngineDeck::prepareConcurrentProcess() {
+    return m_pBuffer->prepareConcurrentProcess();
+}
+
 EngineBuffer* EngineDeck::getEngineBuffer() {
     return m_pBuffer;
 }
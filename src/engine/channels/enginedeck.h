@@ -33,6 +33,7 @@ class EngineDeck : public EngineChannel, public AudioDestination {
     virtual void process(CSAMPLE* pOutput, const int iBufferSize);
     virtual void collectFeatures(GroupFeatureState* pGroupFeatures) const;
     virtual void postProcess(const int iBufferSize);
+    bool prepareConcurrentProcess() override;
 
     // TODO(XXX) This hack needs to be removed.
     virtual EngineBuffer* getEngineBuffer();
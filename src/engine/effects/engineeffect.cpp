@@ -1,5 +1,6 @@
 #include "engine/effects/engineeffect.h"
 
+#include "effects/backends/effectstateallocator.h"
 #include "engine/engine.h"
 #include "util/defs.h"
 #include "util/sample.h"
@@ -34,6 +35,7 @@ EngineEffect::EngineEffect(EffectManifestPointer pManifest,
     const mixxx::EngineParameters engineParameters(
             mixxx::audio::SampleRate(96000),
             MAX_BUFFER_LEN / mixxx::kEngineChannelCount);
+    EffectStateAllocator::ScopedEffect scopedEffect(m_pManifest->id());
     m_pProcessor->initialize(activeInputChannels, registeredOutputChannels, engineParameters);
     m_effectRampsFromDry = pManifest->effectRampsFromDry();
 }
@@ -50,6 +52,7 @@ EffectState* EngineEffect::createState(const mixxx::EngineParameters& enginePara
     VERIFY_OR_DEBUG_ASSERT(m_pProcessor) {
         return new EffectState(engineParameters);
     }
+    EffectStateAllocator::ScopedEffect scopedEffect(m_pManifest->id());
     return m_pProcessor->createState(engineParameters);
 }
 
@@ -362,11 +362,44 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
         chainOnChannelEnableState = EffectEnableState::Enabled;
     }
 
+    return processingOccured;
+}
+
+bool EngineEffectChain::isEnabledForInputChannel(const ChannelHandle& inputHandle) {
+    // Creates the entry if needed, so process() does not need to resize the
+    // matrix while other channels are processed.
+    const auto& outputMap = m_chainStatusForChannelMatrix[inputHandle];
+    if (m_enableState == EffectEnableState::Disabled) {
+        return false;
+    }
+    for (const auto& outputChannelStatus : outputMap) {
+        if (outputChannelStatus.enableState != EffectEnableState::Disabled) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EngineEffectChain::prepareConcurrentProcess(const ChannelHandle& inputHandle) {
+    if (!isEnabledForInputChannel(inputHandle)) {
+        return true;
+    }
+    int enabledInputChannels = 0;
+    for (const auto& outputMap : qAsConst(m_chainStatusForChannelMatrix)) {
+        for (const auto& outputChannelStatus : outputMap) {
+            if (outputChannelStatus.enableState != EffectEnableState::Disabled) {
+                ++enabledInputChannels;
+                break;
+            }
+        }
+    }
+    return enabledInputChannels <= 1;
+}
+
+void EngineEffectChain::onCallbackEnd() {
     if (m_enableState == EffectEnableState::Disabling) {
         m_enableState = EffectEnableState::Disabled;
     } else if (m_enableState == EffectEnableState::Enabling) {
         m_enableState = EffectEnableState::Enabled;
     }
-
-    return processingOccured;
 }
@@ -45,6 +45,19 @@ class EngineEffectChain final : public EffectsRequestHandler {
             const unsigned int sampleRate,
             const GroupFeatureState& groupFeatures);
 
+    /// called from audio thread before the channels are processed
+    /// Returns false if the chain processes the input channel together with
+    /// another input channel. The intermediate buffers and the delay line are
+    /// shared by all input channels, so these channels must not be processed
+    /// concurrently.
+    bool prepareConcurrentProcess(const ChannelHandle& inputHandle);
+
+    /// called from audio thread after all channels have been processed
+    /// Completes the intermediate enabling/disabling state of the chain. This
+    /// is not done in process(), because that is called for each channel and
+    /// possibly from different threads.
+    void onCallbackEnd();
+
     /// called from main thread
     void deleteStatesForInputChannel(const ChannelHandle channel);
 
@@ -69,6 +82,8 @@ class EngineEffectChain final : public EffectsRequestHandler {
             EffectStatesMapArray* statesForEffectsInChain);
     bool disableForInputChannel(ChannelHandle inputHandle);
 
+    bool isEnabledForInputChannel(const ChannelHandle& inputHandle);
+
     // Gets or creates a ChannelStatus entry in m_channelStatus for the provided
     // handle.
     ChannelStatus& getChannelStatus(const ChannelHandle& inputHandle,
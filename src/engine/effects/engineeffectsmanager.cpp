@@ -2,6 +2,7 @@
 
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectchain.h"
+#include "engine/engineprofiler.h"
 #include "util/defs.h"
 #include "util/sample.h"
 
@@ -94,6 +95,30 @@ void EngineEffectsManager::onCallbackStart() {
     }
 }
 
+void EngineEffectsManager::onCallbackEnd() {
+    for (const auto& chains : std::as_const(m_chainsByStage)) {
+        for (EngineEffectChain* pChain : chains) {
+            if (pChain) {
+                pChain->onCallbackEnd();
+            }
+        }
+    }
+}
+
+bool EngineEffectsManager::prepareConcurrentPreFaderProcess(
+        const ChannelHandle& inputHandle) {
+    const QList<EngineEffectChain*>& chains =
+            m_chainsByStage.value(SignalProcessingStage::Prefader);
+    bool concurrent = true;
+    // All chains need to be prepared, even if the result is already known
+    for (EngineEffectChain* pChain : chains) {
+        if (pChain && !pChain->prepareConcurrentProcess(inputHandle)) {
+            concurrent = false;
+        }
+    }
+    return concurrent;
+}
+
 void EngineEffectsManager::processPreFaderInPlace(const ChannelHandle& inputHandle,
         const ChannelHandle& outputHandle,
         CSAMPLE* pInOut,
@@ -166,6 +191,7 @@ void EngineEffectsManager::processInner(
         const GroupFeatureState& groupFeatures,
         const CSAMPLE_GAIN oldGain,
         const CSAMPLE_GAIN newGain) {
+    EngineProfiler::ScopedStage profiledStage(EngineProfiler::Stage::Effects);
     const QList<EngineEffectChain*>& chains = m_chainsByStage.value(stage);
 
     if (pIn == pOut) {
@@ -26,6 +26,13 @@ class EngineEffectsManager final : public EffectsRequestHandler {
     ~EngineEffectsManager();
 
     void onCallbackStart();
+    void onCallbackEnd();
+
+    /// Returns false if a prefader EngineEffectChain processes the input
+    /// channel together with another input channel. The channel must then
+    /// not be processed concurrently with other channels. Called before the
+    /// channels are processed.
+    bool prepareConcurrentPreFaderProcess(const ChannelHandle& inputHandle);
 
     /// Process the prefader EngineEffectChains on the pInOut buffer, modifying
     /// the contents of the input buffer.
@@ -21,6 +21,7 @@
 #include "engine/controls/quantizecontrol.h"
 #include "engine/controls/ratecontrol.h"
 #include "engine/enginemaster.h"
+#include "engine/engineprofiler.h"
 #include "engine/engineworkerscheduler.h"
 #include "engine/readaheadmanager.h"
 #include "engine/sync/enginesync.h"
@@ -100,7 +101,8 @@ EngineBuffer::EngineBuffer(const QString& group,
           m_bPlayAfterLoading(false),
           m_pCrossfadeBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
           m_bCrossfadeReady(false),
-          m_iLastBufferSize(0) {
+          m_iLastBufferSize(0),
+          m_bConcurrentProcess(false) {
     // This should be a static assertion, but isValid() is not constexpr.
     DEBUG_ASSERT(kInitialPlayPosition.isValid());
 
@@ -269,6 +271,11 @@ EngineBuffer::EngineBuffer(const QString& group,
     m_pScaleST = new EngineBufferScaleST(m_pReadAheadManager);
     m_pScaleRB = new EngineBufferScaleRubberBand(m_pReadAheadManager);
     slotKeylockEngineChanged(m_pKeylockEngine->get());
+    m_pKeylockMultiThreaded = new ControlProxy("[Master]", "keylock_multithreaded", this);
+    m_pKeylockMultiThreaded->connectValueChanged(this,
+            &EngineBuffer::slotKeylockMultiThreadedChanged,
+            Qt::DirectConnection);
+    slotKeylockMultiThreadedChanged(m_pKeylockMultiThreaded->get());
     m_pScaleVinyl = m_pScaleLinear;
     m_pScale = m_pScaleVinyl;
     m_pScale->clear();
@@ -343,6 +350,7 @@ void EngineBuffer::enableIndependentPitchTempoScaling(bool bEnable,
     // so cache it.
     EngineBufferScale* keylock_scale = m_pScaleKeylock;
     EngineBufferScale* vinyl_scale = m_pScaleVinyl;
+    EngineBufferScale* const pPreviousScale = m_pScale;
 
     if (bEnable && m_pScale != keylock_scale) {
         if (m_speed_old != 0.0) {
@@ -364,6 +372,10 @@ void EngineBuffer::enableIndependentPitchTempoScaling(bool bEnable,
         m_pScale->clear();
         m_bScalerChanged = true;
     }
+    if (pPreviousScale == m_pScaleRB && m_pScale != m_pScaleRB) {
+        // Keylock is off or uses another engine now
+        m_pScaleRB->releaseWorkerThread();
+    }
 }
 
 mixxx::Bpm EngineBuffer::getBpm() const {
@@ -456,7 +468,10 @@ void EngineBuffer::readToCrossfadeBuffer(const int iBufferSize) {
     if (!m_bCrossfadeReady) {
         // Read buffer, as if there where no parameter change
         // (Must be called only once per callback)
-        m_pScale->scaleBuffer(m_pCrossfadeBuffer, iBufferSize);
+        {
+            EngineProfiler::ScopedStage profiledStage(EngineProfiler::Stage::Scaler);
+            m_pScale->scaleBuffer(m_pCrossfadeBuffer, iBufferSize);
+        }
         // Restore the original position that was lost due to scaleBuffer() above
         m_pReadAheadManager->notifySeek(m_playPosition);
         m_bCrossfadeReady = true;
@@ -818,6 +833,10 @@ void EngineBuffer::slotKeylockEngineChanged(double dIndex) {
     }
 }
 
+void EngineBuffer::slotKeylockMultiThreadedChanged(double value) {
+    m_pScaleRB->setMultiThreaded(value > 0);
+}
+
 void EngineBuffer::processTrackLocked(
         CSAMPLE* pOutput, const int iBufferSize, mixxx::audio::SampleRate sampleRate) {
     ScopedTimer t("EngineBuffer::process_pauselock");
@@ -830,8 +849,12 @@ void EngineBuffer::processTrackLocked(
         baserate = m_trackSampleRateOld / sampleRate;
     }
 
-    // Sync requests can affect rate, so process those first.
-    processSyncRequests();
+    // Sync requests can affect rate, so process those first. They modify the
+    // shared state of EngineSync, which is only allowed if this buffer is not
+    // processed concurrently with other channels.
+    if (!m_bConcurrentProcess) {
+        processSyncRequests();
+    }
 
     // Note: play is also active during cue preview
     bool paused = !m_playButton->toBool();
@@ -1037,7 +1060,11 @@ void EngineBuffer::processTrackLocked(
     // If the buffer is not paused, then scale the audio.
     if (!bCurBufferPaused) {
         // Perform scaling of Reader buffer into buffer.
-        const auto framesRead = m_pScale->scaleBuffer(pOutput, iBufferSize);
+        double framesRead;
+        {
+            EngineProfiler::ScopedStage profiledStage(EngineProfiler::Stage::Scaler);
+            framesRead = m_pScale->scaleBuffer(pOutput, iBufferSize);
+        }
 
         // TODO(XXX): The result framesRead might not be an integer value.
         // Converting to samples here does not make sense. All positional
@@ -1176,6 +1203,17 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
 
     m_iLastBufferSize = iBufferSize;
     m_bCrossfadeReady = false;
+    m_bConcurrentProcess = false;
+}
+
+bool EngineBuffer::prepareConcurrentProcess() {
+    processSyncRequests();
+    // Synchronized decks read and modify the state of EngineSync and of the
+    // other synchronized decks while being processed. Cloning reads the
+    // state of the other deck.
+    m_bConcurrentProcess = m_pSyncControl->getSyncMode() == SyncMode::None &&
+            atomicLoadRelaxed(m_pChannelToCloneFrom) == nullptr;
+    return m_bConcurrentProcess;
 }
 
 void EngineBuffer::processSlip(int iBufferSize) {
@@ -1238,7 +1276,9 @@ void EngineBuffer::processSyncRequests() {
 void EngineBuffer::processSeek(bool paused) {
     m_previousBufferSeek = false;
     // Check if we are cloning another channel before doing any seeking.
-    EngineChannel* pChannel = m_pChannelToCloneFrom.fetchAndStoreRelaxed(nullptr);
+    EngineChannel* pChannel = m_bConcurrentProcess
+            ? nullptr
+            : m_pChannelToCloneFrom.fetchAndStoreRelaxed(nullptr);
     if (pChannel) {
         seekCloneBuffer(pChannel->getEngineBuffer());
     }
@@ -1467,6 +1507,10 @@ bool EngineBuffer::isTrackLoaded() const {
     return false;
 }
 
+bool EngineBuffer::isReaderIdle() const {
+    return m_pReader->isIdle();
+}
+
 TrackPointer EngineBuffer::getLoadedTrack() const {
     return m_pCurrentTrack;
 }
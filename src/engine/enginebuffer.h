@@ -126,12 +126,16 @@ class EngineBuffer : public EngineObject {
     void process(CSAMPLE* pOut, const int iBufferSize);
     void processSlip(int iBufferSize);
     void postProcess(const int iBufferSize);
+    /// See EngineChannel::prepareConcurrentProcess()
+    bool prepareConcurrentProcess();
 
     /// Returns the seek position iff a seek is currently queued but not yet
     /// processed. If no seek was queued, and invalid frame position is returned.
     mixxx::audio::FramePos queuedSeekPosition() const;
 
     bool isTrackLoaded() const;
+    // See CachingReader::isIdle()
+    bool isReaderIdle() const;
     TrackPointer getLoadedTrack() const;
     void ejectTrack();
 
@@ -207,6 +211,7 @@ class EngineBuffer : public EngineObject {
     void slotControlEnd(double);
     void slotControlSeek(double);
     void slotKeylockEngineChanged(double);
+    void slotKeylockMultiThreadedChanged(double);
 
   signals:
     void trackLoaded(TrackPointer pNewTrack, TrackPointer pOldTrack);
@@ -374,6 +379,7 @@ class EngineBuffer : public EngineObject {
     ControlPotmeter* m_playposSlider;
     ControlProxy* m_pSampleRate;
     ControlProxy* m_pKeylockEngine;
+    ControlProxy* m_pKeylockMultiThreaded;
     ControlPushButton* m_pKeylock;
 
     // This ControlProxys is created as parent to this and deleted by
@@ -424,6 +430,9 @@ class EngineBuffer : public EngineObject {
     /// Indicates that no seek is queued
     static constexpr QueuedSeek kNoQueuedSeek = {mixxx::audio::kInvalidFramePos, SEEK_NONE};
     QAtomicPointer<EngineChannel> m_pChannelToCloneFrom;
+    // Set by prepareConcurrentProcess() until the end of process(). Sync and
+    // clone requests that arrive in between are deferred to the next callback.
+    bool m_bConcurrentProcess;
 
     // Is true if the previous buffer was silent due to pausing
     QAtomicInt m_iTrackLoading;
@@ -15,7 +15,9 @@
 #include "engine/enginebuffer.h"
 #include "engine/enginedelay.h"
 #include "engine/enginetalkoverducking.h"
+#include "engine/enginethreadpool.h"
 #include "engine/enginevumeter.h"
+#include "engine/engineprofiler.h"
 #include "engine/engineworkerscheduler.h"
 #include "engine/enginexfader.h"
 #include "engine/sidechain/enginesidechain.h"
@@ -23,11 +25,24 @@
 #include "mixer/playermanager.h"
 #include "moc_enginemaster.cpp"
 #include "preferences/usersettings.h"
+#include "util/cmdlineargs.h"
 #include "util/defs.h"
+#include "util/math.h"
 #include "util/sample.h"
 #include "util/timer.h"
 #include "util/trace.h"
 
+namespace {
+
+// Number of additional real-time threads that process the channels in
+// parallel to the audio callback thread. 0 disables parallel processing.
+const ConfigKey kChannelProcessingThreadsConfigKey(
+        "[Master]", "channel_processing_threads");
+
+constexpr int kMaxChannelProcessingThreads = 16;
+
+} // anonymous namespace
+
 EngineMaster::EngineMaster(
         UserSettingsPointer pConfig,
         const QString& group,
@@ -66,6 +81,18 @@ EngineMaster::EngineMaster(
     m_pWorkerScheduler = new EngineWorkerScheduler(this);
     m_pWorkerScheduler->start(QThread::HighPriority);
 
+    const int numChannelProcessingThreads = math_clamp(
+            pConfig->getValue(kChannelProcessingThreadsConfigKey, 0),
+            0,
+            kMaxChannelProcessingThreads);
+    if (numChannelProcessingThreads > 0) {
+        qDebug() << "Processing channels in parallel with"
+                 << numChannelProcessingThreads
+                 << "additional engine threads";
+        m_pChannelThreadPool = std::make_unique<EngineThreadPool>(
+                numChannelProcessingThreads);
+    }
+
     // Master sample rate
     m_pMasterSampleRate = new ControlObject(ConfigKey(group, "samplerate"), true, true);
     m_pMasterSampleRate->set(44100.);
@@ -175,6 +202,11 @@ EngineMaster::EngineMaster(
     m_pKeylockEngine = new ControlObject(ConfigKey(group, "keylock_engine"), true, false, true);
     m_pKeylockEngine->set(pConfig->getValue(ConfigKey(group, "keylock_engine"),
             static_cast<double>(EngineBuffer::defaultKeylockEngine())));
+    // Rubber Band stretches on a worker thread per deck
+    m_pKeylockMultiThreaded = new ControlObject(
+            ConfigKey(group, "keylock_multithreaded"), true, false, true);
+    m_pKeylockMultiThreaded->set(pConfig->getValue(
+            ConfigKey(group, "keylock_multithreaded"), 0.0));
 
     // TODO: Make this read only and make EngineMaster decide whether
     // processing the master mix is necessary.
@@ -194,7 +226,18 @@ EngineMaster::EngineMaster(
 
 EngineMaster::~EngineMaster() {
     //qDebug() << "in ~EngineMaster()";
+    const EngineProfiler* pProfiler = EngineProfiler::instance();
+    if (pProfiler->callbackCount() > 0) {
+        for (const auto& line : pProfiler->summary()) {
+            qInfo() << "Engine profile:" << line;
+        }
+        const QString& tracePath = CmdlineArgs::Instance().getEngineTracePath();
+        if (!tracePath.isEmpty()) {
+            pProfiler->writeChromeTrace(tracePath);
+        }
+    }
     delete m_pKeylockEngine;
+    delete m_pKeylockMultiThreaded;
     delete m_pCrossfader;
     delete m_pBalance;
     delete m_pHeadMix;
@@ -240,6 +283,8 @@ EngineMaster::~EngineMaster() {
         SampleUtil::free(m_pOutputBusBuffers[o]);
     }
 
+    // Join the channel processing threads before any channel is deleted
+    m_pChannelThreadPool.reset();
     delete m_pWorkerScheduler;
 
     for (int i = 0; i < m_channels.size(); ++i) {
@@ -352,17 +397,44 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 
     // Now that the list is built and ordered, do the processing.
-    for (int i = activeChannelsStartIndex;
-             i < m_activeChannels.size(); ++i) {
-        ChannelInfo* pChannelInfo = m_activeChannels[i];
-        EngineChannel* pChannel = pChannelInfo->m_pChannel;
-        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
-
-        // Collect metadata for effects
-        if (m_pEngineEffectsManager) {
-            GroupFeatureState features;
-            pChannel->collectFeatures(&features);
-            pChannelInfo->m_features = features;
+    if (m_pChannelThreadPool) {
+        // The sync leader is processed on its own before all other channels,
+        // because the followers depend on its updated state.
+        if (activeChannelsStartIndex == 0) {
+            processChannel(m_activeChannels[0], iBufferSize);
+        }
+        // Channels that depend on other channels or on EngineSync during
+        // this callback, e.g. synchronized decks, are processed serially.
+        // Their pending sync requests are processed beforehand, so EngineSync
+        // is never modified concurrently. The same applies to channels that
+        // share a prefader effect chain, because the chain's intermediate
+        // buffers are not per channel.
+        m_concurrentChannels.clear();
+        for (int i = 1; i < m_activeChannels.size(); ++i) {
+            ChannelInfo* pChannelInfo = m_activeChannels[i];
+            const bool effectsConcurrent = !m_pEngineEffectsManager ||
+                    m_pEngineEffectsManager->prepareConcurrentPreFaderProcess(
+                            pChannelInfo->m_handle);
+            if (pChannelInfo->m_pChannel->prepareConcurrentProcess() &&
+                    effectsConcurrent) {
+                m_concurrentChannels.append(pChannelInfo);
+            } else {
+                processChannel(pChannelInfo, iBufferSize);
+            }
+        }
+        // All remaining channels are independent of each other. run() only
+        // returns after all of them have been processed, so the mixing stage
+        // below never sees a partially processed channel buffer.
+        auto processConcurrent = [this, iBufferSize](int index) {
+            processChannel(m_concurrentChannels[index], iBufferSize);
+        };
+        m_pChannelThreadPool->run(
+                m_concurrentChannels.size(), processConcurrent);
+    } else {
+        for (int i = activeChannelsStartIndex;
+                i < m_activeChannels.size();
+                ++i) {
+            processChannel(m_activeChannels[i], iBufferSize);
         }
     }
 
@@ -383,6 +455,18 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 }
 
+void EngineMaster::processChannel(ChannelInfo* pChannelInfo, int iBufferSize) {
+    EngineChannel* pChannel = pChannelInfo->m_pChannel;
+    pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+
+    // Collect metadata for effects
+    if (m_pEngineEffectsManager) {
+        GroupFeatureState features;
+        pChannel->collectFeatures(&features);
+        pChannelInfo->m_features = features;
+    }
+}
+
 void EngineMaster::process(const int iBufferSize) {
     static bool haveSetName = false;
     if (!haveSetName) {
@@ -401,12 +485,23 @@ void EngineMaster::process(const int iBufferSize) {
     constexpr unsigned int kChannels = 2;
     const unsigned int iFrames = iBufferSize / kChannels;
 
+    // Ends last, after all stages of the callback
+    EngineProfiler::ScopedCallback profiledCallback(m_sampleRate.isValid()
+                    ? mixxx::Duration::fromSeconds(iFrames / m_sampleRate.toDouble())
+                    : mixxx::Duration::empty());
+
     if (m_pEngineEffectsManager) {
         m_pEngineEffectsManager->onCallbackStart();
     }
 
     // Prepare all channels for output
-    processChannels(m_iBufferSize);
+    {
+        EngineProfiler::ScopedStage profiledStage(EngineProfiler::Stage::Channels);
+        processChannels(m_iBufferSize);
+    }
+
+    // Everything else until the end of the callback
+    EngineProfiler::ScopedStage profiledMix(EngineProfiler::Stage::Mix);
 
     // Compute headphone mix
     // Head phone left/right mix
@@ -707,6 +802,7 @@ void EngineMaster::process(const int iBufferSize) {
         // EngineSideChain::receiveBuffer has copied the input buffer to m_pSidechainMix
         // via before (called by SoundManager::pushInputBuffers())
         if (m_pEngineSideChain) {
+            EngineProfiler::ScopedStage profiledStage(EngineProfiler::Stage::Sidechain);
             m_pEngineSideChain->writeSamples(m_pSidechainMix, iFrames);
         }
 
@@ -765,11 +861,19 @@ void EngineMaster::process(const int iBufferSize) {
         m_pBoothDelay->process(m_pBooth, m_iBufferSize);
     }
 
+    if (m_pEngineEffectsManager) {
+        m_pEngineEffectsManager->onCallbackEnd();
+    }
+
     // We're close to the end of the callback. Wake up the engine worker
     // scheduler so that it runs the workers.
     m_pWorkerScheduler->runWorkers();
 }
 
+void EngineMaster::runWorkers() {
+    m_pWorkerScheduler->runWorkers();
+}
+
 void EngineMaster::applyMasterEffects() {
     // Apply master effects
     if (m_pEngineEffectsManager) {
@@ -2,6 +2,7 @@
 
 #include <QObject>
 #include <QVarLengthArray>
+#include <memory>
 
 #include "audio/types.h"
 #include "control/controlobject.h"
@@ -30,6 +31,7 @@ class GuiTick;
 class EngineSync;
 class EngineTalkoverDucking;
 class EngineDelay;
+class EngineThreadPool;
 
 // The number of channels to pre-allocate in various structures in the
 // engine. Prevents memory allocation in EngineMaster::addChannel.
@@ -69,6 +71,12 @@ class EngineMaster : public QObject, public AudioSource {
 
     void process(const int iBufferSize);
 
+    // Wakes the engine workers that have requested work since the last
+    // process() call. process() does this on its own, this is only needed
+    // when the engine is driven without a sound device and has to wait for
+    // the workers between callbacks, e.g. for loading a track.
+    void runWorkers();
+
     // Add an EngineChannel to the mixing engine. This is not thread safe --
     // only call it before the engine has started mixing.
     void addChannel(EngineChannel* pChannel);
@@ -261,6 +269,10 @@ class EngineMaster : public QObject, public AudioSource {
     // m_activeTalkoverChannels with each channel that is active for the
     // respective output.
     void processChannels(int iBufferSize);
+    // Calls process() and collects the effect features of a single channel.
+    // May be called concurrently for different channels by the
+    // m_pChannelThreadPool workers.
+    void processChannel(ChannelInfo* pChannelInfo, int iBufferSize);
 
     ChannelHandleFactoryPointer m_pChannelHandleFactory;
     void applyMasterEffects();
@@ -283,6 +295,8 @@ class EngineMaster : public QObject, public AudioSource {
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeBusChannels[3];
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeHeadphoneChannels;
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeTalkoverChannels;
+    // The active channels that are processed by m_pChannelThreadPool
+    QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_concurrentChannels;
 
     mixxx::audio::SampleRate m_sampleRate;
     unsigned int m_iBufferSize;
@@ -296,6 +310,9 @@ class EngineMaster : public QObject, public AudioSource {
     CSAMPLE* m_pSidechainMix;
 
     EngineWorkerScheduler* m_pWorkerScheduler;
+    // Optional pool for processing the independent channels in parallel.
+    // nullptr if all channels are processed serially in the callback thread.
+    std::unique_ptr<EngineThreadPool> m_pChannelThreadPool;
     EngineSync* m_pEngineSync;
 
     ControlObject* m_pMasterGain;
@@ -326,6 +343,7 @@ class EngineMaster : public QObject, public AudioSource {
     ControlPushButton* m_pXFaderReverse;
     ControlPushButton* m_pHeadSplitEnabled;
     ControlObject* m_pKeylockEngine;
+    ControlObject* m_pKeylockMultiThreaded;
 
     PflGainCalculator m_headphoneGain;
     TalkoverGainCalculator m_talkoverGain;
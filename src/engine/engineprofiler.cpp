@@ -0,0 +1,248 @@
+#include "engine/engineprofiler.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtDebug>
+
+#include "util/assert.h"
+
+namespace {
+
+constexpr std::int64_t kNotStarted = -1;
+
+// The thread ids in the trace. The summed stages may run on multiple
+// threads and are exported as counters instead.
+constexpr int kTraceProcessId = 1;
+constexpr int kTraceEngineThreadId = 1;
+
+double nanosToMicros(std::int64_t nanos) {
+    return static_cast<double>(nanos) / 1000;
+}
+
+bool isSummedStage(EngineProfiler::Stage stage) {
+    return stage == EngineProfiler::Stage::Scaler ||
+            stage == EngineProfiler::Stage::Effects;
+}
+
+} // anonymous namespace
+
+// static
+QString EngineProfiler::stageName(Stage stage) {
+    switch (stage) {
+    case Stage::Callback:
+        return QStringLiteral("Callback");
+    case Stage::Channels:
+        return QStringLiteral("Channels");
+    case Stage::Scaler:
+        return QStringLiteral("Scaler");
+    case Stage::Effects:
+        return QStringLiteral("Effects");
+    case Stage::Mix:
+        return QStringLiteral("Mix");
+    case Stage::Sidechain:
+        return QStringLiteral("Sidechain");
+    }
+    DEBUG_ASSERT(!"unreachable");
+    return QString();
+}
+
+EngineProfiler::EngineProfiler()
+        : m_callbackStartNanos(0),
+          m_callbackPeriodNanos(0),
+          m_callbackCount(0),
+          m_deadlineMissCount(0) {
+    for (int i = 0; i < kStageCount; ++i) {
+        m_stageStartNanos[i].store(kNotStarted, std::memory_order_relaxed);
+        m_stageDurationNanos[i].store(0, std::memory_order_relaxed);
+    }
+    m_clock.start();
+}
+
+// static
+EngineProfiler* EngineProfiler::instance() {
+    static EngineProfiler s_profiler;
+    return &s_profiler;
+}
+
+void EngineProfiler::beginCallback(mixxx::Duration bufferPeriod, std::int64_t startNanos) {
+    for (int i = 0; i < kStageCount; ++i) {
+        m_stageStartNanos[i].store(kNotStarted, std::memory_order_relaxed);
+        m_stageDurationNanos[i].store(0, std::memory_order_relaxed);
+    }
+    m_callbackPeriodNanos = bufferPeriod.toIntegerNanos();
+    m_callbackStartNanos = startNanos;
+}
+
+void EngineProfiler::addStage(Stage stage, std::int64_t startNanos, std::int64_t endNanos) {
+    const int i = static_cast<int>(stage);
+    // The first start of the stage in the current callback
+    auto notStarted = kNotStarted;
+    m_stageStartNanos[i].compare_exchange_strong(notStarted,
+            startNanos - m_callbackStartNanos,
+            std::memory_order_relaxed);
+    m_stageDurationNanos[i].fetch_add(endNanos - startNanos, std::memory_order_relaxed);
+}
+
+void EngineProfiler::endCallback(std::int64_t endNanos) {
+    addStage(Stage::Callback, m_callbackStartNanos, endNanos);
+
+    const std::uint64_t index = m_callbackCount.load(std::memory_order_relaxed);
+    RecordSlot& slot = m_records[index % kRecordCapacity];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.startNanos.store(m_callbackStartNanos, std::memory_order_relaxed);
+    slot.periodNanos.store(m_callbackPeriodNanos, std::memory_order_relaxed);
+    for (int i = 0; i < kStageCount; ++i) {
+        const auto stageStartNanos = m_stageStartNanos[i].load(std::memory_order_relaxed);
+        const auto stageDurationNanos = m_stageDurationNanos[i].load(std::memory_order_relaxed);
+        slot.stageStartNanos[i].store(stageStartNanos, std::memory_order_relaxed);
+        slot.stageDurationNanos[i].store(stageDurationNanos, std::memory_order_relaxed);
+        if (stageStartNanos != kNotStarted) {
+            m_histograms[i].record(stageDurationNanos);
+        }
+    }
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+    if (m_stageDurationNanos[static_cast<int>(Stage::Callback)].load(
+                std::memory_order_relaxed) > m_callbackPeriodNanos) {
+        m_deadlineMissCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_callbackCount.store(index + 1, std::memory_order_release);
+}
+
+std::vector<EngineProfiler::CallbackRecord> EngineProfiler::recentCallbacks() const {
+    const std::uint64_t end = m_callbackCount.load(std::memory_order_acquire);
+    const std::uint64_t begin = end > kRecordCapacity ? end - kRecordCapacity : 0;
+    std::vector<CallbackRecord> records;
+    records.reserve(end - begin);
+    for (std::uint64_t index = begin; index < end; ++index) {
+        const RecordSlot& slot = m_records[index % kRecordCapacity];
+        const std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * index + 2) {
+            // Already overwritten by a newer callback
+            continue;
+        }
+        CallbackRecord record;
+        record.index = index;
+        record.startNanos = slot.startNanos.load(std::memory_order_relaxed);
+        record.periodNanos = slot.periodNanos.load(std::memory_order_relaxed);
+        for (int i = 0; i < kStageCount; ++i) {
+            record.stageStartNanos[i] = slot.stageStartNanos[i].load(std::memory_order_relaxed);
+            record.stageDurationNanos[i] =
+                    slot.stageDurationNanos[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+            // Overwritten while reading
+            continue;
+        }
+        records.push_back(record);
+    }
+    return records;
+}
+
+QStringList EngineProfiler::summary() const {
+    QStringList lines;
+    lines.append(QStringLiteral("%1 callbacks, %2 deadline misses")
+                         .arg(QString::number(callbackCount()),
+                                 QString::number(deadlineMissCount())));
+    for (int i = 0; i < kStageCount; ++i) {
+        const auto stage = static_cast<Stage>(i);
+        const mixxx::Histogram& stageHistogram = histogram(stage);
+        if (stageHistogram.count() == 0) {
+            continue;
+        }
+        lines.append(QStringLiteral("%1: p50 %2, p99 %3, p99.9 %4, max %5")
+                             .arg(stageName(stage),
+                                     stageHistogram.quantile(0.5).formatMicrosWithUnit(),
+                                     stageHistogram.quantile(0.99).formatMicrosWithUnit(),
+                                     stageHistogram.quantile(0.999).formatMicrosWithUnit(),
+                                     stageHistogram.max().formatMicrosWithUnit()));
+    }
+    return lines;
+}
+
+QByteArray EngineProfiler::toChromeTrace() const {
+    QJsonArray events;
+    events.append(QJsonObject{
+            {QStringLiteral("name"), QStringLiteral("thread_name")},
+            {QStringLiteral("ph"), QStringLiteral("M")},
+            {QStringLiteral("pid"), kTraceProcessId},
+            {QStringLiteral("tid"), kTraceEngineThreadId},
+            {QStringLiteral("args"),
+                    QJsonObject{{QStringLiteral("name"), QStringLiteral("Engine")}}},
+    });
+    for (const auto& record : recentCallbacks()) {
+        const QJsonObject callbackArgs{
+                {QStringLiteral("index"), static_cast<qint64>(record.index)},
+                {QStringLiteral("period_us"), nanosToMicros(record.periodNanos)},
+        };
+        for (int i = 0; i < kStageCount; ++i) {
+            const auto stage = static_cast<Stage>(i);
+            if (record.stageStartNanos[i] == kNotStarted) {
+                continue;
+            }
+            if (isSummedStage(stage)) {
+                // Summed durations don't have a meaningful position on a
+                // timeline. They are reported once per callback.
+                events.append(QJsonObject{
+                        {QStringLiteral("name"), stageName(stage)},
+                        {QStringLiteral("ph"), QStringLiteral("C")},
+                        {QStringLiteral("ts"), nanosToMicros(record.startNanos)},
+                        {QStringLiteral("pid"), kTraceProcessId},
+                        {QStringLiteral("args"),
+                                QJsonObject{{QStringLiteral("us"),
+                                        nanosToMicros(record.stageDurationNanos[i])}}},
+                });
+                continue;
+            }
+            QJsonObject event{
+                    {QStringLiteral("name"), stageName(stage)},
+                    {QStringLiteral("ph"), QStringLiteral("X")},
+                    {QStringLiteral("ts"),
+                            nanosToMicros(record.startNanos + record.stageStartNanos[i])},
+                    {QStringLiteral("dur"), nanosToMicros(record.stageDurationNanos[i])},
+                    {QStringLiteral("pid"), kTraceProcessId},
+                    {QStringLiteral("tid"), kTraceEngineThreadId},
+            };
+            if (stage == Stage::Callback) {
+                event.insert(QStringLiteral("args"), callbackArgs);
+            }
+            events.append(event);
+        }
+        if (record.missedDeadline()) {
+            events.append(QJsonObject{
+                    {QStringLiteral("name"), QStringLiteral("Deadline miss")},
+                    {QStringLiteral("ph"), QStringLiteral("i")},
+                    {QStringLiteral("s"), QStringLiteral("t")},
+                    {QStringLiteral("ts"),
+                            nanosToMicros(record.startNanos + record.periodNanos)},
+                    {QStringLiteral("pid"), kTraceProcessId},
+                    {QStringLiteral("tid"), kTraceEngineThreadId},
+            });
+        }
+    }
+    const QJsonObject trace{
+            {QStringLiteral("traceEvents"), events},
+            {QStringLiteral("displayTimeUnit"), QStringLiteral("ns")},
+    };
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool EngineProfiler::writeChromeTrace(const QString& filePath) const {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open engine trace file" << filePath
+                   << file.errorString();
+        return false;
+    }
+    const QByteArray trace = toChromeTrace();
+    if (file.write(trace) != trace.size()) {
+        qWarning() << "Failed to write engine trace file" << filePath
+                   << file.errorString();
+        return false;
+    }
+    return true;
+}
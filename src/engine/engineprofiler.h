@@ -0,0 +1,172 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "util/class.h"
+#include "util/duration.h"
+#include "util/histogram.h"
+#include "util/performancetimer.h"
+
+/// Always-on instrumentation of the audio callback.
+///
+/// The engine thread reports the start and end of each callback and the
+/// stages of the callback report their elapsed time. At the end of each
+/// callback the durations are added to a latency histogram per stage (see
+/// util/histogram.h, which is shared with the controller input latency) and
+/// the whole record is stored in a ring that keeps the most recent
+/// callbacks. Callbacks that take longer than the buffer period are counted
+/// as deadline misses.
+///
+/// Recording is lock-free and does not allocate, so it is safe to use from
+/// the engine thread and the channel worker threads. All other functions
+/// may be invoked from any thread and only read a consistent snapshot.
+class EngineProfiler {
+  public:
+    enum class Stage {
+        /// The whole EngineMaster::process() call
+        Callback,
+        /// All channels, including the scaler and pre-fader effects
+        Channels,
+        /// Summed over all decks
+        Scaler,
+        /// Summed over all effects processing, both pre- and post-fader,
+        /// including the gain that is applied along with it
+        Effects,
+        /// Mixing the buses and outputs, including post-fader effects and
+        /// the sidechain
+        Mix,
+        /// Passing the mix on to recording and broadcasting
+        Sidechain,
+    };
+    static constexpr int kStageCount = static_cast<int>(Stage::Sidechain) + 1;
+
+    static QString stageName(Stage stage);
+
+    /// A single callback, all times in nanoseconds
+    struct CallbackRecord {
+        std::uint64_t index = 0;
+        /// Relative to the creation of the profiler
+        std::int64_t startNanos = 0;
+        std::int64_t periodNanos = 0;
+        /// Relative to startNanos or -1 if the stage did not run
+        std::array<std::int64_t, kStageCount> stageStartNanos{};
+        std::array<std::int64_t, kStageCount> stageDurationNanos{};
+
+        bool missedDeadline() const {
+            return stageDurationNanos[static_cast<int>(Stage::Callback)] > periodNanos;
+        }
+    };
+
+    /// Measures a stage from construction to destruction.
+    class ScopedStage {
+      public:
+        explicit ScopedStage(Stage stage, EngineProfiler* pProfiler = instance())
+                : m_pProfiler(pProfiler),
+                  m_stage(stage),
+                  m_startNanos(pProfiler->nowNanos()) {
+        }
+        ~ScopedStage() {
+            m_pProfiler->addStage(m_stage, m_startNanos, m_pProfiler->nowNanos());
+        }
+
+      private:
+        EngineProfiler* const m_pProfiler;
+        const Stage m_stage;
+        const std::int64_t m_startNanos;
+
+        DISALLOW_COPY_AND_ASSIGN(ScopedStage);
+    };
+
+    /// Measures a whole callback from construction to destruction.
+    class ScopedCallback {
+      public:
+        explicit ScopedCallback(mixxx::Duration bufferPeriod,
+                EngineProfiler* pProfiler = instance())
+                : m_pProfiler(pProfiler) {
+            m_pProfiler->beginCallback(bufferPeriod, m_pProfiler->nowNanos());
+        }
+        ~ScopedCallback() {
+            m_pProfiler->endCallback(m_pProfiler->nowNanos());
+        }
+
+      private:
+        EngineProfiler* const m_pProfiler;
+
+        DISALLOW_COPY_AND_ASSIGN(ScopedCallback);
+    };
+
+    /// The number of callbacks that are kept for the trace
+    static constexpr int kRecordCapacity = 4096;
+
+    EngineProfiler();
+
+    /// The profiler of the audio engine
+    static EngineProfiler* instance();
+
+    std::int64_t nowNanos() const {
+        return m_clock.elapsed().toIntegerNanos();
+    }
+
+    /// Only invoked from the engine thread with results of nowNanos()
+    void beginCallback(mixxx::Duration bufferPeriod, std::int64_t startNanos);
+    void endCallback(std::int64_t endNanos);
+
+    /// Accounts the time between two results of nowNanos() to a stage.
+    /// Stages that run multiple times during a callback, possibly on
+    /// different threads, add up.
+    void addStage(Stage stage, std::int64_t startNanos, std::int64_t endNanos);
+
+    std::uint64_t callbackCount() const {
+        return m_callbackCount.load(std::memory_order_relaxed);
+    }
+    std::uint64_t deadlineMissCount() const {
+        return m_deadlineMissCount.load(std::memory_order_relaxed);
+    }
+    const mixxx::Histogram& histogram(Stage stage) const {
+        return m_histograms[static_cast<int>(stage)];
+    }
+
+    /// The most recent callbacks in chronological order
+    std::vector<CallbackRecord> recentCallbacks() const;
+
+    /// A one line summary of each stage's histogram for logging
+    QStringList summary() const;
+
+    /// Serializes the recent callbacks as a trace in the JSON format of
+    /// the Chrome tracing tools, which can be opened by Perfetto.
+    QByteArray toChromeTrace() const;
+    bool writeChromeTrace(const QString& filePath) const;
+
+  private:
+    // A ring slot that is protected by a sequence lock. The sequence is odd
+    // while the engine thread writes the slot.
+    struct RecordSlot {
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<std::int64_t> startNanos{0};
+        std::atomic<std::int64_t> periodNanos{0};
+        std::array<std::atomic<std::int64_t>, kStageCount> stageStartNanos{};
+        std::array<std::atomic<std::int64_t>, kStageCount> stageDurationNanos{};
+    };
+
+    PerformanceTimer m_clock;
+
+    // The current callback
+    std::int64_t m_callbackStartNanos;
+    std::int64_t m_callbackPeriodNanos;
+    std::array<std::atomic<std::int64_t>, kStageCount> m_stageStartNanos;
+    std::array<std::atomic<std::int64_t>, kStageCount> m_stageDurationNanos;
+
+    std::array<mixxx::Histogram, kStageCount> m_histograms;
+    std::atomic<std::uint64_t> m_callbackCount;
+    std::atomic<std::uint64_t> m_deadlineMissCount;
+
+    std::array<RecordSlot, kRecordCapacity> m_records;
+
+    DISALLOW_COPY_AND_ASSIGN(EngineProfiler);
+};
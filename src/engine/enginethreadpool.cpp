@@ -0,0 +1,86 @@
+#include "engine/enginethreadpool.h"
+
+#include "control/controlchangejournal.h"
+#include "util/assert.h"
+#include "util/math.h"
+
+EngineThreadPool::EngineThreadPool(int numWorkers, QThread::Priority priority)
+        : m_itemFunction(nullptr),
+          m_pContext(nullptr),
+          m_numItems(0),
+          m_nextItem(0),
+          m_bQuit(false) {
+    DEBUG_ASSERT(numWorkers >= 0);
+    m_workers.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        m_workers.push_back(std::make_unique<Worker>(this, i));
+        // The workers take part in the work of the calling thread, e.g. the
+        // audio callback, and must not be preempted by anything with a lower
+        // priority than it.
+        m_workers.back()->start(priority);
+    }
+}
+
+EngineThreadPool::~EngineThreadPool() {
+    m_bQuit.store(true);
+    for (const auto& pWorker : m_workers) {
+        pWorker->wake();
+    }
+    for (const auto& pWorker : m_workers) {
+        pWorker->wait();
+    }
+}
+
+void EngineThreadPool::run(int numItems, ItemFunction itemFunction, void* pContext) {
+    if (numItems <= 0) {
+        return;
+    }
+    // Only wake as many workers as there are items left for them, the
+    // calling thread takes care of one item itself.
+    const int numWorkersToWake = math_min(numWorkers(), numItems - 1);
+    if (numWorkersToWake == 0) {
+        for (int i = 0; i < numItems; ++i) {
+            itemFunction(pContext, i);
+        }
+        return;
+    }
+
+    m_itemFunction = itemFunction;
+    m_pContext = pContext;
+    m_numItems = numItems;
+    m_nextItem.store(0);
+    // The semaphore release publishes the batch to the workers
+    for (int i = 0; i < numWorkersToWake; ++i) {
+        m_workers[i]->wake();
+    }
+    processPendingItems();
+    // Join: Every woken worker signals once it has run out of items.
+    m_semaDone.acquire(numWorkersToWake);
+}
+
+void EngineThreadPool::processPendingItems() {
+    for (int index = m_nextItem.fetch_add(1);
+            index < m_numItems;
+            index = m_nextItem.fetch_add(1)) {
+        m_itemFunction(m_pContext, index);
+    }
+}
+
+EngineThreadPool::Worker::Worker(EngineThreadPool* pPool, int workerIndex)
+        : m_pPool(pPool),
+          m_workerIndex(workerIndex) {
+}
+
+void EngineThreadPool::Worker::run() {
+    QThread::currentThread()->setObjectName(
+            QStringLiteral("EngineThreadPool %1").arg(m_workerIndex));
+    ControlChangeJournal::registerGuiJournalThread();
+    while (true) {
+        m_semaWake.acquire();
+        if (m_pPool->m_bQuit.load()) {
+            break;
+        }
+        m_pPool->processPendingItems();
+        m_pPool->m_semaDone.release();
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "util/class.h"
+
+// EngineThreadPool runs independent pieces of engine work (e.g. the process()
+// call of each active channel) on a fixed set of real-time worker threads.
+// The pool is driven from the audio callback: run() wakes the workers, lets
+// the calling thread take part in the work and returns only after every item
+// has been processed, so the caller can rely on a deterministic join point.
+//
+// No memory is allocated and no locks other than the wake/join semaphores are
+// taken while running, so run() may be called from the audio callback.
+class EngineThreadPool {
+  public:
+    // Callback that processes a single work item. Must be safe to call
+    // concurrently for different indices.
+    typedef void (*ItemFunction)(void* pContext, int index);
+
+    // Creates a pool with numWorkers additional threads. With 0 workers all
+    // items are processed serially by the thread that calls run(). The
+    // workers should run at the priority of the thread that calls run().
+    explicit EngineThreadPool(int numWorkers,
+            QThread::Priority priority = QThread::TimeCriticalPriority);
+    ~EngineThreadPool();
+
+    int numWorkers() const {
+        return static_cast<int>(m_workers.size());
+    }
+
+    // Processes items [0, numItems) and blocks until all of them are done.
+    void run(int numItems, ItemFunction itemFunction, void* pContext);
+
+    // Convenience wrapper for lambdas and other callables. The callable is
+    // referenced, not copied, so no allocation takes place.
+    template<typename Callable>
+    void run(int numItems, Callable& callable) {
+        run(
+                numItems,
+                [](void* pContext, int index) {
+                    (*static_cast<Callable*>(pContext))(index);
+                },
+                &callable);
+    }
+
+  private:
+    class Worker : public QThread {
+      public:
+        Worker(EngineThreadPool* pPool, int workerIndex);
+
+        void wake() {
+            m_semaWake.release();
+        }
+
+      protected:
+        void run() override;
+
+      private:
+        EngineThreadPool* const m_pPool;
+        const int m_workerIndex;
+        QSemaphore m_semaWake;
+    };
+
+    // Claims and processes items until none are left. Called by the workers
+    // and by the thread calling run().
+    void processPendingItems();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    // The currently active batch. Only written by run() while all workers
+    // are idle, published to the workers by the wake semaphore.
+    ItemFunction m_itemFunction;
+    void* m_pContext;
+    int m_numItems;
+    std::atomic<int> m_nextItem;
+
+    QSemaphore m_semaDone;
+    std::atomic<bool> m_bQuit;
+
+    DISALLOW_COPY_AND_ASSIGN(EngineThreadPool);
+};
@@ -25,6 +25,41 @@ enum IIRPass {
     IIR_HP2,
 };
 
+// A sample of the left and the right channel. EngineFilterIIR filters both
+// channels at once in the lanes of a single SSE2 or NEON register.
+#if defined(__GNUC__) || defined(__clang__)
+typedef double IIRStereoSample __attribute__((vector_size(2 * sizeof(double))));
+#else
+struct IIRStereoSample {
+    double lanes[2];
+
+    double operator[](int lane) const {
+        return lanes[lane];
+    }
+    IIRStereoSample operator-() const {
+        return {-lanes[0], -lanes[1]};
+    }
+    IIRStereoSample operator+(IIRStereoSample other) const {
+        return {lanes[0] + other.lanes[0], lanes[1] + other.lanes[1]};
+    }
+    IIRStereoSample operator-(IIRStereoSample other) const {
+        return {lanes[0] - other.lanes[0], lanes[1] - other.lanes[1]};
+    }
+    IIRStereoSample operator*(double factor) const {
+        return {lanes[0] * factor, lanes[1] * factor};
+    }
+    friend IIRStereoSample operator*(double factor, IIRStereoSample sample) {
+        return sample * factor;
+    }
+    IIRStereoSample& operator+=(IIRStereoSample other) {
+        return *this = *this + other;
+    }
+    IIRStereoSample& operator-=(IIRStereoSample other) {
+        return *this = *this - other;
+    }
+};
+#endif
+
 
 class EngineFilterIIRBase : public EngineObjectConstIn {
   public:
@@ -82,12 +117,13 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     }
 
     void initBuffers() {
-        // Copy the current buffers into the old buffers
-        memcpy(m_oldBuf1, m_buf1, sizeof(m_buf1));
-        memcpy(m_oldBuf2, m_buf2, sizeof(m_buf2));
+        // Copy the current buffers into the old buffers, unless the
+        // coefficients have been changed again before ramping
+        if (!m_doRamping) {
+            memcpy(m_oldBuf, m_buf, sizeof(m_buf));
+        }
         // Set the current buffers to 0
-        memset(m_buf1, 0, sizeof(m_buf1));
-        memset(m_buf2, 0, sizeof(m_buf2));
+        memset(m_buf, 0, sizeof(m_buf));
         m_doRamping = true;
     }
 
@@ -105,7 +141,9 @@ class EngineFilterIIR : public EngineFilterIIRBase {
         std::strncpy(spec_d, spec, bufsize);
 
         // Copy the old coefficients into m_oldCoef
-        memcpy(m_oldCoef, m_coef, sizeof(m_coef));
+        if (!m_doRamping) {
+            memcpy(m_oldCoef, m_coef, sizeof(m_coef));
+        }
 
         m_coef[0] = fid_design_coef(m_coef + 1, SIZE, spec_d, sampleRate, freq0, freq1, adj);
 
@@ -165,7 +203,9 @@ class EngineFilterIIR : public EngineFilterIIRBase {
         spec2_d[FIDSPEC_LENGTH - 1] = '\0';
 
         // Copy the old coefficients into m_oldCoef
-        memcpy(m_oldCoef, m_coef, sizeof(m_coef));
+        if (!m_doRamping) {
+            memcpy(m_oldCoef, m_coef, sizeof(m_coef));
+        }
         m_coef[0] = fid_design_coef(m_coef + 1,
                             n_coef1,
                             spec1,
@@ -230,17 +270,52 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 
     virtual void process(const CSAMPLE* pIn, CSAMPLE* pOutput,
                          const int iBufferSize) {
+        // The state is copied into local variables for the whole buffer,
+        // which allows the compiler to keep it in registers.
+        IIRStereoSample buf[SIZE];
+        double coef[SIZE + 1];
         if (!m_doRamping) {
+            memcpy(buf, m_buf, sizeof(buf));
+            memcpy(coef, m_coef, sizeof(coef));
+            for (int i = 0; i < iBufferSize; i += 2) {
+                const IIRStereoSample out = processSample(
+                        coef, buf, IIRStereoSample{pIn[i], pIn[i + 1]});
+                pOutput[i] = static_cast<CSAMPLE>(out[0]);
+                pOutput[i + 1] = static_cast<CSAMPLE>(out[1]);
+            }
+            memcpy(m_buf, buf, sizeof(buf));
+        } else if (!m_doStart) {
+            // The filter keeps running with the old state while its
+            // coefficients are moved linearly towards the new ones. The
+            // stable region of the coefficients of each section is convex,
+            // so all intermediate filters are stable. Unlike a cross fade
+            // this processes only one filter and has no settling noise.
+            memcpy(buf, m_oldBuf, sizeof(buf));
+            memcpy(coef, m_oldCoef, sizeof(coef));
+            double coefStep[SIZE + 1];
+            const double frames = static_cast<double>(iBufferSize / 2);
+            for (unsigned int k = 0; k <= SIZE; ++k) {
+                coefStep[k] = (m_coef[k] - m_oldCoef[k]) / frames;
+            }
             for (int i = 0; i < iBufferSize; i += 2) {
-                pOutput[i] = static_cast<CSAMPLE>(processSample(m_coef, m_buf1, pIn[i]));
-                pOutput[i + 1] = static_cast<CSAMPLE>(processSample(m_coef, m_buf2, pIn[i + 1]));
+                for (unsigned int k = 0; k <= SIZE; ++k) {
+                    coef[k] += coefStep[k];
+                }
+                const IIRStereoSample out = processSample(
+                        coef, buf, IIRStereoSample{pIn[i], pIn[i + 1]});
+                pOutput[i] = static_cast<CSAMPLE>(out[0]);
+                pOutput[i + 1] = static_cast<CSAMPLE>(out[1]);
             }
+            memcpy(m_buf, buf, sizeof(buf));
+            m_doRamping = false;
         } else {
+            memcpy(buf, m_buf, sizeof(buf));
+            memcpy(coef, m_coef, sizeof(coef));
             double cross_mix = 0.0;
             double cross_inc = 4.0 / static_cast<double>(iBufferSize);
             for (int i = 0; i < iBufferSize; i += 2) {
-                // Do a linear cross fade between the output of the old
-                // Filter and the new filter.
+                // Do a linear cross fade between the dry or silent input
+                // and the new filter.
                 // The new filter is settled for Input = 0 and it sees
                 // all frequencies of the rectangular start impulse.
                 // Since the group delay, after which the start impulse
@@ -250,45 +325,33 @@ class EngineFilterIIR : public EngineFilterIIRBase {
                 // of the new filter but it turns out that this produces
                 // a gain drop due to the filter delay which is more
                 // conspicuous than the settling noise.
-                double old1;
-                double old2;
-                if (!m_doStart) {
-                    // Process old filter, but only if we do not do a fresh start
-                    old1 = static_cast<CSAMPLE>(processSample(m_oldCoef, m_oldBuf1, pIn[i]));
-                    old2 = static_cast<CSAMPLE>(processSample(m_oldCoef, m_oldBuf2, pIn[i + 1]));
-                } else {
-                    if (m_startFromDry) {
-                        old1 = pIn[i];
-                        old2 = pIn[i + 1];
-                    } else {
-                        old1 = 0;
-                        old2 = 0;
-                    }
-                }
-                double new1 = static_cast<CSAMPLE>(processSample(m_coef, m_buf1, pIn[i]));
-                double new2 = static_cast<CSAMPLE>(processSample(m_coef, m_buf2, pIn[i + 1]));
+                const IIRStereoSample in{pIn[i], pIn[i + 1]};
+                const IIRStereoSample old = m_startFromDry ? in : IIRStereoSample{0, 0};
+                const IIRStereoSample filtered = processSample(coef, buf, in);
 
+                IIRStereoSample out;
                 if (i < iBufferSize / 2) {
-                    pOutput[i] = static_cast<CSAMPLE>(old1);
-                    pOutput[i + 1] = static_cast<CSAMPLE>(old2);
+                    out = old;
                 } else {
-                    pOutput[i] = static_cast<CSAMPLE>(new1 * cross_mix + old1 * (1.0 - cross_mix));
-                    pOutput[i + 1] = static_cast<CSAMPLE>(
-                            new2 * cross_mix + old2 * (1.0 - cross_mix));
+                    out = filtered * cross_mix + old * (1.0 - cross_mix);
                     cross_mix += cross_inc;
                 }
+                pOutput[i] = static_cast<CSAMPLE>(out[0]);
+                pOutput[i + 1] = static_cast<CSAMPLE>(out[1]);
             }
+            memcpy(m_buf, buf, sizeof(buf));
             m_doRamping = false;
             m_doStart = false;
         }
     }
 
   protected:
-    inline double processSample(double* coef, double* buf, double val);
+    // T is either IIRStereoSample or double for a single channel
+    template<typename T>
+    inline T processSample(double* coef, T* buf, T val);
     inline void pauseFilterInner() {
         // Set the current buffers to 0
-        memset(m_buf1, 0, sizeof(m_buf1));
-        memset(m_buf2, 0, sizeof(m_buf2));
+        memset(m_buf, 0, sizeof(m_buf));
         m_doRamping = true;
         m_doStart = true;
     }
@@ -297,15 +360,10 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     // Old coefficients needed for ramping
     double m_oldCoef[SIZE + 1];
 
-    // Channel 1 state
-    double m_buf1[SIZE];
-    // Old channel 1 buffer needed for ramping
-    double m_oldBuf1[SIZE];
-
-    // Channel 2 state
-    double m_buf2[SIZE];
-    // Old channel 2 buffer needed for ramping
-    double m_oldBuf2[SIZE];
+    // State of both channels
+    IIRStereoSample m_buf[SIZE];
+    // Old buffer needed for ramping
+    IIRStereoSample m_oldBuf[SIZE];
 
     // Flag set to true if ramping needs to be done
     bool m_doRamping;
@@ -316,10 +374,11 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 };
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -330,10 +389,11 @@ inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = -tmp;
@@ -344,10 +404,11 @@ inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -358,10 +419,11 @@ inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -377,10 +439,11 @@ inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -407,10 +470,11 @@ inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir= val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -426,10 +490,11 @@ inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -456,10 +521,11 @@ inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
-                                                         double* buf,
-                                                         double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
+                                                    T* buf,
+                                                    T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     buf[7] = buf[8]; buf[8] = buf[9]; buf[9] = buf[10]; buf[10] = buf[11];
@@ -508,10 +574,11 @@ inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -539,10 +606,11 @@ inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
 
 // IIR_LP and IIR_HP use the same processSample routine
 template<>
-inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = coef[2] * tmp;
@@ -553,10 +621,11 @@ inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+   T tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= tmp;
@@ -579,10 +648,11 @@ inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+   T tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= -tmp;
@@ -604,10 +674,11 @@ inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -625,10 +696,11 @@ inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_HP2>::processSample(double* coef,
+                                                   T* buf,
+                                                   T val) {
+    T tmp, fir, iir;
     tmp = buf[0];
     iir = val * -coef[0]; // swap gain to be in phase with LP2
     iir -= coef[1] * tmp; fir = -tmp;
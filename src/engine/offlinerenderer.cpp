@@ -0,0 +1,377 @@
+#include "engine/offlinerenderer.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+#include "control/controlobject.h"
+#include "encoder/encoder.h"
+#include "engine/channels/enginedeck.h"
+#include "engine/engine.h"
+#include "engine/enginebuffer.h"
+#include "engine/enginemaster.h"
+#include "mixer/basetrackplayer.h"
+#include "mixer/playermanager.h"
+#include "soundio/soundmanagerutil.h"
+#include "sources/soundsourceproxy.h"
+#include "track/track.h"
+#include "util/assert.h"
+#include "util/defs.h"
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("OfflineRenderer");
+
+constexpr audio::SampleRate kDefaultSampleRate = audio::SampleRate(44100);
+constexpr SINT kDefaultBufferFrames = 1024;
+constexpr SINT kMaxBufferFrames = MAX_BUFFER_LEN / kEngineChannelCount;
+
+// Upper bounds for waiting on the worker threads. They are only reached
+// if something is seriously wrong, e.g. a deck got stuck while loading.
+constexpr int kTrackLoadTimeoutMillis = 30000;
+constexpr int kReaderTimeoutMillis = 5000;
+
+// Reads a position given either in seconds or in frames from a JSON object.
+bool parseFrames(const QJsonObject& object,
+        const QString& secondsKey,
+        const QString& framesKey,
+        audio::SampleRate sampleRate,
+        SINT* pFrames) {
+    if (object.contains(framesKey)) {
+        *pFrames = static_cast<SINT>(object.value(framesKey).toDouble(-1));
+    } else if (object.contains(secondsKey)) {
+        *pFrames = static_cast<SINT>(std::round(
+                object.value(secondsKey).toDouble(-1) * sampleRate.value()));
+    } else {
+        return false;
+    }
+    return *pFrames >= 0;
+}
+
+} // anonymous namespace
+
+OfflineRenderScript::OfflineRenderScript()
+        : m_sampleRate(kDefaultSampleRate),
+          m_bufferFrames(kDefaultBufferFrames),
+          m_durationFrames(0) {
+}
+
+bool OfflineRenderScript::parse(const QByteArray& json, QString* pErrorMessage) {
+    DEBUG_ASSERT(pErrorMessage);
+    QJsonParseError parseError;
+    const auto document = QJsonDocument::fromJson(json, &parseError);
+    if (!document.isObject()) {
+        *pErrorMessage = QStringLiteral("Invalid JSON: ") + parseError.errorString();
+        return false;
+    }
+    const QJsonObject root = document.object();
+
+    m_sampleRate = audio::SampleRate(static_cast<audio::SampleRate::value_t>(
+            root.value(QStringLiteral("sampleRate"))
+                    .toInt(kDefaultSampleRate.value())));
+    if (!m_sampleRate.isValid()) {
+        *pErrorMessage = QStringLiteral("Invalid sample rate");
+        return false;
+    }
+
+    m_bufferFrames = root.value(QStringLiteral("bufferFrames"))
+                             .toInt(kDefaultBufferFrames);
+    if (m_bufferFrames <= 0 || m_bufferFrames > kMaxBufferFrames) {
+        *pErrorMessage = QStringLiteral("bufferFrames must be between 1 and %1")
+                                 .arg(kMaxBufferFrames);
+        return false;
+    }
+
+    if (!parseFrames(root,
+                QStringLiteral("duration"),
+                QStringLiteral("durationFrames"),
+                m_sampleRate,
+                &m_durationFrames)) {
+        *pErrorMessage = QStringLiteral("Missing or invalid duration");
+        return false;
+    }
+
+    m_events.clear();
+    const QJsonArray events = root.value(QStringLiteral("events")).toArray();
+    m_events.reserve(events.size());
+    for (int i = 0; i < events.size(); ++i) {
+        const QJsonObject object = events.at(i).toObject();
+        OfflineRenderEvent event;
+        if (!parseFrames(object,
+                    QStringLiteral("time"),
+                    QStringLiteral("frame"),
+                    m_sampleRate,
+                    &event.frame)) {
+            *pErrorMessage = QStringLiteral("Event %1: Missing or invalid time").arg(i);
+            return false;
+        }
+        const QString group = object.value(QStringLiteral("group")).toString();
+        if (group.isEmpty()) {
+            *pErrorMessage = QStringLiteral("Event %1: Missing group").arg(i);
+            return false;
+        }
+        if (object.contains(QStringLiteral("load"))) {
+            event.type = OfflineRenderEvent::Type::LoadTrack;
+            event.key = ConfigKey(group, QString());
+            event.value = 0;
+            event.location = object.value(QStringLiteral("load")).toString();
+        } else {
+            const QString item = object.value(QStringLiteral("key")).toString();
+            const QJsonValue value = object.value(QStringLiteral("value"));
+            if (item.isEmpty() || !value.isDouble()) {
+                *pErrorMessage = QStringLiteral("Event %1: Missing key or value").arg(i);
+                return false;
+            }
+            event.type = OfflineRenderEvent::Type::SetControl;
+            event.key = ConfigKey(group, item);
+            event.value = value.toDouble();
+        }
+        m_events.push_back(std::move(event));
+    }
+    std::stable_sort(m_events.begin(),
+            m_events.end(),
+            [](const OfflineRenderEvent& lhs, const OfflineRenderEvent& rhs) {
+                return lhs.frame < rhs.frame;
+            });
+    return true;
+}
+
+OfflineRenderer::OfflineRenderer(UserSettingsPointer pConfig,
+        EngineMaster* pEngineMaster,
+        PlayerManagerInterface* pPlayerManager)
+        : m_pConfig(pConfig),
+          m_pEngineMaster(pEngineMaster),
+          m_pPlayerManager(pPlayerManager) {
+}
+
+OfflineRenderer::~OfflineRenderer() {
+    m_file.close();
+}
+
+bool OfflineRenderer::render(const QString& scriptPath, const QString& outputPath) {
+    QFile scriptFile(scriptPath);
+    if (!scriptFile.open(QIODevice::ReadOnly)) {
+        kLogger.warning() << "Failed to open render script" << scriptPath;
+        return false;
+    }
+    OfflineRenderScript script;
+    QString errorMessage;
+    if (!script.parse(scriptFile.readAll(), &errorMessage)) {
+        kLogger.warning() << "Invalid render script" << scriptPath << errorMessage;
+        return false;
+    }
+
+    const QString fileExtension = QFileInfo(outputPath).suffix().toLower();
+    const EncoderFactory& encoderFactory = EncoderFactory::getFactory();
+    const auto formats = encoderFactory.getFormats();
+    const auto format = std::find_if(formats.begin(),
+            formats.end(),
+            [&fileExtension](const Encoder::Format& format) {
+                return format.fileExtension == fileExtension;
+            });
+    if (format == formats.end()) {
+        kLogger.warning() << "No encoder available for" << outputPath;
+        return false;
+    }
+
+    m_file.setFileName(outputPath);
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        kLogger.warning() << "Failed to open" << outputPath << "for writing";
+        return false;
+    }
+
+    // The encoder settings (e.g. bit depth, compression level) are taken
+    // from the recording preferences.
+    EncoderPointer pEncoder = encoderFactory.createRecordingEncoder(
+            *format, m_pConfig, this);
+    if (pEncoder->initEncoder(script.sampleRate(), &errorMessage) < 0) {
+        kLogger.warning() << "Failed to initialize the encoder:" << errorMessage;
+        return false;
+    }
+
+    // Normally done by SoundManager when opening the sound devices
+    ControlObject::set(ConfigKey("[Master]", "samplerate"), script.sampleRate().value());
+    m_pEngineMaster->onOutputConnected(AudioOutput(AudioOutput::MASTER, 0, 2));
+
+    kLogger.info() << "Rendering" << scriptPath << "to" << outputPath;
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto& events = script.events();
+    auto nextEvent = events.begin();
+    SINT frame = 0;
+    while (frame < script.durationFrames()) {
+        while (nextEvent != events.end() && nextEvent->frame <= frame) {
+            if (!applyEvent(*nextEvent)) {
+                return false;
+            }
+            ++nextEvent;
+        }
+        // Split the callback at the next event to apply it sample accurately
+        SINT blockFrames = math_min(script.bufferFrames(),
+                script.durationFrames() - frame);
+        if (nextEvent != events.end()) {
+            blockFrames = math_min(blockFrames, nextEvent->frame - frame);
+        }
+        const int blockSamples = static_cast<int>(blockFrames * kEngineChannelCount);
+
+        if (!waitForReaders()) {
+            return false;
+        }
+        m_pEngineMaster->process(blockSamples);
+        pEncoder->encodeBuffer(m_pEngineMaster->getMasterBuffer(), blockSamples);
+        frame += blockFrames;
+
+        // Deliver queued signals from the engine, e.g. to the PlayerManager
+        QCoreApplication::processEvents();
+    }
+    pEncoder->flush();
+    m_file.close();
+
+    const double renderedSeconds =
+            static_cast<double>(frame) / script.sampleRate().value();
+    const double elapsedSeconds = timer.elapsed() / 1000.0;
+    kLogger.info() << "Rendered" << renderedSeconds << "s in" << elapsedSeconds
+                   << "s," << renderedSeconds / math_max(elapsedSeconds, 0.001)
+                   << "x realtime";
+    return true;
+}
+
+bool OfflineRenderer::applyEvent(const OfflineRenderEvent& event) {
+    switch (event.type) {
+    case OfflineRenderEvent::Type::SetControl: {
+        ControlObject* pControl = ControlObject::getControl(event.key);
+        if (!pControl) {
+            kLogger.warning() << "Unknown control" << event.key;
+            return false;
+        }
+        pControl->set(event.value);
+        return true;
+    }
+    case OfflineRenderEvent::Type::LoadTrack: {
+        BaseTrackPlayer* pPlayer = m_pPlayerManager->getPlayer(event.key.group);
+        if (!pPlayer) {
+            kLogger.warning() << "Unable to load a track into" << event.key.group;
+            return false;
+        }
+        if (!QFileInfo::exists(event.location)) {
+            kLogger.warning() << "Track" << event.location << "does not exist";
+            return false;
+        }
+        // There is no library, so the metadata (e.g. the BPM that is needed
+        // for sync) is imported from the file directly.
+        TrackPointer pTrack = Track::newTemporary(event.location);
+        SoundSourceProxy(pTrack).updateTrackFromSource(
+                SoundSourceProxy::UpdateTrackFromSourceMode::Once,
+                SyncTrackMetadataParams::readFromUserSettings(*m_pConfig));
+        pPlayer->slotLoadTrack(pTrack, false);
+        if (!m_deckGroups.contains(event.key.group)) {
+            m_deckGroups.append(event.key.group);
+        }
+        return waitForTrackLoaded(event.key.group);
+    }
+    }
+    DEBUG_ASSERT(!"unreachable");
+    return false;
+}
+
+bool OfflineRenderer::waitForTrackLoaded(const QString& group) {
+    auto* pDeck = dynamic_cast<EngineDeck*>(m_pEngineMaster->getChannel(group));
+    if (!pDeck) {
+        kLogger.warning() << "Unable to load a track into" << group;
+        return false;
+    }
+    EngineBuffer* pEngineBuffer = pDeck->getEngineBuffer();
+    // Emitted from the CachingReader worker thread, which might still be
+    // inside the slot after a timeout
+    const auto pLoadFailed = std::make_shared<std::atomic<bool>>(false);
+    const auto connection = QObject::connect(pEngineBuffer,
+            &EngineBuffer::trackLoadFailed,
+            [pLoadFailed](TrackPointer pTrack, const QString& reason) {
+                kLogger.warning() << "Failed to load" << pTrack->getLocation()
+                                  << reason;
+                *pLoadFailed = true;
+            });
+
+    QElapsedTimer timer;
+    timer.start();
+    // The CachingReader worker has been told about the new track but is
+    // only woken at the end of the next callback.
+    m_pEngineMaster->runWorkers();
+    bool loaded = true;
+    while (!pEngineBuffer->isTrackLoaded()) {
+        if (*pLoadFailed) {
+            loaded = false;
+            break;
+        }
+        if (timer.elapsed() > kTrackLoadTimeoutMillis) {
+            kLogger.warning() << "Timed out loading a track into" << group;
+            loaded = false;
+            break;
+        }
+        QCoreApplication::processEvents();
+        QThread::msleep(1);
+    }
+    QObject::disconnect(connection);
+    return loaded;
+}
+
+bool OfflineRenderer::waitForReaders() {
+    // All chunks that have been hinted in the previous callback must be
+    // available before the next one, otherwise the output would depend on
+    // how fast the disk and the workers are.
+    QElapsedTimer timer;
+    timer.start();
+    for (const auto& group : std::as_const(m_deckGroups)) {
+        auto* pDeck = dynamic_cast<EngineDeck*>(m_pEngineMaster->getChannel(group));
+        VERIFY_OR_DEBUG_ASSERT(pDeck) {
+            continue;
+        }
+        while (!pDeck->getEngineBuffer()->isReaderIdle()) {
+            if (timer.elapsed() > kReaderTimeoutMillis) {
+                // Continuing would render silence instead of the track
+                kLogger.warning() << "Timed out waiting for the reader of" << group;
+                return false;
+            }
+            QThread::yieldCurrentThread();
+        }
+    }
+    return true;
+}
+
+void OfflineRenderer::write(const unsigned char* header,
+        const unsigned char* body,
+        int headerLen,
+        int bodyLen) {
+    if (header) {
+        m_file.write(reinterpret_cast<const char*>(header), headerLen);
+    }
+    if (body) {
+        m_file.write(reinterpret_cast<const char*>(body), bodyLen);
+    }
+}
+
+int OfflineRenderer::tell() {
+    return static_cast<int>(m_file.pos());
+}
+
+void OfflineRenderer::seek(int pos) {
+    m_file.seek(pos);
+}
+
+int OfflineRenderer::filelen() {
+    return static_cast<int>(m_file.size());
+}
+
+} // namespace mixxx
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "audio/types.h"
+#include "encoder/encodercallback.h"
+#include "preferences/configobject.h"
+#include "preferences/usersettings.h"
+#include "util/types.h"
+
+class EngineMaster;
+class PlayerManagerInterface;
+
+namespace mixxx {
+
+/// A single scripted change of the mixer state, applied at the first
+/// sample of the given frame.
+struct OfflineRenderEvent {
+    enum class Type {
+        SetControl,
+        LoadTrack,
+    };
+
+    SINT frame;
+    Type type;
+    ConfigKey key;
+    /// Only for Type::SetControl
+    double value;
+    /// Only for Type::LoadTrack
+    QString location;
+};
+
+/// The parsed contents of a --render script. The script is a JSON object:
+///
+/// {
+///   "sampleRate": 44100,
+///   "bufferFrames": 1024,
+///   "duration": 300.0,
+///   "events": [
+///     { "time": 0.0, "group": "[Channel1]", "load": "/path/to/track.mp3" },
+///     { "time": 0.0, "group": "[Channel1]", "key": "play", "value": 1 },
+///     { "frame": 661500, "group": "[Master]", "key": "crossfader", "value": 0.5 }
+///   ]
+/// }
+///
+/// Event positions are given either in seconds ("time") or as a frame
+/// offset ("frame") from the start of the render. The length of the render
+/// is given by either "duration" in seconds or "durationFrames".
+class OfflineRenderScript {
+  public:
+    OfflineRenderScript();
+
+    /// Parses a script. Returns false and sets pErrorMessage if the script
+    /// is invalid.
+    bool parse(const QByteArray& json, QString* pErrorMessage);
+
+    audio::SampleRate sampleRate() const {
+        return m_sampleRate;
+    }
+    SINT bufferFrames() const {
+        return m_bufferFrames;
+    }
+    SINT durationFrames() const {
+        return m_durationFrames;
+    }
+    /// The events sorted by frame. Events at the same frame keep the order
+    /// of the script.
+    const std::vector<OfflineRenderEvent>& events() const {
+        return m_events;
+    }
+
+  private:
+    audio::SampleRate m_sampleRate;
+    SINT m_bufferFrames;
+    SINT m_durationFrames;
+    std::vector<OfflineRenderEvent> m_events;
+};
+
+/// Drives EngineMaster::process() in a tight loop without any sound device
+/// and encodes the master output to a file. The engine is not paced by a
+/// clock, so the render runs as fast as the CPU allows. Before each engine
+/// callback the renderer waits for the CachingReader workers of the decks
+/// to finish pending reads, so the result does not depend on disk or
+/// scheduling latencies and is reproducible.
+///
+/// Tracks are loaded directly into the players without a library, see
+/// CoreServices::initializeForRender().
+class OfflineRenderer : public EncoderCallback {
+  public:
+    OfflineRenderer(UserSettingsPointer pConfig,
+            EngineMaster* pEngineMaster,
+            PlayerManagerInterface* pPlayerManager);
+    ~OfflineRenderer() override;
+
+    /// Renders the script to the output file. Returns false if rendering
+    /// failed, e.g. if a track could not be loaded or a reader got stuck.
+    /// The reason has been logged.
+    bool render(const QString& scriptPath, const QString& outputPath);
+
+    // EncoderCallback
+    void write(const unsigned char* header,
+            const unsigned char* body,
+            int headerLen,
+            int bodyLen) override;
+    int tell() override;
+    void seek(int pos) override;
+    int filelen() override;
+
+  private:
+    bool applyEvent(const OfflineRenderEvent& event);
+    bool waitForTrackLoaded(const QString& group);
+    bool waitForReaders();
+
+    const UserSettingsPointer m_pConfig;
+    EngineMaster* const m_pEngineMaster;
+    PlayerManagerInterface* const m_pPlayerManager;
+
+    // All groups a track has been loaded to
+    QList<QString> m_deckGroups;
+
+    QFile m_file;
+};
+
+} // namespace mixxx
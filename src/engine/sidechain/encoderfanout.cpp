@@ -0,0 +1,273 @@
+#include "engine/sidechain/encoderfanout.h"
+
+#include "engine/sidechain/enginenetworkstream.h"
+#include "moc_encoderfanout.cpp"
+#include "recording/defs_recording.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("EncoderFanOut");
+
+} // anonymous namespace
+
+EncodedPacketQueue::EncodedPacketQueue(int maxBytes)
+        : m_maxBytes(maxBytes),
+          m_bytes(0),
+          m_overrunCount(0) {
+}
+
+bool EncodedPacketQueue::push(const EncodedPacket& packet) {
+    const auto locker = lockMutex(&m_mutex);
+    // A single packet that is larger than the queue is not dropped forever
+    if (m_bytes + packet.size() > m_maxBytes && !m_packets.empty()) {
+        m_overrunCount.fetchAndAddRelaxed(1);
+        return false;
+    }
+    m_packets.push_back(packet);
+    m_bytes += packet.size();
+    return true;
+}
+
+std::deque<EncodedPacket> EncodedPacketQueue::takeAll() {
+    std::deque<EncodedPacket> packets;
+    const auto locker = lockMutex(&m_mutex);
+    packets.swap(m_packets);
+    m_bytes = 0;
+    return packets;
+}
+
+void EncodedPacketQueue::clear() {
+    const auto locker = lockMutex(&m_mutex);
+    m_packets.clear();
+    m_bytes = 0;
+}
+
+EncoderFanOut::EncoderFanOut(const Key& key)
+        : m_key(key),
+          m_stop(0),
+          m_sinkCount(0) {
+    setState(NETWORKSTREAMWORKER_STATE_INIT);
+}
+
+EncoderFanOut::~EncoderFanOut() {
+    stop();
+    // Flushing writes the remaining packets, which nobody receives anymore
+    m_pEncoder.reset();
+}
+
+bool EncoderFanOut::isShareable() const {
+    return m_key.format == QLatin1String(ENCODING_MP3) ||
+            m_key.format == QLatin1String(ENCODING_AAC) ||
+            m_key.format == QLatin1String(ENCODING_HEAAC) ||
+            m_key.format == QLatin1String(ENCODING_HEAACV2);
+}
+
+int EncoderFanOut::initEncoder(EncoderSettingsPointer pSettings, QString* pUserErrorMessage) {
+    m_pEncoder = EncoderFactory::getFactory().createEncoder(pSettings, this);
+    if (!m_pEncoder) {
+        return -1;
+    }
+    const int ret = m_pEncoder->initEncoder(m_key.sampleRate, pUserErrorMessage);
+    if (ret < 0) {
+        m_pEncoder.reset();
+        setState(NETWORKSTREAMWORKER_STATE_ERROR);
+        return ret;
+    }
+    setState(NETWORKSTREAMWORKER_STATE_READY);
+    return ret;
+}
+
+void EncoderFanOut::addSink(NetworkOutputStreamWorker* pSink, EncodedPacketQueue* pQueue) {
+    const auto locker = lockMutex(&m_sinkMutex);
+    m_sinks.append(Sink{pSink, pQueue});
+    m_sinkCount.fetchAndAddRelease(1);
+}
+
+void EncoderFanOut::removeSink(NetworkOutputStreamWorker* pSink) {
+    const auto locker = lockMutex(&m_sinkMutex);
+    for (int i = 0; i < m_sinks.size(); ++i) {
+        if (m_sinks[i].pWorker == pSink) {
+            m_sinks.removeAt(i);
+            m_sinkCount.fetchAndAddRelease(-1);
+            return;
+        }
+    }
+}
+
+int EncoderFanOut::sinkCount() const {
+    return atomicLoadAcquire(m_sinkCount);
+}
+
+void EncoderFanOut::stop() {
+    m_stop.storeRelease(1);
+    m_readSema.release();
+    wait();
+}
+
+void EncoderFanOut::process(const CSAMPLE* pBuffer, const int iBufferSize) {
+    setFunctionCode(4);
+    if (iBufferSize > 0 && m_pEncoder) {
+        setState(NETWORKSTREAMWORKER_STATE_BUSY);
+        // The packets are received by the write() callback
+        m_pEncoder->encodeBuffer(pBuffer, iBufferSize);
+        setState(NETWORKSTREAMWORKER_STATE_READY);
+    }
+}
+
+void EncoderFanOut::outputAvailable() {
+    m_readSema.release();
+}
+
+void EncoderFanOut::setOutputFifo(QSharedPointer<FIFO<CSAMPLE>> pOutputFifo) {
+    m_pOutputFifo = pOutputFifo;
+}
+
+QSharedPointer<FIFO<CSAMPLE>> EncoderFanOut::getOutputFifo() {
+    return m_pOutputFifo;
+}
+
+bool EncoderFanOut::threadWaiting() {
+    // Nothing needs to be encoded until one of the sinks is connected
+    return sinkCount() > 0;
+}
+
+void EncoderFanOut::write(const unsigned char* header,
+        const unsigned char* body,
+        int headerLen,
+        int bodyLen) {
+    setFunctionCode(7);
+    EncodedPacket packet;
+    if (headerLen > 0) {
+        packet.header = QByteArray(reinterpret_cast<const char*>(header), headerLen);
+    }
+    packet.body = QByteArray(reinterpret_cast<const char*>(body), bodyLen);
+
+    const auto locker = lockMutex(&m_sinkMutex);
+    for (const Sink& sink : std::as_const(m_sinks)) {
+        sink.pQueue->push(packet);
+        sink.pWorker->outputAvailable();
+    }
+}
+
+// These are not used for streaming, but the interface requires them
+int EncoderFanOut::tell() {
+    return -1;
+}
+
+// These are not used for streaming, but the interface requires them
+void EncoderFanOut::seek(int pos) {
+    Q_UNUSED(pos)
+}
+
+// These are not used for streaming, but the interface requires them
+int EncoderFanOut::filelen() {
+    return 0;
+}
+
+void EncoderFanOut::run() {
+    QThread::currentThread()->setObjectName(
+            QString("EncoderFanOut %1 %2").arg(m_key.format, QString::number(m_key.quality)));
+    kLogger.debug() << "run: Starting thread";
+
+    VERIFY_OR_DEBUG_ASSERT(m_pOutputFifo) {
+        kLogger.warning() << "run: Broadcast FIFO handle is not available. Aborting";
+        return;
+    }
+
+    while (!atomicLoadRelaxed(m_stop)) {
+        setFunctionCode(1);
+        incRunCount();
+        if (!m_readSema.tryAcquire(1, 1000)) {
+            continue;
+        }
+
+        const int readAvailable = m_pOutputFifo->readAvailable();
+        if (readAvailable) {
+            setFunctionCode(3);
+            CSAMPLE* dataPtr1;
+            ring_buffer_size_t size1;
+            CSAMPLE* dataPtr2;
+            ring_buffer_size_t size2;
+
+            // We use size1 and size2, so we can ignore the return value
+            (void)m_pOutputFifo->aquireReadRegions(
+                    readAvailable, &dataPtr1, &size1, &dataPtr2, &size2);
+
+            // Push frames to the encoder.
+            process(dataPtr1, size1);
+            if (size2 > 0) {
+                process(dataPtr2, size2);
+            }
+
+            m_pOutputFifo->releaseReadRegions(readAvailable);
+        }
+    }
+
+    kLogger.debug() << "run: Thread stopped";
+}
+
+EncoderFanOutPool::EncoderFanOutPool(QSharedPointer<EngineNetworkStream> pNetworkStream)
+        : m_pNetworkStream(pNetworkStream) {
+}
+
+EncoderFanOutPool::~EncoderFanOutPool() {
+    // The connections release their encoders before they are destroyed
+    DEBUG_ASSERT(m_entries.isEmpty());
+}
+
+EncoderFanOutPtr EncoderFanOutPool::acquire(EncoderSettingsPointer pSettings,
+        mixxx::audio::SampleRate sampleRate,
+        QString* pUserErrorMessage) {
+    const EncoderFanOut::Key key{
+            pSettings->getFormat(),
+            pSettings->getQuality(),
+            pSettings->getChannelMode(),
+            sampleRate,
+    };
+
+    const auto locker = lockMutex(&m_mutex);
+    for (Entry& entry : m_entries) {
+        if (entry.pFanOut->isShareable() && entry.pFanOut->key() == key) {
+            ++entry.users;
+            kLogger.debug() << "Sharing the" << key.format << key.quality
+                            << "encoder with" << entry.users << "connections";
+            return entry.pFanOut;
+        }
+    }
+
+    auto pFanOut = EncoderFanOutPtr::create(key);
+    if (pFanOut->initEncoder(pSettings, pUserErrorMessage) < 0) {
+        return EncoderFanOutPtr();
+    }
+    m_pNetworkStream->addOutputWorker(pFanOut);
+    if (!pFanOut->getOutputFifo()) {
+        // All slots of the network stream are in use
+        return EncoderFanOutPtr();
+    }
+    pFanOut->start(QThread::HighPriority);
+    m_entries.append(Entry{pFanOut, 1});
+    return pFanOut;
+}
+
+void EncoderFanOutPool::release(const EncoderFanOutPtr& pFanOut) {
+    if (!pFanOut) {
+        return;
+    }
+
+    const auto locker = lockMutex(&m_mutex);
+    for (int i = 0; i < m_entries.size(); ++i) {
+        Entry& entry = m_entries[i];
+        if (entry.pFanOut != pFanOut) {
+            continue;
+        }
+        if (--entry.users == 0) {
+            pFanOut->stop();
+            m_pNetworkStream->removeOutputWorker(pFanOut);
+            m_entries.removeAt(i);
+        }
+        return;
+    }
+    DEBUG_ASSERT(!"Unknown EncoderFanOut");
+}
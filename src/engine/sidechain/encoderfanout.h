@@ -0,0 +1,183 @@
+#pragma once
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThread>
+#include <deque>
+
+#include "audio/types.h"
+#include "encoder/encoder.h"
+#include "encoder/encodercallback.h"
+#include "encoder/encodersettings.h"
+#include "engine/sidechain/networkoutputstreamworker.h"
+#include "util/compatibility/qatomic.h"
+#include "util/fifo.h"
+
+class EngineNetworkStream;
+
+/// A chunk of encoded audio as it was written by the encoder. Copies share
+/// the data, so every sink receives the same packet without copying it.
+struct EncodedPacket {
+    QByteArray header;
+    QByteArray body;
+
+    int size() const {
+        return header.size() + body.size();
+    }
+};
+
+/// The packets of one sink that have not been sent yet.
+///
+/// The queue is bounded, so a sink that cannot keep up only loses its own
+/// packets and does not slow down the encoder that is shared with others.
+class EncodedPacketQueue {
+  public:
+    explicit EncodedPacketQueue(int maxBytes);
+
+    /// Called by the encoding thread. Returns false if the packet has been
+    /// dropped, because the queue is full.
+    bool push(const EncodedPacket& packet);
+    /// Called by the sink thread to take all queued packets.
+    std::deque<EncodedPacket> takeAll();
+    void clear();
+
+    /// The number of packets dropped since the last reset
+    int overrunCount() const {
+        return atomicLoadRelaxed(m_overrunCount);
+    }
+    int resetOverrunCount() {
+        return m_overrunCount.fetchAndStoreRelaxed(0);
+    }
+
+  private:
+    const int m_maxBytes;
+    QMutex m_mutex;
+    std::deque<EncodedPacket> m_packets;
+    int m_bytes;
+    QAtomicInt m_overrunCount;
+};
+
+/// Encodes the broadcast output once for all connections that use the same
+/// encoder settings and hands the packets to each of them.
+///
+/// The fan-out is a NetworkOutputStreamWorker with its own thread, so the
+/// samples are encoded in parallel to the other encoders and independently
+/// of how fast the sinks send the packets. A sink is notified with
+/// NetworkOutputStreamWorker::outputAvailable() when it has new packets in
+/// its queue.
+class EncoderFanOut : public QThread,
+                      public EncoderCallback,
+                      public NetworkOutputStreamWorker {
+    Q_OBJECT
+  public:
+    /// Streams with the same key produce identical packets
+    struct Key {
+        QString format;
+        int quality;
+        EncoderSettings::ChannelMode channelMode;
+        mixxx::audio::SampleRate sampleRate;
+
+        bool operator==(const Key& other) const {
+            return format == other.format &&
+                    quality == other.quality &&
+                    channelMode == other.channelMode &&
+                    sampleRate == other.sampleRate;
+        }
+    };
+
+    explicit EncoderFanOut(const Key& key);
+    ~EncoderFanOut() override;
+
+    const Key& key() const {
+        return m_key;
+    }
+
+    /// Only streams that can be joined at any packet may share an encoder.
+    /// An Ogg stream for example starts with header pages that a sink joining
+    /// later would miss.
+    bool isShareable() const;
+
+    int initEncoder(EncoderSettingsPointer pSettings, QString* pUserErrorMessage);
+
+    /// Thread-safe. The sink receives all packets that are encoded until
+    /// removeSink() is called.
+    void addSink(NetworkOutputStreamWorker* pSink, EncodedPacketQueue* pQueue);
+    void removeSink(NetworkOutputStreamWorker* pSink);
+    int sinkCount() const;
+
+    void stop();
+
+    // NetworkOutputStreamWorker
+    void process(const CSAMPLE* pBuffer, const int iBufferSize) override;
+    void shutdown() override {
+    }
+    void outputAvailable() override;
+    void setOutputFifo(QSharedPointer<FIFO<CSAMPLE>> pOutputFifo) override;
+    QSharedPointer<FIFO<CSAMPLE>> getOutputFifo() override;
+    bool threadWaiting() override;
+
+    // EncoderCallback, called by the encoder on the fan-out thread
+    void write(const unsigned char* header,
+            const unsigned char* body,
+            int headerLen,
+            int bodyLen) override;
+    int tell() override;
+    void seek(int pos) override;
+    int filelen() override;
+
+  protected:
+    void run() override;
+
+  private:
+    struct Sink {
+        NetworkOutputStreamWorker* pWorker;
+        EncodedPacketQueue* pQueue;
+    };
+
+    const Key m_key;
+    EncoderPointer m_pEncoder;
+    QSharedPointer<FIFO<CSAMPLE>> m_pOutputFifo;
+    QSemaphore m_readSema;
+    QAtomicInt m_stop;
+
+    mutable QMutex m_sinkMutex;
+    QList<Sink> m_sinks;
+    QAtomicInt m_sinkCount;
+};
+
+typedef QSharedPointer<EncoderFanOut> EncoderFanOutPtr;
+
+/// Shares the encoders of the broadcast connections.
+///
+/// An encoder is created for the first connection with a given key and
+/// added to the network stream. It is removed when the last connection that
+/// uses it has released it.
+class EncoderFanOutPool {
+  public:
+    explicit EncoderFanOutPool(QSharedPointer<EngineNetworkStream> pNetworkStream);
+    ~EncoderFanOutPool();
+
+    /// Thread-safe. Returns a running fan-out with an initialized encoder or
+    /// nullptr if the encoder could not be initialized.
+    EncoderFanOutPtr acquire(EncoderSettingsPointer pSettings,
+            mixxx::audio::SampleRate sampleRate,
+            QString* pUserErrorMessage);
+    /// Thread-safe
+    void release(const EncoderFanOutPtr& pFanOut);
+
+  private:
+    struct Entry {
+        EncoderFanOutPtr pFanOut;
+        int users;
+    };
+
+    const QSharedPointer<EngineNetworkStream> m_pNetworkStream;
+    QMutex m_mutex;
+    QList<Entry> m_entries;
+};
+
+typedef QSharedPointer<EncoderFanOutPool> EncoderFanOutPoolPtr;
@@ -17,7 +17,6 @@
 
 #include "broadcast/defs_broadcast.h"
 #include "control/controlpushbutton.h"
-#include "encoder/encoder.h"
 #include "encoder/encoderbroadcastsettings.h"
 #ifdef __OPUS__
 #include "encoder/encoderopus.h"
@@ -38,6 +37,8 @@ constexpr int kMaxNetworkCache = 491520; // 10 s mp3 @ 192 kbit/s
 // Shoutcast default receive buffer 1048576 and autodumpsourcetime 30 s
 // http://wiki.shoutcast.com/wiki/SHOUTcast_DNAS_Server_2
 constexpr int kMaxShoutFailures = 3;
+// The packets that may be waiting to be sent, before they are dropped
+constexpr int kMaxQueuedPacketBytes = kMaxNetworkCache;
 
 const QRegularExpression kArtistOrTitleRegex(QStringLiteral("\\$artist|\\$title"));
 const QRegularExpression kArtistRegex(QStringLiteral("\\$artist"));
@@ -47,7 +48,8 @@ const mixxx::Logger kLogger("ShoutConnection");
 } // namespace
 
 ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
-        UserSettingsPointer pConfig)
+        UserSettingsPointer pConfig,
+        EncoderFanOutPoolPtr pEncoderFanOuts)
         : m_pTextCodec(nullptr),
           m_pMetaData(),
           m_pShout(nullptr),
@@ -57,7 +59,8 @@ ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
           m_iShoutFailures(0),
           m_pConfig(pConfig),
           m_pProfile(profile),
-          m_encoder(nullptr),
+          m_pEncoderFanOuts(pEncoderFanOuts),
+          m_packetQueue(kMaxQueuedPacketBytes),
           m_masterSamplerate("[Master]", "samplerate"),
           m_broadcastEnabled(BROADCAST_PREF_KEY, "enabled"),
           m_custom_metadata(false),
@@ -127,6 +130,8 @@ ShoutConnection::~ShoutConnection() {
        qWarning() << "ShoutOutput::~ShoutOutput(): Thread didn't die.\
        Ignored but file a bug report if problems rise!";
     }
+
+    releaseEncoder();
 }
 
 bool ShoutConnection::isConnected() {
@@ -187,10 +192,9 @@ void ShoutConnection::updateFromPreferences() {
 
     setState(NETWORKSTREAMWORKER_STATE_BUSY);
 
-    // Delete m_encoder if it has been initialized (with maybe) different bitrate.
-    // delete m_encoder calls write() check if it will be exit early
+    // Release the encoder if it has been initialized (with maybe) different bitrate.
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    releaseEncoder();
 
     m_format_is_mp3 = false;
     m_format_is_ov = false;
@@ -454,24 +458,14 @@ void ShoutConnection::updateFromPreferences() {
         return;
     }
 
-    // Initialize m_encoder
+    // Get an encoder, which is shared with the other connections that use
+    // the same settings
     EncoderSettingsPointer pBroadcastSettings =
             std::make_shared<EncoderBroadcastSettings>(m_pProfile);
-    m_encoder = EncoderFactory::getFactory().createEncoder(
-                    pBroadcastSettings, this);
-
     QString userErrorMsg;
-    int ret = -1;
-    if (m_encoder) {
-        ret = m_encoder->initEncoder(masterSamplerate, &userErrorMsg);
-    }
-
-    // TODO(XXX): Use mixxx::audio::SampleRate instead of int in initEncoder
-    if (ret < 0) {
-        // delete m_encoder calls write() make sure it will be exit early
-        DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-        m_encoder.reset();
-
+    m_pEncoderFanOut = m_pEncoderFanOuts->acquire(
+            pBroadcastSettings, masterSamplerate, &userErrorMsg);
+    if (!m_pEncoderFanOut) {
         setState(NETWORKSTREAMWORKER_STATE_ERROR);
 
         m_lastErrorStr = pBroadcastSettings->getFormat() + QChar(' ') +
@@ -503,7 +497,7 @@ bool ShoutConnection::processConnect() {
     // Make sure that we call updateFromPreferences always
     updateFromPreferences();
 
-    if (!m_encoder) {
+    if (!m_pEncoderFanOut) {
         // updateFromPreferences failed
         setStatus(BroadcastProfile::STATUS_FAILURE);
         kLogger.warning() << "ShoutOutput::processConnect() returning false";
@@ -596,9 +590,9 @@ bool ShoutConnection::processConnect() {
 
             m_retryCount = 0;
 
-            if(m_pOutputFifo->readAvailable()) {
-            	m_pOutputFifo->flushReadData(m_pOutputFifo->readAvailable());
-            }
+            // Start receiving the packets of the encoder
+            m_packetQueue.clear();
+            m_pEncoderFanOut->addSink(this, &m_packetQueue);
             m_threadWaiting = true;
 
             setStatus(BroadcastProfile::STATUS_CONNECTED);
@@ -621,9 +615,8 @@ bool ShoutConnection::processConnect() {
 
     // no connection, clean up
     shout_close(m_pShout);
-    // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    releaseEncoder();
     if (m_pProfile->getEnabled()) {
         setStatus(BroadcastProfile::STATUS_FAILURE);
     } else {
@@ -646,29 +639,39 @@ bool ShoutConnection::processDisconnect() {
         emit broadcastDisconnected();
         disconnected = true;
     }
-    // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    releaseEncoder();
     return disconnected;
 }
 
-void ShoutConnection::write(const unsigned char* header, const unsigned char* body,
-                            int headerLen, int bodyLen) {
+void ShoutConnection::releaseEncoder() {
+    if (m_pEncoderFanOut) {
+        // No more packets are queued after this
+        m_pEncoderFanOut->removeSink(this);
+        m_pEncoderFanOuts->release(m_pEncoderFanOut);
+        m_pEncoderFanOut.reset();
+    }
+    m_packetQueue.clear();
+}
+
+void ShoutConnection::write(const EncodedPacket& packet) {
     setFunctionCode(7);
-	if (!m_pShout || m_iShoutStatus != SHOUTERR_CONNECTED) {
-        // This happens when the decoder calls flush() and the connection is
-        // already down
+    if (!m_pShout || m_iShoutStatus != SHOUTERR_CONNECTED) {
+        // This happens when the connection is lost while sending the
+        // queued packets
         return;
     }
 
     // Send header if there is one
-    if (headerLen > 0) {
-        if(!writeSingle(header, headerLen)) {
+    if (!packet.header.isEmpty()) {
+        if (!writeSingle(reinterpret_cast<const unsigned char*>(packet.header.constData()),
+                    packet.header.size())) {
             return;
         }
     }
 
-    if(!writeSingle(body, bodyLen)) {
+    if (!writeSingle(reinterpret_cast<const unsigned char*>(packet.body.constData()),
+                packet.body.size())) {
         return;
     }
 
@@ -681,23 +684,6 @@ void ShoutConnection::write(const unsigned char* header, const unsigned char* bo
         }
     }
 }
-// These are not used for streaming, but the interface requires them
-int ShoutConnection::tell() {
-    if (!m_pShout) {
-        return -1;
-    }
-    return -1;
-}
-// These are not used for streaming, but the interface requires them
-void ShoutConnection::seek(int pos) {
-    Q_UNUSED(pos)
-    return;
-}
-// These are not used for streaming, but the interface requires them
-int ShoutConnection::filelen() {
-    return 0;
-}
-
 bool ShoutConnection::writeSingle(const unsigned char* data, size_t len) {
     setFunctionCode(8);
     int ret = shout_send_raw(m_pShout, data, len);
@@ -724,6 +710,12 @@ bool ShoutConnection::writeSingle(const unsigned char* data, size_t len) {
 }
 
 void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
+    Q_UNUSED(pBuffer);
+    Q_UNUSED(iBufferSize);
+    DEBUG_ASSERT(!"ShoutConnection does not receive samples");
+}
+
+void ShoutConnection::sendPackets() {
     setFunctionCode(4);
     if (!m_pProfile->getEnabled()) {
         return;
@@ -736,16 +728,20 @@ void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
         return;
     }
 
-    // Save a copy of the smart pointer in a local variable
-    // to prevent race conditions when resetting the member
-    // pointer while disconnecting in the worker thread!
-    const EncoderPointer pEncoder = m_encoder;
+    const int overruns = m_packetQueue.resetOverrunCount();
+    if (overruns > 0) {
+        kLogger.warning() << m_pProfile->getProfileName()
+                          << ": dropped" << overruns
+                          << "packets, because the connection is too slow";
+        for (int i = 0; i < overruns; ++i) {
+            incOverflowCount();
+        }
+    }
 
-    // If we are connected, encode the samples.
-    if (iBufferSize > 0 && pEncoder) {
-        setFunctionCode(6);
-        pEncoder->encodeBuffer(pBuffer, iBufferSize);
-        // the encoded frames are received by the write() callback.
+    setFunctionCode(6);
+    const std::deque<EncodedPacket> packets = m_packetQueue.takeAll();
+    for (const EncodedPacket& packet : packets) {
+        write(packet);
     }
 
     // Check if track metadata has changed and if so, update.
@@ -978,14 +974,6 @@ void ShoutConnection::outputAvailable() {
     m_readSema.release();
 }
 
-void ShoutConnection::setOutputFifo(QSharedPointer<FIFO<CSAMPLE>> pOutputFifo) {
-    m_pOutputFifo = pOutputFifo;
-}
-
-QSharedPointer<FIFO<CSAMPLE>> ShoutConnection::getOutputFifo() {
-    return m_pOutputFifo;
-}
-
 bool ShoutConnection::threadWaiting() {
     return atomicLoadRelaxed(m_threadWaiting);
 }
@@ -999,11 +987,6 @@ void ShoutConnection::run() {
     ignoreSigpipe();
 #endif
 
-    VERIFY_OR_DEBUG_ASSERT(m_pOutputFifo) {
-        kLogger.warning() << "run: Broadcast FIFO handle is not available. Aborting";
-        return;
-    }
-
     if (!processConnect()) {
         errorDialog(tr("Can't connect to streaming server"),
                 m_lastErrorStr + "\n\n" +
@@ -1035,26 +1018,8 @@ void ShoutConnection::run() {
             continue;
         }
 
-        int readAvailable = m_pOutputFifo->readAvailable();
-        if (readAvailable) {
-            setFunctionCode(3);
-            CSAMPLE* dataPtr1;
-            ring_buffer_size_t size1;
-            CSAMPLE* dataPtr2;
-            ring_buffer_size_t size2;
-
-            // We use size1 and size2, so we can ignore the return value
-            (void)m_pOutputFifo->aquireReadRegions(readAvailable, &dataPtr1, &size1,
-                    &dataPtr2, &size2);
-
-            // Push frames to the encoder.
-            process(dataPtr1, size1);
-            if (size2 > 0) {
-                process(dataPtr2, size2);
-            }
-
-            m_pOutputFifo->releaseReadRegions(readAvailable);
-        }
+        setFunctionCode(3);
+        sendPackets();
     }
 
     kLogger.debug() << "run: Thread stopped";
@@ -14,8 +14,7 @@
 
 #include "control/controlobject.h"
 #include "control/pollingcontrolproxy.h"
-#include "encoder/encoder.h"
-#include "encoder/encodercallback.h"
+#include "engine/sidechain/encoderfanout.h"
 #include "errordialoghandler.h"
 #include "preferences/broadcastprofile.h"
 #include "preferences/usersettings.h"
@@ -29,39 +28,30 @@ typedef struct shout shout_t;
 struct _util_dict;
 typedef struct _util_dict shout_metadata_t;
 
+/// Sends the packets of an EncoderFanOut to a streaming server. The encoder
+/// is shared with the other connections that use the same encoder settings.
 class ShoutConnection
-        : public QThread, public EncoderCallback, public NetworkOutputStreamWorker {
+        : public QThread, public NetworkOutputStreamWorker {
     Q_OBJECT
   public:
-    ShoutConnection(BroadcastProfilePtr profile, UserSettingsPointer pConfig);
+    ShoutConnection(BroadcastProfilePtr profile,
+            UserSettingsPointer pConfig,
+            EncoderFanOutPoolPtr pEncoderFanOuts);
     ~ShoutConnection() override;
 
-    // This is called by the Engine implementation for each sample. Encode and
-    // send the stream, as well as check for metadata changes.
+    // The samples are encoded by the EncoderFanOut, which notifies us with
+    // outputAvailable() when there are packets to send.
     void process(const CSAMPLE* pBuffer, const int iBufferSize) override;
 
     void shutdown() override {
     }
 
-    // Called by the encoder in method 'encodebuffer()' to flush the stream to
-    // the server.
-    void write(const unsigned char* header, const unsigned char* body,
-               int headerLen, int bodyLen) override;
-    // gets stream position
-    int tell() override;
-    // sets stream position
-    void seek(int pos) override;
-    // gets stream length
-    int filelen() override;
-
     /** connects to server **/
     bool serverConnect();
     bool isConnected();
     void applySettings();
 
     void outputAvailable() override;
-    void setOutputFifo(QSharedPointer<FIFO<CSAMPLE>> pOutputFifo) override;
-    QSharedPointer<FIFO<CSAMPLE>> getOutputFifo() override;
     bool threadWaiting() override;
     void run() override;
 
@@ -99,8 +89,11 @@ class ShoutConnection
     void errorDialog(const QString& text, const QString& detailedError);
     void infoDialog(const QString& text, const QString& detailedError);
 
-    void serverWrite(unsigned char *header, unsigned char *body,
-               int headerLen, int bodyLen);
+    // Send the queued packets and check for metadata changes
+    void sendPackets();
+    // Flush the packet to the server
+    void write(const EncodedPacket& packet);
+    void releaseEncoder();
 
 #ifndef __WINDOWS__
     void ignoreSigpipe();
@@ -124,7 +117,9 @@ class ShoutConnection
     long m_iShoutFailures;
     UserSettingsPointer m_pConfig;
     BroadcastProfilePtr m_pProfile;
-    EncoderPointer m_encoder;
+    EncoderFanOutPoolPtr m_pEncoderFanOuts;
+    EncoderFanOutPtr m_pEncoderFanOut;
+    EncodedPacketQueue m_packetQueue;
     PollingControlProxy m_masterSamplerate;
     PollingControlProxy m_broadcastEnabled;
     // static metadata according to prefereneces
@@ -147,7 +142,6 @@ class ShoutConnection
     bool m_ogg_dynamic_update;
     QAtomicInt m_threadWaiting;
     QSemaphore m_readSema;
-    QSharedPointer<FIFO<CSAMPLE>> m_pOutputFifo;
 
     QString m_lastErrorStr;
     int m_retryCount;
@@ -1,18 +1,58 @@
 #include "library/basetrackcache.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "library/queryutil.h"
 #include "library/searchqueryparser.h"
 #include "library/trackcollection.h"
+#include "library/trackset/crate/cratestorage.h"
 #include "moc_basetrackcache.cpp"
 #include "track/globaltrackcache.h"
 #include "track/keyutils.h"
 #include "track/track.h"
+#include "util/db/dbconnection.h"
 #include "util/performancetimer.h"
 
 namespace {
 
 constexpr bool sDebug = false;
 
+const QString kCrateSearchColumn = QStringLiteral("crate");
+
+// Search columns that contain text, only these can be searched with the
+// search index. LIKE converts the values of other types differently.
+const QStringList kTextSearchColumns = {
+        QStringLiteral("artist"),
+        QStringLiteral("album"),
+        QStringLiteral("album_artist"),
+        QStringLiteral("location"),
+        QStringLiteral("grouping"),
+        QStringLiteral("comment"),
+        QStringLiteral("title"),
+        QStringLiteral("genre"),
+        QStringLiteral("composer"),
+        QStringLiteral("key"),
+};
+
+// Each term of the previous search is contained in a term of the new search,
+// i.e. the new search only matches a subset of the previous result.
+bool isRefinedSearch(const QStringList& previousTerms, const QStringList& terms) {
+    for (const auto& previousTerm : previousTerms) {
+        bool refined = false;
+        for (const auto& term : terms) {
+            if (term.contains(previousTerm)) {
+                refined = true;
+                break;
+            }
+        }
+        if (!refined) {
+            return false;
+        }
+    }
+    return true;
+}
+
 }  // namespace
 
 BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
@@ -25,7 +65,10 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
           m_columnCount(columns.size()),
           m_columnsJoined(columns.join(",")),
           m_columnCache(columns),
+          m_pCrateStorage(&pTrackCollection->crates()),
           m_pQueryParser(new SearchQueryParser(pTrackCollection)),
+          m_bSearchIndexUsable(false),
+          m_bSearchIndexBuilt(false),
           m_bIndexBuilt(false),
           m_bIsCaching(isCaching),
           m_database(pTrackCollection->database()) {
@@ -37,14 +80,8 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
                     << "comment"
                     << "title"
                     << "genre"
-                    << "crate";
-
-    // Convert all the search column names to their field indexes because we use
-    // them a bunch.
-    m_searchColumnIndices.resize(m_searchColumns.size());
-    for (int i = 0; i < m_searchColumns.size(); ++i) {
-        m_searchColumnIndices[i] = m_columnCache.fieldIndex(m_searchColumns[i]);
-    }
+                    << kCrateSearchColumn;
+    updateSearchColumnIndices();
 }
 
 BaseTrackCache::~BaseTrackCache() {
@@ -93,6 +130,7 @@ void BaseTrackCache::slotTracksRemoved(const QSet<TrackId>& trackIds) {
     for (const auto& trackId : qAsConst(trackIds)) {
         m_trackInfo.remove(trackId);
         m_dirtyTracks.remove(trackId);
+        m_searchIndex.removeTrack(trackId);
     }
 }
 
@@ -126,6 +164,32 @@ void BaseTrackCache::ensureCached(const QSet<TrackId>& trackIds) {
 
 void BaseTrackCache::setSearchColumns(const QStringList& columns) {
     m_searchColumns = columns;
+    updateSearchColumnIndices();
+}
+
+void BaseTrackCache::updateSearchColumnIndices() {
+    // Convert all the search column names to their field indexes because we use
+    // them a bunch.
+    m_searchColumnIndices.resize(m_searchColumns.size());
+    m_searchIndexColumns.clear();
+    m_bSearchIndexUsable = true;
+    for (int i = 0; i < m_searchColumns.size(); ++i) {
+        m_searchColumnIndices[i] = m_columnCache.fieldIndex(m_searchColumns[i]);
+        if (m_searchColumns[i] == kCrateSearchColumn) {
+            // Crate names are looked up in the database
+            continue;
+        }
+        if (m_searchColumnIndices[i] < 0 ||
+                !kTextSearchColumns.contains(m_searchColumns[i])) {
+            // Only the database can search it
+            m_bSearchIndexUsable = false;
+        }
+        m_searchIndexColumns.append(m_searchColumnIndices[i]);
+    }
+    if (m_searchIndexColumns.isEmpty()) {
+        m_bSearchIndexUsable = false;
+    }
+    m_bSearchIndexBuilt = false;
 }
 
 const TrackPointer& BaseTrackCache::getRecentTrack(TrackId trackId) const {
@@ -226,6 +290,7 @@ bool BaseTrackCache::updateTrackInIndex(
         for (int i = 0; i < numColumns; ++i) {
             getTrackValueForColumn(pTrack, i, record[i]);
         }
+        updateTrackInSearchIndex(trackId, record);
         if (m_bIsCaching) {
             replaceRecentTrack(std::move(trackId), std::move(pTrack));
         }
@@ -281,6 +346,7 @@ bool BaseTrackCache::updateIndexWithQuery(const QString& queryString) {
                 record[i] = query.value(i);
             }
         }
+        updateTrackInSearchIndex(trackId, record);
     }
 
     qDebug() << this << "updateIndexWithQuery took" << timer.elapsed().debugMillisWithUnit();
@@ -303,6 +369,8 @@ void BaseTrackCache::buildIndex() {
     // clear the table, and keep track of what IDs we see, then delete the ones
     // we don't see.
     m_trackInfo.clear();
+    // Rebuilt on the next search
+    m_bSearchIndexBuilt = false;
 
     if (!updateIndexWithQuery(queryString)) {
         qDebug() << "buildIndex failed!";
@@ -323,6 +391,8 @@ void BaseTrackCache::updateTracksInIndex(const QSet<TrackId>& trackIds) {
     }
 
     QStringList idStrings;
+    // TODO(rryan) consider making this the data passed in and a separate
+    // QVector for output
     for (const auto& trackId: trackIds) {
         idStrings << trackId.toString();
     }
@@ -454,6 +524,210 @@ QVariant BaseTrackCache::data(TrackId trackId, int column) const {
     return result;
 }
 
+void BaseTrackCache::buildSearchIndex() {
+    PerformanceTimer timer;
+    timer.start();
+
+    QVector<TrackSearchIndex::ColumnType> columnTypes;
+    columnTypes.reserve(m_searchIndexColumns.size());
+    for (const int column : qAsConst(m_searchIndexColumns)) {
+        if (column == fieldIndex(ColumnCache::COLUMN_TRACKLOCATIONSTABLE_LOCATION)) {
+            columnTypes.append(TrackSearchIndex::ColumnType::Path);
+        } else {
+            columnTypes.append(TrackSearchIndex::ColumnType::Text);
+        }
+    }
+    m_searchIndex.reset(columnTypes);
+    m_bSearchIndexBuilt = true;
+    for (auto it = m_trackInfo.constBegin(); it != m_trackInfo.constEnd(); ++it) {
+        updateTrackInSearchIndex(it.key(), it.value());
+    }
+
+    qDebug() << this << "buildSearchIndex took" << timer.elapsed().debugMillisWithUnit();
+}
+
+void BaseTrackCache::updateTrackInSearchIndex(
+        TrackId trackId, const QVector<QVariant>& record) {
+    if (!m_bSearchIndexBuilt) {
+        return;
+    }
+    QStringList values;
+    values.reserve(m_searchIndexColumns.size());
+    for (const int column : qAsConst(m_searchIndexColumns)) {
+        QString value = record.value(column).toString();
+        if (column == fieldIndex(ColumnCache::COLUMN_TRACKLOCATIONSTABLE_LOCATION)) {
+            // Search the locations as stored in the database
+            value = QDir::fromNativeSeparators(value);
+        }
+        values.append(value);
+    }
+    m_searchIndex.updateTrack(trackId, values);
+}
+
+std::vector<int> BaseTrackCache::matchSearchIndexTerm(const QString& term,
+        const std::vector<int>* pCandidateRows) const {
+    std::vector<int> rows = m_searchIndex.matchTerm(term, pCandidateRows);
+    if (!m_searchColumns.contains(kCrateSearchColumn)) {
+        return rows;
+    }
+
+    // Like SearchQueryParser, also match the names of the crates
+    // that contain the track
+    std::vector<int> crateRows;
+    CrateTrackSelectResult crateTracks(
+            m_pCrateStorage->selectTracksSortedByCrateNameLike(term));
+    while (crateTracks.next()) {
+        const int row = m_searchIndex.rowOfTrack(crateTracks.trackId());
+        if (row < 0) {
+            continue;
+        }
+        if (pCandidateRows &&
+                !std::binary_search(pCandidateRows->cbegin(), pCandidateRows->cend(), row)) {
+            continue;
+        }
+        crateRows.push_back(row);
+    }
+    if (crateRows.empty()) {
+        return rows;
+    }
+    std::sort(crateRows.begin(), crateRows.end());
+    crateRows.erase(std::unique(crateRows.begin(), crateRows.end()), crateRows.end());
+    std::vector<int> mergedRows;
+    mergedRows.reserve(rows.size() + crateRows.size());
+    std::set_union(rows.cbegin(),
+            rows.cend(),
+            crateRows.cbegin(),
+            crateRows.cend(),
+            std::back_inserter(mergedRows));
+    return mergedRows;
+}
+
+bool BaseTrackCache::filterWithSearchIndex(const QSet<TrackId>& trackIds,
+        const QStringList& searchTerms,
+        const QString& extraFilter,
+        const QString& orderByClause,
+        QHash<TrackId, int>* trackToIndex) {
+    PerformanceTimer timer;
+    timer.start();
+
+    if (!m_bSearchIndexBuilt) {
+        buildSearchIndex();
+    }
+
+    IndexedSearch search;
+    search.extraFilter = extraFilter;
+    search.orderByClause = orderByClause;
+    search.generation = m_searchIndex.generation();
+    for (const auto& term : searchTerms) {
+        QString foldedTerm = term;
+        mixxx::DbConnection::makeStringLatinLow(&foldedTerm);
+        search.foldedTerms.append(foldedTerm);
+    }
+
+    // The order of a subset of the previous result doesn't change as long
+    // as the tracks are unchanged
+    const bool refine = m_lastIndexedSearch.generation == search.generation &&
+            m_lastIndexedSearch.extraFilter == extraFilter &&
+            m_lastIndexedSearch.orderByClause == orderByClause &&
+            isRefinedSearch(m_lastIndexedSearch.foldedTerms, search.foldedTerms) &&
+            m_lastIndexedSearch.trackIds == trackIds;
+    if (!refine) {
+        for (const auto& trackId : trackIds) {
+            if (!m_searchIndex.containsTrack(trackId)) {
+                // Only the database knows about this track
+                return false;
+            }
+        }
+    }
+    search.trackIds = trackIds;
+
+    std::vector<int> rows;
+    const std::vector<int>* pCandidateRows = refine ? &m_lastIndexedSearch.rows : nullptr;
+    for (const auto& term : searchTerms) {
+        rows = matchSearchIndexTerm(term, pCandidateRows);
+        pCandidateRows = &rows;
+        if (rows.empty()) {
+            break;
+        }
+    }
+
+    if (refine) {
+        std::vector<bool> matchingRows(m_searchIndex.rowCount(), false);
+        for (const int row : rows) {
+            matchingRows[row] = true;
+        }
+        search.orderedRows.reserve(rows.size());
+        for (const int row : m_lastIndexedSearch.orderedRows) {
+            if (matchingRows[row]) {
+                search.orderedRows.push_back(row);
+            }
+        }
+    } else {
+        QStringList idStrings;
+        for (const int row : rows) {
+            const TrackId trackId = m_searchIndex.trackIdOfRow(row);
+            if (trackIds.contains(trackId)) {
+                idStrings << trackId.toString();
+            }
+        }
+        if (!idStrings.isEmpty()) {
+            QStringList queryFragments;
+            if (!extraFilter.isEmpty()) {
+                queryFragments << QString("(%1)").arg(extraFilter);
+            }
+            queryFragments << QString("%1 in (%2)")
+                                      .arg(m_idColumn, idStrings.join(","));
+            QString queryString = QString("SELECT %1 FROM %2 WHERE %3 %4")
+                                          .arg(m_idColumn,
+                                                  m_tableName,
+                                                  queryFragments.join(" AND "),
+                                                  orderByClause);
+            if (sDebug) {
+                qDebug() << this << "filterWithSearchIndex executing:" << queryString;
+            }
+
+            QSqlQuery query(m_database);
+            query.setForwardOnly(true);
+            query.prepare(queryString);
+            if (!query.exec()) {
+                LOG_FAILED_QUERY(query);
+                return false;
+            }
+            const int idColumn = query.record().indexOf(m_idColumn);
+            search.orderedRows.reserve(idStrings.size());
+            while (query.next()) {
+                const int row = m_searchIndex.rowOfTrack(TrackId(query.value(idColumn)));
+                VERIFY_OR_DEBUG_ASSERT(row >= 0) {
+                    continue;
+                }
+                search.orderedRows.push_back(row);
+            }
+        }
+    }
+
+    m_trackOrder.resize(0); // keeps allocated memory
+    m_trackOrder.reserve(static_cast<int>(search.orderedRows.size()));
+    trackToIndex->clear();
+    trackToIndex->reserve(static_cast<int>(search.orderedRows.size()));
+    for (const int row : search.orderedRows) {
+        const TrackId trackId = m_searchIndex.trackIdOfRow(row);
+        (*trackToIndex)[trackId] = m_trackOrder.size();
+        m_trackOrder.append(trackId);
+    }
+
+    search.rows = search.orderedRows;
+    std::sort(search.rows.begin(), search.rows.end());
+    m_lastIndexedSearch = std::move(search);
+
+    if (sDebug) {
+        qDebug() << this << "filterWithSearchIndex took"
+                 << timer.elapsed().debugMillisWithUnit()
+                 << (refine ? "refining the previous result" : "")
+                 << "rows:" << m_trackOrder.size();
+    }
+    return true;
+}
+
 void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
                                    const QString& searchQuery,
                                    const QString& extraFilter,
@@ -470,13 +744,9 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         buildIndex();
     }
 
-    QStringList idStrings;
-    // TODO(rryan) consider making this the data passed in and a separate
-    // QVector for output
     QSet<TrackId> dirtyTracks;
-    for (const auto& trackId: trackIds) {
-        idStrings << trackId.toString();
-        if (m_dirtyTracks.contains(trackId)) {
+    for (const auto& trackId : qAsConst(m_dirtyTracks)) {
+        if (trackIds.contains(trackId)) {
             dirtyTracks.insert(trackId);
         }
     }
@@ -485,6 +755,39 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
     if (!extraFilter.isNull() && extraFilter != "") {
         queryFragments << QString("(%1)").arg(extraFilter);
     }
+
+    // Free-text searches are matched by the search index. The database
+    // only needs to sort the result.
+    QStringList searchTerms;
+    if (m_bSearchIndexUsable &&
+            m_pQueryParser->splitIntoPlainTerms(searchQuery, &searchTerms) &&
+            !searchTerms.isEmpty() &&
+            filterWithSearchIndex(trackIds,
+                    searchTerms,
+                    extraFilter,
+                    orderByClause,
+                    trackToIndex)) {
+        // The id list is not needed for matching the dirty tracks
+        const std::unique_ptr<QueryNode> pQuery =
+                m_pQueryParser->parseQuery(
+                        searchQuery,
+                        m_searchColumns,
+                        queryFragments.join(" AND "));
+        updateDirtyTracksInResult(dirtyTracks,
+                searchQuery,
+                *pQuery,
+                sortColumns,
+                columnOffset,
+                trackToIndex);
+        return;
+    }
+
+    QStringList idStrings;
+    // TODO(rryan) consider making this the data passed in and a separate
+    // QVector for output
+    for (const auto& trackId: trackIds) {
+        idStrings << trackId.toString();
+    }
     if (idStrings.size() > 0) {
         queryFragments << QString("%1 in (%2)")
                 .arg(m_idColumn, idStrings.join(","));
@@ -538,6 +841,20 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         m_trackOrder.append(trackId);
     }
 
+    updateDirtyTracksInResult(dirtyTracks,
+            searchQuery,
+            *pQuery,
+            sortColumns,
+            columnOffset,
+            trackToIndex);
+}
+
+void BaseTrackCache::updateDirtyTracksInResult(const QSet<TrackId>& dirtyTracks,
+        const QString& searchQuery,
+        const QueryNode& query,
+        const QList<SortColumn>& sortColumns,
+        const int columnOffset,
+        QHash<TrackId, int>* trackToIndex) {
     // At this point, the original set of tracks have been divided into two
     // pieces: those that should be in the result set and those that should
     // not. Unfortunately, due to TrackDAO caching, there may be tracks in
@@ -563,7 +880,7 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         // The track should be in the result set if the search is empty or the
         // track matches the search.
         bool shouldBeInResultSet = searchQuery.isEmpty() ||
-                pQuery->match(pTrack);
+                query.match(pTrack);
 
         // If the track is in this result set.
         bool isInResultSet = trackToIndex->contains(trackId);
@@ -9,13 +9,17 @@
 #include <QStringList>
 #include <QVector>
 #include <memory>
+#include <vector>
 
 #include "library/columncache.h"
+#include "library/tracksearchindex.h"
 #include "track/track_decl.h"
 #include "track/trackid.h"
 #include "util/class.h"
 #include "util/string.h"
 
+class CrateStorage;
+class QueryNode;
 class SearchQueryParser;
 class TrackCollection;
 
@@ -87,6 +91,21 @@ class BaseTrackCache : public QObject {
     void slotTrackClean(TrackId trackId);
 
   private:
+    // The result of a search that has been answered by the search index.
+    // A search that only adds characters to the terms can be answered by
+    // filtering the previous result.
+    struct IndexedSearch {
+        QSet<TrackId> trackIds;
+        QString extraFilter;
+        QString orderByClause;
+        QStringList foldedTerms;
+        quint64 generation = 0;
+        // The rows of the result in the search index, in ascending order
+        std::vector<int> rows;
+        // The rows in the order of the result
+        std::vector<int> orderedRows;
+    };
+
     const TrackPointer& getRecentTrack(TrackId trackId) const;
     void replaceRecentTrack(TrackPointer pTrack) const;
     void replaceRecentTrack(TrackId trackId, TrackPointer pTrack) const;
@@ -99,6 +118,23 @@ class BaseTrackCache : public QObject {
     void getTrackValueForColumn(TrackPointer pTrack, int column,
                                 QVariant& trackValue) const;
 
+    void updateSearchColumnIndices();
+    void buildSearchIndex();
+    void updateTrackInSearchIndex(TrackId trackId, const QVector<QVariant>& record);
+    std::vector<int> matchSearchIndexTerm(const QString& term,
+            const std::vector<int>* pCandidateRows) const;
+    bool filterWithSearchIndex(const QSet<TrackId>& trackIds,
+            const QStringList& searchTerms,
+            const QString& extraFilter,
+            const QString& orderByClause,
+            QHash<TrackId, int>* trackToIndex);
+    void updateDirtyTracksInResult(const QSet<TrackId>& dirtyTracks,
+            const QString& searchQuery,
+            const QueryNode& query,
+            const QList<SortColumn>& sortColumns,
+            const int columnOffset,
+            QHash<TrackId, int>* trackToIndex);
+
     int findSortInsertionPoint(TrackPointer pTrack,
                                const QList<SortColumn>& sortColumns,
                                const int columnOffset,
@@ -122,6 +158,7 @@ class BaseTrackCache : public QObject {
 
     const ColumnCache m_columnCache;
 
+    const CrateStorage* const m_pCrateStorage;
     const std::unique_ptr<SearchQueryParser> m_pQueryParser;
 
     const mixxx::StringCollator m_collator;
@@ -129,6 +166,16 @@ class BaseTrackCache : public QObject {
     QStringList m_searchColumns;
     QVector<int> m_searchColumnIndices;
 
+    // Free-text searches are answered from an in-memory index if all
+    // search columns are cached. The index is built on the first search.
+    bool m_bSearchIndexUsable;
+    bool m_bSearchIndexBuilt;
+    // The columns in m_searchIndex, i.e. the search columns without the
+    // crate names
+    QVector<int> m_searchIndexColumns;
+    TrackSearchIndex m_searchIndex;
+    IndexedSearch m_lastIndexedSearch;
+
     // Temporary storage for filterAndSort()
 
     QVector<TrackId> m_trackOrder;
@@ -2,13 +2,16 @@
 
 #include <QFutureWatcher>
 #include <QPixmapCache>
+#include <QThread>
 #include <QtConcurrentRun>
 #include <QtDebug>
 
+#include "library/coverartthumbnailstore.h"
 #include "library/coverartutils.h"
 #include "moc_coverartcache.cpp"
 #include "track/track.h"
 #include "util/logger.h"
+#include "util/math.h"
 #include "util/thread_affinity.h"
 
 namespace {
@@ -24,6 +27,10 @@ mixxx::Logger kLogger("CoverArtCache");
 // in order to allow CoverCache handle more covers (performance gain).
 constexpr int kPixmapCacheLimit = 20480;
 
+// Loading covers is mostly waiting for the file system, but a few threads
+// are enough to keep up with scrolling
+constexpr int kMaxLoaderThreads = 4;
+
 QString pixmapCacheKey(mixxx::cache_key_t hash, int width) {
     return QString("CoverArtCache_%1_%2")
             .arg(QString::number(hash), QString::number(width));
@@ -39,8 +46,13 @@ inline QImage resizeImageWidth(const QImage& image, int width) {
 
 } // anonymous namespace
 
-CoverArtCache::CoverArtCache() {
+CoverArtCache::CoverArtCache()
+        : m_activeRequests(0) {
     QPixmapCache::setCacheLimit(kPixmapCacheLimit);
+    m_loaderThreadPool.setMaxThreadCount(
+            math_min(kMaxLoaderThreads, QThread::idealThreadCount()));
+    m_pruneThumbnailsFuture = QtConcurrent::run(
+            &m_loaderThreadPool, [] { CoverArtThumbnailStore::prune(); });
 }
 
 //static
@@ -136,27 +148,70 @@ QPixmap CoverArtCache::tryLoadCover(
 
     if (kLogger.traceEnabled()) {
         kLogger.trace()
-                << "requestCover starting future for"
+                << "requestCover queueing"
                 << coverInfo;
     }
     m_runningRequests.insert(requestId);
-    // The watcher will be deleted in coverLoaded()
-    QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
-    QFuture<FutureResult> future = QtConcurrent::run(
-            &CoverArtCache::loadCover,
+    m_pendingRequests.append(PendingRequest{
             pRequestor,
             pTrack,
             coverInfo,
             desiredWidth,
-            loading == Loading::Default);
-    connect(watcher,
-            &QFutureWatcher<FutureResult>::finished,
-            this,
-            &CoverArtCache::coverLoaded);
-    watcher->setFuture(future);
+            loading == Loading::Default});
+    startPendingRequests();
     return QPixmap();
 }
 
+void CoverArtCache::startPendingRequests() {
+    while (m_activeRequests < m_loaderThreadPool.maxThreadCount() &&
+            !m_pendingRequests.isEmpty()) {
+        PendingRequest request = m_pendingRequests.takeLast();
+        if (kLogger.traceEnabled()) {
+            kLogger.trace()
+                    << "requestCover starting future for"
+                    << request.coverInfo;
+        }
+        ++m_activeRequests;
+        // The watcher will be deleted in coverLoaded()
+        QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
+        QFuture<FutureResult> future = QtConcurrent::run(
+                &m_loaderThreadPool,
+                &CoverArtCache::loadCover,
+                request.pRequestor,
+                std::move(request.pTrack),
+                std::move(request.coverInfo),
+                request.desiredWidth,
+                request.signalWhenDone);
+        connect(watcher,
+                &QFutureWatcher<FutureResult>::finished,
+                this,
+                &CoverArtCache::coverLoaded);
+        watcher->setFuture(future);
+    }
+}
+
+QList<mixxx::cache_key_t> CoverArtCache::cancelPendingRequests(const QObject* pRequestor) {
+    QList<mixxx::cache_key_t> cancelledCacheKeys;
+    auto i = m_pendingRequests.begin();
+    while (i != m_pendingRequests.end()) {
+        if (i->pRequestor != pRequestor) {
+            ++i;
+            continue;
+        }
+        const auto cacheKey = i->coverInfo.cacheKey();
+        m_runningRequests.remove(qMakePair(pRequestor, cacheKey));
+        cancelledCacheKeys.append(cacheKey);
+        i = m_pendingRequests.erase(i);
+    }
+    if (kLogger.traceEnabled() && !cancelledCacheKeys.isEmpty()) {
+        kLogger.trace()
+                << "Cancelled"
+                << cancelledCacheKeys.size()
+                << "pending requests";
+    }
+    return cancelledCacheKeys;
+}
+
 //static
 CoverArtCache::FutureResult CoverArtCache::loadCover(
         const QObject* pRequestor,
@@ -180,11 +235,35 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
             signalWhenDone);
     DEBUG_ASSERT(!res.coverInfoUpdated);
 
+    // The library table requests the same thumbnails again whenever they
+    // have been evicted from the QPixmapCache
+    QString thumbnailPath;
+    bool thumbnailOutdated = false;
+    QImage thumbnail = CoverArtThumbnailStore::load(
+            coverInfo, desiredWidth, &thumbnailPath, &thumbnailOutdated);
+    if (!thumbnail.isNull()) {
+        CoverInfo::LoadedImage loadedThumbnail(CoverInfo::LoadedImage::Result::Ok);
+        loadedThumbnail.image = std::move(thumbnail);
+        loadedThumbnail.location = std::move(thumbnailPath);
+        res.coverArt = CoverArt(
+                std::move(coverInfo),
+                std::move(loadedThumbnail),
+                desiredWidth);
+        return res;
+    }
+
     auto loadedImage = coverInfo.loadImage(
             pTrack ? pTrack->getFileAccess().token() : SecurityTokenPointer());
     if (!loadedImage.image.isNull()) {
         // Refresh hash before resizing the original image!
-        res.coverInfoUpdated = coverInfo.refreshImageDigest(loadedImage.image);
+        if (thumbnailOutdated) {
+            // The existing digest might not match the modified original
+            const CoverInfoRelative previousCoverInfo = coverInfo;
+            coverInfo.setImage(loadedImage.image);
+            res.coverInfoUpdated = previousCoverInfo != coverInfo;
+        } else {
+            res.coverInfoUpdated = coverInfo.refreshImageDigest(loadedImage.image);
+        }
         if (pTrack && res.coverInfoUpdated) {
             kLogger.info()
                     << "Updating cover info of track"
@@ -197,6 +276,7 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
             // Adjust the cover size according to the request
             // or downsize the image for efficiency.
             loadedImage.image = resizeImageWidth(loadedImage.image, desiredWidth);
+            CoverArtThumbnailStore::save(coverInfo, loadedImage.image);
         }
     }
 
@@ -266,6 +346,9 @@ void CoverArtCache::coverLoaded() {
     }
 
     m_runningRequests.remove(qMakePair(res.pRequestor, res.requestedCacheKey));
+    --m_activeRequests;
+    DEBUG_ASSERT(m_activeRequests >= 0);
+    startPendingRequests();
 
     if (res.signalWhenDone) {
         emit coverFound(
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <QFuture>
+#include <QList>
 #include <QObject>
 #include <QPair>
 #include <QPixmap>
 #include <QSet>
+#include <QThreadPool>
 #include <QtDebug>
 
 #include "library/coverart.h"
@@ -52,6 +55,12 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
                 loading);
     }
 
+    /// Drops all requests of pRequestor that are still waiting for a
+    /// worker thread, e.g. for rows of the library table that have been
+    /// scrolled away. Requests that are already being loaded are not
+    /// affected. Returns the cache keys of the dropped requests.
+    QList<mixxx::cache_key_t> cancelPendingRequests(const QObject* pRequestor);
+
     // Only public for testing
     struct FutureResult {
         FutureResult()
@@ -116,7 +125,27 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
             int desiredWidth,
             Loading loading);
 
+    // Starts loading the most recent pending requests while there are
+    // idle worker threads
+    void startPendingRequests();
+
+    struct PendingRequest {
+        const QObject* pRequestor;
+        TrackPointer pTrack;
+        CoverInfo coverInfo;
+        int desiredWidth;
+        bool signalWhenDone;
+    };
+
     QSet<QPair<const QObject*, mixxx::cache_key_t>> m_runningRequests;
+    // Requests that are waiting for a worker thread. The most recent
+    // request is loaded first, because it is most likely still visible.
+    QList<PendingRequest> m_pendingRequests;
+    int m_activeRequests;
+    // Bounded, so that scrolling through the library does not occupy
+    // all cores with decoding cover images
+    QThreadPool m_loaderThreadPool;
+    QFuture<void> m_pruneThumbnailsFuture;
 };
 
 inline
@@ -57,6 +57,17 @@ void CoverArtDelegate::emitRowsChanged(
 void CoverArtDelegate::slotInhibitLazyLoading(
         bool inhibitLazyLoading) {
     m_inhibitLazyLoading = inhibitLazyLoading;
+    if (m_inhibitLazyLoading && m_pCache) {
+        // The rows that are waiting for their covers are probably scrolled
+        // away by now. Those that are still visible are requested again
+        // when scrolling stops.
+        const QList<mixxx::cache_key_t> cancelledCacheKeys =
+                m_pCache->cancelPendingRequests(this);
+        for (const auto cacheKey : cancelledCacheKeys) {
+            m_cacheMissRows.append(m_pendingCacheRows.values(cacheKey));
+            m_pendingCacheRows.remove(cacheKey);
+        }
+    }
     if (m_inhibitLazyLoading || m_cacheMissRows.isEmpty()) {
         return;
     }
@@ -0,0 +1,215 @@
+#include "library/coverartthumbnailstore.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QImageReader>
+#include <QSaveFile>
+#include <algorithm>
+
+#include "util/fileinfo.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CoverArtThumbnailStore");
+
+// Opaque thumbnails are much smaller as JPEG, the others need PNG
+const char* const kOpaqueFormat = "JPG";
+const char* const kTransparentFormat = "PNG";
+const QString kOpaqueFileSuffix = QStringLiteral(".jpg");
+const QString kTransparentFileSuffix = QStringLiteral(".png");
+constexpr int kJpegQuality = 90;
+
+// Only written once during startup before any covers are loaded
+QString s_storageDirectory;
+
+QString cacheKeyName(mixxx::cache_key_t cacheKey) {
+    return QString::number(cacheKey, 16).rightJustified(16, '0');
+}
+
+// The thumbnails are distributed over 256 subdirectories to keep the
+// directories small for large libraries
+QString directoryPathForKey(mixxx::cache_key_t cacheKey) {
+    return QDir(s_storageDirectory).absoluteFilePath(cacheKeyName(cacheKey).left(2));
+}
+
+QString fileNameForKey(mixxx::cache_key_t cacheKey, int width, const QString& suffix) {
+    return cacheKeyName(cacheKey) + QChar('_') + QString::number(width) + suffix;
+}
+
+// The file that contains the original image, i.e. either the audio file
+// or the image file. Same as in CoverInfo::loadImage().
+mixxx::FileInfo sourceFileInfo(const CoverInfo& coverInfo) {
+    if (coverInfo.type == CoverInfo::METADATA) {
+        return mixxx::FileInfo(coverInfo.trackLocation);
+    }
+    if (coverInfo.type != CoverInfo::FILE) {
+        return mixxx::FileInfo();
+    }
+    const auto coverFile = mixxx::FileInfo(coverInfo.coverLocation);
+    if (!coverFile.isRelative() || coverInfo.trackLocation.isEmpty()) {
+        return coverFile;
+    }
+    return mixxx::FileInfo(
+            mixxx::FileInfo(coverInfo.trackLocation).locationPath(),
+            coverInfo.coverLocation);
+}
+
+} // anonymous namespace
+
+// static
+void CoverArtThumbnailStore::setStorageDirectory(const QString& directoryPath) {
+    s_storageDirectory = directoryPath;
+}
+
+// static
+QString CoverArtThumbnailStore::storageDirectory() {
+    return s_storageDirectory;
+}
+
+// static
+bool CoverArtThumbnailStore::isStorable(const CoverInfo& coverInfo, int width) {
+    return !s_storageDirectory.isEmpty() &&
+            width > 0 && width <= kMaxWidth &&
+            !coverInfo.imageDigest().isEmpty();
+}
+
+// static
+QImage CoverArtThumbnailStore::load(
+        const CoverInfo& coverInfo,
+        int width,
+        QString* pFilePath,
+        bool* pOutdated) {
+    if (pOutdated) {
+        *pOutdated = false;
+    }
+    if (!isStorable(coverInfo, width)) {
+        return QImage();
+    }
+    const auto cacheKey = coverInfo.cacheKey();
+    const QDir directory(directoryPathForKey(cacheKey));
+    for (const auto& suffix : {kOpaqueFileSuffix, kTransparentFileSuffix}) {
+        const QString filePath = directory.filePath(fileNameForKey(cacheKey, width, suffix));
+        const QFileInfo fileInfo(filePath);
+        if (!fileInfo.exists()) {
+            continue;
+        }
+        // The thumbnail is shared by all tracks with the same image, e.g.
+        // the tracks of an album. It is valid for all originals that have
+        // not been modified after it has been stored. Otherwise the
+        // original is loaded again to detect if the image has changed.
+        const QDateTime sourceLastModified = sourceFileInfo(coverInfo).lastModified();
+        if (!sourceLastModified.isValid() ||
+                sourceLastModified > fileInfo.lastModified()) {
+            if (pOutdated) {
+                *pOutdated = sourceLastModified.isValid();
+            }
+            return QImage();
+        }
+        QImageReader reader(filePath);
+        QImage thumbnail = reader.read();
+        if (thumbnail.isNull() || thumbnail.width() != width) {
+            kLogger.warning()
+                    << "Discarding invalid thumbnail"
+                    << filePath
+                    << reader.errorString();
+            QFile::remove(filePath);
+            return QImage();
+        }
+        if (pFilePath) {
+            *pFilePath = filePath;
+        }
+        return thumbnail;
+    }
+    return QImage();
+}
+
+// static
+bool CoverArtThumbnailStore::save(const CoverInfo& coverInfo, const QImage& thumbnail) {
+    const int width = thumbnail.width();
+    if (thumbnail.isNull() || !isStorable(coverInfo, width)) {
+        return false;
+    }
+    const auto cacheKey = coverInfo.cacheKey();
+    const QString directoryPath = directoryPathForKey(cacheKey);
+    if (!QDir().mkpath(directoryPath)) {
+        kLogger.warning()
+                << "Failed to create directory"
+                << directoryPath;
+        return false;
+    }
+    const QDir directory(directoryPath);
+
+    // The thumbnails of the previous width of the library table column
+    // are not needed anymore
+    const QStringList otherWidths = directory.entryList(
+            QStringList{cacheKeyName(cacheKey) + QStringLiteral("_*")}, QDir::Files);
+    for (const auto& fileName : otherWidths) {
+        directory.remove(fileName);
+    }
+
+    const bool opaque = !thumbnail.hasAlphaChannel();
+    // Other threads might load the same thumbnail concurrently and must
+    // never see a partially written file
+    QSaveFile file(directory.filePath(fileNameForKey(cacheKey,
+            width,
+            opaque ? kOpaqueFileSuffix : kTransparentFileSuffix)));
+    if (!file.open(QIODevice::WriteOnly) ||
+            !thumbnail.save(&file,
+                    opaque ? kOpaqueFormat : kTransparentFormat,
+                    opaque ? kJpegQuality : -1) ||
+            !file.commit()) {
+        kLogger.warning()
+                << "Failed to save thumbnail"
+                << file.fileName()
+                << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// static
+void CoverArtThumbnailStore::prune(qint64 maxStorageSize) {
+    if (s_storageDirectory.isEmpty()) {
+        return;
+    }
+    QFileInfoList fileInfos;
+    qint64 storageSize = 0;
+    const QDir storageDirectory(s_storageDirectory);
+    const QFileInfoList directoryInfos = storageDirectory.entryInfoList(
+            QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const auto& directoryInfo : directoryInfos) {
+        const QFileInfoList directoryFileInfos =
+                QDir(directoryInfo.absoluteFilePath()).entryInfoList(QDir::Files);
+        for (const auto& fileInfo : directoryFileInfos) {
+            storageSize += fileInfo.size();
+        }
+        fileInfos += directoryFileInfos;
+    }
+    if (storageSize <= maxStorageSize) {
+        return;
+    }
+    // Thumbnails of deleted tracks and replaced images are never requested
+    // again. Removes the least recently stored thumbnails first, they
+    // are stored again when needed.
+    std::sort(fileInfos.begin(),
+            fileInfos.end(),
+            [](const QFileInfo& lhs, const QFileInfo& rhs) {
+                return lhs.lastModified() < rhs.lastModified();
+            });
+    int removedCount = 0;
+    for (const auto& fileInfo : std::as_const(fileInfos)) {
+        if (storageSize <= maxStorageSize) {
+            break;
+        }
+        if (QFile::remove(fileInfo.absoluteFilePath())) {
+            storageSize -= fileInfo.size();
+            ++removedCount;
+        }
+    }
+    kLogger.info()
+            << "Removed"
+            << removedCount
+            << "thumbnails";
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+#include "library/coverart.h"
+
+/// A persistent store for the downscaled cover images that are displayed
+/// in the library table.
+///
+/// Decoding the original image, e.g. embedded in the metadata of an audio
+/// file, and scaling it down is expensive. The thumbnails are stored as
+/// small image files that are loaded instead once the QPixmapCache has
+/// evicted a cover.
+///
+/// Thumbnails are keyed by the cache key of the image digest and the
+/// width. Only a single width is kept per image, because the library
+/// table requests all covers with the same width. A thumbnail is only
+/// used if the original has not been modified since it was stored.
+/// All functions are thread-safe.
+class CoverArtThumbnailStore final {
+  public:
+    /// Larger images are not stored, since they are only requested for
+    /// single covers that are not displayed in a list.
+    static constexpr int kMaxWidth = 512;
+
+    /// A few 10000 thumbnails for the default width of the cover column
+    static constexpr qint64 kMaxStorageSize = 256 * 1024 * 1024;
+
+    /// Thumbnails are only stored if a directory has been set. This
+    /// function is not thread-safe and must be called only once upon
+    /// startup of the application.
+    static void setStorageDirectory(const QString& directoryPath);
+    static QString storageDirectory();
+
+    /// Only images with a digest are stored, because the legacy hash
+    /// is too short for identifying an image on disk.
+    static bool isStorable(const CoverInfo& coverInfo, int width);
+
+    /// Returns a null image if no thumbnail is stored or if the original
+    /// is missing. pOutdated is set if the original has been modified
+    /// after the thumbnail was stored and the image might have changed.
+    static QImage load(const CoverInfo& coverInfo,
+            int width,
+            QString* pFilePath = nullptr,
+            bool* pOutdated = nullptr);
+    /// Replaces the thumbnails of other widths for the same image.
+    static bool save(const CoverInfo& coverInfo, const QImage& thumbnail);
+
+    /// Removes the least recently stored thumbnails until the size of the
+    /// stored files does not exceed maxStorageSize. Reads all directory
+    /// entries and should not be called on the GUI thread.
+    static void prune(qint64 maxStorageSize = kMaxStorageSize);
+
+  private:
+    CoverArtThumbnailStore() = delete;
+};
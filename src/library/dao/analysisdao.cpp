@@ -1,6 +1,7 @@
 #include <QSqlQuery>
 #include <QSqlResult>
 #include <QSqlError>
+#include <QUuid>
 #include <QtDebug>
 
 #include "library/dao/analysisdao.h"
@@ -8,6 +9,7 @@
 #include "preferences/waveformsettings.h"
 #include "util/performancetimer.h"
 #include "waveform/waveform.h"
+#include "waveform/waveformblockfile.h"
 
 const QString AnalysisDao::s_analysisTableName = "track_analysis";
 
@@ -84,6 +86,18 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
         int checksum = query->value(dataChecksumColumn).toInt();
         QString dataPath = analysisPath.absoluteFilePath(
             QString::number(info.analysisId));
+        quint16 indexChecksum = 0;
+        if (WaveformBlockFile::probe(dataPath, &indexChecksum)) {
+            // Only the header has been read, the data follows on demand
+            if (checksum != indexChecksum) {
+                qDebug() << "WARNING: Corrupt waveform analysis loaded from"
+                         << dataPath;
+                continue;
+            }
+            info.dataPath = dataPath;
+            analyses.append(info);
+            continue;
+        }
         const QByteArray compressedData = loadDataFromFile(dataPath);
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
         const int file_checksum = qChecksum(
@@ -129,24 +143,44 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
             compressedData.constData(),
             compressedData.length());
 #endif
+    if (!saveAnalysisRecord(info, checksum)) {
+        return false;
+    }
+
+    QString dataPath = getAnalysisStoragePath().absoluteFilePath(
+        QString::number(info->analysisId));
+    if (!saveDataToFile(dataPath, compressedData)) {
+        qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
+        return false;
+    }
+
+    qDebug() << "AnalysisDAO saved analysis" << info->analysisId
+             << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
+                                                  QString::number(compressedData.length()))
+             << "bytes for track"
+             << info->trackId << "in" << time.elapsed().debugMillisWithUnit();
+    return true;
+}
+
+bool AnalysisDao::saveAnalysisRecord(AnalysisInfo* analysis, int checksum) {
     QSqlQuery query(m_database);
-    if (info->analysisId == -1) {
+    if (analysis->analysisId == -1) {
         query.prepare(QString(
             "INSERT INTO %1 (track_id, type, description, version, data_checksum) "
             "VALUES (:trackId,:type,:description,:version,:data_checksum)")
                       .arg(s_analysisTableName));
 
-        query.bindValue(":trackId", info->trackId.toVariant());
-        query.bindValue(":type", info->type);
-        query.bindValue(":description", info->description);
-        query.bindValue(":version", info->version);
+        query.bindValue(":trackId", analysis->trackId.toVariant());
+        query.bindValue(":type", analysis->type);
+        query.bindValue(":description", analysis->description);
+        query.bindValue(":version", analysis->version);
         query.bindValue(":data_checksum", checksum);
 
         if (!query.exec()) {
             LOG_FAILED_QUERY(query) << "couldn't save new analysis";
             return false;
         }
-        info->analysisId = query.lastInsertId().toInt();
+        analysis->analysisId = query.lastInsertId().toInt();
     } else {
         query.prepare(QString(
             "UPDATE %1 SET "
@@ -157,11 +191,11 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
             "data_checksum = :data_checksum "
             "WHERE id = :analysisId").arg(s_analysisTableName));
 
-        query.bindValue(":analysisId", info->analysisId);
-        query.bindValue(":trackId", info->trackId.toVariant());
-        query.bindValue(":type", info->type);
-        query.bindValue(":description", info->description);
-        query.bindValue(":version", info->version);
+        query.bindValue(":analysisId", analysis->analysisId);
+        query.bindValue(":trackId", analysis->trackId.toVariant());
+        query.bindValue(":type", analysis->type);
+        query.bindValue(":description", analysis->description);
+        query.bindValue(":version", analysis->version);
         query.bindValue(":data_checksum", checksum);
 
         if (!query.exec()) {
@@ -169,19 +203,6 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
             return false;
         }
     }
-
-    QString dataPath = getAnalysisStoragePath().absoluteFilePath(
-        QString::number(info->analysisId));
-    if (!saveDataToFile(dataPath, compressedData)) {
-        qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
-        return false;
-    }
-
-    qDebug() << "AnalysisDAO saved analysis" << info->analysisId
-             << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
-                                                  QString::number(compressedData.length()))
-             << "bytes for track"
-             << info->trackId << "in" << time.elapsed().debugMillisWithUnit();
     return true;
 }
 
@@ -332,38 +353,89 @@ void AnalysisDao::saveTrackAnalyses(
         return;
     }
 
-    AnalysisDao::AnalysisInfo analysis;
-    analysis.trackId = trackId;
-    if (pWaveform->getId() != -1) {
-        analysis.analysisId = pWaveform->getId();
-    }
-    analysis.type = AnalysisDao::TYPE_WAVEFORM;
-    analysis.description = pWaveform->getDescription();
-    analysis.version = pWaveform->getVersion();
-    analysis.data = pWaveform->toByteArray();
-    bool success = saveAnalysis(&analysis);
+    bool success = saveWaveform(trackId, AnalysisDao::TYPE_WAVEFORM, *pWaveform);
     if (success) {
         pWaveform->setSaveState(Waveform::SaveState::Saved);
     }
-
     qDebug() << (success ? "Saved" : "Failed to save")
-                 << "waveform analysis for trackId" << trackId
-                 << "analysisId" << analysis.analysisId;
+             << "waveform analysis for trackId" << trackId;
 
-    // Clear analysisId since we are re-using the AnalysisInfo
-    analysis.analysisId = -1;
-    analysis.type = AnalysisDao::TYPE_WAVESUMMARY;
-    analysis.description = pWaveSummary->getDescription();
-    analysis.version = pWaveSummary->getVersion();
-    analysis.data = pWaveSummary->toByteArray();
-
-    success = saveAnalysis(&analysis);
+    success = saveWaveform(trackId, AnalysisDao::TYPE_WAVESUMMARY, *pWaveSummary);
     if (success) {
         pWaveSummary->setSaveState(Waveform::SaveState::Saved);
     }
     qDebug() << (success ? "Saved" : "Failed to save")
-             << "waveform summary analysis for trackId" << trackId
-             << "analysisId" << analysis.analysisId;
+             << "waveform summary analysis for trackId" << trackId;
+}
+
+bool AnalysisDao::saveWaveform(
+        TrackId trackId,
+        AnalysisType type,
+        const Waveform& waveform) {
+    if (!m_database.isOpen() || !trackId.isValid()) {
+        return false;
+    }
+    PerformanceTimer time;
+    time.start();
+
+    // Adopt the file if it has been written while analyzing the track. A
+    // concurrent analysis of the same track might replace the pending file
+    // at any time, so it is moved to a name that is unique to this call
+    // first. Renaming is atomic and only one caller can win.
+    const QString filePath = getAnalysisStoragePath().absoluteFilePath(
+            QStringLiteral("%1-%2-%3.saving")
+                    .arg(trackId.toString(),
+                            QString::number(type),
+                            QUuid::createUuid().toString(QUuid::WithoutBraces)));
+    quint16 checksum = 0;
+    int dataSize = 0;
+    if (!QFile::rename(getPendingWaveformPath(trackId, type), filePath) ||
+            !WaveformBlockFile::probe(filePath, &checksum, &dataSize) ||
+            dataSize != waveform.getDataSize()) {
+        WaveformBlockFileWriter writer;
+        if (!writer.open(filePath, waveform) || !writer.finish(waveform)) {
+            deleteFile(filePath);
+            return false;
+        }
+        checksum = writer.indexChecksum();
+    }
+
+    AnalysisDao::AnalysisInfo analysis;
+    analysis.trackId = trackId;
+    if (waveform.getId() != -1) {
+        analysis.analysisId = waveform.getId();
+    }
+    analysis.type = type;
+    analysis.description = waveform.getDescription();
+    analysis.version = waveform.getVersion();
+    if (!saveAnalysisRecord(&analysis, checksum)) {
+        deleteFile(filePath);
+        return false;
+    }
+
+    const QString dataPath = getAnalysisStoragePath().absoluteFilePath(
+            QString::number(analysis.analysisId));
+    QFile::remove(dataPath);
+    if (!QFile::rename(filePath, dataPath)) {
+        qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
+        deleteFile(filePath);
+        return false;
+    }
+
+    qDebug() << "AnalysisDAO saved waveform analysis" << analysis.analysisId
+             << QFileInfo(dataPath).size()
+             << "bytes for track"
+             << trackId << "in" << time.elapsed().debugMillisWithUnit();
+    return true;
+}
+
+QString AnalysisDao::getPendingWaveformPath(TrackId trackId, AnalysisType type) const {
+    WaveformSettings waveformSettings(m_pConfig);
+    if (!waveformSettings.waveformCachingEnabled() || !trackId.isValid()) {
+        return QString();
+    }
+    return getAnalysisStoragePath().absoluteFilePath(
+            QStringLiteral("%1-%2.pending").arg(trackId.toString(), QString::number(type)));
 }
 
 size_t AnalysisDao::getDiskUsageInBytes(
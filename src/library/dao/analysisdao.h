@@ -30,6 +30,9 @@ class AnalysisDao : public DAO {
         QString description;
         QString version;
         QByteArray data;
+        // Set instead of data for waveforms that are stored in the block
+        // file format, which is read on demand.
+        QString dataPath;
     };
 
     explicit AnalysisDao(UserSettingsPointer pConfig);
@@ -57,7 +60,19 @@ class AnalysisDao : public DAO {
             ConstWaveformPointer pWaveform,
             ConstWaveformPointer pWaveSummary);
 
+    /// Waveforms are stored as a WaveformBlockFile. While a track is
+    /// analyzed the blocks can be written progressively to this file,
+    /// which is then adopted by saveTrackAnalyses(). Returns an empty
+    /// string if waveforms are not cached.
+    ///
+    /// Concurrent analyses of the same track share this path. This is safe,
+    /// because WaveformBlockFileWriter writes to a temporary file that only
+    /// replaces the pending file when it is complete.
+    QString getPendingWaveformPath(TrackId trackId, AnalysisType type) const;
+
   private:
+    bool saveAnalysisRecord(AnalysisInfo* analysis, int checksum);
+    bool saveWaveform(TrackId trackId, AnalysisType type, const Waveform& waveform);
     QDir getAnalysisStoragePath() const;
     QByteArray loadDataFromFile(const QString& fileName) const;
     bool saveDataToFile(const QString& fileName, const QByteArray& data) const;
@@ -496,6 +496,27 @@ void TrackDAO::addTracksPrepare() {
             "WHERE location=:location");
 }
 
+bool TrackDAO::addTracksCommit() {
+    VERIFY_OR_DEBUG_ASSERT(m_pTransaction) {
+        return false;
+    }
+    // Reset pending statements without discarding the prepared queries
+    m_pQueryTrackLocationInsert->finish();
+    m_pQueryTrackLocationSelect->finish();
+    m_pQueryLibraryInsert->finish();
+    m_pQueryLibraryUpdate->finish();
+    m_pQueryLibrarySelect->finish();
+    if (!m_pTransaction->commit()) {
+        qWarning() << "TrackDAO::addTracksCommit: Failed to commit transaction";
+        return false;
+    }
+    m_pTransaction = std::make_unique<SqlTransaction>(m_database);
+
+    emit tracksAdded(m_tracksAddedSet);
+    m_tracksAddedSet.clear();
+    return true;
+}
+
 void TrackDAO::addTracksFinish(bool rollback) {
     if (m_pTransaction) {
         if (rollback) {
@@ -827,7 +848,8 @@ TrackId TrackDAO::addTracksAddTrack(const TrackPointer& pTrack, bool unremove) {
 
 TrackPointer TrackDAO::addTracksAddFile(
         const mixxx::FileAccess& fileAccess,
-        bool unremove) {
+        bool unremove,
+        const ImportedTrackMetadata* pImportedMetadata) {
     // Check that track is a supported extension.
     // TODO(uklotzde): The following check can be skipped if
     // the track is already in the library. A refactoring is
@@ -877,7 +899,8 @@ TrackPointer TrackDAO::addTracksAddFile(
     // from the file.
     SoundSourceProxy(pTrack).updateTrackFromSource(
             SoundSourceProxy::UpdateTrackFromSourceMode::Once,
-            SyncTrackMetadataParams::readFromUserSettings(*m_pConfig));
+            SyncTrackMetadataParams::readFromUserSettings(*m_pConfig),
+            pImportedMetadata);
     if (!pTrack->checkSourceSynchronized()) {
         qWarning() << "TrackDAO::addTracksAddFile:"
                 << "Failed to parse track metadata from file"
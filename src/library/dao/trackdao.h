@@ -20,6 +20,7 @@ class PlaylistDAO;
 class AnalysisDao;
 class CueDAO;
 class LibraryHashDAO;
+struct ImportedTrackMetadata;
 
 namespace mixxx {
 
@@ -153,7 +154,8 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
             bool unremove);
     TrackPointer addTracksAddFile(
             const mixxx::FileAccess& fileAccess,
-            bool unremove);
+            bool unremove,
+            const ImportedTrackMetadata* pImportedMetadata = nullptr);
     TrackPointer addTracksAddFile(
             const QString& filePath,
             bool unremove) {
@@ -161,6 +163,17 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
                 mixxx::FileAccess(mixxx::FileInfo(filePath)),
                 unremove);
     }
+    // Commits all tracks that have been added since addTracksPrepare()
+    // or the last commit and continues with a new transaction.
+    //
+    // This deliberately gives up the atomicity of adding tracks: A
+    // subsequent addTracksFinish(true) only rolls back the tracks that
+    // have been added after the last commit. The committed tracks remain
+    // in the library. Callers must leave the database in a consistent
+    // state at every commit.
+    bool addTracksCommit();
+    // Commits or rolls back the tracks that have been added since
+    // addTracksPrepare() or the last addTracksCommit().
     void addTracksFinish(bool rollback = false);
 
     bool updateTrack(const Track& track) const;
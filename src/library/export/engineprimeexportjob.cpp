@@ -1,8 +1,11 @@
 #include "library/export/engineprimeexportjob.h"
 
+#include <QFuture>
 #include <QHash>
 #include <QMetaMethod>
+#include <QQueue>
 #include <QStringList>
+#include <QtConcurrentRun>
 #include <QtGlobal>
 #include <array>
 #include <chrono>
@@ -11,6 +14,7 @@
 #include <memory>
 #include <stdexcept>
 
+#include "library/export/exportfilecopier.h"
 #include "library/trackcollection.h"
 #include "library/trackset/crate/crate.h"
 #include "track/track.h"
@@ -30,6 +34,10 @@ constexpr int kMaxHotCues = 8;
 
 constexpr uint8_t kDefaultWaveformOpacity = 127;
 
+// The loaded tracks and waveforms that wait for being written into the
+// database are bounded to limit the memory consumption
+constexpr int kMaxPendingTracks = 32;
+
 const QStringList kSupportedFileTypes = {
         "aac",
         "m4a",
@@ -74,7 +82,16 @@ std::optional<djinterop::musical_key> toDjinteropKey(
     return keyMap[key];
 }
 
+/// A track whose music file is copied and whose waveform is converted
+/// concurrently, but whose metadata has not been written yet.
+struct PendingTrack {
+    TrackPointer pTrack;
+    QString relativePath;
+    std::optional<QFuture<std::vector<djinterop::waveform_entry>>> waveform;
+};
+
 QString exportFile(const QSharedPointer<EnginePrimeExportRequest> pRequest,
+        ExportFileCopier* pCopier,
         TrackPointer pTrack) {
     if (!pRequest->engineLibraryDbDir.exists()) {
         const auto msg = QStringLiteral(
@@ -88,19 +105,15 @@ QString exportFile(const QSharedPointer<EnginePrimeExportRequest> pRequest,
         throw std::runtime_error{msg.toStdString()};
     }
 
-    // Copy music files into the Mixxx export dir, if the source file has
-    // been modified (or the destination doesn't exist).  To ensure no
-    // chance of filename clashes, and to keep things simple, we will prefix
-    // the destination files with the DB track identifier.
+    // Copy music files into the Mixxx export dir, unless the destination
+    // is already up to date.  To ensure no chance of filename clashes, and
+    // to keep things simple, we will prefix the destination files with the
+    // DB track identifier.
     mixxx::FileInfo srcFileInfo = pTrack->getFileInfo();
     const auto trackId = pTrack->getId().value();
     QString dstFilename = QString::number(trackId) + " - " + srcFileInfo.fileName();
     QString dstPath = pRequest->musicFilesDir.filePath(dstFilename);
-    if (!QFile::exists(dstPath) ||
-            srcFileInfo.lastModified() > QFileInfo{dstPath}.lastModified()) {
-        const auto srcPath = srcFileInfo.location();
-        QFile::copy(srcPath, dstPath);
-    }
+    pCopier->enqueue(srcFileInfo.location(), dstPath);
 
     return pRequest->engineLibraryDbDir.relativeFilePath(dstPath);
 }
@@ -168,10 +181,25 @@ bool tryGetBeatgrid(BeatsPointer pBeats,
     return true;
 }
 
+std::vector<djinterop::waveform_entry> convertWaveform(
+        const Waveform& waveform, int64_t frameCount, int sampleRate) {
+    int64_t samplesPerEntry = el::required_waveform_samples_per_entry(sampleRate);
+    int64_t externalWaveformSize = (frameCount + samplesPerEntry - 1) / samplesPerEntry;
+    std::vector<djinterop::waveform_entry> externalWaveform;
+    externalWaveform.reserve(externalWaveformSize);
+    for (int64_t i = 0; i < externalWaveformSize; ++i) {
+        int64_t j = waveform.getDataSize() * i / externalWaveformSize;
+        externalWaveform.push_back({{waveform.getLow(j), kDefaultWaveformOpacity},
+                {waveform.getMid(j), kDefaultWaveformOpacity},
+                {waveform.getHigh(j), kDefaultWaveformOpacity}});
+    }
+    return externalWaveform;
+}
+
 void exportMetadata(djinterop::database* pDatabase,
         QHash<TrackId, int64_t>* pMixxxToEnginePrimeTrackIdMap,
         TrackPointer pTrack,
-        const Waveform* pWaveform,
+        std::vector<djinterop::waveform_entry> waveform,
         const QString& relativePath) {
     // Attempt to load the track in the database, using the relative path to
     // the music file.  If it exists already, take a snapshot of the track and
@@ -305,22 +333,8 @@ void exportMetadata(djinterop::database* pDatabase,
     // Write waveform.
     // Note that writing a single waveform will automatically calculate an
     // overview waveform too.
-    if (pWaveform) {
-        int64_t samplesPerEntry =
-                el::required_waveform_samples_per_entry(pTrack->getSampleRate());
-        int64_t externalWaveformSize = (frameCount + samplesPerEntry - 1) / samplesPerEntry;
-        std::vector<djinterop::waveform_entry> externalWaveform;
-        externalWaveform.reserve(externalWaveformSize);
-        for (int64_t i = 0; i < externalWaveformSize; ++i) {
-            int64_t j = pWaveform->getDataSize() * i / externalWaveformSize;
-            externalWaveform.push_back({{pWaveform->getLow(j), kDefaultWaveformOpacity},
-                    {pWaveform->getMid(j), kDefaultWaveformOpacity},
-                    {pWaveform->getHigh(j), kDefaultWaveformOpacity}});
-        }
-        snapshot.waveform = std::move(externalWaveform);
-    } else {
-        qInfo() << "No waveform data found for track" << pTrack->getId()
-                << "(" << pTrack->getFileInfo().fileName() << ")";
+    if (!waveform.empty()) {
+        snapshot.waveform = std::move(waveform);
     }
 
     int externalTrackId;
@@ -336,29 +350,46 @@ void exportMetadata(djinterop::database* pDatabase,
     pMixxxToEnginePrimeTrackIdMap->insert(pTrack->getId(), externalTrackId);
 }
 
-void exportTrack(
+PendingTrack exportTrack(
         const QSharedPointer<EnginePrimeExportRequest> pRequest,
-        djinterop::database* pDatabase,
-        QHash<TrackId, int64_t>* pMixxxToEnginePrimeTrackIdMap,
+        ExportFileCopier* pCopier,
         const TrackPointer pTrack,
-        const Waveform* pWaveform) {
-    // Only export supported file types.
-    if (!kSupportedFileTypes.contains(pTrack->getType())) {
-        qInfo() << "Skipping file" << pTrack->getFileInfo().fileName()
-                << "(id" << pTrack->getId() << ") as its file type"
-                << pTrack->getType() << "is not supported";
-        return;
-    }
+        std::shared_ptr<const Waveform> pWaveform) {
+    PendingTrack pendingTrack;
+    pendingTrack.pTrack = pTrack;
 
     // Copy the file, if required.
-    const auto musicFileRelativePath = exportFile(pRequest, pTrack);
+    pendingTrack.relativePath = exportFile(pRequest, pCopier, pTrack);
 
-    // Export meta-data.
+    // Convert the waveform on the global thread pool, while the next tracks
+    // are loaded.  Only writing the database must happen on this thread.
+    if (pWaveform) {
+        // Frames used interchangeably with "samples" here.
+        const auto frameCount = static_cast<int64_t>(
+                pTrack->getDuration() * pTrack->getSampleRate());
+        const int sampleRate = pTrack->getSampleRate();
+        pendingTrack.waveform = QtConcurrent::run([pWaveform, frameCount, sampleRate] {
+            return convertWaveform(*pWaveform, frameCount, sampleRate);
+        });
+    } else {
+        qInfo() << "No waveform data found for track" << pTrack->getId()
+                << "(" << pTrack->getFileInfo().fileName() << ")";
+    }
+    return pendingTrack;
+}
+
+void exportPendingTrack(djinterop::database* pDatabase,
+        QHash<TrackId, int64_t>* pMixxxToEnginePrimeTrackIdMap,
+        PendingTrack pendingTrack) {
+    std::vector<djinterop::waveform_entry> waveform;
+    if (pendingTrack.waveform) {
+        waveform = pendingTrack.waveform->result();
+    }
     exportMetadata(pDatabase,
             pMixxxToEnginePrimeTrackIdMap,
-            pTrack,
-            pWaveform,
-            musicFileRelativePath);
+            pendingTrack.pTrack,
+            std::move(waveform),
+            pendingTrack.relativePath);
 }
 
 void exportCrate(
@@ -476,6 +507,9 @@ void EnginePrimeExportJob::loadTrack(const TrackRef& trackRef) {
         const auto& waveformAnalysis = waveformAnalyses.first();
         m_pLastLoadedWaveform.reset(
                 WaveformFactory::loadWaveformFromAnalysis(waveformAnalysis));
+        if (m_pLastLoadedWaveform) {
+            m_pLastLoadedWaveform->loadAll();
+        }
     } else {
         m_pLastLoadedWaveform.reset();
     }
@@ -511,9 +545,10 @@ void EnginePrimeExportJob::run() {
             Qt::BlockingQueuedConnection,
             Q_ARG(QSet<CrateId>, m_pRequest->crateIdsToExport));
 
-    // Measure progress as one 'count' for each track, each crate, plus some
-    // additional counts for various other operations.
-    int maxProgress = m_trackRefs.size() + m_crateIds.size() + 2;
+    // Measure progress as one 'count' for each track, one for each copied
+    // music file, each crate, plus some additional counts for various other
+    // operations.
+    int maxProgress = 2 * m_trackRefs.size() + m_crateIds.size() + 2;
     int currProgress = 0;
     emit jobMaximum(maxProgress);
     emit jobProgress(currProgress);
@@ -539,6 +574,52 @@ void EnginePrimeExportJob::run() {
     // We will build up a map from Mixxx track id to EL track id during export.
     QHash<TrackId, int64_t> mixxxToEnginePrimeTrackIdMap;
 
+    // The music files are copied concurrently while the tracks are loaded
+    // and their metadata is written.
+    ExportFileCopier copier;
+    QQueue<PendingTrack> pendingTracks;
+
+    const auto exportNextPendingTrack = [&]() {
+        PendingTrack pendingTrack = pendingTracks.dequeue();
+        const auto trackId = pendingTrack.pTrack->getId();
+        try {
+            exportPendingTrack(pDb.get(),
+                    &mixxxToEnginePrimeTrackIdMap,
+                    std::move(pendingTrack));
+        } catch (std::exception& e) {
+            qWarning() << "Failed to export track" << trackId.value() << ":" << e.what();
+            m_lastErrorMessage = e.what();
+            emit failed(m_lastErrorMessage);
+            return false;
+        }
+
+        ++currProgress;
+        emit jobProgress(currProgress);
+        return true;
+    };
+
+    const auto takeCopyResults = [&](bool wait) {
+        ExportFileCopier::Result result;
+        while (copier.takeResult(&result, wait)) {
+            if (m_cancellationRequested.loadAcquire() != 0) {
+                qInfo() << "Cancelling export";
+                return false;
+            }
+            if (result.status == ExportFileCopier::Status::Failed) {
+                qWarning() << "Failed to copy" << result.sourcePath << "to"
+                           << result.targetPath << ":" << result.errorString;
+                m_lastErrorMessage = result.errorString;
+                emit failed(m_lastErrorMessage);
+                return false;
+            }
+
+            ++currProgress;
+            emit jobProgress(currProgress);
+            emit jobThroughput(copier.megabytesPerSecond(), copier.filesPerSecond());
+        }
+        return true;
+    };
+
     for (const auto& trackRef : qAsConst(m_trackRefs)) {
         // Load each track.
         // Note that loading must happen on the same thread as the track collection
@@ -556,14 +637,25 @@ void EnginePrimeExportJob::run() {
 
         DEBUG_ASSERT(m_pLastLoadedTrack != nullptr);
 
+        // Only export supported file types.
+        if (!kSupportedFileTypes.contains(m_pLastLoadedTrack->getType())) {
+            qInfo() << "Skipping file" << m_pLastLoadedTrack->getFileInfo().fileName()
+                    << "(id" << m_pLastLoadedTrack->getId() << ") as its file type"
+                    << m_pLastLoadedTrack->getType() << "is not supported";
+            m_pLastLoadedTrack.reset();
+            m_pLastLoadedWaveform.reset();
+            currProgress += 2;
+            emit jobProgress(currProgress);
+            continue;
+        }
+
         qInfo() << "Exporting track" << m_pLastLoadedTrack->getId().value()
                 << "at" << m_pLastLoadedTrack->getFileInfo().location() << "...";
         try {
-            exportTrack(m_pRequest,
-                    pDb.get(),
-                    &mixxxToEnginePrimeTrackIdMap,
+            pendingTracks.enqueue(exportTrack(m_pRequest,
+                    &copier,
                     m_pLastLoadedTrack,
-                    m_pLastLoadedWaveform.get());
+                    m_pLastLoadedWaveform));
         } catch (std::exception& e) {
             qWarning() << "Failed to export track"
                        << m_pLastLoadedTrack->getId().value() << ":"
@@ -574,10 +666,28 @@ void EnginePrimeExportJob::run() {
         }
 
         m_pLastLoadedTrack.reset();
+        m_pLastLoadedWaveform.reset();
 
-        ++currProgress;
-        emit jobProgress(currProgress);
+        while (pendingTracks.size() > kMaxPendingTracks) {
+            if (!exportNextPendingTrack()) {
+                return;
+            }
+        }
+        if (!takeCopyResults(false)) {
+            return;
+        }
+    }
+
+    while (!pendingTracks.isEmpty()) {
+        if (!exportNextPendingTrack()) {
+            return;
+        }
+    }
+    if (!takeCopyResults(true)) {
+        return;
     }
+    qInfo() << "Copied music files with" << copier.megabytesPerSecond()
+            << "MB/s and" << copier.filesPerSecond() << "tracks/s";
 
     // We will ensure that there is a special top-level crate representing the
     // root of all Mixxx-exported items.  Mixxx tracks and crates will exist
@@ -41,6 +41,10 @@ class EnginePrimeExportJob : public QThread {
     /// Informs of progress through the job, up to the pre-signalled maximum.
     void jobProgress(int progress);
 
+    /// Informs of the average throughput of the copied music files since
+    /// the start of the job.
+    void jobThroughput(double megabytesPerSecond, double tracksPerSecond);
+
     /// Inform of a completed export job.
     void completed(int numTracksExported, int numCratesExported);
 
@@ -63,7 +67,8 @@ class EnginePrimeExportJob : public QThread {
     QList<TrackRef> m_trackRefs;
     QList<CrateId> m_crateIds;
     TrackPointer m_pLastLoadedTrack;
-    std::unique_ptr<Waveform> m_pLastLoadedWaveform;
+    // Shared with the conversion of the waveform on a thread pool
+    std::shared_ptr<Waveform> m_pLastLoadedWaveform;
     Crate m_lastLoadedCrate;
     QList<TrackId> m_lastLoadedCrateTrackIds;
 
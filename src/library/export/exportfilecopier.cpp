@@ -0,0 +1,208 @@
+#include "library/export/exportfilecopier.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrentRun>
+
+#include "util/assert.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("ExportFileCopier");
+
+constexpr qint64 kChunkSize = 1024 * 1024;
+
+// FAT file systems, which are common on USB sticks, store the modification
+// time with a resolution of 2 seconds
+constexpr qint64 kModificationTimeToleranceMillis = 2000;
+
+bool isSameModificationTime(const QDateTime& source, const QDateTime& target) {
+    return source.isValid() && target.isValid() &&
+            qAbs(source.msecsTo(target)) <= kModificationTimeToleranceMillis;
+}
+
+// Compares the content of both files, which is cheaper than comparing
+// hashes of the content because it stops at the first difference
+bool isSameContent(const QString& sourcePath, const QString& targetPath) {
+    QFile source(sourcePath);
+    QFile target(targetPath);
+    if (!source.open(QIODevice::ReadOnly) || !target.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    while (!source.atEnd()) {
+        const QByteArray sourceChunk = source.read(kChunkSize);
+        if (sourceChunk.isEmpty() || sourceChunk != target.read(kChunkSize)) {
+            return false;
+        }
+    }
+    return target.atEnd();
+}
+
+bool setModificationTime(const QString& filePath, const QDateTime& lastModified) {
+    QFile file(filePath);
+    return file.open(QIODevice::Append) &&
+            file.setFileTime(lastModified, QFileDevice::FileModificationTime);
+}
+
+} // anonymous namespace
+
+ExportFileCopier::ExportFileCopier(int maxConcurrentCopies)
+        : m_canceled(false),
+          m_pendingCount(0),
+          m_bytesWritten(0),
+          m_finishedFiles(0) {
+    DEBUG_ASSERT(maxConcurrentCopies > 0);
+    m_threadPool.setMaxThreadCount(maxConcurrentCopies);
+    m_elapsedTimer.start();
+}
+
+ExportFileCopier::~ExportFileCopier() {
+    cancel();
+    m_threadPool.waitForDone();
+}
+
+void ExportFileCopier::enqueue(const QString& sourcePath, const QString& targetPath) {
+    ++m_pendingCount;
+    QtConcurrent::run(&m_threadPool, [this, sourcePath, targetPath] {
+        addResult(copy(sourcePath, targetPath));
+    });
+}
+
+void ExportFileCopier::addResult(Result result) {
+    const auto locker = lockMutex(&m_resultsMutex);
+    m_results.enqueue(std::move(result));
+    m_resultsAvailable.wakeOne();
+}
+
+bool ExportFileCopier::takeResult(Result* pResult, bool wait) {
+    DEBUG_ASSERT(pResult);
+    if (m_pendingCount <= 0) {
+        return false;
+    }
+    {
+        const auto locker = lockMutex(&m_resultsMutex);
+        while (m_results.isEmpty()) {
+            if (!wait) {
+                return false;
+            }
+            m_resultsAvailable.wait(&m_resultsMutex);
+        }
+        *pResult = m_results.dequeue();
+    }
+    --m_pendingCount;
+    m_bytesWritten += pResult->bytesWritten;
+    if (pResult->status == Status::Copied || pResult->status == Status::Skipped) {
+        ++m_finishedFiles;
+    }
+    return true;
+}
+
+void ExportFileCopier::cancel() {
+    m_canceled.store(true);
+}
+
+double ExportFileCopier::megabytesPerSecond() const {
+    const qint64 elapsedMillis = m_elapsedTimer.elapsed();
+    if (elapsedMillis <= 0) {
+        return 0.0;
+    }
+    return m_bytesWritten / (1000.0 * elapsedMillis);
+}
+
+double ExportFileCopier::filesPerSecond() const {
+    const qint64 elapsedMillis = m_elapsedTimer.elapsed();
+    if (elapsedMillis <= 0) {
+        return 0.0;
+    }
+    return m_finishedFiles * 1000.0 / elapsedMillis;
+}
+
+// static
+bool ExportFileCopier::isUpToDate(const QString& sourcePath, const QString& targetPath) {
+    const QFileInfo sourceInfo(sourcePath);
+    const QFileInfo targetInfo(targetPath);
+    if (!targetInfo.exists() || sourceInfo.size() != targetInfo.size()) {
+        return false;
+    }
+    if (isSameModificationTime(sourceInfo.lastModified(), targetInfo.lastModified())) {
+        return true;
+    }
+    if (!isSameContent(sourcePath, targetPath)) {
+        return false;
+    }
+    if (!setModificationTime(targetPath, sourceInfo.lastModified())) {
+        kLogger.info()
+                << "Failed to adopt the modification time of"
+                << sourcePath
+                << "for"
+                << targetPath;
+    }
+    return true;
+}
+
+ExportFileCopier::Result ExportFileCopier::copy(
+        const QString& sourcePath, const QString& targetPath) const {
+    Result result;
+    result.sourcePath = sourcePath;
+    result.targetPath = targetPath;
+    if (m_canceled.load()) {
+        result.status = Status::Canceled;
+        return result;
+    }
+    if (isUpToDate(sourcePath, targetPath)) {
+        result.status = Status::Skipped;
+        return result;
+    }
+
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        result.errorString = source.errorString();
+        return result;
+    }
+    // An existing target is only replaced if the copy is complete
+    QSaveFile target(targetPath);
+    if (!target.open(QIODevice::WriteOnly)) {
+        result.errorString = target.errorString();
+        return result;
+    }
+    while (!source.atEnd()) {
+        if (m_canceled.load()) {
+            target.cancelWriting();
+            result.status = Status::Canceled;
+            return result;
+        }
+        const QByteArray chunk = source.read(kChunkSize);
+        if (chunk.isEmpty()) {
+            result.errorString = source.errorString();
+            target.cancelWriting();
+            return result;
+        }
+        if (target.write(chunk) != chunk.size()) {
+            result.errorString = target.errorString();
+            target.cancelWriting();
+            return result;
+        }
+        result.bytesWritten += chunk.size();
+    }
+    if (!target.commit()) {
+        result.errorString = target.errorString();
+        return result;
+    }
+
+    // The modification time allows to skip the comparison of the content
+    // when exporting the file again
+    const QDateTime lastModified = QFileInfo(sourcePath).lastModified();
+    if (lastModified.isValid() && !setModificationTime(targetPath, lastModified)) {
+        kLogger.info()
+                << "Failed to adopt the modification time of"
+                << sourcePath
+                << "for"
+                << targetPath;
+    }
+    result.status = Status::Copied;
+    return result;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <atomic>
+
+/// Copies the music files of an export concurrently on a private thread
+/// pool and skips the files that are already up to date at the target,
+/// e.g. when exporting the same tracks to a USB stick again.
+///
+/// The number of concurrent copies is small, because the throughput of
+/// the target device, usually a USB stick or an SD card, is the bottleneck.
+/// Two copies keep both the source and the target device busy while one
+/// copy reads and the other writes. More copies only fragment the writes.
+///
+/// Copies are enqueued and their results are collected by a single thread,
+/// which is the only thread that may call the non-static functions.
+class ExportFileCopier final {
+  public:
+    static constexpr int kMaxConcurrentCopies = 2;
+
+    enum class Status {
+        Copied,
+        /// The target was already up to date
+        Skipped,
+        Failed,
+        /// Aborted or dropped by cancel()
+        Canceled,
+    };
+
+    struct Result {
+        QString sourcePath;
+        QString targetPath;
+        Status status = Status::Failed;
+        qint64 bytesWritten = 0;
+        QString errorString;
+    };
+
+    explicit ExportFileCopier(int maxConcurrentCopies = kMaxConcurrentCopies);
+    /// Cancels and waits for the running copies.
+    ~ExportFileCopier();
+
+    /// An existing target is replaced unless it is up to date.
+    void enqueue(const QString& sourcePath, const QString& targetPath);
+
+    /// The number of enqueued copies whose result has not been taken yet.
+    int pendingCount() const {
+        return m_pendingCount;
+    }
+
+    /// Takes the result of the next finished copy. Blocks until a copy has
+    /// finished if wait is true. Returns false if no copy is pending or if
+    /// none has finished and wait is false.
+    bool takeResult(Result* pResult, bool wait);
+
+    /// Aborts the running copies and finishes the pending copies with
+    /// Status::Canceled.
+    void cancel();
+
+    /// The number of bytes written per second since the construction
+    double megabytesPerSecond() const;
+    /// The number of copied or skipped files per second since the construction
+    double filesPerSecond() const;
+
+    /// Returns true if the target has the same size as the source and
+    /// either the same modification time or the same content. Adopts the
+    /// modification time of the source if only the content is the same,
+    /// so the next export does not need to read both files again.
+    static bool isUpToDate(const QString& sourcePath, const QString& targetPath);
+
+  private:
+    Result copy(const QString& sourcePath, const QString& targetPath) const;
+
+    void addResult(Result result);
+
+    QThreadPool m_threadPool;
+    std::atomic<bool> m_canceled;
+
+    QMutex m_resultsMutex;
+    QWaitCondition m_resultsAvailable;
+    QQueue<Result> m_results;
+
+    int m_pendingCount;
+    qint64 m_bytesWritten;
+    int m_finishedFiles;
+    QElapsedTimer m_elapsedTimer;
+};
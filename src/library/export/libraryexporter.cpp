@@ -80,6 +80,16 @@ void LibraryExporter::beginEnginePrimeExport(
             &EnginePrimeExportJob::jobProgress,
             pProgressDlg,
             &QProgressDialog::setValue);
+    connect(pJobThread,
+            &EnginePrimeExportJob::jobThroughput,
+            pProgressDlg,
+            [pProgressDlg = pProgressDlg.get()](
+                    double megabytesPerSecond, double tracksPerSecond) {
+                pProgressDlg->setLabelText(
+                        tr("Exporting to Engine Prime... (%1 MB/s, %2 tracks/s)")
+                                .arg(QString::number(megabytesPerSecond, 'f', 1),
+                                        QString::number(tracksPerSecond, 'f', 1)));
+            });
     connect(pJobThread, &EnginePrimeExportJob::finished, pProgressDlg, &QObject::deleteLater);
     connect(pProgressDlg,
             &QProgressDialog::canceled,
@@ -28,6 +28,10 @@ TrackExportDlg::TrackExportDlg(QWidget *parent,
             &TrackExportWorker::progress,
             this,
             &TrackExportDlg::slotProgress);
+    connect(m_worker,
+            &TrackExportWorker::throughput,
+            this,
+            &TrackExportDlg::slotThroughput);
     connect(m_worker,
             &TrackExportWorker::askOverwriteMode,
             this,
@@ -54,14 +58,22 @@ void TrackExportDlg::slotProgress(const QString& filename, int progress, int cou
     if (progress == count) {
         statusLabel->setText(tr("Export finished"));
         finish();
-    } else {
+    } else if (m_throughput.isEmpty()) {
         statusLabel->setText(tr("Exporting %1").arg(filename));
+    } else {
+        statusLabel->setText(tr("Exporting %1 (%2)").arg(filename, m_throughput));
     }
     exportProgress->setMinimum(0);
     exportProgress->setMaximum(count);
     exportProgress->setValue(progress);
 }
 
+void TrackExportDlg::slotThroughput(double megabytesPerSecond, double tracksPerSecond) {
+    m_throughput = tr("%1 MB/s, %2 tracks/s")
+                           .arg(QString::number(megabytesPerSecond, 'f', 1),
+                                   QString::number(tracksPerSecond, 'f', 1));
+}
+
 void TrackExportDlg::slotAskOverwriteMode(
         const QString& filename,
         std::promise<TrackExportWorker::OverwriteAnswer>* promise) {
@@ -29,6 +29,7 @@ class TrackExportDlg : public QDialog, public Ui::DlgTrackExport {
 
   public slots:
     void slotProgress(const QString& filename, int progress, int count);
+    void slotThroughput(double megabytesPerSecond, double tracksPerSecond);
     void slotAskOverwriteMode(
             const QString& filename,
             std::promise<TrackExportWorker::OverwriteAnswer>* promise);
@@ -48,4 +49,5 @@ class TrackExportDlg : public QDialog, public Ui::DlgTrackExport {
     UserSettingsPointer m_pConfig;
     TrackPointerList m_tracks;
     TrackExportWorker* m_worker;
+    QString m_throughput;
 };
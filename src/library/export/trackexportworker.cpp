@@ -71,23 +71,39 @@ QMap<QString, mixxx::FileInfo> createCopylist(const TrackPointerList& tracks) {
 void TrackExportWorker::run() {
     int i = 0;
     QMap<QString, mixxx::FileInfo> copy_list = createCopylist(m_tracks);
+    ExportFileCopier copier;
     for (auto it = copy_list.constBegin(); it != copy_list.constEnd(); ++it) {
-        // We emit progress twice per loop, which may seem excessive, but it
-        // guarantees that we emit a sane progress before we start and after
-        // we end.  In between, each filename will get its own visible tick
-        // on the bar, which looks really nice.
+        // We emit progress before looking at each file and after each
+        // finished copy, which may seem excessive, but it guarantees that
+        // we emit a sane progress before we start and after we end.  In
+        // between, each filename will get its own visible tick on the bar,
+        // which looks really nice.
         emit progress(it->fileName(), i, copy_list.size());
-        copyFile(*it, it.key());
+        const bool enqueued = enqueueCopy(&copier, *it, it.key());
+        if (m_bStop.loadAcquire()) {
+            emit canceled();
+            return;
+        }
+        if (!enqueued) {
+            ++i;
+            emit progress(it->fileName(), i, copy_list.size());
+        }
+        takeCopyResults(&copier, false, &i, copy_list.size());
         if (m_bStop.loadAcquire()) {
             emit canceled();
             return;
         }
-        ++i;
-        emit progress(it->fileName(), i, copy_list.size());
     }
+    takeCopyResults(&copier, true, &i, copy_list.size());
+    if (m_bStop.loadAcquire()) {
+        emit canceled();
+        return;
+    }
+    qInfo() << "Export finished with" << copier.megabytesPerSecond() << "MB/s and"
+            << copier.filesPerSecond() << "tracks/s";
 }
 
-void TrackExportWorker::copyFile(
+bool TrackExportWorker::enqueueCopy(ExportFileCopier* pCopier,
         const mixxx::FileInfo& source_fileinfo,
         const QString& dest_filename) {
     QString sourceFilename = source_fileinfo.canonicalLocation();
@@ -95,6 +111,11 @@ void TrackExportWorker::copyFile(
     QFileInfo dest_fileinfo(dest_path);
 
     if (dest_fileinfo.exists()) {
+        // Files that have been exported before are not worth asking about.
+        if (ExportFileCopier::isUpToDate(sourceFilename, dest_path)) {
+            qDebug() << "skipping up to date" << sourceFilename;
+            return false;
+        }
         switch (m_overwriteMode) {
         // Give the user the option to overwrite existing files in the destination.
         case OverwriteMode::ASK:
@@ -102,46 +123,52 @@ void TrackExportWorker::copyFile(
             case OverwriteAnswer::SKIP:
             case OverwriteAnswer::SKIP_ALL:
                 qDebug() << "skipping" << sourceFilename;
-                return;
+                return false;
             case OverwriteAnswer::OVERWRITE:
             case OverwriteAnswer::OVERWRITE_ALL:
                 break;
             case OverwriteAnswer::CANCEL:
                 m_errorMessage = tr("Export process was canceled");
                 stop();
-                return;
+                return false;
             }
             break;
         case OverwriteMode::SKIP_ALL:
             qDebug() << "skipping" << sourceFilename;
-            return;
+            return false;
         case OverwriteMode::OVERWRITE_ALL:;
         }
+        // The copier replaces the existing file once the copy is complete.
+    }
 
-        // Remove the existing file in preparation for overwriting.
-        QFile dest_file(dest_path);
-        qDebug() << "Removing existing file" << dest_path;
-        if (!dest_file.remove()) {
+    qDebug() << "Copying" << sourceFilename << "to" << dest_path;
+    pCopier->enqueue(sourceFilename, dest_path);
+    return true;
+}
+
+void TrackExportWorker::takeCopyResults(
+        ExportFileCopier* pCopier, bool wait, int* pProgress, int count) {
+    ExportFileCopier::Result result;
+    while (pCopier->takeResult(&result, wait)) {
+        switch (result.status) {
+        case ExportFileCopier::Status::Copied:
+        case ExportFileCopier::Status::Skipped:
+            break;
+        case ExportFileCopier::Status::Failed: {
             const QString error_message = tr(
-                    "Error removing file %1: %2. Stopping.").arg(
-                    dest_path, dest_file.errorString());
+                    "Error exporting track %1 to %2: %3. Stopping.").arg(
+                    result.sourcePath, result.targetPath, result.errorString);
             qWarning() << error_message;
             m_errorMessage = error_message;
             stop();
             return;
         }
-    }
-
-    qDebug() << "Copying" << sourceFilename << "to" << dest_path;
-    QFile source_file(sourceFilename);
-    if (!source_file.copy(dest_path)) {
-        const QString error_message = tr(
-                "Error exporting track %1 to %2: %3. Stopping.").arg(
-                sourceFilename, dest_path, source_file.errorString());
-        qWarning() << error_message;
-        m_errorMessage = error_message;
-        stop();
-        return;
+        case ExportFileCopier::Status::Canceled:
+            return;
+        }
+        ++*pProgress;
+        emit progress(QFileInfo(result.sourcePath).fileName(), *pProgress, count);
+        emit throughput(pCopier->megabytesPerSecond(), pCopier->filesPerSecond());
     }
 }
 
@@ -191,6 +218,6 @@ TrackExportWorker::OverwriteAnswer TrackExportWorker::makeOverwriteRequest(
 }
 
 void TrackExportWorker::stop() {
-    // We'll wait for the current file to finish copying, then stop.
+    // The running copies are aborted before the thread stops.
     m_bStop = true;
 }
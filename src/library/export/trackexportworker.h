@@ -6,13 +6,14 @@
 #include <QThread>
 #include <future>
 
+#include "library/export/exportfilecopier.h"
 #include "track/track_decl.h"
 #include "util/fileinfo.h"
 
 // A QThread class for copying a list of files to a single destination directory.
-// Currently does not preserve subdirectory relationships.  This class performs
-// all copies in a blocking style within its own thread.  May be canceled from
-// another thread.
+// Currently does not preserve subdirectory relationships.  This class decides
+// about existing files in a blocking style within its own thread and copies
+// the files concurrently.  May be canceled from another thread.
 class TrackExportWorker : public QThread {
     Q_OBJECT
   public:
@@ -62,17 +63,24 @@ class TrackExportWorker : public QThread {
             const QString& filename,
             std::promise<TrackExportWorker::OverwriteAnswer>* promise);
     void progress(const QString& filename, int progress, int count);
+    // Averages since the start of the export.
+    void throughput(double megabytesPerSecond, double tracksPerSecond);
     void canceled();
 
   private:
-    // Copies the file at source_fileinfo to the destination directory with the
-    // name given by dest_filename (not a full path).  If the destination file
-    // exists, will emit an overwrite request signal to ask how to proceed.
-    // On unrecoverable error, sets the error message and stops the export
-    // process entirely.
-    void copyFile(const mixxx::FileInfo& source_fileinfo,
+    // Enqueues the copy of the file at source_fileinfo to the destination
+    // directory with the name given by dest_filename (not a full path).  If
+    // the destination file exists and differs from the source, will emit an
+    // overwrite request signal to ask how to proceed.  Returns false if the
+    // file is skipped.
+    bool enqueueCopy(ExportFileCopier* pCopier,
+            const mixxx::FileInfo& source_fileinfo,
             const QString& dest_filename);
 
+    // Emits the progress for the finished copies.  On unrecoverable error,
+    // sets the error message and stops the export process entirely.
+    void takeCopyResults(ExportFileCopier* pCopier, bool wait, int* pProgress, int count);
+
     // Emit a signal requesting overwrite mode, and block until we get an
     // answer.  Updates m_overwriteMode appropriately.
     OverwriteAnswer makeOverwriteRequest(const QString& filename);
@@ -0,0 +1,57 @@
+#include "library/externallibraryfingerprint.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+
+#include "util/assert.h"
+
+ExternalLibraryFingerprint::ExternalLibraryFingerprint(const QString& filePath)
+        : m_size(-1) {
+    const QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        return;
+    }
+    m_filePath = fileInfo.absoluteFilePath();
+    m_size = fileInfo.size();
+    m_lastModified = fileInfo.lastModified();
+}
+
+bool ExternalLibraryFingerprint::calculateHash() {
+    VERIFY_OR_DEBUG_ASSERT(isValid()) {
+        return false;
+    }
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file)) {
+        return false;
+    }
+    m_hash = hash.result();
+    return true;
+}
+
+bool ExternalLibraryFingerprint::isUnchangedSince(ExternalLibraryFingerprint* pImported) {
+    DEBUG_ASSERT(pImported);
+    if (!isValid() || !pImported->isValid() ||
+            m_filePath != pImported->m_filePath ||
+            m_size != pImported->m_size) {
+        return false;
+    }
+    DEBUG_ASSERT(!pImported->m_hash.isEmpty());
+    if (m_lastModified == pImported->m_lastModified) {
+        m_hash = pImported->m_hash;
+        return true;
+    }
+    if (m_hash.isEmpty() && !calculateHash()) {
+        return false;
+    }
+    if (m_hash != pImported->m_hash) {
+        return false;
+    }
+    // The file has only been touched
+    pImported->m_lastModified = m_lastModified;
+    return true;
+}
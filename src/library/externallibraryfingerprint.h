@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+/// Identifies the content of the file of an external library, e.g. the
+/// iTunes Music Library.xml, to skip the import of an unchanged file.
+///
+/// Reading the size and the modification time is cheap. The content hash
+/// is only calculated on demand, because it requires to read the whole
+/// file, which is only worthwhile if the modification time has changed but
+/// the file might still be the same, e.g. after the external application
+/// has written an identical file.
+///
+/// Only the iTunes library can be refreshed within a session and uses a
+/// fingerprint. Traktor imports its collection.nml only once per session
+/// and Rekordbox parses the export.pdb of a device only once while it is
+/// mounted, so there is no previous import to compare with.
+class ExternalLibraryFingerprint final {
+  public:
+    /// An invalid fingerprint that never matches
+    ExternalLibraryFingerprint()
+            : m_size(-1) {
+    }
+    explicit ExternalLibraryFingerprint(const QString& filePath);
+
+    bool isValid() const {
+        return !m_filePath.isEmpty() && m_size >= 0;
+    }
+
+    /// Calculates the hash of the file content. Returns false if the file
+    /// cannot be read.
+    bool calculateHash();
+
+    /// Returns true if the file has not changed since the given fingerprint
+    /// of an imported file has been taken, which must have a hash. Calculates
+    /// the hash of this fingerprint if needed.
+    ///
+    /// If only the modification time has changed, it is adopted by the
+    /// imported fingerprint, so the next comparison does not need to
+    /// calculate the hash again.
+    bool isUnchangedSince(ExternalLibraryFingerprint* pImported);
+
+  private:
+    QString m_filePath;
+    qint64 m_size;
+    QDateTime m_lastModified;
+    QByteArray m_hash;
+};
@@ -6,8 +6,10 @@
 #include <QStringListModel>
 #include <QtConcurrentRun>
 #include <QtSql>
+#include <atomic>
 
 #include "library/baseexternallibraryfeature.h"
+#include "library/externallibraryfingerprint.h"
 #include "library/trackcollection.h"
 #include "library/treeitem.h"
 #include "library/treeitemmodel.h"
@@ -40,23 +42,14 @@ class ITunesFeature : public BaseExternalLibraryFeature {
     BaseSqlTableModel* getPlaylistModelForPlaylist(const QString& playlist) override;
     static QString getiTunesMusicPath();
     // returns the invisible rootItem for the sidebar model
-    TreeItem* importLibrary();
-    void guessMusicLibraryMountpoint(QXmlStreamReader& xml);
-    void parseTracks(QXmlStreamReader& xml);
-    void parseTrack(QXmlStreamReader& xml, QSqlQuery& query);
-    TreeItem* parsePlaylists(QXmlStreamReader &xml);
-    void parsePlaylist(QXmlStreamReader& xml, QSqlQuery& query1,
-                       QSqlQuery &query2, TreeItem*);
-    void clearTable(const QString& table_name);
-    bool readNextStartElement(QXmlStreamReader& xml);
+    TreeItem* importLibrary(const QString& file);
 
     BaseExternalTrackModel* m_pITunesTrackModel;
     BaseExternalPlaylistModel* m_pITunesPlaylistModel;
     parented_ptr<TreeItemModel> m_pSidebarModel;
-    QStringList m_playlists;
     // a new DB connection for the worker thread
     QSqlDatabase m_database;
-    bool m_cancelImport;
+    std::atomic<bool> m_cancelImport;
     bool m_isActivated;
     QString m_dbfile;
 
@@ -64,8 +57,12 @@ class ITunesFeature : public BaseExternalLibraryFeature {
     QFuture<TreeItem*> m_future;
     QString m_title;
 
-    QString m_dbItunesRoot;
-    QString m_mixxxItunesRoot;
+    // Only accessed by the worker thread while an import is running
+    ExternalLibraryFingerprint m_importedFingerprint;
+    QStringList m_importedPlaylists;
+    // Set by the worker thread if the file has not changed since the
+    // previous import, i.e. the tables have not been modified
+    bool m_importSkipped;
 
     QSharedPointer<BaseTrackCache> m_trackSource;
     QPointer<WLibrarySidebar> m_pSidebarWidget;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QXmlStreamReader>
+#include <atomic>
+
+class SqlBatchInsert;
+
+/// Imports the tracks and playlists of an iTunes Music Library.xml into
+/// the itunes_library, itunes_playlists and itunes_playlist_tracks tables.
+///
+/// The file is parsed in a single pass and the rows are inserted in batches.
+/// The previous content of the tables is replaced within a single
+/// transaction, i.e. it remains visible until the import has finished.
+/// Intended to run on a worker thread with its own database connection.
+class ITunesXmlImporter final {
+  public:
+    ITunesXmlImporter(
+            const QSqlDatabase& database,
+            const QString& filePath,
+            const std::atomic<bool>& cancelImport);
+
+    /// Returns false if the file could not be opened or parsed completely.
+    /// The content of a partially parsed file is imported nevertheless.
+    bool importLibrary();
+
+    /// The names of the imported playlists in the order of the file
+    const QStringList& playlists() const {
+        return m_playlists;
+    }
+
+  private:
+    void guessMusicLibraryMountpoint(QXmlStreamReader& xml);
+    void parseTracks(QXmlStreamReader& xml);
+    void parseTrack(QXmlStreamReader& xml, SqlBatchInsert* pInsert);
+    void parsePlaylists(QXmlStreamReader& xml);
+    void parsePlaylist(QXmlStreamReader& xml,
+            QSqlQuery& query_insert_to_playlists,
+            SqlBatchInsert* pInsertToPlaylistTracks);
+    void clearTable(const QString& table_name);
+    static bool readNextStartElement(QXmlStreamReader& xml);
+
+    QSqlDatabase m_database;
+    const QString m_filePath;
+    const std::atomic<bool>& m_cancelImport;
+
+    QString m_dbItunesRoot;
+    QString m_mixxxItunesRoot;
+    QStringList m_playlists;
+};
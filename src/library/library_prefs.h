@@ -40,6 +40,8 @@ extern const ConfigKey kSyncSeratoMetadataConfigKey;
 
 extern const ConfigKey kUseRelativePathOnExportConfigKey;
 
+extern const ConfigKey kScannerThreadCountConfigKey;
+
 } // namespace prefs
 
 } // namespace library
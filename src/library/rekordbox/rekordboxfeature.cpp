@@ -26,6 +26,7 @@
 #include "util/color/color.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/db/dbconnectionpooler.h"
+#include "util/db/sqlbatchinsert.h"
 #include "util/sandbox.h"
 #include "waveform/waveform.h"
 #include "widget/wlibrary.h"
@@ -342,10 +343,11 @@ mixxx::RgbColor colorFromID(int colorID) {
 }
 
 void insertTrack(
-        QSqlDatabase& database,
         rekordbox_pdb_t::track_row_t* track,
         QSqlQuery& query,
-        QSqlQuery& queryInsertIntoDevicePlaylistTracks,
+        SqlBatchInsert* pInsertIntoDevicePlaylistTracks,
+        int devicePlaylistID,
+        QHash<uint32_t, int>* pTrackIDs,
         QMap<uint32_t, QString>& artistsMap,
         QMap<uint32_t, QString>& albumsMap,
         QMap<uint32_t, QString>& genresMap,
@@ -389,35 +391,18 @@ void insertTrack(
             mixxx::RgbColor::toQVariant(
                     colorFromID(static_cast<int>(track->color_id()))));
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
-
     int trackID = -1;
-    QSqlQuery finderQuery(database);
-    finderQuery.prepare("select id from " + kRekordboxLibraryTable +
-            " where rb_id=:rb_id and device=:device");
-    finderQuery.bindValue(":rb_id", rbID);
-    finderQuery.bindValue(":device", device);
-
-    if (!finderQuery.exec()) {
-        LOG_FAILED_QUERY(finderQuery)
-                << "rbID:" << rbID;
-    }
-
-    if (finderQuery.next()) {
-        trackID = finderQuery.value(finderQuery.record().indexOf("id")).toInt();
+    if (query.exec()) {
+        // There is no index on rb_id, looking up the inserted track
+        // afterwards would scan the whole table for each track
+        trackID = query.lastInsertId().toInt();
+        pTrackIDs->insert(track->id(), trackID);
+    } else {
+        LOG_FAILED_QUERY(query);
     }
 
     // Insert into device all tracks playlist
-    queryInsertIntoDevicePlaylistTracks.bindValue(":track_id", trackID);
-    queryInsertIntoDevicePlaylistTracks.bindValue(":position", audioFilesCount);
-
-    if (!queryInsertIntoDevicePlaylistTracks.exec()) {
-        LOG_FAILED_QUERY(queryInsertIntoDevicePlaylistTracks)
-                << "trackID:" << trackID
-                << "position:" << audioFilesCount;
-    }
+    pInsertIntoDevicePlaylistTracks->insert({devicePlaylistID, trackID, audioFilesCount});
 }
 
 void buildPlaylistTree(
@@ -428,8 +413,8 @@ void buildPlaylistTree(
         QMap<uint32_t, bool>& playlistIsFolderMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTreeMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTrackMap,
-        const QString& playlistPath,
-        const QString& device);
+        const QHash<uint32_t, int>& trackIDs,
+        const QString& playlistPath);
 
 QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* deviceItem) {
     QString device = deviceItem->getLabel();
@@ -475,13 +460,13 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
     // Create a playlist for all the tracks on a device
     int playlistID = createDevicePlaylist(database, devicePath);
 
-    QSqlQuery queryInsertIntoDevicePlaylistTracks(database);
-    queryInsertIntoDevicePlaylistTracks.prepare(
-            "INSERT INTO " + kRekordboxPlaylistTracksTable +
-            " (playlist_id, track_id, position) "
-            "VALUES (:playlist_id, :track_id, :position)");
-
-    queryInsertIntoDevicePlaylistTracks.bindValue(":playlist_id", playlistID);
+    SqlBatchInsert insertIntoDevicePlaylistTracks(database,
+            kRekordboxPlaylistTracksTable,
+            {QStringLiteral("playlist_id"),
+                    QStringLiteral("track_id"),
+                    QStringLiteral("position")});
+    // The database IDs of the tracks by their Rekordbox ID
+    QHash<uint32_t, int> trackIDs;
 
     mixxx::FileInfo fileInfo(dbPath);
     if (!Sandbox::askForAccess(&fileInfo)) {
@@ -595,12 +580,14 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
                                     } break;
                                     case rekordbox_pdb_t::PAGE_TYPE_TRACKS: {
                                         // Track found, insert into database
-                                        insertTrack(database,
+                                        insertTrack(
                                                 static_cast<rekordbox_pdb_t::
                                                                 track_row_t*>(
                                                         (*rowRef)->body()),
                                                 query,
-                                                queryInsertIntoDevicePlaylistTracks,
+                                                &insertIntoDevicePlaylistTracks,
+                                                playlistID,
+                                                &trackIDs,
                                                 artistsMap,
                                                 albumsMap,
                                                 genresMap,
@@ -649,6 +636,8 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
         }
     }
 
+    insertIntoDevicePlaylistTracks.flush();
+
     if (audioFilesCount > 0 || folderOrPlaylistFound) {
         // If we have found anything, recursively build playlist/folder TreeItem children
         // for the original device TreeItem
@@ -659,8 +648,8 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
                 playlistIsFolderMap,
                 playlistTreeMap,
                 playlistTrackMap,
-                devicePath,
-                device);
+                trackIDs,
+                devicePath);
     }
 
     qDebug() << "Found: " << audioFilesCount << " audio files in Rekordbox device " << device;
@@ -678,8 +667,8 @@ void buildPlaylistTree(
         QMap<uint32_t, bool>& playlistIsFolderMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTreeMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTrackMap,
-        const QString& playlistPath,
-        const QString& device) {
+        const QHash<uint32_t, int>& trackIDs,
+        const QString& playlistPath) {
     for (uint32_t childIndex = 0;
             childIndex < (uint32_t)playlistTreeMap[parentID].size();
             childIndex++) {
@@ -738,23 +727,7 @@ void buildPlaylistTree(
                     trackIndex++) {
                 uint32_t rbTrackID = playlistTrackMap[childID][trackIndex];
 
-                int trackID = -1;
-                QSqlQuery finderQuery(database);
-                finderQuery.prepare("select id from " + kRekordboxLibraryTable +
-                        " where rb_id=:rb_id and device=:device");
-                finderQuery.bindValue(":rb_id", rbTrackID);
-                finderQuery.bindValue(":device", device);
-
-                if (!finderQuery.exec()) {
-                    LOG_FAILED_QUERY(finderQuery)
-                            << "rbTrackID:" << rbTrackID
-                            << "device:" << device;
-                    return;
-                }
-
-                if (finderQuery.next()) {
-                    trackID = finderQuery.value(finderQuery.record().indexOf("id")).toInt();
-                }
+                const int trackID = trackIDs.value(rbTrackID, -1);
 
                 queryInsertIntoPlaylistTracks.bindValue(":playlist_id", playlistID);
                 queryInsertIntoPlaylistTracks.bindValue(":track_id", trackID);
@@ -780,8 +753,8 @@ void buildPlaylistTree(
                     playlistIsFolderMap,
                     playlistTreeMap,
                     playlistTrackMap,
-                    currentPath,
-                    device);
+                    trackIDs,
+                    currentPath);
         }
     }
 }
@@ -1,7 +1,9 @@
 #include "library/scanner/importfilestask.h"
 
+#include "library/coverartutils.h"
 #include "library/scanner/libraryscanner.h"
 #include "moc_importfilestask.cpp"
+#include "sources/soundsourceproxy.h"
 #include "util/timer.h"
 
 ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
@@ -23,6 +25,8 @@ ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
 
 void ImportFilesTask::run() {
     ScopedTimer timer("ImportFilesTask::run");
+    // All files are located in the same directory
+    CoverInfoGuesser coverInfoGuesser;
     for (const QFileInfo& fileInfo: m_filesToImport) {
         // If a flag was raised telling us to cancel the library scan then stop.
         if (m_scannerGlobal->shouldCancel()) {
@@ -50,7 +54,20 @@ void ImportFilesTask::run() {
             }
             qDebug() << "Importing track" << trackLocation;
 
-            emit addNewTrack(trackLocation);
+            // Reading the metadata from the file is the expensive part
+            // when adding a new track. It is done here in parallel by all
+            // worker threads, while the tracks are added to the database
+            // by the scanner thread.
+            if (!m_scannerGlobal->acquirePendingImportedTrack()) {
+                setSuccess(false);
+                return;
+            }
+            auto pImportedMetadata = std::make_shared<const ImportedTrackMetadata>(
+                    SoundSourceProxy::importTrackMetadataForNewTrack(
+                            mixxx::FileAccess(mixxx::FileInfo(fileInfo), m_pToken),
+                            m_scannerGlobal->syncTrackMetadataParams(),
+                            &coverInfoGuesser));
+            emit addNewTrack(trackLocation, std::move(pImportedMetadata));
         }
     }
     // Insert or update the hash in the database.
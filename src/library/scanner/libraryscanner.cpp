@@ -1,6 +1,7 @@
 #include "library/scanner/libraryscanner.h"
 
 #include "library/coverartutils.h"
+#include "library/library_prefs.h"
 #include "library/queryutil.h"
 #include "library/scanner/libraryscannerdlg.h"
 #include "library/scanner/recursivescandirectorytask.h"
@@ -13,14 +14,28 @@
 #include "util/db/dbconnectionpooler.h"
 #include "util/db/fwdsqlquery.h"
 #include "util/logger.h"
+#include "util/math.h"
 #include "util/performancetimer.h"
 #include "util/timer.h"
 #include "util/trace.h"
 
 namespace {
 
-// TODO(rryan) make configurable
-constexpr int kScannerThreadPoolSize = 1;
+// Reading metadata from files is mostly I/O bound. Use a few more
+// threads than cores to hide the latency of network storage.
+constexpr int kMaxDefaultScannerThreadCount = 8;
+
+// Adding a track takes only a few database statements. Committing them in
+// batches keeps the costs for transactions low, while other connections
+// are not blocked from writing during the whole scan.
+//
+// This is deliberate: A scan that fails only rolls back the tracks since
+// the last commit. A SAVEPOINT would not help, because SQLite keeps the
+// database locked until the outermost transaction ends. The committed
+// state is consistent, since the hash of a directory is written after
+// all of its tracks. A directory without a committed hash is scanned
+// again and its committed tracks are verified instead of added.
+constexpr int kAddedTracksPerTransaction = 1000;
 
 mixxx::Logger kLogger("LibraryScanner");
 
@@ -92,6 +107,15 @@ void updateQueryPlannerStatisticsForDatabase(const QSqlDatabase& database) {
     }
 }
 
+int scannerThreadCount(const UserSettings& config) {
+    const int defaultThreadCount = math_clamp(
+            QThread::idealThreadCount() * 2, 1, kMaxDefaultScannerThreadCount);
+    return math_max(1,
+            config.getValue(
+                    mixxx::library::prefs::kScannerThreadCountConfigKey,
+                    defaultThreadCount));
+}
+
 } // anonymous namespace
 
 LibraryScanner::LibraryScanner(
@@ -103,7 +127,12 @@ LibraryScanner::LibraryScanner(
                   m_analysisDao, m_libraryHashDao,
                   pConfig),
           m_stateSema(1), // only one transaction is possible at a time
-          m_state(IDLE) {
+          m_state(IDLE),
+          m_pConfig(pConfig),
+          m_numUncommittedTracks(0) {
+    qRegisterMetaType<std::shared_ptr<const ImportedTrackMetadata>>(
+            "std::shared_ptr<const ImportedTrackMetadata>");
+
     // Move LibraryScanner to its own thread so that our signals/slots will
     // queue to our event loop.
     moveToThread(this);
@@ -112,7 +141,9 @@ LibraryScanner::LibraryScanner(
     const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
     setObjectName(QString("LibraryScanner %1").arg(instanceId));
 
-    m_pool.setMaxThreadCount(kScannerThreadPoolSize);
+    m_pool.setMaxThreadCount(scannerThreadCount(*pConfig));
+    kLogger.info()
+            << "Using" << m_pool.maxThreadCount() << "worker threads";
 
     // Listen to signals from our public methods (invoked by other threads) and
     // connect them to our slots to run the command on the scanner thread.
@@ -207,8 +238,12 @@ void LibraryScanner::slotStartScan() {
     QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
 
     m_scannerGlobal = ScannerGlobalPointer(
-            new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
-                              coverExtensionFilter, directoryBlacklist));
+            new ScannerGlobal(trackLocations,
+                    directoryHashes,
+                    extensionFilter,
+                    coverExtensionFilter,
+                    directoryBlacklist,
+                    SyncTrackMetadataParams::readFromUserSettings(*m_pConfig)));
 
     m_scannerGlobal->startTimer();
 
@@ -230,6 +265,7 @@ void LibraryScanner::slotStartScan() {
     // Start scanning the library. This prepares insertion queries in TrackDAO
     // (must be called before calling addTracksAdd) and begins a transaction.
     m_trackDao.addTracksPrepare();
+    m_numUncommittedTracks = 0;
 
     // First Scan all known directories we have a hash for.
     // In a second stage, we scan all new directories. This guarantees,
@@ -403,7 +439,9 @@ void LibraryScanner::slotFinishUnhashedScan() {
     }
 
     // Finish adding the tracks -- rollback the transaction if the scan did not
-    // finish cleanly and the user did not cancel the transaction.
+    // finish cleanly and the user did not cancel the transaction. Only the
+    // tracks since the last batch are rolled back, see
+    // kAddedTracksPerTransaction.
     m_trackDao.addTracksFinish(!m_scannerGlobal->shouldCancel() &&
                                !bScanFinishedCleanly);
 
@@ -566,13 +604,23 @@ void LibraryScanner::slotTrackExists(const QString& trackPath) {
     }
 }
 
-void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
+void LibraryScanner::slotAddNewTrack(const QString& trackPath,
+        std::shared_ptr<const ImportedTrackMetadata> pImportedMetadata) {
     //kLogger.debug() << "slotAddNewTrack" << trackPath;
     ScopedTimer timer("LibraryScanner::addNewTrack");
     // For statistics tracking and to detect moved tracks
     TrackPointer pTrack = m_trackDao.addTracksAddFile(
-            trackPath,
-            false);
+            mixxx::FileAccess(mixxx::FileInfo(trackPath)),
+            false,
+            pImportedMetadata.get());
+    if (m_scannerGlobal) {
+        // Let the worker threads continue
+        m_scannerGlobal->releasePendingImportedTrack();
+    }
+    if (++m_numUncommittedTracks >= kAddedTracksPerTransaction) {
+        m_trackDao.addTracksCommit();
+        m_numUncommittedTracks = 0;
+    }
     if (pTrack) {
         DEBUG_ASSERT(!pTrack->isDirty());
         // The track's actual location might differ from the
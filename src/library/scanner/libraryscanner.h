@@ -8,6 +8,7 @@
 #include <QString>
 #include <QThread>
 #include <QThreadPool>
+#include <memory>
 
 #include "library/dao/analysisdao.h"
 #include "library/dao/cuedao.h"
@@ -70,7 +71,8 @@ class LibraryScanner : public QThread {
                                    bool newDirectory, mixxx::cache_key_t hash);
     void slotDirectoryUnchanged(const QString& directoryPath);
     void slotTrackExists(const QString& trackPath);
-    void slotAddNewTrack(const QString& trackPath);
+    void slotAddNewTrack(const QString& trackPath,
+            std::shared_ptr<const ImportedTrackMetadata> pImportedMetadata);
 
   private:
     enum ScannerState {
@@ -119,6 +121,12 @@ class LibraryScanner : public QThread {
     // this is accessed main and LibraryScanner thread
     volatile ScannerState m_state;
 
+    const UserSettingsPointer m_pConfig;
+
+    // The number of tracks that have been added since the
+    // last commit of the current transaction.
+    int m_numUncommittedTracks;
+
     QList<mixxx::FileInfo> m_libraryRootDirs;
     QScopedPointer<LibraryScannerDlg> m_pProgressDlg;
 };
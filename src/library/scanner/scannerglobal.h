@@ -4,10 +4,12 @@
 #include <QHash>
 #include <QMutex>
 #include <QRegularExpression>
+#include <QSemaphore>
 #include <QSet>
 #include <QSharedPointer>
 #include <QStringList>
 
+#include "track/track_decl.h"
 #include "util/cache.h"
 #include "util/compatibility/qmutex.h"
 #include "util/fileaccess.h"
@@ -16,16 +18,24 @@
 
 class ScannerGlobal {
   public:
+    // The maximum number of tracks that have been imported by the worker
+    // threads and not yet been added to the database. Limits the memory
+    // consumption if the database is slower than reading the files.
+    static constexpr int kMaxPendingImportedTracks = 256;
+
     ScannerGlobal(const QSet<QString>& trackLocations,
             const QHash<QString, mixxx::cache_key_t>& directoryHashes,
             const QRegularExpression& supportedExtensionsMatcher,
             const QRegularExpression& supportedCoverExtensionsMatcher,
-            const QStringList& directoriesBlacklist)
+            const QStringList& directoriesBlacklist,
+            const SyncTrackMetadataParams& syncTrackMetadataParams)
             : m_trackLocations(trackLocations),
               m_directoryHashes(directoryHashes),
               m_supportedExtensionsMatcher(supportedExtensionsMatcher),
               m_supportedCoverExtensionsMatcher(supportedCoverExtensionsMatcher),
               m_directoriesBlacklist(directoriesBlacklist),
+              m_syncTrackMetadataParams(syncTrackMetadataParams),
+              m_pendingImportedTracks(kMaxPendingImportedTracks),
               // Unless marked un-clean, we assume it will finish cleanly.
               m_scanFinishedCleanly(true),
               m_shouldCancel(false),
@@ -94,6 +104,28 @@ class ScannerGlobal {
         return match.hasMatch();
     }
 
+    const SyncTrackMetadataParams& syncTrackMetadataParams() const {
+        return m_syncTrackMetadataParams;
+    }
+
+    // Called by the worker threads before importing a new track. Blocks
+    // while too many imported tracks are waiting to be added to the
+    // database. Returns false if the scan has been cancelled while waiting.
+    bool acquirePendingImportedTrack() {
+        while (!m_pendingImportedTracks.tryAcquire(1, kPendingImportedTrackPollMillis)) {
+            if (shouldCancel()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Called by the scanner thread after an imported track has been
+    // added to the database.
+    void releasePendingImportedTrack() {
+        m_pendingImportedTracks.release();
+    }
+
     bool shouldCancel() const {
         return m_shouldCancel;
     }
@@ -182,6 +214,14 @@ class ScannerGlobal {
     // this has never been investigated.
     QStringList m_directoriesBlacklist;
 
+    const SyncTrackMetadataParams m_syncTrackMetadataParams;
+
+    // The worker threads must not wait for the scanner thread
+    // indefinitely, because the scanner thread waits for the
+    // worker threads when cancelling the scan.
+    static constexpr int kPendingImportedTrackPollMillis = 100;
+    QSemaphore m_pendingImportedTracks;
+
     // The list of directories verified by the scan.
     QStringList m_verifiedDirectories;
 
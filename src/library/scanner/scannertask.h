@@ -2,10 +2,12 @@
 
 #include <QObject>
 #include <QRunnable>
+#include <memory>
 
 #include "library/scanner/scannerglobal.h"
 
 class LibraryScanner;
+struct ImportedTrackMetadata;
 
 class ScannerTask : public QObject, public QRunnable {
     Q_OBJECT
@@ -23,7 +25,8 @@ class ScannerTask : public QObject, public QRunnable {
                                    bool newDirectory, mixxx::cache_key_t hash);
     void directoryUnchanged(const QString& directoryPath);
     void trackExists(const QString& filePath);
-    void addNewTrack(const QString& filePath);
+    void addNewTrack(const QString& filePath,
+            std::shared_ptr<const ImportedTrackMetadata> pImportedMetadata);
 
     // Feedback to GUI
     void progressLoading(const QString& fileName);
@@ -3,6 +3,7 @@
 #include <QRegularExpression>
 
 #include "track/keyutils.h"
+#include "util/db/sqllikewildcards.h"
 
 constexpr char kNegatePrefix[] = "-";
 constexpr char kFuzzyPrefix[] = "~";
@@ -277,6 +278,31 @@ std::unique_ptr<QueryNode> SearchQueryParser::parseQuery(const QString& query,
     return pQuery;
 }
 
+bool SearchQueryParser::splitIntoPlainTerms(
+        const QString& query, QStringList* pTerms) const {
+    pTerms->clear();
+    // Split the same way as parseQuery()
+    const QStringList tokens = query.split(" ");
+    for (const auto& untrimmedToken : tokens) {
+        const QString token = untrimmedToken.trimmed();
+        if (token.isEmpty()) {
+            continue;
+        }
+        if (token.startsWith(kNegatePrefix) ||
+                token.startsWith(QChar('"')) ||
+                token.contains(kSqlLikeMatchAll) ||
+                token.contains(kSqlLikeMatchOne) ||
+                m_fuzzyMatcher.match(token).hasMatch() ||
+                m_textFilterMatcher.match(token).hasMatch() ||
+                m_numericFilterMatcher.match(token).hasMatch() ||
+                m_specialFilterMatcher.match(token).hasMatch()) {
+            return false;
+        }
+        pTerms->append(token);
+    }
+    return true;
+}
+
 QStringList SearchQueryParser::splitQueryIntoWords(const QString& query) {
     QStringList queryWordList = query.split(kSplitIntoWordsRegexp,
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
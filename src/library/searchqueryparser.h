@@ -19,6 +19,12 @@ class SearchQueryParser {
             const QStringList& searchColumns,
             const QString& extraFilter) const;
 
+    /// Splits a query that only consists of plain search terms, i.e. terms
+    /// that are matched against all search columns and the crate names.
+    /// Returns false if the query uses filters, negation, quotes or
+    /// LIKE wildcards.
+    bool splitIntoPlainTerms(const QString& query, QStringList* pTerms) const;
+
     /// splits the query into a list of terms
     static QStringList splitQueryIntoWords(const QString& query);
     /// checks if the changed search query is less specific then the original term
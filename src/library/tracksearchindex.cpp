@@ -0,0 +1,369 @@
+#include "library/tracksearchindex.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "util/assert.h"
+#include "util/db/dbconnection.h"
+
+namespace {
+
+// Rows are checked one by one instead of matching the dictionaries if
+// there are fewer candidates, e.g. when refining a previous search.
+constexpr int kCandidateRowsFraction = 8;
+
+// Intersecting more posting lists than this rarely removes candidates
+// that survive the verification.
+constexpr std::size_t kMaxIntersectedPostings = 4;
+
+std::string foldValue(const QString& value) {
+    QString folded = value;
+    mixxx::DbConnection::makeStringLatinLow(&folded);
+    return folded.toStdString();
+}
+
+void collectTrigrams(std::string_view text, std::vector<std::uint32_t>* pTrigrams) {
+    pTrigrams->clear();
+    if (text.size() < 3) {
+        return;
+    }
+    for (std::size_t i = 0; i + 2 < text.size(); ++i) {
+        pTrigrams->push_back(
+                (static_cast<std::uint32_t>(static_cast<std::uint8_t>(text[i])) << 16) |
+                (static_cast<std::uint32_t>(static_cast<std::uint8_t>(text[i + 1])) << 8) |
+                static_cast<std::uint32_t>(static_cast<std::uint8_t>(text[i + 2])));
+    }
+    std::sort(pTrigrams->begin(), pTrigrams->end());
+    pTrigrams->erase(std::unique(pTrigrams->begin(), pTrigrams->end()), pTrigrams->end());
+}
+
+bool contains(std::string_view value, std::string_view needle) {
+    return value.find(needle) != std::string_view::npos;
+}
+
+} // anonymous namespace
+
+void TrackSearchIndex::Postings::append(std::uint32_t valueId) {
+    DEBUG_ASSERT(m_size == 0 || valueId > m_lastValueId);
+    // LEB128 encoded delta to the previous value id
+    std::uint32_t delta = valueId - m_lastValueId;
+    while (delta >= 0x80) {
+        m_bytes.push_back(static_cast<std::uint8_t>(delta | 0x80));
+        delta >>= 7;
+    }
+    m_bytes.push_back(static_cast<std::uint8_t>(delta));
+    m_lastValueId = valueId;
+    ++m_size;
+}
+
+void TrackSearchIndex::Postings::decode(std::vector<std::uint32_t>* pValueIds) const {
+    pValueIds->clear();
+    pValueIds->reserve(m_size);
+    std::uint32_t valueId = 0;
+    std::uint32_t delta = 0;
+    int shift = 0;
+    for (const std::uint8_t byte : m_bytes) {
+        delta |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+        if (byte & 0x80) {
+            shift += 7;
+            continue;
+        }
+        valueId += delta;
+        pValueIds->push_back(valueId);
+        delta = 0;
+        shift = 0;
+    }
+}
+
+void TrackSearchIndex::Postings::intersect(std::vector<std::uint32_t>* pValueIds) const {
+    auto out = pValueIds->begin();
+    auto in = pValueIds->cbegin();
+    std::uint32_t valueId = 0;
+    std::uint32_t delta = 0;
+    int shift = 0;
+    for (auto byte = m_bytes.cbegin(); byte != m_bytes.cend() && in != pValueIds->cend();
+            ++byte) {
+        delta |= static_cast<std::uint32_t>(*byte & 0x7F) << shift;
+        if (*byte & 0x80) {
+            shift += 7;
+            continue;
+        }
+        valueId += delta;
+        delta = 0;
+        shift = 0;
+        while (in != pValueIds->cend() && *in < valueId) {
+            ++in;
+        }
+        if (in != pValueIds->cend() && *in == valueId) {
+            *out++ = valueId;
+            ++in;
+        }
+    }
+    pValueIds->erase(out, pValueIds->end());
+}
+
+std::size_t TrackSearchIndex::Dictionary::ValueHash::operator()(std::uint32_t valueId) const {
+    return std::hash<std::string_view>()(m_pDictionary->value(valueId));
+}
+
+bool TrackSearchIndex::Dictionary::ValueEqual::operator()(
+        std::uint32_t lhs, std::uint32_t rhs) const {
+    return m_pDictionary->value(lhs) == m_pDictionary->value(rhs);
+}
+
+TrackSearchIndex::Dictionary::Dictionary()
+        : m_offsets{0},
+          m_valueIds(0, ValueHash(this), ValueEqual(this)) {
+}
+
+std::uint32_t TrackSearchIndex::Dictionary::intern(std::string_view value) {
+    // Append the value tentatively, the hash set can only look up
+    // values by their id
+    const auto valueId = static_cast<std::uint32_t>(size());
+    m_text.append(value);
+    m_text.push_back('\0');
+    m_offsets.push_back(static_cast<std::uint32_t>(m_text.size()));
+    const auto [it, inserted] = m_valueIds.insert(valueId);
+    if (!inserted) {
+        m_offsets.pop_back();
+        m_text.resize(m_offsets.back());
+        return *it;
+    }
+
+    std::vector<std::uint32_t> trigrams;
+    collectTrigrams(value, &trigrams);
+    for (const auto trigram : trigrams) {
+        m_trigrams[trigram].append(valueId);
+    }
+    return valueId;
+}
+
+void TrackSearchIndex::Dictionary::match(
+        std::string_view needle, std::vector<bool>* pMatches) const {
+    pMatches->assign(size(), false);
+    std::vector<std::uint32_t> trigrams;
+    collectTrigrams(needle, &trigrams);
+    if (trigrams.empty()) {
+        scan(needle, pMatches);
+        return;
+    }
+
+    std::vector<const Postings*> postings;
+    postings.reserve(trigrams.size());
+    for (const auto trigram : trigrams) {
+        const auto it = m_trigrams.find(trigram);
+        if (it == m_trigrams.end()) {
+            // No value contains all trigrams
+            return;
+        }
+        postings.push_back(&it->second);
+    }
+    std::sort(postings.begin(), postings.end(), [](const Postings* lhs, const Postings* rhs) {
+        return lhs->size() < rhs->size();
+    });
+
+    std::vector<std::uint32_t> candidates;
+    postings.front()->decode(&candidates);
+    for (std::size_t i = 1;
+            i < std::min(postings.size(), kMaxIntersectedPostings) && !candidates.empty();
+            ++i) {
+        postings[i]->intersect(&candidates);
+    }
+    // The trigrams might not be adjacent in the value
+    for (const auto valueId : candidates) {
+        if (contains(value(valueId), needle)) {
+            (*pMatches)[valueId] = true;
+        }
+    }
+}
+
+void TrackSearchIndex::Dictionary::scan(
+        std::string_view needle, std::vector<bool>* pMatches) const {
+    const std::string_view text(m_text);
+    std::size_t pos = text.find(needle);
+    while (pos != std::string_view::npos) {
+        const auto next = std::upper_bound(m_offsets.cbegin(), m_offsets.cend(), pos);
+        const auto valueId = static_cast<std::size_t>(next - m_offsets.cbegin()) - 1;
+        (*pMatches)[valueId] = true;
+        // Continue with the next value
+        pos = text.find(needle, *next);
+    }
+}
+
+TrackSearchIndex::TrackSearchIndex()
+        : m_generation(0) {
+}
+
+void TrackSearchIndex::reset(const QVector<ColumnType>& columnTypes) {
+    m_columnTypes = columnTypes;
+    m_columns.clear();
+    m_columns.reserve(columnTypes.size());
+    for (const auto type : columnTypes) {
+        m_columns.push_back(std::make_unique<Column>(type));
+    }
+    m_rowTrackIds.clear();
+    m_rowsByTrackId.clear();
+    ++m_generation;
+}
+
+void TrackSearchIndex::updateTrack(TrackId trackId, const QStringList& values) {
+    VERIFY_OR_DEBUG_ASSERT(values.size() == columnCount()) {
+        return;
+    }
+    auto it = m_rowsByTrackId.find(trackId);
+    if (it == m_rowsByTrackId.end()) {
+        it = m_rowsByTrackId.insert(trackId, rowCount());
+        m_rowTrackIds.push_back(trackId);
+        for (const auto& pColumn : m_columns) {
+            pColumn->rowValues.push_back(kNoValue);
+            if (pColumn->type == ColumnType::Path) {
+                pColumn->rowFileNames.push_back(kNoValue);
+            }
+        }
+    }
+    const int row = it.value();
+
+    for (int i = 0; i < columnCount(); ++i) {
+        Column* pColumn = m_columns[i].get();
+        const std::string value = foldValue(values[i]);
+        std::string_view directory;
+        std::string_view fileName;
+        if (pColumn->type == ColumnType::Path) {
+            const auto separator = value.rfind('/');
+            if (separator == std::string::npos) {
+                fileName = value;
+            } else {
+                directory = std::string_view(value).substr(0, separator);
+                fileName = std::string_view(value).substr(separator + 1);
+            }
+        } else {
+            directory = value;
+        }
+        // Empty values never match, neither do they in SQL
+        pColumn->rowValues[row] = directory.empty()
+                ? kNoValue
+                : pColumn->values.intern(directory);
+        if (pColumn->type == ColumnType::Path) {
+            pColumn->rowFileNames[row] = fileName.empty()
+                    ? kNoValue
+                    : pColumn->fileNames.intern(fileName);
+        }
+    }
+    ++m_generation;
+}
+
+void TrackSearchIndex::removeTrack(TrackId trackId) {
+    const auto it = m_rowsByTrackId.find(trackId);
+    if (it == m_rowsByTrackId.end()) {
+        return;
+    }
+    const int row = it.value();
+    m_rowsByTrackId.erase(it);
+    m_rowTrackIds[row] = TrackId();
+    for (const auto& pColumn : m_columns) {
+        pColumn->rowValues[row] = kNoValue;
+        if (pColumn->type == ColumnType::Path) {
+            pColumn->rowFileNames[row] = kNoValue;
+        }
+    }
+    ++m_generation;
+}
+
+bool TrackSearchIndex::rowMatches(
+        const Column& column, int row, std::string_view needle) const {
+    const std::uint32_t valueId = column.rowValues[row];
+    if (valueId != kNoValue && contains(column.values.value(valueId), needle)) {
+        return true;
+    }
+    if (column.type != ColumnType::Path) {
+        return false;
+    }
+    const std::uint32_t fileNameId = column.rowFileNames[row];
+    if (fileNameId != kNoValue && contains(column.fileNames.value(fileNameId), needle)) {
+        return true;
+    }
+    if (valueId == kNoValue || fileNameId == kNoValue ||
+            needle.find('/') == std::string_view::npos) {
+        return false;
+    }
+    // The needle might span the directory and the file name
+    std::string path(column.values.value(valueId));
+    path.push_back('/');
+    path.append(column.fileNames.value(fileNameId));
+    return contains(path, needle);
+}
+
+void TrackSearchIndex::matchColumn(const Column& column,
+        std::string_view needle,
+        const std::vector<int>* pCandidateRows,
+        std::vector<bool>* pMatchingRows) const {
+    if ((pCandidateRows &&
+                static_cast<int>(pCandidateRows->size()) <
+                        rowCount() / kCandidateRowsFraction) ||
+            (column.type == ColumnType::Path &&
+                    needle.find('/') != std::string_view::npos)) {
+        const auto checkRow = [&](int row) {
+            if (!(*pMatchingRows)[row] && rowMatches(column, row, needle)) {
+                (*pMatchingRows)[row] = true;
+            }
+        };
+        if (pCandidateRows) {
+            std::for_each(pCandidateRows->cbegin(), pCandidateRows->cend(), checkRow);
+        } else {
+            for (int row = 0; row < rowCount(); ++row) {
+                checkRow(row);
+            }
+        }
+        return;
+    }
+
+    std::vector<bool> matchingValues;
+    column.values.match(needle, &matchingValues);
+    std::vector<bool> matchingFileNames;
+    if (column.type == ColumnType::Path) {
+        column.fileNames.match(needle, &matchingFileNames);
+    }
+    const auto checkRow = [&](int row) {
+        const std::uint32_t valueId = column.rowValues[row];
+        if (valueId != kNoValue && matchingValues[valueId]) {
+            (*pMatchingRows)[row] = true;
+            return;
+        }
+        if (column.type == ColumnType::Path) {
+            const std::uint32_t fileNameId = column.rowFileNames[row];
+            if (fileNameId != kNoValue && matchingFileNames[fileNameId]) {
+                (*pMatchingRows)[row] = true;
+            }
+        }
+    };
+    if (pCandidateRows) {
+        std::for_each(pCandidateRows->cbegin(), pCandidateRows->cend(), checkRow);
+    } else {
+        for (int row = 0; row < rowCount(); ++row) {
+            checkRow(row);
+        }
+    }
+}
+
+std::vector<int> TrackSearchIndex::matchTerm(
+        const QString& term,
+        const std::vector<int>* pCandidateRows) const {
+    DEBUG_ASSERT(!pCandidateRows ||
+            std::is_sorted(pCandidateRows->cbegin(), pCandidateRows->cend()));
+    const std::string needle = foldValue(term);
+    std::vector<int> rows;
+    VERIFY_OR_DEBUG_ASSERT(!needle.empty() && needle.find('\0') == std::string::npos) {
+        return rows;
+    }
+
+    std::vector<bool> matchingRows(rowCount(), false);
+    for (const auto& pColumn : m_columns) {
+        matchColumn(*pColumn, needle, pCandidateRows, &matchingRows);
+    }
+    for (int row = 0; row < rowCount(); ++row) {
+        if (matchingRows[row]) {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "track/trackid.h"
+#include "util/class.h"
+
+/// In-memory substring index over the searchable text columns of a track
+/// table, used by BaseTrackCache to answer free-text searches without
+/// evaluating LIKE on every column of every row in SQL.
+///
+/// The values are stored column-wise. Each column keeps a dictionary of its
+/// distinct values, folded like the LIKE function of our database connection
+/// (see DbConnection::makeStringLatinLow()), and each row only refers to the
+/// dictionary entries. A trigram index over the dictionary entries narrows
+/// down the candidates for terms with at least 3 bytes, shorter terms scan
+/// the dictionary. Paths are split into directory and file name, because
+/// most tracks share the directory with other tracks.
+///
+/// Rows are never reused. Removed tracks leave an empty row behind until
+/// the index is reset.
+class TrackSearchIndex {
+  public:
+    enum class ColumnType {
+        Text,
+        /// A path with '/' as separator
+        Path,
+    };
+
+    TrackSearchIndex();
+
+    /// Removes all tracks and sets the types of the indexed columns.
+    void reset(const QVector<ColumnType>& columnTypes);
+
+    int columnCount() const {
+        return m_columnTypes.size();
+    }
+    /// The number of rows, including the rows of removed tracks.
+    int rowCount() const {
+        return static_cast<int>(m_rowTrackIds.size());
+    }
+    int trackCount() const {
+        return m_rowsByTrackId.size();
+    }
+    /// Changes whenever the indexed values change.
+    quint64 generation() const {
+        return m_generation;
+    }
+
+    /// Adds or replaces the values of a track. The values must be in the
+    /// order of the column types.
+    void updateTrack(TrackId trackId, const QStringList& values);
+    void removeTrack(TrackId trackId);
+
+    bool containsTrack(TrackId trackId) const {
+        return m_rowsByTrackId.contains(trackId);
+    }
+    /// Returns -1 if the track is not indexed.
+    int rowOfTrack(TrackId trackId) const {
+        return m_rowsByTrackId.value(trackId, -1);
+    }
+    TrackId trackIdOfRow(int row) const {
+        return m_rowTrackIds[row];
+    }
+
+    /// Returns the rows with a value in any column that contains the
+    /// term, in ascending order. Case and diacritics are ignored like in
+    /// SQL LIKE queries. If pCandidateRows is given, only these rows
+    /// are considered. They must be in ascending order.
+    std::vector<int> matchTerm(
+            const QString& term,
+            const std::vector<int>* pCandidateRows = nullptr) const;
+
+  private:
+    static constexpr std::uint32_t kNoValue = UINT32_MAX;
+
+    // Trigram posting list with delta encoded value ids
+    class Postings {
+      public:
+        void append(std::uint32_t valueId);
+        std::size_t size() const {
+            return m_size;
+        }
+        void decode(std::vector<std::uint32_t>* pValueIds) const;
+        void intersect(std::vector<std::uint32_t>* pValueIds) const;
+
+      private:
+        std::vector<std::uint8_t> m_bytes;
+        std::uint32_t m_lastValueId = 0;
+        std::size_t m_size = 0;
+    };
+
+    // A dictionary of distinct folded values, stored as UTF-8
+    class Dictionary {
+      public:
+        Dictionary();
+
+        std::uint32_t intern(std::string_view value);
+        std::string_view value(std::uint32_t valueId) const {
+            return std::string_view(m_text).substr(m_offsets[valueId],
+                    m_offsets[valueId + 1] - m_offsets[valueId] - 1);
+        }
+        std::size_t size() const {
+            return m_offsets.size() - 1;
+        }
+
+        /// Marks all values that contain the needle.
+        void match(std::string_view needle, std::vector<bool>* pMatches) const;
+
+      private:
+        class ValueHash {
+          public:
+            explicit ValueHash(const Dictionary* pDictionary)
+                    : m_pDictionary(pDictionary) {
+            }
+            std::size_t operator()(std::uint32_t valueId) const;
+
+          private:
+            const Dictionary* m_pDictionary;
+        };
+        class ValueEqual {
+          public:
+            explicit ValueEqual(const Dictionary* pDictionary)
+                    : m_pDictionary(pDictionary) {
+            }
+            bool operator()(std::uint32_t lhs, std::uint32_t rhs) const;
+
+          private:
+            const Dictionary* m_pDictionary;
+        };
+
+        void scan(std::string_view needle, std::vector<bool>* pMatches) const;
+
+        // All values, each terminated by '\0'
+        std::string m_text;
+        // Offset of each value in m_text and the end of the text
+        std::vector<std::uint32_t> m_offsets;
+        std::unordered_set<std::uint32_t, ValueHash, ValueEqual> m_valueIds;
+        std::unordered_map<std::uint32_t, Postings> m_trigrams;
+
+        // The hash set refers to this object
+        DISALLOW_COPY_AND_ASSIGN(Dictionary);
+    };
+
+    // The dictionaries and the value ids of all rows of an indexed column.
+    // Path columns use a second dictionary for the file names.
+    struct Column {
+        explicit Column(ColumnType type)
+                : type(type) {
+        }
+
+        const ColumnType type;
+        Dictionary values;
+        std::vector<std::uint32_t> rowValues;
+        Dictionary fileNames;
+        std::vector<std::uint32_t> rowFileNames;
+    };
+
+    bool rowMatches(const Column& column, int row, std::string_view needle) const;
+    void matchColumn(const Column& column,
+            std::string_view needle,
+            const std::vector<int>* pCandidateRows,
+            std::vector<bool>* pMatchingRows) const;
+
+    QVector<ColumnType> m_columnTypes;
+    std::vector<std::unique_ptr<Column>> m_columns;
+    std::vector<TrackId> m_rowTrackIds;
+    QHash<TrackId, int> m_rowsByTrackId;
+    quint64 m_generation;
+
+    DISALLOW_COPY_AND_ASSIGN(TrackSearchIndex);
+};
@@ -17,6 +17,7 @@
 #include "library/treeitem.h"
 #include "moc_traktorfeature.cpp"
 #include "track/keyutils.h"
+#include "util/db/sqlbatchinsert.h"
 #include "util/sandbox.h"
 #include "util/semanticversion.h"
 
@@ -201,20 +202,28 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
     thisThread->setPriority(QThread::LowPriority);
     //Invisible root item of Traktor's child model
     TreeItem* root = nullptr;
-    //Delete all table entries of Traktor feature
+    //Replace all table entries of Traktor feature within a single
+    //transaction, the previous entries remain visible until committed
     ScopedTransaction transaction(m_database);
     clearTable("traktor_playlist_tracks");
     clearTable("traktor_library");
     clearTable("traktor_playlists");
-    transaction.commit();
 
-    transaction.transaction();
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO traktor_library (artist, title, album, year,"
-                  "genre,comment,tracknumber,bpm, bitrate,duration, location,"
-                  "rating,key) VALUES (:artist, :title, :album, :year,:genre,"
-                  ":comment, :tracknumber,:bpm, :bitrate,:duration, :location,"
-                  ":rating,:key)");
+    SqlBatchInsert insert(m_database,
+            QStringLiteral("traktor_library"),
+            {QStringLiteral("artist"),
+                    QStringLiteral("title"),
+                    QStringLiteral("album"),
+                    QStringLiteral("year"),
+                    QStringLiteral("genre"),
+                    QStringLiteral("comment"),
+                    QStringLiteral("tracknumber"),
+                    QStringLiteral("bpm"),
+                    QStringLiteral("bitrate"),
+                    QStringLiteral("duration"),
+                    QStringLiteral("location"),
+                    QStringLiteral("rating"),
+                    QStringLiteral("key")});
 
     //Parse Trakor XML file using SAX (for performance)
     mixxx::FileInfo fileInfo(file);
@@ -238,7 +247,7 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
             // Each "ENTRY" tag in <COLLECTION> represents a track
             if (inCollectionTag && xml.name() == QLatin1String("ENTRY")) {
                 //parse track
-                parseTrack(xml, query);
+                parseTrack(xml, &insert);
                 ++nAudioFiles; //increment number of files in the music collection
             }
             if (xml.name() == QLatin1String("PLAYLISTS")) {
@@ -250,7 +259,8 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
                 QString name = attr.value("NAME").toString();
 
                 if (nodetype == "FOLDER" && name == "$ROOT") {
-                    //process all playlists
+                    //process all playlists, which refer to the tracks
+                    insert.flush();
                     root = parsePlaylists(xml);
                     isRootFolderParsed = true;
                 }
@@ -265,6 +275,7 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
             }
         }
     }
+    insert.flush();
     if (xml.hasError()) {
          // do error handling
          qDebug() << "Cannot process Traktor music collection";
@@ -281,7 +292,7 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
     return root;
 }
 
-void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
+void TraktorFeature::parseTrack(QXmlStreamReader& xml, SqlBatchInsert* pInsert) {
     QString title;
     QString artist;
     QString album;
@@ -379,26 +390,19 @@ void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
 
     // If we reach the end of ENTRY within the COLLECTION tag
     // Save parsed track to database
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":genre", genre);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":key", key);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-
-    bool success = query.exec();
-    if (!success) {
-        qDebug() << "SQL Error in TraktorTableModel.cpp: line"
-                 << __LINE__ << " " << query.lastError();
-        return;
-    }
+    pInsert->insert({artist,
+            title,
+            album,
+            year,
+            genre,
+            comment,
+            tracknumber,
+            bpm,
+            bitrate,
+            playtime,
+            location,
+            rating,
+            key});
 }
 
 // Purpose: Parsing all the folder and playlists of Traktor
@@ -422,10 +426,25 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
     query_insert_to_playlists.prepare("INSERT INTO traktor_playlists (name) "
                   "VALUES (:name)");
 
-    QSqlQuery query_insert_to_playlist_tracks(m_database);
-    query_insert_to_playlist_tracks.prepare(
-        "INSERT INTO traktor_playlist_tracks (playlist_id, track_id, position) "
-        "VALUES (:playlist_id, :track_id, :position)");
+    SqlBatchInsert insert_to_playlist_tracks(m_database,
+            QStringLiteral("traktor_playlist_tracks"),
+            {QStringLiteral("playlist_id"),
+                    QStringLiteral("track_id"),
+                    QStringLiteral("position")});
+
+    // Looking up the tracks of all playlist entries by their location
+    // would take longer than a single pass over the collection
+    QHash<QString, int> trackIds;
+    QSqlQuery track_id_query(m_database);
+    track_id_query.setForwardOnly(true);
+    if (track_id_query.exec("SELECT location, id FROM traktor_library")) {
+        while (track_id_query.next()) {
+            trackIds.insert(track_id_query.value(0).toString(),
+                    track_id_query.value(1).toInt());
+        }
+    } else {
+        LOG_FAILED_QUERY(track_id_query);
+    }
 
     while (!xml.atEnd() && !m_cancelImport) {
         //read next XML element
@@ -454,8 +473,9 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
                     // process all the entries within the playlist 'name' having path 'current_path'
                     parsePlaylistEntries(xml,
                             current_path,
-                            std::move(query_insert_to_playlists),
-                            std::move(query_insert_to_playlist_tracks));
+                            query_insert_to_playlists,
+                            &insert_to_playlist_tracks,
+                            trackIds);
                 }
             }
         }
@@ -478,14 +498,16 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
             }
         }
     }
+    insert_to_playlist_tracks.flush();
     return rootItem.release();
 }
 
 void TraktorFeature::parsePlaylistEntries(
         QXmlStreamReader& xml,
         const QString& playlist_path,
-        QSqlQuery query_insert_into_playlist,
-        QSqlQuery query_insert_into_playlisttracks) {
+        QSqlQuery& query_insert_into_playlist,
+        SqlBatchInsert* pInsertIntoPlaylistTracks,
+        const QHash<QString, int>& trackIds) {
     // In the database, the name of a playlist is specified by the unique path,
     // e.g., /someFolderA/someFolderB/playlistA"
     query_insert_into_playlist.bindValue(":name", playlist_path);
@@ -531,28 +553,9 @@ void TraktorFeature::parsePlaylistEntries(
                     #endif
 
                     //insert to database
-                    int track_id = -1;
-                    QSqlQuery finder_query(m_database);
-                    finder_query.prepare("select id from traktor_library where location=:path");
-                    finder_query.bindValue(":path", key);
-
-                    if (!finder_query.exec()) {
-                        LOG_FAILED_QUERY(finder_query) << "Could not get track id:" << key;
-                        continue;
-                    }
-
-                    if (finder_query.next()) {
-                        track_id = finder_query.value(finder_query.record().indexOf("id")).toInt();
-                    }
-
-                    query_insert_into_playlisttracks.bindValue(":playlist_id", playlist_id);
-                    query_insert_into_playlisttracks.bindValue(":track_id", track_id);
-                    query_insert_into_playlisttracks.bindValue(":position", playlist_position++);
-                    if (!query_insert_into_playlisttracks.exec()) {
-                        LOG_FAILED_QUERY(query_insert_into_playlisttracks)
-                                << "trackid" << track_id << " with path " << key
-                                << "playlistname; " << playlist_path <<" with ID " << playlist_id;
-                    }
+                    const int track_id = trackIds.value(key, -1);
+                    pInsertIntoPlaylistTracks->insert(
+                            {playlist_id, track_id, playlist_position++});
                 }
             }
         }
@@ -12,6 +12,8 @@
 #include "library/baseexternalplaylistmodel.h"
 #include "library/treeitemmodel.h"
 
+class SqlBatchInsert;
+
 class TraktorTrackModel : public BaseExternalTrackModel {
     Q_OBJECT
   public:
@@ -51,14 +53,15 @@ class TraktorFeature : public BaseExternalLibraryFeature {
     BaseSqlTableModel* getPlaylistModelForPlaylist(const QString& playlist) override;
     TreeItem* importLibrary(const QString& file);
     // parses a track in the music collection
-    void parseTrack(QXmlStreamReader &xml, QSqlQuery &query);
+    void parseTrack(QXmlStreamReader& xml, SqlBatchInsert* pInsert);
     // Iterates over all playliost and folders and constructs the childmodel
     TreeItem* parsePlaylists(QXmlStreamReader &xml);
     // processes a particular playlist
     void parsePlaylistEntries(QXmlStreamReader& xml,
             const QString& playlist_path,
-            QSqlQuery query_insert_into_playlist,
-            QSqlQuery query_insert_into_playlisttracks);
+            QSqlQuery& query_insert_into_playlist,
+            SqlBatchInsert* pInsertIntoPlaylistTracks,
+            const QHash<QString, int>& trackIds);
     void clearTable(const QString& table_name);
     static QString getTraktorMusicDatabase();
     // private fields
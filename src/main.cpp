@@ -8,6 +8,7 @@
 
 #include "config.h"
 #include "coreservices.h"
+#include "engine/offlinerenderer.h"
 #include "errordialoghandler.h"
 #include "mixxxapplication.h"
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -28,11 +29,30 @@ namespace {
 constexpr int kFatalErrorOnStartupExitCode = 1;
 #endif
 constexpr int kParseCmdlineArgsErrorExitCode = 2;
+constexpr int kRenderErrorExitCode = 3;
 
 constexpr char kScaleFactorEnvVar[] = "QT_SCALE_FACTOR";
 const QString kConfigGroup = QStringLiteral("[Config]");
 const QString kScaleFactorKey = QStringLiteral("ScaleFactor");
 
+/// Renders a scripted mix without any GUI or sound device, see --render
+int renderMixxx(MixxxApplication* pApp, const CmdlineArgs& args) {
+    const auto pCoreServices = std::make_shared<mixxx::CoreServices>(args, pApp);
+    pCoreServices->initializeForRender();
+
+    // This scope ensures that the renderer has released the engine before
+    // CoreServices is shut down.
+    {
+        mixxx::OfflineRenderer renderer(pCoreServices->getSettings(),
+                pCoreServices->getEngineMaster().get(),
+                pCoreServices->getPlayerManager().get());
+        if (!renderer.render(args.getRenderScriptPath(), args.getRenderOutputPath())) {
+            return kRenderErrorExitCode;
+        }
+    }
+    return 0;
+}
+
 int runMixxx(MixxxApplication* pApp, const CmdlineArgs& args) {
     const auto pCoreServices = std::make_shared<mixxx::CoreServices>(args, pApp);
 
@@ -161,6 +181,11 @@ int main(int argc, char * argv[]) {
 
     adjustScaleFactor(&args);
 
+    // Rendering does not show any window, so it must not depend on a display
+    if (args.getRenderEnabled() && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", QByteArrayLiteral("offscreen"));
+    }
+
     MixxxApplication app(argc, argv);
 
 #ifdef __APPLE__
@@ -195,7 +220,7 @@ int main(int argc, char * argv[]) {
     // When the last window is closed, terminate the Qt event loop.
     QObject::connect(&app, &MixxxApplication::lastWindowClosed, &app, &MixxxApplication::quit);
 
-    int exitCode = runMixxx(&app, args);
+    int exitCode = args.getRenderEnabled() ? renderMixxx(&app, args) : runMixxx(&app, args);
 
     qDebug() << "Mixxx shutdown complete with code" << exitCode;
 
@@ -303,7 +303,9 @@ void PlayerManager::slotChangeNumDecks(double v) {
 
     // Update the soundmanager config even if the number of decks has been
     // reduced.
-    m_pSoundManager->setConfiguredDeckCount(num);
+    if (m_pSoundManager) {
+        m_pSoundManager->setConfiguredDeckCount(num);
+    }
 
     if (num < m_decks.size()) {
         // The request was invalid -- reset the value.
@@ -426,14 +428,16 @@ void PlayerManager::addDeckInner() {
     m_players[handleGroup.handle()] = pDeck;
     m_decks.append(pDeck);
 
-    // Register the deck output with SoundManager.
-    m_pSoundManager->registerOutput(
-            AudioOutput(AudioOutput::DECK, 0, 2, deckIndex), m_pEngine);
+    if (m_pSoundManager) {
+        // Register the deck output with SoundManager.
+        m_pSoundManager->registerOutput(
+                AudioOutput(AudioOutput::DECK, 0, 2, deckIndex), m_pEngine);
 
-    // Register vinyl input signal with deck for passthrough support.
-    EngineDeck* pEngineDeck = pDeck->getEngineDeck();
-    m_pSoundManager->registerInput(
-            AudioInput(AudioInput::VINYLCONTROL, 0, 2, deckIndex), pEngineDeck);
+        // Register vinyl input signal with deck for passthrough support.
+        EngineDeck* pEngineDeck = pDeck->getEngineDeck();
+        m_pSoundManager->registerInput(
+                AudioInput(AudioInput::VINYLCONTROL, 0, 2, deckIndex), pEngineDeck);
+    }
 
     // Setup equalizer and QuickEffect chain for this deck.
     m_pEffectsManager->addDeck(handleGroup.m_name);
@@ -58,6 +58,9 @@ class PlayerManagerInterface {
 class PlayerManager : public QObject, public PlayerManagerInterface {
     Q_OBJECT
   public:
+    /// pSoundManager may be null if the engine is not driven by a sound
+    /// device, e.g. for offline rendering. Decks are then not registered
+    /// as sound outputs, and microphones and auxiliaries must not be added.
     PlayerManager(UserSettingsPointer pConfig,
             SoundManager* pSoundManager,
             EffectsManager* pEffectsManager,
@@ -16,6 +16,7 @@
 #ifdef __BROADCAST__
 #include "broadcast/broadcastmanager.h"
 #endif
+#include "control/controlchangejournal.h"
 #include "control/controlindicatortimer.h"
 #include "controllers/controllermanager.h"
 #include "controllers/keyboard/keyboardeventfilter.h"
@@ -92,6 +93,11 @@ MixxxMainWindow::MixxxMainWindow(std::shared_ptr<mixxx::CoreServices> pCoreServi
 
     show();
 
+    // Skin widgets receive control changes once per frame instead of
+    // one queued event per change.
+    ControlChangeJournal::setGuiJournalEnabled(
+            m_pCoreServices->getSettings()->getValue<bool>(
+                    ConfigKey("[Master]", "control_change_journal"), false));
     m_pGuiTick = new GuiTick();
     m_pVisualsManager = new VisualsManager();
 }
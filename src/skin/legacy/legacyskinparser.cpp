@@ -24,6 +24,7 @@
 #include "skin/legacy/colorschemeparser.h"
 #include "skin/legacy/launchimage.h"
 #include "skin/legacy/skincontext.h"
+#include "skin/legacy/skindocumentcache.h"
 #include "util/cmdlineargs.h"
 #include "util/timer.h"
 #include "util/valuetransformer.h"
@@ -220,30 +221,9 @@ QDomElement LegacySkinParser::openSkin(const QString& skinPath) {
         return QDomElement();
     }
 
-    QString skinXmlPath = skinDir.filePath("skin.xml");
-    QFile skinXmlFile(skinXmlPath);
-
-    if (!skinXmlFile.open(QIODevice::ReadOnly)) {
-        qDebug() << "LegacySkinParser::openSkin - can't open file:" << skinXmlPath
-                 << "in directory:" << skinDir.path();
-        return QDomElement();
-    }
-
-    QDomDocument skin("skin");
-
-    QString errorMessage;
-    int errorLine;
-    int errorColumn;
-
-    if (!skin.setContent(&skinXmlFile,&errorMessage,&errorLine,&errorColumn)) {
-        qDebug() << "LegacySkinParser::openSkin - setContent failed see"
-                 << "line:" << errorLine << "column:" << errorColumn;
-        qDebug() << "LegacySkinParser::openSkin - message:" << errorMessage;
-        return QDomElement();
-    }
-
-    skinXmlFile.close();
-    return skin.documentElement();
+    // The skin.xml is opened repeatedly, e.g. for the manifest and the color
+    // schemes before parsing the skin
+    return SkinDocumentCache::load(skinDir.filePath("skin.xml"));
 }
 
 // static
@@ -1587,28 +1567,15 @@ QDomElement LegacySkinParser::loadTemplate(const QString& path) {
         return it.value();
     }
 
-    QFile templateFile(absolutePath);
-
-    if (!templateFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Could not open template file:" << absolutePath;
-    }
-
-    QDomDocument tmpl("template");
-    QString errorMessage;
-    int errorLine;
-    int errorColumn;
-
-    if (!tmpl.setContent(&templateFile, &errorMessage,
-                         &errorLine, &errorColumn)) {
-        qWarning() << "LegacySkinParser::loadTemplate - setContent failed see"
-                   << absolutePath << "line:" << errorLine << "column:" << errorColumn;
-        qWarning() << "LegacySkinParser::loadTemplate - message:" << errorMessage;
+    const QDomElement templateNode = SkinDocumentCache::load(absolutePath);
+    if (templateNode.isNull()) {
+        qWarning() << "LegacySkinParser::loadTemplate - failed to load" << absolutePath;
         return QDomElement();
     }
 
-    m_templateCache[absolutePath] = tmpl.documentElement();
+    m_templateCache[absolutePath] = templateNode;
     m_pContext->setSkinTemplatePath(templateFileInfo.absoluteDir().absolutePath());
-    return tmpl.documentElement();
+    return templateNode;
 }
 
 QList<QWidget*> LegacySkinParser::parseTemplate(const QDomElement& node) {
@@ -0,0 +1,71 @@
+#include "skin/legacy/skindocumentcache.h"
+
+#include <QDateTime>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SkinDocumentCache");
+
+struct CachedDocument {
+    QDateTime lastModified;
+    qint64 size;
+    QDomDocument document;
+};
+
+QHash<QString, CachedDocument> s_documents;
+
+} // anonymous namespace
+
+// static
+QDomElement SkinDocumentCache::load(const QString& filePath) {
+    const QFileInfo fileInfo(filePath);
+    const QString absolutePath = fileInfo.absoluteFilePath();
+    const QDateTime lastModified = fileInfo.lastModified();
+    const qint64 size = fileInfo.size();
+
+    const auto it = s_documents.constFind(absolutePath);
+    if (it != s_documents.constEnd() &&
+            it->lastModified == lastModified &&
+            it->size == size) {
+        return it->document.documentElement();
+    }
+
+    QFile file(absolutePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        kLogger.warning()
+                << "Failed to open"
+                << absolutePath
+                << file.errorString();
+        s_documents.remove(absolutePath);
+        return QDomElement();
+    }
+
+    QDomDocument document;
+    QString errorMessage;
+    int errorLine;
+    int errorColumn;
+    if (!document.setContent(&file, &errorMessage, &errorLine, &errorColumn)) {
+        kLogger.warning()
+                << "Failed to parse"
+                << absolutePath
+                << "line:" << errorLine
+                << "column:" << errorColumn
+                << "message:" << errorMessage;
+        s_documents.remove(absolutePath);
+        return QDomElement();
+    }
+
+    s_documents.insert(absolutePath, CachedDocument{lastModified, size, document});
+    return document.documentElement();
+}
+
+// static
+void SkinDocumentCache::clear() {
+    s_documents.clear();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QDomElement>
+#include <QString>
+
+/// Parsed skin and template documents that are shared by all instances of
+/// LegacySkinParser.
+///
+/// A new parser is created for every skin that is loaded, and the skin.xml
+/// is opened multiple times before the skin is even parsed, e.g. for the
+/// manifest and the color schemes. Templates like the decks of LateNight
+/// are instantiated many times. Each file is only parsed once and again
+/// after it has been modified, i.e. reloading an unchanged skin does not
+/// parse any XML.
+///
+/// The documents must not be modified. All functions must be called from
+/// the GUI thread.
+class SkinDocumentCache final {
+  public:
+    /// Returns the document element of the XML file, or a null element if
+    /// the file cannot be read or parsed. Files are validated by their
+    /// modification time and size.
+    static QDomElement load(const QString& filePath);
+
+    /// Frees the memory of all documents.
+    static void clear();
+
+  private:
+    SkinDocumentCache() = delete;
+};
@@ -0,0 +1,145 @@
+#include "skin/legacy/svgrastercache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QImageReader>
+#include <QPainter>
+#include <QSaveFile>
+#include <QSvgRenderer>
+
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SvgRasterCache");
+
+const QString kFileSuffix = QStringLiteral(".png");
+
+// Images of skins that have been updated or removed are not needed anymore
+constexpr qint64 kMaxUnusedDays = 90;
+
+// Only written once during startup before any skin is loaded
+QString s_storageDirectory;
+
+QByteArray readSvgData(const PixmapSource& source) {
+    if (!source.getSvgSourceData().isEmpty()) {
+        return source.getSvgSourceData();
+    }
+    QFile file(source.getPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        kLogger.warning()
+                << "Failed to open"
+                << source.getPath()
+                << file.errorString();
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+QString filePathForSvg(const QByteArray& svgData, double scaleFactor) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(svgData);
+    hash.addData(QByteArray::number(scaleFactor));
+    return QDir(s_storageDirectory).filePath(hash.result().toHex() + kFileSuffix);
+}
+
+QImage renderSvg(const QByteArray& svgData, double scaleFactor) {
+    QSvgRenderer renderer;
+    if (!renderer.load(svgData)) {
+        // The above line already logs a warning
+        return QImage();
+    }
+    QImage image(renderer.defaultSize() * scaleFactor, QImage::Format_ARGB32);
+    image.fill(0x00000000); // Transparent black.
+    {
+        QPainter painter(&image);
+        renderer.render(&painter);
+    }
+    return image;
+}
+
+QImage loadImage(const QString& filePath) {
+    if (!QFile::exists(filePath)) {
+        return QImage();
+    }
+    QImageReader reader(filePath);
+    QImage image = reader.read();
+    if (image.isNull()) {
+        kLogger.warning()
+                << "Discarding invalid image"
+                << filePath
+                << reader.errorString();
+        QFile::remove(filePath);
+        return QImage();
+    }
+    // Mark the image as used, see setStorageDirectory()
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return image.convertToFormat(QImage::Format_ARGB32);
+}
+
+void saveImage(const QString& filePath, const QImage& image) {
+    // Other threads might load the same image concurrently and must
+    // never see a partially written file
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) ||
+            !image.save(&file, "PNG") ||
+            !file.commit()) {
+        kLogger.warning()
+                << "Failed to save image"
+                << filePath
+                << file.errorString();
+    }
+}
+
+} // anonymous namespace
+
+// static
+void SvgRasterCache::setStorageDirectory(const QString& directoryPath) {
+    s_storageDirectory = directoryPath;
+    if (s_storageDirectory.isEmpty()) {
+        return;
+    }
+    QDir directory(s_storageDirectory);
+    if (!directory.mkpath(QStringLiteral("."))) {
+        kLogger.warning()
+                << "Failed to create directory"
+                << s_storageDirectory;
+        s_storageDirectory.clear();
+        return;
+    }
+    const QDateTime expired = QDateTime::currentDateTime().addDays(-kMaxUnusedDays);
+    const QFileInfoList fileInfos = directory.entryInfoList(
+            QStringList{QChar('*') + kFileSuffix}, QDir::Files);
+    for (const auto& fileInfo : fileInfos) {
+        if (fileInfo.lastModified() < expired) {
+            directory.remove(fileInfo.fileName());
+        }
+    }
+}
+
+// static
+QImage SvgRasterCache::render(const PixmapSource& source, double scaleFactor) {
+    const QByteArray svgData = readSvgData(source);
+    if (svgData.isEmpty()) {
+        return QImage();
+    }
+    if (s_storageDirectory.isEmpty()) {
+        return renderSvg(svgData, scaleFactor);
+    }
+
+    const QString filePath = filePathForSvg(svgData, scaleFactor);
+    QImage image = loadImage(filePath);
+    if (!image.isNull()) {
+        return image;
+    }
+    image = renderSvg(svgData, scaleFactor);
+    if (!image.isNull()) {
+        saveImage(filePath, image);
+    }
+    return image;
+}
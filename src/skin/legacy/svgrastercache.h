@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+#include "skin/legacy/pixmapsource.h"
+
+/// A persistent store for the SVG images of skins that are rendered into
+/// raster images at the scale factor of the skin.
+///
+/// Loading and rendering the SVGs of a skin makes up a large part of the
+/// time to load a skin. The rendered images are stored as PNG files and
+/// loaded instead on the next start or when the skin is reloaded. The files
+/// are keyed by a hash of the SVG data and the scale factor, i.e. modified
+/// SVGs are rendered again. Images that have not been used for a while are
+/// deleted upon startup. All functions are thread-safe.
+class SvgRasterCache final {
+  public:
+    /// Images are only stored if a directory has been set. This function
+    /// is not thread-safe and must be called only once upon startup of
+    /// the application.
+    static void setStorageDirectory(const QString& directoryPath);
+
+    /// Renders the SVG of the source scaled by the scale factor into a
+    /// transparent image. Returns a null image if the source is not a
+    /// valid SVG.
+    static QImage render(const PixmapSource& source, double scaleFactor);
+
+  private:
+    SvgRasterCache() = delete;
+};
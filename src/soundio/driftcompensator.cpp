@@ -0,0 +1,188 @@
+#include "soundio/driftcompensator.h"
+
+#include "util/assert.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+// The measured fill level is disturbed by the callback jitter of both
+// devices. It is smoothed over a few dozen callbacks, because any noise
+// that passes the loop modulates the pitch.
+constexpr double kErrorSmoothing = 1.0 / 32;
+
+// The loop is critically damped with a natural frequency of 1/1000 chunks,
+// i.e. it settles within a few thousand callbacks.
+constexpr double kProportionalGain = 2e-3;
+constexpr double kIntegralGain = kProportionalGain * kProportionalGain / 4;
+
+constexpr SINT kHistoryFrames = 4;
+
+// Room for the frames of one chunk at the maximum ratio, including
+// callbacks with a larger than expected number of frames
+constexpr SINT kScratchChunks = 2;
+
+} // anonymous namespace
+
+DriftCompensator::DriftCompensator(int channelCount, SINT framesPerChunk)
+        : m_channelCount(channelCount),
+          m_framesPerChunk(framesPerChunk),
+          m_ratio(1.0),
+          m_integral(0.0),
+          m_error(0.0),
+          m_phase(1.0),
+          m_history(kHistoryFrames * channelCount),
+          m_scratch(kScratchChunks * framesPerChunk * channelCount) {
+    DEBUG_ASSERT(m_channelCount > 0);
+    DEBUG_ASSERT(m_framesPerChunk > 0);
+    m_history.clear();
+}
+
+SINT DriftCompensator::fifoPrefillSamples() const {
+    return static_cast<SINT>((1.0 + kJitterReserve) * m_framesPerChunk) * m_channelCount;
+}
+
+bool DriftCompensator::readOutput(FIFO<CSAMPLE>* pFifo,
+        CSAMPLE* pOut,
+        SINT frames,
+        double referencePhase) {
+    const SINT availableFrames = pFifo->readAvailable() / m_channelCount;
+    // The clock reference device writes a whole chunk at the beginning
+    // of its period, i.e. the continuous fill level is lower than the
+    // measured one at the beginning and higher at the end of the period.
+    // We need at least one chunk left at the end of the period.
+    updateRatio(availableFrames + referencePhase * m_framesPerChunk,
+            (2.0 + kJitterReserve) * m_framesPerChunk);
+
+    const SINT scratchFrames = m_scratch.size() / m_channelCount;
+    const SINT readFrames = math_min(
+            math_min(inputFramesRequired(frames), availableFrames),
+            scratchFrames);
+    pFifo->read(m_scratch.data(), readFrames * m_channelCount);
+
+    SINT consumedFrames;
+    const SINT outputFrames = resample(
+            m_scratch.data(), readFrames, pOut, frames, &consumedFrames);
+    DEBUG_ASSERT(consumedFrames == readFrames);
+    if (outputFrames < frames) {
+        // Underflow
+        SampleUtil::clear(&pOut[outputFrames * m_channelCount],
+                (frames - outputFrames) * m_channelCount);
+        return false;
+    }
+    return true;
+}
+
+bool DriftCompensator::writeInput(FIFO<CSAMPLE>* pFifo,
+        const CSAMPLE* pIn,
+        SINT frames,
+        double referencePhase) {
+    // The clock reference device reads a whole chunk at the beginning of
+    // its period, i.e. the continuous fill level is higher than the
+    // measured one at the beginning and lower at the end of the period.
+    // The chunk is complete before the end of the period.
+    updateRatio(pFifo->readAvailable() / m_channelCount -
+                    referencePhase * m_framesPerChunk,
+            kJitterReserve * m_framesPerChunk);
+
+    SINT consumedFrames = 0;
+    bool overflow = false;
+    while (consumedFrames < frames) {
+        // A single pass is sufficient unless the callback passes more
+        // frames than expected
+        SINT inFrames;
+        const SINT outputFrames = resample(&pIn[consumedFrames * m_channelCount],
+                frames - consumedFrames,
+                m_scratch.data(),
+                m_scratch.size() / m_channelCount,
+                &inFrames);
+        consumedFrames += inFrames;
+        const int samples = outputFrames * m_channelCount;
+        if (pFifo->write(m_scratch.data(), samples) < samples) {
+            overflow = true;
+        }
+    }
+    return !overflow;
+}
+
+void DriftCompensator::updateRatio(double fillLevelFrames, double targetFrames) {
+    m_error += kErrorSmoothing *
+            ((fillLevelFrames - targetFrames) / m_framesPerChunk - m_error);
+    const double deviation = kProportionalGain * m_error +
+            kIntegralGain * (m_integral + m_error);
+    if (deviation > kMaxRatioDeviation) {
+        m_ratio = 1.0 + kMaxRatioDeviation;
+    } else if (deviation < -kMaxRatioDeviation) {
+        m_ratio = 1.0 - kMaxRatioDeviation;
+    } else {
+        // Only integrate if not saturated to avoid a windup after
+        // large errors, e.g. during startup
+        m_integral += m_error;
+        m_ratio = 1.0 + deviation;
+    }
+}
+
+SINT DriftCompensator::inputFramesRequired(SINT outputFrames) const {
+    // This must exactly mirror the loop in resample()
+    double phase = m_phase;
+    SINT inputFrames = 0;
+    for (SINT i = 0; i < outputFrames; ++i) {
+        while (phase >= 1.0) {
+            ++inputFrames;
+            phase -= 1.0;
+        }
+        phase += m_ratio;
+    }
+    return inputFrames;
+}
+
+SINT DriftCompensator::resample(const CSAMPLE* pIn,
+        SINT inFrames,
+        CSAMPLE* pOut,
+        SINT maxOutFrames,
+        SINT* pInFramesConsumed) {
+    CSAMPLE* pHistory = m_history.data();
+    const int channelCount = m_channelCount;
+    SINT inFrame = 0;
+    SINT outFrame = 0;
+    while (outFrame < maxOutFrames) {
+        while (m_phase >= 1.0) {
+            if (inFrame >= inFrames) {
+                *pInFramesConsumed = inFrame;
+                return outFrame;
+            }
+            // The regions overlap
+            for (int i = 0; i < (kHistoryFrames - 1) * channelCount; ++i) {
+                pHistory[i] = pHistory[i + channelCount];
+            }
+            SampleUtil::copy(&pHistory[(kHistoryFrames - 1) * channelCount],
+                    &pIn[inFrame * channelCount],
+                    channelCount);
+            ++inFrame;
+            m_phase -= 1.0;
+        }
+        // Catmull-Rom spline between the second and the third frame
+        const auto t = static_cast<CSAMPLE>(m_phase);
+        const CSAMPLE* pY0 = pHistory;
+        const CSAMPLE* pY1 = &pHistory[channelCount];
+        const CSAMPLE* pY2 = &pHistory[2 * channelCount];
+        const CSAMPLE* pY3 = &pHistory[3 * channelCount];
+        CSAMPLE* pFrame = &pOut[outFrame * channelCount];
+        for (int i = 0; i < channelCount; ++i) {
+            const CSAMPLE y0 = pY0[i];
+            const CSAMPLE y1 = pY1[i];
+            const CSAMPLE y2 = pY2[i];
+            const CSAMPLE y3 = pY3[i];
+            pFrame[i] = y1 +
+                    0.5f * t *
+                            (y2 - y0 +
+                                    t *
+                                            (2.0f * y0 - 5.0f * y1 + 4.0f * y2 - y3 +
+                                                    t * (3.0f * (y1 - y2) + y3 - y0)));
+        }
+        ++outFrame;
+        m_phase += m_ratio;
+    }
+    *pInFramesConsumed = inFrame;
+    return outFrame;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "util/fifo.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+/// Compensates the clock drift between the clock reference sound device and
+/// a secondary sound device by resampling the audio data that is exchanged
+/// through a FIFO between both devices.
+///
+/// The clock reference callback writes (output) or reads (input) the FIFO in
+/// chunks of one audio buffer, the secondary callback reads or writes the
+/// FIFO with a slightly adjusted ratio. The ratio is controlled by a PI loop
+/// that keeps the fill level of the FIFO at a constant level. The measured
+/// fill level jumps by a whole chunk with every access of the clock reference
+/// device, so the caller has to pass the elapsed fraction of the current
+/// clock reference period to estimate the continuous fill level.
+///
+/// The drift is absorbed continuously by a cubic interpolation instead of
+/// dropping or duplicating frames, which causes audible clicks.
+///
+/// All functions except the constructor are real-time safe and must only be
+/// called from the callback of the secondary device.
+class DriftCompensator final {
+  public:
+    /// The additional buffering in chunks that tolerates a delayed callback
+    /// of either device.
+    static constexpr double kJitterReserve = 0.25;
+    /// The maximum deviation of the resampling ratio from 1. Common crystal
+    /// oscillators deviate by less than 200 ppm.
+    static constexpr double kMaxRatioDeviation = 0.005;
+
+    DriftCompensator(int channelCount, SINT framesPerChunk);
+
+    /// The number of samples of silence that a FIFO needs to be prefilled
+    /// with before starting the streams, because it is not predictable
+    /// which callback fires first.
+    SINT fifoPrefillSamples() const;
+
+    /// Fills pOut with the given number of frames that are resampled from
+    /// the output FIFO.
+    ///
+    /// referencePhase is the elapsed fraction of the clock reference period
+    /// since the clock reference device has written the last chunk into the
+    /// FIFO. Returns false and pads the output with silence on an underflow.
+    bool readOutput(FIFO<CSAMPLE>* pFifo,
+            CSAMPLE* pOut,
+            SINT frames,
+            double referencePhase);
+
+    /// Writes the given frames resampled into the input FIFO.
+    ///
+    /// referencePhase is the elapsed fraction of the clock reference period
+    /// since the clock reference device has read the last chunk from the
+    /// FIFO. Returns false if the FIFO has overflowed.
+    bool writeInput(FIFO<CSAMPLE>* pFifo,
+            const CSAMPLE* pIn,
+            SINT frames,
+            double referencePhase);
+
+    /// The number of input frames that are consumed per output frame.
+    double ratio() const {
+        return m_ratio;
+    }
+
+    /// The number of frames that are delayed by the interpolation on top
+    /// of the FIFO fill level.
+    static constexpr SINT kInterpolationDelayFrames = 2;
+
+  private:
+    /// Adjusts the ratio for the next chunk. A positive error, i.e. a FIFO
+    /// that is too full, increases the ratio in both directions, because
+    /// more frames are consumed from the output FIFO and less frames are
+    /// written into the input FIFO.
+    void updateRatio(double fillLevelFrames, double targetFrames);
+
+    /// Returns the number of input frames that are required for the given
+    /// number of output frames.
+    SINT inputFramesRequired(SINT outputFrames) const;
+
+    /// Resamples until either the input is consumed or the output is full.
+    /// Returns the number of output frames.
+    SINT resample(const CSAMPLE* pIn,
+            SINT inFrames,
+            CSAMPLE* pOut,
+            SINT maxOutFrames,
+            SINT* pInFramesConsumed);
+
+    const int m_channelCount;
+    const SINT m_framesPerChunk;
+
+    double m_ratio;
+    double m_integral;
+    /// The smoothed deviation from the target fill level in chunks
+    double m_error;
+
+    /// Position of the next output frame between the second and third
+    /// frame of the history. Values >= 1 require a new input frame.
+    double m_phase;
+    /// The last 4 input frames, the oldest first.
+    mixxx::SampleBuffer m_history;
+    mixxx::SampleBuffer m_scratch;
+};
@@ -8,6 +8,7 @@
 #include <pthread.h>
 #endif
 
+#include "control/controlchangejournal.h"
 #include "control/pollingcontrolproxy.h"
 #include "engine/sidechain/networkoutputstreamworker.h"
 #include "soundio/sounddevice.h"
@@ -95,6 +96,7 @@ class SoundDeviceNetworkThread : public QThread {
             qWarning() << "SoundDeviceNetworkThread: Failed bumping priority";
         }
 #endif
+        ControlChangeJournal::registerGuiJournalThread();
 
         while(!m_stop) {
             m_pParent->callbackProcessClkRef();
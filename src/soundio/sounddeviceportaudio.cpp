@@ -6,8 +6,10 @@
 #include <QThread>
 #include <QtDebug>
 
+#include "control/controlchangejournal.h"
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
+#include "soundio/driftcompensator.h"
 #include "soundio/sounddevice.h"
 #include "soundio/soundmanager.h"
 #include "soundio/soundmanagerutil.h"
@@ -15,6 +17,7 @@
 #include "util/fifo.h"
 #include "util/math.h"
 #include "util/sample.h"
+#include "util/time.h"
 #include "util/timer.h"
 #include "util/trace.h"
 #include "vinylcontrol/defs_vinylcontrol.h"
@@ -27,11 +30,10 @@
 
 namespace {
 
-// Buffer for drift correction 1 full, 1 for r/w, 1 empty
-constexpr int kDriftReserve = 1;
-
-// Buffer for drift correction 1 full, 1 for r/w, 1 empty
-constexpr int kFifoSize = 2 * kDriftReserve + 1;
+// FIFO size in chunks for drift correction: 1 written by the clock reference
+// device, 1 read by this device and the reserve of the DriftCompensator.
+// FIFO rounds the size up to a power of 2, i.e. the capacity is 4 chunks.
+constexpr int kFifoSize = 3;
 
 constexpr int kCpuUsageUpdateRate = 30; // in 1/s, fits to display frame rate
 
@@ -86,6 +88,8 @@ SoundDevicePortAudio::SoundDevicePortAudio(UserSettingsPointer config,
           m_inputFifo(nullptr),
           m_outputDrift(false),
           m_inputDrift(false),
+          m_clkRefOutputFifoWriteNanos(0),
+          m_clkRefInputFifoReadNanos(0),
           m_bSetThreadPriority(false),
           m_masterAudioLatencyUsage("[Master]", "audio_latency_usage"),
           m_framesSinceAudioLatencyUsageUpdate(0),
@@ -253,15 +257,15 @@ SoundDeviceStatus SoundDevicePortAudio::open(bool isClkRefDevice, int syncBuffer
         // when there is a clock drift compared to the clock reference device
         // we need an additional artificial delay
         if (m_outputParams.channelCount) {
-            // On chunk for reading one for writing and on for drift correction
+            m_pOutputDriftCompensator = std::make_unique<DriftCompensator>(
+                    m_outputParams.channelCount, m_framesPerBuffer);
             m_outputFifo = new FIFO<CSAMPLE>(
                     m_outputParams.channelCount * m_framesPerBuffer
                             * kFifoSize);
-            // Clear first 1.5 chunks on for the required artificial delaly to
-            // a allow jitter and a half, because we can't predict which
-            // callback fires first.
-            int writeCount = m_outputParams.channelCount * m_framesPerBuffer *
-                    kFifoSize / 2;
+            // Prefill the FIFO with silence, because we can't predict
+            // which callback fires first.
+            int writeCount = static_cast<int>(
+                    m_pOutputDriftCompensator->fifoPrefillSamples());
             CSAMPLE* dataPtr1;
             ring_buffer_size_t size1;
             CSAMPLE* dataPtr2;
@@ -273,11 +277,13 @@ SoundDeviceStatus SoundDevicePortAudio::open(bool isClkRefDevice, int syncBuffer
             m_outputFifo->releaseWriteRegions(writeCount);
         }
         if (m_inputParams.channelCount) {
+            m_pInputDriftCompensator = std::make_unique<DriftCompensator>(
+                    m_inputParams.channelCount, m_framesPerBuffer);
             m_inputFifo = new FIFO<CSAMPLE>(
                     m_inputParams.channelCount * m_framesPerBuffer * kFifoSize);
-            // Clear first 1.5 chunks (see above)
-            int writeCount = m_inputParams.channelCount * m_framesPerBuffer *
-                    kFifoSize / 2;
+            // Prefill the FIFO with silence (see above)
+            int writeCount = static_cast<int>(
+                    m_pInputDriftCompensator->fifoPrefillSamples());
             CSAMPLE* dataPtr1;
             ring_buffer_size_t size1;
             CSAMPLE* dataPtr2;
@@ -288,6 +294,11 @@ SoundDeviceStatus SoundDevicePortAudio::open(bool isClkRefDevice, int syncBuffer
             SampleUtil::clear(dataPtr2, size2);
             m_inputFifo->releaseWriteRegions(writeCount);
         }
+        // The clock reference device accesses the FIFOs at the beginning
+        // of its periods, starting now
+        const qint64 nowNanos = mixxx::Time::elapsed().toIntegerNanos();
+        m_clkRefOutputFifoWriteNanos.store(nowNanos, std::memory_order_relaxed);
+        m_clkRefInputFifoReadNanos.store(nowNanos, std::memory_order_relaxed);
     } else if (m_syncBuffers == 1) { // "Disabled (short delay)"
         // this can be used on a second device when it is driven by the Clock
         // reference device clock
@@ -425,6 +436,8 @@ SoundDeviceStatus SoundDevicePortAudio::close() {
         if (m_inputFifo) {
             delete m_inputFifo;
         }
+        m_pOutputDriftCompensator.reset();
+        m_pInputDriftCompensator.reset();
     }
 
     m_outputFifo = nullptr;
@@ -560,6 +573,11 @@ void SoundDevicePortAudio::readProcess() {
             }
             m_inputFifo->releaseReadRegions(readCount);
         }
+        if (m_pInputDriftCompensator) {
+            m_clkRefInputFifoReadNanos.store(
+                    mixxx::Time::elapsed().toIntegerNanos(),
+                    std::memory_order_relaxed);
+        }
         if (readCount < inChunkSize) {
             // Fill remaining buffers with zeros
             clearInputBuffer(inChunkSize - readCount, readCount);
@@ -600,6 +618,11 @@ void SoundDevicePortAudio::writeProcess() {
             }
             m_outputFifo->releaseWriteRegions(writeCount);
         }
+        if (m_pOutputDriftCompensator) {
+            m_clkRefOutputFifoWriteNanos.store(
+                    mixxx::Time::elapsed().toIntegerNanos(),
+                    std::memory_order_relaxed);
+        }
 
         if (m_syncBuffers == 0) { // "Experimental (no delay)"
             // Polling
@@ -694,119 +717,54 @@ int SoundDevicePortAudio::callbackProcessDrift(
     // Unfortunately this delay is somehow random, an WILL produce a delay slow
     // shift without we can avoid it. (That's the price for using a cheap USB soundcard).
     //
-    // Additional we need an filled chunk and an empty chunk. These are used when on
-    // sound card overtakes the other. This always happens, if they are driven form
-    // two crystals. In a test case every 30 s @ 23 ms. After they are consumed,
-    // the drift correction takes place and fills or clears the reserve buffers.
-    // If this is finished before another overtake happens, we do not face any
-    // dropouts or clicks.
-    // So that's why we need a Fifo of 3 chunks.
+    // The drift is absorbed continuously by resampling the chunks with a ratio
+    // that keeps the fill level of the FIFOs constant. Dropping or duplicating
+    // frames instead would cause clicks. Since the Clock Reference device
+    // accesses the FIFOs chunk wise, we pass the time since its last access
+    // to estimate the continuous fill level.
     //
     // In addition there is a jitter effect. It happens that one callback is delayed,
     // in this case the second one fires two times and then the first one fires two
-    // time as well to catch up. This is also fixed by the additional buffers. If this
-    // happens just after an regular overtake, we will have clicks again.
-    //
-    // I the tests it turns out that it only happens in the opposite direction, so
-    // 3 chunks are just fine.
+    // time as well to catch up. This is fixed by a small reserve in the FIFOs.
 
     if (m_inputParams.channelCount) {
-        int inChunkSize = framesPerBuffer * m_inputParams.channelCount;
-        int readAvailable = m_inputFifo->readAvailable();
-        int writeAvailable = m_inputFifo->writeAvailable();
-        if (readAvailable < inChunkSize * kDriftReserve) {
-            // risk of an underflow, duplicate one frame
-            m_inputFifo->write(in, inChunkSize);
-            if (m_inputDrift) {
-                // Do not compensate the first delay, because it is likely a jitter
-                // corrected in the next cycle
-                // Duplicate one frame
-                m_inputFifo->write(
-                        &in[inChunkSize - m_inputParams.channelCount],
-                        m_inputParams.channelCount);
-                //qDebug() << "callbackProcessDrift write:" << (float)readAvailable / inChunkSize << "Skip";
-            } else {
-                m_inputDrift = true;
-                //qDebug() << "callbackProcessDrift write:" << (float)readAvailable / inChunkSize << "Jitter Skip";
-            }
-        } else if (readAvailable == inChunkSize * kDriftReserve) {
-            // Everything Ok
-            m_inputFifo->write(in, inChunkSize);
-            m_inputDrift = false;
-            //qDebug() << "callbackProcess write:" << (float) readAvailable / inChunkSize << "Normal";
-        } else if (writeAvailable >= inChunkSize) {
-            // Risk of overflow, skip one frame
-            if (m_inputDrift) {
-                m_inputFifo->write(in, inChunkSize - m_inputParams.channelCount);
-                //qDebug() << "callbackProcessDrift write:" << (float)readAvailable / inChunkSize << "Skip";
-            } else {
-                m_inputFifo->write(in, inChunkSize);
-                m_inputDrift = true;
-                //qDebug() << "callbackProcessDrift write:" << (float)readAvailable / inChunkSize << "Jitter Skip";
-            }
-        } else if (writeAvailable) {
+        if (!m_pInputDriftCompensator->writeInput(m_inputFifo,
+                    in,
+                    framesPerBuffer,
+                    clkRefPhase(m_clkRefInputFifoReadNanos, framesPerBuffer))) {
             // Fifo Overflow
-            m_inputFifo->write(in, writeAvailable);
             m_pSoundManager->underflowHappened(8);
-            //qDebug() << "callbackProcessDrift write:" << (float) readAvailable / inChunkSize << "Overflow";
-        } else {
-            // Buffer full
-            m_pSoundManager->underflowHappened(9);
-            //qDebug() << "callbackProcessDrift write:" << (float) readAvailable / inChunkSize << "Buffer full";
+            //qDebug() << "callbackProcessDrift write:" << "Overflow";
         }
     }
 
     if (m_outputParams.channelCount) {
-        int outChunkSize = framesPerBuffer * m_outputParams.channelCount;
-        int readAvailable = m_outputFifo->readAvailable();
-
-        if (readAvailable > outChunkSize * (kDriftReserve + 1)) {
-            m_outputFifo->read(out, outChunkSize);
-            if (m_outputDrift) {
-                // Risk of overflow, skip one frame
-                m_outputFifo->releaseReadRegions(m_outputParams.channelCount);
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Skip";
-            } else {
-                m_outputDrift = true;
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Jitter Skip";
-            }
-        } else if (readAvailable == outChunkSize * (kDriftReserve + 1)) {
-            m_outputFifo->read(out, outChunkSize);
-            m_outputDrift = false;
-            //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Normal";
-        } else if (readAvailable >= outChunkSize) {
-            if (m_outputDrift) {
-                // Risk of underflow, duplicate one frame
-                m_outputFifo->read(out,
-                        outChunkSize - m_outputParams.channelCount);
-                SampleUtil::copy(
-                        &out[outChunkSize - m_outputParams.channelCount],
-                        &out[outChunkSize - (2 * m_outputParams.channelCount)],
-                        m_outputParams.channelCount);
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Save";
-            } else {
-                m_outputFifo->read(out, outChunkSize);
-                m_outputDrift = true;
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Jitter Save";
-            }
-        } else if (readAvailable) {
-            m_outputFifo->read(out,
-                    readAvailable);
+        if (!m_pOutputDriftCompensator->readOutput(m_outputFifo,
+                    out,
+                    framesPerBuffer,
+                    clkRefPhase(m_clkRefOutputFifoWriteNanos, framesPerBuffer))) {
             // underflow
-            SampleUtil::clear(&out[readAvailable],
-                    outChunkSize - readAvailable);
             m_pSoundManager->underflowHappened(10);
-            //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Underflow";
-        } else {
-            // underflow
-            SampleUtil::clear(out, outChunkSize);
-            m_pSoundManager->underflowHappened(11);
-            //qDebug() << "callbackProcess read:" << (float)readAvailable / outChunkSize << "Buffer empty";
+            //qDebug() << "callbackProcessDrift read:" << "Underflow";
         }
-     }
+    }
     return paContinue;
 }
 
+double SoundDevicePortAudio::clkRefPhase(
+        const std::atomic<qint64>& clkRefAccessNanos,
+        const SINT framesPerBuffer) const {
+    const double elapsedSecs =
+            (mixxx::Time::elapsed().toIntegerNanos() -
+                    clkRefAccessNanos.load(std::memory_order_relaxed)) /
+            1e9;
+    // The Clock Reference device accesses the FIFO once per period. The
+    // phase exceeds 1 if its callback is late or has not been called yet,
+    // and might be slightly negative if it accesses the FIFO concurrently.
+    // The fill level doesn't change until the next access in both cases.
+    return math_clamp(elapsedSecs * m_dSampleRate / framesPerBuffer, 0.0, 1.0);
+}
+
 int SoundDevicePortAudio::callbackProcess(const SINT framesPerBuffer,
         CSAMPLE *out, const CSAMPLE *in,
         const PaStreamCallbackTimeInfo *timeInfo,
@@ -875,6 +833,7 @@ int SoundDevicePortAudio::callbackProcessClkRef(
     if (!m_bSetThreadPriority) {
         QThread::currentThread()->setPriority(QThread::TimeCriticalPriority);
         m_bSetThreadPriority = true;
+        ControlChangeJournal::registerGuiJournalThread();
 
 
 #ifdef __SSE__
@@ -3,8 +3,11 @@
 #include <portaudio.h>
 
 #include <QString>
+#include <atomic>
+#include <memory>
 
 #include "control/pollingcontrolproxy.h"
+#include "soundio/driftcompensator.h"
 #include "soundio/sounddevice.h"
 #include "util/duration.h"
 #include "util/performancetimer.h"
@@ -53,6 +56,10 @@ class SoundDevicePortAudio : public SoundDevice {
   private:
     void updateCallbackEntryToDacTime(const PaStreamCallbackTimeInfo* timeInfo);
     void updateAudioLatencyUsage(const SINT framesPerBuffer);
+    /// The elapsed fraction of the Clock Reference period since the
+    /// Clock Reference device has accessed a FIFO.
+    double clkRefPhase(const std::atomic<qint64>& clkRefAccessNanos,
+            const SINT framesPerBuffer) const;
 
     // PortAudio stream for this device.
     PaStream* volatile m_pStream;
@@ -66,8 +73,15 @@ class SoundDevicePortAudio : public SoundDevice {
     PaStreamParameters m_inputParams;
     FIFO<CSAMPLE>* m_outputFifo;
     FIFO<CSAMPLE>* m_inputFifo;
+    // Only used with the "Experimental (no delay)" mode, which still
+    // drops or duplicates single frames in readProcess() and writeProcess()
     bool m_outputDrift;
     bool m_inputDrift;
+    // Only used with the "Default (long delay)" drift correction
+    std::unique_ptr<DriftCompensator> m_pOutputDriftCompensator;
+    std::unique_ptr<DriftCompensator> m_pInputDriftCompensator;
+    std::atomic<qint64> m_clkRefOutputFifoWriteNanos;
+    std::atomic<qint64> m_clkRefInputFifoReadNanos;
 
     // A string describing the last PortAudio error to occur.
     QString m_lastError;
@@ -0,0 +1,231 @@
+#include "sources/seekindex.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+
+#include "util/cache.h"
+#include "util/fileinfo.h"
+#include "util/logger.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("SeekIndex");
+
+constexpr quint32 kMagic = 0x4d585349; // "MXSI"
+constexpr quint32 kVersion = 1;
+
+const QString kFileSuffix = QStringLiteral(".seek");
+
+// Only written once during startup before any sources are opened
+QString s_storageDirectory;
+
+QString filePathForFile(const FileInfo& fileInfo, const QString& decoderName) {
+    const cache_key_t cacheKey = cacheKeyFromFileInfo(fileInfo);
+    return QDir(s_storageDirectory)
+            .absoluteFilePath(
+                    QString::number(cacheKey, 16).rightJustified(16, '0') +
+                    QChar('.') + decoderName + kFileSuffix);
+}
+
+} // anonymous namespace
+
+// static
+void SeekIndex::setStorageDirectory(const QString& directoryPath) {
+    s_storageDirectory = directoryPath;
+}
+
+// static
+QString SeekIndex::storageDirectory() {
+    return s_storageDirectory;
+}
+
+// static
+void SeekIndex::prune(qint64 maxStorageSize) {
+    if (s_storageDirectory.isEmpty()) {
+        return;
+    }
+    QFileInfoList fileInfos = QDir(s_storageDirectory)
+                                      .entryInfoList(QStringList{QChar('*') + kFileSuffix},
+                                              QDir::Files);
+    qint64 storageSize = 0;
+    for (const auto& fileInfo : std::as_const(fileInfos)) {
+        storageSize += fileInfo.size();
+    }
+    if (storageSize <= maxStorageSize) {
+        return;
+    }
+    // The cache key changes whenever a file is modified and the indexes of
+    // removed tracks are never requested again. The key of a missing file
+    // is unknown, so they cannot be removed along with the track. Removes
+    // the least recently stored indexes first, they are stored again when
+    // needed.
+    std::sort(fileInfos.begin(),
+            fileInfos.end(),
+            [](const QFileInfo& lhs, const QFileInfo& rhs) {
+                return lhs.lastModified() < rhs.lastModified();
+            });
+    int removedCount = 0;
+    for (const auto& fileInfo : std::as_const(fileInfos)) {
+        if (storageSize <= maxStorageSize) {
+            break;
+        }
+        if (QFile::remove(fileInfo.absoluteFilePath())) {
+            storageSize -= fileInfo.size();
+            ++removedCount;
+        }
+    }
+    kLogger.info()
+            << "Removed"
+            << removedCount
+            << "seek indexes";
+}
+
+void SeekIndex::clear() {
+    m_seekPoints.clear();
+    m_channelCount = audio::ChannelCount();
+    m_sampleRate = audio::SampleRate();
+    m_bitrate = audio::Bitrate();
+}
+
+bool SeekIndex::isValid(qint64 fileSize) const {
+    // At least a single frame followed by the end of the stream
+    if (m_seekPoints.size() < 2 ||
+            m_seekPoints.front().frameIndex != 0 ||
+            m_seekPoints.front().byteOffset < 0 ||
+            m_seekPoints.back().byteOffset > fileSize) {
+        return false;
+    }
+    for (std::size_t i = 1; i < m_seekPoints.size(); ++i) {
+        if (m_seekPoints[i].frameIndex <= m_seekPoints[i - 1].frameIndex ||
+                m_seekPoints[i].byteOffset <= m_seekPoints[i - 1].byteOffset) {
+            return false;
+        }
+    }
+    return m_channelCount.isValid() && m_sampleRate.isValid();
+}
+
+QByteArray SeekIndex::serialize() const {
+    // Consecutive frames usually differ by the same number of samples
+    // and similar sizes. Encoding the differences makes them compress
+    // very well.
+    QByteArray seekPointData;
+    {
+        QDataStream stream(&seekPointData, QIODevice::WriteOnly);
+        SeekPoint previous{0, 0};
+        for (const auto& seekPoint : m_seekPoints) {
+            stream << static_cast<quint32>(seekPoint.frameIndex - previous.frameIndex)
+                   << static_cast<quint32>(seekPoint.byteOffset - previous.byteOffset);
+            previous = seekPoint;
+        }
+    }
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << kMagic
+           << kVersion
+           << static_cast<quint32>(m_channelCount.value())
+           << static_cast<quint32>(m_sampleRate.value())
+           << static_cast<quint32>(m_bitrate.value())
+           << static_cast<quint32>(m_seekPoints.size())
+           << qCompress(seekPointData);
+    return data;
+}
+
+bool SeekIndex::deserialize(const QByteArray& data) {
+    clear();
+    QDataStream stream(data);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != kMagic || version != kVersion) {
+        return false;
+    }
+    quint32 channelCount = 0;
+    quint32 sampleRate = 0;
+    quint32 bitrate = 0;
+    quint32 seekPointCount = 0;
+    QByteArray compressedSeekPointData;
+    stream >> channelCount >> sampleRate >> bitrate >> seekPointCount >>
+            compressedSeekPointData;
+    if (stream.status() != QDataStream::Ok ||
+            channelCount > audio::ChannelCount::max().value()) {
+        return false;
+    }
+    const QByteArray seekPointData = qUncompress(compressedSeekPointData);
+    if (seekPointData.size() !=
+            static_cast<qint64>(seekPointCount) * 2 * sizeof(quint32)) {
+        return false;
+    }
+    m_channelCount = audio::ChannelCount(
+            static_cast<audio::ChannelCount::value_t>(channelCount));
+    m_sampleRate = audio::SampleRate(sampleRate);
+    m_bitrate = audio::Bitrate(bitrate);
+
+    QDataStream seekPointStream(seekPointData);
+    m_seekPoints.reserve(seekPointCount);
+    SeekPoint seekPoint{0, 0};
+    for (quint32 i = 0; i < seekPointCount; ++i) {
+        quint32 frameDelta = 0;
+        quint32 byteDelta = 0;
+        seekPointStream >> frameDelta >> byteDelta;
+        seekPoint.frameIndex += frameDelta;
+        seekPoint.byteOffset += byteDelta;
+        m_seekPoints.push_back(seekPoint);
+    }
+    return true;
+}
+
+bool SeekIndex::load(const FileInfo& fileInfo, const QString& decoderName) {
+    clear();
+    if (s_storageDirectory.isEmpty()) {
+        return false;
+    }
+    QFile file(filePathForFile(fileInfo, decoderName));
+    if (!file.open(QIODevice::ReadOnly)) {
+        // Not stored yet
+        return false;
+    }
+    if (!deserialize(file.readAll()) || !isValid(fileInfo.sizeInBytes())) {
+        kLogger.warning()
+                << "Discarding invalid seek index"
+                << file.fileName();
+        clear();
+        file.remove();
+        return false;
+    }
+    return true;
+}
+
+bool SeekIndex::save(const FileInfo& fileInfo, const QString& decoderName) const {
+    if (s_storageDirectory.isEmpty()) {
+        return false;
+    }
+    DEBUG_ASSERT(isValid(fileInfo.sizeInBytes()));
+    if (!QDir().mkpath(s_storageDirectory)) {
+        kLogger.warning()
+                << "Failed to create directory"
+                << s_storageDirectory;
+        return false;
+    }
+    // Other threads might load the same index concurrently and must
+    // never see a partially written file
+    QSaveFile file(filePathForFile(fileInfo, decoderName));
+    if (!file.open(QIODevice::WriteOnly) ||
+            file.write(serialize()) < 0 ||
+            !file.commit()) {
+        kLogger.warning()
+                << "Failed to save seek index"
+                << file.fileName()
+                << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace mixxx
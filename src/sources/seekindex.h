@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <vector>
+
+#include "audio/types.h"
+#include "util/types.h"
+
+namespace mixxx {
+
+class FileInfo;
+
+/// The positions of the compressed frames of an audio file that a
+/// decoder needs for sample accurate seeking.
+///
+/// Building the index requires parsing the whole file. It is stored in
+/// a small sidecar file next to the analysis data, keyed by the cache key
+/// of the file, and reused when the same file is opened again.
+class SeekIndex final {
+  public:
+    struct SeekPoint {
+        SINT frameIndex;
+        /// The offset of the compressed frame in the file
+        qint64 byteOffset;
+    };
+
+    /// Several 1000 indexes of variable bitrate files
+    static constexpr qint64 kMaxStorageSize = 64 * 1024 * 1024;
+
+    /// Seek indexes are only stored if a directory has been set. This
+    /// function is not thread-safe and must be called only once upon
+    /// startup of the application.
+    static void setStorageDirectory(const QString& directoryPath);
+    static QString storageDirectory();
+
+    /// Removes the least recently stored indexes until the size of the
+    /// stored files does not exceed maxStorageSize. Reads all directory
+    /// entries and should not be called on the GUI thread.
+    static void prune(qint64 maxStorageSize = kMaxStorageSize);
+
+    SeekIndex() = default;
+
+    void clear();
+
+    void reserve(std::size_t capacity) {
+        m_seekPoints.reserve(capacity);
+    }
+
+    /// Both the frame index and the byte offset must increase.
+    void append(SINT frameIndex, qint64 byteOffset) {
+        m_seekPoints.push_back(SeekPoint{frameIndex, byteOffset});
+    }
+
+    /// Ordered by frame index. The last seek point marks the end of
+    /// the stream.
+    const std::vector<SeekPoint>& seekPoints() const {
+        return m_seekPoints;
+    }
+
+    /// The properties of the stream that have been collected while
+    /// building the index, because they would require the same scan.
+    audio::ChannelCount getChannelCount() const {
+        return m_channelCount;
+    }
+    void setChannelCount(audio::ChannelCount channelCount) {
+        m_channelCount = channelCount;
+    }
+    audio::SampleRate getSampleRate() const {
+        return m_sampleRate;
+    }
+    void setSampleRate(audio::SampleRate sampleRate) {
+        m_sampleRate = sampleRate;
+    }
+    audio::Bitrate getBitrate() const {
+        return m_bitrate;
+    }
+    void setBitrate(audio::Bitrate bitrate) {
+        m_bitrate = bitrate;
+    }
+
+    /// Checks that the index starts at the first frame, that the seek
+    /// points are strictly ordered, and that all offsets are within a
+    /// file of the given size.
+    bool isValid(qint64 fileSize) const;
+
+    /// Loads the index that the decoder has stored for the file in its
+    /// current state. Returns false if no valid index is available.
+    bool load(const FileInfo& fileInfo, const QString& decoderName);
+    bool save(const FileInfo& fileInfo, const QString& decoderName) const;
+
+    QByteArray serialize() const;
+    bool deserialize(const QByteArray& data);
+
+  private:
+    std::vector<SeekPoint> m_seekPoints;
+    audio::ChannelCount m_channelCount;
+    audio::SampleRate m_sampleRate;
+    audio::Bitrate m_bitrate;
+};
+
+} // namespace mixxx
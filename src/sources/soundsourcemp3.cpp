@@ -1,6 +1,8 @@
 #include "sources/soundsourcemp3.h"
 #include "sources/mp3decoding.h"
+#include "sources/seekindex.h"
 
+#include "util/fileinfo.h"
 #include "util/logger.h"
 #include "util/math.h"
 
@@ -12,6 +14,8 @@ namespace {
 
 const Logger kLogger("SoundSourceMp3");
 
+const QString kSeekIndexDecoderName = QStringLiteral("mad");
+
 // MP3 does only support 1 or 2 channels
 constexpr SINT kChannelCountMax = 2;
 
@@ -225,6 +229,29 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     mad_stream_buffer(&m_madStream, m_pFileData, m_fileSize);
     DEBUG_ASSERT(m_pFileData == m_madStream.this_frame);
 
+    DEBUG_ASSERT(m_seekFrameList.empty());
+    if (!loadSeekIndex()) {
+        const OpenResult result = scanSeekFrames();
+        if (result != OpenResult::Succeeded) {
+            return result;
+        }
+        saveSeekIndex();
+    }
+    DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
+
+    // Restart decoding at the beginning of the audio stream
+    restartDecoding(m_seekFrameList.front());
+
+    if (m_curFrameIndex != frameIndexMin()) {
+        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
+        // Abort
+        return OpenResult::Failed;
+    }
+
+    return OpenResult::Succeeded;
+}
+
+SoundSource::OpenResult SoundSourceMp3::scanSeekFrames() {
     DEBUG_ASSERT(m_seekFrameList.empty());
     m_avgSeekFrameCount = 0;
     m_curFrameIndex = 0;
@@ -402,18 +429,57 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
 
     // Terminate m_seekFrameList
     addSeekFrame(m_curFrameIndex, nullptr);
-    DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
 
-    // Restart decoding at the beginning of the audio stream
-    restartDecoding(m_seekFrameList.front());
+    return OpenResult::Succeeded;
+}
 
-    if (m_curFrameIndex != frameIndexMin()) {
-        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
-        // Abort
-        return OpenResult::Failed;
+bool SoundSourceMp3::loadSeekIndex() {
+    SeekIndex seekIndex;
+    if (!seekIndex.load(FileInfo(m_file), kSeekIndexDecoderName)) {
+        return false;
+    }
+    const auto& seekPoints = seekIndex.seekPoints();
+    const auto frameIndexEnd = seekPoints.back().frameIndex;
+    if (seekPoints.back().byteOffset != static_cast<qint64>(m_fileSize) ||
+            seekIndex.getChannelCount() > kChannelCountMax ||
+            getIndexBySampleRate(seekIndex.getSampleRate()) >= kSampleRateCount) {
+        kLogger.warning()
+                << "Ignoring mismatching seek index for"
+                << m_file.fileName();
+        return false;
     }
 
-    return OpenResult::Succeeded;
+    DEBUG_ASSERT(m_seekFrameList.empty());
+    for (auto it = seekPoints.begin(); it != seekPoints.end() - 1; ++it) {
+        addSeekFrame(it->frameIndex, m_pFileData + it->byteOffset);
+    }
+    addSeekFrame(frameIndexEnd, nullptr);
+
+    initChannelCountOnce(seekIndex.getChannelCount());
+    initSampleRateOnce(seekIndex.getSampleRate());
+    initFrameIndexRangeOnce(IndexRange::forward(0, frameIndexEnd));
+    if (seekIndex.getBitrate().isValid()) {
+        initBitrateOnce(seekIndex.getBitrate());
+    }
+    m_avgSeekFrameCount = frameLength() / static_cast<SINT>(m_seekFrameList.size() - 1);
+    return true;
+}
+
+void SoundSourceMp3::saveSeekIndex() const {
+    if (SeekIndex::storageDirectory().isEmpty()) {
+        return;
+    }
+    SeekIndex seekIndex;
+    seekIndex.reserve(m_seekFrameList.size());
+    for (const auto& seekFrame : m_seekFrameList) {
+        seekIndex.append(seekFrame.frameIndex,
+                seekFrame.pInputData ? seekFrame.pInputData - m_pFileData
+                                     : static_cast<qint64>(m_fileSize));
+    }
+    seekIndex.setChannelCount(getSignalInfo().getChannelCount());
+    seekIndex.setSampleRate(getSignalInfo().getSampleRate());
+    seekIndex.setBitrate(getBitrate());
+    seekIndex.save(FileInfo(m_file), kSeekIndexDecoderName);
 }
 
 void SoundSourceMp3::close() {
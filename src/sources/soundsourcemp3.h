@@ -53,6 +53,15 @@ class SoundSourceMp3 final : public SoundSource {
 
     void addSeekFrame(SINT frameIndex, const unsigned char* pInputData);
 
+    /// Parses all frame headers of the file to build m_seekFrameList
+    /// and to determine the properties of the stream.
+    OpenResult scanSeekFrames();
+
+    /// Restores m_seekFrameList and the properties of the stream from
+    /// a previous scan of the same file to avoid scanning it again.
+    bool loadSeekIndex();
+    void saveSeekIndex() const;
+
     /** Returns the position in m_seekFrameList of the requested frame index. */
     SINT findSeekFrameIndex(SINT frameIndex) const;
 
@@ -5,6 +5,7 @@
 #include <QMimeType>
 #include <QRegularExpression>
 #include <QStandardPaths>
+#include <tuple>
 
 #include "sources/audiosourcetrackproxy.h"
 
@@ -572,6 +573,49 @@ SoundSourceProxy::importTrackMetadataAndCoverImageFromFile(
             resetMissingTagMetadata);
 }
 
+//static
+ImportedTrackMetadata SoundSourceProxy::importTrackMetadataForNewTrack(
+        mixxx::FileAccess trackFileAccess,
+        const SyncTrackMetadataParams& syncParams,
+        CoverInfoGuesser* pCoverInfoGuesser) {
+    DEBUG_ASSERT(pCoverInfoGuesser);
+    ImportedTrackMetadata importedMetadata;
+    if (!trackFileAccess.info().checkFileExists()) {
+        return importedMetadata;
+    }
+    {
+        // Release the cached track object after unlocking the cache
+        TrackPointer pCachedTrack;
+        GlobalTrackCacheLocker locker;
+        pCachedTrack = locker.lookupTrackByRef(
+                TrackRef::fromFileInfo(trackFileAccess.info()));
+        if (pCachedTrack) {
+            // The metadata might be exported while reading the file.
+            // Leave the import to updateTrackFromSource().
+            return importedMetadata;
+        }
+    }
+    // The file might still be written after unlocking the cache if a
+    // track object is created and exported in the meantime. In this
+    // case the file has been modified after the synchronization time
+    // stamp and the metadata will be re-imported when needed.
+    const auto pTrack = Track::newTemporary(std::move(trackFileAccess));
+    importedMetadata.trackMetadata = pTrack->getMetadata();
+    QImage coverImg;
+    std::tie(importedMetadata.importResult, importedMetadata.sourceSynchronizedAt) =
+            SoundSourceProxy(pTrack).importTrackMetadataAndCoverImage(
+                    &importedMetadata.trackMetadata,
+                    &coverImg,
+                    syncParams.resetMissingTagMetadataOnImport);
+    if (importedMetadata.importResult == mixxx::MetadataSource::ImportResult::Succeeded) {
+        importedMetadata.coverInfo = pCoverInfoGuesser->guessCoverInfo(
+                pTrack->getFileInfo(),
+                importedMetadata.trackMetadata.getAlbumInfo().getTitle(),
+                coverImg);
+    }
+    return importedMetadata;
+}
+
 std::pair<mixxx::MetadataSource::ImportResult, QDateTime>
 SoundSourceProxy::importTrackMetadataAndCoverImage(
         mixxx::TrackMetadata* pTrackMetadata,
@@ -617,7 +661,8 @@ inline bool shouldImportSeratoTagsFromSource(
 
 SoundSourceProxy::UpdateTrackFromSourceResult SoundSourceProxy::updateTrackFromSource(
         UpdateTrackFromSourceMode mode,
-        const SyncTrackMetadataParams& syncParams) {
+        const SyncTrackMetadataParams& syncParams,
+        const ImportedTrackMetadata* pImportedMetadata) {
     DEBUG_ASSERT(m_pTrack);
 
     if (getUrl().isEmpty()) {
@@ -687,13 +732,30 @@ SoundSourceProxy::UpdateTrackFromSourceResult SoundSourceProxy::updateTrackFromS
         }
     }
 
+    // Metadata that has been imported in advance is only applicable
+    // when initializing a new track object, i.e. if it has been imported
+    // starting from the same (empty) metadata.
+    const bool useImportedMetadata = pImportedMetadata &&
+            pImportedMetadata->importResult !=
+                    mixxx::MetadataSource::ImportResult::Unavailable &&
+            sourceSyncStatus == mixxx::TrackRecord::SourceSyncStatus::Void &&
+            pCoverImg;
+
     // Parse the tags stored in the audio file and the date and time when the
     // file has been last modified to detect future changes of the tags.
-    auto [metadataImportResult, sourceSynchronizedAt] =
-            importTrackMetadataAndCoverImage(
-                    &trackMetadata,
-                    pCoverImg,
-                    syncParams.resetMissingTagMetadataOnImport);
+    std::pair<mixxx::MetadataSource::ImportResult, QDateTime> importResult;
+    if (useImportedMetadata) {
+        trackMetadata = pImportedMetadata->trackMetadata;
+        importResult = std::make_pair(
+                pImportedMetadata->importResult,
+                pImportedMetadata->sourceSynchronizedAt);
+    } else {
+        importResult = importTrackMetadataAndCoverImage(
+                &trackMetadata,
+                pCoverImg,
+                syncParams.resetMissingTagMetadataOnImport);
+    }
+    auto [metadataImportResult, sourceSynchronizedAt] = importResult;
     VERIFY_OR_DEBUG_ASSERT(!sourceSynchronizedAt.isValid() ||
             sourceSynchronizedAt.timeSpec() == Qt::UTC) {
         qWarning() << "Converting source synchronization time to UTC:" << sourceSynchronizedAt;
@@ -843,11 +905,12 @@ SoundSourceProxy::UpdateTrackFromSourceResult SoundSourceProxy::updateTrackFromS
 
     if (pCoverImg) {
         // If the pointer is not null then the cover art should be guessed
-        auto coverInfo =
-                CoverInfoGuesser().guessCoverInfo(
-                        m_pTrack->getFileInfo(),
-                        m_pTrack->getAlbum(),
-                        *pCoverImg);
+        auto coverInfo = useImportedMetadata
+                ? pImportedMetadata->coverInfo
+                : CoverInfoGuesser().guessCoverInfo(
+                          m_pTrack->getFileInfo(),
+                          m_pTrack->getAlbum(),
+                          *pCoverImg);
         DEBUG_ASSERT(coverInfo.source == CoverInfo::GUESSED);
         m_pTrack->setCoverInfo(coverInfo);
     }
@@ -2,16 +2,30 @@
 
 #include <QMimeType>
 
+#include "library/coverart.h"
 #include "sources/soundsourceproviderregistry.h"
 #include "track/track_decl.h"
 #include "util/sandbox.h"
 
+class CoverInfoGuesser;
+
 namespace mixxx {
 
 class FileAccess;
 
 } // namespace mixxx
 
+/// Track metadata and cover art that have been imported from a file
+/// in advance, i.e. before the corresponding track object is updated
+/// by SoundSourceProxy::updateTrackFromSource().
+struct ImportedTrackMetadata {
+    mixxx::MetadataSource::ImportResult importResult =
+            mixxx::MetadataSource::ImportResult::Unavailable;
+    QDateTime sourceSynchronizedAt;
+    mixxx::TrackMetadata trackMetadata;
+    CoverInfoRelative coverInfo;
+};
+
 /// Creates sound sources for tracks. Only intended to be used
 /// in a narrow scope and not shareable between multiple threads!
 class SoundSourceProxy {
@@ -105,6 +119,25 @@ class SoundSourceProxy {
             QImage* pCoverImage,
             bool resetMissingTagMetadata);
 
+    /// Import track metadata and guess the cover art of a file that
+    /// is about to be added to the library.
+    ///
+    /// The result is only applicable for initializing a new track object
+    /// from the file, see updateTrackFromSource(). Unlike
+    /// importTrackMetadataAndCoverImageFromFile() the GlobalTrackCache is
+    /// not kept locked while reading the file. This allows to import many
+    /// files concurrently, e.g. by the library scanner. If the file is
+    /// already referenced by a cached track object that might export its
+    /// metadata concurrently nothing is imported and the result is
+    /// ImportResult::Unavailable.
+    ///
+    /// The cover info guesser caches the list of image files in the
+    /// folder of the last track and must not be shared between threads.
+    static ImportedTrackMetadata importTrackMetadataForNewTrack(
+            mixxx::FileAccess trackFileAccess,
+            const SyncTrackMetadataParams& syncParams,
+            CoverInfoGuesser* pCoverInfoGuesser);
+
     /// Import both track metadata and/or the cover image of the
     /// captured track object from the corresponding file.
     ///
@@ -172,10 +205,16 @@ class SoundSourceProxy {
     /// properly. The application log will contain warning messages for a detailed
     /// analysis in case unexpected behavior has been reported.
     ///
+    /// Metadata that has been imported in advance by
+    /// importTrackMetadataForNewTrack() is used instead of reading
+    /// the file again when initializing a new track object. It is
+    /// ignored otherwise.
+    ///
     /// Returns true if the track has been modified and false otherwise.
     UpdateTrackFromSourceResult updateTrackFromSource(
             UpdateTrackFromSourceMode mode,
-            const SyncTrackMetadataParams& syncParams);
+            const SyncTrackMetadataParams& syncParams,
+            const ImportedTrackMetadata* pImportedMetadata = nullptr);
 
     /// Opening the audio source through the proxy will update the
     /// audio properties of the corresponding track object. Returns
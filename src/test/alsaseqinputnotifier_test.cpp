@@ -0,0 +1,107 @@
+#include "controllers/midi/alsaseqinputnotifier.h"
+
+#include <gtest/gtest.h>
+
+#include <QElapsedTimer>
+#include <memory>
+
+#include "test/mixxxtest.h"
+#include "util/time.h"
+
+namespace {
+
+const QString kPortName = QStringLiteral("Mixxx Test Controller Output");
+
+/// Plays the role of a MIDI controller with a sequencer client that sends
+/// events on a readable port.
+class AlsaSeqInputNotifierTest : public MixxxTest {
+  protected:
+    AlsaSeqInputNotifierTest()
+            : m_pSeq(nullptr),
+              m_port(-1),
+              m_inputCount(0) {
+    }
+
+    void SetUp() override {
+        m_pNotifier = std::make_unique<AlsaSeqInputNotifier>();
+        if (!m_pNotifier->isValid() ||
+                snd_seq_open(&m_pSeq, "default", SND_SEQ_OPEN_OUTPUT, 0) < 0) {
+            m_pSeq = nullptr;
+            GTEST_SKIP() << "The ALSA sequencer is not available";
+        }
+        snd_seq_set_client_name(m_pSeq, "Mixxx Test Controller");
+        m_port = snd_seq_create_simple_port(m_pSeq,
+                kPortName.toLocal8Bit().constData(),
+                SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ,
+                SND_SEQ_PORT_TYPE_MIDI_GENERIC);
+        ASSERT_GE(m_port, 0);
+
+        QObject::connect(m_pNotifier.get(),
+                &AlsaSeqInputNotifier::inputReceived,
+                [this](mixxx::Duration receivedAt) {
+                    ++m_inputCount;
+                    m_receivedAt = receivedAt;
+                });
+    }
+
+    void TearDown() override {
+        m_pNotifier.reset();
+        if (m_pSeq) {
+            snd_seq_close(m_pSeq);
+        }
+    }
+
+    void sendNoteOn() {
+        snd_seq_event_t event;
+        snd_seq_ev_clear(&event);
+        snd_seq_ev_set_source(&event, m_port);
+        snd_seq_ev_set_subs(&event);
+        snd_seq_ev_set_direct(&event);
+        snd_seq_ev_set_noteon(&event, 0, 60, 127);
+        ASSERT_GE(snd_seq_event_output_direct(m_pSeq, &event), 0);
+    }
+
+    /// Processes events until the notifier has emitted inputReceived or
+    /// the timeout has expired
+    void processEvents(int timeoutMillis) {
+        QElapsedTimer timer;
+        timer.start();
+        while (m_inputCount == 0 && timer.elapsed() < timeoutMillis) {
+            application()->processEvents(QEventLoop::AllEvents, 10);
+        }
+    }
+
+    std::unique_ptr<AlsaSeqInputNotifier> m_pNotifier;
+    snd_seq_t* m_pSeq;
+    int m_port;
+    int m_inputCount;
+    mixxx::Duration m_receivedAt;
+};
+
+TEST_F(AlsaSeqInputNotifierTest, WatchesPortsByName) {
+    const QSet<QString> watchedPortNames = m_pNotifier->setWatchedPorts(
+            {kPortName, QStringLiteral("Mixxx Test Nonexistent Port")});
+    EXPECT_EQ(QSet<QString>{kPortName}, watchedPortNames);
+
+    EXPECT_TRUE(m_pNotifier->setWatchedPorts({}).isEmpty());
+}
+
+TEST_F(AlsaSeqInputNotifierTest, InputReceived) {
+    ASSERT_FALSE(m_pNotifier->setWatchedPorts({kPortName}).isEmpty());
+
+    sendNoteOn();
+    processEvents(1000);
+    EXPECT_EQ(1, m_inputCount);
+    EXPECT_LE(m_receivedAt, mixxx::Time::elapsed());
+}
+
+TEST_F(AlsaSeqInputNotifierTest, UnwatchedPortIsIgnored) {
+    ASSERT_FALSE(m_pNotifier->setWatchedPorts({kPortName}).isEmpty());
+    m_pNotifier->setWatchedPorts({});
+
+    sendNoteOn();
+    processEvents(100);
+    EXPECT_EQ(0, m_inputCount);
+}
+
+} // namespace
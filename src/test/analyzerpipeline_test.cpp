@@ -0,0 +1,229 @@
+#include "analyzer/analyzerpipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <algorithm>
+
+#include "analyzer/constants.h"
+#include "analyzer/trackanalysisautoscaler.h"
+
+namespace {
+
+// Expects chunks that are filled with their consecutive number
+class ChunkCountingAnalyzer : public Analyzer {
+  public:
+    struct Result {
+        int chunkCount = 0;
+        int outOfOrderCount = 0;
+        Qt::HANDLE threadId = nullptr;
+        bool stored = false;
+    };
+
+    ChunkCountingAnalyzer(Result* pResult, bool initialize, int failAfterChunks = -1)
+            : m_pResult(pResult),
+              m_initialize(initialize),
+              m_failAfterChunks(failAfterChunks) {
+    }
+
+    bool initialize(TrackPointer, mixxx::audio::SampleRate, int) override {
+        *m_pResult = Result();
+        return m_initialize;
+    }
+
+    bool processSamples(const CSAMPLE* pIn, const int iLen) override {
+        if (iLen <= 0 || pIn[0] != m_pResult->chunkCount || pIn[iLen - 1] != pIn[0]) {
+            ++m_pResult->outOfOrderCount;
+        }
+        ++m_pResult->chunkCount;
+        m_pResult->threadId = QThread::currentThreadId();
+        return m_pResult->chunkCount != m_failAfterChunks;
+    }
+
+    void storeResults(TrackPointer) override {
+        m_pResult->stored = true;
+    }
+
+    void cleanup() override {
+    }
+
+  private:
+    Result* const m_pResult;
+    const bool m_initialize;
+    const int m_failAfterChunks;
+};
+
+class AnalyzerPipelineTest : public testing::Test {
+  protected:
+    void addAnalyzer(bool initialize, int failAfterChunks = -1) {
+        m_results.push_back(std::make_unique<ChunkCountingAnalyzer::Result>());
+        m_analyzers.emplace_back(std::make_unique<ChunkCountingAnalyzer>(
+                m_results.back().get(), initialize, failAfterChunks));
+    }
+
+    void initializeAnalyzers() {
+        for (auto&& analyzer : m_analyzers) {
+            analyzer.initialize(TrackPointer(), mixxx::audio::SampleRate(44100), 0);
+        }
+    }
+
+    void finishAnalyzers() {
+        for (auto&& analyzer : m_analyzers) {
+            analyzer.finish(TrackPointer());
+        }
+    }
+
+    // Decodes the chunks like AnalyzerThread
+    void decodeChunks(AnalyzerPipeline* pPipeline, int chunkCount) {
+        for (int i = 0; i < chunkCount; ++i) {
+            const auto buffer = pPipeline->nextChunkBuffer();
+            const SINT sampleCount = i == chunkCount - 1
+                    ? mixxx::kAnalysisSamplesPerChunk / 2
+                    : mixxx::kAnalysisSamplesPerChunk;
+            std::fill(buffer.data(), buffer.data(sampleCount), static_cast<CSAMPLE>(i));
+            pPipeline->processSamples(buffer.data(), sampleCount);
+        }
+    }
+
+    std::vector<std::unique_ptr<ChunkCountingAnalyzer::Result>> m_results;
+    std::vector<AnalyzerWithState> m_analyzers;
+};
+
+TEST_F(AnalyzerPipelineTest, AllChunksReachAllActiveAnalyzers) {
+    addAnalyzer(true);
+    addAnalyzer(false);
+    addAnalyzer(true);
+    addAnalyzer(true, 10);
+    addAnalyzer(true);
+    AnalyzerPipeline pipeline(2);
+
+    for (int track = 0; track < 3; ++track) {
+        initializeAnalyzers();
+        pipeline.assignAnalyzers(&m_analyzers);
+        decodeChunks(&pipeline, 100);
+        pipeline.waitUntilIdle();
+        finishAnalyzers();
+
+        for (std::size_t i = 0; i < m_results.size(); ++i) {
+            const auto& result = *m_results[i];
+            EXPECT_EQ(0, result.outOfOrderCount) << i;
+            EXPECT_NE(QThread::currentThreadId(), result.threadId) << i;
+        }
+        EXPECT_EQ(100, m_results[0]->chunkCount);
+        EXPECT_TRUE(m_results[0]->stored);
+        EXPECT_EQ(0, m_results[1]->chunkCount);
+        EXPECT_FALSE(m_results[1]->stored);
+        EXPECT_EQ(10, m_results[3]->chunkCount);
+        EXPECT_FALSE(m_results[3]->stored);
+        EXPECT_EQ(100, m_results[4]->chunkCount);
+        // Active analyzers are distributed among both stages
+        EXPECT_NE(m_results[0]->threadId, m_results[2]->threadId);
+    }
+}
+
+TEST_F(AnalyzerPipelineTest, FewerAnalyzersThanStages) {
+    addAnalyzer(true);
+    addAnalyzer(false);
+    AnalyzerPipeline pipeline(3);
+
+    initializeAnalyzers();
+    pipeline.assignAnalyzers(&m_analyzers);
+    decodeChunks(&pipeline, 20);
+    pipeline.waitUntilIdle();
+    finishAnalyzers();
+    EXPECT_EQ(20, m_results[0]->chunkCount);
+    EXPECT_EQ(0, m_results[0]->outOfOrderCount);
+
+    // No active analyzer at all
+    pipeline.assignAnalyzers(&m_analyzers);
+    decodeChunks(&pipeline, 20);
+    pipeline.waitUntilIdle();
+}
+
+TEST_F(AnalyzerPipelineTest, DiscardPendingChunks) {
+    addAnalyzer(true);
+    addAnalyzer(true);
+    AnalyzerPipeline pipeline(2);
+
+    initializeAnalyzers();
+    pipeline.assignAnalyzers(&m_analyzers);
+    decodeChunks(&pipeline, 50);
+    // A chunk that has been acquired but not passed on
+    pipeline.nextChunkBuffer();
+    pipeline.waitUntilIdle(true);
+    for (auto&& analyzer : m_analyzers) {
+        analyzer.cancel();
+    }
+    EXPECT_LE(m_results[0]->chunkCount, 50);
+    EXPECT_EQ(0, m_results[0]->outOfOrderCount);
+
+    // The next track starts with the first chunk again
+    initializeAnalyzers();
+    pipeline.assignAnalyzers(&m_analyzers);
+    decodeChunks(&pipeline, 30);
+    pipeline.waitUntilIdle();
+    finishAnalyzers();
+    EXPECT_EQ(30, m_results[0]->chunkCount);
+    EXPECT_EQ(30, m_results[1]->chunkCount);
+    EXPECT_EQ(0, m_results[1]->outOfOrderCount);
+}
+
+class TrackAnalysisAutoscalerTest : public testing::Test {
+  protected:
+    // Finishes tracks of 1 minute with the given throughput in
+    // seconds of audio per second until the worker count changes
+    // or a limit is reached.
+    bool finishTracks(TrackAnalysisAutoscaler* pAutoscaler, double throughput) {
+        for (int i = 0; i < 100; ++i) {
+            m_now += std::chrono::duration_cast<TrackAnalysisAutoscaler::Clock::duration>(
+                    std::chrono::duration<double>(60.0 / throughput));
+            if (pAutoscaler->trackFinished(60.0, m_now)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    TrackAnalysisAutoscaler::Clock::time_point m_now;
+};
+
+TEST_F(TrackAnalysisAutoscalerTest, SingleWorker) {
+    TrackAnalysisAutoscaler autoscaler(1, 8, m_now);
+    EXPECT_TRUE(autoscaler.isSettled());
+    EXPECT_EQ(1, autoscaler.workerCount());
+    EXPECT_EQ(3, autoscaler.pipelineStageCount());
+    EXPECT_FALSE(finishTracks(&autoscaler, 100));
+}
+
+TEST_F(TrackAnalysisAutoscalerTest, ReducesWorkersWhileThroughputHolds) {
+    TrackAnalysisAutoscaler autoscaler(4, 4, m_now);
+    EXPECT_EQ(4, autoscaler.workerCount());
+    EXPECT_EQ(0, autoscaler.pipelineStageCount());
+
+    // Disk bound: Fewer workers are as fast as more workers
+    EXPECT_TRUE(finishTracks(&autoscaler, 200));
+    EXPECT_EQ(3, autoscaler.workerCount());
+    EXPECT_TRUE(finishTracks(&autoscaler, 200));
+    EXPECT_EQ(2, autoscaler.workerCount());
+    EXPECT_EQ(1, autoscaler.pipelineStageCount());
+
+    EXPECT_TRUE(finishTracks(&autoscaler, 200));
+    EXPECT_EQ(1, autoscaler.workerCount());
+    // Slower with a single worker
+    EXPECT_TRUE(finishTracks(&autoscaler, 150));
+    EXPECT_EQ(2, autoscaler.workerCount());
+    EXPECT_TRUE(autoscaler.isSettled());
+    EXPECT_FALSE(finishTracks(&autoscaler, 50));
+    EXPECT_EQ(2, autoscaler.workerCount());
+}
+
+TEST_F(TrackAnalysisAutoscalerTest, KeepsAllWorkersIfCpuBound) {
+    TrackAnalysisAutoscaler autoscaler(8, 8, m_now);
+    EXPECT_TRUE(finishTracks(&autoscaler, 400));
+    EXPECT_EQ(7, autoscaler.workerCount());
+    EXPECT_TRUE(finishTracks(&autoscaler, 350));
+    EXPECT_EQ(8, autoscaler.workerCount());
+    EXPECT_TRUE(autoscaler.isSettled());
+}
+
+} // namespace
@@ -1,6 +1,9 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 
 #include <QtDebug>
+#include <algorithm>
+#include <vector>
 
 #include "audio/types.h"
 #include "track/beats.h"
@@ -537,4 +540,112 @@ TEST(BeatsTest, ConstTempoFindPrevNextBeatWhenNotOnBeat) {
     EXPECT_NEAR(nextBeat.value(), foundNextBeat.value(), kMaxBeatError);
 }
 
+/// Creates a beat map with many short sections of slightly different
+/// tempo, like the beats of a live recording that have been analyzed
+/// without assuming a constant tempo.
+BeatsPointer createBeatMap(int markerCount, std::vector<audio::FramePos>* pBeatPositions) {
+    std::vector<BeatMarker> markers;
+    markers.reserve(markerCount);
+    auto position = kStartPosition;
+    for (int i = 0; i < markerCount; ++i) {
+        const int beatsTillNextMarker = 1 + i % 4;
+        const audio::FrameDiff_t beatLengthFrames = 23000 + (i * 7919) % 2000;
+        markers.emplace_back(position, beatsTillNextMarker);
+        for (int j = 0; j < beatsTillNextMarker; ++j) {
+            pBeatPositions->push_back(position + j * beatLengthFrames);
+        }
+        position += beatsTillNextMarker * beatLengthFrames;
+    }
+    pBeatPositions->push_back(position);
+    return Beats::fromBeatMarkers(kSampleRate, markers, position, kBpm);
+}
+
+TEST(BeatsTest, BeatMapLookupsMatchBeatPositions) {
+    std::vector<audio::FramePos> beatPositions;
+    const auto pBeats = createBeatMap(1000, &beatPositions);
+    constexpr int kMaxN = 8;
+
+    for (int i = kMaxN; i + kMaxN < static_cast<int>(beatPositions.size()); ++i) {
+        const auto beat = beatPositions[i];
+        const auto nextBeat = beatPositions[i + 1];
+        // On the beat, between two beats and right before the next beat
+        for (const auto position : {beat, beat + (nextBeat - beat) / 3, nextBeat - 0.5}) {
+            const auto nextIndex = std::lower_bound(beatPositions.cbegin(),
+                                           beatPositions.cend(),
+                                           position) -
+                    beatPositions.cbegin();
+            for (int n = 1; n <= kMaxN; ++n) {
+                EXPECT_EQ(beatPositions[nextIndex + n - 1],
+                        pBeats->findNthBeat(position, n));
+                const auto prevIndex = (beatPositions[nextIndex] == position)
+                        ? nextIndex - n + 1
+                        : nextIndex - n;
+                EXPECT_EQ(beatPositions[prevIndex], pBeats->findNthBeat(position, -n));
+            }
+
+            const auto closestBeat = (position - beat < nextBeat - position) ? beat : nextBeat;
+            EXPECT_EQ(closestBeat, pBeats->findClosestBeat(position));
+        }
+
+        EXPECT_EQ(kMaxN,
+                pBeats->numBeatsInRange(beat,
+                        beatPositions[i + kMaxN - 1] +
+                                (beatPositions[i + kMaxN] - beatPositions[i + kMaxN - 1]) /
+                                        2));
+    }
+}
+
+TEST(BeatsTest, BeatMapIteratorAddSubtract) {
+    std::vector<audio::FramePos> beatPositions;
+    const auto pBeats = createBeatMap(100, &beatPositions);
+    const int beatCount = static_cast<int>(beatPositions.size());
+
+    for (int i = 0; i < beatCount; ++i) {
+        const auto it = pBeats->cfirstmarker() + i;
+        EXPECT_EQ(beatPositions[i], *it);
+        EXPECT_EQ(i, it - pBeats->cfirstmarker());
+        EXPECT_EQ(beatCount - 1 - i, pBeats->clastmarker() - it);
+        EXPECT_EQ(pBeats->cfirstmarker(), pBeats->clastmarker() - (beatCount - 1 - i) - i);
+    }
+}
+
+static void BM_BeatMapFindNthBeat(benchmark::State& state) {
+    std::vector<audio::FramePos> beatPositions;
+    const auto pBeats = createBeatMap(static_cast<int>(state.range(0)), &beatPositions);
+    const auto lastPosition = beatPositions.back();
+
+    audio::FramePos position = kStartPosition;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pBeats->findNthBeat(position, 4));
+        // Jump through the track like multiple decks that are playing
+        position = kStartPosition + std::fmod(position.value() * 1.618, lastPosition.value());
+    }
+}
+BENCHMARK(BM_BeatMapFindNthBeat)->Arg(100)->Arg(10000);
+
+static void BM_BeatMapFindClosestBeat(benchmark::State& state) {
+    std::vector<audio::FramePos> beatPositions;
+    const auto pBeats = createBeatMap(static_cast<int>(state.range(0)), &beatPositions);
+    const auto lastPosition = beatPositions.back();
+
+    audio::FramePos position = kStartPosition;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pBeats->findClosestBeat(position));
+        position = kStartPosition + std::fmod(position.value() * 1.618, lastPosition.value());
+    }
+}
+BENCHMARK(BM_BeatMapFindClosestBeat)->Arg(100)->Arg(10000);
+
+static void BM_BeatMapNumBeatsInRange(benchmark::State& state) {
+    std::vector<audio::FramePos> beatPositions;
+    const auto pBeats = createBeatMap(static_cast<int>(state.range(0)), &beatPositions);
+
+    // The whole track, like the Engine Prime export
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pBeats->numBeatsInRange(
+                beatPositions.front(), beatPositions.back()));
+    }
+}
+BENCHMARK(BM_BeatMapNumBeatsInRange)->Arg(100)->Arg(10000);
+
 } // namespace
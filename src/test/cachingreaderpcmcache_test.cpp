@@ -0,0 +1,90 @@
+#include "engine/cachingreader/cachingreaderpcmcache.h"
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QTemporaryDir>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+
+namespace {
+
+constexpr mixxx::audio::SampleRate kSampleRate = mixxx::audio::SampleRate(44100);
+
+// 2.5 chunks
+const mixxx::IndexRange kFrameIndexRange = mixxx::IndexRange::forward(0, 8192 * 5 / 2);
+
+// The approximate size of a cache file for kFrameIndexRange
+constexpr qint64 kFileSize = 3 * 8192 * 2 * sizeof(CSAMPLE) + 4096;
+
+class CachingReaderPcmCacheTest : public testing::Test {
+  protected:
+    int numCacheFiles() const {
+        return QDir(m_tempDir.path()).entryList(QDir::Files).size();
+    }
+
+    QTemporaryDir m_tempDir;
+};
+
+TEST_F(CachingReaderPcmCacheTest, ChunksPersistAcrossReloads) {
+    {
+        CachingReaderPcmCache cache(m_tempDir.path(), 10 * kFileSize);
+        ASSERT_TRUE(cache.open(1, kFrameIndexRange, kSampleRate));
+        EXPECT_EQ(3, cache.numChunks());
+        EXPECT_EQ(0, cache.nextUncachedChunk(0));
+
+        const SINT frameIndex = CachingReaderChunk::kFrames * 2;
+        cache.writableSamples(frameIndex)[0] = 0.25f;
+        cache.setChunkCached(2);
+        EXPECT_FALSE(cache.isChunkCached(1));
+        EXPECT_TRUE(cache.isChunkCached(2));
+        EXPECT_EQ(1, cache.nextUncachedChunk(1));
+        EXPECT_EQ(-1, cache.nextUncachedChunk(3));
+    }
+
+    CachingReaderPcmCache cache(m_tempDir.path(), 10 * kFileSize);
+    ASSERT_TRUE(cache.open(1, kFrameIndexRange, kSampleRate));
+    EXPECT_TRUE(cache.isChunkCached(2));
+    EXPECT_EQ(0.25f, cache.readableSamples(CachingReaderChunk::kFrames * 2)[0]);
+
+    // A different length resets the file
+    ASSERT_TRUE(cache.open(1,
+            mixxx::IndexRange::forward(0, CachingReaderChunk::kFrames * 3),
+            kSampleRate));
+    EXPECT_FALSE(cache.isChunkCached(2));
+    EXPECT_EQ(1, numCacheFiles());
+}
+
+TEST_F(CachingReaderPcmCacheTest, SameTrackInMultipleDecks) {
+    CachingReaderPcmCache cache1(m_tempDir.path(), 10 * kFileSize);
+    CachingReaderPcmCache cache2(m_tempDir.path(), 10 * kFileSize);
+    ASSERT_TRUE(cache1.open(1, kFrameIndexRange, kSampleRate));
+    EXPECT_FALSE(cache2.open(1, kFrameIndexRange, kSampleRate));
+    EXPECT_FALSE(cache2.isOpen());
+    cache1.close();
+    EXPECT_TRUE(cache2.open(1, kFrameIndexRange, kSampleRate));
+}
+
+TEST_F(CachingReaderPcmCacheTest, EvictsFilesNotInUse) {
+    CachingReaderPcmCache cache1(m_tempDir.path(), 2 * kFileSize);
+    CachingReaderPcmCache cache2(m_tempDir.path(), 2 * kFileSize);
+    ASSERT_TRUE(cache1.open(1, kFrameIndexRange, kSampleRate));
+    ASSERT_TRUE(cache2.open(2, kFrameIndexRange, kSampleRate));
+    EXPECT_EQ(2, numCacheFiles());
+
+    // Only the closed file is evicted
+    cache2.close();
+    ASSERT_TRUE(cache2.open(3, kFrameIndexRange, kSampleRate));
+    EXPECT_EQ(2, numCacheFiles());
+    ASSERT_TRUE(cache1.isOpen());
+    cache1.setChunkCached(0);
+    EXPECT_TRUE(cache1.isChunkCached(0));
+}
+
+TEST_F(CachingReaderPcmCacheTest, RejectsTracksLargerThanTheCache) {
+    CachingReaderPcmCache cache(m_tempDir.path(), kFileSize / 2);
+    EXPECT_FALSE(cache.open(1, kFrameIndexRange, kSampleRate));
+    EXPECT_EQ(0, numCacheFiles());
+}
+
+} // namespace
@@ -0,0 +1,102 @@
+#include "engine/cachingreader/cachingreaderprefetcher.h"
+
+#include <gtest/gtest.h>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+
+namespace {
+
+class CachingReaderPrefetcherTest : public testing::Test {
+  protected:
+    // Simulates reads at a constant speed and returns the position where
+    // the next read continues
+    SINT play(SINT frameIndex, SINT framesPerRead, int numReads) {
+        for (int i = 0; i < numReads; ++i) {
+            frameIndex += framesPerRead;
+            m_prefetcher.notifyRead(frameIndex);
+        }
+        return frameIndex;
+    }
+
+    CachingReaderPrefetcher m_prefetcher;
+};
+
+TEST_F(CachingReaderPrefetcherTest, NoPredictionWithoutHistory) {
+    EXPECT_TRUE(m_prefetcher.predictedFrameIndexRange().empty());
+    m_prefetcher.notifyRead(1000);
+    EXPECT_TRUE(m_prefetcher.predictedFrameIndexRange().empty());
+    EXPECT_EQ(1024, m_prefetcher.jumpTargetFrameCount(1024));
+}
+
+TEST_F(CachingReaderPrefetcherTest, PredictsAheadWhenPlayingForward) {
+    m_prefetcher.notifyRead(0);
+    // 1.5 x 1024 frames per read
+    const SINT position = play(0, 1536, 20);
+    EXPECT_NEAR(1536, m_prefetcher.velocity(), 10);
+
+    const auto range = m_prefetcher.predictedFrameIndexRange();
+    EXPECT_TRUE(range.containsIndex(position));
+    EXPECT_TRUE(range.containsIndex(position + 10 * 1536));
+    EXPECT_FALSE(range.containsIndex(position - 4 * 1536));
+
+    // Jump targets need more than the default at this speed
+    EXPECT_GT(m_prefetcher.jumpTargetFrameCount(1024), 1024);
+    EXPECT_LE(m_prefetcher.jumpTargetFrameCount(1024), 2 * CachingReaderChunk::kFrames);
+}
+
+TEST_F(CachingReaderPrefetcherTest, PredictsBehindWhenPlayingInReverse) {
+    m_prefetcher.notifyRead(1000000);
+    const SINT position = play(1000000, -1024, 20);
+    EXPECT_LT(m_prefetcher.velocity(), 0);
+
+    const auto range = m_prefetcher.predictedFrameIndexRange();
+    EXPECT_TRUE(range.containsIndex(position - 1));
+    EXPECT_TRUE(range.containsIndex(position - 10 * 1024));
+    EXPECT_FALSE(range.containsIndex(position + 4 * 1024));
+}
+
+TEST_F(CachingReaderPrefetcherTest, JumpsDoNotAffectVelocity) {
+    m_prefetcher.notifyRead(0);
+    SINT position = play(0, 1024, 20);
+    const double velocity = m_prefetcher.velocity();
+
+    // Hotcue jump
+    position += 10 * CachingReaderChunk::kFrames;
+    m_prefetcher.notifyRead(position);
+    EXPECT_EQ(velocity, m_prefetcher.velocity());
+
+    // The prediction continues from the jump target
+    const auto range = m_prefetcher.predictedFrameIndexRange();
+    EXPECT_TRUE(range.containsIndex(position));
+    EXPECT_TRUE(range.containsIndex(position + 10 * 1024));
+}
+
+TEST_F(CachingReaderPrefetcherTest, ScratchingCoversBothDirections) {
+    SINT position = 1000000;
+    m_prefetcher.notifyRead(position);
+    for (int i = 0; i < 10; ++i) {
+        position = play(position, 2048, 3);
+        position = play(position, -2048, 3);
+    }
+    const auto range = m_prefetcher.predictedFrameIndexRange();
+    EXPECT_TRUE(range.containsIndex(position - 2048));
+    EXPECT_TRUE(range.containsIndex(position + 2048));
+}
+
+TEST_F(CachingReaderPrefetcherTest, PredictionIsBounded) {
+    m_prefetcher.notifyRead(0);
+    // Fast forward
+    play(0, 8192, 100);
+    EXPECT_LE(m_prefetcher.predictedFrameIndexRange().length(),
+            8 * CachingReaderChunk::kFrames);
+}
+
+TEST_F(CachingReaderPrefetcherTest, Reset) {
+    m_prefetcher.notifyRead(0);
+    play(0, 1024, 20);
+    m_prefetcher.reset();
+    EXPECT_EQ(0, m_prefetcher.velocity());
+    EXPECT_TRUE(m_prefetcher.predictedFrameIndexRange().empty());
+}
+
+} // namespace
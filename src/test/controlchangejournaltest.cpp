@@ -0,0 +1,136 @@
+#include "control/controlchangejournal.h"
+
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+class ControlChangeJournalTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pControl1 = std::make_unique<ControlObject>(ConfigKey("[Channel1]", "co1"));
+        m_pControl2 = std::make_unique<ControlObject>(ConfigKey("[Channel1]", "co2"));
+    }
+
+    std::unique_ptr<ControlObject> m_pControl1;
+    std::unique_ptr<ControlObject> m_pControl2;
+    QObject m_owner;
+};
+
+TEST_F(ControlChangeJournalTest, CoalescesChangesPerDrain) {
+    ControlChangeJournal journal;
+    auto* pSubscription = journal.subscribe(ConfigKey("[Channel1]", "co1"), &m_owner);
+    ASSERT_NE(nullptr, pSubscription);
+    std::vector<double> values;
+    QObject::connect(pSubscription,
+            &ControlJournalSubscription::valueChanged,
+            [&values](double value) {
+                values.push_back(value);
+            });
+
+    EXPECT_EQ(0, journal.drain());
+
+    m_pControl1->set(1.0);
+    m_pControl1->set(2.0);
+    m_pControl1->set(3.0);
+    // Not subscribed
+    m_pControl2->set(4.0);
+    EXPECT_TRUE(values.empty());
+
+    EXPECT_EQ(1, journal.drain());
+    ASSERT_EQ(1u, values.size());
+    EXPECT_EQ(3.0, values.back());
+
+    // Nothing changed since the last drain
+    EXPECT_EQ(0, journal.drain());
+    EXPECT_EQ(1u, values.size());
+}
+
+TEST_F(ControlChangeJournalTest, MultipleSubscriptionsOfOneControl) {
+    ControlChangeJournal journal;
+    auto* pSubscription1 = journal.subscribe(ConfigKey("[Channel1]", "co1"), &m_owner);
+    auto* pSubscription2 = journal.subscribe(ConfigKey("[Channel1]", "co1"), &m_owner);
+    ASSERT_NE(nullptr, pSubscription1);
+    ASSERT_NE(nullptr, pSubscription2);
+
+    m_pControl1->set(1.0);
+    EXPECT_EQ(2, journal.drain());
+
+    delete pSubscription1;
+    m_pControl1->set(2.0);
+    EXPECT_EQ(1, journal.drain());
+
+    delete pSubscription2;
+    m_pControl1->set(3.0);
+    EXPECT_EQ(0, journal.drain());
+}
+
+TEST_F(ControlChangeJournalTest, ControlIsJournaledOnce) {
+    ControlChangeJournal journal1;
+    ControlChangeJournal journal2;
+    auto* pSubscription = journal1.subscribe(ConfigKey("[Channel1]", "co1"), &m_owner);
+    ASSERT_NE(nullptr, pSubscription);
+    EXPECT_EQ(nullptr, journal2.subscribe(ConfigKey("[Channel1]", "co1"), &m_owner));
+    EXPECT_EQ(nullptr, journal2.subscribe(ConfigKey("[Channel1]", "missing"), &m_owner));
+
+    delete pSubscription;
+    EXPECT_NE(nullptr, journal2.subscribe(ConfigKey("[Channel1]", "co1"), &m_owner));
+}
+
+TEST_F(ControlChangeJournalTest, ChangesFromOtherThreads) {
+    ControlChangeJournal journal;
+    auto* pSubscription = journal.subscribe(ConfigKey("[Channel1]", "co1"), &m_owner);
+    ASSERT_NE(nullptr, pSubscription);
+    double lastValue = 0;
+    QObject::connect(pSubscription,
+            &ControlJournalSubscription::valueChanged,
+            [&lastValue](double value) {
+                lastValue = value;
+            });
+
+    // More changes than fit into a single ring
+    constexpr int kNumChanges = 5000;
+    std::unique_ptr<QThread> pThread(QThread::create([this] {
+        for (int i = 1; i <= kNumChanges; ++i) {
+            m_pControl1->set(i);
+        }
+    }));
+    pThread->start();
+    pThread->wait();
+
+    EXPECT_EQ(1, journal.drain());
+    EXPECT_EQ(kNumChanges, lastValue);
+}
+
+TEST_F(ControlChangeJournalTest, RegisteredThread) {
+    ControlChangeJournal journal;
+    auto* pSubscription = journal.subscribe(ConfigKey("[Channel1]", "co1"), &m_owner);
+    ASSERT_NE(nullptr, pSubscription);
+    double lastValue = 0;
+    QObject::connect(pSubscription,
+            &ControlJournalSubscription::valueChanged,
+            [&lastValue](double value) {
+                lastValue = value;
+            });
+
+    // Registering twice reuses the ring
+    std::unique_ptr<QThread> pThread(QThread::create([this, &journal] {
+        journal.registerThread();
+        journal.registerThread();
+        m_pControl1->set(1.0);
+        m_pControl1->set(2.0);
+    }));
+    pThread->start();
+    pThread->wait();
+
+    EXPECT_EQ(1, journal.drain());
+    EXPECT_EQ(2.0, lastValue);
+    EXPECT_EQ(0, journal.drain());
+}
+
+} // namespace
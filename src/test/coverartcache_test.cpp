@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QTemporaryDir>
 
 #include "library/coverartcache.h"
+#include "library/coverartthumbnailstore.h"
 #include "library/coverartutils.h"
 #include "library/trackcollection.h"
 #include "test/librarytest.h"
@@ -92,3 +97,85 @@ TEST_F(CoverArtCacheTest, loadCoverFromFileAbsolute) {
             getTestDir().filePath(kCoverLocationTest),
             getTestDir().filePath(kCoverLocationTest));
 }
+
+TEST_F(CoverArtCacheTest, loadCoverFromThumbnailStore) {
+    QTemporaryDir storageDir;
+    ASSERT_TRUE(storageDir.isValid());
+    CoverArtThumbnailStore::setStorageDirectory(storageDir.path());
+
+    // A copy that can be modified
+    const QString coverLocation = QDir(storageDir.path()).filePath(kCoverFileTest);
+    ASSERT_TRUE(QFile::copy(getTestDir().filePath(kCoverLocationTest), coverLocation));
+    const QImage img = QImage(coverLocation);
+    ASSERT_FALSE(img.isNull());
+
+    CoverInfo info;
+    info.type = CoverInfo::FILE;
+    info.source = CoverInfo::GUESSED;
+    info.coverLocation = coverLocation;
+    info.setImageDigest(CoverImageUtils::calculateDigest(img));
+    constexpr int kWidth = 64;
+
+    // The first request stores the thumbnail
+    CoverArtCache::FutureResult res;
+    res = CoverArtCache::loadCover(nullptr, TrackPointer(), info, kWidth, false);
+    EXPECT_FALSE(res.coverInfoUpdated);
+    EXPECT_EQ(kWidth, res.coverArt.loadedImage.image.width());
+    EXPECT_FALSE(CoverArtThumbnailStore::load(info, kWidth).isNull());
+
+    // Subsequent requests don't need to decode the original image
+    QString thumbnailPath;
+    EXPECT_FALSE(CoverArtThumbnailStore::load(info, kWidth, &thumbnailPath).isNull());
+    res = CoverArtCache::loadCover(nullptr, TrackPointer(), info, kWidth, false);
+    EXPECT_EQ(CoverInfo::LoadedImage::Result::Ok, res.coverArt.loadedImage.result);
+    EXPECT_QSTRING_EQ(thumbnailPath, res.coverArt.loadedImage.location);
+    EXPECT_EQ(kWidth, res.coverArt.loadedImage.image.width());
+    EXPECT_EQ(kWidth, res.coverArt.resizedToWidth);
+
+    // The thumbnail is not used if the original is missing
+    CoverInfo movedInfo = info;
+    movedInfo.coverLocation = QDir(storageDir.path()).filePath("missing.jpg");
+    EXPECT_TRUE(CoverArtThumbnailStore::load(movedInfo, kWidth).isNull());
+    res = CoverArtCache::loadCover(nullptr, TrackPointer(), movedInfo, kWidth, false);
+    EXPECT_NE(CoverInfo::LoadedImage::Result::Ok, res.coverArt.loadedImage.result);
+
+    // The original is loaded again if it has been modified since the
+    // thumbnail was stored
+    {
+        QFile thumbnailFile(thumbnailPath);
+        ASSERT_TRUE(thumbnailFile.open(QIODevice::Append));
+        ASSERT_TRUE(thumbnailFile.setFileTime(
+                QDateTime::currentDateTime().addSecs(-3600),
+                QFileDevice::FileModificationTime));
+    }
+    ASSERT_TRUE(img.mirrored().save(coverLocation));
+    bool outdated = false;
+    EXPECT_TRUE(CoverArtThumbnailStore::load(info, kWidth, nullptr, &outdated).isNull());
+    EXPECT_TRUE(outdated);
+    res = CoverArtCache::loadCover(nullptr, TrackPointer(), info, kWidth, false);
+    EXPECT_TRUE(res.coverInfoUpdated);
+    EXPECT_EQ(QImage(coverLocation).scaledToWidth(kWidth, Qt::SmoothTransformation),
+            res.coverArt.loadedImage.image);
+    EXPECT_NE(info.imageDigest(), res.coverArt.imageDigest());
+    info = res.coverArt;
+    EXPECT_FALSE(CoverArtThumbnailStore::load(info, kWidth).isNull());
+
+    // Only the most recently requested width is kept
+    res = CoverArtCache::loadCover(nullptr, TrackPointer(), info, 2 * kWidth, false);
+    EXPECT_EQ(2 * kWidth, res.coverArt.loadedImage.image.width());
+    EXPECT_TRUE(CoverArtThumbnailStore::load(info, kWidth).isNull());
+    EXPECT_FALSE(CoverArtThumbnailStore::load(info, 2 * kWidth).isNull());
+
+    // Neither original sizes nor images without a digest are stored
+    CoverInfo legacyInfo = info;
+    legacyInfo.setImageDigest(QByteArray(), 0x1234);
+    EXPECT_FALSE(CoverArtThumbnailStore::isStorable(info, 0));
+    EXPECT_FALSE(CoverArtThumbnailStore::isStorable(
+            info, CoverArtThumbnailStore::kMaxWidth + 1));
+    EXPECT_FALSE(CoverArtThumbnailStore::isStorable(legacyInfo, kWidth));
+
+    CoverArtThumbnailStore::prune(0);
+    EXPECT_TRUE(CoverArtThumbnailStore::load(info, 2 * kWidth).isNull());
+
+    CoverArtThumbnailStore::setStorageDirectory(QString());
+}
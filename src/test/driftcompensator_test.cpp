@@ -0,0 +1,336 @@
+#include "soundio/driftcompensator.h"
+
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "util/fifo.h"
+#include "util/math.h"
+#include "util/types.h"
+
+namespace {
+
+constexpr double kSampleRate = 48000;
+constexpr SINT kFramesPerChunk = 256;
+constexpr int kChannelCount = 2;
+constexpr double kChunkSeconds = kFramesPerChunk / kSampleRate;
+constexpr double kSineFrequency = 1000;
+// Long enough for the controller to settle, the first part is ignored
+constexpr int kSimulatedChunks = 20000;
+constexpr int kSettlingChunks = 5000;
+// Both callbacks are randomly delayed by up to this fraction of a chunk
+constexpr double kCallbackJitter = 0.15;
+constexpr SINT kFitFrames = 512;
+
+struct SimulationResult {
+    int underflows = 0;
+    int overflows = 0;
+    /// RMS of the deviation from an ideal sine relative to its RMS
+    double errorDb = 0;
+    /// The mean delay of the FIFO and the interpolation
+    double meanLatencyChunks = 0;
+    double maxLatencyChunks = 0;
+};
+
+/// A sound card clock that deviates from the nominal sample rate and fires
+/// its callbacks with some random delay.
+class SimulatedClock {
+  public:
+    SimulatedClock(double ppm, unsigned int seed)
+            : m_period(kChunkSeconds / (1.0 + ppm * 1e-6)),
+              m_jitter(0.0, kCallbackJitter * kChunkSeconds),
+              m_random(seed),
+              m_chunks(0),
+              m_nextCallback(0) {
+        schedule();
+    }
+
+    double nextCallback() const {
+        return m_nextCallback;
+    }
+
+    void advance() {
+        ++m_chunks;
+        schedule();
+    }
+
+  private:
+    void schedule() {
+        m_nextCallback = m_chunks * m_period + m_jitter(m_random);
+    }
+
+    const double m_period;
+    std::uniform_real_distribution<double> m_jitter;
+    std::mt19937 m_random;
+    int m_chunks;
+    double m_nextCallback;
+};
+
+void generateSine(std::vector<CSAMPLE>* pBuffer, SINT firstFrame) {
+    for (SINT i = 0; i < kFramesPerChunk; ++i) {
+        const auto value = static_cast<CSAMPLE>(
+                std::sin(2 * M_PI * kSineFrequency * (firstFrame + i) / kSampleRate));
+        for (int c = 0; c < kChannelCount; ++c) {
+            (*pBuffer)[i * kChannelCount + c] = value;
+        }
+    }
+}
+
+/// Fits a sine with the expected frequency into short windows of the
+/// received signal. The remaining error consists of the interpolation
+/// error and the clicks and pitch modulation caused by the drift
+/// compensation.
+double measureErrorDb(const std::vector<CSAMPLE>& received, double frequency) {
+    const double omega = 2 * M_PI * frequency / kSampleRate;
+    double errorEnergy = 0;
+    double signalEnergy = 0;
+    for (SINT start = 0; start + kFitFrames <= static_cast<SINT>(received.size());
+            start += kFitFrames) {
+        // Least squares fit of a * sin + b * cos, the basis is nearly
+        // orthogonal for windows of many periods
+        double ss = 0;
+        double cc = 0;
+        double sc = 0;
+        double ys = 0;
+        double yc = 0;
+        for (SINT i = 0; i < kFitFrames; ++i) {
+            const double s = std::sin(omega * (start + i));
+            const double c = std::cos(omega * (start + i));
+            const double y = received[start + i];
+            ss += s * s;
+            cc += c * c;
+            sc += s * c;
+            ys += y * s;
+            yc += y * c;
+        }
+        const double det = ss * cc - sc * sc;
+        const double a = (ys * cc - yc * sc) / det;
+        const double b = (yc * ss - ys * sc) / det;
+        for (SINT i = 0; i < kFitFrames; ++i) {
+            const double fit = a * std::sin(omega * (start + i)) +
+                    b * std::cos(omega * (start + i));
+            const double y = received[start + i];
+            errorEnergy += (y - fit) * (y - fit);
+            signalEnergy += fit * fit;
+        }
+    }
+    return 10 * std::log10(errorEnergy / signalEnergy);
+}
+
+class DriftCompensatorTest : public testing::Test {
+  protected:
+    /// The clock reference device writes chunks of a sine into the FIFO
+    /// that are played by the secondary device.
+    SimulationResult simulateOutput(double referencePpm, double secondaryPpm) {
+        DriftCompensator compensator(kChannelCount, kFramesPerChunk);
+        FIFO<CSAMPLE> fifo(kChannelCount * kFramesPerChunk * 3);
+        prefill(&fifo, compensator.fifoPrefillSamples());
+
+        SimulatedClock referenceClock(referencePpm, 1);
+        SimulatedClock secondaryClock(secondaryPpm, 2);
+        std::vector<CSAMPLE> buffer(kChannelCount * kFramesPerChunk);
+        std::vector<CSAMPLE> received;
+        SimulationResult result;
+        LatencyMeter latency;
+        SINT generatedFrames = 0;
+        double lastReferenceCallback = 0;
+        for (int chunk = 0; chunk < kSimulatedChunks;) {
+            if (referenceClock.nextCallback() < secondaryClock.nextCallback()) {
+                const double now = referenceClock.nextCallback();
+                latency.update(now, fifo.readAvailable(), chunk >= kSettlingChunks);
+                generateSine(&buffer, generatedFrames);
+                generatedFrames += kFramesPerChunk;
+                const int samples = static_cast<int>(buffer.size());
+                if (fifo.write(buffer.data(), samples) < samples) {
+                    ++result.overflows;
+                }
+                lastReferenceCallback = now;
+                referenceClock.advance();
+            } else {
+                const double now = secondaryClock.nextCallback();
+                latency.update(now, fifo.readAvailable(), chunk >= kSettlingChunks);
+                const double referencePhase = (now - lastReferenceCallback) / kChunkSeconds;
+                const bool ok = compensator.readOutput(
+                        &fifo, buffer.data(), kFramesPerChunk, referencePhase);
+                if (chunk >= kSettlingChunks) {
+                    if (!ok) {
+                        ++result.underflows;
+                    }
+                    for (SINT i = 0; i < kFramesPerChunk; ++i) {
+                        received.push_back(buffer[i * kChannelCount]);
+                    }
+                }
+                secondaryClock.advance();
+                ++chunk;
+            }
+        }
+        // The secondary device plays the sine slower if its clock is faster
+        result.errorDb = measureErrorDb(received,
+                kSineFrequency * (1.0 + referencePpm * 1e-6) /
+                        (1.0 + secondaryPpm * 1e-6));
+        latency.finish(&result);
+        return result;
+    }
+
+    /// The secondary device records a sine that is read in chunks from the
+    /// FIFO by the clock reference device.
+    SimulationResult simulateInput(double referencePpm, double secondaryPpm) {
+        DriftCompensator compensator(kChannelCount, kFramesPerChunk);
+        FIFO<CSAMPLE> fifo(kChannelCount * kFramesPerChunk * 3);
+        prefill(&fifo, compensator.fifoPrefillSamples());
+
+        SimulatedClock referenceClock(referencePpm, 3);
+        SimulatedClock secondaryClock(secondaryPpm, 4);
+        std::vector<CSAMPLE> buffer(kChannelCount * kFramesPerChunk);
+        std::vector<CSAMPLE> received;
+        SimulationResult result;
+        LatencyMeter latency;
+        SINT generatedFrames = 0;
+        double lastReferenceCallback = 0;
+        for (int chunk = 0; chunk < kSimulatedChunks;) {
+            if (referenceClock.nextCallback() < secondaryClock.nextCallback()) {
+                const double now = referenceClock.nextCallback();
+                latency.update(now, fifo.readAvailable(), chunk >= kSettlingChunks);
+                const int samples = static_cast<int>(buffer.size());
+                const int readSamples = fifo.read(buffer.data(), samples);
+                if (chunk >= kSettlingChunks) {
+                    if (readSamples < samples) {
+                        ++result.underflows;
+                    }
+                    for (SINT i = 0; i < kFramesPerChunk; ++i) {
+                        received.push_back(buffer[i * kChannelCount]);
+                    }
+                }
+                lastReferenceCallback = now;
+                referenceClock.advance();
+                ++chunk;
+            } else {
+                const double now = secondaryClock.nextCallback();
+                latency.update(now, fifo.readAvailable(), chunk >= kSettlingChunks);
+                const double referencePhase = (now - lastReferenceCallback) / kChunkSeconds;
+                generateSine(&buffer, generatedFrames);
+                generatedFrames += kFramesPerChunk;
+                if (!compensator.writeInput(
+                            &fifo, buffer.data(), kFramesPerChunk, referencePhase)) {
+                    ++result.overflows;
+                }
+                secondaryClock.advance();
+            }
+        }
+        result.errorDb = measureErrorDb(received,
+                kSineFrequency * (1.0 + secondaryPpm * 1e-6) /
+                        (1.0 + referencePpm * 1e-6));
+        latency.finish(&result);
+        return result;
+    }
+
+  private:
+    /// Integrates the fill level of the FIFO over time
+    class LatencyMeter {
+      public:
+        void update(double now, int fillSamples, bool measure) {
+            const double fillChunks = static_cast<double>(fillSamples) /
+                            (kChannelCount * kFramesPerChunk) +
+                    static_cast<double>(DriftCompensator::kInterpolationDelayFrames) /
+                            kFramesPerChunk;
+            if (measure) {
+                m_integral += m_lastFillChunks * (now - m_lastUpdate);
+                m_duration += now - m_lastUpdate;
+                m_max = math_max(m_max, fillChunks);
+            }
+            m_lastUpdate = now;
+            m_lastFillChunks = fillChunks;
+        }
+
+        void finish(SimulationResult* pResult) const {
+            pResult->meanLatencyChunks = m_integral / m_duration;
+            pResult->maxLatencyChunks = m_max;
+        }
+
+      private:
+        double m_lastUpdate = 0;
+        double m_lastFillChunks = 0;
+        double m_integral = 0;
+        double m_duration = 0;
+        double m_max = 0;
+    };
+
+    static void prefill(FIFO<CSAMPLE>* pFifo, SINT samples) {
+        const std::vector<CSAMPLE> silence(samples);
+        pFifo->write(silence.data(), static_cast<int>(samples));
+    }
+};
+
+void report(const char* direction,
+        double referencePpm,
+        double secondaryPpm,
+        const SimulationResult& result) {
+    qInfo() << direction
+            << "reference" << referencePpm << "ppm"
+            << "secondary" << secondaryPpm << "ppm:"
+            << "error" << result.errorDb << "dB,"
+            << "latency" << result.meanLatencyChunks * kChunkSeconds * 1000
+            << "ms mean," << result.maxLatencyChunks * kChunkSeconds * 1000
+            << "ms max";
+}
+
+// The clock reference device writes a whole chunk before the secondary
+// device can start reading, so one chunk is the lower bound.
+constexpr double kMaxMeanLatencyChunks = 1.5;
+// A single click caused by dropping or duplicating a frame is far above
+// this level
+constexpr double kMaxErrorDb = -60;
+
+const double kDrifts[][2] = {
+        {0, 0},
+        {200, -200},
+        {-200, 200},
+        {200, 200},
+};
+
+TEST_F(DriftCompensatorTest, OutputAbsorbsDrift) {
+    for (const auto& drift : kDrifts) {
+        const SimulationResult result = simulateOutput(drift[0], drift[1]);
+        report("Output", drift[0], drift[1], result);
+        EXPECT_EQ(0, result.underflows);
+        EXPECT_EQ(0, result.overflows);
+        EXPECT_LT(result.errorDb, kMaxErrorDb);
+        EXPECT_LT(result.meanLatencyChunks, kMaxMeanLatencyChunks);
+    }
+}
+
+TEST_F(DriftCompensatorTest, InputAbsorbsDrift) {
+    for (const auto& drift : kDrifts) {
+        const SimulationResult result = simulateInput(drift[0], drift[1]);
+        report("Input", drift[0], drift[1], result);
+        EXPECT_EQ(0, result.underflows);
+        EXPECT_EQ(0, result.overflows);
+        EXPECT_LT(result.errorDb, kMaxErrorDb);
+        EXPECT_LT(result.meanLatencyChunks, kMaxMeanLatencyChunks);
+    }
+}
+
+TEST_F(DriftCompensatorTest, UnityRatioIsTransparent) {
+    DriftCompensator compensator(kChannelCount, kFramesPerChunk);
+    FIFO<CSAMPLE> fifo(kChannelCount * kFramesPerChunk * 4);
+    std::vector<CSAMPLE> input(kChannelCount * kFramesPerChunk);
+    std::vector<CSAMPLE> output(kChannelCount * kFramesPerChunk);
+    for (SINT i = 0; i < static_cast<SINT>(input.size()); ++i) {
+        input[i] = static_cast<CSAMPLE>(i);
+    }
+    // Exactly on the target level the ratio remains 1 and a single frame
+    // is consumed per output frame
+    const SINT targetFrames = static_cast<SINT>(
+            (2.0 + DriftCompensator::kJitterReserve) * kFramesPerChunk);
+    const std::vector<CSAMPLE> silence(kChannelCount * (targetFrames - kFramesPerChunk));
+    fifo.write(silence.data(), static_cast<int>(silence.size()));
+    fifo.write(input.data(), static_cast<int>(input.size()));
+    ASSERT_TRUE(compensator.readOutput(&fifo, output.data(), kFramesPerChunk, 0.0));
+    EXPECT_DOUBLE_EQ(1.0, compensator.ratio());
+    EXPECT_EQ(kChannelCount * (targetFrames - kFramesPerChunk), fifo.readAvailable());
+}
+
+} // namespace
@@ -0,0 +1,125 @@
+#include "effects/backends/effectstateallocator.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "effects/backends/builtin/echoeffect.h"
+#include "effects/backends/effectsamplebuffer.h"
+
+namespace {
+
+const mixxx::EngineParameters kEngineParameters(
+        mixxx::audio::SampleRate(96000),
+        1024);
+
+constexpr std::size_t kDefaultMaxPooledBytes = 64 * 1024 * 1024;
+
+EffectStateAllocator::Usage usageOf(const QString& effectId) {
+    const auto usage = EffectStateAllocator::usage();
+    for (const auto& effectUsage : usage) {
+        if (effectUsage.effectId == effectId) {
+            return effectUsage;
+        }
+    }
+    return EffectStateAllocator::Usage{effectId, 0, 0, 0, 0};
+}
+
+class EffectStateAllocatorTest : public testing::Test {
+  protected:
+    ~EffectStateAllocatorTest() override {
+        EffectStateAllocator::setMaxPooledBytes(kDefaultMaxPooledBytes);
+        EffectStateAllocator::releasePooledMemory();
+    }
+};
+
+TEST_F(EffectStateAllocatorTest, ReusesFreedMemory) {
+    EffectStateAllocator::releasePooledMemory();
+    void* pMemory = EffectStateAllocator::allocate(1000);
+    EffectStateAllocator::deallocate(pMemory);
+    EXPECT_GE(EffectStateAllocator::pooledBytes(), 1000u);
+
+    // Rounded to the same size
+    void* pReused = EffectStateAllocator::allocate(999);
+    EXPECT_EQ(pMemory, pReused);
+    EXPECT_EQ(0u, EffectStateAllocator::pooledBytes());
+    EffectStateAllocator::deallocate(pReused);
+}
+
+TEST_F(EffectStateAllocatorTest, Alignment) {
+    std::vector<std::unique_ptr<EffectSampleBuffer>> buffers;
+    for (SINT size = 1; size < 1000; size += 37) {
+        buffers.push_back(std::make_unique<EffectSampleBuffer>(size));
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(buffers.back()->data()) % 32);
+    }
+}
+
+TEST_F(EffectStateAllocatorTest, AccountsPerEffect) {
+    const QString effectId = QStringLiteral("test.AccountsPerEffect");
+    const std::size_t delaySize = EchoGroupState::kMaxDelaySeconds *
+            kEngineParameters.sampleRate() * kEngineParameters.channelCount() *
+            sizeof(CSAMPLE);
+
+    std::unique_ptr<EchoGroupState> pState;
+    {
+        EffectStateAllocator::ScopedEffect scopedEffect(effectId);
+        pState = std::make_unique<EchoGroupState>(kEngineParameters);
+    }
+    // The state and its delay buffer
+    auto usage = usageOf(effectId);
+    EXPECT_GT(usage.bytesInUse, delaySize);
+    EXPECT_EQ(2, usage.allocationCount);
+    EXPECT_EQ(0, usage.reusedCount);
+    const CSAMPLE* pDelayBuffer = pState->delay_buf.data();
+
+    // Not charged to the effect
+    EffectSampleBuffer unattributed(100);
+    EXPECT_EQ(usage.bytesInUse, usageOf(effectId).bytesInUse);
+
+    pState.reset();
+    usage = usageOf(effectId);
+    EXPECT_EQ(0u, usage.bytesInUse);
+    EXPECT_GT(usage.peakBytesInUse, delaySize);
+
+    {
+        EffectStateAllocator::ScopedEffect scopedEffect(effectId);
+        pState = std::make_unique<EchoGroupState>(kEngineParameters);
+    }
+    usage = usageOf(effectId);
+    EXPECT_EQ(4, usage.allocationCount);
+    EXPECT_EQ(2, usage.reusedCount);
+    EXPECT_EQ(pDelayBuffer, pState->delay_buf.data());
+}
+
+TEST_F(EffectStateAllocatorTest, LimitsPooledMemory) {
+    EffectStateAllocator::releasePooledMemory();
+    EffectStateAllocator::setMaxPooledBytes(64 * 1024);
+    EffectStateAllocator::deallocate(EffectStateAllocator::allocate(1000));
+    const std::size_t pooledBytes = EffectStateAllocator::pooledBytes();
+    EXPECT_GT(pooledBytes, 0u);
+    EffectStateAllocator::deallocate(EffectStateAllocator::allocate(1024 * 1024));
+    EXPECT_EQ(pooledBytes, EffectStateAllocator::pooledBytes());
+    EffectStateAllocator::releasePooledMemory();
+    EXPECT_EQ(0u, EffectStateAllocator::pooledBytes());
+}
+
+// Loading an echo for 8 channels and both outputs, with and without
+// recycling the memory of the previous states
+static void BM_CreateEchoStates(benchmark::State& state) {
+    EffectStateAllocator::setMaxPooledBytes(state.range(0) ? kDefaultMaxPooledBytes : 0);
+    std::vector<std::unique_ptr<EchoGroupState>> states;
+    for (auto _ : state) {
+        states.clear();
+        for (int i = 0; i < 16; ++i) {
+            states.push_back(std::make_unique<EchoGroupState>(kEngineParameters));
+        }
+    }
+    states.clear();
+    EffectStateAllocator::setMaxPooledBytes(kDefaultMaxPooledBytes);
+    EffectStateAllocator::releasePooledMemory();
+}
+BENCHMARK(BM_CreateEchoStates)->ArgName("pooled")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+} // namespace
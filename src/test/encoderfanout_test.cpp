@@ -0,0 +1,152 @@
+#ifdef __BROADCAST__
+
+#include "engine/sidechain/encoderfanout.h"
+
+#include <gtest/gtest.h>
+
+#include "recording/defs_recording.h"
+
+namespace {
+
+class TestSink : public NetworkOutputStreamWorker {
+  public:
+    TestSink()
+            : m_notifications(0) {
+    }
+
+    void process(const CSAMPLE* pBuffer, const int iBufferSize) override {
+        Q_UNUSED(pBuffer);
+        Q_UNUSED(iBufferSize);
+    }
+    void shutdown() override {
+    }
+    void outputAvailable() override {
+        ++m_notifications;
+    }
+
+    int notifications() const {
+        return m_notifications;
+    }
+
+  private:
+    int m_notifications;
+};
+
+EncoderFanOut::Key makeKey(const QString& format) {
+    return EncoderFanOut::Key{
+            format,
+            128,
+            EncoderSettings::ChannelMode::STEREO,
+            mixxx::audio::SampleRate(44100),
+    };
+}
+
+void writePacket(EncoderFanOut* pFanOut, int size) {
+    const QByteArray body(size, 'x');
+    pFanOut->write(nullptr,
+            reinterpret_cast<const unsigned char*>(body.constData()),
+            0,
+            body.size());
+}
+
+TEST(EncoderFanOutTest, SinksSharePackets) {
+    EncoderFanOut fanOut(makeKey(ENCODING_MP3));
+    TestSink sink1;
+    TestSink sink2;
+    EncodedPacketQueue queue1(1024);
+    EncodedPacketQueue queue2(1024);
+    fanOut.addSink(&sink1, &queue1);
+    fanOut.addSink(&sink2, &queue2);
+    EXPECT_EQ(2, fanOut.sinkCount());
+    EXPECT_TRUE(fanOut.threadWaiting());
+
+    const QByteArray header("head");
+    const QByteArray body("body");
+    fanOut.write(reinterpret_cast<const unsigned char*>(header.constData()),
+            reinterpret_cast<const unsigned char*>(body.constData()),
+            header.size(),
+            body.size());
+    EXPECT_EQ(1, sink1.notifications());
+    EXPECT_EQ(1, sink2.notifications());
+
+    const auto packets1 = queue1.takeAll();
+    const auto packets2 = queue2.takeAll();
+    ASSERT_EQ(1u, packets1.size());
+    ASSERT_EQ(1u, packets2.size());
+    EXPECT_EQ(header, packets1.front().header);
+    EXPECT_EQ(body, packets1.front().body);
+    // Not copied for each sink
+    EXPECT_EQ(packets1.front().body.constData(), packets2.front().body.constData());
+    EXPECT_TRUE(queue1.takeAll().empty());
+
+    fanOut.removeSink(&sink1);
+    fanOut.removeSink(&sink2);
+    EXPECT_FALSE(fanOut.threadWaiting());
+}
+
+TEST(EncoderFanOutTest, SlowSinkOnlyDropsItsOwnPackets) {
+    EncoderFanOut fanOut(makeKey(ENCODING_MP3));
+    TestSink slowSink;
+    TestSink sink;
+    EncodedPacketQueue slowQueue(100);
+    EncodedPacketQueue queue(1000);
+    fanOut.addSink(&slowSink, &slowQueue);
+    fanOut.addSink(&sink, &queue);
+
+    for (int i = 0; i < 10; ++i) {
+        writePacket(&fanOut, 40);
+    }
+    EXPECT_EQ(2u, slowQueue.takeAll().size());
+    EXPECT_EQ(8, slowQueue.overrunCount());
+    EXPECT_EQ(10u, queue.takeAll().size());
+    EXPECT_EQ(0, queue.overrunCount());
+
+    // Taking the packets makes room again
+    writePacket(&fanOut, 40);
+    EXPECT_EQ(1u, slowQueue.takeAll().size());
+    EXPECT_EQ(8, slowQueue.resetOverrunCount());
+    EXPECT_EQ(0, slowQueue.overrunCount());
+
+    fanOut.removeSink(&slowSink);
+    fanOut.removeSink(&sink);
+}
+
+TEST(EncoderFanOutTest, OversizedPacketIsNotDroppedForever) {
+    EncodedPacketQueue queue(10);
+    EncodedPacket packet;
+    packet.body = QByteArray(20, 'x');
+    EXPECT_TRUE(queue.push(packet));
+    EXPECT_FALSE(queue.push(packet));
+    EXPECT_EQ(1u, queue.takeAll().size());
+    EXPECT_TRUE(queue.push(packet));
+}
+
+TEST(EncoderFanOutTest, RemovedSinkReceivesNothing) {
+    EncoderFanOut fanOut(makeKey(ENCODING_MP3));
+    TestSink sink;
+    EncodedPacketQueue queue(1024);
+    fanOut.addSink(&sink, &queue);
+    fanOut.removeSink(&sink);
+    EXPECT_EQ(0, fanOut.sinkCount());
+
+    writePacket(&fanOut, 10);
+    EXPECT_EQ(0, sink.notifications());
+    EXPECT_TRUE(queue.takeAll().empty());
+}
+
+TEST(EncoderFanOutTest, OnlyJoinableStreamsAreShared) {
+    EXPECT_TRUE(EncoderFanOut(makeKey(ENCODING_MP3)).isShareable());
+    EXPECT_TRUE(EncoderFanOut(makeKey(ENCODING_AAC)).isShareable());
+    // Sinks joining later would miss the Ogg header pages
+    EXPECT_FALSE(EncoderFanOut(makeKey(ENCODING_OGG)).isShareable());
+    EXPECT_FALSE(EncoderFanOut(makeKey(ENCODING_OPUS)).isShareable());
+
+    EXPECT_TRUE(makeKey(ENCODING_MP3) == makeKey(ENCODING_MP3));
+    EncoderFanOut::Key otherBitrate = makeKey(ENCODING_MP3);
+    otherBitrate.quality = 320;
+    EXPECT_FALSE(makeKey(ENCODING_MP3) == otherBitrate);
+}
+
+} // namespace
+
+#endif // __BROADCAST__
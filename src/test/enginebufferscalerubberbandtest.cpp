@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <cmath>
+
+#include "engine/bufferscalers/enginebufferscalerubberband.h"
+#include "engine/readaheadmanager.h"
+#include "test/mixxxtest.h"
+#include "util/math.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+constexpr SINT kOutputFrames = 4096;
+constexpr SINT kOutputSamples = 2 * kOutputFrames;
+
+// Reads a stereo sine that can be seeked to any frame
+class ReadAheadManagerSine : public ReadAheadManager {
+  public:
+    ReadAheadManagerSine()
+            : ReadAheadManager(),
+              m_frame(0) {
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer, SINT requested_samples) override {
+        Q_UNUSED(dRate);
+        for (SINT i = 0; i < requested_samples; i += 2) {
+            const auto sample = static_cast<CSAMPLE>(std::sin(m_frame * 0.05) * 0.5);
+            buffer[i] = sample;
+            buffer[i + 1] = sample;
+            ++m_frame;
+        }
+        return requested_samples;
+    }
+
+    void seek(SINT frame) {
+        m_frame = frame;
+    }
+
+  private:
+    SINT m_frame;
+};
+
+class StretchedDeck {
+  public:
+    explicit StretchedDeck(bool multiThreaded)
+            : m_scale(&m_reader),
+              m_output(kOutputSamples) {
+        m_scale.setSampleRate(mixxx::audio::SampleRate(44100));
+        m_scale.setMultiThreaded(multiThreaded);
+    }
+
+    const mixxx::SampleBuffer& process() {
+        // Like EngineBuffer, the parameters are set for every callback
+        double tempoRatio = 1.1;
+        double pitchRatio = 1.0;
+        m_scale.setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+        m_scale.scaleBuffer(m_output.data(), m_output.size());
+        return m_output;
+    }
+
+    void seek(SINT frame) {
+        m_reader.seek(frame);
+        m_scale.clear();
+    }
+
+  private:
+    ReadAheadManagerSine m_reader;
+    EngineBufferScaleRubberBand m_scale;
+    mixxx::SampleBuffer m_output;
+};
+
+class EngineBufferScaleRubberBandTest : public MixxxTest {
+};
+
+TEST_F(EngineBufferScaleRubberBandTest, MultiThreadedMatchesSingleThreaded) {
+    StretchedDeck multiThreaded(true);
+    StretchedDeck singleThreaded(false);
+    for (int i = 0; i < 100; ++i) {
+        // Seek after the stretcher has been handed over to the worker,
+        // which is likely busy at that moment
+        const bool seek = i % 20 == 10;
+        if (seek) {
+            multiThreaded.seek(i * 1000);
+            singleThreaded.seek(i * 1000);
+        }
+        const mixxx::SampleBuffer& output = multiThreaded.process();
+        const mixxx::SampleBuffer& expected = singleThreaded.process();
+        CSAMPLE peak = 0;
+        for (SINT j = 0; j < kOutputSamples; ++j) {
+            ASSERT_NEAR(expected[j], output[j], 1e-5) << i << ' ' << j;
+            peak = math_max(peak, std::abs(output[j]));
+        }
+        if (seek) {
+            // Stretched synchronously instead of waiting for the worker
+            EXPECT_GT(peak, 0.1) << i;
+        }
+        // Starts the worker thread when it has been requested and lets it
+        // stretch ahead
+        application()->processEvents();
+        QThread::msleep(1);
+    }
+}
+
+} // namespace
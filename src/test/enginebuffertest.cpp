@@ -12,6 +12,7 @@
 #include "test/mixxxtest.h"
 #include "test/signalpathtest.h"
 #include "engine/controls/ratecontrol.h"
+#include "util/math.h"
 
 // In case any of the test in this file fail. You can use the audioplot.py tool
 // in the tools folder to visually compare the results of the enginebuffer
@@ -389,6 +390,48 @@ TEST_F(EngineBufferE2ETest, RubberbandReverseTest) {
     // on the uses library version
 }
 
+TEST_F(EngineBufferE2ETest, RubberbandMultiThreadedTest) {
+    // Stretching ahead on the worker thread must keep the deck playing
+    // while seeking, changing the rate, and toggling the mode.
+    ControlObject::set(ConfigKey("[Master]", "keylock_engine"),
+            static_cast<double>(EngineBuffer::KeylockEngine::RubberBandFaster));
+    ControlObject::set(ConfigKey("[Master]", "keylock_multithreaded"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup1, "pitch"), -1);
+    ControlObject::set(ConfigKey(m_sGroup1, "rate"), 0.05);
+    ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+
+    const auto processBuffers = [this](int count) {
+        CSAMPLE peak = 0;
+        for (int i = 0; i < count; ++i) {
+            // Starts the worker thread once the deck stretches
+            application()->processEvents();
+            ProcessBuffer();
+            for (int j = 0; j < kProcessBufferSize; ++j) {
+                peak = math_max(peak, std::abs(m_pEngineMaster->masterBuffer()[j]));
+            }
+        }
+        return peak;
+    };
+
+    // Hands over to the worker once the rate is stable
+    EXPECT_GT(processBuffers(20), 0);
+    const double position = ControlObject::get(ConfigKey(m_sGroup1, "playposition"));
+    EXPECT_GT(processBuffers(20), 0);
+    EXPECT_GT(ControlObject::get(ConfigKey(m_sGroup1, "playposition")), position);
+
+    m_pChannel1->getEngineBuffer()->queueNewPlaypos(
+            mixxx::audio::FramePos(500), EngineBuffer::SEEK_EXACT);
+    EXPECT_GT(processBuffers(20), 0);
+    // Rate jump
+    ControlObject::set(ConfigKey(m_sGroup1, "rate"), 0.5);
+    EXPECT_GT(processBuffers(20), 0);
+    ControlObject::set(ConfigKey(m_sGroup1, "reverse"), 1.0);
+    processBuffers(20);
+    ControlObject::set(ConfigKey(m_sGroup1, "reverse"), 0.0);
+    ControlObject::set(ConfigKey("[Master]", "keylock_multithreaded"), 0.0);
+    EXPECT_GT(processBuffers(20), 0);
+}
+
 TEST_F(EngineBufferE2ETest, CueGotoAndStopTest) {
     // Be sure, that the Crossfade buffer is processed only once
     // Bug #1504838
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <cmath>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "effects/backends/builtin/biquadfullkilleqeffect.h"
+#include "effects/backends/effectsbackendmanager.h"
+#include "effects/chains/equalizereffectchain.h"
+#include "effects/effectslot.h"
+#include "effects/effectsmanager.h"
+#include "engine/channels/enginedeck.h"
+#include "engine/enginebuffer.h"
+#include "engine/enginemaster.h"
+#include "mixer/deck.h"
+#include "mixer/playerinfo.h"
+#include "mixer/playermanager.h"
+#include "soundio/soundmanagerutil.h"
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/track.h"
+#include "util/defs.h"
+#include "util/math.h"
+
+namespace {
+
+constexpr int kBufferSize = 1024;
+constexpr int kNumCallbacks = 200;
+
+// Processes two decks that share a prefader effect chain with and without
+// the channel thread pool. The chain has intermediate buffers and a delay
+// line that are not per channel, so both decks must be processed serially.
+class EngineMasterConcurrencyTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    std::vector<CSAMPLE> render(int numChannelThreads) {
+        config()->setValue(ConfigKey("[Master]", "channel_processing_threads"),
+                numChannelThreads);
+
+        auto pChannelHandleFactory = std::make_shared<ChannelHandleFactory>();
+        auto pEffectsManager = std::make_unique<EffectsManager>(
+                config(), pChannelHandleFactory);
+        auto pEngine = std::make_unique<EngineMaster>(config(),
+                "[Master]",
+                pEffectsManager.get(),
+                pChannelHandleFactory,
+                false);
+        auto pPlayerManager = std::make_unique<PlayerManager>(config(),
+                nullptr,
+                pEffectsManager.get(),
+                pEngine.get());
+        PlayerInfo::create();
+        pPlayerManager->addDeck();
+        pPlayerManager->addDeck();
+        pEffectsManager->setup();
+        pEngine->onOutputConnected(AudioOutput(AudioOutput::MASTER, 0, 2));
+
+        // Route the second deck through the equalizer of the first one and
+        // kill the bass, so the shared chain actually processes both decks.
+        auto pEqualizer = pEffectsManager->getEqualizerEffectChain("[Channel1]");
+        pEqualizer->getEffectSlot(0)->loadEffectWithDefaults(
+                pEffectsManager->getBackendManager()->getManifest(
+                        BiquadFullKillEQEffect::getId(),
+                        EffectBackendType::BuiltIn));
+        pEqualizer->registerInputChannel(
+                pEngine->registerChannelGroup("[Channel2]"), 1.0);
+        ControlObject::set(ConfigKey("[EqualizerRack1_[Channel1]_Effect1]",
+                                   "parameter1"),
+                0.0);
+
+        std::vector<EngineBuffer*> engineBuffers;
+        for (unsigned int i = 1; i <= pPlayerManager->numberOfDecks(); ++i) {
+            Deck* pDeck = pPlayerManager->getDeck(i);
+            pDeck->slotLoadTrack(
+                    Track::newTemporary(getTestDir().filePath("sine-30.wav")),
+                    false);
+            engineBuffers.push_back(pDeck->getEngineDeck()->getEngineBuffer());
+        }
+        for (EngineBuffer* pEngineBuffer : engineBuffers) {
+            pEngine->process(kBufferSize);
+            while (!pEngineBuffer->isTrackLoaded()) {
+                application()->processEvents();
+                QThread::msleep(1);
+            }
+        }
+        ControlObject::set(ConfigKey("[Channel1]", "play"), 1.0);
+        ControlObject::set(ConfigKey("[Channel2]", "play"), 1.0);
+        // Detune the second deck, so both decks process different samples
+        ControlObject::set(ConfigKey("[Channel2]", "rate"), 0.5);
+
+        std::vector<CSAMPLE> output;
+        output.reserve(kNumCallbacks * kBufferSize);
+        for (int i = 0; i < kNumCallbacks; ++i) {
+            // Make the result independent of the speed of the readers
+            for (EngineBuffer* pEngineBuffer : engineBuffers) {
+                while (!pEngineBuffer->isReaderIdle()) {
+                    QThread::yieldCurrentThread();
+                }
+            }
+            pEngine->process(kBufferSize);
+            const CSAMPLE* pMaster = pEngine->getMasterBuffer();
+            output.insert(output.end(), pMaster, pMaster + kBufferSize);
+            application()->processEvents();
+        }
+
+        pPlayerManager.reset();
+        PlayerInfo::destroy();
+        pEngine.reset();
+        pEffectsManager.reset();
+        return output;
+    }
+};
+
+TEST_F(EngineMasterConcurrencyTest, SharedPreFaderChainMatchesSerialProcessing) {
+    const std::vector<CSAMPLE> expected = render(0);
+    const std::vector<CSAMPLE> actual = render(2);
+    ASSERT_EQ(expected.size(), actual.size());
+    CSAMPLE peak = 0;
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(expected[i], actual[i]) << "at sample " << i;
+        peak = math_max(peak, std::abs(expected[i]));
+    }
+    EXPECT_GT(peak, 0.1f);
+}
+
+} // namespace
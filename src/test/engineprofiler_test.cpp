@@ -0,0 +1,137 @@
+#include "engine/engineprofiler.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <memory>
+
+namespace {
+
+constexpr auto kPeriod = mixxx::Duration::fromMillis(5);
+
+class EngineProfilerTest : public testing::Test {
+  protected:
+    EngineProfilerTest()
+            : m_pProfiler(std::make_unique<EngineProfiler>()) {
+    }
+
+    // Records a callback with explicit stage times in microseconds
+    void recordCallback(std::int64_t channelsMicros,
+            std::int64_t mixMicros,
+            std::int64_t scalerMicros = 0) {
+        const std::int64_t start = m_pProfiler->nowNanos();
+        m_pProfiler->beginCallback(kPeriod, start);
+        const std::int64_t channelsEnd = start + channelsMicros * 1000;
+        m_pProfiler->addStage(EngineProfiler::Stage::Channels, start, channelsEnd);
+        if (scalerMicros > 0) {
+            // Two decks
+            m_pProfiler->addStage(EngineProfiler::Stage::Scaler,
+                    start,
+                    start + scalerMicros * 1000 / 2);
+            m_pProfiler->addStage(EngineProfiler::Stage::Scaler,
+                    start,
+                    start + scalerMicros * 1000 / 2);
+        }
+        const std::int64_t mixEnd = channelsEnd + mixMicros * 1000;
+        m_pProfiler->addStage(EngineProfiler::Stage::Mix, channelsEnd, mixEnd);
+        m_pProfiler->endCallback(mixEnd);
+    }
+
+    std::unique_ptr<EngineProfiler> m_pProfiler;
+};
+
+TEST_F(EngineProfilerTest, CountsDeadlineMisses) {
+    recordCallback(1000, 1000);
+    recordCallback(4000, 2000);
+    recordCallback(100, 100, 50);
+    EXPECT_EQ(3u, m_pProfiler->callbackCount());
+    EXPECT_EQ(1u, m_pProfiler->deadlineMissCount());
+    EXPECT_EQ(3u, m_pProfiler->histogram(EngineProfiler::Stage::Channels).count());
+    EXPECT_EQ(1u, m_pProfiler->histogram(EngineProfiler::Stage::Scaler).count());
+    EXPECT_EQ(0u, m_pProfiler->histogram(EngineProfiler::Stage::Sidechain).count());
+    EXPECT_EQ(mixxx::Duration::fromMillis(4),
+            m_pProfiler->histogram(EngineProfiler::Stage::Channels).max());
+    EXPECT_EQ(mixxx::Duration::fromMillis(6),
+            m_pProfiler->histogram(EngineProfiler::Stage::Callback).max());
+
+    const auto records = m_pProfiler->recentCallbacks();
+    ASSERT_EQ(3u, records.size());
+    EXPECT_FALSE(records[0].missedDeadline());
+    EXPECT_TRUE(records[1].missedDeadline());
+    EXPECT_EQ(6000000,
+            records[1].stageDurationNanos[static_cast<int>(EngineProfiler::Stage::Callback)]);
+    EXPECT_EQ(4000000,
+            records[1].stageStartNanos[static_cast<int>(EngineProfiler::Stage::Mix)]);
+    EXPECT_EQ(50000,
+            records[2].stageDurationNanos[static_cast<int>(EngineProfiler::Stage::Scaler)]);
+    EXPECT_EQ(-1,
+            records[2].stageStartNanos[static_cast<int>(EngineProfiler::Stage::Sidechain)]);
+}
+
+TEST_F(EngineProfilerTest, KeepsMostRecentCallbacks) {
+    const int count = EngineProfiler::kRecordCapacity + 10;
+    for (int i = 0; i < count; ++i) {
+        recordCallback(10, 10);
+    }
+    const auto records = m_pProfiler->recentCallbacks();
+    ASSERT_EQ(static_cast<std::size_t>(EngineProfiler::kRecordCapacity), records.size());
+    EXPECT_EQ(10u, records.front().index);
+    EXPECT_EQ(static_cast<std::uint64_t>(count - 1), records.back().index);
+}
+
+TEST_F(EngineProfilerTest, ChromeTrace) {
+    recordCallback(1000, 1000, 500);
+    recordCallback(4000, 2000);
+
+    QJsonParseError error;
+    const auto document = QJsonDocument::fromJson(m_pProfiler->toChromeTrace(), &error);
+    ASSERT_EQ(QJsonParseError::NoError, error.error);
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+    int callbacks = 0;
+    int counters = 0;
+    int deadlineMisses = 0;
+    for (const auto& value : events) {
+        const QJsonObject event = value.toObject();
+        const QString name = event.value(QStringLiteral("name")).toString();
+        const QString phase = event.value(QStringLiteral("ph")).toString();
+        if (name == QStringLiteral("Callback")) {
+            EXPECT_EQ(QStringLiteral("X"), phase);
+            ++callbacks;
+        } else if (name == QStringLiteral("Scaler")) {
+            EXPECT_EQ(QStringLiteral("C"), phase);
+            EXPECT_DOUBLE_EQ(500,
+                    event.value(QStringLiteral("args"))
+                            .toObject()
+                            .value(QStringLiteral("us"))
+                            .toDouble());
+            ++counters;
+        } else if (name == QStringLiteral("Deadline miss")) {
+            ++deadlineMisses;
+        }
+    }
+    EXPECT_EQ(2, callbacks);
+    EXPECT_EQ(1, counters);
+    EXPECT_EQ(1, deadlineMisses);
+}
+
+static void BM_ProfiledCallback(benchmark::State& state) {
+    // Too large for the stack
+    const auto pProfiler = std::make_unique<EngineProfiler>();
+    for (auto _ : state) {
+        EngineProfiler::ScopedCallback callback(kPeriod, pProfiler.get());
+        {
+            EngineProfiler::ScopedStage stage(EngineProfiler::Stage::Channels, pProfiler.get());
+            for (int i = 0; i < 4; ++i) {
+                EngineProfiler::ScopedStage scaler(
+                        EngineProfiler::Stage::Scaler, pProfiler.get());
+            }
+        }
+        EngineProfiler::ScopedStage stage(EngineProfiler::Stage::Mix, pProfiler.get());
+    }
+}
+BENCHMARK(BM_ProfiledCallback);
+
+} // namespace
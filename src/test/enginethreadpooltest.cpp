@@ -0,0 +1,120 @@
+#include "engine/enginethreadpool.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include "util/defs.h"
+#include "util/sample.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+class EngineThreadPoolTest : public testing::Test {
+  protected:
+    void assertEachItemProcessedOnce(EngineThreadPool* pPool, int numItems) {
+        std::vector<std::atomic<int>> counts(numItems);
+        for (auto& count : counts) {
+            count.store(0);
+        }
+        auto countItem = [&counts](int index) {
+            counts[index].fetch_add(1);
+        };
+        pPool->run(numItems, countItem);
+        for (int i = 0; i < numItems; ++i) {
+            EXPECT_EQ(1, counts[i].load()) << "item " << i;
+        }
+    }
+};
+
+TEST_F(EngineThreadPoolTest, SerialWithoutWorkers) {
+    EngineThreadPool pool(0);
+    EXPECT_EQ(0, pool.numWorkers());
+    assertEachItemProcessedOnce(&pool, 4);
+}
+
+TEST_F(EngineThreadPoolTest, MoreItemsThanWorkers) {
+    EngineThreadPool pool(2);
+    assertEachItemProcessedOnce(&pool, 16);
+}
+
+TEST_F(EngineThreadPoolTest, MoreWorkersThanItems) {
+    EngineThreadPool pool(8);
+    assertEachItemProcessedOnce(&pool, 1);
+    assertEachItemProcessedOnce(&pool, 3);
+}
+
+TEST_F(EngineThreadPoolTest, NoItems) {
+    EngineThreadPool pool(2);
+    int calls = 0;
+    auto countItem = [&calls](int) {
+        ++calls;
+    };
+    pool.run(0, countItem);
+    EXPECT_EQ(0, calls);
+}
+
+TEST_F(EngineThreadPoolTest, RepeatedRunsJoinDeterministically) {
+    EngineThreadPool pool(3);
+    // Every run must have finished all items before returning, otherwise
+    // the sums of later runs would be off.
+    for (int run = 0; run < 1000; ++run) {
+        std::atomic<int> sum(0);
+        auto addItem = [&sum](int index) {
+            sum.fetch_add(index);
+        };
+        pool.run(4, addItem);
+        ASSERT_EQ(0 + 1 + 2 + 3, sum.load());
+    }
+}
+
+// Simulates the CPU load of a deck with keylock and effects enabled by
+// running a few passes of a one-pole filter with a transcendental function
+// over the channel buffer.
+void processSyntheticChannel(CSAMPLE* pBuffer, int bufferSize) {
+    constexpr int kPasses = 16;
+    CSAMPLE state = 0;
+    for (int pass = 0; pass < kPasses; ++pass) {
+        for (int i = 0; i < bufferSize; ++i) {
+            state = 0.9f * state + 0.1f * std::sin(pBuffer[i] + state);
+            pBuffer[i] = state;
+        }
+    }
+}
+
+// Compares the serial channel processing (0 workers) with the parallel one.
+// Arguments: number of additional worker threads, number of channels and
+// buffer size in samples. The real time per iteration is the time spent per
+// audio callback.
+static void BM_ProcessChannels(benchmark::State& state) {
+    const int numWorkers = static_cast<int>(state.range(0));
+    const int numChannels = static_cast<int>(state.range(1));
+    const int bufferSize = static_cast<int>(state.range(2));
+
+    std::vector<mixxx::SampleBuffer> channelBuffers;
+    channelBuffers.reserve(numChannels);
+    for (int i = 0; i < numChannels; ++i) {
+        channelBuffers.emplace_back(bufferSize);
+        SampleUtil::fill(channelBuffers.back().data(), 0.5f, bufferSize);
+    }
+
+    EngineThreadPool pool(numWorkers);
+    auto processChannel = [&channelBuffers, bufferSize](int index) {
+        processSyntheticChannel(channelBuffers[index].data(), bufferSize);
+    };
+
+    for (auto _ : state) {
+        pool.run(numChannels, processChannel);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * numChannels);
+}
+BENCHMARK(BM_ProcessChannels)
+        ->ArgNames({"workers", "channels", "samples"})
+        ->ArgsProduct({{0, 1, 3}, {4, 8}, {256, 1024}})
+        ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,72 @@
+#include "library/externallibraryfingerprint.h"
+
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+
+namespace {
+
+class ExternalLibraryFingerprintTest : public testing::Test {
+  protected:
+    ExternalLibraryFingerprintTest()
+            : m_filePath(m_dir.filePath(QStringLiteral("library.xml"))) {
+    }
+
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        ASSERT_TRUE(writeFile(QByteArrayLiteral("content")));
+        ASSERT_TRUE(setLastModified(QDateTime::currentDateTime().addSecs(-3600)));
+    }
+
+    bool writeFile(const QByteArray& content) const {
+        QFile file(m_filePath);
+        return file.open(QIODevice::WriteOnly) &&
+                file.write(content) == content.size();
+    }
+
+    bool setLastModified(const QDateTime& lastModified) const {
+        QFile file(m_filePath);
+        return file.open(QIODevice::Append) &&
+                file.setFileTime(lastModified, QFileDevice::FileModificationTime);
+    }
+
+    ExternalLibraryFingerprint importedFingerprint() const {
+        ExternalLibraryFingerprint fingerprint(m_filePath);
+        EXPECT_TRUE(fingerprint.calculateHash());
+        return fingerprint;
+    }
+
+    const QTemporaryDir m_dir;
+    const QString m_filePath;
+};
+
+TEST_F(ExternalLibraryFingerprintTest, Unchanged) {
+    auto imported = importedFingerprint();
+    EXPECT_TRUE(ExternalLibraryFingerprint(m_filePath).isUnchangedSince(&imported));
+
+    ExternalLibraryFingerprint invalid;
+    EXPECT_FALSE(ExternalLibraryFingerprint(m_filePath).isUnchangedSince(&invalid));
+}
+
+TEST_F(ExternalLibraryFingerprintTest, Modified) {
+    auto imported = importedFingerprint();
+    ASSERT_TRUE(writeFile(QByteArrayLiteral("changed")));
+    EXPECT_FALSE(ExternalLibraryFingerprint(m_filePath).isUnchangedSince(&imported));
+}
+
+TEST_F(ExternalLibraryFingerprintTest, TouchedOnly) {
+    auto imported = importedFingerprint();
+    const QDateTime touched = QDateTime::currentDateTime();
+    ASSERT_TRUE(setLastModified(touched));
+    EXPECT_TRUE(ExternalLibraryFingerprint(m_filePath).isUnchangedSince(&imported));
+
+    // The modification time has been adopted and the content is not
+    // compared again as long as it does not change
+    ASSERT_TRUE(writeFile(QByteArrayLiteral("changed")));
+    ASSERT_TRUE(setLastModified(touched));
+    EXPECT_TRUE(ExternalLibraryFingerprint(m_filePath).isUnchangedSince(&imported));
+}
+
+} // namespace
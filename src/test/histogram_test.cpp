@@ -0,0 +1,44 @@
+#include "util/histogram.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+namespace mixxx {
+
+TEST(HistogramTest, Buckets) {
+    for (std::int64_t nanos = 0; nanos < 100000; ++nanos) {
+        const int index = Histogram::bucketIndex(nanos);
+        ASSERT_LE(nanos, Histogram::bucketUpperBound(index));
+        if (index > 0) {
+            ASSERT_GT(nanos, Histogram::bucketUpperBound(index - 1));
+        }
+    }
+    // Relative error
+    const std::int64_t nanos = 123456789;
+    const std::int64_t upperBound = Histogram::bucketUpperBound(Histogram::bucketIndex(nanos));
+    EXPECT_LE(upperBound - nanos, nanos / Histogram::kSubBucketCount);
+    // Clamped
+    EXPECT_EQ(0, Histogram::bucketIndex(-1));
+    EXPECT_EQ(Histogram::kBucketCount - 1,
+            Histogram::bucketIndex(std::numeric_limits<std::int64_t>::max()));
+}
+
+TEST(HistogramTest, Quantiles) {
+    Histogram histogram;
+    EXPECT_EQ(Duration::empty(), histogram.quantile(0.5));
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.record(i * 1000);
+    }
+    EXPECT_EQ(1000u, histogram.count());
+    EXPECT_EQ(Duration::fromMicros(1000), histogram.max());
+    const auto median = histogram.quantile(0.5).toIntegerNanos();
+    EXPECT_GE(median, 500000);
+    EXPECT_LE(median, 500000 + 500000 / Histogram::kSubBucketCount);
+    const auto p99 = histogram.quantile(0.99).toIntegerNanos();
+    EXPECT_GE(p99, 990000);
+    EXPECT_LE(p99, 1000000);
+    EXPECT_EQ(histogram.max(), histogram.quantile(1));
+}
+
+} // namespace mixxx
@@ -0,0 +1,202 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <atomic>
+#include <memory>
+
+#include "library/itunes/itunesxmlimporter.h"
+#include "test/mixxxdbtest.h"
+
+namespace {
+
+const QByteArray kXmlHeader = QByteArrayLiteral(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<plist version=\"1.0\">\n"
+        "<dict>\n");
+const QByteArray kXmlFooter = QByteArrayLiteral(
+        "</dict>\n"
+        "</plist>\n");
+
+QByteArray trackXml(int id, const QByteArray& extraKeys = QByteArray()) {
+    const QByteArray number = QByteArray::number(id);
+    return QByteArrayLiteral("<key>") + number + QByteArrayLiteral("</key>\n<dict>\n") +
+            QByteArrayLiteral("<key>Track ID</key><integer>") + number +
+            QByteArrayLiteral("</integer>\n") +
+            QByteArrayLiteral("<key>Name</key><string>Title ") + number +
+            QByteArrayLiteral("</string>\n") +
+            QByteArrayLiteral("<key>Artist</key><string>Artist ") +
+            QByteArray::number(id % 100) + QByteArrayLiteral("</string>\n") +
+            QByteArrayLiteral("<key>Album</key><string>Album ") +
+            QByteArray::number(id % 1000) + QByteArrayLiteral("</string>\n") +
+            QByteArrayLiteral("<key>Genre</key><string>Techno</string>\n") +
+            QByteArrayLiteral("<key>BPM</key><integer>128</integer>\n") +
+            QByteArrayLiteral("<key>Bit Rate</key><integer>320</integer>\n") +
+            QByteArrayLiteral("<key>Total Time</key><integer>360000</integer>\n") +
+            QByteArrayLiteral("<key>Year</key><integer>2020</integer>\n") +
+            QByteArrayLiteral("<key>Rating</key><integer>80</integer>\n") +
+            QByteArrayLiteral(
+                    "<key>Location</key><string>file://localhost/Music/Track%20") +
+            number + QByteArrayLiteral(".mp3</string>\n") + extraKeys +
+            QByteArrayLiteral("</dict>\n");
+}
+
+QByteArray playlistXml(
+        int id, const QByteArray& name, const QList<int>& trackIds, bool master = false) {
+    QByteArray xml = QByteArrayLiteral("<dict>\n<key>Name</key><string>") + name +
+            QByteArrayLiteral("</string>\n");
+    if (master) {
+        xml += QByteArrayLiteral("<key>Master</key><true/>\n");
+    }
+    xml += QByteArrayLiteral("<key>Playlist ID</key><integer>") + QByteArray::number(id) +
+            QByteArrayLiteral("</integer>\n<key>Playlist Items</key>\n<array>\n");
+    for (const int trackId : trackIds) {
+        xml += QByteArrayLiteral("<dict><key>Track ID</key><integer>") +
+                QByteArray::number(trackId) + QByteArrayLiteral("</integer></dict>\n");
+    }
+    return xml + QByteArrayLiteral("</array>\n</dict>\n");
+}
+
+// A library with the given number of tracks and playlists of
+// consecutive tracks, like the libraries of our users
+QByteArray syntheticLibraryXml(int numTracks, int numPlaylists, int numTracksPerPlaylist) {
+    QByteArray xml = kXmlHeader + QByteArrayLiteral("<key>Tracks</key>\n<dict>\n");
+    for (int id = 1; id <= numTracks; ++id) {
+        xml += trackXml(id);
+    }
+    xml += QByteArrayLiteral("</dict>\n<key>Playlists</key>\n<array>\n");
+    for (int i = 0; i < numPlaylists; ++i) {
+        QList<int> trackIds;
+        for (int j = 0; j < numTracksPerPlaylist; ++j) {
+            trackIds.append(1 + (i * numTracksPerPlaylist + j) % numTracks);
+        }
+        xml += playlistXml(100000 + i, QByteArrayLiteral("Set ") + QByteArray::number(i), trackIds);
+    }
+    return xml + QByteArrayLiteral("</array>\n") + kXmlFooter;
+}
+
+bool writeFile(const QString& filePath, const QByteArray& data) {
+    QFile file(filePath);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+int countRows(const QSqlDatabase& database, const QString& tableName) {
+    QSqlQuery query(database);
+    if (!query.exec(QStringLiteral("SELECT COUNT(*) FROM ") + tableName) || !query.next()) {
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+class ITunesXmlImporterTest : public MixxxDbTest {
+  protected:
+    ITunesXmlImporterTest()
+            : MixxxDbTest(true),
+              m_cancelImport(false) {
+    }
+
+    QString writeLibrary(const QByteArray& xml) {
+        const QString filePath = QDir(m_tempDir.path()).filePath("iTunes Music Library.xml");
+        EXPECT_TRUE(writeFile(filePath, xml));
+        return filePath;
+    }
+
+    QTemporaryDir m_tempDir;
+    std::atomic<bool> m_cancelImport;
+};
+
+TEST_F(ITunesXmlImporterTest, ImportTracksAndPlaylists) {
+    const QString filePath = writeLibrary(kXmlHeader +
+            QByteArrayLiteral("<key>Tracks</key>\n<dict>\n") + trackXml(1) + trackXml(2) +
+            // Only the first of multiple tracks with the same ID is imported
+            trackXml(2) + trackXml(3) +
+            // Tracks from iTunes Match are not accessible
+            trackXml(4, QByteArrayLiteral("<key>Track Type</key><string>Remote</string>\n")) +
+            QByteArrayLiteral("</dict>\n<key>Playlists</key>\n<array>\n") +
+            playlistXml(10, "Library", {1, 2, 3}, true) +
+            playlistXml(11, "Set 1", {3, 1}) +
+            playlistXml(12, "Set 2", {2}) +
+            QByteArrayLiteral("</array>\n") + kXmlFooter);
+
+    ITunesXmlImporter importer(dbConnection(), filePath, m_cancelImport);
+    EXPECT_TRUE(importer.importLibrary());
+    EXPECT_EQ(QStringList({"Set 1", "Set 2"}), importer.playlists());
+    EXPECT_EQ(3, countRows(dbConnection(), "itunes_library"));
+    EXPECT_EQ(2, countRows(dbConnection(), "itunes_playlists"));
+    EXPECT_EQ(3, countRows(dbConnection(), "itunes_playlist_tracks"));
+
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec(
+            "SELECT track_id FROM itunes_playlist_tracks "
+            "WHERE playlist_id=11 ORDER BY position"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(3, query.value(0).toInt());
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(1, query.value(0).toInt());
+
+    // A subsequent import replaces the content of the tables
+    writeLibrary(syntheticLibraryXml(300, 2, 10));
+    ITunesXmlImporter reimporter(dbConnection(), filePath, m_cancelImport);
+    EXPECT_TRUE(reimporter.importLibrary());
+    EXPECT_EQ(300, countRows(dbConnection(), "itunes_library"));
+    EXPECT_EQ(2, countRows(dbConnection(), "itunes_playlists"));
+    EXPECT_EQ(20, countRows(dbConnection(), "itunes_playlist_tracks"));
+}
+
+TEST_F(ITunesXmlImporterTest, KeepPreviousContentIfFileIsMissing) {
+    const QString filePath = writeLibrary(syntheticLibraryXml(10, 1, 5));
+    ITunesXmlImporter importer(dbConnection(), filePath, m_cancelImport);
+    ASSERT_TRUE(importer.importLibrary());
+
+    ASSERT_TRUE(QFile::remove(filePath));
+    ITunesXmlImporter failingImporter(dbConnection(), filePath, m_cancelImport);
+    EXPECT_FALSE(failingImporter.importLibrary());
+    EXPECT_EQ(10, countRows(dbConnection(), "itunes_library"));
+    EXPECT_EQ(5, countRows(dbConnection(), "itunes_playlist_tracks"));
+}
+
+// Provides a fresh database for each run of the benchmark
+class ITunesXmlImporterBenchmarkScope : public MixxxDbTest {
+  public:
+    ITunesXmlImporterBenchmarkScope()
+            : MixxxDbTest(true) {
+    }
+
+    using MixxxDbTest::dbConnection;
+
+  private:
+    void TestBody() override {
+    }
+};
+
+void BM_ITunesXmlImport(benchmark::State& state) {
+    const int numTracks = static_cast<int>(state.range(0));
+    QTemporaryDir tempDir;
+    const QString filePath = QDir(tempDir.path()).filePath("iTunes Music Library.xml");
+    if (!writeFile(filePath, syntheticLibraryXml(numTracks, numTracks / 100, 100))) {
+        state.SkipWithError("Failed to write library");
+        return;
+    }
+    const std::atomic<bool> cancelImport(false);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto pScope = std::make_unique<ITunesXmlImporterBenchmarkScope>();
+        state.ResumeTiming();
+
+        ITunesXmlImporter importer(pScope->dbConnection(), filePath, cancelImport);
+        benchmark::DoNotOptimize(importer.importLibrary());
+
+        state.PauseTiming();
+        pScope.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * numTracks);
+}
+
+} // anonymous namespace
+
+BENCHMARK(BM_ITunesXmlImport)
+        ->Arg(1000)
+        ->Arg(10000)
+        ->Unit(benchmark::kMillisecond);
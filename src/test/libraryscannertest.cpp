@@ -1,10 +1,73 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QSemaphore>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
 #include "test/librarytest.h"
 
+#include "library/library_prefs.h"
 #include "library/scanner/libraryscanner.h"
 
+namespace {
+
+// Files with embedded cover art that are supported by all builds
+const QStringList kSyntheticTrackFiles = {
+        QStringLiteral("id3-test-data/cover-test.flac"),
+        QStringLiteral("id3-test-data/cover-test.ogg"),
+};
+
+// Populates rootDir with an artist/album directory tree of copies of
+// the test files
+bool createSyntheticLibrary(
+        const QDir& testDir,
+        const QDir& rootDir,
+        int numAlbums,
+        int numTracksPerAlbum) {
+    for (int i = 0; i < numAlbums; ++i) {
+        const QString albumPath = QStringLiteral("Artist %1/Album %2")
+                                          .arg(i % 10)
+                                          .arg(i);
+        if (!rootDir.mkpath(albumPath)) {
+            return false;
+        }
+        for (int j = 0; j < numTracksPerAlbum; ++j) {
+            const QString srcFilePath = testDir.filePath(
+                    kSyntheticTrackFiles[j % kSyntheticTrackFiles.size()]);
+            const QString dstFilePath = rootDir.filePath(
+                    QStringLiteral("%1/%2 - Track.%3")
+                            .arg(albumPath)
+                            .arg(j + 1, 2, 10, QChar('0'))
+                            .arg(QFileInfo(srcFilePath).suffix()));
+            if (!QFile::copy(srcFilePath, dstFilePath)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Scans all library directories in the thread of the scanner and
+// waits until the scan is finished
+void runScan(LibraryScanner* pScanner) {
+    QSemaphore scanFinished;
+    const auto connection = QObject::connect(
+            pScanner,
+            &LibraryScanner::scanFinished,
+            pScanner,
+            [&scanFinished] {
+                scanFinished.release();
+            },
+            Qt::DirectConnection);
+    pScanner->scan();
+    scanFinished.acquire();
+    QObject::disconnect(connection);
+}
+
+} // namespace
+
 class LibraryScannerTest : public LibraryTest {
   protected:
     LibraryScannerTest()
@@ -52,3 +115,113 @@ TEST_F(LibraryScannerTest, ScannerRoundtrip) {
     m_libraryScanner.changeScannerState(LibraryScanner::IDLE);
     EXPECT_EQ(m_libraryScanner.m_state, LibraryScanner::IDLE);
 }
+
+class LibraryScannerScanTest : public LibraryTest {
+  protected:
+    int countTracks(const QString& condition) const {
+        QSqlQuery query(dbConnection());
+        if (!query.exec(QStringLiteral("SELECT COUNT(*) FROM library WHERE ") +
+                    condition) ||
+                !query.next()) {
+            return -1;
+        }
+        return query.value(0).toInt();
+    }
+
+    const QTemporaryDir m_libraryDir;
+};
+
+TEST_F(LibraryScannerScanTest, ParallelScanAddsAllTracks) {
+    constexpr int kNumAlbums = 12;
+    constexpr int kNumTracksPerAlbum = 10;
+    ASSERT_TRUE(createSyntheticLibrary(
+            getTestDir(), QDir(m_libraryDir.path()), kNumAlbums, kNumTracksPerAlbum));
+    ASSERT_TRUE(internalCollection()->addDirectory(mixxx::FileInfo(m_libraryDir.path())));
+
+    config()->setValue(mixxx::library::prefs::kScannerThreadCountConfigKey, 4);
+    LibraryScanner libraryScanner(dbConnectionPooler(), config());
+    libraryScanner.start();
+    runScan(&libraryScanner);
+
+    EXPECT_EQ(kNumAlbums * kNumTracksPerAlbum,
+            countTracks(QStringLiteral("mixxx_deleted=0")));
+    // The metadata that has been imported by the worker threads
+    // has been stored
+    EXPECT_EQ(kNumAlbums * kNumTracksPerAlbum,
+            countTracks(QStringLiteral("source_synchronized_ms IS NOT NULL "
+                                       "AND coverart_hash<>0")));
+
+    // A rescan doesn't add any tracks
+    runScan(&libraryScanner);
+    EXPECT_EQ(kNumAlbums * kNumTracksPerAlbum,
+            countTracks(QStringLiteral("mixxx_deleted=0")));
+}
+
+namespace {
+
+// Provides a fresh library for each run of the benchmark
+class LibraryScannerBenchmarkScope : public LibraryTest {
+  public:
+    explicit LibraryScannerBenchmarkScope(const QDir& libraryDir) {
+        internalCollection()->addDirectory(mixxx::FileInfo(libraryDir.path()));
+    }
+
+    std::unique_ptr<LibraryScanner> newLibraryScanner(int numThreads) {
+        config()->setValue(mixxx::library::prefs::kScannerThreadCountConfigKey, numThreads);
+        return std::make_unique<LibraryScanner>(dbConnectionPooler(), config());
+    }
+
+  private:
+    void TestBody() override {
+    }
+};
+
+constexpr int kBenchmarkNumAlbums = 50;
+constexpr int kBenchmarkNumTracksPerAlbum = 20;
+
+// The directory tree is generated once and shared by all benchmark runs
+const QDir& syntheticLibraryDir() {
+    static const QTemporaryDir s_tempDir;
+    static const QDir s_libraryDir = [] {
+        const QDir libraryDir(s_tempDir.path());
+        VERIFY_OR_DEBUG_ASSERT(createSyntheticLibrary(
+                MixxxTest::getOrInitTestDir(),
+                libraryDir,
+                kBenchmarkNumAlbums,
+                kBenchmarkNumTracksPerAlbum)) {
+            qWarning() << "Failed to create synthetic library in" << libraryDir;
+        }
+        return libraryDir;
+    }();
+    return s_libraryDir;
+}
+
+} // namespace
+
+static void BM_ScanSyntheticLibrary(benchmark::State& state) {
+    const int numThreads = static_cast<int>(state.range(0));
+    const QDir& libraryDir = syntheticLibraryDir();
+    for (auto _ : state) {
+        state.PauseTiming();
+        LibraryScannerBenchmarkScope scope(libraryDir);
+        auto pLibraryScanner = scope.newLibraryScanner(numThreads);
+        pLibraryScanner->start();
+        state.ResumeTiming();
+
+        runScan(pLibraryScanner.get());
+
+        state.PauseTiming();
+        pLibraryScanner.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(
+            state.iterations() * kBenchmarkNumAlbums * kBenchmarkNumTracksPerAlbum);
+}
+BENCHMARK(BM_ScanSyntheticLibrary)
+        ->ArgName("threads")
+        ->Arg(1)
+        ->Arg(2)
+        ->Arg(4)
+        ->Arg(8)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
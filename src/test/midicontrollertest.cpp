@@ -1,3 +1,4 @@
+#include <benchmark/benchmark.h>
 #include <gmock/gmock.h>
 
 #include <QScopedPointer>
@@ -16,7 +17,20 @@ class MockMidiController : public MidiController {
     explicit MockMidiController()
             : MidiController("test") {
     }
-    ~MockMidiController() override { }
+    ~MockMidiController() override {
+        if (getScriptEngine()) {
+            stopEngine();
+        }
+    }
+
+    void startScriptEngine() {
+        startEngine();
+        getScriptEngine()->initialize();
+    }
+
+    ControllerScriptEngineLegacy* scriptEngine() const {
+        return getScriptEngine();
+    }
 
     MOCK_METHOD0(open, int());
     MOCK_METHOD0(close, int());
@@ -25,6 +39,8 @@ class MockMidiController : public MidiController {
                                     unsigned char byte2));
     MOCK_METHOD1(sendBytes, void(const QByteArray& data));
     MOCK_CONST_METHOD0(isPolling, bool());
+
+    using MidiController::receivedShortMessage;
 };
 
 class MidiControllerTest : public MixxxTest {
@@ -596,3 +612,107 @@ TEST_F(MidiControllerTest, ReceiveMessage_PotMeterCO_14BitPitchBend) {
     receivedShortMessage(MidiOpCode::PitchBendChange, channel, 0x01, 0x40);
     EXPECT_LT(kMiddleValue, potmeter.get());
 }
+
+TEST_F(MidiControllerTest, ReceiveMessage_BatchedScriptKeepsOrder) {
+    ControlObject log(ConfigKey("[Test]", "log"));
+    ControlObject seen(ConfigKey("[Test]", "seen"));
+    ControlObject native(ConfigKey("[Test]", "native"));
+    m_pController->startScriptEngine();
+
+    unsigned char channel = 0x01;
+    MidiOptions scriptOptions;
+    scriptOptions.setFlag(MidiOption::Script);
+    addMapping(MidiInputMapping(
+            MidiKey(MidiUtils::statusFromOpCodeAndChannel(
+                            MidiOpCode::ControlChange, channel),
+                    0x10),
+            scriptOptions,
+            ConfigKey("[Test]",
+                    "function(channel, control, value, status, group) {"
+                    "    engine.setValue(group, 'log',"
+                    "            engine.getValue(group, 'log') * 128 + value);"
+                    "    engine.setValue(group, 'seen', engine.getValue(group, 'native'));"
+                    "}")));
+    addMapping(MidiInputMapping(
+            MidiKey(MidiUtils::statusFromOpCodeAndChannel(
+                            MidiOpCode::ControlChange, channel),
+                    0x11),
+            MidiOptions(),
+            native.getKey()));
+    m_pController->setMapping(m_pMapping->clone());
+
+    {
+        ControllerScriptEngineLegacy::ScopedBatch batch(m_pController->scriptEngine());
+        receivedShortMessage(MidiOpCode::ControlChange, channel, 0x10, 1);
+        // Queued until the batch ends
+        EXPECT_DOUBLE_EQ(0.0, log.get());
+
+        // Runs the queued handlers first
+        receivedShortMessage(MidiOpCode::ControlChange, channel, 0x11, 5);
+        EXPECT_DOUBLE_EQ(1.0, log.get());
+        EXPECT_DOUBLE_EQ(0.0, seen.get());
+
+        receivedShortMessage(MidiOpCode::ControlChange, channel, 0x10, 2);
+        EXPECT_DOUBLE_EQ(1.0, log.get());
+    }
+    EXPECT_DOUBLE_EQ(1 * 128 + 2, log.get());
+    EXPECT_DOUBLE_EQ(5.0, seen.get());
+
+    // Without a batch, the handler is called immediately
+    receivedShortMessage(MidiOpCode::ControlChange, channel, 0x10, 3);
+    EXPECT_DOUBLE_EQ((1 * 128 + 2) * 128 + 3, log.get());
+}
+
+namespace {
+
+enum class MappingType {
+    Control,
+    Script,
+    BatchedScript,
+};
+
+// Delivers one poll cycle of control changes to a mapping of the type given
+// by the argument
+static void BM_ReceiveShortMessages(benchmark::State& state) {
+    const auto mappingType = static_cast<MappingType>(state.range(0));
+    constexpr int kMessagesPerPoll = 64;
+    constexpr unsigned char kStatus = 0xB0;
+    constexpr unsigned char kControl = 0x10;
+
+    ControlPotmeter potmeter(ConfigKey("[Test]", "potmeter"), 0.0, 1.0);
+    testing::NiceMock<MockMidiController> controller;
+    controller.startScriptEngine();
+
+    MidiOptions options;
+    ConfigKey key = potmeter.getKey();
+    if (mappingType != MappingType::Control) {
+        options.setFlag(MidiOption::Script);
+        key.item = QStringLiteral(
+                "function(channel, control, value, status, group) {"
+                "    engine.setParameter(group, 'potmeter', value / 127);"
+                "}");
+    }
+    auto pMapping = std::make_shared<LegacyMidiControllerMapping>();
+    pMapping->addInputMapping(MidiKey(kStatus, kControl).key,
+            MidiInputMapping(MidiKey(kStatus, kControl), options, key));
+    controller.setMapping(pMapping);
+
+    const mixxx::Duration timestamp = mixxx::Time::elapsed();
+    for (auto _ : state) {
+        ControllerScriptEngineLegacy::ScopedBatch batch(
+                mappingType == MappingType::BatchedScript
+                        ? controller.scriptEngine()
+                        : nullptr);
+        for (int i = 0; i < kMessagesPerPoll; ++i) {
+            controller.receivedShortMessage(kStatus, kControl, i, timestamp);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kMessagesPerPoll);
+}
+BENCHMARK(BM_ReceiveShortMessages)
+        ->ArgName("mapping")
+        ->Arg(static_cast<int>(MappingType::Control))
+        ->Arg(static_cast<int>(MappingType::Script))
+        ->Arg(static_cast<int>(MappingType::BatchedScript));
+
+} // namespace
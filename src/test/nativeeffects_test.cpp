@@ -1,8 +1,16 @@
-#if 0
-// TODO: make this work again
 #include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "engine/filters/enginefilterbessel8.h"
+#include "engine/filters/enginefilterlinkwitzriley8.h"
+#include "util/samplebuffer.h"
+
+#if 0
+// TODO: make this work again
 #include "control/controlpotmeter.h"
 #include "effects/builtin/autopaneffect.h"
 #include "effects/builtin/bessel4lvmixeqeffect.h"
@@ -19,7 +27,6 @@
 #include "engine/channelhandle.h"
 #include "engine/effects/groupfeaturestate.h"
 #include "test/baseeffecttest.h"
-#include "util/samplebuffer.h"
 
 namespace {
 
@@ -94,3 +101,150 @@ DECLARE_EFFECT_BENCHMARK(ReverbEffect)
 
 }  // namespace
 #endif
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+
+// Processes one channel after the other with the scalar version of the
+// filter sections, as EngineFilterIIR did before it processed both channels
+// in the lanes of one register.
+template<class Filter, unsigned int SIZE>
+class ScalarIIRFilter : public Filter {
+  public:
+    using Filter::Filter;
+
+    void processScalar(const CSAMPLE* pIn, CSAMPLE* pOutput, int bufferSize) {
+        for (int i = 0; i < bufferSize; i += 2) {
+            pOutput[i] = static_cast<CSAMPLE>(this->processSample(
+                    this->m_coef, m_buf1, static_cast<double>(pIn[i])));
+            pOutput[i + 1] = static_cast<CSAMPLE>(this->processSample(
+                    this->m_coef, m_buf2, static_cast<double>(pIn[i + 1])));
+        }
+    }
+
+  private:
+    double m_buf1[SIZE] = {};
+    double m_buf2[SIZE] = {};
+};
+
+using ScalarBessel8Low = ScalarIIRFilter<EngineFilterBessel8Low, 8>;
+using ScalarBessel8Band = ScalarIIRFilter<EngineFilterBessel8Band, 16>;
+using ScalarLinkwitzRiley8High = ScalarIIRFilter<EngineFilterLinkwitzRiley8High, 8>;
+
+void fillTestSignal(mixxx::SampleBuffer* pBuffer) {
+    for (SINT i = 0; i < pBuffer->size(); i += 2) {
+        (*pBuffer)[i] = static_cast<CSAMPLE>(std::sin(i * 0.01) * 0.5);
+        (*pBuffer)[i + 1] = static_cast<CSAMPLE>(std::sin(i * 0.37) * 0.5);
+    }
+}
+
+// Compares the bits instead of the values to also tell apart 0 and -0
+std::uint32_t sampleBits(CSAMPLE sample) {
+    static_assert(sizeof(CSAMPLE) == sizeof(std::uint32_t));
+    std::uint32_t bits;
+    std::memcpy(&bits, &sample, sizeof(bits));
+    return bits;
+}
+
+// Both versions perform the same operations in the same order, so their
+// results are exactly the same. This only holds as long as the compiler
+// does not fuse multiply-adds differently, see -ffp-contract=off for this
+// file in CMakeLists.txt.
+template<class Filter>
+void expectSameAsScalar(Filter* pFilter) {
+    mixxx::SampleBuffer input(1024);
+    fillTestSignal(&input);
+    mixxx::SampleBuffer expected(input.size());
+    mixxx::SampleBuffer output(input.size());
+    pFilter->assumeSettled();
+    for (int i = 0; i < 4; ++i) {
+        pFilter->processScalar(input.data(), expected.data(), input.size());
+        pFilter->process(input.data(), output.data(), input.size());
+        for (SINT j = 0; j < input.size(); ++j) {
+            ASSERT_EQ(sampleBits(expected[j]), sampleBits(output[j]))
+                    << j << ": " << expected[j] << " != " << output[j];
+        }
+    }
+}
+
+TEST(EngineFilterIIRTest, StereoLanesMatchScalar) {
+    ScalarBessel8Low low(kSampleRate, 250);
+    expectSameAsScalar(&low);
+    ScalarBessel8Band band(kSampleRate, 250, 2500);
+    expectSameAsScalar(&band);
+    ScalarLinkwitzRiley8High high(kSampleRate, 2500);
+    expectSameAsScalar(&high);
+}
+
+TEST(EngineFilterIIRTest, InterpolatesCoefficients) {
+    mixxx::SampleBuffer input(1024);
+    fillTestSignal(&input);
+    mixxx::SampleBuffer output(input.size());
+
+    EngineFilterBessel8Low filter(kSampleRate, 250);
+    filter.assumeSettled();
+    filter.process(input.data(), output.data(), input.size());
+    const CSAMPLE lastLeft = output[output.size() - 2];
+
+    // The first sample continues the previous buffer instead of fading in
+    // a filter that starts from silence
+    filter.setFrequencyCorners(kSampleRate, 300);
+    filter.process(input.data(), output.data(), input.size());
+    EXPECT_NEAR(lastLeft, output[0], 0.05);
+    for (SINT i = 0; i < output.size(); ++i) {
+        ASSERT_TRUE(std::isfinite(output[i]));
+        ASSERT_LT(std::abs(output[i]), 1.0f);
+    }
+}
+
+template<class Filter>
+void benchmarkIIR(benchmark::State& state, Filter* pFilter, bool scalar) {
+    mixxx::SampleBuffer input(state.range(0));
+    fillTestSignal(&input);
+    mixxx::SampleBuffer output(input.size());
+    pFilter->assumeSettled();
+    for (auto _ : state) {
+        if (scalar) {
+            pFilter->processScalar(input.data(), output.data(), input.size());
+        } else {
+            pFilter->process(input.data(), output.data(), input.size());
+        }
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * input.size() / 2);
+}
+
+// The filters of Bessel8LVMixEQEffect and LinkwitzRiley8EQEffect
+static void BM_EngineFilterIIR_Bessel8Low_Scalar(benchmark::State& state) {
+    ScalarBessel8Low filter(kSampleRate, 250);
+    benchmarkIIR(state, &filter, true);
+}
+static void BM_EngineFilterIIR_Bessel8Low_Stereo(benchmark::State& state) {
+    ScalarBessel8Low filter(kSampleRate, 250);
+    benchmarkIIR(state, &filter, false);
+}
+static void BM_EngineFilterIIR_Bessel8Band_Scalar(benchmark::State& state) {
+    ScalarBessel8Band filter(kSampleRate, 250, 2500);
+    benchmarkIIR(state, &filter, true);
+}
+static void BM_EngineFilterIIR_Bessel8Band_Stereo(benchmark::State& state) {
+    ScalarBessel8Band filter(kSampleRate, 250, 2500);
+    benchmarkIIR(state, &filter, false);
+}
+static void BM_EngineFilterIIR_LinkwitzRiley8High_Scalar(benchmark::State& state) {
+    ScalarLinkwitzRiley8High filter(kSampleRate, 2500);
+    benchmarkIIR(state, &filter, true);
+}
+static void BM_EngineFilterIIR_LinkwitzRiley8High_Stereo(benchmark::State& state) {
+    ScalarLinkwitzRiley8High filter(kSampleRate, 2500);
+    benchmarkIIR(state, &filter, false);
+}
+BENCHMARK(BM_EngineFilterIIR_Bessel8Low_Scalar)->Arg(128)->Arg(1024);
+BENCHMARK(BM_EngineFilterIIR_Bessel8Low_Stereo)->Arg(128)->Arg(1024);
+BENCHMARK(BM_EngineFilterIIR_Bessel8Band_Scalar)->Arg(128)->Arg(1024);
+BENCHMARK(BM_EngineFilterIIR_Bessel8Band_Stereo)->Arg(128)->Arg(1024);
+BENCHMARK(BM_EngineFilterIIR_LinkwitzRiley8High_Scalar)->Arg(128)->Arg(1024);
+BENCHMARK(BM_EngineFilterIIR_LinkwitzRiley8High_Stereo)->Arg(128)->Arg(1024);
+
+} // namespace
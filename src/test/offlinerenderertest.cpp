@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <cmath>
+
+#include "effects/effectsmanager.h"
+#include "engine/channelhandle.h"
+#include "engine/enginemaster.h"
+#include "engine/offlinerenderer.h"
+#include "mixer/playerinfo.h"
+#include "mixer/playermanager.h"
+#include "sources/soundsourceproxy.h"
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/track.h"
+#include "util/math.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+constexpr SINT kDurationFrames = 44100;
+
+// This setup mirrors CoreServices::initializeForRender()
+class OfflineRendererTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    OfflineRendererTest() {
+        auto pChannelHandleFactory = std::make_shared<ChannelHandleFactory>();
+        m_pEffectsManager = std::make_shared<EffectsManager>(
+                config(), pChannelHandleFactory);
+        m_pEngine = std::make_shared<EngineMaster>(config(),
+                "[Master]",
+                m_pEffectsManager.get(),
+                pChannelHandleFactory,
+                false);
+        m_pPlayerManager = std::make_shared<PlayerManager>(config(),
+                nullptr,
+                m_pEffectsManager.get(),
+                m_pEngine.get());
+        PlayerInfo::create();
+        m_pPlayerManager->addDeck();
+        m_pPlayerManager->addDeck();
+        m_pEffectsManager->setup();
+    }
+
+    ~OfflineRendererTest() override {
+        m_pPlayerManager.reset();
+        PlayerInfo::destroy();
+        m_pEngine.reset();
+        m_pEffectsManager.reset();
+    }
+
+    bool render(const QString& trackLocation) {
+        const QString scriptPath = getTestDataDir().filePath("script.json");
+        QFile scriptFile(scriptPath);
+        EXPECT_TRUE(scriptFile.open(QIODevice::WriteOnly));
+        scriptFile.write(QStringLiteral(R"({
+            "sampleRate": 44100,
+            "bufferFrames": 1000,
+            "durationFrames": %1,
+            "events": [
+                { "frame": 0, "group": "[Channel1]", "load": "%2" },
+                { "frame": 0, "group": "[Channel1]", "key": "play", "value": 1 }
+            ]
+        })")
+                                 .arg(kDurationFrames)
+                                 .arg(trackLocation)
+                                 .toUtf8());
+        scriptFile.close();
+
+        mixxx::OfflineRenderer renderer(
+                config(), m_pEngine.get(), m_pPlayerManager.get());
+        return renderer.render(scriptPath, outputPath());
+    }
+
+    QString outputPath() const {
+        return getTestDataDir().filePath("output.wav");
+    }
+
+    std::shared_ptr<EffectsManager> m_pEffectsManager;
+    std::shared_ptr<EngineMaster> m_pEngine;
+    std::shared_ptr<PlayerManager> m_pPlayerManager;
+};
+
+TEST_F(OfflineRendererTest, RendersPlayingDeck) {
+    ASSERT_TRUE(render(getTestDir().filePath("sine-30.wav")));
+
+    auto pAudioSource = SoundSourceProxy(Track::newTemporary(outputPath()))
+                                .openAudioSource();
+    ASSERT_NE(nullptr, pAudioSource);
+    EXPECT_EQ(mixxx::audio::SampleRate(44100),
+            pAudioSource->getSignalInfo().getSampleRate());
+    ASSERT_EQ(kDurationFrames, pAudioSource->frameLength());
+
+    mixxx::SampleBuffer buffer(pAudioSource->getSignalInfo().frames2samples(
+            pAudioSource->frameLength()));
+    const auto readFrames = pAudioSource->readSampleFrames(
+            mixxx::WritableSampleFrames(pAudioSource->frameIndexRange(),
+                    mixxx::SampleBuffer::WritableSlice(buffer)));
+    pAudioSource->close();
+    ASSERT_EQ(pAudioSource->frameIndexRange(), readFrames.frameIndexRange());
+
+    // The deck starts playing in the first callback, so the sine must be
+    // audible in the first buffer and last until the end.
+    const SINT samplesPerBuffer =
+            pAudioSource->getSignalInfo().frames2samples(1000);
+    for (SINT start = 0; start < buffer.size(); start += samplesPerBuffer) {
+        CSAMPLE peak = 0;
+        for (SINT i = start; i < math_min(start + samplesPerBuffer, buffer.size()); ++i) {
+            peak = math_max(peak, std::abs(buffer[i]));
+        }
+        EXPECT_GT(peak, 0.1f) << "Silence at sample " << start;
+    }
+}
+
+TEST_F(OfflineRendererTest, FailsIfTrackIsMissing) {
+    EXPECT_FALSE(render(getTestDataDir().filePath("missing.wav")));
+}
+
+TEST_F(OfflineRendererTest, FailsIfTrackCannotBeLoaded) {
+    const QString trackLocation = getTestDataDir().filePath("broken.wav");
+    QFile trackFile(trackLocation);
+    ASSERT_TRUE(trackFile.open(QIODevice::WriteOnly));
+    trackFile.write("not audio");
+    trackFile.close();
+
+    EXPECT_FALSE(render(trackLocation));
+}
+
+} // namespace
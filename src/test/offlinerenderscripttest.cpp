@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include "engine/offlinerenderer.h"
+
+namespace {
+
+class OfflineRenderScriptTest : public testing::Test {
+  protected:
+    bool parse(const char* json) {
+        return m_script.parse(QByteArray(json), &m_errorMessage);
+    }
+
+    mixxx::OfflineRenderScript m_script;
+    QString m_errorMessage;
+};
+
+TEST_F(OfflineRenderScriptTest, ParsesEventsInFrameOrder) {
+    ASSERT_TRUE(parse(R"({
+        "sampleRate": 48000,
+        "bufferFrames": 256,
+        "duration": 10,
+        "events": [
+            { "time": 1.5, "group": "[Master]", "key": "crossfader", "value": 0.5 },
+            { "frame": 0, "group": "[Channel1]", "load": "/tmp/track.flac" },
+            { "frame": 0, "group": "[Channel1]", "key": "play", "value": 1 }
+        ]
+    })")) << m_errorMessage.toStdString();
+
+    EXPECT_EQ(mixxx::audio::SampleRate(48000), m_script.sampleRate());
+    EXPECT_EQ(256, m_script.bufferFrames());
+    EXPECT_EQ(480000, m_script.durationFrames());
+
+    const auto& events = m_script.events();
+    ASSERT_EQ(3u, events.size());
+    // Events at the same frame keep the order of the script
+    EXPECT_EQ(0, events[0].frame);
+    EXPECT_EQ(mixxx::OfflineRenderEvent::Type::LoadTrack, events[0].type);
+    EXPECT_EQ(QStringLiteral("[Channel1]"), events[0].key.group);
+    EXPECT_EQ(QStringLiteral("/tmp/track.flac"), events[0].location);
+    EXPECT_EQ(0, events[1].frame);
+    EXPECT_EQ(mixxx::OfflineRenderEvent::Type::SetControl, events[1].type);
+    EXPECT_EQ(ConfigKey("[Channel1]", "play"), events[1].key);
+    EXPECT_EQ(1.0, events[1].value);
+    // 1.5 s at 48 kHz
+    EXPECT_EQ(72000, events[2].frame);
+    EXPECT_EQ(ConfigKey("[Master]", "crossfader"), events[2].key);
+    EXPECT_EQ(0.5, events[2].value);
+}
+
+TEST_F(OfflineRenderScriptTest, Defaults) {
+    ASSERT_TRUE(parse(R"({ "durationFrames": 1000 })"));
+    EXPECT_EQ(mixxx::audio::SampleRate(44100), m_script.sampleRate());
+    EXPECT_EQ(1024, m_script.bufferFrames());
+    EXPECT_EQ(1000, m_script.durationFrames());
+    EXPECT_TRUE(m_script.events().empty());
+}
+
+TEST_F(OfflineRenderScriptTest, RejectsInvalidScripts) {
+    EXPECT_FALSE(parse("not json"));
+    // Missing duration
+    EXPECT_FALSE(parse(R"({ "events": [] })"));
+    // Buffer larger than the engine supports
+    EXPECT_FALSE(parse(R"({ "duration": 1, "bufferFrames": 1000000 })"));
+    // Event without position
+    EXPECT_FALSE(parse(R"({ "duration": 1, "events": [
+        { "group": "[Master]", "key": "crossfader", "value": 0 }
+    ] })"));
+    // Event without value
+    EXPECT_FALSE(parse(R"({ "duration": 1, "events": [
+        { "time": 0, "group": "[Master]", "key": "crossfader" }
+    ] })"));
+    // Negative position
+    EXPECT_FALSE(parse(R"({ "duration": 1, "events": [
+        { "frame": -1, "group": "[Master]", "key": "crossfader", "value": 0 }
+    ] })"));
+}
+
+} // namespace
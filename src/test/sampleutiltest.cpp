@@ -4,6 +4,7 @@
 #include <QList>
 #include <QPair>
 #include <QtDebug>
+#include <cmath>
 #include <vector>
 
 #include "util/sample.h"
@@ -397,6 +398,85 @@ TEST_F(SampleUtilTest, copyReverse) {
     }
 }
 
+// All instruction set variants must produce exactly the same results as the
+// generic implementation, apart from the rounding of the sums.
+TEST_F(SampleUtilTest, isaVariantsMatchGeneric) {
+    const SampleUtil::Isa activeIsa = SampleUtil::activeIsa();
+    for (const auto isa : {SampleUtil::Isa::Avx2, SampleUtil::Isa::Avx512}) {
+        if (!SampleUtil::isIsaSupported(isa)) {
+            continue;
+        }
+        for (int i = 0; i < buffers.size(); ++i) {
+            const int size = sizes[i];
+            const int evenSize = size - size % 2;
+            std::vector<CSAMPLE> source(size);
+            std::vector<CSAMPLE> source2(size);
+            for (int j = 0; j < size; ++j) {
+                source[j] = static_cast<CSAMPLE>(std::sin(j * 0.01) * 1.2);
+                source2[j] = static_cast<CSAMPLE>(std::cos(j * 0.03) * 0.9);
+            }
+
+            std::vector<CSAMPLE> expected(2 * size, 0.5f);
+            std::vector<CSAMPLE> expectedMix(2 * size);
+            std::vector<SAMPLE> expectedS16(size);
+            CSAMPLE expectedAbsL;
+            CSAMPLE expectedAbsR;
+            ASSERT_TRUE(SampleUtil::setActiveIsa(SampleUtil::Isa::Generic));
+            SampleUtil::addWithRampingGain(
+                    expected.data(), source.data(), 0.3f, 0.7f, evenSize);
+            SampleUtil::interleaveBuffer(
+                    expected.data() + size, source.data(), source.data() + size / 2, size / 2);
+            SampleUtil::copy2WithRampingGain(expectedMix.data(),
+                    source.data(), 0.3f, 0.7f,
+                    source2.data(), 0.9f, 0.2f,
+                    evenSize);
+            SampleUtil::copy3WithGain(expectedMix.data() + size,
+                    source.data(), 0.3f,
+                    source2.data(), 0.7f,
+                    source.data(), 1.1f,
+                    size);
+            SampleUtil::convertFloat32ToS16(expectedS16.data(), source.data(), size);
+            const auto expectedClipping = SampleUtil::sumAbsPerChannel(
+                    &expectedAbsL, &expectedAbsR, source.data(), evenSize);
+
+            std::vector<CSAMPLE> actual(2 * size, 0.5f);
+            std::vector<CSAMPLE> actualMix(2 * size);
+            std::vector<SAMPLE> actualS16(size);
+            CSAMPLE actualAbsL;
+            CSAMPLE actualAbsR;
+            ASSERT_TRUE(SampleUtil::setActiveIsa(isa));
+            SampleUtil::addWithRampingGain(
+                    actual.data(), source.data(), 0.3f, 0.7f, evenSize);
+            SampleUtil::interleaveBuffer(
+                    actual.data() + size, source.data(), source.data() + size / 2, size / 2);
+            SampleUtil::copy2WithRampingGain(actualMix.data(),
+                    source.data(), 0.3f, 0.7f,
+                    source2.data(), 0.9f, 0.2f,
+                    evenSize);
+            SampleUtil::copy3WithGain(actualMix.data() + size,
+                    source.data(), 0.3f,
+                    source2.data(), 0.7f,
+                    source.data(), 1.1f,
+                    size);
+            SampleUtil::convertFloat32ToS16(actualS16.data(), source.data(), size);
+            const auto actualClipping = SampleUtil::sumAbsPerChannel(
+                    &actualAbsL, &actualAbsR, source.data(), evenSize);
+
+            EXPECT_EQ(expected, actual) << SampleUtil::isaName(isa);
+            EXPECT_EQ(expectedMix, actualMix) << SampleUtil::isaName(isa);
+            EXPECT_EQ(expectedS16, actualS16) << SampleUtil::isaName(isa);
+            EXPECT_EQ(expectedClipping, actualClipping) << SampleUtil::isaName(isa);
+            // -ffast-math allows to reorder the sums, so they are computed
+            // with as many partial sums as the vector has lanes.
+            EXPECT_NEAR(expectedAbsL, actualAbsL, expectedAbsL * 1e-5f)
+                    << SampleUtil::isaName(isa);
+            EXPECT_NEAR(expectedAbsR, actualAbsR, expectedAbsR * 1e-5f)
+                    << SampleUtil::isaName(isa);
+        }
+    }
+    SampleUtil::setActiveIsa(activeIsa);
+}
+
 static void BM_MemCpy(benchmark::State& state) {
     SINT size = static_cast<SINT>(state.range(0));
     CSAMPLE* buffer = SampleUtil::alloc(size);
@@ -583,4 +663,94 @@ static void BM_Copy2WithRampingGain(benchmark::State& state) {
 }
 BENCHMARK(BM_Copy2WithRampingGain)->Range(64, 4096);
 
+// Benchmarks of the instruction set variants. The first argument is the
+// SampleUtil::Isa, the second one the buffer size in samples.
+class ScopedSampleUtilIsa {
+  public:
+    explicit ScopedSampleUtilIsa(benchmark::State& state)
+            : m_previousIsa(SampleUtil::activeIsa()) {
+        const auto isa = static_cast<SampleUtil::Isa>(state.range(0));
+        if (SampleUtil::setActiveIsa(isa)) {
+            state.SetLabel(SampleUtil::isaName(isa));
+        } else {
+            state.SkipWithError("Instruction set not supported by this CPU");
+        }
+    }
+    ~ScopedSampleUtilIsa() {
+        SampleUtil::setActiveIsa(m_previousIsa);
+    }
+
+  private:
+    const SampleUtil::Isa m_previousIsa;
+};
+
+static void BM_IsaCopyWithGain(benchmark::State& state) {
+    ScopedSampleUtilIsa isa(state);
+    const SINT size = static_cast<SINT>(state.range(1));
+    std::vector<CSAMPLE> dest(size);
+    std::vector<CSAMPLE> src(size, 0.5f);
+    for (auto _ : state) {
+        SampleUtil::copyWithGain(dest.data(), src.data(), 1.1f, size);
+        benchmark::ClobberMemory();
+    }
+}
+
+static void BM_IsaAddWithRampingGain(benchmark::State& state) {
+    ScopedSampleUtilIsa isa(state);
+    const SINT size = static_cast<SINT>(state.range(1));
+    std::vector<CSAMPLE> dest(size);
+    std::vector<CSAMPLE> src(size, 0.5f);
+    for (auto _ : state) {
+        SampleUtil::addWithRampingGain(dest.data(), src.data(), 0.9f, 1.1f, size);
+        benchmark::ClobberMemory();
+    }
+}
+
+static void BM_IsaSumAbsPerChannel(benchmark::State& state) {
+    ScopedSampleUtilIsa isa(state);
+    const SINT size = static_cast<SINT>(state.range(1));
+    std::vector<CSAMPLE> src(size, 0.5f);
+    CSAMPLE absL;
+    CSAMPLE absR;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+                SampleUtil::sumAbsPerChannel(&absL, &absR, src.data(), size));
+    }
+}
+
+static void BM_IsaConvertFloat32ToS16(benchmark::State& state) {
+    ScopedSampleUtilIsa isa(state);
+    const SINT size = static_cast<SINT>(state.range(1));
+    std::vector<SAMPLE> dest(size);
+    std::vector<CSAMPLE> src(size, 0.5f);
+    for (auto _ : state) {
+        SampleUtil::convertFloat32ToS16(dest.data(), src.data(), size);
+        benchmark::ClobberMemory();
+    }
+}
+
+static void BM_IsaInterleaveBuffer(benchmark::State& state) {
+    ScopedSampleUtilIsa isa(state);
+    const SINT size = static_cast<SINT>(state.range(1));
+    std::vector<CSAMPLE> dest(size);
+    std::vector<CSAMPLE> src1(size / 2, 0.5f);
+    std::vector<CSAMPLE> src2(size / 2, 0.25f);
+    for (auto _ : state) {
+        SampleUtil::interleaveBuffer(dest.data(), src1.data(), src2.data(), size / 2);
+        benchmark::ClobberMemory();
+    }
+}
+
+#define ISA_BENCHMARK(name)                                                      \
+    BENCHMARK(name)->ArgsProduct({{static_cast<int64_t>(SampleUtil::Isa::Generic), \
+                                          static_cast<int64_t>(SampleUtil::Isa::Avx2),   \
+                                          static_cast<int64_t>(SampleUtil::Isa::Avx512)}, \
+            benchmark::CreateRange(64, 4096, 8)})
+
+ISA_BENCHMARK(BM_IsaCopyWithGain);
+ISA_BENCHMARK(BM_IsaAddWithRampingGain);
+ISA_BENCHMARK(BM_IsaSumAbsPerChannel);
+ISA_BENCHMARK(BM_IsaConvertFloat32ToS16);
+ISA_BENCHMARK(BM_IsaInterleaveBuffer);
+
 }  // namespace
@@ -996,6 +996,27 @@ TEST_F(SearchQueryParserTest, CrateFilterWithCrateFilterAndNegation){
                  qPrintable(pQueryB->toSql()));
 }
 
+TEST_F(SearchQueryParserTest, SplitIntoPlainTerms) {
+    QStringList terms;
+    EXPECT_TRUE(m_parser.splitIntoPlainTerms(QStringLiteral(" Daft  punk "), &terms));
+    EXPECT_EQ(QStringList({QStringLiteral("Daft"), QStringLiteral("punk")}), terms);
+
+    EXPECT_TRUE(m_parser.splitIntoPlainTerms(QString(), &terms));
+    EXPECT_TRUE(terms.isEmpty());
+
+    // Not a filter
+    EXPECT_TRUE(m_parser.splitIntoPlainTerms(QStringLiteral("12:30"), &terms));
+    EXPECT_EQ(QStringList({QStringLiteral("12:30")}), terms);
+
+    EXPECT_FALSE(m_parser.splitIntoPlainTerms(QStringLiteral("daft artist:punk"), &terms));
+    EXPECT_FALSE(m_parser.splitIntoPlainTerms(QStringLiteral("bpm:>120"), &terms));
+    EXPECT_FALSE(m_parser.splitIntoPlainTerms(QStringLiteral("~key:Am"), &terms));
+    EXPECT_FALSE(m_parser.splitIntoPlainTerms(QStringLiteral("daft -punk"), &terms));
+    EXPECT_FALSE(m_parser.splitIntoPlainTerms(QStringLiteral("\"daft punk\""), &terms));
+    EXPECT_FALSE(m_parser.splitIntoPlainTerms(QStringLiteral("daft%punk"), &terms));
+    EXPECT_FALSE(m_parser.splitIntoPlainTerms(QStringLiteral("daft_punk"), &terms));
+}
+
 TEST_F(SearchQueryParserTest, SplitQueryIntoWords) {
     QStringList rv = SearchQueryParser::splitQueryIntoWords(QString("a test b"));
     QStringList ex = QStringList() << "a"
@@ -0,0 +1,307 @@
+#include "sources/seekindex.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QUrl>
+#include <random>
+
+#include "sources/soundsourceproxy.h"
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/track.h"
+#include "util/fileinfo.h"
+#include "util/samplebuffer.h"
+
+#ifdef __MAD__
+#include "sources/soundsourcemp3.h"
+#endif
+
+namespace {
+
+constexpr SINT kReadFrameCount = 1024;
+
+const QStringList kFileNameSuffixes = {
+        QStringLiteral(".flac"),
+        QStringLiteral("-itunes-12.7.0-aac.m4a"),
+        QStringLiteral("-vbr.mp3"),
+        QStringLiteral(".ogg"),
+        QStringLiteral(".opus"),
+        QStringLiteral(".wav"),
+        QStringLiteral(".wv"),
+};
+
+QString testFilePath(const QString& fileNameSuffix) {
+    return MixxxTest::getOrInitTestDir().filePath(
+            QStringLiteral("id3-test-data/cover-test") + fileNameSuffix);
+}
+
+mixxx::SeekIndex newSeekIndex(int frameCount) {
+    mixxx::SeekIndex seekIndex;
+    for (int i = 0; i <= frameCount; ++i) {
+        seekIndex.append(i * 1152, 100 + i * 417);
+    }
+    seekIndex.setChannelCount(mixxx::audio::ChannelCount::stereo());
+    seekIndex.setSampleRate(mixxx::audio::SampleRate(44100));
+    seekIndex.setBitrate(mixxx::audio::Bitrate(128));
+    return seekIndex;
+}
+
+class SeekIndexTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    SeekIndexTest() {
+        mixxx::SeekIndex::setStorageDirectory(
+                getTestDataDir().filePath(QStringLiteral("seekindex")));
+    }
+    ~SeekIndexTest() override {
+        mixxx::SeekIndex::setStorageDirectory(QString());
+    }
+
+    int countStoredIndexes() const {
+        return QDir(mixxx::SeekIndex::storageDirectory())
+                .entryList(QDir::Files)
+                .size();
+    }
+};
+
+TEST_F(SeekIndexTest, SerializeRoundTrip) {
+    const auto seekIndex = newSeekIndex(10000);
+    const QByteArray data = seekIndex.serialize();
+    // The differences of a constant bitrate stream compress well
+    EXPECT_LT(data.size(), 1000);
+
+    mixxx::SeekIndex restored;
+    ASSERT_TRUE(restored.deserialize(data));
+    EXPECT_TRUE(restored.isValid(100 + 10000 * 417));
+    EXPECT_EQ(seekIndex.getChannelCount(), restored.getChannelCount());
+    EXPECT_EQ(seekIndex.getSampleRate(), restored.getSampleRate());
+    EXPECT_EQ(seekIndex.getBitrate(), restored.getBitrate());
+    ASSERT_EQ(seekIndex.seekPoints().size(), restored.seekPoints().size());
+    for (std::size_t i = 0; i < seekIndex.seekPoints().size(); ++i) {
+        EXPECT_EQ(seekIndex.seekPoints()[i].frameIndex, restored.seekPoints()[i].frameIndex);
+        EXPECT_EQ(seekIndex.seekPoints()[i].byteOffset, restored.seekPoints()[i].byteOffset);
+    }
+
+    EXPECT_FALSE(restored.deserialize(data.left(data.size() / 2)));
+    EXPECT_FALSE(restored.deserialize(QByteArray()));
+}
+
+TEST_F(SeekIndexTest, Validation) {
+    auto seekIndex = newSeekIndex(10);
+    EXPECT_TRUE(seekIndex.isValid(100 + 10 * 417));
+    // Beyond the end of the file
+    EXPECT_FALSE(seekIndex.isValid(100 + 10 * 417 - 1));
+    // Not ordered
+    seekIndex.append(10 * 1152, 100 + 11 * 417);
+    EXPECT_FALSE(seekIndex.isValid(100 + 11 * 417));
+    EXPECT_FALSE(mixxx::SeekIndex().isValid(0));
+}
+
+TEST_F(SeekIndexTest, StoredPerFileAndDecoder) {
+    const mixxx::FileInfo fileInfo(testFilePath(QStringLiteral("-vbr.mp3")));
+    mixxx::SeekIndex seekIndex = newSeekIndex(10);
+    EXPECT_TRUE(seekIndex.save(fileInfo, QStringLiteral("test")));
+    EXPECT_EQ(1, countStoredIndexes());
+
+    mixxx::SeekIndex loaded;
+    EXPECT_TRUE(loaded.load(fileInfo, QStringLiteral("test")));
+    EXPECT_EQ(seekIndex.seekPoints().size(), loaded.seekPoints().size());
+    EXPECT_FALSE(loaded.load(fileInfo, QStringLiteral("other")));
+    EXPECT_FALSE(loaded.load(
+            mixxx::FileInfo(testFilePath(QStringLiteral(".flac"))),
+            QStringLiteral("test")));
+
+    // Nothing is stored without a directory
+    mixxx::SeekIndex::setStorageDirectory(QString());
+    EXPECT_FALSE(seekIndex.save(fileInfo, QStringLiteral("test")));
+    EXPECT_FALSE(loaded.load(fileInfo, QStringLiteral("test")));
+}
+
+TEST_F(SeekIndexTest, PruneRemovesLeastRecentlyStored) {
+    const mixxx::FileInfo fileInfo(testFilePath(QStringLiteral("-vbr.mp3")));
+    const mixxx::SeekIndex seekIndex = newSeekIndex(10);
+    const QStringList decoderNames = {
+            QStringLiteral("first"),
+            QStringLiteral("second"),
+            QStringLiteral("third"),
+    };
+    QDateTime lastModified = QDateTime::currentDateTime().addDays(-1);
+    for (const auto& decoderName : decoderNames) {
+        ASSERT_TRUE(seekIndex.save(fileInfo, decoderName));
+        const QFileInfoList fileInfos =
+                QDir(mixxx::SeekIndex::storageDirectory())
+                        .entryInfoList({QStringLiteral("*.%1.seek").arg(decoderName)});
+        ASSERT_EQ(1, fileInfos.size());
+        QFile file(fileInfos.first().absoluteFilePath());
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.setFileTime(lastModified, QFileDevice::FileModificationTime));
+        lastModified = lastModified.addSecs(60);
+    }
+    const qint64 fileSize = seekIndex.serialize().size();
+
+    mixxx::SeekIndex::prune(3 * fileSize);
+    EXPECT_EQ(3, countStoredIndexes());
+
+    mixxx::SeekIndex::prune(2 * fileSize);
+    EXPECT_EQ(2, countStoredIndexes());
+    mixxx::SeekIndex loaded;
+    EXPECT_FALSE(loaded.load(fileInfo, QStringLiteral("first")));
+    EXPECT_TRUE(loaded.load(fileInfo, QStringLiteral("second")));
+    EXPECT_TRUE(loaded.load(fileInfo, QStringLiteral("third")));
+
+    mixxx::SeekIndex::prune(0);
+    EXPECT_EQ(0, countStoredIndexes());
+}
+
+#ifdef __MAD__
+TEST_F(SeekIndexTest, Mp3ReopenDecodesIdentically) {
+    const QUrl url = QUrl::fromLocalFile(testFilePath(QStringLiteral("-vbr.mp3")));
+    mixxx::SoundSourceProviderMp3 provider;
+
+    const auto pScanned = provider.newSoundSource(url);
+    ASSERT_EQ(mixxx::SoundSource::OpenResult::Succeeded,
+            pScanned->open(mixxx::SoundSource::OpenMode::Strict));
+    EXPECT_EQ(1, countStoredIndexes());
+
+    const auto pIndexed = provider.newSoundSource(url);
+    ASSERT_EQ(mixxx::SoundSource::OpenResult::Succeeded,
+            pIndexed->open(mixxx::SoundSource::OpenMode::Strict));
+    EXPECT_EQ(pScanned->getSignalInfo(), pIndexed->getSignalInfo());
+    EXPECT_EQ(pScanned->getBitrate(), pIndexed->getBitrate());
+    ASSERT_EQ(pScanned->frameIndexRange(), pIndexed->frameIndexRange());
+
+    mixxx::SampleBuffer scannedData(
+            pScanned->getSignalInfo().frames2samples(kReadFrameCount));
+    mixxx::SampleBuffer indexedData(
+            pIndexed->getSignalInfo().frames2samples(kReadFrameCount));
+    // Seek backwards through the file
+    for (SINT frameIndex = pScanned->frameIndexMax() - kReadFrameCount;
+            frameIndex >= pScanned->frameIndexMin();
+            frameIndex -= 10 * kReadFrameCount) {
+        const auto range = mixxx::IndexRange::forward(frameIndex, kReadFrameCount);
+        const auto scanned = pScanned->readSampleFrames(mixxx::WritableSampleFrames(
+                range, mixxx::SampleBuffer::WritableSlice(scannedData)));
+        const auto indexed = pIndexed->readSampleFrames(mixxx::WritableSampleFrames(
+                range, mixxx::SampleBuffer::WritableSlice(indexedData)));
+        ASSERT_EQ(scanned.frameIndexRange(), indexed.frameIndexRange());
+        for (SINT i = 0; i < scannedData.size(); ++i) {
+            ASSERT_EQ(scannedData[i], indexedData[i]) << frameIndex;
+        }
+    }
+}
+#endif
+
+// Opens each test file with each provider that supports it. The
+// arguments select the file, the provider, and whether seek indexes
+// are stored.
+class AudioSourceBenchmarkScope : public SoundSourceProviderRegistration {
+  public:
+    AudioSourceBenchmarkScope(benchmark::State& state, bool storeSeekIndex) {
+        if (storeSeekIndex) {
+            mixxx::SeekIndex::setStorageDirectory(m_storageDir.path());
+        }
+        const int fileIndex = static_cast<int>(state.range(0));
+        const int providerIndex = static_cast<int>(state.range(1));
+        const QString filePath = testFilePath(kFileNameSuffixes.value(fileIndex));
+        const auto registrations =
+                SoundSourceProxy::allProviderRegistrationsForUrl(
+                        QUrl::fromLocalFile(filePath));
+        if (providerIndex < registrations.size()) {
+            m_pTrack = Track::newTemporary(filePath);
+            m_pProvider = registrations[providerIndex].getProvider();
+            state.SetLabel(QString(kFileNameSuffixes.value(fileIndex) +
+                                   QStringLiteral(" ") +
+                                   m_pProvider->getDisplayName())
+                                   .toStdString());
+        }
+    }
+    ~AudioSourceBenchmarkScope() {
+        mixxx::SeekIndex::setStorageDirectory(QString());
+    }
+
+    bool isValid() const {
+        return m_pProvider != nullptr;
+    }
+
+    mixxx::AudioSourcePointer openAudioSource() const {
+        SoundSourceProxy proxy(m_pTrack, m_pProvider);
+        return proxy.openAudioSource();
+    }
+
+  private:
+    const QTemporaryDir m_storageDir;
+    TrackPointer m_pTrack;
+    mixxx::SoundSourceProviderPointer m_pProvider;
+};
+
+void audioSourceArguments(benchmark::internal::Benchmark* pBenchmark) {
+    pBenchmark->ArgNames({"file", "provider"});
+    for (int fileIndex = 0; fileIndex < kFileNameSuffixes.size(); ++fileIndex) {
+        // No file type has more than 3 providers
+        for (int providerIndex = 0; providerIndex < 3; ++providerIndex) {
+            pBenchmark->Args({fileIndex, providerIndex});
+        }
+    }
+}
+
+void openAudioSource(benchmark::State& state, bool storeSeekIndex) {
+    AudioSourceBenchmarkScope scope(state, storeSeekIndex);
+    if (!scope.isValid()) {
+        state.SkipWithError("No such provider");
+        return;
+    }
+    // Stores the seek index, if any
+    if (!scope.openAudioSource()) {
+        state.SkipWithError("Unsupported file");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(scope.openAudioSource());
+    }
+}
+
+static void BM_OpenAudioSource(benchmark::State& state) {
+    openAudioSource(state, false);
+}
+BENCHMARK(BM_OpenAudioSource)->Apply(audioSourceArguments)->Unit(benchmark::kMicrosecond);
+
+static void BM_OpenAudioSourceWithSeekIndex(benchmark::State& state) {
+    openAudioSource(state, true);
+}
+BENCHMARK(BM_OpenAudioSourceWithSeekIndex)
+        ->Apply(audioSourceArguments)
+        ->Unit(benchmark::kMicrosecond);
+
+static void BM_RandomSeek(benchmark::State& state) {
+    AudioSourceBenchmarkScope scope(state, true);
+    if (!scope.isValid()) {
+        state.SkipWithError("No such provider");
+        return;
+    }
+    const auto pAudioSource = scope.openAudioSource();
+    if (!pAudioSource || pAudioSource->frameLength() <= kReadFrameCount) {
+        state.SkipWithError("Unsupported file");
+        return;
+    }
+    mixxx::SampleBuffer buffer(
+            pAudioSource->getSignalInfo().frames2samples(kReadFrameCount));
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<SINT> frameIndices(
+            pAudioSource->frameIndexMin(),
+            pAudioSource->frameIndexMax() - kReadFrameCount);
+    for (auto _ : state) {
+        const auto range = mixxx::IndexRange::forward(
+                frameIndices(generator), kReadFrameCount);
+        benchmark::DoNotOptimize(pAudioSource->readSampleFrames(
+                mixxx::WritableSampleFrames(
+                        range, mixxx::SampleBuffer::WritableSlice(buffer))));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RandomSeek)->Apply(audioSourceArguments)->Unit(benchmark::kMicrosecond);
+
+} // namespace
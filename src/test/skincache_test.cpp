@@ -0,0 +1,81 @@
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "skin/legacy/pixmapsource.h"
+#include "skin/legacy/skindocumentcache.h"
+#include "skin/legacy/svgrastercache.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+const QByteArray kSvgData = QByteArrayLiteral(
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"10\">"
+        "<rect width=\"20\" height=\"10\" fill=\"#ff0000\"/>"
+        "</svg>");
+
+bool writeFile(const QString& filePath, const QByteArray& data) {
+    QFile file(filePath);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+class SkinCacheTest : public MixxxTest {
+  protected:
+    void TearDown() override {
+        SkinDocumentCache::clear();
+        SvgRasterCache::setStorageDirectory(QString());
+    }
+};
+
+TEST_F(SkinCacheTest, DocumentIsParsedAgainAfterModification) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString filePath = QDir(dir.path()).filePath("template.xml");
+
+    ASSERT_TRUE(writeFile(filePath, "<Template><WidgetGroup/></Template>"));
+    const QDomElement first = SkinDocumentCache::load(filePath);
+    EXPECT_EQ(QStringLiteral("Template"), first.tagName());
+    // The parsed document is shared
+    EXPECT_EQ(first, SkinDocumentCache::load(filePath));
+
+    ASSERT_TRUE(writeFile(filePath, "<Template><WidgetGroup/><Label/></Template>"));
+    const QDomElement modified = SkinDocumentCache::load(filePath);
+    EXPECT_NE(first, modified);
+    EXPECT_FALSE(modified.firstChildElement("Label").isNull());
+
+    ASSERT_TRUE(writeFile(filePath, "<Template>"));
+    EXPECT_TRUE(SkinDocumentCache::load(filePath).isNull());
+    ASSERT_TRUE(QFile::remove(filePath));
+    EXPECT_TRUE(SkinDocumentCache::load(filePath).isNull());
+}
+
+TEST_F(SkinCacheTest, SvgIsRenderedOnce) {
+    QTemporaryDir storageDir;
+    ASSERT_TRUE(storageDir.isValid());
+    SvgRasterCache::setStorageDirectory(storageDir.path());
+    const QDir directory(storageDir.path());
+
+    PixmapSource source;
+    source.setSVG(kSvgData);
+    const QImage rendered = SvgRasterCache::render(source, 2.0);
+    ASSERT_FALSE(rendered.isNull());
+    EXPECT_EQ(QSize(40, 20), rendered.size());
+    EXPECT_EQ(QImage::Format_ARGB32, rendered.format());
+    EXPECT_EQ(1, directory.entryList(QDir::Files).size());
+
+    // The second request is answered from the stored image
+    const QImage loaded = SvgRasterCache::render(source, 2.0);
+    EXPECT_EQ(rendered, loaded);
+    EXPECT_EQ(1, directory.entryList(QDir::Files).size());
+
+    // Each scale factor is stored separately
+    EXPECT_EQ(QSize(20, 10), SvgRasterCache::render(source, 1.0).size());
+    EXPECT_EQ(2, directory.entryList(QDir::Files).size());
+
+    PixmapSource invalidSource;
+    invalidSource.setSVG("<svg");
+    EXPECT_TRUE(SvgRasterCache::render(invalidSource, 1.0).isNull());
+    EXPECT_EQ(2, directory.entryList(QDir::Files).size());
+}
+
+} // anonymous namespace
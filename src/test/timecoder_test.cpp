@@ -0,0 +1,314 @@
+#ifdef __VINYLCONTROL__
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QtDebug>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "sources/audiosourcestereoproxy.h"
+#include "sources/soundsourceproxy.h"
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/track.h"
+#include "util/math.h"
+#include "util/samplebuffer.h"
+
+#ifdef _MSC_VER
+#include "timecoder.h"
+#else
+extern "C" {
+#include "timecoder.h"
+}
+#endif
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr int kChannels = TIMECODER_CHANNELS;
+constexpr int kMonitorSize = 64;
+
+// Recordings of timecode vinyl are replayed from this directory if it is
+// set. The file names start with the xwax name of the timecode, e.g.
+// "serato_2a-scratching.wav".
+const char* const kRecordingsDirVariable = "MIXXX_TIMECODE_RECORDINGS";
+
+// Serato 2nd Ed., side A as defined in lib/xwax/timecoder.c
+const char* const kTimecodeName = "serato_2a";
+constexpr unsigned int kTimecodeBits = 20;
+constexpr unsigned int kTimecodeSeed = 0x59017;
+constexpr unsigned int kTimecodeTaps = 0x361e4;
+constexpr double kTimecodeResolution = 1000;
+
+unsigned int nextTimecode(unsigned int code) {
+    unsigned int taken = code & (kTimecodeTaps | 0x1);
+    unsigned int bit = 0;
+    while (taken != 0) {
+        bit ^= taken & 0x1;
+        taken >>= 1;
+    }
+    return (code >> 1) | (bit << (kTimecodeBits - 1));
+}
+
+/// Synthesizes the signal of a timecode vinyl that is played forward with
+/// the given speed. One bit is encoded per cycle in the amplitude of the
+/// primary channel (right), the secondary channel (left) is 90 degrees
+/// ahead of it.
+std::vector<short> synthesizeTimecode(int frames, double speed) {
+    std::vector<short> pcm(frames * kChannels);
+    unsigned int code = kTimecodeSeed;
+    bool bit = false;
+    double phase = 0;
+    const double phaseIncrement = 2 * M_PI * kTimecodeResolution * speed / kSampleRate;
+    for (int i = 0; i < frames; ++i) {
+        const double amplitude = bit ? 0.9 : 0.5;
+        pcm[i * kChannels] = static_cast<short>(std::sin(phase) * 0.9 * SAMPLE_MAXIMUM);
+        pcm[i * kChannels + 1] = static_cast<short>(
+                std::cos(phase) * amplitude * SAMPLE_MAXIMUM);
+        phase += phaseIncrement;
+        if (phase >= 2 * M_PI) {
+            phase -= 2 * M_PI;
+            code = nextTimecode(code);
+            bit = (code >> (kTimecodeBits - 1)) & 0x1;
+        }
+    }
+    return pcm;
+}
+
+std::vector<short> reversed(const std::vector<short>& pcm) {
+    std::vector<short> result(pcm.size());
+    const int frames = static_cast<int>(pcm.size()) / kChannels;
+    for (int i = 0; i < frames; ++i) {
+        std::memcpy(&result[i * kChannels],
+                &pcm[(frames - 1 - i) * kChannels],
+                kChannels * sizeof(short));
+    }
+    return result;
+}
+
+/// A timecoder for every decoding path, initialized the same way
+class Decoder {
+  public:
+    Decoder(const char* name, int sampleRate, bool monitor) {
+        timecode_def* pDef = timecoder_find_definition(name);
+        DEBUG_ASSERT(pDef);
+        timecoder_init(&m_timecoder, pDef, 1.0, sampleRate, false);
+        if (monitor) {
+            timecoder_monitor_init(&m_timecoder, kMonitorSize);
+        }
+    }
+    ~Decoder() {
+        if (m_timecoder.mon) {
+            timecoder_monitor_clear(&m_timecoder);
+        }
+        timecoder_clear(&m_timecoder);
+    }
+
+    timecoder* get() {
+        return &m_timecoder;
+    }
+
+  private:
+    timecoder m_timecoder;
+};
+
+void expectSameState(timecoder* pExpected, timecoder* pActual) {
+    EXPECT_EQ(timecoder_get_position(pExpected, nullptr),
+            timecoder_get_position(pActual, nullptr));
+    EXPECT_EQ(pExpected->bitstream, pActual->bitstream);
+    EXPECT_EQ(pExpected->valid_counter, pActual->valid_counter);
+    EXPECT_EQ(pExpected->timecode_ticker, pActual->timecode_ticker);
+    EXPECT_EQ(pExpected->forwards, pActual->forwards);
+    EXPECT_EQ(pExpected->ref_level, pActual->ref_level);
+    // Only the pitch may differ by rounding errors
+    EXPECT_NEAR(timecoder_get_pitch(pExpected), timecoder_get_pitch(pActual), 1e-9);
+}
+
+/// The result of decoding a signal in blocks of the size of an audio buffer
+struct DecodeResult {
+    // The number of frames until the first valid position was decoded
+    int latencyFrames = -1;
+    int validBlocks = 0;
+    qint64 elapsedNanos = 0;
+};
+
+template<typename Submit>
+DecodeResult decode(timecoder* pTimecoder,
+        const std::vector<short>& pcm,
+        int blockFrames,
+        Submit submit,
+        std::vector<int>* pPositions) {
+    DecodeResult result;
+    const int frames = static_cast<int>(pcm.size()) / kChannels;
+    QElapsedTimer timer;
+    for (int i = 0; i < frames; i += blockFrames) {
+        const int length = math_min(blockFrames, frames - i);
+        timer.start();
+        submit(pTimecoder, const_cast<short*>(&pcm[i * kChannels]), length);
+        result.elapsedNanos += timer.nsecsElapsed();
+        const int position = timecoder_get_position(pTimecoder, nullptr);
+        pPositions->push_back(position);
+        if (position != -1) {
+            ++result.validBlocks;
+            if (result.latencyFrames < 0) {
+                result.latencyFrames = i + length;
+            }
+        }
+    }
+    return result;
+}
+
+void submitScalar(timecoder* pTimecoder, short* pPcm, int frames) {
+    timecoder_submit(pTimecoder, pPcm, frames);
+}
+
+void submitBlock(timecoder* pTimecoder, short* pPcm, int frames) {
+    timecoder_submit_block(pTimecoder, pPcm, frames);
+}
+
+TEST(TimecoderTest, DecodesPosition) {
+    const int frames = 5 * kSampleRate;
+    const std::vector<short> pcm = synthesizeTimecode(frames, 1.0);
+    Decoder decoder(kTimecodeName, kSampleRate, false);
+    timecoder_submit_block(decoder.get(), pcm.data(), frames);
+
+    // One cycle per millisecond
+    EXPECT_NEAR(frames * 1000.0 / kSampleRate,
+            timecoder_get_position(decoder.get(), nullptr),
+            2);
+    EXPECT_NEAR(1.0, timecoder_get_pitch(decoder.get()), 0.01);
+}
+
+TEST(TimecoderTest, BlockDecoderMatchesScalarDecoder) {
+    const std::vector<short> forward = synthesizeTimecode(3 * kSampleRate, 1.0);
+    const std::vector<short> fast = synthesizeTimecode(kSampleRate, 1.35);
+    const std::vector<short> backward = reversed(forward);
+    for (const int blockFrames : {1, 64, 256, 1024}) {
+        SCOPED_TRACE(blockFrames);
+        Decoder scalar(kTimecodeName, kSampleRate, true);
+        Decoder block(kTimecodeName, kSampleRate, true);
+        for (const auto* pPcm : {&forward, &backward, &fast}) {
+            std::vector<int> scalarPositions;
+            std::vector<int> blockPositions;
+            decode(scalar.get(), *pPcm, blockFrames, submitScalar, &scalarPositions);
+            decode(block.get(), *pPcm, blockFrames, submitBlock, &blockPositions);
+            EXPECT_EQ(scalarPositions, blockPositions);
+            expectSameState(scalar.get(), block.get());
+        }
+        EXPECT_EQ(0,
+                std::memcmp(scalar.get()->mon,
+                        block.get()->mon,
+                        kMonitorSize * kMonitorSize));
+    }
+}
+
+class TimecoderRecordingTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    static std::vector<short> readRecording(const QString& filePath, int* pSampleRate) {
+        std::vector<short> pcm;
+        auto pTrack = Track::newTemporary(filePath);
+        SoundSourceProxy proxy(pTrack);
+        mixxx::AudioSource::OpenParams openParams;
+        openParams.setChannelCount(mixxx::audio::ChannelCount(kChannels));
+        auto pAudioSource = proxy.openAudioSource(openParams);
+        if (!pAudioSource) {
+            return pcm;
+        }
+        const auto frameRange = pAudioSource->frameIndexRange();
+        if (pAudioSource->getSignalInfo().getChannelCount() != kChannels) {
+            pAudioSource = mixxx::AudioSourceStereoProxy::create(
+                    pAudioSource, frameRange.length());
+        }
+        *pSampleRate = pAudioSource->getSignalInfo().getSampleRate();
+
+        mixxx::SampleBuffer buffer(frameRange.length() * kChannels);
+        const auto readFrames = pAudioSource->readSampleFrames(
+                mixxx::WritableSampleFrames(frameRange,
+                        mixxx::SampleBuffer::WritableSlice(
+                                buffer.data(), buffer.size())));
+        // The same conversion as in VinylControlXwax without gain
+        pcm.resize(readFrames.readableLength());
+        for (SINT i = 0; i < readFrames.readableLength(); ++i) {
+            pcm[i] = static_cast<short>(math_clamp(
+                    readFrames.readableData()[i] * SAMPLE_MAXIMUM,
+                    static_cast<CSAMPLE>(SAMPLE_MINIMUM),
+                    static_cast<CSAMPLE>(SAMPLE_MAXIMUM)));
+        }
+        return pcm;
+    }
+};
+
+TEST_F(TimecoderRecordingTest, ReplayRecordings) {
+    const QString recordingsDir = qEnvironmentVariable(kRecordingsDirVariable);
+    if (recordingsDir.isEmpty()) {
+        GTEST_SKIP() << kRecordingsDirVariable << " is not set";
+    }
+    const QFileInfoList recordings = QDir(recordingsDir).entryInfoList(
+            QStringList{QStringLiteral("*.wav")}, QDir::Files, QDir::Name);
+    for (const QFileInfo& recording : recordings) {
+        SCOPED_TRACE(recording.fileName().toStdString());
+        const QByteArray name = recording.fileName().section('-', 0, 0).toLatin1();
+        if (!timecoder_find_definition(name.constData())) {
+            qWarning() << "Unknown timecode of" << recording.fileName();
+            continue;
+        }
+        int sampleRate = 0;
+        const std::vector<short> pcm = readRecording(recording.filePath(), &sampleRate);
+        ASSERT_FALSE(pcm.empty());
+
+        // The buffer size of the audio callback at 5 ms latency
+        const int blockFrames = sampleRate / 200;
+        Decoder scalar(name.constData(), sampleRate, false);
+        Decoder block(name.constData(), sampleRate, false);
+        std::vector<int> scalarPositions;
+        std::vector<int> blockPositions;
+        const DecodeResult scalarResult = decode(
+                scalar.get(), pcm, blockFrames, submitScalar, &scalarPositions);
+        const DecodeResult blockResult = decode(
+                block.get(), pcm, blockFrames, submitBlock, &blockPositions);
+        // The accuracy must not change
+        EXPECT_EQ(scalarPositions, blockPositions);
+        EXPECT_EQ(scalarResult.latencyFrames, blockResult.latencyFrames);
+
+        qInfo() << recording.fileName()
+                << "valid blocks:" << blockResult.validBlocks << '/'
+                << blockPositions.size()
+                << "first position after"
+                << blockResult.latencyFrames * 1000.0 / sampleRate << "ms"
+                << "decoding time:" << scalarResult.elapsedNanos / 1000 << "us scalar,"
+                << blockResult.elapsedNanos / 1000 << "us block";
+    }
+}
+
+template<typename Submit>
+void decodeBenchmark(benchmark::State& state, Submit submit) {
+    const int blockFrames = static_cast<int>(state.range(0));
+    const std::vector<short> pcm = synthesizeTimecode(kSampleRate, 1.0);
+    const int frames = static_cast<int>(pcm.size()) / kChannels;
+    Decoder decoder(kTimecodeName, kSampleRate, true);
+    for (auto _ : state) {
+        for (int i = 0; i + blockFrames <= frames; i += blockFrames) {
+            submit(decoder.get(), const_cast<short*>(&pcm[i * kChannels]), blockFrames);
+        }
+        benchmark::DoNotOptimize(decoder.get()->bitstream);
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+
+static void BM_TimecoderSubmit(benchmark::State& state) {
+    decodeBenchmark(state, submitScalar);
+}
+BENCHMARK(BM_TimecoderSubmit)->Range(64, 1024);
+
+static void BM_TimecoderSubmitBlock(benchmark::State& state) {
+    decodeBenchmark(state, submitBlock);
+}
+BENCHMARK(BM_TimecoderSubmitBlock)->Range(64, 1024);
+
+} // namespace
+
+#endif // __VINYLCONTROL__
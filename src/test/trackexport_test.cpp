@@ -300,3 +300,62 @@ TEST_F(TrackExporterTest, MungeFilename) {
     // Remove the track we created.
     tempPath.remove("cover-test.ogg");
 }
+
+TEST_F(TrackExporterTest, SkipUpToDate) {
+    // Export the same track twice.  The second export must neither ask
+    // about the existing file nor copy it again.
+    mixxx::FileInfo fileinfo1(m_testDataDir.filePath("cover-test.ogg"));
+    TrackPointer track1(Track::newTemporary(mixxx::FileAccess(fileinfo1)));
+    TrackPointerList tracks;
+    tracks.append(track1);
+
+    TrackExportWorker worker1(m_exportDir.canonicalPath(), tracks);
+    m_answerer.reset(new FakeOverwriteAnswerer(&worker1));
+    worker1.run();
+    EXPECT_TRUE(worker1.wait(10000));
+
+    QFileInfo newfile1(m_exportDir.filePath("cover-test.ogg"));
+    ASSERT_TRUE(newfile1.exists());
+    EXPECT_EQ(fileinfo1.sizeInBytes(), newfile1.size());
+    // The modification time of the source is adopted
+    EXPECT_LE(qAbs(fileinfo1.lastModified().msecsTo(newfile1.lastModified())), 2000);
+
+    // No answer is set, so the answerer fails if it is asked.
+    TrackExportWorker worker2(m_exportDir.canonicalPath(), tracks);
+    m_answerer.reset(new FakeOverwriteAnswerer(&worker2));
+    worker2.run();
+    EXPECT_TRUE(worker2.wait(10000));
+
+    EXPECT_EQ(1, m_answerer->currentProgress());
+    EXPECT_EQ(1, m_answerer->currentProgressCount());
+}
+
+TEST_F(TrackExporterTest, UpToDateComparesContent) {
+    const QString sourcePath = m_testDataDir.filePath("cover-test.ogg");
+    const QString targetPath = m_exportDir.filePath("cover-test.ogg");
+    ASSERT_TRUE(QFile::copy(sourcePath, targetPath));
+    const QDateTime lastModified = QFileInfo(sourcePath).lastModified();
+
+    // Same content with a different modification time
+    {
+        QFile target(targetPath);
+        ASSERT_TRUE(target.open(QIODevice::Append));
+        ASSERT_TRUE(target.setFileTime(lastModified.addDays(-1),
+                QFileDevice::FileModificationTime));
+    }
+    EXPECT_TRUE(ExportFileCopier::isUpToDate(sourcePath, targetPath));
+    EXPECT_LE(qAbs(lastModified.msecsTo(QFileInfo(targetPath).lastModified())), 2000);
+
+    // Same size with a different content
+    {
+        QFile target(targetPath);
+        ASSERT_TRUE(target.open(QIODevice::ReadWrite));
+        const QByteArray firstByte = target.read(1);
+        ASSERT_EQ(1, firstByte.size());
+        ASSERT_TRUE(target.seek(0));
+        ASSERT_EQ(1, target.write(QByteArray(1, static_cast<char>(~firstByte.at(0)))));
+        ASSERT_TRUE(target.setFileTime(lastModified.addDays(-1),
+                QFileDevice::FileModificationTime));
+    }
+    EXPECT_FALSE(ExportFileCopier::isUpToDate(sourcePath, targetPath));
+}
@@ -0,0 +1,236 @@
+#include "library/tracksearchindex.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QRandomGenerator>
+#include <QVector>
+
+#include "util/db/dbconnection.h"
+
+namespace {
+
+const QVector<TrackSearchIndex::ColumnType> kColumnTypes = {
+        TrackSearchIndex::ColumnType::Text, // artist
+        TrackSearchIndex::ColumnType::Text, // title
+        TrackSearchIndex::ColumnType::Path, // location
+};
+
+const QStringList kWords = {
+        QStringLiteral("Björk"),
+        QStringLiteral("Jóga"),
+        QStringLiteral("Homogenic"),
+        QStringLiteral("Daft"),
+        QStringLiteral("Punk"),
+        QStringLiteral("Around"),
+        QStringLiteral("World"),
+        QStringLiteral("Café"),
+        QStringLiteral("del"),
+        QStringLiteral("Mar"),
+        QStringLiteral("Energy"),
+        QStringLiteral("52"),
+        QStringLiteral("Sigur"),
+        QStringLiteral("Rós"),
+        QStringLiteral("Hoppípolla"),
+        QStringLiteral("Mixxx"),
+};
+
+QString randomWords(QRandomGenerator* pRandom, int count) {
+    QStringList words;
+    for (int i = 0; i < count; ++i) {
+        words.append(kWords[pRandom->bounded(kWords.size())]);
+    }
+    return words.join(QChar(' '));
+}
+
+QStringList randomTrack(QRandomGenerator* pRandom, int trackNumber) {
+    const QString artist = randomWords(pRandom, 1 + pRandom->bounded(2));
+    const QString title = randomWords(pRandom, 1 + pRandom->bounded(4));
+    const QString location = QStringLiteral("/home/user/Music/%1/%2/%3 - %4.mp3")
+                                     .arg(artist,
+                                             randomWords(pRandom, 2),
+                                             QString::number(trackNumber),
+                                             title);
+    return {artist, title, location};
+}
+
+void populate(TrackSearchIndex* pIndex, int numTracks, QVector<QStringList>* pTracks) {
+    QRandomGenerator random(42);
+    pIndex->reset(kColumnTypes);
+    for (int i = 0; i < numTracks; ++i) {
+        const QStringList values = randomTrack(&random, i);
+        pIndex->updateTrack(TrackId(i + 1), values);
+        if (pTracks) {
+            pTracks->append(values);
+        }
+    }
+}
+
+class TrackSearchIndexTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        m_index.reset(kColumnTypes);
+    }
+
+    QList<int> matchingTrackIds(const QString& term,
+            const std::vector<int>* pCandidateRows = nullptr) const {
+        QList<int> trackIds;
+        for (const int row : m_index.matchTerm(term, pCandidateRows)) {
+            trackIds.append(m_index.trackIdOfRow(row).value());
+        }
+        return trackIds;
+    }
+
+    TrackSearchIndex m_index;
+};
+
+TEST_F(TrackSearchIndexTest, IgnoresCaseAndDiacritics) {
+    m_index.updateTrack(TrackId(1),
+            {QStringLiteral("Björk"),
+                    QStringLiteral("Jóga"),
+                    QStringLiteral("/music/Björk/Homogenic/02 - Jóga.flac")});
+    m_index.updateTrack(TrackId(2),
+            {QStringLiteral("Sigur Rós"),
+                    QStringLiteral("Hoppípolla"),
+                    QStringLiteral("/music/Sigur Rós/Takk/03 - Hoppípolla.flac")});
+
+    EXPECT_EQ(QList<int>({1}), matchingTrackIds(QStringLiteral("bjork")));
+    EXPECT_EQ(QList<int>({1}), matchingTrackIds(QStringLiteral("JÓGA")));
+    EXPECT_EQ(QList<int>({2}), matchingTrackIds(QStringLiteral("ros")));
+    EXPECT_EQ(QList<int>({1, 2}), matchingTrackIds(QStringLiteral("o")));
+    EXPECT_EQ(QList<int>({1, 2}), matchingTrackIds(QStringLiteral("fl")));
+    EXPECT_EQ(QList<int>({2}), matchingTrackIds(QStringLiteral("takk")));
+    EXPECT_TRUE(matchingTrackIds(QStringLiteral("homogenicx")).isEmpty());
+    EXPECT_TRUE(matchingTrackIds(QStringLiteral("z")).isEmpty());
+}
+
+TEST_F(TrackSearchIndexTest, PathTermsSpanDirectoryAndFileName) {
+    m_index.updateTrack(TrackId(1),
+            {QString(), QString(), QStringLiteral("/music/Album/01 - Intro.mp3")});
+    m_index.updateTrack(TrackId(2),
+            {QString(), QString(), QStringLiteral("Intro.mp3")});
+
+    EXPECT_EQ(QList<int>({1}), matchingTrackIds(QStringLiteral("album/01")));
+    EXPECT_EQ(QList<int>({1}), matchingTrackIds(QStringLiteral("/music/")));
+    EXPECT_EQ(QList<int>({1, 2}), matchingTrackIds(QStringLiteral("intro.mp3")));
+    EXPECT_TRUE(matchingTrackIds(QStringLiteral("album01")).isEmpty());
+}
+
+TEST_F(TrackSearchIndexTest, UpdateAndRemoveTracks) {
+    m_index.updateTrack(TrackId(1),
+            {QStringLiteral("Daft Punk"), QStringLiteral("Around the World"), QString()});
+    m_index.updateTrack(TrackId(2),
+            {QStringLiteral("Daft Punk"), QStringLiteral("One More Time"), QString()});
+    EXPECT_EQ(2, m_index.trackCount());
+    EXPECT_EQ(QList<int>({1, 2}), matchingTrackIds(QStringLiteral("daft")));
+
+    const auto generation = m_index.generation();
+    m_index.updateTrack(TrackId(1),
+            {QStringLiteral("Kraftwerk"), QStringLiteral("Around the World"), QString()});
+    EXPECT_NE(generation, m_index.generation());
+    EXPECT_EQ(2, m_index.trackCount());
+    EXPECT_EQ(QList<int>({2}), matchingTrackIds(QStringLiteral("daft")));
+    EXPECT_EQ(QList<int>({1}), matchingTrackIds(QStringLiteral("kraft")));
+
+    m_index.removeTrack(TrackId(2));
+    EXPECT_EQ(1, m_index.trackCount());
+    EXPECT_FALSE(m_index.containsTrack(TrackId(2)));
+    EXPECT_EQ(-1, m_index.rowOfTrack(TrackId(2)));
+    EXPECT_TRUE(matchingTrackIds(QStringLiteral("daft")).isEmpty());
+    EXPECT_TRUE(matchingTrackIds(QStringLiteral("time")).isEmpty());
+    EXPECT_EQ(QList<int>({1}), matchingTrackIds(QStringLiteral("world")));
+}
+
+TEST_F(TrackSearchIndexTest, CandidateRows) {
+    for (int i = 1; i <= 100; ++i) {
+        m_index.updateTrack(TrackId(i),
+                {QStringLiteral("Artist %1").arg(i), QStringLiteral("Title"), QString()});
+    }
+    const std::vector<int> candidateRows = {
+            m_index.rowOfTrack(TrackId(10)),
+            m_index.rowOfTrack(TrackId(20)),
+            m_index.rowOfTrack(TrackId(21)),
+            m_index.rowOfTrack(TrackId(30))};
+    EXPECT_EQ(QList<int>({10, 20, 21, 30}),
+            matchingTrackIds(QStringLiteral("title"), &candidateRows));
+    EXPECT_EQ(QList<int>({20, 21}),
+            matchingTrackIds(QStringLiteral("artist 2"), &candidateRows));
+}
+
+TEST_F(TrackSearchIndexTest, MatchesLikeStringContains) {
+    QVector<QStringList> tracks;
+    populate(&m_index, 2000, &tracks);
+
+    const QStringList terms = {
+            QStringLiteral("o"),
+            QStringLiteral("ro"),
+            QStringLiteral("rós"),
+            QStringLiteral("hoppi"),
+            QStringLiteral("punk around"),
+            QStringLiteral("e 5"),
+            QStringLiteral("52/"),
+            QStringLiteral("mixxx/"),
+            QStringLiteral("cafe del"),
+            QStringLiteral("music/"),
+            QStringLiteral(".mp3"),
+            QStringLiteral("1 - "),
+            QStringLiteral("nothing"),
+    };
+    for (const auto& term : terms) {
+        QString foldedTerm = term;
+        mixxx::DbConnection::makeStringLatinLow(&foldedTerm);
+        QList<int> expectedTrackIds;
+        for (int i = 0; i < tracks.size(); ++i) {
+            for (QString value : tracks[i]) {
+                mixxx::DbConnection::makeStringLatinLow(&value);
+                if (value.contains(foldedTerm)) {
+                    expectedTrackIds.append(i + 1);
+                    break;
+                }
+            }
+        }
+        EXPECT_EQ(expectedTrackIds, matchingTrackIds(term)) << term.toStdString();
+    }
+}
+
+class TrackSearchIndexBenchmark {
+  public:
+    TrackSearchIndexBenchmark() {
+        populate(&m_index, 300000, nullptr);
+    }
+
+    TrackSearchIndex m_index;
+};
+
+TrackSearchIndexBenchmark* benchmarkIndex() {
+    // Built once for all benchmarks
+    static auto* const s_pBenchmark = new TrackSearchIndexBenchmark();
+    return s_pBenchmark;
+}
+
+// Simulates typing a search term on a library with 300k tracks
+static void BM_TypeSearchTerm(benchmark::State& state) {
+    const TrackSearchIndex& index = benchmarkIndex()->m_index;
+    const QString term = QStringLiteral("hoppipolla");
+    const bool refine = state.range(0) != 0;
+    for (auto _ : state) {
+        std::vector<int> rows;
+        for (int i = 1; i <= term.size(); ++i) {
+            rows = index.matchTerm(term.left(i), refine && i > 1 ? &rows : nullptr);
+        }
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetItemsProcessed(state.iterations() * term.size());
+}
+BENCHMARK(BM_TypeSearchTerm)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+static void BM_MatchTerm(benchmark::State& state) {
+    const TrackSearchIndex& index = benchmarkIndex()->m_index;
+    const QString term = QStringLiteral("homogenic").left(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.matchTerm(term));
+    }
+}
+BENCHMARK(BM_MatchTerm)->DenseRange(1, 5)->Arg(9)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,253 @@
+#include "waveform/waveformblockfile.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <random>
+
+#include "waveform/waveform.h"
+#include "waveform/waveformfactory.h"
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr int kVisualSampleRate = 441;
+constexpr int kBlockSize = 1024;
+
+// A waveform of the given duration filled with non-zero data
+std::unique_ptr<Waveform> newWaveform(int seconds) {
+    auto pWaveform = std::make_unique<Waveform>(
+            kSampleRate, kSampleRate * 2 * seconds, kVisualSampleRate, -1);
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> values(1, 255);
+    WaveformData* pData = pWaveform->data();
+    for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+        pData[i].filtered.low = static_cast<unsigned char>(values(generator));
+        pData[i].filtered.mid = static_cast<unsigned char>(values(generator));
+        pData[i].filtered.high = static_cast<unsigned char>(values(generator));
+        pData[i].filtered.all = static_cast<unsigned char>(values(generator));
+    }
+    pWaveform->setCompletion(pWaveform->getDataSize());
+    return pWaveform;
+}
+
+bool isLoaded(const Waveform& waveform, int index) {
+    return waveform.get(index).m_i != 0;
+}
+
+class WaveformBlockFileTest : public testing::Test {
+  protected:
+    WaveformBlockFileTest()
+            : m_pWaveform(newWaveform(60)),
+              m_filePath(m_dir.filePath(QStringLiteral("waveform"))) {
+    }
+
+    bool writeFile() const {
+        WaveformBlockFileWriter writer(kBlockSize);
+        return writer.open(m_filePath, *m_pWaveform) &&
+                writer.finish(*m_pWaveform);
+    }
+
+    void expectEqualData(const Waveform& waveform, int first, int last) const {
+        for (int i = first; i < last; ++i) {
+            ASSERT_EQ(m_pWaveform->get(i).m_i, waveform.get(i).m_i) << i;
+        }
+    }
+
+    const QTemporaryDir m_dir;
+    const std::unique_ptr<Waveform> m_pWaveform;
+    const QString m_filePath;
+};
+
+TEST_F(WaveformBlockFileTest, RoundTrip) {
+    ASSERT_TRUE(writeFile());
+    auto pBlockFile = WaveformBlockFile::open(m_filePath);
+    ASSERT_NE(nullptr, pBlockFile);
+    EXPECT_EQ(m_pWaveform->getDataSize(), pBlockFile->dataSize());
+    EXPECT_EQ(kBlockSize, pBlockFile->blockSize());
+    EXPECT_EQ((m_pWaveform->getDataSize() + kBlockSize - 1) / kBlockSize,
+            pBlockFile->blockCount());
+
+    const Waveform waveform(std::move(pBlockFile));
+    EXPECT_TRUE(waveform.isValid());
+    EXPECT_EQ(Waveform::SaveState::Saved, waveform.saveState());
+    EXPECT_EQ(m_pWaveform->getDataSize(), waveform.getDataSize());
+    EXPECT_EQ(m_pWaveform->getDataSize(), waveform.getCompletion());
+    EXPECT_EQ(m_pWaveform->getTextureStride(), waveform.getTextureStride());
+    EXPECT_DOUBLE_EQ(m_pWaveform->getVisualSampleRate(), waveform.getVisualSampleRate());
+    EXPECT_DOUBLE_EQ(m_pWaveform->getAudioVisualRatio(), waveform.getAudioVisualRatio());
+    waveform.loadAll();
+    expectEqualData(waveform, 0, waveform.getDataSize());
+}
+
+TEST_F(WaveformBlockFileTest, LoadFromAnalysis) {
+    ASSERT_TRUE(writeFile());
+    ASSERT_TRUE(WaveformBlockFile::open(m_filePath)->verifyBlocks());
+    AnalysisDao::AnalysisInfo analysis;
+    analysis.type = AnalysisDao::TYPE_WAVEFORM;
+    analysis.dataPath = m_filePath;
+    const std::unique_ptr<Waveform> pWaveform(
+            WaveformFactory::loadWaveformFromAnalysis(analysis));
+    ASSERT_NE(nullptr, pWaveform);
+    const Waveform& waveform = *pWaveform;
+    EXPECT_TRUE(waveform.isValid());
+    waveform.loadAll();
+    expectEqualData(waveform, 0, waveform.getDataSize());
+}
+
+TEST_F(WaveformBlockFileTest, LoadsOnlyRequestedBlocks) {
+    ASSERT_TRUE(writeFile());
+    const Waveform waveform(WaveformBlockFile::open(m_filePath));
+    EXPECT_FALSE(isLoaded(waveform, 0));
+
+    waveform.loadRange(3 * kBlockSize + 10, 4 * kBlockSize + 10);
+    EXPECT_FALSE(isLoaded(waveform, 3 * kBlockSize - 1));
+    expectEqualData(waveform, 3 * kBlockSize, 5 * kBlockSize);
+    EXPECT_FALSE(isLoaded(waveform, 5 * kBlockSize));
+
+    // Out of range
+    waveform.loadRange(-kBlockSize, 1);
+    EXPECT_TRUE(isLoaded(waveform, 0));
+    waveform.loadRange(waveform.getDataSize() - 1, waveform.getDataSize() + kBlockSize);
+    EXPECT_TRUE(isLoaded(waveform, waveform.getDataSize() - 1));
+}
+
+TEST_F(WaveformBlockFileTest, ProgressiveWrite) {
+    WaveformBlockFileWriter writer(kBlockSize);
+    ASSERT_TRUE(writer.open(m_filePath, *m_pWaveform));
+    ASSERT_TRUE(writer.write(*m_pWaveform, kBlockSize - 1));
+    ASSERT_TRUE(writer.write(*m_pWaveform, 2 * kBlockSize + 1));
+
+    // Unfinished
+    quint16 checksum = 0;
+    EXPECT_FALSE(WaveformBlockFile::probe(m_filePath, &checksum));
+    EXPECT_EQ(nullptr, WaveformBlockFile::open(m_filePath));
+
+    ASSERT_TRUE(writer.write(*m_pWaveform, m_pWaveform->getDataSize() / 2));
+    ASSERT_TRUE(writer.finish(*m_pWaveform));
+    int dataSize = 0;
+    EXPECT_TRUE(WaveformBlockFile::probe(m_filePath, &checksum, &dataSize));
+    EXPECT_EQ(writer.indexChecksum(), checksum);
+    EXPECT_EQ(m_pWaveform->getDataSize(), dataSize);
+
+    const Waveform waveform(WaveformBlockFile::open(m_filePath));
+    waveform.loadAll();
+    expectEqualData(waveform, 0, waveform.getDataSize());
+}
+
+TEST_F(WaveformBlockFileTest, AbortRemovesFile) {
+    {
+        WaveformBlockFileWriter writer(kBlockSize);
+        ASSERT_TRUE(writer.open(m_filePath, *m_pWaveform));
+        ASSERT_TRUE(writer.write(*m_pWaveform, 4 * kBlockSize));
+    }
+    EXPECT_FALSE(QFile::exists(m_filePath));
+}
+
+TEST_F(WaveformBlockFileTest, ConcurrentWritersOfSameFile) {
+    WaveformBlockFileWriter writer1(kBlockSize);
+    ASSERT_TRUE(writer1.open(m_filePath, *m_pWaveform));
+    ASSERT_TRUE(writer1.write(*m_pWaveform, 2 * kBlockSize));
+    {
+        WaveformBlockFileWriter writer2(kBlockSize);
+        ASSERT_TRUE(writer2.open(m_filePath, *m_pWaveform));
+        ASSERT_TRUE(writer2.write(*m_pWaveform, 4 * kBlockSize));
+        ASSERT_TRUE(writer1.write(*m_pWaveform, 3 * kBlockSize));
+        ASSERT_TRUE(writer2.finish(*m_pWaveform));
+    }
+    ASSERT_TRUE(writer1.write(*m_pWaveform, m_pWaveform->getDataSize() / 2));
+
+    // The finished file is not affected by the other writer
+    quint16 checksum = 0;
+    ASSERT_TRUE(WaveformBlockFile::probe(m_filePath, &checksum));
+    writer1.abort();
+    ASSERT_TRUE(WaveformBlockFile::probe(m_filePath, &checksum));
+
+    const Waveform waveform(WaveformBlockFile::open(m_filePath));
+    waveform.loadAll();
+    expectEqualData(waveform, 0, waveform.getDataSize());
+}
+
+TEST_F(WaveformBlockFileTest, CorruptBlock) {
+    ASSERT_TRUE(writeFile());
+    {
+        // Overwrite a byte of the first block after the header
+        QFile file(m_filePath);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.seek(100));
+        char byte = 0;
+        ASSERT_TRUE(file.getChar(&byte));
+        ASSERT_TRUE(file.seek(100));
+        ASSERT_TRUE(file.putChar(static_cast<char>(~byte)));
+    }
+    auto pBlockFile = WaveformBlockFile::open(m_filePath);
+    ASSERT_NE(nullptr, pBlockFile);
+    EXPECT_FALSE(pBlockFile->verifyBlocks());
+
+    // Corruption that is only detected while rendering
+    const Waveform waveform(std::move(pBlockFile));
+    ASSERT_TRUE(waveform.isValid());
+    waveform.loadAll();
+    EXPECT_FALSE(isLoaded(waveform, 0));
+    expectEqualData(waveform, kBlockSize, waveform.getDataSize());
+
+    // The analyzer runs again
+    AnalysisDao::AnalysisInfo analysis;
+    analysis.type = AnalysisDao::TYPE_WAVEFORM;
+    analysis.dataPath = m_filePath;
+    EXPECT_EQ(nullptr, WaveformFactory::loadWaveformFromAnalysis(analysis));
+}
+
+TEST_F(WaveformBlockFileTest, NotABlockFile) {
+    {
+        QFile file(m_filePath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(qCompress(m_pWaveform->toByteArray()));
+    }
+    quint16 checksum = 0;
+    EXPECT_FALSE(WaveformBlockFile::probe(m_filePath, &checksum));
+    EXPECT_EQ(nullptr, WaveformBlockFile::open(m_filePath));
+    EXPECT_FALSE(Waveform(WaveformBlockFile::open(m_filePath)).isValid());
+
+    AnalysisDao::AnalysisInfo analysis;
+    analysis.type = AnalysisDao::TYPE_WAVEFORM;
+    analysis.dataPath = m_filePath;
+    EXPECT_EQ(nullptr, WaveformFactory::loadWaveformFromAnalysis(analysis));
+}
+
+// The same 5 minute track in both formats. The scrolling waveform usually
+// displays a few seconds of it.
+static void BM_LoadWaveformProto(benchmark::State& state) {
+    const auto pWaveform = newWaveform(300);
+    const QByteArray compressedData = qCompress(pWaveform->toByteArray());
+    for (auto _ : state) {
+        const Waveform waveform(qUncompress(compressedData));
+        benchmark::DoNotOptimize(waveform.data());
+    }
+    state.SetBytesProcessed(state.iterations() * compressedData.size());
+}
+BENCHMARK(BM_LoadWaveformProto)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadWaveformBlockFileVisibleRegion(benchmark::State& state) {
+    const auto pWaveform = newWaveform(300);
+    const QTemporaryDir dir;
+    const QString filePath = dir.filePath(QStringLiteral("waveform"));
+    WaveformBlockFileWriter writer;
+    if (!writer.open(filePath, *pWaveform) || !writer.finish(*pWaveform)) {
+        state.SkipWithError("Failed to write file");
+        return;
+    }
+    // 10 seconds of stereo data
+    const int visibleSize = 10 * kVisualSampleRate * 2;
+    for (auto _ : state) {
+        const Waveform waveform(WaveformBlockFile::open(filePath));
+        const int first = waveform.getDataSize() / 2;
+        waveform.loadRange(first, first + visibleSize);
+        benchmark::DoNotOptimize(waveform.data());
+    }
+}
+BENCHMARK(BM_LoadWaveformBlockFileVisibleRegion)->Unit(benchmark::kMillisecond);
+
+} // namespace
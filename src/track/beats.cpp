@@ -1,5 +1,6 @@
 #include "track/beats.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iterator>
 #include <vector>
@@ -20,6 +21,10 @@ struct BeatGridV1Data {
 
 constexpr double kEpsilon = 0.01;
 
+// The size of the lookup tables in relation to the number of markers. On
+// average, a lookup has to step over less than a single marker.
+constexpr int kIndexBucketsPerMarker = 2;
+
 } // namespace
 
 namespace mixxx {
@@ -59,24 +64,7 @@ Beats::ConstIterator Beats::ConstIterator::operator+=(Beats::ConstIterator::diff
     }
 
     DEBUG_ASSERT(n > 0);
-    const int beatOffset = m_beatOffset + n;
-
-    // Detect integer overflow
-    if (beatOffset < m_beatOffset) {
-        qWarning() << "Beats: Iterator would go out of possible range, capping "
-                      "at latest possible position.";
-        m_it = m_beats->m_markers.cend();
-        m_beatOffset = std::numeric_limits<Beats::ConstIterator::difference_type>::max();
-        updateValue();
-        return *this;
-    }
-
-    m_beatOffset = beatOffset;
-    while (m_it != m_beats->m_markers.cend() && m_beatOffset >= m_it->beatsTillNextMarker()) {
-        m_beatOffset -= m_it->beatsTillNextMarker();
-        m_it++;
-    }
-    updateValue();
+    setBeatNumber(m_beats->beatNumber(m_it, m_beatOffset) + n);
     return *this;
 }
 
@@ -102,46 +90,51 @@ Beats::ConstIterator Beats::ConstIterator::operator-=(Beats::ConstIterator::diff
     }
 
     DEBUG_ASSERT(n > 0);
-    const int beatOffset = m_beatOffset - n;
-
-    // Detect integer overflow
-    if (beatOffset > m_beatOffset) {
-        qWarning() << "Beats: Iterator would go out of possible range, capping "
-                      "at earliest possible position.";
-        m_it = m_beats->m_markers.cbegin();
-        m_beatOffset = std::numeric_limits<Beats::ConstIterator::difference_type>::lowest();
-        updateValue();
-        return *this;
-    }
-
-    m_beatOffset = beatOffset;
-    while (m_it != m_beats->m_markers.cbegin() && m_beatOffset < 0) {
-        m_it--;
-        m_beatOffset += m_it->beatsTillNextMarker();
-    }
-    updateValue();
+    setBeatNumber(m_beats->beatNumber(m_it, m_beatOffset) - n);
     return *this;
 }
 
 Beats::ConstIterator::difference_type Beats::ConstIterator::operator-(
         const Beats::ConstIterator& other) const {
-    const int vectorItDiff = m_it - other.m_it;
-    if (vectorItDiff == 0) {
-        return m_beatOffset - other.m_beatOffset;
-    }
-
-    if (vectorItDiff > 0) {
-        return -(other - *this);
-    }
+    return static_cast<difference_type>(m_beats->beatNumber(m_it, m_beatOffset) -
+            m_beats->beatNumber(other.m_it, other.m_beatOffset));
+}
 
-    auto it = m_it;
-    int result = -m_beatOffset + other.m_beatOffset;
-    while (it != m_beats->m_markers.cend() && it != other.m_it) {
-        result += it->beatsTillNextMarker();
-        it++;
+void Beats::ConstIterator::setBeatNumber(qint64 beatNumber) {
+    const auto& markers = m_beats->m_markers;
+    const auto& markerBeatNumbers = m_beats->m_markerBeatNumbers;
+    const int lastMarkerBeatNumber = markerBeatNumbers.back();
+    if (beatNumber >= lastMarkerBeatNumber) {
+        const qint64 beatOffset = beatNumber - lastMarkerBeatNumber;
+        // Detect integer overflow
+        if (beatOffset > std::numeric_limits<Beats::ConstIterator::difference_type>::max()) {
+            qWarning() << "Beats: Iterator would go out of possible range, capping "
+                          "at latest possible position.";
+            m_it = markers.cend();
+            m_beatOffset = std::numeric_limits<Beats::ConstIterator::difference_type>::max();
+            updateValue();
+            return;
+        }
+        m_it = markers.cend();
+        m_beatOffset = static_cast<int>(beatOffset);
+    } else if (beatNumber < 0) {
+        // Detect integer overflow
+        if (beatNumber < std::numeric_limits<Beats::ConstIterator::difference_type>::lowest()) {
+            qWarning() << "Beats: Iterator would go out of possible range, capping "
+                          "at earliest possible position.";
+            m_it = markers.cbegin();
+            m_beatOffset = std::numeric_limits<Beats::ConstIterator::difference_type>::lowest();
+            updateValue();
+            return;
+        }
+        m_it = markers.cbegin();
+        m_beatOffset = static_cast<int>(beatNumber);
+    } else {
+        const int markerIndex = m_beats->markerIndexOfBeat(static_cast<int>(beatNumber));
+        m_it = markers.cbegin() + markerIndex;
+        m_beatOffset = static_cast<int>(beatNumber - markerBeatNumbers[markerIndex]);
     }
-    DEBUG_ASSERT(it == other.m_it);
-    return -result;
+    updateValue();
 }
 
 void Beats::ConstIterator::updateValue() {
@@ -443,8 +436,24 @@ Beats::ConstIterator Beats::iteratorFrom(audio::FramePos position) const {
             return cbegin();
         }
         it -= static_cast<int>(n);
+    } else if (m_markers.empty()) {
+        DEBUG_ASSERT(position == m_lastMarkerPosition);
+        it = clastmarker();
     } else {
-        it = std::lower_bound(cfirstmarker(), clastmarker() + 1, position);
+        // Lookup position is inside the section of a marker
+        const auto markerIt = m_markers.cbegin() + markerIndexAt(position);
+        auto markerBeatIt = ConstIterator(this, markerIt, 0);
+        const double n = std::ceil(
+                (position - markerIt->position()) / markerBeatIt.beatLengthFrames());
+        it = markerBeatIt + static_cast<int>(n);
+
+        // Compensate floating point errors like above, in both directions
+        auto previousBeatIt = it - 1;
+        if (*previousBeatIt >= position) {
+            it = previousBeatIt;
+        } else if (*it < position) {
+            it++;
+        }
     }
     DEBUG_ASSERT(it == cbegin() || it == cend() || *it >= position);
     DEBUG_ASSERT(it == cbegin() || it == cend() ||
@@ -670,17 +679,95 @@ std::optional<BeatsPointer> Beats::trySetBpm(mixxx::Bpm bpm) const {
 }
 
 bool Beats::isValid() const {
-    if (!m_lastMarkerPosition.isValid() || !m_lastMarkerBpm.isValid()) {
-        return false;
+    // The markers have been validated once when building the index, this
+    // function is called for each lookup.
+    return m_lastMarkerPosition.isValid() && m_lastMarkerBpm.isValid() && m_markersValid;
+}
+
+void Beats::buildIndex() {
+    m_markersValid = std::all_of(m_markers.cbegin(),
+            m_markers.cend(),
+            [](const BeatMarker& marker) {
+                return marker.position().isValid() && marker.beatsTillNextMarker() > 0;
+            });
+
+    m_markerBeatNumbers.clear();
+    m_markerBeatNumbers.reserve(m_markers.size() + 1);
+    int beatNumber = 0;
+    for (const auto& marker : m_markers) {
+        m_markerBeatNumbers.push_back(beatNumber);
+        beatNumber += marker.beatsTillNextMarker();
     }
+    m_markerBeatNumbers.push_back(beatNumber);
 
-    for (const BeatMarker& marker : m_markers) {
-        if (!marker.position().isValid() || marker.beatsTillNextMarker() <= 0) {
-            return false;
+    m_positionBucketMarkers.clear();
+    m_beatBucketMarkers.clear();
+    if (m_markers.empty()) {
+        return;
+    }
+    const int markerCount = static_cast<int>(m_markers.size());
+    const int bucketCount = kIndexBucketsPerMarker * markerCount;
+
+    const auto firstMarkerPosition = m_markers.front().position();
+    m_positionBucketFrames = (m_lastMarkerPosition - firstMarkerPosition) / bucketCount;
+    m_positionBucketMarkers.reserve(bucketCount);
+    int markerIndex = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        const auto bucketPosition = firstMarkerPosition + i * m_positionBucketFrames;
+        while (markerIndex + 1 < markerCount &&
+                m_markers[markerIndex + 1].position() <= bucketPosition) {
+            ++markerIndex;
+        }
+        m_positionBucketMarkers.push_back(markerIndex);
+    }
+
+    // The beat buckets have a size of a power of 2 for using a shift
+    // instead of a division
+    m_beatBucketShift = 0;
+    while ((beatNumber >> m_beatBucketShift) >= bucketCount) {
+        ++m_beatBucketShift;
+    }
+    const int beatBucketCount = (beatNumber >> m_beatBucketShift) + 1;
+    m_beatBucketMarkers.reserve(beatBucketCount);
+    markerIndex = 0;
+    for (int i = 0; i < beatBucketCount; ++i) {
+        const int bucketBeatNumber = i << m_beatBucketShift;
+        while (markerIndex + 1 < markerCount &&
+                m_markerBeatNumbers[markerIndex + 1] <= bucketBeatNumber) {
+            ++markerIndex;
         }
+        m_beatBucketMarkers.push_back(markerIndex);
     }
+}
 
-    return true;
+int Beats::markerIndexAt(audio::FramePos position) const {
+    DEBUG_ASSERT(!m_markers.empty());
+    const int markerCount = static_cast<int>(m_markers.size());
+    int bucket = 0;
+    if (m_positionBucketFrames > 0) {
+        bucket = static_cast<int>(
+                (position - m_markers.front().position()) / m_positionBucketFrames);
+        bucket = std::clamp(bucket, 0, static_cast<int>(m_positionBucketMarkers.size()) - 1);
+    }
+    int markerIndex = m_positionBucketMarkers[bucket];
+    // The start of the bucket might be off by a rounding error
+    while (markerIndex > 0 && m_markers[markerIndex].position() > position) {
+        --markerIndex;
+    }
+    while (markerIndex + 1 < markerCount && m_markers[markerIndex + 1].position() <= position) {
+        ++markerIndex;
+    }
+    return markerIndex;
+}
+
+int Beats::markerIndexOfBeat(int beatNumber) const {
+    DEBUG_ASSERT(beatNumber >= 0);
+    DEBUG_ASSERT(beatNumber < m_markerBeatNumbers.back());
+    int markerIndex = m_beatBucketMarkers[beatNumber >> m_beatBucketShift];
+    while (m_markerBeatNumbers[markerIndex + 1] <= beatNumber) {
+        ++markerIndex;
+    }
+    return markerIndex;
 }
 
 mixxx::audio::FrameDiff_t Beats::firstBeatLengthFrames() const {
@@ -707,17 +794,16 @@ audio::FramePos Beats::snapPosToNearBeat(audio::FramePos position) const {
 }
 
 int Beats::numBeatsInRange(audio::FramePos startPosition, audio::FramePos endPosition) const {
+    if (endPosition <= audio::kStartFramePos) {
+        return -1;
+    }
     startPosition = snapPosToNearBeat(startPosition);
-    audio::FramePos lastPosition = audio::kStartFramePos;
-    int i = 1;
-    while (lastPosition < endPosition) {
-        lastPosition = findNthBeat(startPosition, i);
-        if (!lastPosition.isValid()) {
-            break;
-        }
-        i++;
+    // Count the beats in the range [startPosition, endPosition)
+    const auto startIt = iteratorFrom(startPosition);
+    if (*startIt >= endPosition) {
+        return 0;
     }
-    return i - 2;
+    return iteratorFrom(endPosition) - startIt;
 };
 
 audio::FramePos Beats::findNextBeat(audio::FramePos position) const {
@@ -142,6 +142,9 @@ class Beats : private std::enable_shared_from_this<Beats> {
         }
 
       private:
+        /// Moves the iterator to the beat with the given number, counted
+        /// from the first marker (see Beats::beatNumber()).
+        void setBeatNumber(qint64 beatNumber);
         void updateValue();
 
         mixxx::audio::FramePos m_value;
@@ -165,6 +168,7 @@ class Beats : private std::enable_shared_from_this<Beats> {
         DEBUG_ASSERT(!m_lastMarkerPosition.isFractional());
         DEBUG_ASSERT(m_lastMarkerBpm.isValid());
         DEBUG_ASSERT(m_sampleRate.isValid());
+        buildIndex();
     }
 
     Beats(mixxx::audio::FramePos lastMarkerPosition,
@@ -427,11 +431,40 @@ class Beats : private std::enable_shared_from_this<Beats> {
     mixxx::audio::FrameDiff_t firstBeatLengthFrames() const;
     mixxx::audio::FrameDiff_t lastBeatLengthFrames() const;
 
+    /// Builds the lookup tables that allow to find the marker of a frame
+    /// position or a beat number in constant time, instead of walking or
+    /// bisecting the markers on every query.
+    void buildIndex();
+
+    /// The number of the beat at the given iterator position, counted from
+    /// the first marker. Beats before the first marker have negative numbers.
+    qint64 beatNumber(std::vector<BeatMarker>::const_iterator it, int beatOffset) const {
+        return static_cast<qint64>(m_markerBeatNumbers[it - m_markers.cbegin()]) + beatOffset;
+    }
+
+    /// Returns the index of the marker whose section contains `position`,
+    /// which must be between the first and the last marker.
+    int markerIndexAt(audio::FramePos position) const;
+    /// Returns the index of the marker whose section contains the beat with
+    /// the given number, which must be between the first and the last marker.
+    int markerIndexOfBeat(int beatNumber) const;
+
     std::vector<BeatMarker> m_markers;
     mixxx::audio::FramePos m_lastMarkerPosition;
     mixxx::Bpm m_lastMarkerBpm;
     mixxx::audio::SampleRate m_sampleRate;
 
+    bool m_markersValid{true};
+    /// The number of beats before each marker, followed by the number of
+    /// beats before the last marker.
+    std::vector<int> m_markerBeatNumbers{0};
+    /// The marker index at the start of equally sized ranges of frame
+    /// positions and beat numbers.
+    std::vector<int> m_positionBucketMarkers;
+    audio::FrameDiff_t m_positionBucketFrames{0};
+    std::vector<int> m_beatBucketMarkers;
+    int m_beatBucketShift{0};
+
     // The sub-version of this beatgrid.
     const QString m_subVersion;
 };
@@ -1,6 +1,9 @@
 #include "util/cache.h"
 
+#include <QCryptographicHash>
+
 #include "util/assert.h"
+#include "util/fileinfo.h"
 #include "util/math.h"
 
 namespace mixxx {
@@ -35,4 +38,12 @@ cache_key_t cacheKeyFromMessageDigest(const QByteArray& messageDigest) {
     return key;
 }
 
+cache_key_t cacheKeyFromFileInfo(const FileInfo& fileInfo) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fileInfo.canonicalLocation().toUtf8());
+    hash.addData(QByteArray::number(fileInfo.sizeInBytes()));
+    hash.addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+    return cacheKeyFromMessageDigest(hash.result());
+}
+
 } // namespace mixxx
@@ -6,6 +6,8 @@
 
 namespace mixxx {
 
+class FileInfo;
+
 typedef quint64 cache_key_t;
 
 // A signed integer is needed for storing cache keys as
@@ -33,6 +35,11 @@ inline constexpr cache_key_t signedCacheKey(cache_key_t cacheKey) {
 // bytes as the size (in bytes) of the cache key.
 cache_key_t cacheKeyFromMessageDigest(const QByteArray& messageDigest);
 
+// Derive a cache key for data that is derived from the contents of a file
+// from the location, size and modification time of the file. Modifying the
+// file invalidates the key.
+cache_key_t cacheKeyFromFileInfo(const FileInfo& fileInfo);
+
 } // namespace mixxx
 
 Q_DECLARE_METATYPE(mixxx::cache_key_t);
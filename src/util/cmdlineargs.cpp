@@ -170,6 +170,15 @@ bool CmdlineArgs::parse(const QStringList& arguments, CmdlineArgs::ParseMode mod
     parser.addOption(timelinePath);
     parser.addOption(timelinePathDeprecated);
 
+    const QCommandLineOption engineTracePath(QStringLiteral("engine-trace-path"),
+            forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
+                                      "Path the timing of the most recent audio callbacks "
+                                      "is written to on exit, in the Chrome trace format "
+                                      "that can be opened with Perfetto")
+                            : QString(),
+            QStringLiteral("path"));
+    parser.addOption(engineTracePath);
+
     const QCommandLineOption controllerDebug(QStringLiteral("controller-debug"),
             forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
                                       "Causes Mixxx to display/log all of the controller data it "
@@ -249,6 +258,24 @@ bool CmdlineArgs::parse(const QStringList& arguments, CmdlineArgs::ParseMode mod
     parser.addOption(debugAssertBreak);
     parser.addOption(debugAssertBreakDeprecated);
 
+    const QCommandLineOption render(QStringLiteral("render"),
+            forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
+                                      "Render the mix described by the given JSON script "
+                                      "offline and faster than realtime without opening "
+                                      "any sound device, then quit.")
+                            : QString(),
+            QStringLiteral("script"));
+    parser.addOption(render);
+
+    const QCommandLineOption renderOutput(QStringLiteral("render-output"),
+            forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
+                                      "Audio file for the master output of --render. The "
+                                      "encoder is chosen by the file extension (e.g. .wav, "
+                                      ".flac).")
+                            : QString(),
+            QStringLiteral("file"));
+    parser.addOption(renderOutput);
+
     const QCommandLineOption helpOption = parser.addHelpOption();
     const QCommandLineOption versionOption = parser.addVersionOption();
 
@@ -319,6 +346,19 @@ bool CmdlineArgs::parse(const QStringList& arguments, CmdlineArgs::ParseMode mod
         m_timelinePath = parser.value(timelinePathDeprecated);
     }
 
+    if (parser.isSet(engineTracePath)) {
+        m_engineTracePath = parser.value(engineTracePath);
+    }
+
+    if (parser.isSet(render)) {
+        m_renderScriptPath = parser.value(render);
+        m_renderOutputPath = parser.value(renderOutput);
+        if (m_renderOutputPath.isEmpty()) {
+            fputs("\n--render requires --render-output\n", stdout);
+            return false;
+        }
+    }
+
     m_controllerDebug = parser.isSet(controllerDebug) || parser.isSet(controllerDebugDeprecated);
     m_developer = parser.isSet(developer);
     m_safeMode = parser.isSet(safeMode) || parser.isSet(safeModeDeprecated);
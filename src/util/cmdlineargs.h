@@ -51,6 +51,18 @@ class CmdlineArgs final {
     }
     const QString& getResourcePath() const { return m_resourcePath; }
     const QString& getTimelinePath() const { return m_timelinePath; }
+    const QString& getEngineTracePath() const {
+        return m_engineTracePath;
+    }
+    bool getRenderEnabled() const {
+        return !m_renderScriptPath.isEmpty();
+    }
+    const QString& getRenderScriptPath() const {
+        return m_renderScriptPath;
+    }
+    const QString& getRenderOutputPath() const {
+        return m_renderOutputPath;
+    }
 
     void setScaleFactor(double scaleFactor) {
         m_scaleFactor = scaleFactor;
@@ -83,4 +95,7 @@ class CmdlineArgs final {
     QString m_settingsPath;
     QString m_resourcePath;
     QString m_timelinePath;
+    QString m_engineTracePath;
+    QString m_renderScriptPath;
+    QString m_renderOutputPath;
 };
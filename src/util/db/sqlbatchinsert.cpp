@@ -0,0 +1,135 @@
+#include "util/db/sqlbatchinsert.h"
+
+#include <QSqlError>
+
+#include "util/assert.h"
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SqlBatchInsert");
+
+// SQLITE_MAX_VARIABLE_NUMBER of SQLite versions before 3.32.0
+constexpr int kMaxBoundValues = 999;
+
+// Larger batches don't pay off, because the statement needs to be parsed
+// once and the values of all rows are copied anyway.
+constexpr int kMaxRowsPerBatch = 128;
+
+} // anonymous namespace
+
+SqlBatchInsert::SqlBatchInsert(
+        const QSqlDatabase& database,
+        const QString& tableName,
+        const QStringList& columnNames)
+        : m_database(database),
+          m_tableName(tableName),
+          m_columnNames(columnNames),
+          m_rowsPerBatch(math_clamp(
+                  kMaxBoundValues / math_max(static_cast<int>(columnNames.size()), 1),
+                  1,
+                  kMaxRowsPerBatch)),
+          m_batchQuery(database),
+          m_rowQuery(database),
+          m_rowQueryPrepared(false) {
+    DEBUG_ASSERT(!m_columnNames.isEmpty());
+    m_pendingValues.reserve(m_rowsPerBatch * m_columnNames.size());
+    if (!m_batchQuery.prepare(statement(m_rowsPerBatch))) {
+        kLogger.warning()
+                << "Failed to prepare statement"
+                << m_batchQuery.lastQuery()
+                << m_batchQuery.lastError();
+    }
+}
+
+SqlBatchInsert::~SqlBatchInsert() {
+    DEBUG_ASSERT(m_pendingValues.isEmpty());
+}
+
+QString SqlBatchInsert::statement(int rowCount) const {
+    QString row = QStringLiteral("(?");
+    for (int i = 1; i < m_columnNames.size(); ++i) {
+        row += QStringLiteral(",?");
+    }
+    row += QChar(')');
+    QStringList rows;
+    rows.reserve(rowCount);
+    for (int i = 0; i < rowCount; ++i) {
+        rows.append(row);
+    }
+    return QStringLiteral("INSERT INTO %1 (%2) VALUES %3")
+            .arg(m_tableName,
+                    m_columnNames.join(QChar(',')),
+                    rows.join(QChar(',')));
+}
+
+bool SqlBatchInsert::insert(const QVariantList& values) {
+    VERIFY_OR_DEBUG_ASSERT(values.size() == m_columnNames.size()) {
+        return false;
+    }
+    m_pendingValues.append(values);
+    if (m_pendingValues.size() < m_rowsPerBatch * m_columnNames.size()) {
+        return true;
+    }
+    const bool success = exec(&m_batchQuery, 0, m_rowsPerBatch);
+    m_pendingValues.clear();
+    return success;
+}
+
+bool SqlBatchInsert::flush() {
+    const int rowCount = static_cast<int>(m_pendingValues.size() / m_columnNames.size());
+    if (rowCount == 0) {
+        return true;
+    }
+    // The remainder is smaller than a batch and needs its own statement
+    QSqlQuery query(m_database);
+    bool success;
+    if (query.prepare(statement(rowCount))) {
+        success = exec(&query, 0, rowCount);
+    } else {
+        kLogger.warning()
+                << "Failed to prepare statement"
+                << query.lastQuery()
+                << query.lastError();
+        success = false;
+    }
+    m_pendingValues.clear();
+    return success;
+}
+
+bool SqlBatchInsert::exec(QSqlQuery* pQuery, int firstRow, int rowCount) {
+    const int columnCount = static_cast<int>(m_columnNames.size());
+    for (int i = 0; i < rowCount * columnCount; ++i) {
+        pQuery->bindValue(i, m_pendingValues.at(firstRow * columnCount + i));
+    }
+    if (pQuery->exec()) {
+        return true;
+    }
+    if (rowCount == 1) {
+        kLogger.warning()
+                << "Failed to insert row into"
+                << m_tableName
+                << pQuery->lastError();
+        return false;
+    }
+
+    // A statement either inserts all or none of its rows
+    if (!m_rowQueryPrepared) {
+        m_rowQueryPrepared = m_rowQuery.prepare(statement(1));
+        if (!m_rowQueryPrepared) {
+            kLogger.warning()
+                    << "Failed to prepare statement"
+                    << m_rowQuery.lastQuery()
+                    << m_rowQuery.lastError();
+            return false;
+        }
+    }
+    bool success = true;
+    for (int row = firstRow; row < firstRow + rowCount; ++row) {
+        if (!exec(&m_rowQuery, row, 1)) {
+            success = false;
+        }
+    }
+    return success;
+}
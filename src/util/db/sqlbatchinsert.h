@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+
+/// Inserts rows into a table with multi-row INSERT statements.
+///
+/// Executing one statement per row dominates the time for importing large
+/// external libraries. The rows are buffered and inserted in batches with a
+/// single statement each. If a batch fails, e.g. due to a constraint
+/// violation of a single row, its rows are inserted one by one. Only the
+/// failing rows are lost, like with individual statements.
+///
+/// The pending rows must be flushed before querying the table and before
+/// committing the enclosing transaction.
+class SqlBatchInsert final {
+  public:
+    SqlBatchInsert(
+            const QSqlDatabase& database,
+            const QString& tableName,
+            const QStringList& columnNames);
+    ~SqlBatchInsert();
+
+    /// Adds a row with one value per column. Returns false if a row of a
+    /// batch that has been inserted by this call has failed.
+    bool insert(const QVariantList& values);
+
+    /// Inserts all pending rows. Returns false if any row has failed.
+    bool flush();
+
+    int rowsPerBatch() const {
+        return m_rowsPerBatch;
+    }
+
+  private:
+    QString statement(int rowCount) const;
+    bool exec(QSqlQuery* pQuery, int firstRow, int rowCount);
+
+    const QSqlDatabase m_database;
+    const QString m_tableName;
+    const QStringList m_columnNames;
+    const int m_rowsPerBatch;
+
+    QSqlQuery m_batchQuery;
+    /// Only prepared after a batch has failed
+    QSqlQuery m_rowQuery;
+    bool m_rowQueryPrepared;
+
+    QVariantList m_pendingValues;
+};
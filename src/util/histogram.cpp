@@ -0,0 +1,81 @@
+#include "util/histogram.h"
+
+#include <bit>
+#include <cmath>
+
+#include "util/assert.h"
+#include "util/math.h"
+
+namespace mixxx {
+
+Histogram::Histogram()
+        : m_count(0),
+          m_maxNanos(0) {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+// static
+int Histogram::bucketIndex(std::int64_t nanos) {
+    const auto value = static_cast<std::uint64_t>(math_clamp<std::int64_t>(
+            nanos, 0, (std::int64_t{1} << (kMaxExponent + 1)) - 1));
+    if (value < kSubBucketCount) {
+        return static_cast<int>(value);
+    }
+    // The position of the highest bit is at least kSubBucketBits
+    const int exponent = std::bit_width(value) - 1;
+    const int subBucket = static_cast<int>(
+            (value >> (exponent - kSubBucketBits)) & (kSubBucketCount - 1));
+    return kSubBucketCount + (exponent - kSubBucketBits) * kSubBucketCount + subBucket;
+}
+
+// static
+std::int64_t Histogram::bucketUpperBound(int index) {
+    DEBUG_ASSERT(index >= 0);
+    DEBUG_ASSERT(index < kBucketCount);
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const int shift = (index - kSubBucketCount) / kSubBucketCount;
+    const int subBucket = (index - kSubBucketCount) % kSubBucketCount;
+    const std::int64_t lowerBound =
+            static_cast<std::int64_t>(kSubBucketCount + subBucket) << shift;
+    return lowerBound + (std::int64_t{1} << shift) - 1;
+}
+
+void Histogram::record(std::int64_t nanos) {
+    m_buckets[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    // Only a single thread records into a histogram
+    if (nanos > m_maxNanos.load(std::memory_order_relaxed)) {
+        m_maxNanos.store(nanos, std::memory_order_relaxed);
+    }
+}
+
+Duration Histogram::quantile(double q) const {
+    DEBUG_ASSERT(q >= 0);
+    DEBUG_ASSERT(q <= 1);
+    std::uint64_t total = 0;
+    for (const auto& bucket : m_buckets) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return Duration::empty();
+    }
+    // The rank of the quantile, starting at 1
+    const auto rank = math_max<std::uint64_t>(1,
+            static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total))));
+    std::uint64_t cumulated = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        cumulated += m_buckets[i].load(std::memory_order_relaxed);
+        if (cumulated >= rank) {
+            // The bucket might be wider than the actual maximum
+            return Duration::fromNanos(
+                    math_min(bucketUpperBound(i), max().toIntegerNanos()));
+        }
+    }
+    return max();
+}
+
+} // namespace mixxx
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "util/class.h"
+#include "util/duration.h"
+
+namespace mixxx {
+
+/// Log-linear histogram of nanosecond durations similar to HdrHistogram.
+/// Each power of two is split into 16 buckets which limits the relative
+/// error of quantiles to 1/16.
+///
+/// Recording is lock-free and does not allocate, but only a single thread
+/// may record into a histogram. All other functions may be invoked from
+/// any thread.
+class Histogram {
+  public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+    // Durations above 2^40 ns (~18 min) are clamped
+    static constexpr int kMaxExponent = 40;
+    static constexpr int kBucketCount =
+            kSubBucketCount + (kMaxExponent - kSubBucketBits + 1) * kSubBucketCount;
+
+    Histogram();
+
+    void record(std::int64_t nanos);
+
+    std::uint64_t count() const {
+        return m_count.load(std::memory_order_relaxed);
+    }
+    Duration max() const {
+        return Duration::fromNanos(m_maxNanos.load(std::memory_order_relaxed));
+    }
+    /// The upper bound of the bucket that contains the quantile q,
+    /// which must be within [0, 1].
+    Duration quantile(double q) const;
+
+    static int bucketIndex(std::int64_t nanos);
+    static std::int64_t bucketUpperBound(int index);
+
+  private:
+    std::array<std::atomic<std::uint64_t>, kBucketCount> m_buckets;
+    std::atomic<std::uint64_t> m_count;
+    std::atomic<std::int64_t> m_maxNanos;
+
+    DISALLOW_COPY_AND_ASSIGN(Histogram);
+};
+
+} // namespace mixxx
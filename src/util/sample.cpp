@@ -1,9 +1,11 @@
 #include "util/sample.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdlib>
 
 #include "util/math.h"
+#include "util/sample_dispatch.h"
 
 #ifdef __WINDOWS__
 #include <QtGlobal>
@@ -37,8 +39,64 @@ constexpr bool useAlignedAlloc() {
             sizeof(CSAMPLE*) == sizeof(size_t);
 }
 
+// The hot loops are compiled for several instruction sets in
+// sample_dispatch.cpp. The widest variant supported by the CPU is used.
+const mixxx::SampleKernels* selectKernels() {
+    for (const auto isa : {SampleUtil::Isa::Avx512, SampleUtil::Isa::Avx2}) {
+        const mixxx::SampleKernels* pKernels = mixxx::sampleKernelsForIsa(isa);
+        if (pKernels) {
+            return pKernels;
+        }
+    }
+    return mixxx::sampleKernelsForIsa(SampleUtil::Isa::Generic);
+}
+
+// Function-local static to be initialized on first use, even if SampleUtil
+// is already used during static initialization.
+std::atomic<const mixxx::SampleKernels*>& activeKernels() {
+    static std::atomic<const mixxx::SampleKernels*> s_pKernels(selectKernels());
+    return s_pKernels;
+}
+
+inline const mixxx::SampleKernels& kernels() {
+    return *activeKernels().load(std::memory_order_relaxed);
+}
+
 } // anonymous namespace
 
+// static
+SampleUtil::Isa SampleUtil::activeIsa() {
+    return kernels().isa;
+}
+
+// static
+bool SampleUtil::isIsaSupported(Isa isa) {
+    return mixxx::sampleKernelsForIsa(isa) != nullptr;
+}
+
+// static
+bool SampleUtil::setActiveIsa(Isa isa) {
+    const mixxx::SampleKernels* pKernels = mixxx::sampleKernelsForIsa(isa);
+    if (!pKernels) {
+        return false;
+    }
+    activeKernels().store(pKernels);
+    return true;
+}
+
+// static
+const char* SampleUtil::isaName(Isa isa) {
+    switch (isa) {
+    case Isa::Generic:
+        return "Generic";
+    case Isa::Avx2:
+        return "AVX2";
+    case Isa::Avx512:
+        return "AVX-512";
+    }
+    return "Unknown";
+}
+
 // static
 CSAMPLE* SampleUtil::alloc(SINT size) {
     // To speed up vectorization we align our sample buffers to 16-byte (128
@@ -231,11 +289,7 @@ void SampleUtil::addWithGain(CSAMPLE* M_RESTRICT pDest,
     if (gain == CSAMPLE_GAIN_ZERO) {
         return;
     }
-
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc[i] * gain;
-    }
+    kernels().addWithGain(pDest, pSrc, gain, numSamples);
 }
 
 void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
@@ -245,23 +299,7 @@ void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
     if (old_gain == CSAMPLE_GAIN_ZERO && new_gain == CSAMPLE_GAIN_ZERO) {
         return;
     }
-
-    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
-            / CSAMPLE_GAIN(numSamples / 2);
-    if (gain_delta != 0) {
-        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] += pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
-        }
-    } else {
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples; ++i) {
-            pDest[i] += pSrc[i] * old_gain;
-        }
-    }
+    kernels().addWithRampingGain(pDest, pSrc, old_gain, new_gain, numSamples);
 }
 
 // static
@@ -318,15 +356,7 @@ void SampleUtil::copyWithGain(CSAMPLE* M_RESTRICT pDest,
         clear(pDest, numSamples);
         return;
     }
-
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] = pSrc[i] * gain;
-    }
-
-    // OR! need to test which fares better
-    // copy(pDest, pSrc, iNumSamples);
-    // applyGain(pDest, gain);
+    kernels().copyWithGain(pDest, pSrc, gain, numSamples);
 }
 
 // static
@@ -343,27 +373,74 @@ void SampleUtil::copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
         clear(pDest, numSamples);
         return;
     }
+    kernels().copyWithRampingGain(pDest, pSrc, old_gain, new_gain, numSamples);
+}
 
-    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
-            / CSAMPLE_GAIN(numSamples / 2);
-    if (gain_delta != 0) {
-        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED only with "int i" (not SINT i)
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] = pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
-        }
-    } else {
-        // note: LOOP VECTORIZED.
-        for (SINT i = 0; i < numSamples; ++i) {
-            pDest[i] = pSrc[i] * old_gain;
-        }
-    }
+// static
+void SampleUtil::dispatchCopy2WithGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc0,
+        CSAMPLE_GAIN gain0,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        int iNumSamples) {
+    kernels().copy2WithGain(pDest, pSrc0, gain0, pSrc1, gain1, iNumSamples);
+}
+
+// static
+void SampleUtil::dispatchCopy2WithRampingGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc0,
+        CSAMPLE_GAIN gain0in,
+        CSAMPLE_GAIN gain0out,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1in,
+        CSAMPLE_GAIN gain1out,
+        int iNumSamples) {
+    kernels().copy2WithRampingGain(pDest,
+            pSrc0,
+            gain0in,
+            gain0out,
+            pSrc1,
+            gain1in,
+            gain1out,
+            iNumSamples);
+}
+
+// static
+void SampleUtil::dispatchCopy3WithGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc0,
+        CSAMPLE_GAIN gain0,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        int iNumSamples) {
+    kernels().copy3WithGain(
+            pDest, pSrc0, gain0, pSrc1, gain1, pSrc2, gain2, iNumSamples);
+}
 
-    // OR! need to test which fares better
-    // copy(pDest, pSrc, iNumSamples);
-    // applyRampingGain(pDest, gain);
+// static
+void SampleUtil::dispatchCopy3WithRampingGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc0,
+        CSAMPLE_GAIN gain0in,
+        CSAMPLE_GAIN gain0out,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1in,
+        CSAMPLE_GAIN gain1out,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2in,
+        CSAMPLE_GAIN gain2out,
+        int iNumSamples) {
+    kernels().copy3WithRampingGain(pDest,
+            pSrc0,
+            gain0in,
+            gain0out,
+            pSrc1,
+            gain1in,
+            gain1out,
+            pSrc2,
+            gain2in,
+            gain2out,
+            iNumSamples);
 }
 
 // static
@@ -383,47 +460,14 @@ void SampleUtil::convertS16ToFloat32(CSAMPLE* M_RESTRICT pDest,
 //static
 void SampleUtil::convertFloat32ToS16(SAMPLE* pDest, const CSAMPLE* pSrc,
         SINT numSamples) {
-    // We use here -SAMPLE_MINIMUM for a perfect round trip with convertS16ToFloat32
-    // +1.0 is clamped to 32767 (0.99996942)
     DEBUG_ASSERT(-SAMPLE_MINIMUM >= SAMPLE_MAXIMUM);
-    const CSAMPLE kConversionFactor = SAMPLE_MINIMUM * -1.0f;
-    // note: LOOP VECTORIZED only with "int i" (not SINT i)
-    for (int i = 0; i < numSamples; ++i) {
-        pDest[i] = static_cast<SAMPLE>(math_clamp(pSrc[i] * kConversionFactor,
-                static_cast<CSAMPLE>(SAMPLE_MINIMUM),
-                static_cast<CSAMPLE>(SAMPLE_MAXIMUM)));
-    }
+    kernels().convertFloat32ToS16(pDest, pSrc, numSamples);
 }
 
 // static
 SampleUtil::CLIP_STATUS SampleUtil::sumAbsPerChannel(CSAMPLE* pfAbsL,
         CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numSamples) {
-    CSAMPLE fAbsL = CSAMPLE_ZERO;
-    CSAMPLE fAbsR = CSAMPLE_ZERO;
-    CSAMPLE clippedL = 0;
-    CSAMPLE clippedR = 0;
-
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples / 2; ++i) {
-        CSAMPLE absl = fabs(pBuffer[i * 2]);
-        fAbsL += absl;
-        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
-        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
-        fAbsR += absr;
-        // Replacing the code with a bool clipped will prevent vetorizing
-        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
-    }
-
-    *pfAbsL = fAbsL;
-    *pfAbsR = fAbsR;
-    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
-    if (clippedL > 0) {
-        clipping |= SampleUtil::CLIPPING_LEFT;
-    }
-    if (clippedR > 0) {
-        clipping |= SampleUtil::CLIPPING_RIGHT;
-    }
-    return clipping;
+    return kernels().sumAbsPerChannel(pfAbsL, pfAbsR, pBuffer, numSamples);
 }
 
 // static
@@ -440,11 +484,7 @@ void SampleUtil::interleaveBuffer(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc1,
         const CSAMPLE* M_RESTRICT pSrc2,
         SINT numFrames) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numFrames; ++i) {
-        pDest[2 * i] = pSrc1[i];
-        pDest[2 * i + 1] = pSrc2[i];
-    }
+    kernels().interleaveBuffer(pDest, pSrc1, pSrc2, numFrames);
 }
 
 // static
@@ -452,11 +492,7 @@ void SampleUtil::deinterleaveBuffer(CSAMPLE* M_RESTRICT pDest1,
         CSAMPLE* M_RESTRICT pDest2,
         const CSAMPLE* M_RESTRICT pSrc,
         SINT numFrames) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numFrames; ++i) {
-        pDest1[i] = pSrc[i * 2];
-        pDest2[i] = pSrc[i * 2 + 1];
-    }
+    kernels().deinterleaveBuffer(pDest1, pDest2, pSrc, numFrames);
 }
 
 // static
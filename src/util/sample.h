@@ -25,6 +25,24 @@ class SampleUtil {
     // This is some legacy, we cannot easily revert.
     static constexpr double kPlayPositionChannels = 2.0;
 
+    // The instruction set variants of the vectorized mixing functions. The
+    // best variant supported by the CPU is selected on first use.
+    enum class Isa {
+        // Compiled for the baseline of the build target
+        Generic,
+        Avx2,
+        Avx512,
+    };
+
+    static Isa activeIsa();
+    static bool isIsaSupported(Isa isa);
+    static const char* isaName(Isa isa);
+
+    // Switches to another instruction set variant. Returns false if the CPU
+    // does not support it. Only intended for tests and benchmarks, because
+    // it is not synchronized with concurrent calls.
+    static bool setActiveIsa(Isa isa);
+
     // Allocated a buffer of CSAMPLE's with length size. Ensures that the buffer
     // is 16-byte aligned for SSE enhancement.
     static CSAMPLE* alloc(SINT size);
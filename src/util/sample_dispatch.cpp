@@ -0,0 +1,120 @@
+#include "util/sample_dispatch.h"
+
+#include <cmath>
+
+#include "util/math.h"
+
+// Distribution builds only target the baseline instruction set (e.g. SSE2 on
+// x86-64). The hot loops are therefore compiled a second time for AVX2 and
+// AVX-512 (see sample_kernels.h) and SampleUtil selects the widest variant
+// supported by the CPU once at startup. On arm64 NEON is part of the
+// baseline, so there is nothing to dispatch.
+//
+// This file is compiled with -ffp-contract=off, see CMakeLists.txt.
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MIXXX_SAMPLE_DISPATCH_X86
+#endif
+
+namespace mixxx {
+
+namespace {
+
+namespace generic {
+#define SAMPLE_KERNEL inline
+#include "util/sample_kernels.h"
+#undef SAMPLE_KERNEL
+} // namespace generic
+
+#ifdef MIXXX_SAMPLE_DISPATCH_X86
+namespace avx2 {
+#define SAMPLE_KERNEL __attribute__((target("avx2")))
+#include "util/sample_kernels.h"
+#undef SAMPLE_KERNEL
+} // namespace avx2
+
+namespace avx512 {
+#define SAMPLE_KERNEL __attribute__((target("avx512f,avx512bw,avx512vl")))
+#include "util/sample_kernels.h"
+#undef SAMPLE_KERNEL
+} // namespace avx512
+#endif
+
+const SampleKernels kGenericKernels = {
+        SampleUtil::Isa::Generic,
+        &generic::copyWithGain,
+        &generic::copyWithRampingGain,
+        &generic::addWithGain,
+        &generic::addWithRampingGain,
+        &generic::copy2WithGain,
+        &generic::copy2WithRampingGain,
+        &generic::copy3WithGain,
+        &generic::copy3WithRampingGain,
+        &generic::convertFloat32ToS16,
+        &generic::sumAbsPerChannel,
+        &generic::interleaveBuffer,
+        &generic::deinterleaveBuffer,
+};
+
+#ifdef MIXXX_SAMPLE_DISPATCH_X86
+const SampleKernels kAvx2Kernels = {
+        SampleUtil::Isa::Avx2,
+        &avx2::copyWithGain,
+        &avx2::copyWithRampingGain,
+        &avx2::addWithGain,
+        &avx2::addWithRampingGain,
+        &avx2::copy2WithGain,
+        &avx2::copy2WithRampingGain,
+        &avx2::copy3WithGain,
+        &avx2::copy3WithRampingGain,
+        &avx2::convertFloat32ToS16,
+        &avx2::sumAbsPerChannel,
+        &avx2::interleaveBuffer,
+        &avx2::deinterleaveBuffer,
+};
+
+const SampleKernels kAvx512Kernels = {
+        SampleUtil::Isa::Avx512,
+        &avx512::copyWithGain,
+        &avx512::copyWithRampingGain,
+        &avx512::addWithGain,
+        &avx512::addWithRampingGain,
+        &avx512::copy2WithGain,
+        &avx512::copy2WithRampingGain,
+        &avx512::copy3WithGain,
+        &avx512::copy3WithRampingGain,
+        &avx512::convertFloat32ToS16,
+        &avx512::sumAbsPerChannel,
+        &avx512::interleaveBuffer,
+        &avx512::deinterleaveBuffer,
+};
+#endif
+
+} // anonymous namespace
+
+const SampleKernels* sampleKernelsForIsa(SampleUtil::Isa isa) {
+    switch (isa) {
+    case SampleUtil::Isa::Generic:
+        return &kGenericKernels;
+#ifdef MIXXX_SAMPLE_DISPATCH_X86
+    case SampleUtil::Isa::Avx2:
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return &kAvx2Kernels;
+        }
+        return nullptr;
+    case SampleUtil::Isa::Avx512:
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") &&
+                __builtin_cpu_supports("avx512bw") &&
+                __builtin_cpu_supports("avx512vl")) {
+            return &kAvx512Kernels;
+        }
+        return nullptr;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace mixxx
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "util/sample.h"
+
+namespace mixxx {
+
+/// The loops of SampleUtil that are compiled once per instruction set, see
+/// sample_kernels.h. The trivial cases (gain 0 or 1) are handled by
+/// SampleUtil before calling into one of these functions.
+struct SampleKernels {
+    SampleUtil::Isa isa;
+    void (*copyWithGain)(CSAMPLE* M_RESTRICT pDest,
+            const CSAMPLE* M_RESTRICT pSrc,
+            CSAMPLE_GAIN gain,
+            SINT numSamples);
+    void (*copyWithRampingGain)(CSAMPLE* M_RESTRICT pDest,
+            const CSAMPLE* M_RESTRICT pSrc,
+            CSAMPLE_GAIN old_gain,
+            CSAMPLE_GAIN new_gain,
+            SINT numSamples);
+    void (*addWithGain)(CSAMPLE* M_RESTRICT pDest,
+            const CSAMPLE* M_RESTRICT pSrc,
+            CSAMPLE_GAIN gain,
+            SINT numSamples);
+    void (*addWithRampingGain)(CSAMPLE* M_RESTRICT pDest,
+            const CSAMPLE* M_RESTRICT pSrc,
+            CSAMPLE_GAIN old_gain,
+            CSAMPLE_GAIN new_gain,
+            SINT numSamples);
+    void (*copy2WithGain)(CSAMPLE* M_RESTRICT pDest,
+            const CSAMPLE* M_RESTRICT pSrc0,
+            CSAMPLE_GAIN gain0,
+            const CSAMPLE* M_RESTRICT pSrc1,
+            CSAMPLE_GAIN gain1,
+            int iNumSamples);
+    void (*copy2WithRampingGain)(CSAMPLE* M_RESTRICT pDest,
+            const CSAMPLE* M_RESTRICT pSrc0,
+            CSAMPLE_GAIN gain0in,
+            CSAMPLE_GAIN gain0out,
+            const CSAMPLE* M_RESTRICT pSrc1,
+            CSAMPLE_GAIN gain1in,
+            CSAMPLE_GAIN gain1out,
+            int iNumSamples);
+    void (*copy3WithGain)(CSAMPLE* M_RESTRICT pDest,
+            const CSAMPLE* M_RESTRICT pSrc0,
+            CSAMPLE_GAIN gain0,
+            const CSAMPLE* M_RESTRICT pSrc1,
+            CSAMPLE_GAIN gain1,
+            const CSAMPLE* M_RESTRICT pSrc2,
+            CSAMPLE_GAIN gain2,
+            int iNumSamples);
+    void (*copy3WithRampingGain)(CSAMPLE* M_RESTRICT pDest,
+            const CSAMPLE* M_RESTRICT pSrc0,
+            CSAMPLE_GAIN gain0in,
+            CSAMPLE_GAIN gain0out,
+            const CSAMPLE* M_RESTRICT pSrc1,
+            CSAMPLE_GAIN gain1in,
+            CSAMPLE_GAIN gain1out,
+            const CSAMPLE* M_RESTRICT pSrc2,
+            CSAMPLE_GAIN gain2in,
+            CSAMPLE_GAIN gain2out,
+            int iNumSamples);
+    void (*convertFloat32ToS16)(SAMPLE* pDest,
+            const CSAMPLE* pSrc,
+            SINT numSamples);
+    SampleUtil::CLIP_STATUS (*sumAbsPerChannel)(CSAMPLE* pfAbsL,
+            CSAMPLE* pfAbsR,
+            const CSAMPLE* pBuffer,
+            SINT numSamples);
+    void (*interleaveBuffer)(CSAMPLE* M_RESTRICT pDest,
+            const CSAMPLE* M_RESTRICT pSrc1,
+            const CSAMPLE* M_RESTRICT pSrc2,
+            SINT numFrames);
+    void (*deinterleaveBuffer)(CSAMPLE* M_RESTRICT pDest1,
+            CSAMPLE* M_RESTRICT pDest2,
+            const CSAMPLE* M_RESTRICT pSrc,
+            SINT numFrames);
+};
+
+/// Returns nullptr if the CPU does not support the instruction set.
+const SampleKernels* sampleKernelsForIsa(SampleUtil::Isa isa);
+
+} // namespace mixxx
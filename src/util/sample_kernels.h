@@ -0,0 +1,155 @@
+// This file is included multiple times by sample_dispatch.cpp, once for every
+// instruction set SampleUtil dispatches to at runtime. Each inclusion is
+// wrapped in its own namespace and SAMPLE_KERNEL is defined to the function
+// attributes that enable the instruction set for the compiler, which then
+// autovectorizes the loops with the corresponding vector width.
+//
+// The loops are identical to the former implementations in sample.cpp and
+// must stay that way: Don't use FMA or reorder operations, otherwise the
+// results would differ between the variants. For the same reason
+// sample_dispatch.cpp is compiled with -ffp-contract=off, which prevents the
+// compiler from fusing multiply-adds in the variants with FMA support.
+// The element-wise loops produce identical results for all variants. Only
+// the sums of sumAbsPerChannel() may differ in the last bits, because
+// -ffast-math allows the compiler to split them into as many partial sums
+// as the vector has lanes.
+//
+// The trivial cases (gain 0 or 1) are handled by SampleUtil before calling
+// into one of these kernels.
+//
+// No include guard by intention!
+
+SAMPLE_KERNEL void copyWithGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] = pSrc[i] * gain;
+    }
+}
+
+SAMPLE_KERNEL void copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN old_gain,
+        CSAMPLE_GAIN new_gain,
+        SINT numSamples) {
+    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain) / CSAMPLE_GAIN(numSamples / 2);
+    if (gain_delta != 0) {
+        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
+        // note: LOOP VECTORIZED only with "int i" (not SINT i)
+        for (int i = 0; i < numSamples / 2; ++i) {
+            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
+            pDest[i * 2] = pSrc[i * 2] * gain;
+            pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+        }
+    } else {
+        // note: LOOP VECTORIZED.
+        for (SINT i = 0; i < numSamples; ++i) {
+            pDest[i] = pSrc[i] * old_gain;
+        }
+    }
+}
+
+SAMPLE_KERNEL void addWithGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc[i] * gain;
+    }
+}
+
+SAMPLE_KERNEL void addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN old_gain,
+        CSAMPLE_GAIN new_gain,
+        SINT numSamples) {
+    const CSAMPLE_GAIN gain_delta = (new_gain - old_gain) / CSAMPLE_GAIN(numSamples / 2);
+    if (gain_delta != 0) {
+        const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < numSamples / 2; ++i) {
+            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
+            pDest[i * 2] += pSrc[i * 2] * gain;
+            pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+        }
+    } else {
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < numSamples; ++i) {
+            pDest[i] += pSrc[i] * old_gain;
+        }
+    }
+}
+
+SAMPLE_KERNEL void convertFloat32ToS16(SAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        SINT numSamples) {
+    // We use here -SAMPLE_MINIMUM for a perfect round trip with convertS16ToFloat32
+    // +1.0 is clamped to 32767 (0.99996942)
+    const CSAMPLE kConversionFactor = SAMPLE_MINIMUM * -1.0f;
+    // note: LOOP VECTORIZED only with "int i" (not SINT i)
+    for (int i = 0; i < numSamples; ++i) {
+        pDest[i] = static_cast<SAMPLE>(math_clamp(pSrc[i] * kConversionFactor,
+                static_cast<CSAMPLE>(SAMPLE_MINIMUM),
+                static_cast<CSAMPLE>(SAMPLE_MAXIMUM)));
+    }
+}
+
+SAMPLE_KERNEL SampleUtil::CLIP_STATUS sumAbsPerChannel(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR,
+        const CSAMPLE* pBuffer,
+        SINT numSamples) {
+    CSAMPLE fAbsL = CSAMPLE_ZERO;
+    CSAMPLE fAbsR = CSAMPLE_ZERO;
+    CSAMPLE clippedL = 0;
+    CSAMPLE clippedR = 0;
+
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples / 2; ++i) {
+        CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
+        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        // Replacing the code with a bool clipped will prevent vetorizing
+        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
+    }
+
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
+    if (clippedL > 0) {
+        clipping |= SampleUtil::CLIPPING_LEFT;
+    }
+    if (clippedR > 0) {
+        clipping |= SampleUtil::CLIPPING_RIGHT;
+    }
+    return clipping;
+}
+
+SAMPLE_KERNEL void interleaveBuffer(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+SAMPLE_KERNEL void deinterleaveBuffer(CSAMPLE* M_RESTRICT pDest1,
+        CSAMPLE* M_RESTRICT pDest2,
+        const CSAMPLE* M_RESTRICT pSrc,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest1[i] = pSrc[i * 2];
+        pDest2[i] = pSrc[i * 2 + 1];
+    }
+}
+
+// copy2WithGain(), copy3WithRampingGain(), ...
+#include "util/sample_kernels_autogen.h"
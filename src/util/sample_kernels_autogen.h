@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////
+// THIS FILE IS AUTO-GENERATED. DO NOT EDIT DIRECTLY! //
+// SEE tools/generate_sample_functions.py             //
+////////////////////////////////////////////////////////
+// Included by sample_kernels.h, no include guard by intention!
+SAMPLE_KERNEL void copy2WithGain(CSAMPLE* M_RESTRICT pDest,
+                                 const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0,
+                                 const CSAMPLE* M_RESTRICT pSrc1, CSAMPLE_GAIN gain1,
+                                 int iNumSamples) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < iNumSamples; ++i) {
+        pDest[i] = pSrc0[i] * gain0 +
+                   pSrc1[i] * gain1;
+    }
+}
+SAMPLE_KERNEL void copy2WithRampingGain(CSAMPLE* M_RESTRICT pDest,
+                                        const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0in, CSAMPLE_GAIN gain0out,
+                                        const CSAMPLE* M_RESTRICT pSrc1, CSAMPLE_GAIN gain1in, CSAMPLE_GAIN gain1out,
+                                        int iNumSamples) {
+    const CSAMPLE_GAIN gain_delta0 = (gain0out - gain0in) / (iNumSamples / 2);
+    const CSAMPLE_GAIN start_gain0 = gain0in + gain_delta0;
+    const CSAMPLE_GAIN gain_delta1 = (gain1out - gain1in) / (iNumSamples / 2);
+    const CSAMPLE_GAIN start_gain1 = gain1in + gain_delta1;
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < iNumSamples / 2; ++i) {
+        const CSAMPLE_GAIN gain0 = start_gain0 + gain_delta0 * i;
+        const CSAMPLE_GAIN gain1 = start_gain1 + gain_delta1 * i;
+        pDest[i * 2] = pSrc0[i * 2] * gain0 +
+                       pSrc1[i * 2] * gain1;
+        pDest[i * 2 + 1] = pSrc0[i * 2 + 1] * gain0 +
+                           pSrc1[i * 2 + 1] * gain1;
+    }
+}
+SAMPLE_KERNEL void copy3WithGain(CSAMPLE* M_RESTRICT pDest,
+                                 const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0,
+                                 const CSAMPLE* M_RESTRICT pSrc1, CSAMPLE_GAIN gain1,
+                                 const CSAMPLE* M_RESTRICT pSrc2, CSAMPLE_GAIN gain2,
+                                 int iNumSamples) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < iNumSamples; ++i) {
+        pDest[i] = pSrc0[i] * gain0 +
+                   pSrc1[i] * gain1 +
+                   pSrc2[i] * gain2;
+    }
+}
+SAMPLE_KERNEL void copy3WithRampingGain(CSAMPLE* M_RESTRICT pDest,
+                                        const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0in, CSAMPLE_GAIN gain0out,
+                                        const CSAMPLE* M_RESTRICT pSrc1, CSAMPLE_GAIN gain1in, CSAMPLE_GAIN gain1out,
+                                        const CSAMPLE* M_RESTRICT pSrc2, CSAMPLE_GAIN gain2in, CSAMPLE_GAIN gain2out,
+                                        int iNumSamples) {
+    const CSAMPLE_GAIN gain_delta0 = (gain0out - gain0in) / (iNumSamples / 2);
+    const CSAMPLE_GAIN start_gain0 = gain0in + gain_delta0;
+    const CSAMPLE_GAIN gain_delta1 = (gain1out - gain1in) / (iNumSamples / 2);
+    const CSAMPLE_GAIN start_gain1 = gain1in + gain_delta1;
+    const CSAMPLE_GAIN gain_delta2 = (gain2out - gain2in) / (iNumSamples / 2);
+    const CSAMPLE_GAIN start_gain2 = gain2in + gain_delta2;
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < iNumSamples / 2; ++i) {
+        const CSAMPLE_GAIN gain0 = start_gain0 + gain_delta0 * i;
+        const CSAMPLE_GAIN gain1 = start_gain1 + gain_delta1 * i;
+        const CSAMPLE_GAIN gain2 = start_gain2 + gain_delta2 * i;
+        pDest[i * 2] = pSrc0[i * 2] * gain0 +
+                       pSrc1[i * 2] * gain1 +
+                       pSrc2[i * 2] * gain2;
+        pDest[i * 2 + 1] = pSrc0[i * 2 + 1] * gain0 +
+                           pSrc1[i * 2 + 1] * gain1 +
+                           pSrc2[i * 2 + 1] * gain2;
+    }
+}
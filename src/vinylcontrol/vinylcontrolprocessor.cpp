@@ -1,9 +1,11 @@
 #include "vinylcontrol/vinylcontrolprocessor.h"
 
 #include "control/controlpushbutton.h"
+#include "engine/enginethreadpool.h"
 #include "moc_vinylcontrolprocessor.cpp"
 #include "util/defs.h"
 #include "util/event.h"
+#include "util/math.h"
 #include "util/sample.h"
 #include "util/timer.h"
 #include "vinylcontrol/defs_vinylcontrol.h"
@@ -13,11 +15,23 @@
 #define SIGNAL_QUALITY_FIFO_SIZE 256
 #define SAMPLE_PIPE_FIFO_SIZE 65536
 
+namespace {
+
+// The deck threads share the priority of the processor thread
+constexpr QThread::Priority kProcessorPriority = QThread::HighPriority;
+
+int maxDeckThreadPoolWorkers() {
+    // The processor thread analyzes one of the decks itself
+    return math_max(0,
+            math_min(kMaximumVinylControlInputs, QThread::idealThreadCount()) - 1);
+}
+
+} // anonymous namespace
+
 VinylControlProcessor::VinylControlProcessor(QObject* pParent, UserSettingsPointer pConfig)
         : QThread(pParent),
           m_pConfig(pConfig),
           m_pToggle(new ControlPushButton(ConfigKey(VINYL_PREF_KEY, "Toggle"))),
-          m_pWorkBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
           m_processorsLock(QT_RECURSIVE_MUTEX_INIT),
           m_processors(kMaximumVinylControlInputs, NULL),
           m_signalQualityFifo(SIGNAL_QUALITY_FIFO_SIZE),
@@ -32,18 +46,19 @@ VinylControlProcessor::VinylControlProcessor(QObject* pParent, UserSettingsPoint
 
     for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
         m_samplePipes[i] = new FIFO<CSAMPLE>(SAMPLE_PIPE_FIFO_SIZE);
+        m_pWorkBuffers[i] = SampleUtil::alloc(MAX_BUFFER_LEN);
     }
 
-    start(QThread::HighPriority);
+    start(kProcessorPriority);
 }
 
 VinylControlProcessor::~VinylControlProcessor() {
     m_bQuit = true;
     m_samplesAvailableSignal.wakeAll();
     wait();
+    m_pDeckThreadPool.reset();
 
     delete m_pToggle;
-    SampleUtil::free(m_pWorkBuffer);
 
     {
         const auto locker = lockMutex(&m_processorsLock);
@@ -54,6 +69,8 @@ VinylControlProcessor::~VinylControlProcessor() {
 
             delete m_samplePipes[i];
             m_samplePipes[i] = nullptr;
+            SampleUtil::free(m_pWorkBuffers[i]);
+            m_pWorkBuffers[i] = nullptr;
         }
     }
 
@@ -86,29 +103,38 @@ void VinylControlProcessor::run() {
             m_bReloadConfig = false;
         }
 
+        VinylControl* processors[kMaximumVinylControlInputs];
+        int numPendingDecks = 0;
+        int numEnabledDecks = 0;
         for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
             auto locker = lockMutex(&m_processorsLock);
-            VinylControl* pProcessor = m_processors[i];
+            processors[i] = m_processors[i];
             locker.unlock();
-            FIFO<CSAMPLE>* pSamplePipe = m_samplePipes[i];
-
-            if (pSamplePipe->readAvailable() > 0) {
-                int samplesRead = pSamplePipe->read(m_pWorkBuffer, MAX_BUFFER_LEN);
-
-                if (samplesRead % 2 != 0) {
-                    qWarning() << "VinylControlProcessor received non-even number of samples via sample FIFO.";
-                    samplesRead--;
-                }
-                int framesRead = samplesRead / 2;
-
-                if (pProcessor) {
-                    pProcessor->analyzeSamples(m_pWorkBuffer, framesRead);
-                } else {
-                    // Samples are being written to a non-existent processor. Warning?
-                    qWarning() << "Samples written to non-existent VinylControl processor:" << i;
-                }
+            if (processors[i] && processors[i]->isEnabled()) {
+                ++numEnabledDecks;
             }
+            if (takePendingSamples(i, processors[i], &m_pendingDecks[numPendingDecks])) {
+                ++numPendingDecks;
+            }
+        }
+        resizeDeckThreadPool(numEnabledDecks);
+
+        // The decks are independent of each other, so they are analyzed in
+        // parallel if vinyl control is enabled on more than one of them.
+        auto analyzeDeck = [this](int index) {
+            const PendingDeck& deck = m_pendingDecks[index];
+            deck.pProcessor->analyzeSamples(deck.pSamples, deck.frames);
+        };
+        if (m_pDeckThreadPool) {
+            m_pDeckThreadPool->run(numPendingDecks, analyzeDeck);
+        } else {
+            for (int i = 0; i < numPendingDecks; ++i) {
+                analyzeDeck(i);
+            }
+        }
 
+        for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
+            VinylControl* pProcessor = processors[i];
             // TODO(rryan) define a time-based update rate. This will update way
             // too quickly.
             if (pProcessor && m_bReportSignalQuality) {
@@ -134,6 +160,48 @@ void VinylControlProcessor::run() {
     }
 }
 
+bool VinylControlProcessor::takePendingSamples(
+        int i, VinylControl* pProcessor, PendingDeck* pDeck) {
+    FIFO<CSAMPLE>* pSamplePipe = m_samplePipes[i];
+    if (pSamplePipe->readAvailable() <= 0) {
+        return false;
+    }
+
+    CSAMPLE* pWorkBuffer = m_pWorkBuffers[i];
+    int samplesRead = pSamplePipe->read(pWorkBuffer, MAX_BUFFER_LEN);
+
+    if (samplesRead % 2 != 0) {
+        qWarning() << "VinylControlProcessor received non-even number of samples via sample FIFO.";
+        samplesRead--;
+    }
+    int framesRead = samplesRead / 2;
+
+    if (!pProcessor) {
+        // Samples are being written to a non-existent processor. Warning?
+        qWarning() << "Samples written to non-existent VinylControl processor:" << i;
+        return false;
+    }
+
+    pDeck->pProcessor = pProcessor;
+    pDeck->pSamples = pWorkBuffer;
+    pDeck->frames = framesRead;
+    return true;
+}
+
+void VinylControlProcessor::resizeDeckThreadPool(int numEnabledDecks) {
+    const int numWorkers = math_min(numEnabledDecks - 1, maxDeckThreadPoolWorkers());
+    if (numWorkers <= 0) {
+        m_pDeckThreadPool.reset();
+        return;
+    }
+    // Vinyl control is rarely toggled, so the threads are simply recreated
+    if (!m_pDeckThreadPool || m_pDeckThreadPool->numWorkers() != numWorkers) {
+        m_pDeckThreadPool.reset();
+        m_pDeckThreadPool = std::make_unique<EngineThreadPool>(
+                numWorkers, kProcessorPriority);
+    }
+}
+
 void VinylControlProcessor::reloadConfig() {
     for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
         auto locker = lockMutex(&m_processorsLock);
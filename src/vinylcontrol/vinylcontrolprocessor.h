@@ -5,6 +5,7 @@
 #include <QThread>
 #include <QVector>
 #include <QWaitCondition>
+#include <memory>
 
 #include "preferences/usersettings.h"
 #include "soundio/soundmanagerutil.h"
@@ -14,11 +15,14 @@
 
 class VinylControl;
 class ControlPushButton;
+class EngineThreadPool;
 
 // VinylControlProcessor is a thread that is in charge of receiving samples from
 // the engine callback and feeding those samples to the VinylControl
 // classes. The most important thing is that the connection between the engine
 // callback and VinylControlProcessor (the receiveBuffer method) is lock-free.
+// When vinyl control is enabled on several decks, the decks are analyzed in
+// parallel on a small thread pool that only exists as long as it is needed.
 class VinylControlProcessor : public QThread, public AudioDestination {
     Q_OBJECT
   public:
@@ -62,7 +66,20 @@ class VinylControlProcessor : public QThread, public AudioDestination {
     void toggleDeck(double value);
 
   private:
+    // The samples of one deck that are analyzed in the current cycle
+    struct PendingDeck {
+        VinylControl* pProcessor;
+        CSAMPLE* pSamples;
+        int frames;
+    };
+
     void reloadConfig();
+    // Reads the samples of deck i from its pipe. Returns false if there are
+    // none to analyze.
+    bool takePendingSamples(int i, VinylControl* pProcessor, PendingDeck* pDeck);
+    // Creates or destroys the deck threads, so there is one thread for each
+    // deck with vinyl control enabled. Called from the processor thread.
+    void resizeDeckThreadPool(int numEnabledDecks);
 
     UserSettingsPointer m_pConfig;
     ControlPushButton* m_pToggle;
@@ -70,7 +87,12 @@ class VinylControlProcessor : public QThread, public AudioDestination {
     // callback to the processor thread. There is a maximum of
     // kMaximumVinylControlInputs pipes.
     FIFO<CSAMPLE>* m_samplePipes[kMaximumVinylControlInputs];
-    CSAMPLE* m_pWorkBuffer;
+    // One work buffer per deck, so that the decks can be analyzed in parallel
+    CSAMPLE* m_pWorkBuffers[kMaximumVinylControlInputs];
+    PendingDeck m_pendingDecks[kMaximumVinylControlInputs];
+    // Runs at the priority of the processor thread, which analyzes one of the
+    // decks itself. Null while vinyl control is enabled on less than 2 decks.
+    std::unique_ptr<EngineThreadPool> m_pDeckThreadPool;
     QWaitCondition m_samplesAvailableSignal;
     QMutex m_waitForSampleMutex;
     QT_RECURSIVE_MUTEX m_processorsLock;
@@ -212,21 +212,18 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
     }
 
     // Convert CSAMPLE samples to shorts, preventing overflow.
+    const CSAMPLE factor = gain * SAMPLE_MAXIMUM;
+    short* pWorkBuffer = m_pWorkBuffer.data();
+    // note: LOOP VECTORIZED only with "int i" and without branches
     for (int i = 0; i < static_cast<int>(samplesSize); ++i) {
-        CSAMPLE sample = pSamples[i] * gain * SAMPLE_MAXIMUM;
-
-        if (sample > SAMPLE_MAXIMUM) {
-            m_pWorkBuffer[i] = SAMPLE_MAXIMUM;
-        } else if (sample < SAMPLE_MINIMUM) {
-            m_pWorkBuffer[i] = SAMPLE_MINIMUM;
-        } else {
-            m_pWorkBuffer[i] = static_cast<short>(sample);
-        }
+        pWorkBuffer[i] = static_cast<short>(math_clamp(pSamples[i] * factor,
+                static_cast<CSAMPLE>(SAMPLE_MINIMUM),
+                static_cast<CSAMPLE>(SAMPLE_MAXIMUM)));
     }
 
     // Submit the samples to the xwax timecode processor. The size argument is
     // in stereo frames.
-    timecoder_submit(&timecoder, m_pWorkBuffer.data(), nFrames);
+    timecoder_submit_block(&timecoder, pWorkBuffer, nFrames);
 
     bool bHaveSignal = fabs(pSamples[0]) + fabs(pSamples[1]) > kMinSignal;
     //qDebug() << "signal?" << bHaveSignal;
@@ -1,6 +1,7 @@
 #include <QTimer>
 
 #include "waveform/guitick.h"
+#include "control/controlchangejournal.h"
 #include "control/controlobject.h"
 
 GuiTick::GuiTick() {
@@ -12,6 +13,13 @@ GuiTick::GuiTick() {
 // this is called from WaveformWidgetFactory::render in the main thread with the
 // configured waveform frame rate
 void GuiTick::process() {
+    // Deliver the control changes of the last frame before the widgets
+    // that are driven by the ticks below are updated.
+    ControlChangeJournal* pJournal = ControlChangeJournal::guiJournal();
+    if (pJournal) {
+        pJournal->drain();
+    }
+
     m_cpuTimeLastTick += m_cpuTimer.restart();
     double cpuTimeLastTickSeconds = m_cpuTimeLastTick.toDoubleSeconds();
     m_pCOGuiTickTime->set(cpuTimeLastTickSeconds);
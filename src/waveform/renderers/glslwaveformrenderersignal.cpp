@@ -88,6 +88,8 @@ bool GLSLWaveformRendererSignal::loadTexture() {
         if (waveform) {
             dataSize = waveform->getDataSize();
             if (dataSize > 1) {
+                // The whole waveform is uploaded as a texture
+                waveform->loadAll();
                 data = waveform->data();
             }
         }
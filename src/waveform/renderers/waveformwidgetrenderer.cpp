@@ -125,8 +125,9 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
     m_visualSamplePerPixel = math_max(0.01, visualSamplePerPixel);
 
     TrackPointer pTrack = m_pTrack;
+    ConstWaveformPointer pWaveform;
     if (pTrack) {
-        ConstWaveformPointer pWaveform = pTrack->getWaveform();
+        pWaveform = pTrack->getWaveform();
         if (pWaveform) {
             m_audioVisualRatio = pWaveform->getAudioVisualRatio();
         }
@@ -162,6 +163,14 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
 
         m_firstDisplayedPosition = m_playPos - displayedLengthLeft;
         m_lastDisplayedPosition = m_playPos + displayedLengthRight;
+
+        if (pWaveform) {
+            // Page in the visible region of a stored waveform
+            const int dataSize = pWaveform->getDataSize();
+            pWaveform->loadRange(
+                    static_cast<int>(std::floor(m_firstDisplayedPosition * dataSize)),
+                    static_cast<int>(std::ceil(m_lastDisplayedPosition * dataSize)) + 1);
+        }
     } else {
         m_playPos = -1; // disable renderers
     }
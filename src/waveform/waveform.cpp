@@ -2,6 +2,8 @@
 
 #include "waveform/waveform.h"
 #include "proto/waveform.pb.h"
+#include "util/math.h"
+#include "waveform/waveformblockfile.h"
 
 using namespace mixxx::track;
 
@@ -64,10 +66,72 @@ Waveform::Waveform(int audioSampleRate, int audioSamples,
     setCompletion(0);
 }
 
+Waveform::Waveform(std::unique_ptr<WaveformBlockFile> pBlockFile)
+        : m_id(-1),
+          m_saveState(SaveState::NotSaved),
+          m_dataSize(0),
+          m_visualSampleRate(0),
+          m_audioVisualRatio(0),
+          m_textureStride(computeTextureStride(0)),
+          m_completion(-1) {
+    if (!pBlockFile) {
+        return;
+    }
+    resize(pBlockFile->dataSize());
+    m_visualSampleRate = pBlockFile->visualSampleRate();
+    m_audioVisualRatio = pBlockFile->audioVisualRatio();
+    m_loadedBlocks.assign(pBlockFile->blockCount(), false);
+    m_pendingBlockCount = pBlockFile->blockCount();
+    if (m_pendingBlockCount > 0) {
+        m_pBlockFile = std::move(pBlockFile);
+    }
+    m_completion = m_dataSize;
+    m_saveState = SaveState::Saved;
+}
+
 Waveform::~Waveform() {
 }
 
+void Waveform::loadRange(int first, int last) const {
+    if (m_pendingBlockCount.loadAcquire() == 0) {
+        return;
+    }
+    const auto locker = lockMutex(&m_blockMutex);
+    if (!m_pBlockFile) {
+        return;
+    }
+    first = math_max(first, 0);
+    last = math_min(last, m_dataSize);
+    if (first >= last) {
+        return;
+    }
+    const int blockSize = m_pBlockFile->blockSize();
+    // The blocks are only written once before they are rendered, like
+    // the analyzer does while the waveform is completed.
+    WaveformData* pData = m_data.data();
+    for (int blockIndex = first / blockSize;
+            blockIndex <= (last - 1) / blockSize;
+            ++blockIndex) {
+        if (m_loadedBlocks[blockIndex]) {
+            continue;
+        }
+        // WaveformFactory has verified the blocks, so this only fails if
+        // the file has been modified since. The block is not read again.
+        if (!m_pBlockFile->readBlock(blockIndex, pData + blockIndex * blockSize)) {
+            qWarning() << "Waveform block" << blockIndex << "remains empty";
+        }
+        m_loadedBlocks[blockIndex] = true;
+        m_pendingBlockCount.deref();
+    }
+    if (m_pendingBlockCount.loadAcquire() == 0) {
+        // Unmaps and closes the file
+        m_pBlockFile.reset();
+    }
+}
+
 QByteArray Waveform::toByteArray() const {
+    loadAll();
+
     io::Waveform waveform;
     waveform.set_visual_sample_rate(m_visualSampleRate);
     waveform.set_audio_visual_ratio(m_audioVisualRatio);
@@ -5,6 +5,7 @@
 #include <QMutex>
 #include <QSharedPointer>
 #include <QString>
+#include <memory>
 #include <vector>
 
 #include "util/class.h"
@@ -26,6 +27,8 @@ union WaveformData {
     WaveformData(int i) { m_i = i;}
 };
 
+class WaveformBlockFile;
+
 class Waveform {
   public:
     enum class SaveState {
@@ -37,6 +40,8 @@ class Waveform {
     explicit Waveform(const QByteArray& pData = QByteArray());
     Waveform(int audioSampleRate, int audioSamples,
              int desiredVisualSampleRate, int maxVisualSamples);
+    /// The data is read from the block file on demand, see loadRange().
+    explicit Waveform(std::unique_ptr<WaveformBlockFile> pBlockFile);
 
     virtual ~Waveform();
 
@@ -94,6 +99,12 @@ class Waveform {
         return m_audioVisualRatio;
     }
 
+    // We do not lock the mutex since m_visualSampleRate is not changed after
+    // the constructor runs.
+    double getVisualSampleRate() const {
+        return m_visualSampleRate;
+    }
+
     // Atomically lookup the completion of the waveform. Represents the number
     // of data elements that have been processed out of dataSize.
     int getCompletion() const {
@@ -130,6 +141,15 @@ class Waveform {
     // constructor runs.
     const WaveformData* data() const { return &m_data[0];}
 
+    /// Waveforms that have been loaded from a block file are read in
+    /// blocks on demand. Ensures that the data elements in the range
+    /// [first, last) are available, all others might still be 0. Does
+    /// nothing for waveforms that are kept in memory entirely.
+    void loadRange(int first, int last) const;
+    void loadAll() const {
+        loadRange(0, getDataSize());
+    }
+
     void dump() const;
 
   private:
@@ -142,7 +162,6 @@ class Waveform {
     inline unsigned char& mid(int i) { return m_data[i].filtered.mid;}
     inline unsigned char& high(int i) { return m_data[i].filtered.high;}
     inline unsigned char& all(int i) { return m_data[i].filtered.all;}
-    double getVisualSampleRate() const { return m_visualSampleRate; }
 
     // If stored in the database, the ID of the waveform.
     int m_id;
@@ -161,7 +180,8 @@ class Waveform {
     // checking when accessing the vector.
     // TODO(XXX): In the future we should switch to QVector and use the raw data
     // pointer when performance matters.
-    std::vector<WaveformData> m_data;
+    // mutable since loadRange() fills in the blocks of a block file on demand.
+    mutable std::vector<WaveformData> m_data;
     // Not allowed to change after the constructor runs.
     double m_visualSampleRate;
     // Not allowed to change after the constructor runs.
@@ -177,6 +197,14 @@ class Waveform {
 
     mutable QMutex m_mutex;
 
+    // The block file is released after all blocks have been read. The
+    // number of pending blocks is checked without locking m_blockMutex,
+    // because loadRange() is called for every rendered frame.
+    mutable std::unique_ptr<WaveformBlockFile> m_pBlockFile;
+    mutable std::vector<bool> m_loadedBlocks;
+    mutable QAtomicInt m_pendingBlockCount;
+    mutable QMutex m_blockMutex;
+
     DISALLOW_COPY_AND_ASSIGN(Waveform);
 };
 
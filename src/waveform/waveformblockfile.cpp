@@ -0,0 +1,391 @@
+#include "waveform/waveformblockfile.h"
+
+#include <QDataStream>
+#include <limits>
+
+#include "util/logger.h"
+#include "util/math.h"
+#include "waveform/waveform.h"
+
+namespace {
+
+const mixxx::Logger kLogger("WaveformBlockFile");
+
+constexpr quint32 kMagic = 0x4257584d; // "MXWB"
+constexpr quint32 kVersion = 1;
+
+constexpr qint64 kHeaderSize = 48;
+constexpr qint64 kIndexEntrySize = 16;
+
+// The same trade-off between size and CPU time as for other analyses
+constexpr int kCompressionLevel = -1;
+
+// The bands low, mid, high, and all
+constexpr int kBandCount = 4;
+
+struct Header {
+    quint32 dataSize;
+    quint32 blockSize;
+    double visualSampleRate;
+    double audioVisualRatio;
+    quint32 blockCount;
+    quint16 indexChecksum;
+    // 0 until the file is finished
+    quint64 indexOffset;
+};
+
+void initStream(QDataStream* pStream) {
+    pStream->setByteOrder(QDataStream::LittleEndian);
+    pStream->setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+quint16 checksum(const char* pData, int size) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return qChecksum(QByteArrayView(pData, size));
+#else
+    return qChecksum(pData, static_cast<uint>(size));
+#endif
+}
+
+int blockCountForDataSize(qint64 dataSize, qint64 blockSize) {
+    return static_cast<int>((dataSize + blockSize - 1) / blockSize);
+}
+
+bool readHeader(QFile* pFile, Header* pHeader) {
+    if (!pFile->seek(0)) {
+        return false;
+    }
+    QDataStream stream(pFile);
+    initStream(&stream);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint16 reserved = 0;
+    stream >> magic >> version >>
+            pHeader->dataSize >> pHeader->blockSize >>
+            pHeader->visualSampleRate >> pHeader->audioVisualRatio >>
+            pHeader->blockCount >> pHeader->indexChecksum >> reserved >>
+            pHeader->indexOffset;
+    return stream.status() == QDataStream::Ok &&
+            magic == kMagic &&
+            version == kVersion &&
+            pHeader->indexOffset >= static_cast<quint64>(kHeaderSize) &&
+            pHeader->blockSize > 0 &&
+            pHeader->blockSize <= static_cast<quint32>(std::numeric_limits<int>::max() / kBandCount) &&
+            pHeader->dataSize <= static_cast<quint32>(std::numeric_limits<int>::max()) &&
+            pHeader->blockCount ==
+            static_cast<quint32>(blockCountForDataSize(
+                    pHeader->dataSize, pHeader->blockSize));
+}
+
+QByteArray encodeBlock(const WaveformData* pData, int size) {
+    QByteArray planarData(size * kBandCount, Qt::Uninitialized);
+    char* pLow = planarData.data();
+    char* pMid = pLow + size;
+    char* pHigh = pMid + size;
+    char* pAll = pHigh + size;
+    for (int i = 0; i < size; ++i) {
+        pLow[i] = static_cast<char>(pData[i].filtered.low);
+        pMid[i] = static_cast<char>(pData[i].filtered.mid);
+        pHigh[i] = static_cast<char>(pData[i].filtered.high);
+        pAll[i] = static_cast<char>(pData[i].filtered.all);
+    }
+    return qCompress(planarData, kCompressionLevel);
+}
+
+void decodeBlock(const QByteArray& planarData, WaveformData* pData, int size) {
+    const auto* pLow = reinterpret_cast<const unsigned char*>(planarData.constData());
+    const auto* pMid = pLow + size;
+    const auto* pHigh = pMid + size;
+    const auto* pAll = pHigh + size;
+    for (int i = 0; i < size; ++i) {
+        pData[i].filtered.low = pLow[i];
+        pData[i].filtered.mid = pMid[i];
+        pData[i].filtered.high = pHigh[i];
+        pData[i].filtered.all = pAll[i];
+    }
+}
+
+} // anonymous namespace
+
+// static
+std::unique_ptr<WaveformBlockFile> WaveformBlockFile::open(const QString& filePath) {
+    auto pBlockFile = std::unique_ptr<WaveformBlockFile>(new WaveformBlockFile(filePath));
+    if (!pBlockFile->m_file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    if (!pBlockFile->readIndex()) {
+        kLogger.warning()
+                << "Failed to read waveform from"
+                << filePath;
+        return nullptr;
+    }
+    // Blocks are read from the file if it cannot be mapped
+    pBlockFile->m_pMappedData = pBlockFile->m_file.map(0, pBlockFile->m_file.size());
+    return pBlockFile;
+}
+
+// static
+bool WaveformBlockFile::probe(const QString& filePath,
+        quint16* pIndexChecksum,
+        int* pDataSize) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    Header header;
+    if (!readHeader(&file, &header)) {
+        return false;
+    }
+    if (pIndexChecksum) {
+        *pIndexChecksum = header.indexChecksum;
+    }
+    if (pDataSize) {
+        *pDataSize = static_cast<int>(header.dataSize);
+    }
+    return true;
+}
+
+WaveformBlockFile::WaveformBlockFile(const QString& filePath)
+        : m_file(filePath),
+          m_pMappedData(nullptr),
+          m_dataSize(0),
+          m_blockSize(0),
+          m_visualSampleRate(0),
+          m_audioVisualRatio(0),
+          m_indexChecksum(0) {
+}
+
+WaveformBlockFile::~WaveformBlockFile() {
+    if (m_pMappedData) {
+        m_file.unmap(const_cast<uchar*>(m_pMappedData));
+    }
+}
+
+bool WaveformBlockFile::readIndex() {
+    Header header;
+    if (!readHeader(&m_file, &header)) {
+        return false;
+    }
+    const qint64 indexSize = header.blockCount * kIndexEntrySize;
+    if (static_cast<qint64>(header.indexOffset) + indexSize > m_file.size() ||
+            !m_file.seek(header.indexOffset)) {
+        return false;
+    }
+    const QByteArray indexData = m_file.read(indexSize);
+    if (indexData.size() != indexSize ||
+            checksum(indexData.constData(), indexData.size()) != header.indexChecksum) {
+        return false;
+    }
+
+    QDataStream stream(indexData);
+    initStream(&stream);
+    m_blocks.reserve(header.blockCount);
+    for (quint32 i = 0; i < header.blockCount; ++i) {
+        quint64 offset = 0;
+        quint32 compressedSize = 0;
+        quint16 blockChecksum = 0;
+        quint16 reserved = 0;
+        stream >> offset >> compressedSize >> blockChecksum >> reserved;
+        // Blocks are located between the header and the index
+        if (offset < static_cast<quint64>(kHeaderSize) ||
+                offset + compressedSize > header.indexOffset) {
+            m_blocks.clear();
+            return false;
+        }
+        m_blocks.push_back(Block{static_cast<qint64>(offset),
+                static_cast<int>(compressedSize),
+                blockChecksum});
+    }
+
+    m_dataSize = static_cast<int>(header.dataSize);
+    m_blockSize = static_cast<int>(header.blockSize);
+    m_visualSampleRate = header.visualSampleRate;
+    m_audioVisualRatio = header.audioVisualRatio;
+    m_indexChecksum = header.indexChecksum;
+    return true;
+}
+
+int WaveformBlockFile::blockDataSize(int blockIndex) const {
+    return math_min(m_blockSize, m_dataSize - blockIndex * m_blockSize);
+}
+
+QByteArray WaveformBlockFile::readCompressedBlock(int blockIndex) const {
+    const Block& block = m_blocks[blockIndex];
+    QByteArray compressedData;
+    if (m_pMappedData) {
+        // Wraps the mapped memory without copying it
+        compressedData = QByteArray::fromRawData(
+                reinterpret_cast<const char*>(m_pMappedData + block.offset),
+                block.compressedSize);
+    } else if (m_file.seek(block.offset)) {
+        compressedData = m_file.read(block.compressedSize);
+    }
+    if (compressedData.size() != block.compressedSize ||
+            checksum(compressedData.constData(), compressedData.size()) !=
+                    block.checksum) {
+        kLogger.warning()
+                << "Corrupt block" << blockIndex
+                << "in" << m_file.fileName();
+        return QByteArray();
+    }
+    return compressedData;
+}
+
+bool WaveformBlockFile::verifyBlocks() const {
+    bool intact = true;
+    for (int blockIndex = 0; blockIndex < blockCount(); ++blockIndex) {
+        // Continues to log all corrupt blocks
+        if (readCompressedBlock(blockIndex).isNull()) {
+            intact = false;
+        }
+    }
+    return intact;
+}
+
+bool WaveformBlockFile::readBlock(int blockIndex, WaveformData* pDest) const {
+    VERIFY_OR_DEBUG_ASSERT(blockIndex >= 0 && blockIndex < blockCount()) {
+        return false;
+    }
+    const QByteArray compressedData = readCompressedBlock(blockIndex);
+    if (compressedData.isNull()) {
+        return false;
+    }
+    const int size = blockDataSize(blockIndex);
+    const QByteArray planarData = qUncompress(compressedData);
+    if (planarData.size() != size * kBandCount) {
+        kLogger.warning()
+                << "Failed to decompress block" << blockIndex
+                << "in" << m_file.fileName();
+        return false;
+    }
+    decodeBlock(planarData, pDest, size);
+    return true;
+}
+
+WaveformBlockFileWriter::WaveformBlockFileWriter(int blockSize)
+        : m_blockSize(blockSize),
+          m_indexChecksum(0) {
+    DEBUG_ASSERT(m_blockSize > 0);
+}
+
+WaveformBlockFileWriter::~WaveformBlockFileWriter() {
+    abort();
+}
+
+bool WaveformBlockFileWriter::open(const QString& filePath, const Waveform& waveform) {
+    abort();
+    m_blocks.clear();
+    m_indexChecksum = 0;
+    m_pFile = std::make_unique<QSaveFile>(filePath);
+    if (!m_pFile->open(QIODevice::WriteOnly)) {
+        kLogger.warning()
+                << "Failed to create"
+                << filePath
+                << m_pFile->errorString();
+        m_pFile.reset();
+        return false;
+    }
+    // Marks the file as unfinished until the index has been written
+    if (!writeHeader(waveform, 0)) {
+        abort();
+        return false;
+    }
+    return true;
+}
+
+bool WaveformBlockFileWriter::writeHeader(const Waveform& waveform, qint64 indexOffset) {
+    if (!m_pFile->seek(0)) {
+        return false;
+    }
+    QDataStream stream(m_pFile.get());
+    initStream(&stream);
+    stream << kMagic
+           << kVersion
+           << static_cast<quint32>(waveform.getDataSize())
+           << static_cast<quint32>(m_blockSize)
+           << waveform.getVisualSampleRate()
+           << waveform.getAudioVisualRatio()
+           << static_cast<quint32>(m_blocks.size())
+           << m_indexChecksum
+           << static_cast<quint16>(0)
+           << static_cast<quint64>(indexOffset);
+    return stream.status() == QDataStream::Ok && m_pFile->pos() == kHeaderSize;
+}
+
+bool WaveformBlockFileWriter::writeBlock(const Waveform& waveform) {
+    const int blockIndex = static_cast<int>(m_blocks.size());
+    const int first = blockIndex * m_blockSize;
+    const int size = math_min(m_blockSize, waveform.getDataSize() - first);
+    const QByteArray compressedData = encodeBlock(waveform.data() + first, size);
+    const qint64 offset = m_pFile->pos();
+    if (m_pFile->write(compressedData) != compressedData.size()) {
+        return false;
+    }
+    m_blocks.push_back(WaveformBlockFile::Block{offset,
+            static_cast<int>(compressedData.size()),
+            checksum(compressedData.constData(), compressedData.size())});
+    return true;
+}
+
+bool WaveformBlockFileWriter::write(const Waveform& waveform, int completion) {
+    VERIFY_OR_DEBUG_ASSERT(isOpen()) {
+        return false;
+    }
+    completion = math_min(completion, waveform.getDataSize());
+    while ((static_cast<int>(m_blocks.size()) + 1) * m_blockSize <= completion) {
+        if (!writeBlock(waveform)) {
+            kLogger.warning()
+                    << "Failed to write"
+                    << m_pFile->fileName()
+                    << m_pFile->errorString();
+            abort();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WaveformBlockFileWriter::finish(const Waveform& waveform) {
+    VERIFY_OR_DEBUG_ASSERT(isOpen()) {
+        return false;
+    }
+    const int blockCount = blockCountForDataSize(waveform.getDataSize(), m_blockSize);
+    while (static_cast<int>(m_blocks.size()) < blockCount) {
+        if (!writeBlock(waveform)) {
+            break;
+        }
+    }
+
+    QByteArray indexData;
+    {
+        QDataStream stream(&indexData, QIODevice::WriteOnly);
+        initStream(&stream);
+        for (const auto& block : m_blocks) {
+            stream << static_cast<quint64>(block.offset)
+                   << static_cast<quint32>(block.compressedSize)
+                   << block.checksum
+                   << static_cast<quint16>(0);
+        }
+    }
+    m_indexChecksum = checksum(indexData.constData(), indexData.size());
+    const qint64 indexOffset = m_pFile->pos();
+    // commit() replaces the file atomically
+    if (static_cast<int>(m_blocks.size()) != blockCount ||
+            m_pFile->write(indexData) != indexData.size() ||
+            !writeHeader(waveform, indexOffset) ||
+            !m_pFile->commit()) {
+        kLogger.warning()
+                << "Failed to write"
+                << m_pFile->fileName()
+                << m_pFile->errorString();
+        abort();
+        return false;
+    }
+    m_pFile.reset();
+    return true;
+}
+
+void WaveformBlockFileWriter::abort() {
+    // Removes the temporary file without touching the file
+    m_pFile.reset();
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "util/class.h"
+
+class Waveform;
+union WaveformData;
+
+/// A waveform stored as a sequence of independently compressed blocks,
+/// followed by an index with the position of each block.
+///
+/// Reading a waveform only requires the fixed size header and the index.
+/// The file is memory mapped and the blocks are inflated on demand, i.e.
+/// only for the region that is actually displayed. The blocks can be
+/// written while the waveform is still being analyzed, the index and the
+/// header are completed afterwards.
+///
+/// All multi-byte values are stored in little-endian byte order. Within a
+/// block the bands of the waveform data are stored one after another,
+/// which compresses better than the interleaved layout in memory.
+class WaveformBlockFile final {
+  public:
+    /// The number of waveform data elements per block. 32 KiB of raw
+    /// data or about 9 s of a track with the default visual sample rate.
+    static constexpr int kDefaultBlockSize = 8192;
+
+    /// Returns nullptr if the file does not exist, has not been finished,
+    /// or is corrupt.
+    static std::unique_ptr<WaveformBlockFile> open(const QString& filePath);
+
+    /// Reads only the header to check if this is a finished block file.
+    static bool probe(const QString& filePath,
+            quint16* pIndexChecksum,
+            int* pDataSize = nullptr);
+
+    ~WaveformBlockFile();
+
+    int dataSize() const {
+        return m_dataSize;
+    }
+    int blockSize() const {
+        return m_blockSize;
+    }
+    int blockCount() const {
+        return static_cast<int>(m_blocks.size());
+    }
+    double visualSampleRate() const {
+        return m_visualSampleRate;
+    }
+    double audioVisualRatio() const {
+        return m_audioVisualRatio;
+    }
+    /// Stored in the database for detecting corrupt files.
+    quint16 indexChecksum() const {
+        return m_indexChecksum;
+    }
+
+    /// Checks the checksums of all blocks without inflating them and
+    /// logs the corrupt ones. Reads the entire file.
+    bool verifyBlocks() const;
+
+    /// Inflates a block into pDest, which must provide space for
+    /// blockSize() elements. Only the last block might contain less.
+    /// Not thread-safe.
+    bool readBlock(int blockIndex, WaveformData* pDest) const;
+
+  private:
+    struct Block {
+        qint64 offset;
+        int compressedSize;
+        quint16 checksum;
+    };
+
+    explicit WaveformBlockFile(const QString& filePath);
+
+    bool readIndex();
+    /// Returns a null array if the block is corrupt.
+    QByteArray readCompressedBlock(int blockIndex) const;
+    int blockDataSize(int blockIndex) const;
+
+    // mutable for the fallback if the file cannot be mapped
+    mutable QFile m_file;
+    const uchar* m_pMappedData;
+
+    int m_dataSize;
+    int m_blockSize;
+    double m_visualSampleRate;
+    double m_audioVisualRatio;
+    quint16 m_indexChecksum;
+    std::vector<Block> m_blocks;
+
+    friend class WaveformBlockFileWriter;
+
+    DISALLOW_COPY_AND_ASSIGN(WaveformBlockFile);
+};
+
+/// Writes a WaveformBlockFile, either progressively while the waveform is
+/// being analyzed or at once.
+///
+/// The blocks are written to a unique temporary file in the same directory,
+/// which atomically replaces the file in finish(). Until then the file is
+/// left untouched, so concurrent writers of the same file don't interfere
+/// and an unfinished file is never visible. It is removed when the writer
+/// is aborted or destroyed.
+class WaveformBlockFileWriter final {
+  public:
+    explicit WaveformBlockFileWriter(
+            int blockSize = WaveformBlockFile::kDefaultBlockSize);
+    ~WaveformBlockFileWriter();
+
+    /// Creates the file and writes a preliminary header.
+    bool open(const QString& filePath, const Waveform& waveform);
+    bool isOpen() const {
+        return m_pFile && m_pFile->isOpen();
+    }
+
+    /// Appends all blocks that are entirely below completion, i.e. the
+    /// number of elements that have been analyzed.
+    bool write(const Waveform& waveform, int completion);
+
+    /// Appends the remaining blocks and the index and completes the
+    /// header.
+    bool finish(const Waveform& waveform);
+
+    /// Discards an unfinished file.
+    void abort();
+
+    /// Only valid after finish() succeeded.
+    quint16 indexChecksum() const {
+        return m_indexChecksum;
+    }
+
+  private:
+    bool writeHeader(const Waveform& waveform, qint64 indexOffset);
+    bool writeBlock(const Waveform& waveform);
+
+    const int m_blockSize;
+    std::unique_ptr<QSaveFile> m_pFile;
+    std::vector<WaveformBlockFile::Block> m_blocks;
+    quint16 m_indexChecksum;
+
+    DISALLOW_COPY_AND_ASSIGN(WaveformBlockFileWriter);
+};
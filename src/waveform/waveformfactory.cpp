@@ -2,11 +2,29 @@
 
 #include "waveform/waveformfactory.h"
 #include "waveform/waveform.h"
+#include "waveform/waveformblockfile.h"
 
 // static
 Waveform* WaveformFactory::loadWaveformFromAnalysis(
         const AnalysisDao::AnalysisInfo& analysis) {
-    Waveform* pWaveform = new Waveform(analysis.data);
+    Waveform* pWaveform;
+    if (analysis.dataPath.isEmpty()) {
+        pWaveform = new Waveform(analysis.data);
+    } else {
+        auto pBlockFile = WaveformBlockFile::open(analysis.dataPath);
+        // Blocks that are found to be corrupt while rendering would remain
+        // empty forever. Returning nothing lets the analyzer run again.
+        if (!pBlockFile || !pBlockFile->verifyBlocks()) {
+            qWarning() << "Discarding corrupt waveform" << analysis.dataPath;
+            return nullptr;
+        }
+        pWaveform = new Waveform(std::move(pBlockFile));
+        if (analysis.type == AnalysisDao::TYPE_WAVESUMMARY) {
+            // The overview is always displayed entirely and only consists
+            // of a few blocks.
+            pWaveform->loadAll();
+        }
+    }
     pWaveform->setId(analysis.analysisId);
     pWaveform->setVersion(analysis.version);
     pWaveform->setDescription(analysis.description);
@@ -20,6 +38,11 @@ WaveformFactory::VersionClass WaveformFactory::waveformVersionToVersionClass(con
         return VC_USE;
     }
 
+    if (version == WAVEFORM_5_VERSION) {
+        // The same data, but loaded in full
+        return VC_USE;
+    }
+
     if (version == WAVEFORM_4_VERSION) {
         // Used in Mixxx 1.12 beta, suffers Bug lp:1406389
         return VC_REMOVE;
@@ -46,6 +69,11 @@ WaveformFactory::VersionClass WaveformFactory::waveformSummaryVersionToVersionCl
         return VC_USE;
     }
 
+    if (version == WAVEFORMSUMMARY_5_VERSION) {
+        // The same data, but loaded in full
+        return VC_USE;
+    }
+
     if (version == WAVEFORMSUMMARY_4_VERSION) {
         // Used in Mixxx 1.12 beta, suffers Bug lp:1406389
         return VC_REMOVE;
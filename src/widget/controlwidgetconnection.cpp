@@ -2,6 +2,7 @@
 
 #include <QStyle>
 
+#include "control/controlchangejournal.h"
 #include "control/controlproxy.h"
 #include "moc_controlwidgetconnection.cpp"
 #include "util/assert.h"
@@ -38,7 +39,17 @@ ControlWidgetConnection::ControlWidgetConnection(
         : m_pWidget(pBaseWidget),
           m_pValueTransformer(pTransformer) {
     m_pControl = new ControlProxy(key, this, ControlFlag::NoAssertIfMissing);
-    m_pControl->connectValueChanged(this, &ControlWidgetConnection::slotControlValueChanged);
+    ControlChangeJournal* pJournal = ControlChangeJournal::guiJournal();
+    ControlJournalSubscription* pSubscription =
+            pJournal && m_pControl->valid() ? pJournal->subscribe(key, this) : nullptr;
+    if (pSubscription) {
+        connect(pSubscription,
+                &ControlJournalSubscription::valueChanged,
+                this,
+                &ControlWidgetConnection::slotControlValueChanged);
+    } else {
+        m_pControl->connectValueChanged(this, &ControlWidgetConnection::slotControlValueChanged);
+    }
 }
 
 void ControlWidgetConnection::setControlParameter(double parameter) {
@@ -5,6 +5,7 @@
 #include <QPainter>
 
 #include "skin/legacy/imgloader.h"
+#include "skin/legacy/svgrastercache.h"
 #include "util/assert.h"
 
 
@@ -58,29 +59,11 @@ std::shared_ptr<QImage> WImageStore::getImage(const PixmapSource& source, double
 // static
 QImage* WImageStore::getImageNoCache(const PixmapSource& source, double scaleFactor) {
     if (source.isSVG()) {
-        QSvgRenderer renderer;
-
-        if (!source.getSvgSourceData().isEmpty()) {
-            // Call here the different overload for svg content
-            if (!renderer.load(source.getSvgSourceData())) {
-                // The above line already logs a warning
-                return nullptr;
-            }
-        } else if (!source.getPath().isEmpty()) {
-            if (!renderer.load(source.getPath())) {
-                // The above line already logs a warning
-                return nullptr;
-            }
-        } else {
+        QImage image = SvgRasterCache::render(source, scaleFactor);
+        if (image.isNull()) {
             return nullptr;
         }
-
-        auto* pImage = new QImage(renderer.defaultSize() * scaleFactor,
-                QImage::Format_ARGB32);
-        pImage->fill(0x00000000);  // Transparent black.
-        QPainter painter(pImage);
-        renderer.render(&painter);
-        return pImage;
+        return new QImage(std::move(image));
     } else {
         return m_loader->getImage(source.getPath(), scaleFactor);
     }
@@ -3,8 +3,9 @@ import argparse
 import sys
 
 # To use, run this from the top level of the Git repository tree:
-# scripts/generate_sample_functions.py
+# tools/generate_sample_functions.py
 #     --sample_autogen_h src/util/sample_autogen.h
+#     --sample_kernels_autogen_h src/util/sample_kernels_autogen.h
 
 BASIC_INDENT = 4
 
@@ -17,11 +18,23 @@ def copy_with_gain_method_name(i):
 
 RAMPING_GAIN_METHOD_PATTERN = "copy%(i)dWithRampingGain"
 
+DISPATCH_METHOD_PATTERN = "dispatch%(name)s"
+
+# The variants that are used by the engine and the stock effects. Their loops
+# are compiled for every instruction set SampleUtil dispatches to at runtime.
+DISPATCHED_CHANNELS = (2, 3)
+
 
 def copy_with_ramping_gain_method_name(i):
     return RAMPING_GAIN_METHOD_PATTERN % {"i": i}
 
 
+def dispatch_method_name(method_name):
+    return DISPATCH_METHOD_PATTERN % {
+        "name": method_name[0].upper() + method_name[1:]
+    }
+
+
 def method_call(method_name, args):
     return "%(method_name)s(%(args)s)" % {
         "method_name": method_name,
@@ -43,31 +56,33 @@ def hanging_indent(base, groups, hanging_suffix, terminator, depth=0):
     )
 
 
-def write_sample_autogen(output, num_channels):
-    output.append("#ifndef MIXXX_UTIL_SAMPLEAUTOGEN_H")
-    output.append("#define MIXXX_UTIL_SAMPLEAUTOGEN_H")
+def write_autogen_banner(output):
     output.append("////////////////////////////////////////////////////////")
     output.append("// THIS FILE IS AUTO-GENERATED. DO NOT EDIT DIRECTLY! //")
-    output.append("// SEE scripts/generate_sample_functions.py           //")
+    output.append("// SEE tools/generate_sample_functions.py             //")
     output.append("////////////////////////////////////////////////////////")
 
+
+def write_sample_autogen(output, num_channels):
+    output.append("#pragma once")
+    write_autogen_banner(output)
+
     for i in range(1, num_channels + 1):
         copy_with_gain(output, 0, i)
         copy_with_ramping_gain(output, 0, i)
 
-    output.append("#endif /* MIXXX_UTIL_SAMPLEAUTOGEN_H */")
 
+def write_sample_kernels_autogen(output):
+    write_autogen_banner(output)
+    output.append("// Included by sample_kernels.h, no include guard by intention!")
 
-def copy_with_gain(output, base_indent_depth, num_channels):
-    def write(data, depth=0):
-        output.append(
-            " " * (BASIC_INDENT * (depth + base_indent_depth)) + data
-        )
+    for i in DISPATCHED_CHANNELS:
+        copy_with_gain_kernel(output, 0, i)
+        copy_with_ramping_gain_kernel(output, 0, i)
 
-    header = "static inline void %s(" % copy_with_gain_method_name(
-        num_channels
-    )
-    arg_groups = (
+
+def copy_with_gain_arg_groups(num_channels):
+    return (
         ["CSAMPLE* M_RESTRICT pDest"]
         + [
             "const CSAMPLE* M_RESTRICT pSrc%(i)d, CSAMPLE_GAIN gain%(i)d"
@@ -77,6 +92,101 @@ def copy_with_gain(output, base_indent_depth, num_channels):
         + ["int iNumSamples"]
     )
 
+
+def copy_with_gain_args(num_channels):
+    return (
+        ["pDest"]
+        + ["pSrc%(i)d, gain%(i)d" % {"i": i} for i in range(num_channels)]
+        + ["iNumSamples"]
+    )
+
+
+def copy_with_ramping_gain_arg_groups(num_channels):
+    return (
+        ["CSAMPLE* M_RESTRICT pDest"]
+        + [
+            (
+                "const CSAMPLE* M_RESTRICT pSrc%(i)d, "
+                "CSAMPLE_GAIN gain%(i)din, CSAMPLE_GAIN gain%(i)dout"
+            )
+            % {"i": i}
+            for i in range(num_channels)
+        ]
+        + ["int iNumSamples"]
+    )
+
+
+def copy_with_ramping_gain_args(num_channels):
+    return (
+        ["pDest"]
+        + [
+            "pSrc%(i)d, gain%(i)din, gain%(i)dout" % {"i": i}
+            for i in range(num_channels)
+        ]
+        + ["iNumSamples"]
+    )
+
+
+def dispatch_declaration(output, base_indent_depth, method_name, arg_groups):
+    output.append(
+        " " * (BASIC_INDENT * base_indent_depth)
+        + "// Runs the loop for the instruction set selected in sample.cpp"
+    )
+    header = "static void %s(" % dispatch_method_name(method_name)
+    output.extend(
+        hanging_indent(header, arg_groups, ",", ");", depth=base_indent_depth)
+    )
+
+
+def copy_with_gain_kernel(output, base_indent_depth, num_channels):
+    header = "SAMPLE_KERNEL void %s(" % copy_with_gain_method_name(
+        num_channels
+    )
+    output.extend(
+        hanging_indent(
+            header,
+            copy_with_gain_arg_groups(num_channels),
+            ",",
+            ") {",
+            depth=base_indent_depth,
+        )
+    )
+    copy_with_gain_loop(output, base_indent_depth, num_channels)
+    output.append(" " * (BASIC_INDENT * base_indent_depth) + "}")
+
+
+def copy_with_ramping_gain_kernel(output, base_indent_depth, num_channels):
+    header = "SAMPLE_KERNEL void %s(" % copy_with_ramping_gain_method_name(
+        num_channels
+    )
+    output.extend(
+        hanging_indent(
+            header,
+            copy_with_ramping_gain_arg_groups(num_channels),
+            ",",
+            ") {",
+            depth=base_indent_depth,
+        )
+    )
+    copy_with_ramping_gain_loop(output, base_indent_depth, num_channels)
+    output.append(" " * (BASIC_INDENT * base_indent_depth) + "}")
+
+
+def copy_with_gain(output, base_indent_depth, num_channels):
+    def write(data, depth=0):
+        output.append(
+            " " * (BASIC_INDENT * (depth + base_indent_depth)) + data
+        )
+
+    method_name = copy_with_gain_method_name(num_channels)
+    arg_groups = copy_with_gain_arg_groups(num_channels)
+    if num_channels in DISPATCHED_CHANNELS:
+        dispatch_declaration(
+            output, base_indent_depth, method_name, arg_groups
+        )
+
+    header = "static inline void %s(" % method_name
+
     output.extend(
         hanging_indent(header, arg_groups, ",", ") {", depth=base_indent_depth)
     )
@@ -105,16 +215,37 @@ def copy_with_gain(output, base_indent_depth, num_channels):
         write("return;", depth=2)
         write("}", depth=1)
 
+    if num_channels in DISPATCHED_CHANNELS:
+        write(
+            "%s;"
+            % method_call(
+                dispatch_method_name(method_name),
+                copy_with_gain_args(num_channels),
+            ),
+            depth=1,
+        )
+    else:
+        copy_with_gain_loop(output, base_indent_depth, num_channels)
+    write("}")
+
+
+def copy_with_gain_loop(output, base_indent_depth, num_channels):
+    def write(data, depth=0):
+        output.append(
+            " " * (BASIC_INDENT * (depth + base_indent_depth)) + data
+        )
+
     write("// note: LOOP VECTORIZED.", depth=1)
     write("for (int i = 0; i < iNumSamples; ++i) {", depth=1)
     terms = [
         "pSrc%(i)d[i] * gain%(i)d" % {"i": i} for i in range(num_channels)
     ]
     assign = "pDest[i] = "
-    output.extend(hanging_indent(assign, terms, " +", ";", depth=2))
+    output.extend(
+        hanging_indent(assign, terms, " +", ";", depth=base_indent_depth + 2)
+    )
 
     write("}", depth=1)
-    write("}")
 
 
 def copy_with_ramping_gain(output, base_indent_depth, num_channels):
@@ -123,21 +254,14 @@ def copy_with_ramping_gain(output, base_indent_depth, num_channels):
             " " * (BASIC_INDENT * (depth + base_indent_depth)) + data
         )
 
-    header = "static inline void %s(" % copy_with_ramping_gain_method_name(
-        num_channels
-    )
-    arg_groups = (
-        ["CSAMPLE* M_RESTRICT pDest"]
-        + [
-            (
-                "const CSAMPLE* M_RESTRICT pSrc%(i)d, "
-                "CSAMPLE_GAIN gain%(i)din, CSAMPLE_GAIN gain%(i)dout"
-            )
-            % {"i": i}
-            for i in range(num_channels)
-        ]
-        + ["int iNumSamples"]
-    )
+    method_name = copy_with_ramping_gain_method_name(num_channels)
+    arg_groups = copy_with_ramping_gain_arg_groups(num_channels)
+    if num_channels in DISPATCHED_CHANNELS:
+        dispatch_declaration(
+            output, base_indent_depth, method_name, arg_groups
+        )
+
+    header = "static inline void %s(" % method_name
 
     output.extend(
         hanging_indent(header, arg_groups, ",", ") {", depth=base_indent_depth)
@@ -174,6 +298,26 @@ def copy_with_ramping_gain(output, base_indent_depth, num_channels):
         write("return;", depth=2)
         write("}", depth=1)
 
+    if num_channels in DISPATCHED_CHANNELS:
+        write(
+            "%s;"
+            % method_call(
+                dispatch_method_name(method_name),
+                copy_with_ramping_gain_args(num_channels),
+            ),
+            depth=1,
+        )
+    else:
+        copy_with_ramping_gain_loop(output, base_indent_depth, num_channels)
+    write("}")
+
+
+def copy_with_ramping_gain_loop(output, base_indent_depth, num_channels):
+    def write(data, depth=0):
+        output.append(
+            " " * (BASIC_INDENT * (depth + base_indent_depth)) + data
+        )
+
     for i in range(num_channels):
         write(
             (
@@ -214,11 +358,18 @@ def copy_with_ramping_gain(output, base_indent_depth, num_channels):
     assign1 = "pDest[i * 2] = "
     assign2 = "pDest[i * 2 + 1] = "
 
-    output.extend(hanging_indent(assign1, terms1, " +", ";", depth=2))
-    output.extend(hanging_indent(assign2, terms2, " +", ";", depth=2))
+    output.extend(
+        hanging_indent(
+            assign1, terms1, " +", ";", depth=base_indent_depth + 2
+        )
+    )
+    output.extend(
+        hanging_indent(
+            assign2, terms2, " +", ";", depth=base_indent_depth + 2
+        )
+    )
 
     write("}", depth=1)
-    write("}")
 
 
 def main(args):
@@ -232,6 +383,12 @@ def main(args):
     )
     output.write("\n".join(sampleutil_output_lines) + "\n")
 
+    if args.sample_kernels_autogen_h:
+        kernels_output_lines = []
+        write_sample_kernels_autogen(kernels_output_lines)
+        with open(args.sample_kernels_autogen_h, "w") as output:
+            output.write("\n".join(kernels_output_lines) + "\n")
+
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(
@@ -242,6 +399,7 @@ if __name__ == "__main__":
         ),
     )
     parser.add_argument("--sample_autogen_h")
+    parser.add_argument("--sample_kernels_autogen_h")
     parser.add_argument("--max_channels", type=int, default=32)
     args = parser.parse_args()
     main(args)